@@ -0,0 +1,281 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <http://www.natron.fr/>,
+ * Copyright (C) 2016 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "Benchmark.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <ctime>
+
+CLANG_DIAG_OFF(deprecated)
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QThread>
+CLANG_DIAG_ON(deprecated)
+
+NATRON_NAMESPACE_ENTER;
+
+Benchmark::Benchmark(const std::string& group,
+                     const std::string& name)
+    : _group(group)
+    , _name(name)
+    , _bytesPerIteration(0)
+    , _itemsPerIteration(0)
+    , _counters()
+{
+}
+
+Benchmark::~Benchmark()
+{
+}
+
+std::string
+Benchmark::getFullName() const
+{
+    return _group + '/' + _name;
+}
+
+NATRON_NAMESPACE_ANONYMOUS_ENTER
+
+// Function-local so that it is constructed before the static registrars use it, whatever the link order
+std::vector<Benchmark*>&
+getRegisteredBenchmarks()
+{
+    static std::vector<Benchmark*> benchmarks;
+
+    return benchmarks;
+}
+
+bool
+benchmarkNameLess(const Benchmark* a,
+                  const Benchmark* b)
+{
+    return a->getFullName() < b->getFullName();
+}
+
+double
+runIterations(Benchmark* benchmark,
+              U64 iterations)
+{
+    QElapsedTimer timer;
+
+    timer.start();
+    for (U64 i = 0; i < iterations; ++i) {
+        benchmark->run();
+    }
+
+    return (double)timer.nsecsElapsed();
+}
+
+void
+writeJSONString(std::ostream& os,
+                const std::string& str)
+{
+    os << '"';
+    for (std::size_t i = 0; i < str.size(); ++i) {
+        unsigned char c = (unsigned char)str[i];
+        if ( (c == '"') || (c == '\\') ) {
+            os << '\\' << str[i];
+        } else if (c < 0x20) {
+            char buf[8];
+            snprintf(buf, sizeof(buf), "\\u%04x", (unsigned int)c);
+            os << buf;
+        } else {
+            os << str[i];
+        }
+    }
+    os << '"';
+}
+
+void
+writeJSONNumber(std::ostream& os,
+                double value)
+{
+    // JSON has no representation for infinity and NaN, for which value - value is NaN
+    if ( !(value - value == 0.) ) {
+        os << "null";
+    } else {
+        char buf[32];
+        snprintf(buf, sizeof(buf), "%.9g", value);
+        os << buf;
+    }
+}
+
+NATRON_NAMESPACE_ANONYMOUS_EXIT
+
+void
+BenchmarkRunner::registerBenchmark(Benchmark* benchmark)
+{
+    getRegisteredBenchmarks().push_back(benchmark);
+}
+
+const std::vector<Benchmark*>&
+BenchmarkRunner::getBenchmarks()
+{
+    std::vector<Benchmark*>& benchmarks = getRegisteredBenchmarks();
+
+    // The static registration order depends on the link order: sort so that runs are comparable
+    std::sort(benchmarks.begin(), benchmarks.end(), benchmarkNameLess);
+
+    return benchmarks;
+}
+
+BenchmarkRunner::BenchmarkRunner()
+    : _filter()
+    , _samples(5)
+    , _minSampleTimeMs(100.)
+    , _results()
+{
+}
+
+BenchmarkResult
+BenchmarkRunner::runBenchmark(Benchmark* benchmark) const
+{
+    BenchmarkResult result;
+
+    result.name = benchmark->getFullName();
+
+    benchmark->setUp();
+
+    // Warm-up, then double the number of iterations until a sample is long enough to be measured reliably
+    U64 iterations = 1;
+    double ns = runIterations(benchmark, iterations);
+    const double minSampleNs = _minSampleTimeMs * 1e6;
+    while (ns < minSampleNs) {
+        U64 factor = 2;
+        if (ns > 0) {
+            factor = std::max( (U64)2, std::min( (U64)10, (U64)(minSampleNs / ns) + 1 ) );
+        } else {
+            factor = 10;
+        }
+        iterations *= factor;
+        ns = runIterations(benchmark, iterations);
+    }
+
+    std::vector<double> perIteration(_samples);
+    double sum = 0.;
+    for (int i = 0; i < _samples; ++i) {
+        perIteration[i] = runIterations(benchmark, iterations) / iterations;
+        sum += perIteration[i];
+    }
+    std::sort( perIteration.begin(), perIteration.end() );
+
+    benchmark->tearDown();
+
+    result.iterations = iterations;
+    result.samples = _samples;
+    result.minNs = perIteration.front();
+    result.medianNs = (_samples % 2) ? perIteration[_samples / 2] : (perIteration[_samples / 2 - 1] + perIteration[_samples / 2]) / 2.;
+    result.meanNs = sum / _samples;
+    result.bytesPerIteration = benchmark->getBytesPerIteration();
+    result.itemsPerIteration = benchmark->getItemsPerIteration();
+    result.counters = benchmark->getCounters();
+
+    return result;
+} // runBenchmark
+
+void
+BenchmarkRunner::run(std::ostream* progress)
+{
+    _results.clear();
+    const std::vector<Benchmark*>& benchmarks = getBenchmarks();
+    for (std::size_t i = 0; i < benchmarks.size(); ++i) {
+        std::string name = benchmarks[i]->getFullName();
+        if ( !_filter.empty() && (name.find(_filter) == std::string::npos) ) {
+            continue;
+        }
+        BenchmarkResult result = runBenchmark(benchmarks[i]);
+        if (progress) {
+            char buf[256];
+            snprintf(buf, sizeof(buf), "%-48s %12.0f ns (median) %12.0f ns (min) x %llu\n", name.c_str(), result.medianNs, result.minNs, (unsigned long long)result.iterations);
+            *progress << buf << std::flush;
+        }
+        _results.push_back(result);
+    }
+}
+
+void
+BenchmarkRunner::writeJSON(std::ostream& os) const
+{
+    char date[64];
+    time_t now = time(0);
+
+    strftime( date, sizeof(date), "%Y-%m-%dT%H:%M:%SZ", gmtime(&now) );
+
+    os << "{\n";
+    os << "  \"version\": ";
+    writeJSONString(os, NATRON_VERSION_STRING);
+    os << ",\n";
+    os << "  \"build\": ";
+#ifdef DEBUG
+    writeJSONString(os, "debug");
+#else
+    writeJSONString(os, "release");
+#endif
+    os << ",\n";
+    os << "  \"date\": ";
+    writeJSONString(os, date);
+    os << ",\n";
+    os << "  \"idealThreadCount\": " << QThread::idealThreadCount() << ",\n";
+    os << "  \"samples\": " << _samples << ",\n";
+    os << "  \"benchmarks\": [";
+    for (std::size_t i = 0; i < _results.size(); ++i) {
+        const BenchmarkResult& r = _results[i];
+        os << (i == 0 ? "\n" : ",\n");
+        os << "    {\n";
+        os << "      \"name\": ";
+        writeJSONString(os, r.name);
+        os << ",\n";
+        os << "      \"iterations\": " << r.iterations << ",\n";
+        os << "      \"minNs\": ";
+        writeJSONNumber(os, r.minNs);
+        os << ",\n";
+        os << "      \"medianNs\": ";
+        writeJSONNumber(os, r.medianNs);
+        os << ",\n";
+        os << "      \"meanNs\": ";
+        writeJSONNumber(os, r.meanNs);
+        if (r.bytesPerIteration) {
+            os << ",\n      \"bytesPerSecond\": ";
+            writeJSONNumber(os, r.bytesPerIteration * 1e9 / r.medianNs);
+        }
+        if (r.itemsPerIteration) {
+            os << ",\n      \"itemsPerSecond\": ";
+            writeJSONNumber(os, r.itemsPerIteration * 1e9 / r.medianNs);
+        }
+        if ( !r.counters.empty() ) {
+            os << ",\n      \"counters\": {";
+            for (std::map<std::string, double>::const_iterator it = r.counters.begin(); it != r.counters.end(); ++it) {
+                os << ( it == r.counters.begin() ? "\n" : ",\n" ) << "        ";
+                writeJSONString(os, it->first);
+                os << ": ";
+                writeJSONNumber(os, it->second);
+            }
+            os << "\n      }";
+        }
+        os << "\n    }";
+    }
+    os << "\n  ]\n}\n";
+} // writeJSON
+
+NATRON_NAMESPACE_EXIT;
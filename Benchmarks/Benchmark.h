@@ -0,0 +1,229 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <http://www.natron.fr/>,
+ * Copyright (C) 2016 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+#ifndef NATRON_BENCHMARKS_BENCHMARK_H
+#define NATRON_BENCHMARKS_BENCHMARK_H
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "Global/Macros.h"
+
+#include <map>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "Global/GlobalDefines.h"
+
+NATRON_NAMESPACE_ENTER;
+
+/**
+ * @brief A single micro-benchmark. run() executes one iteration of the measured code and is called
+ * repeatedly by the BenchmarkRunner: everything that should not be measured (allocating and filling
+ * buffers, building a curve...) belongs to setUp() and tearDown().
+ * Benchmarks are registered statically with the NATRON_BENCHMARK macro.
+ **/
+class Benchmark
+{
+public:
+
+    Benchmark(const std::string& group,
+              const std::string& name);
+
+    virtual ~Benchmark();
+
+    /**
+     * @brief Returns "group/name", which is the identifier of the benchmark in the JSON output.
+     **/
+    std::string getFullName() const;
+
+    virtual void setUp() {}
+
+    virtual void run() = 0;
+
+    virtual void tearDown() {}
+
+    /**
+     * @brief The number of bytes (resp. items: pixels, keys, lookups...) processed by one iteration,
+     * used to report a throughput. Zero if not relevant.
+     **/
+    U64 getBytesPerIteration() const
+    {
+        return _bytesPerIteration;
+    }
+
+    U64 getItemsPerIteration() const
+    {
+        return _itemsPerIteration;
+    }
+
+    const std::map<std::string, double>& getCounters() const
+    {
+        return _counters;
+    }
+
+protected:
+
+    void setBytesPerIteration(U64 bytes)
+    {
+        _bytesPerIteration = bytes;
+    }
+
+    void setItemsPerIteration(U64 items)
+    {
+        _itemsPerIteration = items;
+    }
+
+    /**
+     * @brief Reports an extra value measured by the benchmark (e.g: a compression ratio or a hit ratio).
+     **/
+    void setCounter(const std::string& name,
+                    double value)
+    {
+        _counters[name] = value;
+    }
+
+private:
+
+    std::string _group, _name;
+    U64 _bytesPerIteration;
+    U64 _itemsPerIteration;
+    std::map<std::string, double> _counters;
+};
+
+/**
+ * @brief A deterministic pseudo-random generator, so that all benchmarks process the same data on every run
+ * and on every platform, which is not guaranteed by rand().
+ **/
+class BenchmarkRandom
+{
+public:
+
+    explicit BenchmarkRandom(U32 seed)
+        : _state(seed ? seed : 1)
+    {
+    }
+
+    U32 next()
+    {
+        // xorshift32
+        _state ^= _state << 13;
+        _state ^= _state >> 17;
+        _state ^= _state << 5;
+
+        return _state;
+    }
+
+    // Uniform in [0,1)
+    double nextDouble()
+    {
+        return next() / 4294967296.;
+    }
+
+private:
+
+    U32 _state;
+};
+
+struct BenchmarkResult
+{
+    std::string name;
+    U64 iterations; // per sample
+    int samples;
+    double minNs, medianNs, meanNs; // per iteration
+    U64 bytesPerIteration, itemsPerIteration;
+    std::map<std::string, double> counters;
+};
+
+/**
+ * @brief Runs the registered benchmarks and writes the results as JSON.
+ * Each benchmark is first run once to warm up caches and to calibrate the number of iterations so that
+ * a sample lasts at least minSampleTimeMs, then the given number of samples is measured.
+ * The minimum and median times per iteration are the most stable figures to compare between two builds.
+ **/
+class BenchmarkRunner
+{
+public:
+
+    static void registerBenchmark(Benchmark* benchmark);
+
+    static const std::vector<Benchmark*>& getBenchmarks();
+
+    BenchmarkRunner();
+
+    void setFilter(const std::string& filter)
+    {
+        _filter = filter;
+    }
+
+    void setSamples(int samples)
+    {
+        _samples = samples;
+    }
+
+    void setMinSampleTimeMs(double ms)
+    {
+        _minSampleTimeMs = ms;
+    }
+
+    /**
+     * @brief Runs all benchmarks whose full name contains the filter. Progress is printed to progress if not NULL.
+     **/
+    void run(std::ostream* progress);
+
+    void writeJSON(std::ostream& os) const;
+
+    const std::vector<BenchmarkResult>& getResults() const
+    {
+        return _results;
+    }
+
+private:
+
+    BenchmarkResult runBenchmark(Benchmark* benchmark) const;
+
+    std::string _filter;
+    int _samples;
+    double _minSampleTimeMs;
+    std::vector<BenchmarkResult> _results;
+};
+
+template <typename T>
+class BenchmarkRegistrar
+{
+public:
+
+    BenchmarkRegistrar()
+    {
+        BenchmarkRunner::registerBenchmark(new T);
+    }
+};
+
+NATRON_NAMESPACE_EXIT;
+
+/**
+ * @brief Registers the Benchmark subclass named className, which must be default-constructible.
+ **/
+#define NATRON_BENCHMARK(className) \
+    static NATRON_NAMESPACE::BenchmarkRegistrar<className> className ## _registrar
+
+#endif // NATRON_BENCHMARKS_BENCHMARK_H
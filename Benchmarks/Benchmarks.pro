@@ -0,0 +1,57 @@
+# ***** BEGIN LICENSE BLOCK *****
+# This file is part of Natron <http://www.natron.fr/>,
+# Copyright (C) 2016 INRIA and Alexandre Gauthier-Foichat
+#
+# Natron is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 2 of the License, or
+# (at your option) any later version.
+#
+# Natron is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+# ***** END LICENSE BLOCK *****
+
+# Micro-benchmarks of the engine hot paths. Run ./Benchmarks --help for the options, the results are written as JSON.
+TARGET = Benchmarks
+TEMPLATE = app
+CONFIG += console
+CONFIG -= app_bundle
+# Cairo is still the default renderer for Roto
+!enable-osmesa {
+   CONFIG += enable-cairo
+}
+CONFIG += moc
+CONFIG += boost qt python shiboken pyside
+enable-cairo: CONFIG += cairo
+CONFIG += static-engine static-host-support static-breakpadclient static-libmv static-openmvg static-ceres static-libtess
+QT += core network
+QT -= gui
+greaterThan(QT_MAJOR_VERSION, 4): QT += concurrent
+
+CONFIG += openmvg-flags glad-flags
+
+!noexpat: CONFIG += expat
+
+include(../global.pri)
+
+SOURCES += \
+    Benchmark.cpp \
+    Benchmarks_main.cpp \
+    CacheBenchmarks.cpp \
+    CurveBenchmarks.cpp \
+    Hash64Benchmarks.cpp \
+    ImageBenchmarks.cpp \
+    LutBenchmarks.cpp \
+    OfxMultiThreadBenchmarks.cpp \
+    RotoBenchmarks.cpp \
+    TLSBenchmarks.cpp \
+    TrackerBenchmarks.cpp \
+    ViewerTileCodecBenchmarks.cpp
+
+HEADERS += \
+    Benchmark.h
@@ -0,0 +1,110 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <http://www.natron.fr/>,
+ * Copyright (C) 2016 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+#include "Engine/AppManager.h"
+#include "Engine/CLArgs.h"
+
+#include "Benchmark.h"
+
+NATRON_NAMESPACE_USING
+
+static void
+printUsage(const char* program)
+{
+    std::cout << "Usage: " << program << " [options]\n"
+              << "Runs the Natron micro-benchmarks and writes the results as JSON.\n\n"
+              << "Options:\n"
+              << "  --list               List the benchmarks and exit.\n"
+              << "  --filter <text>      Only run the benchmarks whose name contains <text>.\n"
+              << "  --samples <n>        Number of measured samples per benchmark (default 5).\n"
+              << "  --min-time <ms>      Minimum duration of a sample in milliseconds (default 100).\n"
+              << "  --output <file>      Write the JSON results to <file> instead of the standard output.\n"
+              << "  --help               Print this message and exit.\n";
+}
+
+int
+main(int argc,
+     char *argv[])
+{
+    BenchmarkRunner runner;
+    std::string outputFile;
+
+    for (int i = 1; i < argc; ++i) {
+        bool hasValue = i + 1 < argc;
+        if ( !strcmp(argv[i], "--help") ) {
+            printUsage(argv[0]);
+
+            return 0;
+        } else if ( !strcmp(argv[i], "--list") ) {
+            const std::vector<Benchmark*>& benchmarks = BenchmarkRunner::getBenchmarks();
+            for (std::size_t j = 0; j < benchmarks.size(); ++j) {
+                std::cout << benchmarks[j]->getFullName() << '\n';
+            }
+
+            return 0;
+        } else if ( !strcmp(argv[i], "--filter") && hasValue ) {
+            runner.setFilter(argv[++i]);
+        } else if ( !strcmp(argv[i], "--samples") && hasValue ) {
+            runner.setSamples( std::max(1, std::atoi(argv[++i])) );
+        } else if ( !strcmp(argv[i], "--min-time") && hasValue ) {
+            runner.setMinSampleTimeMs( std::max(1., std::atof(argv[++i])) );
+        } else if ( !strcmp(argv[i], "--output") && hasValue ) {
+            outputFile = argv[++i];
+        } else {
+            std::cerr << "Unknown or incomplete option: " << argv[i] << '\n';
+            printUsage(argv[0]);
+
+            return 1;
+        }
+    }
+
+    // The cache benchmarks need the application: it owns the cache memory accounting and the thread pool.
+    // As in the unit tests, there is no project to load: the return value only tells whether it was rendered.
+    AppManager manager;
+    int appArgc = 0;
+    CLArgs cl;
+    manager.load(appArgc, 0, cl);
+
+    runner.run(&std::cerr);
+
+    if ( outputFile.empty() ) {
+        runner.writeJSON(std::cout);
+    } else {
+        std::ofstream ofile( outputFile.c_str() );
+        if ( !ofile.good() ) {
+            std::cerr << "Cannot open " << outputFile << " for writing\n";
+
+            return 1;
+        }
+        runner.writeJSON(ofile);
+    }
+
+    return 0;
+} // main
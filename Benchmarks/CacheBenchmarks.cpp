@@ -0,0 +1,194 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <http://www.natron.fr/>,
+ * Copyright (C) 2016 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "Global/Macros.h"
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#if !defined(Q_MOC_RUN) && !defined(SBK_RUN)
+#include <boost/scoped_ptr.hpp>
+#endif
+
+CLANG_DIAG_OFF(deprecated)
+#include <QtCore/QAtomicInt>
+#include <QtCore/QThread>
+CLANG_DIAG_ON(deprecated)
+
+#include "Engine/Cache.h"
+#include "Engine/Image.h"
+#include "Engine/ImageComponents.h"
+#include "Engine/ViewIdx.h"
+
+#include "Benchmark.h"
+
+NATRON_NAMESPACE_USING
+
+NATRON_NAMESPACE_ANONYMOUS_ENTER
+
+// Entries are 128x128 RGBA float images (256 KiB), the cache holds kCacheCapacity of them
+const int kImageSize = 128;
+const int kCacheCapacity = 64;
+const int kOpsPerThread = 256;
+
+class CacheWorker
+    : public QThread
+{
+    ImageCache* _cache;
+    ImageParamsPtr _params;
+    int _nKeys;
+    U32 _seed;
+    QAtomicInt* _hits;
+
+public:
+
+    CacheWorker(ImageCache* cache,
+                const ImageParamsPtr& params,
+                int nKeys,
+                U32 seed,
+                QAtomicInt* hits)
+        : QThread()
+        , _cache(cache)
+        , _params(params)
+        , _nKeys(nKeys)
+        , _seed(seed)
+        , _hits(hits)
+    {
+    }
+
+private:
+
+    virtual void run() OVERRIDE FINAL
+    {
+        BenchmarkRandom random(_seed);
+        int hits = 0;
+
+        for (int i = 0; i < kOpsPerThread; ++i) {
+            U64 nodeHash = 1 + random.next() % _nKeys;
+            ImageKey key(0, nodeHash, false, 0., ViewIdx(0), 1., false, false);
+            ImagePtr image;
+            if ( _cache->getOrCreate(key, _params, 0, &image) ) {
+                ++hits;
+            } else if (image) {
+                image->allocateMemory();
+            }
+        }
+        _hits->fetchAndAddRelaxed(hits);
+    }
+};
+
+std::string
+makeCacheBenchmarkName(bool evict,
+                       int nThreads)
+{
+    char name[64];
+
+    snprintf(name, sizeof(name), "%s_threads%d", evict ? "getOrCreate_evict" : "get", nThreads);
+
+    return name;
+}
+
+/**
+ * @brief Several threads look-up random keys in a private image cache at the same time.
+ * If evict is false the keys all fit in the cache and after the first iteration this measures the lookup
+ * (and the contention on the cache locks), otherwise about a third of the look-ups miss, which allocates a new
+ * entry and evicts the least recently used one.
+ **/
+template <int nThreads, bool evict>
+class CacheBenchmark
+    : public Benchmark
+{
+    boost::scoped_ptr<ImageCache> _cache;
+    ImageParamsPtr _params;
+    QAtomicInt _hits;
+    U64 _nOps;
+    U32 _seed;
+
+public:
+
+    CacheBenchmark()
+        : Benchmark( "Cache", makeCacheBenchmarkName(evict, nThreads) )
+        , _cache()
+        , _params()
+        , _hits(0)
+        , _nOps(0)
+        , _seed(1)
+    {
+    }
+
+    virtual void setUp() OVERRIDE FINAL
+    {
+        RectI bounds(0, 0, kImageSize, kImageSize);
+        RectD rod(bounds.x1, bounds.y1, bounds.x2, bounds.y2);
+
+        _params = Image::makeParams(rod, bounds, 1., 0, false, ImageComponents::getRGBAComponents(), eImageBitDepthFloat,
+                                    eImagePremultiplicationPremultiplied, eImageFieldingOrderNone);
+        _cache.reset( new ImageCache( "BenchmarkCache", NATRON_CACHE_VERSION, (U64)kCacheCapacity * kImageSize * kImageSize * 4 * sizeof(float), 1. ) );
+        _hits.fetchAndStoreRelaxed(0);
+        _nOps = 0;
+        _seed = 1;
+        setItemsPerIteration(nThreads * kOpsPerThread);
+    }
+
+    virtual void run() OVERRIDE FINAL
+    {
+        int nKeys = evict ? kCacheCapacity * 3 / 2 : kCacheCapacity / 2;
+        std::vector<CacheWorker*> workers(nThreads);
+
+        for (int i = 0; i < nThreads; ++i) {
+            workers[i] = new CacheWorker(_cache.get(), _params, nKeys, _seed++, &_hits);
+            workers[i]->start();
+        }
+        for (int i = 0; i < nThreads; ++i) {
+            workers[i]->wait();
+            delete workers[i];
+        }
+        _nOps += nThreads * kOpsPerThread;
+    }
+
+    virtual void tearDown() OVERRIDE FINAL
+    {
+        setCounter("hitRatio", _nOps ? (double)_hits.fetchAndAddRelaxed(0) / _nOps : 0.);
+        _cache->waitForDeleterThread();
+        _cache.reset();
+        _params.reset();
+    }
+};
+
+typedef CacheBenchmark<1, false> CacheGet1Benchmark;
+typedef CacheBenchmark<4, false> CacheGet4Benchmark;
+typedef CacheBenchmark<16, false> CacheGet16Benchmark;
+typedef CacheBenchmark<1, true> CacheEvict1Benchmark;
+typedef CacheBenchmark<4, true> CacheEvict4Benchmark;
+typedef CacheBenchmark<16, true> CacheEvict16Benchmark;
+
+NATRON_NAMESPACE_ANONYMOUS_EXIT
+
+NATRON_BENCHMARK(CacheGet1Benchmark);
+NATRON_BENCHMARK(CacheGet4Benchmark);
+NATRON_BENCHMARK(CacheGet16Benchmark);
+NATRON_BENCHMARK(CacheEvict1Benchmark);
+NATRON_BENCHMARK(CacheEvict4Benchmark);
+NATRON_BENCHMARK(CacheEvict16Benchmark);
@@ -0,0 +1,109 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <http://www.natron.fr/>,
+ * Copyright (C) 2016 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "Global/Macros.h"
+
+#include <cstdio>
+#include <string>
+
+#if !defined(Q_MOC_RUN) && !defined(SBK_RUN)
+#include <boost/scoped_ptr.hpp>
+#endif
+
+#include "Engine/Curve.h"
+
+#include "Benchmark.h"
+
+NATRON_NAMESPACE_USING
+
+NATRON_NAMESPACE_ANONYMOUS_ENTER
+
+const int kEvaluations = 4096;
+
+std::string
+makeCurveBenchmarkName(const char* interpolation,
+                       int nKeys)
+{
+    char name[64];
+
+    snprintf(name, sizeof(name), "getValueAt_%s_keys%d", interpolation, nKeys);
+
+    return name;
+}
+
+/**
+ * @brief Evaluates a curve with nKeys keyframes at kEvaluations fractional times spread over its range,
+ * as the curve editor and the renders of an animated parameter do.
+ **/
+template <int nKeys, KeyframeTypeEnum interpolation>
+class CurveGetValueBenchmark
+    : public Benchmark
+{
+    boost::scoped_ptr<Curve> _curve;
+    double _sum;
+
+public:
+
+    CurveGetValueBenchmark()
+        : Benchmark( "Curve", makeCurveBenchmarkName(interpolation == eKeyframeTypeLinear ? "linear" : "smooth", nKeys) )
+        , _curve()
+        , _sum(0.)
+    {
+    }
+
+    virtual void setUp() OVERRIDE FINAL
+    {
+        BenchmarkRandom random(nKeys);
+
+        _curve.reset(new Curve);
+        for (int i = 0; i < nKeys; ++i) {
+            _curve->addKeyFrame( KeyFrame( i * 10., random.nextDouble() * 100., 0., 0., interpolation ) );
+        }
+        setItemsPerIteration(kEvaluations);
+    }
+
+    virtual void run() OVERRIDE FINAL
+    {
+        const double step = (nKeys - 1) * 10. / kEvaluations;
+
+        for (int i = 0; i < kEvaluations; ++i) {
+            _sum += _curve->getValueAt(i * step);
+        }
+    }
+
+    virtual void tearDown() OVERRIDE FINAL
+    {
+        _curve.reset();
+    }
+};
+
+typedef CurveGetValueBenchmark<16, eKeyframeTypeSmooth> CurveSmooth16Benchmark;
+typedef CurveGetValueBenchmark<1024, eKeyframeTypeSmooth> CurveSmooth1024Benchmark;
+typedef CurveGetValueBenchmark<1024, eKeyframeTypeLinear> CurveLinear1024Benchmark;
+
+NATRON_NAMESPACE_ANONYMOUS_EXIT
+
+NATRON_BENCHMARK(CurveSmooth16Benchmark);
+NATRON_BENCHMARK(CurveSmooth1024Benchmark);
+NATRON_BENCHMARK(CurveLinear1024Benchmark);
@@ -0,0 +1,87 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <http://www.natron.fr/>,
+ * Copyright (C) 2016 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "Global/Macros.h"
+
+#include <vector>
+
+#include "Engine/Hash64.h"
+
+#include "Benchmark.h"
+
+NATRON_NAMESPACE_USING
+
+NATRON_NAMESPACE_ANONYMOUS_ENTER
+
+/**
+ * @brief Appends nValues values and computes the hash, as is done for each node whenever a parameter changes.
+ **/
+template <int nValues>
+class Hash64Benchmark
+    : public Benchmark
+{
+    std::vector<double> _values;
+    U64 _hash;
+
+public:
+
+    Hash64Benchmark()
+        : Benchmark("Hash64", nValues > 64 ? "appendAndCompute_large" : "appendAndCompute_small")
+        , _values()
+        , _hash(0)
+    {
+    }
+
+    virtual void setUp() OVERRIDE FINAL
+    {
+        BenchmarkRandom random(nValues);
+
+        _values.resize(nValues);
+        for (int i = 0; i < nValues; ++i) {
+            _values[i] = random.nextDouble();
+        }
+        setItemsPerIteration(nValues);
+        setBytesPerIteration( nValues * sizeof(U64) );
+    }
+
+    virtual void run() OVERRIDE FINAL
+    {
+        Hash64 hash;
+
+        for (int i = 0; i < nValues; ++i) {
+            hash.append(_values[i]);
+        }
+        hash.computeHash();
+        _hash ^= hash.value();
+    }
+};
+
+// A node with a handful of parameters, and one with many parameters or animated ones
+typedef Hash64Benchmark<32> Hash64SmallBenchmark;
+typedef Hash64Benchmark<4096> Hash64LargeBenchmark;
+
+NATRON_NAMESPACE_ANONYMOUS_EXIT
+
+NATRON_BENCHMARK(Hash64SmallBenchmark);
+NATRON_BENCHMARK(Hash64LargeBenchmark);
@@ -0,0 +1,477 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <http://www.natron.fr/>,
+ * Copyright (C) 2016 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "Global/Macros.h"
+
+#include <bitset>
+#include <list>
+#include <string>
+
+#include "Engine/Image.h"
+#include "Engine/ImageComponents.h"
+
+#include "Benchmark.h"
+
+NATRON_NAMESPACE_USING
+
+NATRON_NAMESPACE_ANONYMOUS_ENTER
+
+// An HD frame, which is what most of the images processed by the renderer look like
+const int kWidth = 1920;
+const int kHeight = 1080;
+
+// Allocates a local image filled with deterministic premultiplied noise
+ImagePtr
+makeImage(const ImageComponents& components,
+          ImageBitDepthEnum depth,
+          const RectI& bounds,
+          U32 seed)
+{
+    RectD rod(bounds.x1, bounds.y1, bounds.x2, bounds.y2);
+    ImagePtr image( new Image(components, rod, bounds, 0, 1., depth, eImagePremultiplicationPremultiplied, eImageFieldingOrderNone) );
+    BenchmarkRandom random(seed);
+    int nComps = (int)components.getNumComponents();
+    Image::WriteAccess acc( image.get() );
+
+    for (int y = bounds.y1; y < bounds.y2; ++y) {
+        unsigned char* row = acc.pixelAt(bounds.x1, y);
+        for (int x = 0; x < bounds.width(); ++x) {
+            float alpha = (float)random.nextDouble();
+            for (int c = 0; c < nComps; ++c) {
+                float v = (c == nComps - 1) ? alpha : (float)random.nextDouble() * alpha;
+                int i = x * nComps + c;
+                if (depth == eImageBitDepthFloat) {
+                    reinterpret_cast<float*>(row)[i] = v;
+                } else if (depth == eImageBitDepthShort) {
+                    reinterpret_cast<unsigned short*>(row)[i] = (unsigned short)(v * 65535.f);
+                } else {
+                    row[i] = (unsigned char)(v * 255.f);
+                }
+            }
+        }
+    }
+
+    return image;
+}
+
+class ConvertToByteBenchmark
+    : public Benchmark
+{
+    ImagePtr _src, _dst;
+
+public:
+
+    ConvertToByteBenchmark()
+        : Benchmark("Image", "convertToFormat_RGBAFloat_RGBAByte_sRGB")
+    {
+    }
+
+    virtual void setUp() OVERRIDE FINAL
+    {
+        RectI bounds(0, 0, kWidth, kHeight);
+
+        _src = makeImage(ImageComponents::getRGBAComponents(), eImageBitDepthFloat, bounds, 1);
+        _dst = makeImage(ImageComponents::getRGBAComponents(), eImageBitDepthByte, bounds, 2);
+        setItemsPerIteration( bounds.area() );
+        setBytesPerIteration( (U64)bounds.area() * 4 * sizeof(float) );
+    }
+
+    virtual void run() OVERRIDE FINAL
+    {
+        _src->convertToFormat(_src->getBounds(), eViewerColorSpaceLinear, eViewerColorSpaceSRGB, 3, false, false, _dst.get() );
+    }
+
+    virtual void tearDown() OVERRIDE FINAL
+    {
+        _src.reset();
+        _dst.reset();
+    }
+};
+
+class ConvertToAlphaBenchmark
+    : public Benchmark
+{
+    ImagePtr _src, _dst;
+
+public:
+
+    ConvertToAlphaBenchmark()
+        : Benchmark("Image", "convertToFormat_RGBAFloat_Alpha")
+    {
+    }
+
+    virtual void setUp() OVERRIDE FINAL
+    {
+        RectI bounds(0, 0, kWidth, kHeight);
+
+        _src = makeImage(ImageComponents::getRGBAComponents(), eImageBitDepthFloat, bounds, 3);
+        _dst = makeImage(ImageComponents::getAlphaComponents(), eImageBitDepthFloat, bounds, 4);
+        setItemsPerIteration( bounds.area() );
+        setBytesPerIteration( (U64)bounds.area() * 4 * sizeof(float) );
+    }
+
+    virtual void run() OVERRIDE FINAL
+    {
+        _src->convertToFormat(_src->getBounds(), eViewerColorSpaceLinear, eViewerColorSpaceLinear, 3, false, false, _dst.get() );
+    }
+
+    virtual void tearDown() OVERRIDE FINAL
+    {
+        _src.reset();
+        _dst.reset();
+    }
+};
+
+class HalveRoIBenchmark
+    : public Benchmark
+{
+    ImagePtr _src, _dst;
+
+public:
+
+    HalveRoIBenchmark()
+        : Benchmark("Image", "halveRoI_RGBAFloat")
+    {
+    }
+
+    virtual void setUp() OVERRIDE FINAL
+    {
+        RectI bounds(0, 0, kWidth, kHeight);
+
+        _src = makeImage(ImageComponents::getRGBAComponents(), eImageBitDepthFloat, bounds, 5);
+        _dst = makeImage( ImageComponents::getRGBAComponents(), eImageBitDepthFloat, RectI(0, 0, kWidth / 2, kHeight / 2), 6 );
+        setItemsPerIteration( bounds.area() );
+        setBytesPerIteration( (U64)bounds.area() * 4 * sizeof(float) );
+    }
+
+    virtual void run() OVERRIDE FINAL
+    {
+        _src->halveRoI(_src->getBounds(), false, _dst.get() );
+    }
+
+    virtual void tearDown() OVERRIDE FINAL
+    {
+        _src.reset();
+        _dst.reset();
+    }
+};
+
+class PasteFromBenchmark
+    : public Benchmark
+{
+    ImagePtr _src, _dst;
+    RectI _roi;
+
+public:
+
+    PasteFromBenchmark()
+        : Benchmark("Image", "pasteFrom_RGBAFloat")
+        , _roi(256, 128, 256 + 1024, 128 + 768)
+    {
+    }
+
+    virtual void setUp() OVERRIDE FINAL
+    {
+        RectI bounds(0, 0, kWidth, kHeight);
+
+        _src = makeImage(ImageComponents::getRGBAComponents(), eImageBitDepthFloat, bounds, 7);
+        _dst = makeImage(ImageComponents::getRGBAComponents(), eImageBitDepthFloat, bounds, 8);
+        setItemsPerIteration( _roi.area() );
+        setBytesPerIteration( (U64)_roi.area() * 4 * sizeof(float) );
+    }
+
+    virtual void run() OVERRIDE FINAL
+    {
+        _dst->pasteFrom(*_src, _roi, false);
+    }
+
+    virtual void tearDown() OVERRIDE FINAL
+    {
+        _src.reset();
+        _dst.reset();
+    }
+};
+
+const char*
+depthName(ImageBitDepthEnum depth)
+{
+    switch (depth) {
+    case eImageBitDepthByte:
+
+        return "Byte";
+    case eImageBitDepthShort:
+
+        return "Short";
+    default:
+
+        return "Float";
+    }
+}
+
+template <ImageBitDepthEnum depth>
+class ApplyMaskMixBenchmark
+    : public Benchmark
+{
+    ImagePtr _img, _mask, _original;
+
+public:
+
+    ApplyMaskMixBenchmark()
+        : Benchmark( "Image", std::string("applyMaskMix_RGBA") + depthName(depth) )
+    {
+    }
+
+    virtual void setUp() OVERRIDE FINAL
+    {
+        RectI bounds(0, 0, kWidth, kHeight);
+
+        _img = makeImage(ImageComponents::getRGBAComponents(), depth, bounds, 9);
+        _mask = makeImage(ImageComponents::getAlphaComponents(), depth, bounds, 10);
+        _original = makeImage(ImageComponents::getRGBAComponents(), depth, bounds, 11);
+        setItemsPerIteration( bounds.area() );
+        setBytesPerIteration( (U64)bounds.area() * 4 * getSizeOfForBitDepth(depth) );
+    }
+
+    virtual void run() OVERRIDE FINAL
+    {
+        _img->applyMaskMix(_img->getBounds(), _mask.get(), _original.get(), true, false, 0.5f);
+    }
+
+    virtual void tearDown() OVERRIDE FINAL
+    {
+        _img.reset();
+        _mask.reset();
+        _original.reset();
+    }
+};
+
+typedef ApplyMaskMixBenchmark<eImageBitDepthFloat> ApplyMaskMixFloatBenchmark;
+typedef ApplyMaskMixBenchmark<eImageBitDepthByte> ApplyMaskMixByteBenchmark;
+
+// The alpha of the output was processed, RGB are copied from the original image
+template <ImageBitDepthEnum depth>
+class CopyUnProcessedChannelsBenchmark
+    : public Benchmark
+{
+    ImagePtr _img, _original;
+
+public:
+
+    CopyUnProcessedChannelsBenchmark()
+        : Benchmark( "Image", std::string("copyUnProcessedChannels_RGBA") + depthName(depth) )
+    {
+    }
+
+    virtual void setUp() OVERRIDE FINAL
+    {
+        RectI bounds(0, 0, kWidth, kHeight);
+
+        _img = makeImage(ImageComponents::getRGBAComponents(), depth, bounds, 12);
+        _original = makeImage(ImageComponents::getRGBAComponents(), depth, bounds, 13);
+        setItemsPerIteration( bounds.area() );
+        setBytesPerIteration( (U64)bounds.area() * 4 * getSizeOfForBitDepth(depth) );
+    }
+
+    virtual void run() OVERRIDE FINAL
+    {
+        std::bitset<4> processChannels;
+
+        processChannels[3] = true;
+        _img->copyUnProcessedChannels(_img->getBounds(), eImagePremultiplicationPremultiplied, eImagePremultiplicationPremultiplied,
+                                      processChannels, _original, false);
+    }
+
+    virtual void tearDown() OVERRIDE FINAL
+    {
+        _img.reset();
+        _original.reset();
+    }
+};
+
+typedef CopyUnProcessedChannelsBenchmark<eImageBitDepthFloat> CopyUnProcessedChannelsFloatBenchmark;
+typedef CopyUnProcessedChannelsBenchmark<eImageBitDepthByte> CopyUnProcessedChannelsByteBenchmark;
+
+// One unpremultiplication followed by one premultiplication, as done around color corrections
+class UnpremultPremultBenchmark
+    : public Benchmark
+{
+    ImagePtr _img;
+
+public:
+
+    UnpremultPremultBenchmark()
+        : Benchmark("Image", "unpremultPremult_RGBAFloat")
+    {
+    }
+
+    virtual void setUp() OVERRIDE FINAL
+    {
+        RectI bounds(0, 0, kWidth, kHeight);
+
+        _img = makeImage(ImageComponents::getRGBAComponents(), eImageBitDepthFloat, bounds, 14);
+        setItemsPerIteration( bounds.area() );
+        setBytesPerIteration( (U64)bounds.area() * 4 * sizeof(float) );
+    }
+
+    virtual void run() OVERRIDE FINAL
+    {
+        _img->unpremultImage( _img->getBounds() );
+        _img->premultImage( _img->getBounds() );
+    }
+
+    virtual void tearDown() OVERRIDE FINAL
+    {
+        _img.reset();
+    }
+};
+
+// A 2K bitmap where 64x64 blocks are randomly rendered, as happens when several threads render tiles of the same image
+void
+markRandomBlocks(Bitmap* bitmap,
+                 bool withPending)
+{
+    const RectI& bounds = bitmap->getBounds();
+    BenchmarkRandom random(12);
+
+    for (int y = bounds.y1; y < bounds.y2; y += 64) {
+        for (int x = bounds.x1; x < bounds.x2; x += 64) {
+            double r = random.nextDouble();
+            RectI block(x, y, x + 64, y + 64);
+            if (r < 0.7) {
+                bitmap->markForRendered(block);
+            }
+#if NATRON_ENABLE_TRIMAP
+            else if ( withPending && (r < 0.8) ) {
+                bitmap->markForRendering(block);
+            }
+#else
+            Q_UNUSED(withPending);
+#endif
+        }
+    }
+}
+
+class BitmapNonMarkedRectsBenchmark
+    : public Benchmark
+{
+    Bitmap _bitmap;
+
+public:
+
+    BitmapNonMarkedRectsBenchmark()
+        : Benchmark("Bitmap", "minimalNonMarkedRects")
+        , _bitmap()
+    {
+    }
+
+    virtual void setUp() OVERRIDE FINAL
+    {
+        _bitmap.initialize( RectI(0, 0, 2048, 2048) );
+        markRandomBlocks(&_bitmap, false);
+        setItemsPerIteration( _bitmap.getBounds().area() );
+    }
+
+    virtual void run() OVERRIDE FINAL
+    {
+        std::list<RectI> rects;
+
+        _bitmap.minimalNonMarkedRects(_bitmap.getBounds(), rects);
+    }
+};
+
+#if NATRON_ENABLE_TRIMAP
+class BitmapNonMarkedRectsTrimapBenchmark
+    : public Benchmark
+{
+    Bitmap _bitmap;
+
+public:
+
+    BitmapNonMarkedRectsTrimapBenchmark()
+        : Benchmark("Bitmap", "minimalNonMarkedRects_trimap")
+        , _bitmap()
+    {
+    }
+
+    virtual void setUp() OVERRIDE FINAL
+    {
+        _bitmap.initialize( RectI(0, 0, 2048, 2048) );
+        markRandomBlocks(&_bitmap, true);
+        setItemsPerIteration( _bitmap.getBounds().area() );
+    }
+
+    virtual void run() OVERRIDE FINAL
+    {
+        std::list<RectI> rects;
+        bool isBeingRenderedElsewhere = false;
+
+        _bitmap.minimalNonMarkedRects_trimap(_bitmap.getBounds(), rects, &isBeingRenderedElsewhere);
+    }
+};
+#endif
+
+class BitmapNonMarkedBboxBenchmark
+    : public Benchmark
+{
+    Bitmap _bitmap;
+
+public:
+
+    BitmapNonMarkedBboxBenchmark()
+        : Benchmark("Bitmap", "minimalNonMarkedBbox")
+        , _bitmap()
+    {
+    }
+
+    virtual void setUp() OVERRIDE FINAL
+    {
+        _bitmap.initialize( RectI(0, 0, 2048, 2048) );
+        markRandomBlocks(&_bitmap, false);
+        setItemsPerIteration( _bitmap.getBounds().area() );
+    }
+
+    virtual void run() OVERRIDE FINAL
+    {
+        RectI bbox = _bitmap.minimalNonMarkedBbox( _bitmap.getBounds() );
+
+        Q_UNUSED(bbox);
+    }
+};
+
+NATRON_NAMESPACE_ANONYMOUS_EXIT
+
+NATRON_BENCHMARK(ConvertToByteBenchmark);
+NATRON_BENCHMARK(ConvertToAlphaBenchmark);
+NATRON_BENCHMARK(HalveRoIBenchmark);
+NATRON_BENCHMARK(PasteFromBenchmark);
+NATRON_BENCHMARK(ApplyMaskMixFloatBenchmark);
+NATRON_BENCHMARK(ApplyMaskMixByteBenchmark);
+NATRON_BENCHMARK(CopyUnProcessedChannelsFloatBenchmark);
+NATRON_BENCHMARK(CopyUnProcessedChannelsByteBenchmark);
+NATRON_BENCHMARK(UnpremultPremultBenchmark);
+NATRON_BENCHMARK(BitmapNonMarkedRectsBenchmark);
+#if NATRON_ENABLE_TRIMAP
+NATRON_BENCHMARK(BitmapNonMarkedRectsTrimapBenchmark);
+#endif
+NATRON_BENCHMARK(BitmapNonMarkedBboxBenchmark);
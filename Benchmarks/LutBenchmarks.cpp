@@ -0,0 +1,165 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <http://www.natron.fr/>,
+ * Copyright (C) 2016 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "Global/Macros.h"
+
+#include <vector>
+
+#include "Engine/Lut.h"
+#include "Engine/RectI.h"
+
+#include "Benchmark.h"
+
+NATRON_NAMESPACE_USING
+
+NATRON_NAMESPACE_ANONYMOUS_ENTER
+
+// Conversions of a packed RGBA HD frame, as done by the readers, the writers and the viewer
+const int kWidth = 1920;
+const int kHeight = 1080;
+
+enum LutConversionEnum
+{
+    eLutConversionToBytePacked = 0,
+    eLutConversionFromBytePacked,
+    eLutConversionFromShortPacked,
+    eLutConversionLinearFromBytePacked,
+    eLutConversionLinearFromShortPacked,
+    eLutConversionToColorSpaceFloat
+};
+
+const char*
+getLutConversionName(LutConversionEnum conversion)
+{
+    switch (conversion) {
+    case eLutConversionToBytePacked:
+        return "sRGB_to_byte_packed";
+    case eLutConversionFromBytePacked:
+        return "sRGB_from_byte_packed";
+    case eLutConversionFromShortPacked:
+        return "sRGB_from_short_packed";
+    case eLutConversionLinearFromBytePacked:
+        return "Linear_from_byte_packed";
+    case eLutConversionLinearFromShortPacked:
+        return "Linear_from_short_packed";
+    case eLutConversionToColorSpaceFloat:
+        return "sRGB_toColorSpaceFloatFromLinearFloat";
+    }
+
+    return "";
+}
+
+template <LutConversionEnum conversion>
+class LutBenchmark
+    : public Benchmark
+{
+    const Color::Lut* _lut;
+    RectI _rect;
+    std::vector<float> _floats;
+    std::vector<unsigned char> _bytes;
+    std::vector<unsigned short> _shorts;
+
+public:
+
+    LutBenchmark()
+        : Benchmark( "Lut", getLutConversionName(conversion) )
+        , _lut(0)
+        , _rect(0, 0, kWidth, kHeight)
+        , _floats()
+        , _bytes()
+        , _shorts()
+    {
+    }
+
+    virtual void setUp() OVERRIDE FINAL
+    {
+        std::size_t nElements = (std::size_t)_rect.area() * 4;
+        BenchmarkRandom random(conversion + 1);
+
+        // The table is built eagerly, not on the first conversion
+        _lut = Color::LutManager::sRGBLut();
+        _floats.resize(nElements);
+        _bytes.resize(nElements);
+        _shorts.resize(nElements);
+        for (std::size_t i = 0; i < nElements; ++i) {
+            U32 r = random.next();
+            _floats[i] = (r & 0xffff) / 65535.f;
+            _bytes[i] = (unsigned char)(r >> 24);
+            _shorts[i] = (unsigned short)(r >> 16);
+        }
+        setItemsPerIteration( _rect.area() );
+        setBytesPerIteration( (U64)nElements * sizeof(float) );
+    }
+
+    virtual void run() OVERRIDE FINAL
+    {
+        switch (conversion) {
+        case eLutConversionToBytePacked:
+            _lut->to_byte_packed(&_bytes[0], &_floats[0], _rect, _rect, _rect, Color::ePixelPackingRGBA, Color::ePixelPackingRGBA, false, false);
+            break;
+        case eLutConversionFromBytePacked:
+            _lut->from_byte_packed(&_floats[0], &_bytes[0], _rect, _rect, _rect, Color::ePixelPackingRGBA, Color::ePixelPackingRGBA, false, false);
+            break;
+        case eLutConversionFromShortPacked:
+            _lut->from_short_packed(&_floats[0], &_shorts[0], _rect, _rect, _rect, Color::ePixelPackingRGBA, Color::ePixelPackingRGBA, false, false);
+            break;
+        case eLutConversionLinearFromBytePacked:
+            Color::Linear::from_byte_packed(&_floats[0], &_bytes[0], _rect, _rect, _rect, Color::ePixelPackingRGBA, Color::ePixelPackingRGBA, false);
+            break;
+        case eLutConversionLinearFromShortPacked:
+            Color::Linear::from_short_packed(&_floats[0], &_shorts[0], _rect, _rect, _rect, Color::ePixelPackingRGBA, Color::ePixelPackingRGBA, false);
+            break;
+        case eLutConversionToColorSpaceFloat: {
+            float* p = &_floats[0];
+            for (std::size_t i = 0; i < _floats.size(); ++i) {
+                p[i] = _lut->toColorSpaceFloatFromLinearFloat(p[i]);
+            }
+            break;
+        }
+        }
+    }
+
+    virtual void tearDown() OVERRIDE FINAL
+    {
+        _floats.clear();
+        _bytes.clear();
+        _shorts.clear();
+    }
+};
+
+typedef LutBenchmark<eLutConversionToBytePacked> LutToBytePackedBenchmark;
+typedef LutBenchmark<eLutConversionFromBytePacked> LutFromBytePackedBenchmark;
+typedef LutBenchmark<eLutConversionFromShortPacked> LutFromShortPackedBenchmark;
+typedef LutBenchmark<eLutConversionLinearFromBytePacked> LinearFromBytePackedBenchmark;
+typedef LutBenchmark<eLutConversionLinearFromShortPacked> LinearFromShortPackedBenchmark;
+typedef LutBenchmark<eLutConversionToColorSpaceFloat> LutToColorSpaceFloatBenchmark;
+
+NATRON_NAMESPACE_ANONYMOUS_EXIT
+
+NATRON_BENCHMARK(LutToBytePackedBenchmark);
+NATRON_BENCHMARK(LutFromBytePackedBenchmark);
+NATRON_BENCHMARK(LutFromShortPackedBenchmark);
+NATRON_BENCHMARK(LinearFromBytePackedBenchmark);
+NATRON_BENCHMARK(LinearFromShortPackedBenchmark);
+NATRON_BENCHMARK(LutToColorSpaceFloatBenchmark);
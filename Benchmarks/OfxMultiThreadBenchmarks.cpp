@@ -0,0 +1,263 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <http://www.natron.fr/>,
+ * Copyright (C) 2016 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "Global/Macros.h"
+
+#include <algorithm> // min
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+CLANG_DIAG_OFF(deprecated)
+#include <QtCore/QThread>
+#include <QtConcurrentMap> // QtCore on Qt4, QtConcurrent on Qt5
+CLANG_DIAG_ON(deprecated)
+
+#include "Engine/AppManager.h"
+#include "Engine/OfxHost.h"
+
+#include "Benchmark.h"
+
+NATRON_NAMESPACE_USING
+
+NATRON_NAMESPACE_ANONYMOUS_ENTER
+
+/**
+ * @brief How the synthetic plug-in calls the multi-thread suite: through the host, or through the
+ * implementation the host had before the MultiThreadExecutor.
+ **/
+typedef OfxStatus (*MultiThreadFunc)(OfxThreadFunctionV1 func, unsigned int nThreads, void* customArg);
+
+OfxStatus
+referenceThreadFunctionWrapper(OfxThreadFunctionV1 func,
+                               unsigned int threadIndex,
+                               unsigned int threadMax,
+                               QThread* spawnerThread,
+                               void* customArg)
+{
+    OfxHost::OfxHostDataTLSPtr tls = appPTR->getOFXHost()->getTLSData();
+
+    tls->threadIndexes.push_back( (int)threadIndex );
+
+    QThread* spawnedThread = QThread::currentThread();
+    if (spawnedThread != spawnerThread) {
+        appPTR->getAppTLS()->softCopy(spawnerThread, spawnedThread);
+    }
+    func(threadIndex, threadMax, customArg);
+    tls->threadIndexes.pop_back();
+    if (spawnedThread != spawnerThread) {
+        appPTR->getAppTLS()->cleanupTLSForThread();
+    }
+
+    return kOfxStatOK;
+}
+
+struct ReferenceThreadFunction
+{
+    typedef OfxStatus result_type;
+
+    OfxThreadFunctionV1* func;
+    unsigned int threadMax;
+    QThread* spawnerThread;
+    void* customArg;
+
+    OfxStatus operator()(unsigned int threadIndex) const
+    {
+        return referenceThreadFunctionWrapper(func, threadIndex, threadMax, spawnerThread, customArg);
+    }
+};
+
+/**
+ * @brief The thread-pool path of OfxHost::multiThread before the MultiThreadExecutor: the indices are mapped on the
+ * global thread pool and the calling thread waits for them. Kept here as the reference the executor is compared to.
+ **/
+OfxStatus
+referenceMultiThread(OfxThreadFunctionV1 func,
+                     unsigned int nThreads,
+                     void* customArg)
+{
+    std::vector<unsigned int> threadIndexes(nThreads);
+
+    for (unsigned int i = 0; i < nThreads; ++i) {
+        threadIndexes[i] = i;
+    }
+    ReferenceThreadFunction f;
+    f.func = func;
+    f.threadMax = nThreads;
+    f.spawnerThread = QThread::currentThread();
+    f.customArg = customArg;
+    QFuture<OfxStatus> future = QtConcurrent::mapped(threadIndexes, f);
+    future.waitForFinished();
+    for (QFuture<OfxStatus>::const_iterator it = future.begin(); it != future.end(); ++it) {
+        if (*it != kOfxStatOK) {
+            return *it;
+        }
+    }
+
+    return kOfxStatOK;
+}
+
+OfxStatus
+hostMultiThread(OfxThreadFunctionV1 func,
+                unsigned int nThreads,
+                void* customArg)
+{
+    // The suite is not const, but the host does not change
+    return const_cast<OfxHost*>( appPTR->getOFXHost() )->multiThread(func, nThreads, customArg);
+}
+
+unsigned int
+getNumCPUs()
+{
+    unsigned int nCPUs = 1;
+
+    appPTR->getOFXHost()->multiThreadNumCPUS(&nCPUs);
+
+    return nCPUs;
+}
+
+/**
+ * @brief The image processed by the synthetic plug-in, one float per pixel
+ **/
+struct SyntheticRender
+{
+    MultiThreadFunc multiThread;
+    float* pixels;
+    int width;
+    int y1, y2;
+    int nestedLevels;
+};
+
+/**
+ * @brief The thread function of the synthetic plug-in: like the processors of the OpenFX support library, index i
+ * processes the i-th band of rows. If nestedLevels is not 0, the band is split again with a nested call, as a
+ * plug-in rendering an input from its own thread function does.
+ **/
+void
+syntheticRenderThreadFunction(unsigned int threadIndex,
+                              unsigned int threadMax,
+                              void* customArg)
+{
+    const SyntheticRender* render = (const SyntheticRender*)customArg;
+    int nRows = render->y2 - render->y1;
+    int y1 = render->y1 + (int)( (long long)nRows * threadIndex / threadMax );
+    int y2 = render->y1 + (int)( (long long)nRows * (threadIndex + 1) / threadMax );
+
+    if (render->nestedLevels > 0) {
+        SyntheticRender band = *render;
+        band.y1 = y1;
+        band.y2 = y2;
+        --band.nestedLevels;
+        unsigned int nThreads = std::min( getNumCPUs(), (unsigned int)std::max(1, y2 - y1) );
+        band.multiThread(syntheticRenderThreadFunction, nThreads, &band);
+
+        return;
+    }
+    for (int y = y1; y < y2; ++y) {
+        float* pix = render->pixels + (std::size_t)y * render->width;
+        for (int x = 0; x < render->width; ++x) {
+            pix[x] = std::sqrt(pix[x] * 0.5f + 0.25f);
+        }
+    }
+}
+
+std::string
+makeOfxMultiThreadBenchmarkName(bool reference,
+                                int size,
+                                int nestedLevels)
+{
+    char name[64];
+
+    snprintf(name, sizeof(name), "%s_%dx%d_nested%d", reference ? "mapped" : "executor", size, size, nestedLevels);
+
+    return name;
+}
+
+/**
+ * @brief Renders a size x size image with a synthetic plug-in that splits its render action in as many indices as
+ * multiThreadNumCPUS returns, as most plug-ins do. Small sizes measure the cost of a multiThread call itself
+ * (render actions on small tiles are common), and nested calls measure what happens when the thread functions
+ * call the suite again. The "mapped" version is the thread-pool path the host had before the MultiThreadExecutor.
+ **/
+template <bool reference, int size, int nestedLevels>
+class OfxMultiThreadBenchmark
+    : public Benchmark
+{
+    std::vector<float> _pixels;
+
+public:
+
+    OfxMultiThreadBenchmark()
+        : Benchmark( "OfxMultiThread", makeOfxMultiThreadBenchmarkName(reference, size, nestedLevels) )
+        , _pixels()
+    {
+    }
+
+    virtual void setUp() OVERRIDE FINAL
+    {
+        BenchmarkRandom random(size);
+
+        _pixels.resize(size * size);
+        for (std::size_t i = 0; i < _pixels.size(); ++i) {
+            _pixels[i] = (float)random.nextDouble();
+        }
+        setItemsPerIteration(size * size);
+        setCounter( "numCPUs", (double)getNumCPUs() );
+    }
+
+    virtual void run() OVERRIDE FINAL
+    {
+        SyntheticRender render;
+
+        render.multiThread = reference ? referenceMultiThread : hostMultiThread;
+        render.pixels = &_pixels.front();
+        render.width = size;
+        render.y1 = 0;
+        render.y2 = size;
+        render.nestedLevels = nestedLevels;
+        render.multiThread(syntheticRenderThreadFunction, getNumCPUs(), &render);
+    }
+
+    virtual void tearDown() OVERRIDE FINAL
+    {
+        _pixels.clear();
+    }
+};
+
+typedef OfxMultiThreadBenchmark<true, 64, 0> OfxMultiThreadMapped64Benchmark;
+typedef OfxMultiThreadBenchmark<false, 64, 0> OfxMultiThreadExecutor64Benchmark;
+typedef OfxMultiThreadBenchmark<true, 2048, 0> OfxMultiThreadMapped2048Benchmark;
+typedef OfxMultiThreadBenchmark<false, 2048, 0> OfxMultiThreadExecutor2048Benchmark;
+typedef OfxMultiThreadBenchmark<true, 2048, 1> OfxMultiThreadMappedNested2048Benchmark;
+typedef OfxMultiThreadBenchmark<false, 2048, 1> OfxMultiThreadExecutorNested2048Benchmark;
+
+NATRON_NAMESPACE_ANONYMOUS_EXIT
+
+NATRON_BENCHMARK(OfxMultiThreadMapped64Benchmark);
+NATRON_BENCHMARK(OfxMultiThreadExecutor64Benchmark);
+NATRON_BENCHMARK(OfxMultiThreadMapped2048Benchmark);
+NATRON_BENCHMARK(OfxMultiThreadExecutor2048Benchmark);
+NATRON_BENCHMARK(OfxMultiThreadMappedNested2048Benchmark);
+NATRON_BENCHMARK(OfxMultiThreadExecutorNested2048Benchmark);
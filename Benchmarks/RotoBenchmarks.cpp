@@ -0,0 +1,186 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <http://www.natron.fr/>,
+ * Copyright (C) 2016 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "Global/Macros.h"
+
+#include <cmath>
+#include <vector>
+
+#if !defined(Q_MOC_RUN) && !defined(SBK_RUN)
+#include <boost/scoped_ptr.hpp>
+#endif
+
+#ifdef ROTO_SHAPE_RENDER_ENABLE_CAIRO
+#include <cairo/cairo.h>
+#endif
+
+#include "Engine/RectI.h"
+#include "Engine/RotoBezierTriangulation.h"
+#include "Engine/RotoShapeRenderCPU.h"
+#ifdef ROTO_SHAPE_RENDER_ENABLE_CAIRO
+#include "Engine/RotoShapeRenderCairo.h"
+#endif
+
+#include "Benchmark.h"
+
+#ifndef M_PI
+#define M_PI        3.14159265358979323846264338327950288   /* pi             */
+#endif
+
+NATRON_NAMESPACE_USING
+
+NATRON_NAMESPACE_ANONYMOUS_ENTER
+
+// A feathered disc discretized with as many points as a typical bezier shape, covering most of the RoI
+const int kRoISize = 1024;
+const int kNVertices = 512;
+
+void
+makeFeatheredPolygon(double cx,
+                     double cy,
+                     double radius,
+                     double feather,
+                     int nVertices,
+                     RotoBezierTriangulation::PolygonData* data)
+{
+    RotoBezierTriangulation::RotoTriangleFans fan;
+
+    for (int i = 0; i < nVertices; ++i) {
+        double a = 2. * M_PI * i / nVertices;
+        ParametricPoint p;
+        p.x = cx + radius * std::cos(a);
+        p.y = cy + radius * std::sin(a);
+        p.t = 0.;
+        data->bezierPolygonJoined.push_back(p);
+        fan.indices.push_back(i);
+    }
+    data->internalFans.push_back(fan);
+
+    for (int i = 0; i < nVertices; ++i) {
+        double a = 2. * M_PI * i / nVertices;
+        double b = 2. * M_PI * (i + 1) / nVertices;
+        RotoBezierTriangulation::RotoFeatherVertex innerA = { cx + radius * std::cos(a), cy + radius * std::sin(a), true };
+        RotoBezierTriangulation::RotoFeatherVertex outerA = { cx + (radius + feather) * std::cos(a), cy + (radius + feather) * std::sin(a), false };
+        RotoBezierTriangulation::RotoFeatherVertex innerB = { cx + radius * std::cos(b), cy + radius * std::sin(b), true };
+        RotoBezierTriangulation::RotoFeatherVertex outerB = { cx + (radius + feather) * std::cos(b), cy + (radius + feather) * std::sin(b), false };
+        data->featherMesh.push_back(innerA);
+        data->featherMesh.push_back(outerA);
+        data->featherMesh.push_back(innerB);
+        data->featherMesh.push_back(outerA);
+        data->featherMesh.push_back(outerB);
+        data->featherMesh.push_back(innerB);
+    }
+}
+
+class RotoCoverageCPUBenchmark
+    : public Benchmark
+{
+    boost::scoped_ptr<RotoBezierTriangulation::PolygonData> _data;
+    RectI _roi;
+    std::vector<float> _coverage;
+
+public:
+
+    RotoCoverageCPUBenchmark()
+        : Benchmark("Roto", "renderCoverage_cpu_feathered")
+        , _data()
+        , _roi(0, 0, kRoISize, kRoISize)
+        , _coverage()
+    {
+    }
+
+    virtual void setUp() OVERRIDE FINAL
+    {
+        _data.reset(new RotoBezierTriangulation::PolygonData);
+        makeFeatheredPolygon(kRoISize / 2. + 0.3, kRoISize / 2. - 0.3, kRoISize * 0.4, kRoISize * 0.05, kNVertices, _data.get() );
+        _coverage.resize( _roi.area() );
+        setItemsPerIteration( _roi.area() );
+    }
+
+    virtual void run() OVERRIDE FINAL
+    {
+        RotoShapeRenderCPU::renderCoverage_cpu(*_data, 1., eRampTypeLinear, _roi, &_coverage[0]);
+    }
+
+    virtual void tearDown() OVERRIDE FINAL
+    {
+        _data.reset();
+        _coverage.clear();
+    }
+};
+
+#ifdef ROTO_SHAPE_RENDER_ENABLE_CAIRO
+// The same shape through the Cairo mesh pattern renderer, for comparison
+class RotoCoverageCairoBenchmark
+    : public Benchmark
+{
+    boost::scoped_ptr<RotoBezierTriangulation::PolygonData> _data;
+    cairo_surface_t* _surface;
+
+public:
+
+    RotoCoverageCairoBenchmark()
+        : Benchmark("Roto", "renderCoverage_cairo_feathered")
+        , _data()
+        , _surface(0)
+    {
+    }
+
+    virtual void setUp() OVERRIDE FINAL
+    {
+        _data.reset(new RotoBezierTriangulation::PolygonData);
+        makeFeatheredPolygon(kRoISize / 2. + 0.3, kRoISize / 2. - 0.3, kRoISize * 0.4, kRoISize * 0.05, kNVertices, _data.get() );
+        _surface = cairo_image_surface_create(CAIRO_FORMAT_A8, kRoISize, kRoISize);
+        setItemsPerIteration(kRoISize * kRoISize);
+    }
+
+    virtual void run() OVERRIDE FINAL
+    {
+        cairo_t* cr = cairo_create(_surface);
+
+        cairo_set_operator(cr, CAIRO_OPERATOR_OVER);
+        cairo_pattern_t* mesh = cairo_pattern_create_mesh();
+        double shapeColor[3] = {1., 1., 1.};
+        RotoShapeRenderCairo::renderFeather_cairo(*_data, shapeColor, 1., mesh);
+        RotoShapeRenderCairo::renderInternalShape_cairo(*_data, shapeColor, mesh);
+        RotoShapeRenderCairo::applyAndDestroyMask(cr, mesh);
+        cairo_surface_flush(_surface);
+        cairo_destroy(cr);
+    }
+
+    virtual void tearDown() OVERRIDE FINAL
+    {
+        cairo_surface_destroy(_surface);
+        _surface = 0;
+        _data.reset();
+    }
+};
+#endif // ROTO_SHAPE_RENDER_ENABLE_CAIRO
+
+NATRON_NAMESPACE_ANONYMOUS_EXIT
+
+NATRON_BENCHMARK(RotoCoverageCPUBenchmark);
+#ifdef ROTO_SHAPE_RENDER_ENABLE_CAIRO
+NATRON_BENCHMARK(RotoCoverageCairoBenchmark);
+#endif
@@ -0,0 +1,277 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <http://www.natron.fr/>,
+ * Copyright (C) 2016 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "Global/Macros.h"
+
+#include <cassert>
+#include <cstdio>
+#include <map>
+#include <string>
+#include <vector>
+
+#if !defined(Q_MOC_RUN) && !defined(SBK_RUN)
+#include <boost/shared_ptr.hpp>
+#endif
+
+CLANG_DIAG_OFF(deprecated)
+#include <QtCore/QAtomicInt>
+#include <QtCore/QReadWriteLock>
+#include <QtCore/QThread>
+CLANG_DIAG_ON(deprecated)
+
+#include "Engine/AppManager.h"
+#include "Engine/Knob.h"
+#include "Engine/TLSHolder.h"
+
+#include "Benchmark.h"
+
+NATRON_NAMESPACE_USING
+
+NATRON_NAMESPACE_ANONYMOUS_ENTER
+
+// Each thread reads the TLS of kHolders holders (e.g: the knobs of a node) kLookupsPerThread times
+const int kHolders = 64;
+const int kLookupsPerThread = 16384;
+
+typedef KnobHelper::KnobTLSData BenchmarkTLSData;
+typedef std::map<const QThread*, const QThread*> SpawnsMap;
+
+/**
+ * @brief The thread-local storage as it was implemented before the per-thread slots: every holder maps
+ * the threads to their data under a read-write lock, and every look-up first checks under another
+ * read-write lock whether the thread was spawned and must copy the TLS of its spawner.
+ * Kept here as the reference the slots are compared to.
+ **/
+class MapTLSHolder
+{
+    typedef std::map<const QThread*, boost::shared_ptr<BenchmarkTLSData> > ThreadDataMap;
+
+    QReadWriteLock* _spawnsMutex;
+    const SpawnsMap* _spawns;
+    mutable QReadWriteLock _perThreadDataMutex;
+    mutable ThreadDataMap _perThreadData;
+
+public:
+
+    MapTLSHolder(QReadWriteLock* spawnsMutex,
+                 const SpawnsMap* spawns)
+        : _spawnsMutex(spawnsMutex)
+        , _spawns(spawns)
+        , _perThreadDataMutex()
+        , _perThreadData()
+    {
+    }
+
+    boost::shared_ptr<BenchmarkTLSData> getOrCreateTLSData() const
+    {
+        QThread* curThread = QThread::currentThread();
+        {
+            QReadLocker k(_spawnsMutex);
+            if ( _spawns->find(curThread) != _spawns->end() ) {
+                // the TLS of the spawner thread would be copied here, but the benchmark threads are not spawned
+                assert(false);
+            }
+        }
+        {
+            QReadLocker k(&_perThreadDataMutex);
+            ThreadDataMap::const_iterator found = _perThreadData.find(curThread);
+            if ( found != _perThreadData.end() ) {
+                return found->second;
+            }
+        }
+        boost::shared_ptr<BenchmarkTLSData> data(new BenchmarkTLSData);
+        QWriteLocker k(&_perThreadDataMutex);
+        _perThreadData.insert( std::make_pair(curThread, data) );
+
+        return data;
+    }
+
+    void cleanupPerThreadData() const
+    {
+        QWriteLocker k(&_perThreadDataMutex);
+
+        _perThreadData.erase( QThread::currentThread() );
+    }
+};
+
+/**
+ * @brief How to create the holders and clean-up the TLS of a thread with each implementation.
+ **/
+template <typename HOLDER>
+struct TLSHolderTraits;
+
+template <>
+struct TLSHolderTraits<MapTLSHolder>
+{
+    static const char* name()
+    {
+        return "map";
+    }
+
+    static MapTLSHolder* create(QReadWriteLock* spawnsMutex,
+                                const SpawnsMap* spawns)
+    {
+        return new MapTLSHolder(spawnsMutex, spawns);
+    }
+
+    static void cleanupTLSForThread(const std::vector<boost::shared_ptr<MapTLSHolder> >& holders)
+    {
+        for (std::size_t i = 0; i < holders.size(); ++i) {
+            holders[i]->cleanupPerThreadData();
+        }
+    }
+};
+
+template <>
+struct TLSHolderTraits<TLSHolder<BenchmarkTLSData> >
+{
+    static const char* name()
+    {
+        return "slots";
+    }
+
+    static TLSHolder<BenchmarkTLSData>* create(QReadWriteLock* /*spawnsMutex*/,
+                                               const SpawnsMap* /*spawns*/)
+    {
+        return new TLSHolder<BenchmarkTLSData>();
+    }
+
+    static void cleanupTLSForThread(const std::vector<boost::shared_ptr<TLSHolder<BenchmarkTLSData> > >& /*holders*/)
+    {
+        appPTR->getAppTLS()->cleanupTLSForThread();
+    }
+};
+
+template <typename HOLDER>
+class TLSWorker
+    : public QThread
+{
+    const std::vector<boost::shared_ptr<HOLDER> >* _holders;
+    QAtomicInt* _checksum;
+
+public:
+
+    TLSWorker(const std::vector<boost::shared_ptr<HOLDER> >* holders,
+              QAtomicInt* checksum)
+        : QThread()
+        , _holders(holders)
+        , _checksum(checksum)
+    {
+    }
+
+private:
+
+    virtual void run() OVERRIDE FINAL
+    {
+        int sum = 0;
+
+        for (int i = 0; i < kLookupsPerThread; ++i) {
+            sum += (*_holders)[i % kHolders]->getOrCreateTLSData()->expressionRecursionLevel + 1;
+        }
+        TLSHolderTraits<HOLDER>::cleanupTLSForThread(*_holders);
+        _checksum->fetchAndAddRelaxed(sum);
+    }
+};
+
+std::string
+makeTLSBenchmarkName(const char* implementation,
+                     int nThreads)
+{
+    char name[64];
+
+    snprintf(name, sizeof(name), "getOrCreateTLSData_%s_threads%d", implementation, nThreads);
+
+    return name;
+}
+
+/**
+ * @brief Several threads read the TLS of the same holders at the same time, as render threads do with the
+ * TLS of the effects, clips and parameters of the tree. The first look-up of each holder on a thread creates
+ * its data, the following ones only find it: this measures the look-up and the contention on the locks.
+ * The map version is the implementation TLSHolder had before the per-thread slots.
+ **/
+template <typename HOLDER, int nThreads>
+class TLSBenchmark
+    : public Benchmark
+{
+    QReadWriteLock _spawnsMutex;
+    SpawnsMap _spawns;
+    std::vector<boost::shared_ptr<HOLDER> > _holders;
+    QAtomicInt _checksum;
+
+public:
+
+    TLSBenchmark()
+        : Benchmark( "TLS", makeTLSBenchmarkName(TLSHolderTraits<HOLDER>::name(), nThreads) )
+        , _spawnsMutex()
+        , _spawns()
+        , _holders()
+        , _checksum(0)
+    {
+    }
+
+    virtual void setUp() OVERRIDE FINAL
+    {
+        _holders.resize(kHolders);
+        for (int i = 0; i < kHolders; ++i) {
+            _holders[i].reset( TLSHolderTraits<HOLDER>::create(&_spawnsMutex, &_spawns) );
+        }
+        setItemsPerIteration(nThreads * kLookupsPerThread);
+    }
+
+    virtual void run() OVERRIDE FINAL
+    {
+        std::vector<TLSWorker<HOLDER>*> workers(nThreads);
+
+        for (int i = 0; i < nThreads; ++i) {
+            workers[i] = new TLSWorker<HOLDER>(&_holders, &_checksum);
+            workers[i]->start();
+        }
+        for (int i = 0; i < nThreads; ++i) {
+            workers[i]->wait();
+            delete workers[i];
+        }
+    }
+
+    virtual void tearDown() OVERRIDE FINAL
+    {
+        _holders.clear();
+    }
+};
+
+typedef TLSBenchmark<MapTLSHolder, 1> TLSMap1Benchmark;
+typedef TLSBenchmark<MapTLSHolder, 4> TLSMap4Benchmark;
+typedef TLSBenchmark<MapTLSHolder, 16> TLSMap16Benchmark;
+typedef TLSBenchmark<TLSHolder<BenchmarkTLSData>, 1> TLSSlots1Benchmark;
+typedef TLSBenchmark<TLSHolder<BenchmarkTLSData>, 4> TLSSlots4Benchmark;
+typedef TLSBenchmark<TLSHolder<BenchmarkTLSData>, 16> TLSSlots16Benchmark;
+
+NATRON_NAMESPACE_ANONYMOUS_EXIT
+
+NATRON_BENCHMARK(TLSMap1Benchmark);
+NATRON_BENCHMARK(TLSMap4Benchmark);
+NATRON_BENCHMARK(TLSMap16Benchmark);
+NATRON_BENCHMARK(TLSSlots1Benchmark);
+NATRON_BENCHMARK(TLSSlots4Benchmark);
+NATRON_BENCHMARK(TLSSlots16Benchmark);
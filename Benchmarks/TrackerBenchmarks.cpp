@@ -0,0 +1,152 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <http://www.natron.fr/>,
+ * Copyright (C) 2016 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "Global/Macros.h"
+
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "Engine/RectD.h"
+#include "Engine/TrackerContextPrivate.h"
+
+#include "Benchmark.h"
+
+NATRON_NAMESPACE_USING
+
+NATRON_NAMESPACE_ANONYMOUS_ENTER
+
+const int kNKeyframes = 256;
+
+std::string
+makeTrackerSolverBenchmarkName(bool cornerPin,
+                               int nTracks,
+                               int jitterPeriod)
+{
+    char name[64];
+
+    snprintf(name, sizeof(name), "%s_tracks%d_jitter%d", cornerPin ? "cornerPin" : "transform", nTracks, jitterPeriod);
+
+    return name;
+}
+
+/**
+ * @brief Solves kNKeyframes keyframes of one solver batch of nTracks noisy tracks following a rotation and a scale,
+ * as one thread does when the Tracker node computes its Transform or CornerPin from the tracks.
+ * The marker data is already extracted: this measures building the sorted correspondences from the batch arrays
+ * and the robust model search.
+ **/
+template <bool cornerPin, int nTracks, int jitterPeriod>
+class TrackerSolverBenchmark
+    : public Benchmark
+{
+    TrackerContextPrivate::SolverBatch _batch;
+    std::vector<Point> _refPoints;
+    std::vector<Point> _x1, _x2;
+    int _nValid;
+
+public:
+
+    TrackerSolverBenchmark()
+        : Benchmark( "TrackerSolver", makeTrackerSolverBenchmarkName(cornerPin, nTracks, jitterPeriod) )
+        , _batch()
+        , _refPoints()
+        , _x1()
+        , _x2()
+        , _nValid(0)
+    {
+    }
+
+    virtual void setUp() OVERRIDE FINAL
+    {
+        BenchmarkRandom random(nTracks);
+        const int halfJitter = jitterPeriod > 1 ? jitterPeriod / 2 : 0;
+
+        _batch = TrackerContextPrivate::SolverBatch();
+        for (int k = 1; k <= kNKeyframes; ++k) {
+            _batch.keyframes.push_back(k);
+        }
+        for (int t = 1 - halfJitter; t <= kNKeyframes + halfJitter; ++t) {
+            _batch.sampleTimes.push_back(t);
+        }
+
+        const std::size_t nSamples = _batch.sampleTimes.size();
+        _refPoints.resize(nTracks);
+        _batch.centers.resize(nTracks * nSamples);
+        _batch.errors.resize(nTracks * kNKeyframes);
+        _batch.used.resize(nTracks * kNKeyframes);
+        for (int m = 0; m < nTracks; ++m) {
+            _refPoints[m].x = 100. + random.nextDouble() * 1720.;
+            _refPoints[m].y = 100. + random.nextDouble() * 880.;
+            for (std::size_t s = 0; s < nSamples; ++s) {
+                const double t = _batch.sampleTimes[s];
+                const double angle = t * 0.001;
+                const double scale = 1. + t * 0.0005;
+                Point& p = _batch.centers[m * nSamples + s];
+                p.x = scale * (std::cos(angle) * _refPoints[m].x - std::sin(angle) * _refPoints[m].y) + t + random.nextDouble() - 0.5;
+                p.y = scale * (std::sin(angle) * _refPoints[m].x + std::cos(angle) * _refPoints[m].y) - t + random.nextDouble() - 0.5;
+            }
+            for (int k = 0; k < kNKeyframes; ++k) {
+                // Some tracks are lost along the way
+                _batch.used[m * kNKeyframes + k] = random.nextDouble() > 0.1;
+                _batch.errors[m * kNKeyframes + k] = random.nextDouble();
+            }
+        }
+        setItemsPerIteration(kNKeyframes);
+    }
+
+    virtual void run() OVERRIDE FINAL
+    {
+        const RectD rod(0, 0, 1920, 1080);
+
+        for (int k = 0; k < kNKeyframes; ++k) {
+            TrackerContextPrivate::makeSortedPointsFromSolverBatch(_batch, k, _refPoints, jitterPeriod, false, &_x1, &_x2);
+            if (cornerPin) {
+                _nValid += TrackerContextPrivate::computeCornerPinParamsFromPoints(0., _batch.keyframes[k], true, rod, rod, _x1, _x2).valid;
+            } else {
+                _nValid += TrackerContextPrivate::computeTransformParamsFromPoints(0., _batch.keyframes[k], true, rod, rod, _x1, _x2).valid;
+            }
+        }
+    }
+
+    virtual void tearDown() OVERRIDE FINAL
+    {
+        _batch = TrackerContextPrivate::SolverBatch();
+    }
+};
+
+typedef TrackerSolverBenchmark<false, 16, 0> TransformSolver16Benchmark;
+typedef TrackerSolverBenchmark<false, 256, 0> TransformSolver256Benchmark;
+typedef TrackerSolverBenchmark<false, 256, 5> TransformSolver256Jitter5Benchmark;
+typedef TrackerSolverBenchmark<true, 16, 0> CornerPinSolver16Benchmark;
+typedef TrackerSolverBenchmark<true, 256, 0> CornerPinSolver256Benchmark;
+
+NATRON_NAMESPACE_ANONYMOUS_EXIT
+
+NATRON_BENCHMARK(TransformSolver16Benchmark);
+NATRON_BENCHMARK(TransformSolver256Benchmark);
+NATRON_BENCHMARK(TransformSolver256Jitter5Benchmark);
+NATRON_BENCHMARK(CornerPinSolver16Benchmark);
+NATRON_BENCHMARK(CornerPinSolver256Benchmark);
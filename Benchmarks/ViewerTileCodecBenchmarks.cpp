@@ -0,0 +1,155 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <http://www.natron.fr/>,
+ * Copyright (C) 2016 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "Global/Macros.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "Engine/ViewerTileCodec.h"
+
+#include "Benchmark.h"
+
+NATRON_NAMESPACE_USING
+
+NATRON_NAMESPACE_ANONYMOUS_ENTER
+
+// Viewer tiles are 256x256 by default, and the playback cache holds HD frames made of 8x5 such tiles
+const int kTileSize = 256;
+const int kTilesPerHDFrame = 8 * 5;
+
+// A smooth gradient with some mild noise, similar to what a viewer tile of natural footage holds
+void
+makeTile(ImageBitDepthEnum depth,
+         std::vector<unsigned char>* pixels)
+{
+    BenchmarkRandom random(depth == eImageBitDepthFloat ? 2 : 1);
+
+    pixels->resize( ViewerTileCodec::getUncompressedSize(kTileSize, kTileSize, depth) );
+    for (int y = 0; y < kTileSize; ++y) {
+        for (int x = 0; x < kTileSize; ++x) {
+            for (int c = 0; c < 4; ++c) {
+                double v = c == 3 ? 1. : 0.5 + 0.4 * std::sin( (x + 2 * y) * 0.02 + c ) + ( random.nextDouble() - 0.5 ) * 0.02;
+                std::size_t i = (std::size_t)(y * kTileSize + x) * 4 + c;
+                if (depth == eImageBitDepthFloat) {
+                    float f = (float)v;
+                    std::memcpy(&(*pixels)[i * sizeof(float)], &f, sizeof(float));
+                } else {
+                    (*pixels)[i] = (unsigned char)(v * 255.);
+                }
+            }
+        }
+    }
+}
+
+std::string
+makeCodecBenchmarkName(bool encode,
+                       ImageBitDepthEnum depth,
+                       int ratio)
+{
+    char name[64];
+
+    snprintf(name, sizeof(name), "%s_%s_ratio%d", encode ? "encode" : "decode", depth == eImageBitDepthFloat ? "float" : "byte", ratio);
+
+    return name;
+}
+
+/**
+ * @brief Encodes (or decodes) a 256x256 RGBA tile into a slot of 1/ratio its size, as the playback cache does
+ * in compressed mode. The counters give the ratio that was actually needed and the number of HD frames
+ * that fit in 1 GiB of playback cache with and without compression.
+ **/
+template <bool encode, ImageBitDepthEnum depth, int ratio>
+class ViewerTileCodecBenchmark
+    : public Benchmark
+{
+    std::vector<unsigned char> _pixels, _encoded, _decoded;
+    std::size_t _encodedSize;
+
+public:
+
+    ViewerTileCodecBenchmark()
+        : Benchmark( "ViewerTileCodec", makeCodecBenchmarkName(encode, depth, ratio) )
+        , _pixels()
+        , _encoded()
+        , _decoded()
+        , _encodedSize(0)
+    {
+    }
+
+    virtual void setUp() OVERRIDE FINAL
+    {
+        makeTile(depth, &_pixels);
+        _encoded.resize(_pixels.size() / ratio);
+        _decoded.resize( _pixels.size() );
+        _encodedSize = ViewerTileCodec::encode(&_pixels[0], kTileSize, kTileSize, depth, &_encoded[0], _encoded.size());
+
+        double gib = 1024. * 1024. * 1024.;
+        setCounter("achievedRatio", _encodedSize ? (double)_pixels.size() / _encodedSize : 0.);
+        setCounter("lossless", _encodedSize && ViewerTileCodec::isLossless(&_encoded[0], _encodedSize) ? 1. : 0.);
+        setCounter( "framesPerGiB", gib / (kTilesPerHDFrame * _encoded.size()) );
+        setCounter( "framesPerGiBUncompressed", gib / (kTilesPerHDFrame * _pixels.size()) );
+        setItemsPerIteration(kTileSize * kTileSize);
+        setBytesPerIteration( _pixels.size() );
+    }
+
+    virtual void run() OVERRIDE FINAL
+    {
+        if (encode) {
+            _encodedSize = ViewerTileCodec::encode(&_pixels[0], kTileSize, kTileSize, depth, &_encoded[0], _encoded.size());
+        } else {
+            ViewerTileCodec::decode(&_encoded[0], _encodedSize, kTileSize, kTileSize, depth, &_decoded[0]);
+        }
+    }
+
+    virtual void tearDown() OVERRIDE FINAL
+    {
+        _pixels.clear();
+        _encoded.clear();
+        _decoded.clear();
+    }
+};
+
+typedef ViewerTileCodecBenchmark<true, eImageBitDepthByte, 2> EncodeByte2Benchmark;
+typedef ViewerTileCodecBenchmark<true, eImageBitDepthByte, 4> EncodeByte4Benchmark;
+typedef ViewerTileCodecBenchmark<true, eImageBitDepthFloat, 2> EncodeFloat2Benchmark;
+typedef ViewerTileCodecBenchmark<true, eImageBitDepthFloat, 4> EncodeFloat4Benchmark;
+typedef ViewerTileCodecBenchmark<false, eImageBitDepthByte, 2> DecodeByte2Benchmark;
+typedef ViewerTileCodecBenchmark<false, eImageBitDepthByte, 4> DecodeByte4Benchmark;
+typedef ViewerTileCodecBenchmark<false, eImageBitDepthFloat, 2> DecodeFloat2Benchmark;
+typedef ViewerTileCodecBenchmark<false, eImageBitDepthFloat, 4> DecodeFloat4Benchmark;
+
+NATRON_NAMESPACE_ANONYMOUS_EXIT
+
+NATRON_BENCHMARK(EncodeByte2Benchmark);
+NATRON_BENCHMARK(EncodeByte4Benchmark);
+NATRON_BENCHMARK(EncodeFloat2Benchmark);
+NATRON_BENCHMARK(EncodeFloat4Benchmark);
+NATRON_BENCHMARK(DecodeByte2Benchmark);
+NATRON_BENCHMARK(DecodeByte4Benchmark);
+NATRON_BENCHMARK(DecodeFloat2Benchmark);
+NATRON_BENCHMARK(DecodeFloat4Benchmark);
@@ -25,7 +25,9 @@
 #include "AppInstance.h"
 
 #include <fstream>
+#include <iostream>
 #include <list>
+#include <set>
 #include <cassert>
 #include <stdexcept>
 
@@ -53,9 +55,11 @@ GCC_DIAG_UNUSED_LOCAL_TYPEDEFS_ON
 #include "Engine/CLArgs.h"
 #include "Engine/CreateNodeArgs.h"
 #include "Engine/FileDownloader.h"
+#include "Engine/FStreamsSupport.h"
 #include "Engine/GroupOutput.h"
 #include "Engine/KnobTypes.h"
 #include "Engine/DiskCacheNode.h"
+#include "Engine/LocalRenderFarm.h"
 #include "Engine/ProjectSerialization.h"
 #include "Engine/Node.h"
 #include "Engine/NodeSerialization.h"
@@ -64,6 +68,7 @@ GCC_DIAG_UNUSED_LOCAL_TYPEDEFS_ON
 #include "Engine/Project.h"
 #include "Engine/ProcessHandler.h"
 #include "Engine/ReadNode.h"
+#include "Engine/RenderBenchmark.h"
 #include "Engine/RotoLayer.h"
 #include "Engine/Settings.h"
 #include "Engine/ViewerInstance.h"
@@ -165,6 +170,12 @@ public:
 
     ProjectBeingLoadedInfo projectBeingLoaded;
 
+    // Set while rendering with --workers, protected by renderQueueMutex
+    LocalRenderFarm* localRenderFarm;
+
+    // Set while rendering with --benchmark, protected by renderQueueMutex
+    RenderBenchmarkPtr renderBenchmark;
+
     AppInstancePrivate(int appID,
                        AppInstance* app)
 
@@ -183,6 +194,8 @@ public:
         , invalidExprKnobsMutex()
         , invalidExprKnobs()
         , projectBeingLoaded()
+        , localRenderFarm(0)
+        , renderBenchmark()
     {
     }
 
@@ -199,6 +212,10 @@ public:
     void getSequenceNameFromWriter(const OutputEffectInstancePtr& writer, QString* sequenceName);
 
     void startRenderingFullSequence(bool blocking, const RenderQueueItem& writerWork);
+
+    void renderWithLocalRenderFarm(const CLArgs& cl, const std::list<AppInstance::RenderWork>& writersWork);
+
+    void renderForBenchmark(const CLArgs& cl, const std::list<AppInstance::RenderWork>& writersWork);
 };
 
 AppInstance::AppInstance(int appID)
@@ -651,7 +668,11 @@ AppInstance::loadInternal(const CLArgs& cl,
         }
 
         ///launch renders
-        if ( !writersWork.empty() ) {
+        if (cl.getNumWorkers() > 0) {
+            _imp->renderWithLocalRenderFarm(cl, writersWork);
+        } else if (cl.getNumBenchmarkRuns() > 0) {
+            _imp->renderForBenchmark(cl, writersWork);
+        } else if ( !writersWork.empty() ) {
             startWritersRendering(false, writersWork);
         } else {
             std::list<std::string> writers;
@@ -1573,6 +1594,18 @@ AppInstance::startWritersRenderingFromNames(bool enableRenderStats,
 {
     std::list<RenderWork> renderers;
 
+    getWritersWorkFromNames(enableRenderStats, writers, frameRanges, &renderers);
+    startWritersRendering(doBlockingRender, renderers);
+}
+
+void
+AppInstance::getWritersWorkFromNames(bool enableRenderStats,
+                                     const std::list<std::string>& writers,
+                                     const std::list<std::pair<int, std::pair<int, int> > >& frameRanges,
+                                     std::list<AppInstance::RenderWork>* works)
+{
+    std::list<RenderWork>& renderers = *works;
+
     if ( !writers.empty() ) {
         for (std::list<std::string>::const_iterator it = writers.begin(); it != writers.end(); ++it) {
             const std::string& writerName = *it;
@@ -1632,9 +1665,7 @@ AppInstance::startWritersRenderingFromNames(bool enableRenderStats,
     if ( renderers.empty() ) {
         throw std::invalid_argument("Project file is missing a writer node. This project cannot render anything.");
     }
-
-    startWritersRendering(doBlockingRender, renderers);
-} // AppInstance::startWritersRenderingFromNames
+} // AppInstance::getWritersWorkFromNames
 
 void
 AppInstance::startWritersRendering(bool doBlockingRender,
@@ -1769,6 +1800,181 @@ AppInstancePrivate::validateRenderOptions(const AppInstance::RenderWork& w,
     return true;
 }
 
+void
+AppInstancePrivate::renderWithLocalRenderFarm(const CLArgs& cl,
+                                              const std::list<AppInstance::RenderWork>& writersWork)
+{
+    // Arguments given to every worker process, the writer and frame range arguments are added per chunk
+    QStringList commonArgs;
+    if ( cl.areRenderStatsEnabled() ) {
+        commonArgs << QString::fromUtf8("--render-stats");
+    }
+    if ( !cl.getDefaultOnProjectLoadedScript().isEmpty() ) {
+        commonArgs << QString::fromUtf8("--onload") << cl.getDefaultOnProjectLoadedScript();
+    }
+    const std::list<std::string>& pythonCommands = cl.getPythonCommands();
+    for (std::list<std::string>::const_iterator it = pythonCommands.begin(); it != pythonCommands.end(); ++it) {
+        commonArgs << QString::fromUtf8("--cmd") << QString::fromUtf8( it->c_str() );
+    }
+    const std::list<CLArgs::ReaderArg>& readerArgs = cl.getReaderArgs();
+    for (std::list<CLArgs::ReaderArg>::const_iterator it = readerArgs.begin(); it != readerArgs.end(); ++it) {
+        commonArgs << QString::fromUtf8("--reader") << it->name << it->filename;
+    }
+
+    // For each writer, the command-line arguments selecting it in the worker process and the works rendering it
+    std::list<std::pair<QStringList, std::list<AppInstance::RenderWork> > > jobs;
+    const std::list<CLArgs::WriterArg>& writerArgs = cl.getWriterArgs();
+    if ( !writerArgs.empty() ) {
+        // getWritersWorkForCL() adds the works of each writer argument in order: one per frame range, or a single
+        // one if no frame range was given
+        std::size_t nWorksPerWriter = cl.hasFrameRange() ? cl.getFrameRanges().size() : 1;
+        std::list<AppInstance::RenderWork>::const_iterator workIt = writersWork.begin();
+        for (std::list<CLArgs::WriterArg>::const_iterator it = writerArgs.begin(); it != writerArgs.end(); ++it) {
+            QStringList args;
+            if (it->mustCreate) {
+                // The name is Output<index>, see the parsing of the -o option in CLArgs
+                const QString outputPrefix = QString::fromUtf8("Output");
+                args << QString::fromUtf8("--output") + it->name.mid( outputPrefix.size() ) << it->filename;
+            } else {
+                args << QString::fromUtf8("--writer") << it->name;
+                if ( !it->filename.isEmpty() ) {
+                    args << it->filename;
+                }
+            }
+            std::list<AppInstance::RenderWork> works;
+            for (std::size_t i = 0; i < nWorksPerWriter && workIt != writersWork.end(); ++i, ++workIt) {
+                works.push_back(*workIt);
+            }
+            jobs.push_back( std::make_pair(args, works) );
+        }
+    } else {
+        std::list<OutputEffectInstancePtr> writers;
+        _currentProject->getWriters(&writers);
+        for (std::list<OutputEffectInstancePtr>::const_iterator it = writers.begin(); it != writers.end(); ++it) {
+            std::string scriptName = (*it)->getNode()->getScriptName_mt_safe();
+            if ( (*it)->getNode()->getFullyQualifiedName() != scriptName ) {
+                throw std::invalid_argument( tr("%1 is inside a group and cannot be rendered with the --workers option. "
+                                                "Please select the writers to render with the -w option.").arg( QString::fromUtf8( (*it)->getNode()->getFullyQualifiedName().c_str() ) ).toStdString() );
+            }
+            QStringList args;
+            args << QString::fromUtf8("--writer") << QString::fromUtf8( scriptName.c_str() );
+            std::list<AppInstance::RenderWork> works;
+            const std::list<std::pair<int, std::pair<int, int> > >& frameRanges = cl.getFrameRanges();
+            for (std::list<std::pair<int, std::pair<int, int> > >::const_iterator it2 = frameRanges.begin(); it2 != frameRanges.end(); ++it2) {
+                works.push_back( AppInstance::RenderWork(*it, it2->second.first, it2->second.second, it2->first, cl.areRenderStatsEnabled() ) );
+            }
+            if ( frameRanges.empty() ) {
+                works.push_back( AppInstance::RenderWork(*it, INT_MIN, INT_MAX, INT_MIN, cl.areRenderStatsEnabled() ) );
+            }
+            jobs.push_back( std::make_pair(args, works) );
+        }
+    }
+
+    if ( jobs.empty() ) {
+        throw std::invalid_argument("Project file is missing a writer node. This project cannot render anything.");
+    }
+
+    LocalRenderFarm farm( cl.getScriptFilename(), commonArgs, cl.getNumWorkers() );
+    for (std::list<std::pair<QStringList, std::list<AppInstance::RenderWork> > >::const_iterator it = jobs.begin(); it != jobs.end(); ++it) {
+        std::set<int> frames;
+        bool splittable = true;
+        for (std::list<AppInstance::RenderWork>::const_iterator it2 = it->second.begin(); it2 != it->second.end(); ++it2) {
+            int first, last, step;
+            if ( !validateRenderOptions(*it2, &first, &last, &step) ) {
+                continue;
+            }
+            for (int f = first; f <= last; f += step) {
+                frames.insert(f);
+            }
+            // A video file cannot be written by several processes
+            if ( it2->writer->isVideoWriter() ) {
+                splittable = false;
+            }
+        }
+        farm.addJob( it->first, std::vector<int>( frames.begin(), frames.end() ), splittable );
+    }
+
+    std::cout << tr("Rendering with %1 worker process(es)").arg( cl.getNumWorkers() ).toStdString() << std::endl;
+    {
+        QMutexLocker k(&renderQueueMutex);
+        localRenderFarm = &farm;
+    }
+    bool ok = farm.exec();
+    {
+        QMutexLocker k(&renderQueueMutex);
+        localRenderFarm = 0;
+    }
+    if (!ok) {
+        throw std::runtime_error( tr("Some frames could not be rendered by the worker processes.").toStdString() );
+    }
+} // AppInstancePrivate::renderWithLocalRenderFarm
+
+void
+AppInstance::abortLocalRenderFarm()
+{
+    QMutexLocker k(&_imp->renderQueueMutex);
+
+    if (_imp->localRenderFarm) {
+        _imp->localRenderFarm->abortRender();
+    }
+}
+
+void
+AppInstancePrivate::renderForBenchmark(const CLArgs& cl,
+                                       const std::list<AppInstance::RenderWork>& writersWork)
+{
+    std::list<AppInstance::RenderWork> works = writersWork;
+
+    if ( works.empty() ) {
+        _publicInterface->getWritersWorkFromNames( true, std::list<std::string>(), cl.getFrameRanges(), &works );
+    }
+    // The per-node breakdown is needed for the report. It is collected by the benchmark instead of being written to files.
+    for (std::list<AppInstance::RenderWork>::iterator it = works.begin(); it != works.end(); ++it) {
+        it->useRenderStats = true;
+    }
+
+    RenderBenchmarkPtr benchmark(new RenderBenchmark);
+    {
+        QMutexLocker k(&renderQueueMutex);
+        renderBenchmark = benchmark;
+    }
+    for (int i = 0; i < cl.getNumBenchmarkRuns(); ++i) {
+        bool coldCache = i == 0;
+        if (coldCache) {
+            appPTR->clearAllCaches();
+        }
+        benchmark->beginRun(coldCache);
+        // Blocking: this returns once all writers are rendered
+        _publicInterface->startWritersRendering(true, works);
+        benchmark->endRun();
+    }
+    {
+        QMutexLocker k(&renderQueueMutex);
+        renderBenchmark.reset();
+    }
+
+    const QString& reportFilePath = cl.getBenchmarkReportFilePath();
+    if ( reportFilePath.isEmpty() ) {
+        benchmark->writeJSON(std::cout);
+        std::cout << std::flush;
+    } else {
+        FStreamsSupport::ofstream ofile;
+        FStreamsSupport::open( &ofile, reportFilePath.toStdString() );
+        if (!ofile) {
+            throw std::runtime_error( tr("Cannot write the benchmark report to %1.").arg(reportFilePath).toStdString() );
+        }
+        benchmark->writeJSON(ofile);
+    }
+} // AppInstancePrivate::renderForBenchmark
+
+RenderBenchmarkPtr
+AppInstance::getRenderBenchmark() const
+{
+    QMutexLocker k(&_imp->renderQueueMutex);
+
+    return _imp->renderBenchmark;
+}
+
 void
 AppInstancePrivate::startRenderingFullSequence(bool blocking,
                                                const RenderQueueItem& w)
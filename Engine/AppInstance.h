@@ -299,6 +299,26 @@ public:
                                         const std::list<std::pair<int, std::pair<int, int> > >& frameRanges);
     void startWritersRendering(bool doBlockingRender, const std::list<RenderWork>& writers);
 
+    /**
+     * @brief Same as startWritersRenderingFromNames but only returns what should be rendered, without rendering it.
+     **/
+    void getWritersWorkFromNames(bool enableRenderStats,
+                                 const std::list<std::string>& writers,
+                                 const std::list<std::pair<int, std::pair<int, int> > >& frameRanges,
+                                 std::list<RenderWork>* works);
+
+    /**
+     * @brief Aborts the renders dispatched to the worker processes when rendering with --workers, if any.
+     * This may be called from any thread.
+     **/
+    void abortLocalRenderFarm();
+
+    /**
+     * @brief Returns the object collecting the render timings when rendering with --benchmark, or NULL otherwise.
+     * This may be called from any thread.
+     **/
+    RenderBenchmarkPtr getRenderBenchmark() const;
+
 public:
 
     void addInvalidExpressionKnob(const KnobIPtr& knob);
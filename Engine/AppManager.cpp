@@ -98,6 +98,7 @@
 #include "Engine/Project.h"
 #include "Engine/PrecompNode.h"
 #include "Engine/ReadNode.h"
+#include "Engine/RenderTrace.h"
 #include "Engine/RotoPaint.h"
 #include "Engine/RotoShapeRenderNode.h"
 #include "Engine/RotoShapeRenderCairo.h"
@@ -250,6 +251,8 @@ AppManager::AppManager()
 void
 AppManager::takeNatronGIL()
 {
+    RenderTraceScope trace("python", "GIL wait");
+
     _imp->natronPythonGIL.lock();
 }
 
@@ -288,6 +291,8 @@ AppManager::load(int &argc,
     QThreadPool::setGlobalInstance(new ThreadPool);
 #endif
 
+    _imp->taskExecutor.reset( new TaskExecutor() );
+
     // set fontconfig path on all platforms
     if ( qgetenv("FONTCONFIG_PATH").isNull() ) {
         // set FONTCONFIG_PATH to Natron/Resources/etc/fonts (required by plugins using fontconfig)
@@ -384,6 +389,9 @@ AppManager::~AppManager()
     _imp->_viewerCache.reset();
     _imp->_diskCache.reset();
 
+    // Waits for the running tasks, queued ones are dropped
+    _imp->taskExecutor.reset();
+
     tearDownPython();
     _imp->tearDownGL();
 
@@ -810,7 +818,8 @@ bool
 AppManager::loadInternalAfterInitGui(const CLArgs& cl)
 {
     try {
-        size_t maxCacheRAM = _imp->_settings->getRamMaximumPercent() * getSystemTotalRAM();
+        // Within a container, the cgroup memory limit is what matters, not the RAM of the host
+        size_t maxCacheRAM = _imp->_settings->getRamMaximumPercent() * getSystemTotalRAM_conditionnally();
         U64 viewerCacheSize = _imp->_settings->getMaximumViewerDiskCacheSize();
         U64 maxDiskCacheNode = _imp->_settings->getMaximumDiskCacheNodeSize();
 
@@ -818,6 +827,21 @@ AppManager::loadInternalAfterInitGui(const CLArgs& cl)
         _imp->_diskCache.reset( new ImageCache("DiskCache", NATRON_CACHE_VERSION, maxDiskCacheNode, 0.) );
         _imp->_viewerCache.reset( new FrameEntryCache("ViewerCache", NATRON_CACHE_VERSION, viewerCacheSize, 0.) );
         _imp->setViewerCacheTileSize();
+        {
+            QMutexLocker k(&_imp->cacheBudgetMutex);
+            _imp->nodeCacheBaseBudget = maxCacheRAM;
+            _imp->viewerCacheBaseBudget = viewerCacheSize;
+            _imp->applyCachesMemoryBudget();
+        }
+
+        U64 cgroupLimit = getCGroupMemoryLimit();
+        if (cgroupLimit) {
+            _imp->logCacheBudgetMessage( tr("Memory is limited to %1 by the cgroup of the process (%2 on the system): RAM cache budget is %3, viewer cache budget is %4")
+                                         .arg( printAsRAM(cgroupLimit) )
+                                         .arg( printAsRAM( getSystemTotalRAM() ) )
+                                         .arg( printAsRAM(maxCacheRAM) )
+                                         .arg( printAsRAM( std::min(viewerCacheSize, (U64)maxCacheRAM) ) ) );
+        }
     } catch (std::logic_error) {
         // ignore
     }
@@ -879,6 +903,10 @@ AppManager::loadInternalAfterInitGui(const CLArgs& cl)
         _imp->_appType = eAppTypeGui;
     }
 
+    if ( !cl.getTraceFilePath().isEmpty() ) {
+        RenderTrace::setEnabled(true);
+    }
+
     //Now that the locale is set, re-parse the command line arguments because the filenames might have non UTF-8 encodings
     CLArgs args;
     if ( !cl.getScriptFilename().isEmpty() ) {
@@ -899,6 +927,14 @@ AppManager::loadInternalAfterInitGui(const CLArgs& cl)
     } else {
         onLoadCompleted();
 
+        if ( !cl.getTraceFilePath().isEmpty() && (_imp->_appType != eAppTypeGui) ) {
+            std::string error;
+            if ( !RenderTrace::writeToFile(cl.getTraceFilePath().toStdString(), &error) ) {
+                std::cerr << error << std::endl;
+            }
+            RenderTrace::setEnabled(false);
+        }
+
         ///In background project auto-run the rendering is finished at this point, just exit the instance
         if ( ( (_imp->_appType == eAppTypeBackgroundAutoRun) ||
                ( _imp->_appType == eAppTypeBackgroundAutoRunLaunchedFromGui) ||
@@ -959,6 +995,9 @@ AppManagerPrivate::setViewerCacheTileSize()
         default:
             break;
     }
+
+    // Compressed tiles are stored in fixed slots that are a fraction of the raw tile size, see FrameParams
+    tileSize /= _settings->getViewerCacheCompressionRatio();
     _viewerCache->setTiled(true, tileSize);
 }
 
@@ -1209,6 +1248,7 @@ AppManager::abortAnyProcessing()
     }
 
     for (AppInstanceVec::iterator it = copy.begin(); it != copy.end(); ++it) {
+        (*it)->abortLocalRenderFarm();
         (*it)->getProject()->quitAnyProcessingForAllNodes_non_blocking();
     }
 }
@@ -1236,15 +1276,19 @@ void
 AppManager::setApplicationsCachesMaximumMemoryPercent(double p)
 {
     size_t maxCacheRAM = p * getSystemTotalRAM_conditionnally();
+    QMutexLocker k(&_imp->cacheBudgetMutex);
 
-    _imp->_nodeCache->setMaximumCacheSize(maxCacheRAM);
-    _imp->_nodeCache->setMaximumInMemorySize(1);
+    _imp->nodeCacheBaseBudget = maxCacheRAM;
+    _imp->applyCachesMemoryBudget();
 }
 
 void
 AppManager::setApplicationsCachesMaximumViewerDiskSpace(unsigned long long size)
 {
-    _imp->_viewerCache->setMaximumCacheSize(size);
+    QMutexLocker k(&_imp->cacheBudgetMutex);
+
+    _imp->viewerCacheBaseBudget = size;
+    _imp->applyCachesMemoryBudget();
 }
 
 void
@@ -2525,9 +2569,13 @@ AppManager::isNodeCacheAlmostFull() const
 void
 AppManager::checkCacheFreeMemoryIsGoodEnough()
 {
+    // Adapt the budget of the caches to the memory pressure
+    _imp->refreshCachesMemoryBudget();
+
     ///Before allocating the memory check that there's enough space to fit in memory
-    size_t systemRAMToKeepFree = getSystemTotalRAM() * appPTR->getCurrentSettings()->getUnreachableRamPercent();
-    size_t totalFreeRAM = getAmountFreePhysicalRAM();
+    U64 cgroupLimit = getCGroupMemoryLimit();
+    size_t systemRAMToKeepFree = (cgroupLimit ? cgroupLimit : getSystemTotalRAM()) * appPTR->getCurrentSettings()->getUnreachableRamPercent();
+    size_t totalFreeRAM = AppManagerPrivate::getAmountFreeRAMForCaches(cgroupLimit);
 
     while (totalFreeRAM <= systemRAMToKeepFree) {
 #ifdef NATRON_DEBUG_CACHE
@@ -2535,12 +2583,27 @@ AppManager::checkCacheFreeMemoryIsGoodEnough()
         << ", clearing least recently used NodeCache image...";
 #endif
         if ( !_imp->_nodeCache->evictLRUInMemoryEntry() ) {
-            break;
+            // Nothing left to drop in the NodeCache: write viewer textures back to disk
+            if ( !_imp->_viewerCache->evictLRUInMemoryEntry() ) {
+                break;
+            }
         }
 
 
-        totalFreeRAM = getAmountFreePhysicalRAM();
+        totalFreeRAM = AppManagerPrivate::getAmountFreeRAMForCaches(cgroupLimit);
+    }
+}
+
+U64
+AppManager::getCachesMemoryBudget(bool* reducedByMemoryPressure) const
+{
+    QMutexLocker k(&_imp->cacheBudgetMutex);
+
+    if (reducedByMemoryPressure) {
+        *reducedByMemoryPressure = _imp->cacheBudgetFactor < 1.;
     }
+
+    return _imp->nodeCacheBaseBudget * _imp->cacheBudgetFactor;
 }
 
 void
@@ -3328,6 +3391,12 @@ AppManager::getAppTLS() const
     return &_imp->globalTLS;
 }
 
+TaskExecutor*
+AppManager::getTaskExecutor() const
+{
+    return _imp->taskExecutor.get();
+}
+
 
 QString
 AppManager::getBoostVersion() const
@@ -214,6 +214,12 @@ public:
 
     U64 getCachesTotalMemorySize() const;
     U64 getCachesTotalDiskSize() const;
+
+    /**
+     * @brief Returns the current RAM budget of the caches. It is derived from the preferences and the cgroup memory limit,
+     * and is lowered while the system is under memory pressure, in which case reducedByMemoryPressure is set to true.
+     **/
+    U64 getCachesMemoryBudget(bool* reducedByMemoryPressure = 0) const;
     boost::shared_ptr<CacheSignalEmitter> getOrActivateViewerCacheSignalEmitter() const;
 
     void setApplicationsCachesMaximumMemoryPercent(double p);
@@ -341,7 +347,8 @@ public:
     void decreaseNCacheFilesOpened();
 
     /**
-     * @brief Called by the caches to check that there's enough free memory on the computer to perform the allocation.
+     * @brief Called by the caches to check that there's enough free memory on the computer (or below the cgroup memory limit)
+     * to perform the allocation. This also adapts the RAM budget of the caches to the memory pressure.
      * WARNING: This functin may remove some entries from the caches.
      **/
     void checkCacheFreeMemoryIsGoodEnough();
@@ -487,6 +494,12 @@ public:
     OFX::Host::ImageEffect::Descriptor* getPluginContextAndDescribe(OFX::Host::ImageEffect::ImageEffectPlugin* plugin,
                                                                     ContextEnum* ctx);
     AppTLS* getAppTLS() const;
+
+    /**
+     * @brief The engine-wide executor that runs cache deletion, viewer renders, tracking, viewer histograms, previews, cache clean-up and other background tasks.
+     * Returns NULL before load() and while the application shuts down.
+     **/
+    TaskExecutor* getTaskExecutor() const;
     const OfxHost* getOFXHost() const;
     GPUContextPool* getGPUContextPool() const;
 
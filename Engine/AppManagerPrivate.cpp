@@ -43,6 +43,9 @@ GCC_DIAG_OFF(unused-parameter)
 GCC_DIAG_UNUSED_LOCAL_TYPEDEFS_ON
 GCC_DIAG_ON(unused-parameter)
 
+#include <iostream>
+
+#include <QtCore/QDateTime>
 #include <QtCore/QDebug>
 #include <QtCore/QProcess>
 #include <QtCore/QTemporaryFile>
@@ -53,6 +56,7 @@ GCC_DIAG_ON(unused-parameter)
 #include "Global/QtCompat.h" // for removeRecursively
 #include "Global/GlobalDefines.h"
 #include "Global/GLIncludes.h"
+#include "Global/MemoryInfo.h"
 
 #include "Engine/FStreamsSupport.h"
 #include "Engine/CacheSerialization.h"
@@ -122,6 +126,11 @@ AppManagerPrivate::AppManagerPrivate()
 #endif
     , natronPythonGIL(QMutex::Recursive)
     , pluginsUseInputImageCopyToRender(false)
+    , cacheBudgetMutex()
+    , nodeCacheBaseBudget(0)
+    , viewerCacheBaseBudget(0)
+    , cacheBudgetFactor(1.)
+    , lastMemoryPressureCheck()
     , glRequirements()
     , glHasTextureFloat(false)
     , hasInitializedOpenGLFunctions(false)
@@ -129,6 +138,7 @@ AppManagerPrivate::AppManagerPrivate()
     , glVersionMajor(0)
     , glVersionMinor(0)
     , renderingContextPool()
+    , taskExecutor()
     , openGLRenderers()
 {
     setMaxCacheFiles();
@@ -864,4 +874,107 @@ AppManagerPrivate::tearDownGL()
 #endif
 }
 
+U64
+AppManagerPrivate::getAmountFreeRAMForCaches(U64 cgroupLimit)
+{
+    if (cgroupLimit) {
+        U64 usage = getCGroupMemoryUsage();
+
+        return usage >= cgroupLimit ? 0 : cgroupLimit - usage;
+    }
+
+    return getAmountFreePhysicalRAM();
+}
+
+void
+AppManagerPrivate::refreshCachesMemoryBudget()
+{
+    // Only one thread needs to do this, others can go on allocating
+    if ( !cacheBudgetMutex.tryLock() ) {
+        return;
+    }
+    if ( (lastMemoryPressureCheck.getTimeSinceCreation() < NATRON_MEMORY_PRESSURE_CHECK_INTERVAL) || !_nodeCache || !nodeCacheBaseBudget ) {
+        cacheBudgetMutex.unlock();
+
+        return;
+    }
+    lastMemoryPressureCheck.reset();
+
+    double someAvg10 = 0.;
+    bool hasPSI = getMemoryPressure(&someAvg10, NULL);
+    U64 cgroupLimit = getCGroupMemoryLimit();
+    U64 ramToKeepFree = 0;
+    if (cgroupLimit) {
+        ramToKeepFree = cgroupLimit * _settings->getUnreachableRamPercent();
+    }
+    U64 freeRAM = cgroupLimit ? getAmountFreeRAMForCaches(cgroupLimit) : 0;
+
+    bool underPressure = ( hasPSI && (someAvg10 >= NATRON_MEMORY_PRESSURE_HIGH_PERCENT) ) || ( cgroupLimit && (freeRAM <= ramToKeepFree) );
+    bool relaxed = ( !hasPSI || (someAvg10 <= NATRON_MEMORY_PRESSURE_LOW_PERCENT) ) && ( !cgroupLimit || (freeRAM > 2 * ramToKeepFree) );
+
+    double oldFactor = cacheBudgetFactor;
+    if (underPressure) {
+        cacheBudgetFactor = std::max(NATRON_CACHE_MIN_BUDGET_FACTOR, cacheBudgetFactor * 0.75);
+    } else if (relaxed) {
+        cacheBudgetFactor = std::min(1., cacheBudgetFactor + 0.1);
+    }
+
+    bool shrunk = cacheBudgetFactor < oldFactor;
+    if (cacheBudgetFactor != oldFactor) {
+        U64 oldBudget = nodeCacheBaseBudget * oldFactor;
+        applyCachesMemoryBudget();
+        QString reason;
+        if (hasPSI) {
+            reason = tr("memory pressure %1%").arg(someAvg10, 0, 'f', 2);
+        }
+        if (cgroupLimit) {
+            if ( !reason.isEmpty() ) {
+                reason += QString::fromUtf8(", ");
+            }
+            reason += tr("%1 free below the cgroup limit of %2").arg( printAsRAM(freeRAM) ).arg( printAsRAM(cgroupLimit) );
+        }
+        logCacheBudgetMessage( tr("%1 the RAM cache budget from %2 to %3 (%4)")
+                               .arg( shrunk ? tr("Shrinking") : tr("Growing") )
+                               .arg( printAsRAM(oldBudget) )
+                               .arg( printAsRAM(nodeCacheBaseBudget * cacheBudgetFactor) )
+                               .arg(reason) );
+    }
+    cacheBudgetMutex.unlock();
+
+    if (shrunk) {
+        // Drop images from the NodeCache above the new budget, and write back to disk the viewer textures that are
+        // not in use, before the kernel has to reclaim memory
+        _nodeCache->clearExceedingEntries();
+        if (_viewerCache) {
+            _viewerCache->clearExceedingEntries();
+        }
+    }
+} // AppManagerPrivate::refreshCachesMemoryBudget
+
+void
+AppManagerPrivate::applyCachesMemoryBudget()
+{
+    assert( !cacheBudgetMutex.tryLock() );
+    U64 nodeCacheBudget = nodeCacheBaseBudget * cacheBudgetFactor;
+    _nodeCache->setMaximumCacheSize(nodeCacheBudget);
+    _nodeCache->setMaximumInMemorySize(1);
+
+    if (_viewerCache) {
+        U64 viewerCacheBudget = viewerCacheBaseBudget;
+        if ( getCGroupMemoryLimit() ) {
+            viewerCacheBudget = std::min(viewerCacheBudget, nodeCacheBudget);
+        }
+        _viewerCache->setMaximumCacheSize(viewerCacheBudget);
+    }
+}
+
+void
+AppManagerPrivate::logCacheBudgetMessage(const QString& message)
+{
+    appPTR->writeToErrorLog_mt_safe(tr("Cache"), QDateTime::currentDateTime(), message);
+    if ( appPTR->isBackground() ) {
+        std::cout << tr("Cache").toStdString() << ": " << message.toStdString() << std::endl;
+    }
+}
+
 NATRON_NAMESPACE_EXIT;
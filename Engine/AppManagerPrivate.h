@@ -68,8 +68,10 @@ GCC_DIAG_ON(deprecated)
 #include "Engine/Image.h"
 #include "Engine/GPUContextPool.h"
 #include "Engine/GenericSchedulerThreadWatcher.h"
+#include "Engine/TaskExecutor.h"
 #include "Engine/EngineFwd.h"
 #include "Engine/TLSHolder.h"
+#include "Engine/Timer.h"
 
 NATRON_NAMESPACE_ENTER;
 
@@ -158,6 +160,15 @@ public:
     // Copy of the setting knob for faster access from OfxImage constructor
     bool pluginsUseInputImageCopyToRender;
 
+    // The RAM budget of the NodeCache is nodeCacheBaseBudget * cacheBudgetFactor. The factor is lowered
+    // when the system (or the cgroup of the process) is under memory pressure, and raised back when it is not.
+    // See refreshCachesMemoryBudget()
+    QMutex cacheBudgetMutex; // protects all fields below
+    U64 nodeCacheBaseBudget; // from the settings, in bytes
+    U64 viewerCacheBaseBudget; // from the settings, in bytes
+    double cacheBudgetFactor; // in [NATRON_CACHE_MIN_BUDGET_FACTOR, 1]
+    TimeLapse lastMemoryPressureCheck;
+
     // True if we can use OpenGL
     struct OpenGLRequirementsData
     {
@@ -185,6 +196,7 @@ public:
 #endif
 
     boost::scoped_ptr<GPUContextPool> renderingContextPool;
+    boost::scoped_ptr<TaskExecutor> taskExecutor;
     std::list<OpenGLRendererInfo> openGLRenderers;
     boost::scoped_ptr<QCoreApplication> _qApp;
 
@@ -229,6 +241,27 @@ public:
     void tearDownGL();
 
     void setViewerCacheTileSize();
+
+    /**
+     * @brief Returns the amount of RAM that can still be allocated before the kernel starts reclaiming memory
+     * from this process: the headroom below the cgroup limit if any, otherwise the free physical RAM.
+     **/
+    static U64 getAmountFreeRAMForCaches(U64 cgroupLimit);
+
+    /**
+     * @brief Reads the memory pressure (PSI) and the cgroup memory usage, and shrinks or grows the RAM budget of
+     * the caches accordingly. Does nothing if it was called less than NATRON_MEMORY_PRESSURE_CHECK_INTERVAL seconds ago.
+     **/
+    void refreshCachesMemoryBudget();
+
+    /**
+     * @brief Applies nodeCacheBaseBudget * cacheBudgetFactor to the NodeCache. Within a cgroup memory limit, the
+     * ViewerCache is also capped by that budget, since the pages of its memory-mapped tiles are charged to the cgroup.
+     * cacheBudgetMutex must be locked.
+     **/
+    void applyCachesMemoryBudget();
+
+    void logCacheBudgetMessage(const QString& message);
 };
 
 NATRON_NAMESPACE_EXIT;
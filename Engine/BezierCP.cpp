@@ -30,6 +30,7 @@
 #include <set>
 #include <list>
 #include <utility>
+#include <vector>
 #include <cassert>
 #include <stdexcept>
 
@@ -864,6 +865,88 @@ BezierCP::clone(const BezierCP & other)
     }
 }
 
+static void
+getInternalCurves(const BezierCPPrivate & imp,
+                  Curve* curves[BezierCPDelta::eCurveCount])
+{
+    curves[BezierCPDelta::eCurveX] = imp.curveX.get();
+    curves[BezierCPDelta::eCurveY] = imp.curveY.get();
+    curves[BezierCPDelta::eCurveLeftX] = imp.curveLeftBezierX.get();
+    curves[BezierCPDelta::eCurveLeftY] = imp.curveLeftBezierY.get();
+    curves[BezierCPDelta::eCurveRightX] = imp.curveRightBezierX.get();
+    curves[BezierCPDelta::eCurveRightY] = imp.curveRightBezierY.get();
+}
+
+void
+BezierCP::saveDelta(double time,
+                    bool allKeyframes,
+                    BezierCPDelta* delta) const
+{
+    assert(delta);
+    delta->time = time;
+    delta->allKeyframes = allKeyframes;
+    {
+        QMutexLocker l(&_imp->staticPositionMutex);
+        delta->staticValues[BezierCPDelta::eCurveX] = _imp->x;
+        delta->staticValues[BezierCPDelta::eCurveY] = _imp->y;
+        delta->staticValues[BezierCPDelta::eCurveLeftX] = _imp->leftX;
+        delta->staticValues[BezierCPDelta::eCurveLeftY] = _imp->leftY;
+        delta->staticValues[BezierCPDelta::eCurveRightX] = _imp->rightX;
+        delta->staticValues[BezierCPDelta::eCurveRightY] = _imp->rightY;
+    }
+
+    Curve* curves[BezierCPDelta::eCurveCount];
+    getInternalCurves(*_imp, curves);
+    for (int i = 0; i < BezierCPDelta::eCurveCount; ++i) {
+        std::vector<KeyFrame>& keys = delta->keyframes[i];
+        keys.clear();
+        if (allKeyframes) {
+            KeyFrameSet set = curves[i]->getKeyFrames_mt_safe();
+            keys.assign( set.begin(), set.end() );
+        } else {
+            KeyFrame k;
+            if ( curves[i]->getKeyFrameWithTime(time, &k) ) {
+                keys.push_back(k);
+            }
+        }
+    }
+}
+
+void
+BezierCP::restoreDelta(const BezierCPDelta & delta)
+{
+    Curve* curves[BezierCPDelta::eCurveCount];
+
+    getInternalCurves(*_imp, curves);
+    for (int i = 0; i < BezierCPDelta::eCurveCount; ++i) {
+        const std::vector<KeyFrame>& keys = delta.keyframes[i];
+        if (delta.allKeyframes) {
+            curves[i]->clearKeyFrames();
+        } else if ( keys.empty() ) {
+            // The edit may have set a keyframe that did not exist
+            KeyFrame k;
+            if ( curves[i]->getKeyFrameWithTime(delta.time, &k) ) {
+                curves[i]->removeKeyFrameWithTime(delta.time);
+            }
+        }
+        for (std::vector<KeyFrame>::const_iterator it = keys.begin(); it != keys.end(); ++it) {
+            curves[i]->addKeyFrame(*it);
+        }
+    }
+
+    {
+        QMutexLocker l(&_imp->staticPositionMutex);
+        _imp->x = delta.staticValues[BezierCPDelta::eCurveX];
+        _imp->y = delta.staticValues[BezierCPDelta::eCurveY];
+        _imp->leftX = delta.staticValues[BezierCPDelta::eCurveLeftX];
+        _imp->leftY = delta.staticValues[BezierCPDelta::eCurveLeftY];
+        _imp->rightX = delta.staticValues[BezierCPDelta::eCurveRightX];
+        _imp->rightY = delta.staticValues[BezierCPDelta::eCurveRightY];
+    }
+
+    cloneInternalCurvesToGuiCurves();
+}
+
 bool
 BezierCP::equalsAtTime(bool useGuiCurves,
                        double time,
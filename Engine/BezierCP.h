@@ -27,9 +27,11 @@
 
 #include "Global/Macros.h"
 
+#include <cstddef>
 #include <list>
 #include <set>
 #include <utility>
+#include <vector>
 
 #include "Global/Macros.h"
 
@@ -40,11 +42,59 @@
 
 #include "Global/GlobalDefines.h"
 
+#include "Engine/Curve.h"
 #include "Engine/ViewIdx.h"
 #include "Engine/EngineFwd.h"
 
 NATRON_NAMESPACE_ENTER;
 
+/**
+ * @brief The part of a control point that an edit made at a given time may change: the static
+ * position and tangents, and the keyframes of the 6 animation curves at that time only (or all of them
+ * for a ripple edit). Undo commands keep this rather than a full copy of the control point.
+ **/
+struct BezierCPDelta
+{
+    enum CurveEnum
+    {
+        eCurveX = 0,
+        eCurveY,
+        eCurveLeftX,
+        eCurveLeftY,
+        eCurveRightX,
+        eCurveRightY,
+        eCurveCount
+    };
+
+    double time;
+    bool allKeyframes;
+    double staticValues[eCurveCount];
+    std::vector<KeyFrame> keyframes[eCurveCount];
+
+    BezierCPDelta()
+        : time(0)
+        , allKeyframes(false)
+    {
+        for (int i = 0; i < eCurveCount; ++i) {
+            staticValues[i] = 0.;
+        }
+    }
+
+    /**
+     * @brief Returns an estimate in bytes of the memory held by this delta.
+     **/
+    std::size_t getMemoryCost() const
+    {
+        std::size_t ret = sizeof(*this);
+
+        for (int i = 0; i < eCurveCount; ++i) {
+            ret += keyframes[i].capacity() * sizeof(KeyFrame);
+        }
+
+        return ret;
+    }
+};
+
 /**
  * @class A Bezier is an animated control point of a Bezier. It is the starting point
  * and/or the ending point of a bezier segment. (It would correspond to P0/P3).
@@ -89,6 +139,18 @@ public:
 
     void clone(const BezierCP & other);
 
+    /**
+     * @brief Saves in delta the state that an edit at the given time may change. If allKeyframes is true
+     * every keyframe is saved, which is what a ripple edit needs.
+     **/
+    void saveDelta(double time, bool allKeyframes, BezierCPDelta* delta) const;
+
+    /**
+     * @brief Restores the state saved by saveDelta() on both the internal and the GUI curves:
+     * keyframes that were added at the saved time since are removed.
+     **/
+    void restoreDelta(const BezierCPDelta & delta);
+
     void setPositionAtTime(bool useGuiCurves, double time, double x, double y);
 
     void setLeftBezierPointAtTime(bool useGuiCurves, double time, double x, double y);
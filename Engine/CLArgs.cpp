@@ -60,6 +60,10 @@ public:
     std::list<std::pair<int, std::pair<int, int> > > frameRanges;
     bool rangeSet;
     bool enableRenderStats;
+    int nWorkers;
+    int nBenchmarkRuns;
+    QString benchmarkReportFilePath;
+    QString traceFilePath;
     bool isEmpty;
     mutable QString imageFilename;
     QString breakpadPipeFilePath;
@@ -84,6 +88,10 @@ public:
         , frameRanges()
         , rangeSet(false)
         , enableRenderStats(false)
+        , nWorkers(0)
+        , nBenchmarkRuns(0)
+        , benchmarkReportFilePath()
+        , traceFilePath()
         , isEmpty(true)
         , imageFilename()
         , breakpadPipeFilePath()
@@ -180,6 +188,10 @@ CLArgs::operator=(const CLArgs& other)
     _imp->frameRanges = other._imp->frameRanges;
     _imp->rangeSet = other._imp->rangeSet;
     _imp->enableRenderStats = other._imp->enableRenderStats;
+    _imp->nWorkers = other._imp->nWorkers;
+    _imp->nBenchmarkRuns = other._imp->nBenchmarkRuns;
+    _imp->benchmarkReportFilePath = other._imp->benchmarkReportFilePath;
+    _imp->traceFilePath = other._imp->traceFilePath;
     _imp->isEmpty = other._imp->isEmpty;
     _imp->imageFilename = other._imp->imageFilename;
     _imp->exportDocsPath = other._imp->exportDocsPath;
@@ -275,7 +287,30 @@ CLArgs::printUsage(const std::string& programName)
         "     breakdown contains informations about each nodes, render times etc...\n"
         "     This option is useful for debugging purposes or to control that a render\n"
         "     is working correctly.\n"
-        "     **Please note** that it does not work when writing video files."
+        "     **Please note** that it does not work when writing video files.\n"
+        "  --trace <filename>\n"
+        "     Record a timeline of the render activity of each thread (plug-in\n"
+        "     actions, cache lookups, tiles, waits on the Python interpreter) and\n"
+        "     write it to the given file in the trace-event JSON format, which can be\n"
+        "     opened with chrome://tracing or https://ui.perfetto.dev\n"
+        "  --workers <N>\n"
+        "     Split the frames to render in chunks and dispatch them to N child\n"
+        "     renderer processes running in parallel on this computer. Chunks are\n"
+        "     handed to the first idle process and chunks whose process failed are\n"
+        "     rendered again. Writers of video files are always rendered by a single\n"
+        "     process.\n"
+        "  --benchmark <N>\n"
+        "     Render the writers N times in a row and report the timings instead of\n"
+        "     writing render statistics files: the first render starts with all the\n"
+        "     caches cleared (cold), the next ones reuse the caches (warm). For each\n"
+        "     render, the report gives the frame time percentiles, the throughput,\n"
+        "     the peak memory use of the process and how much the render raised it,\n"
+        "     the image cache hit rate, the queue latency of the background tasks and\n"
+        "     the nodes that took the most time, in JSON format.\n"
+        "  --benchmark-report <filename>\n"
+        "     Write the report of the --benchmark option to the given file instead of\n"
+        "     the standard output.\n"
+        "\n"
         "Sample uses:\n"
         "  %1 /Users/Me/MyNatronProjects/MyProject.ntp\n"
         "  %1 -b -w MyWriter /Users/Me/MyNatronProjects/MyProject.ntp\n"
@@ -439,6 +474,30 @@ CLArgs::areRenderStatsEnabled() const
     return _imp->enableRenderStats;
 }
 
+int
+CLArgs::getNumWorkers() const
+{
+    return _imp->nWorkers;
+}
+
+int
+CLArgs::getNumBenchmarkRuns() const
+{
+    return _imp->nBenchmarkRuns;
+}
+
+const QString&
+CLArgs::getBenchmarkReportFilePath() const
+{
+    return _imp->benchmarkReportFilePath;
+}
+
+const QString&
+CLArgs::getTraceFilePath() const
+{
+    return _imp->traceFilePath;
+}
+
 bool
 CLArgs::isPythonScript() const
 {
@@ -592,10 +651,17 @@ tryParseFrameRange(const QString& arg,
 
         return true;
     }
-    QStringList strRange = arg.split( QChar::fromLatin1('-') );
-    if (strRange.size() != 2) {
+    // The separator is the first '-' after the first frame, which may itself be negative, e.g: -10--5:1
+    int firstChar = 0;
+    while ( firstChar < arg.size() && arg[firstChar].isSpace() ) {
+        ++firstChar;
+    }
+    int separator = arg.indexOf(QChar::fromLatin1('-'), firstChar + 1);
+    if (separator == -1) {
         return false;
     }
+    QStringList strRange;
+    strRange << arg.left(separator) << arg.mid(separator + 1);
     for (int i = 0; i < strRange.size(); ++i) {
         //whitespace removed from the start and the end.
         strRange[i] = strRange[i].trimmed();
@@ -701,6 +767,116 @@ CLArgsPrivate::parse()
         }
     }
 
+    {
+        QStringList::iterator it = hasToken( QString::fromUtf8("trace"), QString() );
+        if ( it != args.end() ) {
+            QStringList::iterator next = it;
+            ++next;
+            if ( next == args.end() ) {
+                std::cout << tr("You must specify the trace filename when using the --trace option").toStdString() << std::endl;
+                error = 1;
+
+                return;
+            }
+            if (!isBackground) {
+                std::cout << tr("You cannot use the --trace option in interactive mode").toStdString() << std::endl;
+                error = 1;
+
+                return;
+            }
+            traceFilePath = *next;
+#ifdef __NATRON_UNIX__
+            traceFilePath = AppManager::qt_tildeExpansion(traceFilePath);
+#endif
+            ++next;
+            args.erase(it, next);
+        }
+    }
+
+    {
+        QStringList::iterator it = hasToken( QString::fromUtf8("workers"), QString() );
+        if ( it != args.end() ) {
+            QStringList::iterator next = it;
+            ++next;
+            bool ok = false;
+            if ( next != args.end() ) {
+                nWorkers = next->toInt(&ok);
+            }
+            if ( !ok || (nWorkers < 1) ) {
+                std::cout << tr("You must specify a strictly positive number of processes when using the --workers option").toStdString() << std::endl;
+                error = 1;
+
+                return;
+            }
+            if (!isBackground || isInterpreterMode) {
+                std::cout << tr("You cannot use the --workers option in interactive or interpreter mode").toStdString() << std::endl;
+                error = 1;
+
+                return;
+            }
+            ++next;
+            args.erase(it, next);
+        }
+    }
+
+    {
+        QStringList::iterator it = hasToken( QString::fromUtf8("benchmark"), QString() );
+        if ( it != args.end() ) {
+            QStringList::iterator next = it;
+            ++next;
+            bool ok = false;
+            if ( next != args.end() ) {
+                nBenchmarkRuns = next->toInt(&ok);
+            }
+            if ( !ok || (nBenchmarkRuns < 1) ) {
+                std::cout << tr("You must specify a strictly positive number of renders when using the --benchmark option").toStdString() << std::endl;
+                error = 1;
+
+                return;
+            }
+            if (!isBackground || isInterpreterMode) {
+                std::cout << tr("You cannot use the --benchmark option in interactive or interpreter mode").toStdString() << std::endl;
+                error = 1;
+
+                return;
+            }
+            if (nWorkers > 0) {
+                std::cout << tr("The --benchmark and --workers options cannot be used together").toStdString() << std::endl;
+                error = 1;
+
+                return;
+            }
+            ++next;
+            args.erase(it, next);
+        }
+    }
+
+    {
+        QStringList::iterator it = hasToken( QString::fromUtf8("benchmark-report"), QString() );
+        if ( it != args.end() ) {
+            QStringList::iterator next = it;
+            ++next;
+            if ( next == args.end() ) {
+                std::cout << tr("You must specify the report filename when using the --benchmark-report option").toStdString() << std::endl;
+                error = 1;
+
+                return;
+            }
+            if (nBenchmarkRuns == 0) {
+                std::cout << tr("The --benchmark-report option requires the --benchmark option").toStdString() << std::endl;
+                error = 1;
+
+                return;
+            }
+            benchmarkReportFilePath = *next;
+#ifdef __NATRON_UNIX__
+            benchmarkReportFilePath = AppManager::qt_tildeExpansion(benchmarkReportFilePath);
+#endif
+            ++next;
+            args.erase(it, next);
+        }
+    }
+
     {
         QStringList::iterator it = hasToken( QString::fromUtf8(NATRON_BREAKPAD_PROCESS_PID), QString() );
         if ( it != args.end() ) {
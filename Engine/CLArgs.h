@@ -120,6 +120,27 @@ public:
 
     bool areRenderStatsEnabled() const;
 
+    /*
+     * @brief Returns the number of renderer processes requested with the --workers option.
+     * If lower than 2, the render happens in this process.
+     */
+    int getNumWorkers() const;
+
+    /*
+     * @brief Returns the number of renders requested with the --benchmark option, or 0 if not benchmarking.
+     */
+    int getNumBenchmarkRuns() const;
+
+    /*
+     * @brief Returns the file where the --benchmark report should be written. If empty, it goes to the standard output.
+     */
+    const QString& getBenchmarkReportFilePath() const;
+
+    /*
+     * @brief Returns the file where the timeline of the render activity should be written, see RenderTrace.
+     */
+    const QString& getTraceFilePath() const;
+
     const QString& getBreakpadProcessExecutableFilePath() const;
 
     qint64 getBreakpadProcessPID() const;
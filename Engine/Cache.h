@@ -58,6 +58,7 @@ GCC_DIAG_ON(deprecated)
 #include "Engine/CacheEntry.h"
 #include "Engine/LRUHashTable.h"
 #include "Engine/StandardPaths.h"
+#include "Engine/TaskExecutor.h"
 #include "Engine/ImageLocker.h"
 #include "Global/MemoryInfo.h"
 #include "Engine/EngineFwd.h"
@@ -65,6 +66,18 @@ GCC_DIAG_ON(deprecated)
 //Beyond that percentage of occupation, the cache will start evicting LRU entries
 #define NATRON_CACHE_LIMIT_PERCENT 0.9
 
+//Minimum interval in seconds between two reads of the memory pressure (PSI) and cgroup memory usage
+#define NATRON_MEMORY_PRESSURE_CHECK_INTERVAL 0.5
+
+//Above this percentage of time stalled on memory (PSI "some avg10"), the RAM budget of the caches is shrunk
+#define NATRON_MEMORY_PRESSURE_HIGH_PERCENT 10.
+
+//Below this percentage of time stalled on memory, the RAM budget of the caches may grow back
+#define NATRON_MEMORY_PRESSURE_LOW_PERCENT 1.
+
+//The RAM budget of the caches never goes below this fraction of the budget set in the preferences
+#define NATRON_CACHE_MIN_BUDGET_FACTOR 0.1
+
 #define NATRON_TILE_CACHE_FILE_SIZE_BYTES 2000000000
 
 ///When defined, number of opened files, memory size and disk size of the cache are printed whenever there's activity.
@@ -73,37 +86,62 @@ GCC_DIAG_ON(deprecated)
 NATRON_NAMESPACE_ENTER;
 
 /**
- * @brief The point of this thread is to delete the content of the list in a separate thread so the thread calling
- * get() doesn't wait for all the entries to be deleted (which can be expensive for large images)
+ * @brief Deletes the content of the list on the TaskExecutor so the thread calling
+ * get() doesn't wait for all the entries to be deleted (which can be expensive for large images).
+ * At most one cache deletion task per cache processes the queue at a time.
+ * Render threads wait for the deletion when the cache is full, so if no worker of the executor
+ * can start the task right away, the queue is processed in the calling thread instead: appendToQueue()
+ * must therefore never be called with the lock of the cache held.
  **/
 template <typename T>
-class DeleterThread
-    : public QThread
+class CacheDeleter
 {
+    class DeleteTask
+        : public ExecutorTask
+    {
+        CacheDeleter* _deleter;
+
+    public:
+
+        DeleteTask(CacheDeleter* deleter)
+            : ExecutorTask()
+            , _deleter(deleter)
+        {
+        }
+
+        virtual void run() OVERRIDE FINAL
+        {
+            _deleter->processQueue();
+        }
+
+        virtual void onDropped() OVERRIDE FINAL
+        {
+            _deleter->processQueue();
+        }
+    };
+
+    friend class DeleteTask;
+
     mutable QMutex _entriesQueueMutex;
     std::list<boost::shared_ptr<T> >_entriesQueue;
-    QWaitCondition _entriesQueueNotEmptyCond;
+
+    // True while a DeleteTask is queued or running, protected by _entriesQueueMutex
+    bool _taskScheduled;
+    QWaitCondition _queueProcessedCond;
     CacheAPI* cache;
-    QMutex mustQuitMutex;
-    QWaitCondition mustQuitCond;
-    bool mustQuit;
 
 public:
 
-    DeleterThread(CacheAPI* cache)
-        : QThread()
-        , _entriesQueueMutex()
+    CacheDeleter(CacheAPI* cache)
+        : _entriesQueueMutex()
         , _entriesQueue()
-        , _entriesQueueNotEmptyCond()
+        , _taskScheduled(false)
+        , _queueProcessedCond()
         , cache(cache)
-        , mustQuitMutex()
-        , mustQuitCond()
-        , mustQuit(false)
     {
-        setObjectName( QString::fromUtf8("CacheDeleter") );
     }
 
-    virtual ~DeleterThread()
+    ~CacheDeleter()
     {
     }
 
@@ -113,34 +151,31 @@ public:
             return;
         }
 
+        bool mustSchedule;
         {
             QMutexLocker k(&_entriesQueueMutex);
             _entriesQueue.insert( _entriesQueue.begin(), entriesToDelete.begin(), entriesToDelete.end() );
+            mustSchedule = !_taskScheduled;
+            _taskScheduled = true;
         }
-        if ( !isRunning() ) {
-            start();
-        } else {
-            QMutexLocker k(&_entriesQueueMutex);
-            _entriesQueueNotEmptyCond.wakeOne();
+        if (mustSchedule) {
+            TaskExecutor* executor = appPTR ? appPTR->getTaskExecutor() : 0;
+            if ( !executor || !executor->trySubmit( eTaskPriorityCacheDeletion, ExecutorTaskPtr( new DeleteTask(this) ) ) ) {
+                // No executor (e.g: while the application shuts down) or all its workers are busy: delete in this thread
+                processQueue();
+            }
         }
     }
 
-    void quitThread()
+    /**
+     * @brief Blocks until the queue is processed
+     **/
+    void waitForQueueProcessed()
     {
-        if ( !isRunning() ) {
-            return;
-        }
-        QMutexLocker k(&mustQuitMutex);
-        assert(!mustQuit);
-        mustQuit = true;
+        QMutexLocker k(&_entriesQueueMutex);
 
-        {
-            QMutexLocker k2(&_entriesQueueMutex);
-            _entriesQueue.push_back( boost::shared_ptr<T>() );
-            _entriesQueueNotEmptyCond.wakeOne();
-        }
-        while (mustQuit) {
-            mustQuitCond.wait(&mustQuitMutex);
+        while (_taskScheduled) {
+            _queueProcessedCond.wait(&_entriesQueueMutex);
         }
     }
 
@@ -153,33 +188,19 @@ public:
 
 private:
 
-    virtual void run() OVERRIDE FINAL
+    void processQueue()
     {
         for (;; ) {
-            bool quit;
-            {
-                QMutexLocker k(&mustQuitMutex);
-                quit = mustQuit;
-            }
-
             {
                 boost::shared_ptr<T> front;
                 {
                     QMutexLocker k(&_entriesQueueMutex);
-                    if ( quit && _entriesQueue.empty() ) {
-                        _entriesQueueMutex.unlock();
-                        QMutexLocker k(&mustQuitMutex);
-                        assert(mustQuit);
-                        mustQuit = false;
-                        mustQuitCond.wakeOne();
+                    if ( _entriesQueue.empty() ) {
+                        _taskScheduled = false;
+                        _queueProcessedCond.wakeAll();
 
                         return;
                     }
-                    while ( _entriesQueue.empty() ) {
-                        _entriesQueueNotEmptyCond.wait(&_entriesQueueMutex);
-                    }
-
-                    assert( !_entriesQueue.empty() );
                     front = _entriesQueue.front();
                     _entriesQueue.pop_front();
                 }
@@ -194,12 +215,38 @@ private:
 
 
 /**
- * @brief The point of this thread is to remove entries that we are sure are no longer needed
- * e.g: they may have a hash that can no longer be produced
+ * @brief Removes entries that we are sure are no longer needed
+ * e.g: they may have a hash that can no longer be produced.
+ * Requests are processed in order by at most one housekeeping task of the TaskExecutor at a time.
  **/
-class CacheCleanerThread
-    : public QThread
+class CacheCleaner
 {
+    class CleanTask
+        : public ExecutorTask
+    {
+        CacheCleaner* _cleaner;
+
+    public:
+
+        CleanTask(CacheCleaner* cleaner)
+            : ExecutorTask()
+            , _cleaner(cleaner)
+        {
+        }
+
+        virtual void run() OVERRIDE FINAL
+        {
+            _cleaner->processQueue();
+        }
+
+        virtual void onDropped() OVERRIDE FINAL
+        {
+            _cleaner->processQueue();
+        }
+    };
+
+    friend class CleanTask;
+
     mutable QMutex _requestQueueMutex;
     struct CleanRequest
     {
@@ -209,28 +256,24 @@ class CacheCleanerThread
     };
 
     std::list<CleanRequest> _requestsQueues;
-    QWaitCondition _requestsQueueNotEmptyCond;
+
+    // True while a CleanTask is queued or running, protected by _requestQueueMutex
+    bool _taskScheduled;
+    QWaitCondition _queueProcessedCond;
     CacheAPI* cache;
-    QMutex mustQuitMutex;
-    QWaitCondition mustQuitCond;
-    bool mustQuit;
 
 public:
 
-    CacheCleanerThread(CacheAPI* cache)
-        : QThread()
-        , _requestQueueMutex()
+    CacheCleaner(CacheAPI* cache)
+        : _requestQueueMutex()
         , _requestsQueues()
-        , _requestsQueueNotEmptyCond()
+        , _taskScheduled(false)
+        , _queueProcessedCond()
         , cache(cache)
-        , mustQuitMutex()
-        , mustQuitCond()
-        , mustQuit(false)
     {
-        setObjectName( QString::fromUtf8("CacheCleaner") );
     }
 
-    virtual ~CacheCleanerThread()
+    ~CacheCleaner()
     {
     }
 
@@ -238,6 +281,7 @@ public:
                        U64 nodeHash,
                        bool removeAll)
     {
+        bool mustSchedule;
         {
             QMutexLocker k(&_requestQueueMutex);
             CleanRequest r;
@@ -245,32 +289,26 @@ public:
             r.nodeHash = nodeHash;
             r.removeAll = removeAll;
             _requestsQueues.push_back(r);
+            mustSchedule = !_taskScheduled;
+            _taskScheduled = true;
         }
-        if ( !isRunning() ) {
-            start();
-        } else {
-            QMutexLocker k(&_requestQueueMutex);
-            _requestsQueueNotEmptyCond.wakeOne();
+        if (mustSchedule) {
+            TaskExecutor* executor = appPTR ? appPTR->getTaskExecutor() : 0;
+            if ( !executor || !executor->submit( eTaskPriorityHousekeeping, ExecutorTaskPtr( new CleanTask(this) ) ) ) {
+                processQueue();
+            }
         }
     }
 
-    void quitThread()
+    /**
+     * @brief Blocks until the queue is processed
+     **/
+    void waitForQueueProcessed()
     {
-        if ( !isRunning() ) {
-            return;
-        }
-        QMutexLocker k(&mustQuitMutex);
-        assert(!mustQuit);
-        mustQuit = true;
+        QMutexLocker k(&_requestQueueMutex);
 
-        {
-            QMutexLocker k2(&_requestQueueMutex);
-            CleanRequest r;
-            _requestsQueues.push_back(r);
-            _requestsQueueNotEmptyCond.wakeOne();
-        }
-        while (mustQuit) {
-            mustQuitCond.wait(&mustQuitMutex);
+        while (_taskScheduled) {
+            _queueProcessedCond.wait(&_requestQueueMutex);
         }
     }
 
@@ -283,38 +321,22 @@ public:
 
 private:
 
-    virtual void run() OVERRIDE FINAL
+    void processQueue()
     {
         for (;; ) {
-            bool quit;
-            {
-                QMutexLocker k(&mustQuitMutex);
-                quit = mustQuit;
-            }
-
+            CleanRequest front;
             {
-                CleanRequest front;
-                {
-                    QMutexLocker k(&_requestQueueMutex);
-                    if ( quit && _requestsQueues.empty() ) {
-                        _requestQueueMutex.unlock();
-                        QMutexLocker k(&mustQuitMutex);
-                        assert(mustQuit);
-                        mustQuit = false;
-                        mustQuitCond.wakeOne();
+                QMutexLocker k(&_requestQueueMutex);
+                if ( _requestsQueues.empty() ) {
+                    _taskScheduled = false;
+                    _queueProcessedCond.wakeAll();
 
-                        return;
-                    }
-                    while ( _requestsQueues.empty() ) {
-                        _requestsQueueNotEmptyCond.wait(&_requestQueueMutex);
-                    }
-
-                    assert( !_requestsQueues.empty() );
-                    front = _requestsQueues.front();
-                    _requestsQueues.pop_front();
+                    return;
                 }
-                cache->removeAllEntriesWithDifferentNodeHashForHolderPrivate(front.holderID, front.nodeHash, front.removeAll);
+                front = _requestsQueues.front();
+                _requestsQueues.pop_front();
             }
+            cache->removeAllEntriesWithDifferentNodeHashForHolderPrivate(front.holderID, front.nodeHash, front.removeAll);
         }
     }
 };
@@ -381,7 +403,7 @@ template<typename EntryType>
 class Cache
     : public CacheAPI
 {
-    friend class CacheCleanerThread;
+    friend class CacheCleaner;
 public:
 
     typedef typename EntryType::hash_type hash_type;
@@ -488,9 +510,9 @@ private:
     ///Store the system physical total RAM in a member
     std::size_t _maxPhysicalRAM;
     bool _tearingDown;
-    mutable DeleterThread<EntryType> _deleterThread;
+    mutable CacheDeleter<EntryType> _deleter;
     mutable QWaitCondition _memoryFullCondition; //< protected by _sizeLock
-    mutable CacheCleanerThread _cleanerThread;
+    mutable CacheCleaner _cleaner;
 
     // If tiled, the cache will consist only of a few large files that each contain tiles of the same size.
     // This is useful to cache chunks of data that always have the same size.
@@ -530,9 +552,9 @@ public:
         , _signalEmitter(new CacheSignalEmitter)
         , _maxPhysicalRAM( getSystemTotalRAM() )
         , _tearingDown(false)
-        , _deleterThread(this)
+        , _deleter(this)
         , _memoryFullCondition()
-        , _cleanerThread(this)
+        , _cleaner(this)
         , _tileCacheMutex()
         , _isTiled(false)
         , _tileByteSize(0)
@@ -545,6 +567,9 @@ public:
 
     virtual ~Cache()
     {
+        // Tasks on the executor reference the deleter and the cleaner
+        waitForDeleterThread();
+
         QMutexLocker locker(&_lock);
 
         _tearingDown = true;
@@ -579,8 +604,8 @@ public:
 
     void waitForDeleterThread()
     {
-        _deleterThread.quitThread();
-        _cleanerThread.quitThread();
+        _deleter.waitForQueueProcessed();
+        _cleaner.waitForQueueProcessed();
     }
 
     /**
@@ -796,9 +821,11 @@ private:
             memoryCacheSize = _memoryCacheSize;
             maximumInMemorySize = std::max( (std::size_t)1, _maximumInMemorySize );
         }
+        ///The evicted entries are handed to the deleter once _lock is released: if it deletes them in this
+        ///thread, the memory freeing must not make all the threads calling get() wait
+        std::list<EntryTypePtr> entriesToBeDeleted;
         {
             QMutexLocker locker(&_lock);
-            std::list<EntryTypePtr> entriesToBeDeleted;
             double occupationPercentage = (double)memoryCacheSize / maximumInMemorySize;
             ///While the current cache size can't fit the new entry, erase the last recently used entries.
             ///Also if the total free RAM is under the limit of the system free RAM to keep free, erase LRU entries.
@@ -823,15 +850,14 @@ private:
 
                 occupationPercentage = (double)memoryCacheSize / maximumInMemorySize;
             }
+        }
+        if ( !entriesToBeDeleted.empty() ) {
+            ///Launch a separate thread whose function will be to delete all the entries to be deleted
+            _deleter.appendToQueue(entriesToBeDeleted);
 
-            if ( !entriesToBeDeleted.empty() ) {
-                ///Launch a separate thread whose function will be to delete all the entries to be deleted
-                _deleterThread.appendToQueue(entriesToBeDeleted);
-
-                ///Clearing the list here will not delete the objects pointing to by the shared_ptr's because we made a copy
-                ///that the separate thread will delete
-                entriesToBeDeleted.clear();
-            }
+            ///Clearing the list here will not delete the objects pointing to by the shared_ptr's because we made a copy
+            ///that the separate thread will delete
+            entriesToBeDeleted.clear();
         }
         {
             //If _maximumcacheSize == 0 we don't return 1 otherwise we would cause a deadlock
@@ -840,38 +866,38 @@ private:
 
             //_memoryCacheSize member will get updated while images are being destroyed by the parallel thread.
             //we wait for cache memory occupation to be < 100% to be sure we don't hit swap here
-            while ( occupationPercentage >= 1. && _deleterThread.isWorking() ) {
+            while ( occupationPercentage >= 1. && _deleter.isWorking() ) {
                 _memoryFullCondition.wait(&_sizeLock);
                 occupationPercentage =  _maximumCacheSize == 0 ? 0.99 : (double)_memoryCacheSize / _maximumCacheSize;
             }
         }
         if (_isTiled) {
-
-            QMutexLocker locker(&_lock);
-            // For tiled caches, we insert directly into the disk cache, so make sure there is room for it
-            std::list<EntryTypePtr> entriesToBeDeleted;
-            U64 diskCacheSize, maximumDiskCacheSize;
             {
-                QMutexLocker k(&_sizeLock);
-                diskCacheSize = _diskCacheSize;
-                maximumDiskCacheSize = std::max( (std::size_t)1, _maximumCacheSize - _maximumInMemorySize );
-            }
-            double diskPercentage = (double)diskCacheSize / maximumDiskCacheSize;
-            while (diskPercentage >= NATRON_CACHE_LIMIT_PERCENT) {
-                std::list<EntryTypePtr> deleted;
-                if ( !tryEvictDiskEntry(deleted) ) {
-                    break;
+                QMutexLocker locker(&_lock);
+                // For tiled caches, we insert directly into the disk cache, so make sure there is room for it
+                U64 diskCacheSize, maximumDiskCacheSize;
+                {
+                    QMutexLocker k(&_sizeLock);
+                    diskCacheSize = _diskCacheSize;
+                    maximumDiskCacheSize = std::max( (std::size_t)1, _maximumCacheSize - _maximumInMemorySize );
                 }
+                double diskPercentage = (double)diskCacheSize / maximumDiskCacheSize;
+                while (diskPercentage >= NATRON_CACHE_LIMIT_PERCENT) {
+                    std::list<EntryTypePtr> deleted;
+                    if ( !tryEvictDiskEntry(deleted) ) {
+                        break;
+                    }
 
-                for (typename std::list<EntryTypePtr>::iterator it = deleted.begin(); it != deleted.end(); ++it) {
-                    diskCacheSize -= (*it)->size();
-                    entriesToBeDeleted.push_back(*it);
+                    for (typename std::list<EntryTypePtr>::iterator it = deleted.begin(); it != deleted.end(); ++it) {
+                        diskCacheSize -= (*it)->size();
+                        entriesToBeDeleted.push_back(*it);
+                    }
+                    diskPercentage = (double)diskCacheSize / maximumDiskCacheSize;
                 }
-                diskPercentage = (double)diskCacheSize / maximumDiskCacheSize;
             }
             if ( !entriesToBeDeleted.empty() ) {
                 ///Launch a separate thread whose function will be to delete all the entries to be deleted
-                _deleterThread.appendToQueue(entriesToBeDeleted);
+                _deleter.appendToQueue(entriesToBeDeleted);
 
                 ///Clearing the list here will not delete the objects pointing to by the shared_ptr's because we made a copy
                 ///that the separate thread will delete
@@ -1505,7 +1531,7 @@ public:
             }
         } // QMutexLocker l(&_lock);
         if ( !toRemove.empty() ) {
-            _deleterThread.appendToQueue(toRemove);
+            _deleter.appendToQueue(toRemove);
 
             ///Clearing the list here will not delete the objects pointing to by the shared_ptr's because we made a copy
             ///that the separate thread will delete
@@ -1538,7 +1564,7 @@ public:
         } // QMutexLocker l(&_lock);
 
         if ( !toRemove.empty() ) {
-            _deleterThread.appendToQueue(toRemove);
+            _deleter.appendToQueue(toRemove);
 
             ///Clearing the list here will not delete the objects pointing to by the shared_ptr's because we made a copy
             ///that the separate thread will delete
@@ -1558,7 +1584,7 @@ public:
     void removeAllEntriesWithDifferentNodeHashForHolderPublic(const CacheEntryHolder* holder,
                                                               U64 nodeHash)
     {
-        _cleanerThread.appendToQueue(holder->getCacheID(), nodeHash, false);
+        _cleaner.appendToQueue(holder->getCacheID(), nodeHash, false);
     }
 
     void removeAllEntriesForHolderPublic(const CacheEntryHolder* holder,
@@ -1567,7 +1593,7 @@ public:
         if (blocking) {
             removeAllEntriesWithDifferentNodeHashForHolderPrivate(holder->getCacheID(), 0, true);
         } else {
-            _cleanerThread.appendToQueue(holder->getCacheID(), 0, true);
+            _cleaner.appendToQueue(holder->getCacheID(), 0, true);
         }
     }
 
@@ -1658,7 +1684,7 @@ private:
         } // QMutexLocker locker(&_lock);
 
         if ( !toDelete.empty() ) {
-            _deleterThread.appendToQueue(toDelete);
+            _deleter.appendToQueue(toDelete);
 
             ///Clearing the list here will not delete the objects pointing to by the shared_ptr's because we made a copy
             ///that the separate thread will delete
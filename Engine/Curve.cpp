@@ -258,8 +258,12 @@ Curve::Curve(const KnobIPtr& owner,
 }
 
 Curve::Curve(const Curve & other)
-    : _imp( new CurvePrivate(*other._imp) )
+    : _imp(new CurvePrivate)
 {
+    // other may be modified by another thread while we copy it
+    QMutexLocker l(&other._imp->_lock);
+
+    *_imp = *other._imp;
 }
 
 Curve::~Curve()
@@ -279,6 +283,7 @@ Curve::clearKeyFrames()
     QMutexLocker l(&_imp->_lock);
 
     _imp->keyFrames.clear();
+    ++_imp->changeCount;
 }
 
 bool
@@ -397,6 +402,7 @@ Curve::addKeyFrame(KeyFrame key)
 std::pair<KeyFrameSet::iterator, bool> Curve::addKeyFrameNoUpdate(const KeyFrame & cp)
 {
     // PRIVATE - should not lock
+    ++_imp->changeCount;
     if (!_imp->isParametric) { //< if keyframes are clamped to integers
         std::pair<KeyFrameSet::iterator, bool> newKey = _imp->keyFrames.insert(cp);
         // keyframe at this time exists, erase and insert again
@@ -457,6 +463,7 @@ Curve::removeKeyFrame(KeyFrameSet::const_iterator it)
     }
 
     _imp->keyFrames.erase(it);
+    ++_imp->changeCount;
 
     if (mustRefreshPrev) {
         refreshDerivatives( eCurveChangedReasonDerivativesChanged, find( prevKey.getTime() ) );
@@ -1074,6 +1081,7 @@ Curve::setXRange(double a,
 
     _imp->xMin = a;
     _imp->xMax = b;
+    ++_imp->changeCount;
 }
 
 std::pair<double, double> Curve::getXRange() const
@@ -1099,6 +1107,24 @@ Curve::getKeyFrames_mt_safe() const
     return _imp->keyFrames;
 }
 
+void
+Curve::getKeyFramesArray_mt_safe(std::vector<KeyFrame>* keys,
+                                 U64* changeCount) const
+{
+    QMutexLocker l(&_imp->_lock);
+
+    keys->assign( _imp->keyFrames.begin(), _imp->keyFrames.end() );
+    *changeCount = _imp->changeCount;
+}
+
+U64
+Curve::getChangeCount() const
+{
+    QMutexLocker l(&_imp->_lock);
+
+    return _imp->changeCount;
+}
+
 KeyFrameSet::iterator
 Curve::setKeyFrameValueAndTimeNoUpdate(double value,
                                        double time,
@@ -1405,6 +1431,7 @@ Curve::refreshDerivatives(Curve::CurveChangedReasonEnum reason,
     newKey.setLeftDerivative(vcurDerivLeft);
     newKey.setRightDerivative(vcurDerivRight);
 
+    ++_imp->changeCount;
     std::pair<KeyFrameSet::iterator, bool> newKeyIt = _imp->keyFrames.insert(newKey);
 
     // keyframe at this time exists, erase and insert again
@@ -1555,6 +1582,7 @@ Curve::setYRange(double yMin,
     _imp->yMin = yMin;
     _imp->yMax = yMax;
     _imp->hasYRange = true;
+    ++_imp->changeCount;
 }
 
 bool
@@ -1576,6 +1604,7 @@ void
 Curve::onCurveChanged()
 {
     // PRIVATE - should not lock
+    ++_imp->changeCount;
     KnobIPtr owner = _imp->owner.lock();
     if (owner) {
         owner->clearExpressionsResults(_imp->dimensionInOwner);
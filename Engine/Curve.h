@@ -245,6 +245,19 @@ public:
 
     KeyFrameSet getKeyFrames_mt_safe() const WARN_UNUSED_RETURN;
 
+    /**
+     * @brief Same as getKeyFrames_mt_safe() but copies the keyframes, by increasing time, into a contiguous array.
+     * The change count (see getChangeCount()) the keyframes correspond to is returned in changeCount.
+     **/
+    void getKeyFramesArray_mt_safe(std::vector<KeyFrame>* keys, U64* changeCount) const;
+
+    /**
+     * @brief Returns a counter which is incremented whenever the keyframes or the ranges of the curve change.
+     * Observers that derive data from the curve (e.g. the curve editor drawing) compare it with the value
+     * they last saw to know whether their data is stale.
+     **/
+    U64 getChangeCount() const WARN_UNUSED_RETURN;
+
     void clearKeyFrames();
 
     /**
@@ -69,7 +69,7 @@ struct CurvePrivate
     mutable QMutex _lock; //< the plug-ins can call getValueAt at any moment and we must make sure the user is not playing around
     bool isParametric;
     bool hasYRange;
-
+    U64 changeCount; //< incremented by Curve::onCurveChanged() and whenever keyFrames is modified
 
     CurvePrivate()
         : keyFrames()
@@ -86,11 +86,13 @@ struct CurvePrivate
         , _lock(QMutex::Recursive)
         , isParametric(false)
         , hasYRange(false)
+        , changeCount(0)
     {
     }
 
     CurvePrivate(const CurvePrivate & other)
         : _lock(QMutex::Recursive)
+        , changeCount(0)
     {
         *this = other;
     }
@@ -107,6 +109,7 @@ struct CurvePrivate
         yMin = other.yMin;
         yMax = other.yMax;
         hasYRange = other.hasYRange;
+        ++changeCount;
     }
 };
 
@@ -62,6 +62,7 @@ GCC_DIAG_UNUSED_LOCAL_TYPEDEFS_ON
 #include "Engine/ImageParams.h"
 #include "Engine/KnobFile.h"
 #include "Engine/KnobTypes.h"
+#include "Engine/KnobsRenderSnapshot.h"
 #include "Engine/Log.h"
 #include "Engine/Node.h"
 #include "Engine/OfxEffectInstance.h"
@@ -74,6 +75,7 @@ GCC_DIAG_UNUSED_LOCAL_TYPEDEFS_ON
 #include "Engine/PluginMemory.h"
 #include "Engine/Project.h"
 #include "Engine/RenderStats.h"
+#include "Engine/RenderTrace.h"
 #include "Engine/RotoContext.h"
 #include "Engine/RotoDrawableItem.h"
 #include "Engine/ReadNode.h"
@@ -249,6 +251,10 @@ EffectInstance::setParallelRenderArgsTLS(const SetParallelRenderTLSArgsPtr& inAr
     args->stats = inArgs->stats;
     args->openGLContext = inArgs->glContext;
     args->cpuOpenGLContext = inArgs->cpuGlContext;
+    // An analysis may set values on the knobs while rendering and read them back: they must be read live
+    if (!args->isAnalysis) {
+        args->knobsSnapshot = getOrCreateKnobsRenderSnapshot(args->nodeHash);
+    }
     argsList.push_back(args);
 }
 
@@ -314,6 +320,40 @@ EffectInstance::getParallelRenderArgsTLS() const
     return tls->frameArgs.back();
 }
 
+KnobsRenderSnapshotPtr
+EffectInstance::getOrCreateKnobsRenderSnapshot(U64 nodeHash)
+{
+    {
+        QMutexLocker k(&_imp->knobsRenderSnapshotMutex);
+        if ( _imp->knobsRenderSnapshot && (_imp->knobsRenderSnapshotHash == nodeHash) ) {
+            return _imp->knobsRenderSnapshot;
+        }
+    }
+
+    KnobsRenderSnapshotPtr snapshot( new KnobsRenderSnapshot( getKnobs_mt_safe() ) );
+
+    // If a knob changed since the render started, the snapshot does not match nodeHash: only use it for this render
+    if (getHash() == nodeHash) {
+        QMutexLocker k(&_imp->knobsRenderSnapshotMutex);
+        _imp->knobsRenderSnapshot = snapshot;
+        _imp->knobsRenderSnapshotHash = nodeHash;
+    }
+
+    return snapshot;
+}
+
+const KnobsRenderSnapshot*
+EffectInstance::getCurrentRenderKnobsSnapshot() const
+{
+    EffectDataTLSPtr tls = _imp->tlsData->getTLSData();
+
+    if ( !tls || tls->frameArgs.empty() ) {
+        return 0;
+    }
+
+    return tls->frameArgs.back()->knobsSnapshot.get();
+}
+
 U64
 EffectInstance::getHash() const
 {
@@ -943,6 +983,7 @@ EffectInstance::getImage(int inputNb,
         *roiPixel = pixelRoI;
     }
     unsigned int inputImgMipMapLevel = inputImg->getMipMapLevel();
+    bool inputImgRescaled = false;
 
     ///If the plug-in doesn't support the render scale, but the image is downscaled, up-scale it.
     ///Note that we do NOT cache it because it is really low def!
@@ -970,6 +1011,7 @@ EffectInstance::getImage(int inputNb,
         }
 
         inputImg = rescaledImg;
+        inputImgRescaled = true;
     }
 
 
@@ -983,7 +1025,8 @@ EffectInstance::getImage(int inputNb,
 
 
     if (mapToClipPrefs) {
-        inputImg = convertPlanesFormatsIfNeeded(getApp(), inputImg, pixelRoI, clipPrefComps, depth, getNode()->usesAlpha0ToConvertFromRGBToRGBA(), outputPremult, channelForMask);
+        // Upscaled images are local to this render: do not share their conversion through the cache
+        inputImg = convertPlanesFormatsIfNeeded(inputImg, pixelRoI, clipPrefComps, depth, getNode()->usesAlpha0ToConvertFromRGBToRGBA(), outputPremult, channelForMask, !duringPaintStroke && !inputImgRescaled);
     }
 
 #ifdef DEBUG
@@ -1712,12 +1755,16 @@ EffectInstance::getImageFromCacheAndConvertIfNeeded(bool /*useCache*/,
     }
 
     if (!isCached) {
+        RenderTraceScope trace("cache", "cache lookup", this);
         // For textures, we lookup for a RAM image, if found we convert it to a texture
         if ( (storage == eStorageModeRAM) || (storage == eStorageModeGLTex) ) {
             isCached = appPTR->getImage(key, &cachedImages);
         } else if (storage == eStorageModeDisk) {
             isCached = appPTR->getImage_diskCache(key, &cachedImages);
         }
+        if ( trace.isActive() ) {
+            trace.setDetail(isCached ? "hit" : "miss");
+        }
     }
 
     if (stats && stats->isInDepthProfilingEnabled() && !isCached) {
@@ -2340,6 +2387,13 @@ EffectInstance::Implementation::tiledRenderingFunctor(const RectToRender & rectT
 
     assert( !rectToRender.rect.isNull() );
 
+    RenderTraceScope trace("render", "tile", _publicInterface);
+    if ( trace.isActive() ) {
+        std::stringstream ss;
+        ss << rectToRender.rect.x1 << ' ' << rectToRender.rect.y1 << ' ' << rectToRender.rect.x2 << ' ' << rectToRender.rect.y2;
+        trace.setDetail( ss.str() );
+    }
+
     // renderMappedRectToRender is in the mapped mipmap level, i.e the expected mipmap level of the render action of the plug-in
     // downscaledRectToRender is in the mipMapLevel
     RectI renderMappedRectToRender, downscaledRectToRender;
@@ -2385,6 +2439,10 @@ EffectInstance::Implementation::tiledRenderingFunctor(const RectToRender & rectT
     bool multiPlanar = _publicInterface->isMultiPlanar();
     {
         RenderingFunctorRetEnum internalRet = renderHandlerInternal(tls, glContext, actionArgs, *planes, multiPlanar, bitmapMarkedForRendering, outputClipPrefsComps, outputClipPrefDepth, outputPlanes, &glContextAttacher);
+        // The wait time is recorded whenever the render is timed, not only with in-depth profiling
+        if ( timeRecorder && glContextAttacher && (glContextAttacher->getTimeSpentWaiting() > 0) ) {
+            frameArgs->stats->addOpenGLContextWaitTimeForNode( _publicInterface->getNode(), glContextAttacher->getTimeSpentWaiting() );
+        }
         if (internalRet != eRenderingFunctorRetOK) {
             return internalRet;
         }
@@ -3849,6 +3907,7 @@ EffectInstance::render_public(const RenderActionArgs & args)
 {
     NON_RECURSIVE_ACTION();
     REPORT_CURRENT_THREAD_ACTION( "kOfxImageEffectActionRender", getNode() );
+    RenderTraceScope trace("action", "render", this);
     try {
         return render(args);
     } catch (...) {
@@ -3914,6 +3973,7 @@ EffectInstance::isIdentity_public(bool useIdentityCache, // only set to true whe
         /// Don't call isIdentity if plugin is sequential only.
         if (getSequentialPreference() != eSequentialPreferenceOnlySequential) {
             try {
+                RenderTraceScope trace("action", "isIdentity", this);
                 *inputView = view;
                 ret = isIdentity(time, scale, renderWindow, view, inputTime, inputView, inputNb);
             } catch (...) {
@@ -4016,8 +4076,10 @@ EffectInstance::getRegionOfDefinition_public(U64 hash,
         {
             RECURSIVE_ACTION();
 
-
-            ret = getRegionOfDefinition(hash, time, supportsRenderScaleMaybe() == eSupportsNo ? scaleOne : scale, view, rod);
+            {
+                RenderTraceScope trace("action", "getRegionOfDefinition", this);
+                ret = getRegionOfDefinition(hash, time, supportsRenderScaleMaybe() == eSupportsNo ? scaleOne : scale, view, rod);
+            }
 
             if ( (ret != eStatusOK) && (ret != eStatusReplyDefault) ) {
                 // rod is not valid
@@ -4081,6 +4143,7 @@ EffectInstance::getFramesNeeded_public(U64 hash,
     }
 
     try {
+        RenderTraceScope trace("action", "getFramesNeeded", this);
         framesNeeded = getFramesNeeded(time, view);
     } catch (std::exception &e) {
         if ( !hasPersistentMessage() ) { // plugin may already have set a message
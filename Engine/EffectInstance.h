@@ -684,6 +684,15 @@ public:
 
     ParallelRenderArgsPtr getParallelRenderArgsTLS() const;
 
+    /**
+     * @brief Returns a snapshot of the knobs of this effect matching the given hash of the node.
+     * The snapshot made for the previous render is returned if it was made for the same hash, so that all
+     * the frames rendered without any change to the node share the same snapshot.
+     **/
+    KnobsRenderSnapshotPtr getOrCreateKnobsRenderSnapshot(U64 nodeHash);
+
+    virtual const KnobsRenderSnapshot* getCurrentRenderKnobsSnapshot() const OVERRIDE FINAL WARN_UNUSED_RETURN;
+
     //Implem in ParallelRenderArgs.cpp
     static StatusEnum getInputsRoIsFunctor(bool useTransforms,
                                            double time,
@@ -2144,14 +2153,19 @@ private:
                                              EffectInstance::InputImagesMap *inputImages,
                                              RoIMap* inputsRoI);
 
-    static ImagePtr convertPlanesFormatsIfNeeded(const AppInstancePtr& app,
-                                                                 const ImagePtr& inputImage,
-                                                                 const RectI& roi,
-                                                                 const ImageComponents& targetComponents,
-                                                                 ImageBitDepthEnum targetDepth,
-                                                                 bool useAlpha0ForRGBToRGBAConversion,
-                                                                 ImagePremultiplicationEnum outputPremult,
-                                                                 int channelForAlpha);
+    /**
+     * @brief Returns inputImage converted to the given components and bit depth in the given roi, or inputImage itself
+     * if it already has this format. If useCache is true, the converted image is stored in the cache next to inputImage
+     * so that other tiles, render clones and consumers only convert the part that was not converted yet.
+     **/
+    ImagePtr convertPlanesFormatsIfNeeded(const ImagePtr& inputImage,
+                                          const RectI& roi,
+                                          const ImageComponents& targetComponents,
+                                          ImageBitDepthEnum targetDepth,
+                                          bool useAlpha0ForRGBToRGBAConversion,
+                                          ImagePremultiplicationEnum outputPremult,
+                                          int channelForAlpha,
+                                          bool useCache);
 
 
     /**
@@ -347,6 +347,9 @@ EffectInstance::Implementation::Implementation(EffectInstance* publicInterface)
     , isDoingInstanceSafeRender(false)
     , renderClonesMutex()
     , renderClonesPool()
+    , knobsRenderSnapshotMutex()
+    , knobsRenderSnapshot()
+    , knobsRenderSnapshotHash(0)
 {
 }
 
@@ -377,6 +380,9 @@ EffectInstance::Implementation::Implementation(const Implementation& other)
 , isDoingInstanceSafeRender(false)
 , renderClonesMutex()
 , renderClonesPool()
+, knobsRenderSnapshotMutex()
+, knobsRenderSnapshot()
+, knobsRenderSnapshotHash(0)
 {
 
 }
@@ -222,6 +222,12 @@ public:
     mutable QMutex renderClonesMutex;
     std::list<EffectInstancePtr> renderClonesPool;
 
+    // The snapshot of the knobs made for the last render and the hash of the node it was made for,
+    // see EffectInstance::getOrCreateKnobsRenderSnapshot
+    mutable QMutex knobsRenderSnapshotMutex;
+    KnobsRenderSnapshotPtr knobsRenderSnapshot;
+    U64 knobsRenderSnapshotHash;
+
     void runChangedParamCallback(const KnobIPtr& k, bool userEdited, const std::string & callback);
 
     void setDuringInteractAction(bool b);
@@ -69,6 +69,7 @@ GCC_DIAG_UNUSED_LOCAL_TYPEDEFS_ON
 #include "Engine/OutputSchedulerThread.h"
 #include "Engine/OSGLContext.h"
 #include "Engine/GPUContextPool.h"
+#include "Engine/Hash64.h"
 #include "Engine/PluginMemory.h"
 #include "Engine/Project.h"
 #include "Engine/RenderStats.h"
@@ -85,6 +86,25 @@ GCC_DIAG_UNUSED_LOCAL_TYPEDEFS_ON
 
 NATRON_NAMESPACE_ENTER;
 
+/*
+ * @brief If the plane was rendered in a resized copy of the image found in the cache (see cacheSwapImage),
+ * replace the cached image by the copy.
+ */
+static void
+swapResizedImageInCache(const EffectInstance::PlaneToRender& plane)
+{
+    if (!plane.cacheSwapImage) {
+        return;
+    }
+    const CacheAPI* cache = plane.cacheSwapImage->getCacheAPI();
+    const ImageCache* imgCache = dynamic_cast<const ImageCache*>(cache);
+    if (imgCache) {
+        ImageCache* ccImgCache = const_cast<ImageCache*>(imgCache);
+        assert(ccImgCache);
+        ccImgCache->swapOrInsert(plane.cacheSwapImage, plane.fullscaleImage);
+    }
+}
+
 /*
  * @brief Split all rects to render in smaller rects and check if each one of them is identity.
  * For identity rectangles, we just call renderRoI again on the identity input in the tiledRenderingFunctor.
@@ -164,15 +184,51 @@ optimizeRectsToRender(const EffectInstancePtr& self,
     }
 } // optimizeRectsToRender
 
+/**
+ * @brief Returns the hash of everything that determines the result of converting an image of the given key to another format.
+ * It is stored in the key of the converted image so it is found in the cache next to the image it was converted from.
+ **/
+static U64
+makeFormatConversionHash(const Image& inputImage,
+                         const ImageComponents& targetComponents,
+                         ImageBitDepthEnum targetDepth,
+                         ViewerColorSpaceEnum srcColorSpace,
+                         ViewerColorSpaceEnum dstColorSpace,
+                         bool useAlpha0ForRGBToRGBAConversion,
+                         bool unPremultIfNeeded,
+                         int channelForAlpha)
+{
+    Hash64 hash;
+    const ImageComponents& srcComponents = inputImage.getComponents();
+
+    Hash64_appendQString( &hash, QString::fromUtf8( srcComponents.getLayerName().c_str() ) );
+    Hash64_appendQString( &hash, QString::fromUtf8( srcComponents.getComponentsGlobalName().c_str() ) );
+    hash.append<int>( (int)inputImage.getBitDepth() );
+    hash.append<int>( (int)inputImage.getPremultiplication() );
+    hash.append<unsigned int>( inputImage.getMipMapLevel() );
+    Hash64_appendQString( &hash, QString::fromUtf8( targetComponents.getLayerName().c_str() ) );
+    Hash64_appendQString( &hash, QString::fromUtf8( targetComponents.getComponentsGlobalName().c_str() ) );
+    hash.append<int>( (int)targetDepth );
+    hash.append<int>( (int)srcColorSpace );
+    hash.append<int>( (int)dstColorSpace );
+    hash.append<bool>(useAlpha0ForRGBToRGBAConversion);
+    hash.append<bool>(unPremultIfNeeded);
+    hash.append<int>(channelForAlpha);
+    hash.computeHash();
+
+    // 0 is reserved for images that are not a conversion
+    return hash.value() ? hash.value() : 1;
+}
+
 ImagePtr
-EffectInstance::convertPlanesFormatsIfNeeded(const AppInstancePtr& app,
-                                             const ImagePtr& inputImage,
+EffectInstance::convertPlanesFormatsIfNeeded(const ImagePtr& inputImage,
                                              const RectI& roi,
                                              const ImageComponents& targetComponents,
                                              ImageBitDepthEnum targetDepth,
                                              bool useAlpha0ForRGBToRGBAConversion,
                                              ImagePremultiplicationEnum outputPremult,
-                                             int channelForAlpha)
+                                             int channelForAlpha,
+                                             bool useCache)
 {
     // Do not do any conversion for OpenGL textures, OpenGL is managing it for us.
     if (inputImage->getStorageMode() == eStorageModeGLTex) {
@@ -182,41 +238,89 @@ EffectInstance::convertPlanesFormatsIfNeeded(const AppInstancePtr& app,
 
     if (!imageConversionNeeded) {
         return inputImage;
+    }
+
+    AppInstancePtr app = getApp();
+    ViewerColorSpaceEnum srcColorSpace = app->getDefaultColorSpaceForBitDepth( inputImage->getBitDepth() );
+    ViewerColorSpaceEnum dstColorSpace = app->getDefaultColorSpaceForBitDepth(targetDepth);
+    bool unPremultIfNeeded = outputPremult == eImagePremultiplicationPremultiplied && inputImage->getComponentsCount() == 4 && targetComponents.getNumComponents() == 3;
+
+    /**
+     * Lock the downscaled image so it cannot be resized while creating the temp image and calling convertToFormat.
+     **/
+    Image::ReadAccess acc = inputImage->getReadRights();
+    RectI bounds = inputImage->getBounds();
+    RectI clippedRoi;
+    roi.intersect(bounds, &clippedRoi);
+
+    // The converted image can only be shared through the cache if the input image is fully rendered in the RoI: otherwise
+    // (e.g: the render was aborted) the bitmap of the converted image would claim pixels that were never rendered.
+    if ( useCache && inputImage->usesBitMap() ) {
+        std::list<RectI> restToRender;
+        inputImage->getRestToRender(clippedRoi, restToRender);
+        useCache = restToRender.empty();
     } else {
-        /**
-         * Lock the downscaled image so it cannot be resized while creating the temp image and calling convertToFormat.
-         **/
-        Image::ReadAccess acc = inputImage->getReadRights();
-        RectI bounds = inputImage->getBounds();
-        ImagePtr tmp( new Image(targetComponents,
-                                inputImage->getRoD(),
-                                bounds,
-                                inputImage->getMipMapLevel(),
-                                inputImage->getPixelAspectRatio(),
-                                targetDepth,
-                                inputImage->getPremultiplication(),
-                                inputImage->getFieldingOrder(),
-                                false) );
+        useCache = false;
+    }
+
+    ImagePtr tmp;
+    if (useCache) {
+        ImageKey key = inputImage->getKey();
+        key._conversionHash = makeFormatConversionHash(*inputImage, targetComponents, targetDepth, srcColorSpace, dstColorSpace, useAlpha0ForRGBToRGBAConversion, unPremultIfNeeded, channelForAlpha);
+        key.resetHash();
+        ImageParamsPtr params = Image::makeParams( inputImage->getRoD(),
+                                                   bounds,
+                                                   inputImage->getPixelAspectRatio(),
+                                                   inputImage->getMipMapLevel(),
+                                                   inputImage->getParams()->isRodProjectFormat(),
+                                                   targetComponents,
+                                                   targetDepth,
+                                                   inputImage->getPremultiplication(),
+                                                   inputImage->getFieldingOrder() );
+        appPTR->getImageOrCreate(key, params, 0, &tmp);
+        if (tmp) {
+            tmp->allocateMemory();
+            tmp->ensureBounds(OSGLContextPtr(), bounds);
+        }
+    }
+
+    std::list<RectI> rectsToConvert;
+    if (tmp) {
+        // Only convert what another tile, render clone or consumer did not convert already
+        tmp->getRestToRender(clippedRoi, rectsToConvert);
+    } else {
+        tmp.reset( new Image(targetComponents,
+                             inputImage->getRoD(),
+                             bounds,
+                             inputImage->getMipMapLevel(),
+                             inputImage->getPixelAspectRatio(),
+                             targetDepth,
+                             inputImage->getPremultiplication(),
+                             inputImage->getFieldingOrder(),
+                             false) );
         tmp->setKey(inputImage->getKey());
-        RectI clippedRoi;
-        roi.intersect(bounds, &clippedRoi);
+        rectsToConvert.push_back(clippedRoi);
+    }
 
-        bool unPremultIfNeeded = outputPremult == eImagePremultiplicationPremultiplied && inputImage->getComponentsCount() == 4 && tmp->getComponentsCount() == 3;
+    ParallelRenderArgsPtr frameArgs = getParallelRenderArgsTLS();
+    if ( frameArgs && frameArgs->stats && frameArgs->stats->isInDepthProfilingEnabled() ) {
+        frameArgs->stats->addFormatConversionInfosForNode( getNode(), rectsToConvert.empty() );
+    }
 
+    for (std::list<RectI>::const_iterator it = rectsToConvert.begin(); it != rectsToConvert.end(); ++it) {
         if (useAlpha0ForRGBToRGBAConversion) {
-            inputImage->convertToFormatAlpha0( clippedRoi,
-                                               app->getDefaultColorSpaceForBitDepth( inputImage->getBitDepth() ),
-                                               app->getDefaultColorSpaceForBitDepth(targetDepth),
+            inputImage->convertToFormatAlpha0( *it,
+                                               srcColorSpace, dstColorSpace,
                                                channelForAlpha, false, unPremultIfNeeded, tmp.get() );
         } else {
-            inputImage->convertToFormat( clippedRoi,
-                                         app->getDefaultColorSpaceForBitDepth( inputImage->getBitDepth() ),
-                                         app->getDefaultColorSpaceForBitDepth(targetDepth),
+            inputImage->convertToFormat( *it,
+                                         srcColorSpace, dstColorSpace,
                                          channelForAlpha, false, unPremultIfNeeded, tmp.get() );
         }
-
-        return tmp;
+        tmp->markForRendered(*it);
     }
+
+    return tmp;
 } // EffectInstance::convertPlanesFormatsIfNeeded
 
 void
@@ -686,8 +790,8 @@ EffectInstance::Implementation::handleIdentityEffect(const EffectInstance::Rende
                 if (fetchUserSelectedComponentsUpstream) {
                     // We fetched potentially different components, so convert them to the format requested
                     std::map<ImageComponents, ImagePtr> convertedPlanes;
-                    AppInstancePtr app = _publicInterface->getApp();
                     bool useAlpha0ForRGBToRGBAConversion = args.caller ? args.caller->getNode()->usesAlpha0ToConvertFromRGBToRGBA() : false;
+                    const bool useConversionCache = !args.byPassCache && !frameArgs->isDuringPaintStrokeCreation;
                     std::list<ImageComponents>::const_iterator compIt = args.components.begin();
 
                     for (std::map<ImageComponents, ImagePtr>::iterator it = outputPlanes->begin(); it != outputPlanes->end(); ++it, ++compIt) {
@@ -699,7 +803,7 @@ EffectInstance::Implementation::handleIdentityEffect(const EffectInstance::Rende
                             premult = eImagePremultiplicationOpaque;
                         }
 
-                        ImagePtr tmp = convertPlanesFormatsIfNeeded(app, it->second, args.roi, *compIt, inputArgs->bitdepth, useAlpha0ForRGBToRGBAConversion, premult, -1);
+                        ImagePtr tmp = _publicInterface->convertPlanesFormatsIfNeeded(it->second, args.roi, *compIt, inputArgs->bitdepth, useAlpha0ForRGBToRGBAConversion, premult, -1, useConversionCache);
                         assert(tmp);
                         convertedPlanes[it->first] = tmp;
                     }
@@ -1923,6 +2027,8 @@ EffectInstance::Implementation::renderRoITermination(const RenderRoIArgs & args,
     ////////////////// Make sure all planes rendered have the requested  format ///////////////////////////
 
     bool useAlpha0ForRGBToRGBAConversion = args.caller ? args.caller->getNode()->usesAlpha0ToConvertFromRGBToRGBA() : false;
+    // The content of an image changes under the same key while painting
+    const bool useConversionCache = !renderAborted && !args.byPassCache && !frameArgs->isDuringPaintStrokeCreation;
 
     // If the caller is not multiplanar, for the color plane we remap it to the components metadata obtained from the metadata pass, otherwise we stick to returning
     //bool callerIsMultiplanar = args.caller ? args.caller->isMultiPlanar() : false;
@@ -1930,15 +2036,7 @@ EffectInstance::Implementation::renderRoITermination(const RenderRoIArgs & args,
     //bool multiplanar = isMultiPlanar();
     for (std::map<ImageComponents, EffectInstance::PlaneToRender>::iterator it = planesToRender->planes.begin(); it != planesToRender->planes.end(); ++it) {
         //If we have worked on a local swaped image, swap it in the cache
-        if (it->second.cacheSwapImage) {
-            const CacheAPI* cache = it->second.cacheSwapImage->getCacheAPI();
-            const ImageCache* imgCache = dynamic_cast<const ImageCache*>(cache);
-            if (imgCache) {
-                ImageCache* ccImgCache = const_cast<ImageCache*>(imgCache);
-                assert(ccImgCache);
-                ccImgCache->swapOrInsert(it->second.cacheSwapImage, it->second.fullscaleImage);
-            }
-        }
+        swapResizedImageInCache(it->second);
 
         //We have to return the downscale image, so make sure it has been computed
         if ( (renderRetCode != eRenderRoIStatusRenderFailed) &&
@@ -1977,7 +2075,7 @@ EffectInstance::Implementation::renderRoITermination(const RenderRoIArgs & args,
         assert(comp);
         ///The image might need to be converted to fit the original requested format
         if (comp) {
-            it->second.downscaleImage = convertPlanesFormatsIfNeeded(_publicInterface->getApp(), it->second.downscaleImage, originalRoI, *comp, args.bitdepth, useAlpha0ForRGBToRGBAConversion, planesToRender->outputPremult, -1);
+            it->second.downscaleImage = _publicInterface->convertPlanesFormatsIfNeeded(it->second.downscaleImage, originalRoI, *comp, args.bitdepth, useAlpha0ForRGBToRGBAConversion, planesToRender->outputPremult, -1, useConversionCache);
             assert(it->second.downscaleImage->getStorageMode() == eStorageModeGLTex ||  (it->second.downscaleImage->getComponents() == *comp && it->second.downscaleImage->getBitDepth() == args.bitdepth));
 
             StorageModeEnum imageStorage = it->second.downscaleImage->getStorageMode();
@@ -2219,6 +2317,12 @@ EffectInstance::renderRoI(const RenderRoIArgs & args,
         if (frameArgs->isDuringPaintStrokeCreation) {
             //We know the image will never be used ever again
             getNode()->removeAllImagesFromCache(false);
+        } else if ( hasSomethingToRender && !frameArgs->isCurrentFrameRenderNotAbortable() && (getHash() == nodeHash) ) {
+            // The tiles finished before the abort are marked as rendered in the bitmap. The node did not change since, so
+            // they are still valid: keep the images we rendered in so that the next render only computes what is left.
+            for (std::map<ImageComponents, EffectInstance::PlaneToRender>::iterator it = planesToRender->planes.begin(); it != planesToRender->planes.end(); ++it) {
+                swapResizedImageInCache(it->second);
+            }
         }
 
         return eRenderRoIRetCodeAborted;
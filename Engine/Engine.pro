@@ -123,11 +123,14 @@ SOURCES += \
     KnobFactory.cpp \
     KnobFile.cpp \
     KnobTypes.cpp \
+    KnobsRenderSnapshot.cpp \
     LibraryBinary.cpp \
+    LocalRenderFarm.cpp \
     Log.cpp \
     Lut.cpp \
     Markdown.cpp \
     MemoryFile.cpp \
+    MultiThreadExecutor.cpp \
     Node.cpp \
     NodeGroup.cpp \
     NodeMetadata.cpp \
@@ -154,8 +157,10 @@ SOURCES += \
     OutputEffectInstance.cpp \
     OutputSchedulerThread.cpp \
     ParallelRenderArgs.cpp \
+    PlaybackController.cpp \
     Plugin.cpp \
     PluginMemory.cpp \
+    PrecompCache.cpp \
     PrecompNode.cpp \
     ProcessHandler.cpp \
     Project.cpp \
@@ -171,7 +176,9 @@ SOURCES += \
     ReadNode.cpp \
     RectD.cpp \
     RectI.cpp \
+    RenderBenchmark.cpp \
     RenderStats.cpp \
+    RenderTrace.cpp \
     RotoBezierTriangulation.cpp \
     RotoContext.cpp \
     RotoDrawableItem.cpp \
@@ -182,6 +189,7 @@ SOURCES += \
     RotoShapeRenderNode.cpp \
     RotoShapeRenderNodePrivate.cpp \
     RotoShapeRenderCairo.cpp \
+    RotoShapeRenderCPU.cpp \
     RotoShapeRenderGL.cpp \
     RotoStrokeItem.cpp \
     RotoUndoCommand.cpp \
@@ -189,6 +197,7 @@ SOURCES += \
     Settings.cpp \
     StandardPaths.cpp \
     StringAnimationManager.cpp \
+    TaskExecutor.cpp \
     Texture.cpp \
     TextureRect.cpp \
     ThreadPool.cpp \
@@ -205,6 +214,7 @@ SOURCES += \
     Transform.cpp \
     Utils.cpp \
     ViewerInstance.cpp \
+    ViewerTileCodec.cpp \
     WriteNode.cpp \
     ../Global/glad_source.c \
     ../Global/ProcInfo.cpp \
@@ -330,13 +340,16 @@ HEADERS += \
     KnobFactory.h \
     KnobFile.h \
     KnobTypes.h \
+    KnobsRenderSnapshot.h \
     LibraryBinary.h \
+    LocalRenderFarm.h \
     Log.h \
     LogEntry.h \
     LRUHashTable.h \
     Lut.h \
     Markdown.h \
     MemoryFile.h \
+    MultiThreadExecutor.h \
     MergingEnum.h \
     Node.h \
     NodeGroup.h \
@@ -368,9 +381,11 @@ HEADERS += \
     OutputSchedulerThread.h \
     OverlaySupport.h \
     ParallelRenderArgs.h \
+    PlaybackController.h \
     Plugin.h \
     PluginActionShortcut.h \
     PluginMemory.h \
+    PrecompCache.h \
     PrecompNode.h \
     ProcessHandler.h \
     Project.h \
@@ -389,7 +404,9 @@ HEADERS += \
     RectDSerialization.h \
     RectI.h \
     RectISerialization.h \
+    RenderBenchmark.h \
     RenderStats.h \
+    RenderTrace.h \
     RotoBezierTriangulation.h \
     RotoContext.h \
     RotoContextPrivate.h \
@@ -406,6 +423,7 @@ HEADERS += \
     RotoShapeRenderNode.h \
     RotoShapeRenderNodePrivate.h \
     RotoShapeRenderCairo.h \
+    RotoShapeRenderCPU.h \
     RotoShapeRenderGL.h \
     RotoStrokeItem.h \
     RotoStrokeItemSerialization.h \
@@ -415,6 +433,7 @@ HEADERS += \
     Singleton.h \
     StandardPaths.h \
     StringAnimationManager.h \
+    TaskExecutor.h \
     Texture.h \
     TextureRect.h \
     TextureRectSerialization.h \
@@ -441,6 +460,7 @@ HEADERS += \
     VariantSerialization.h \
     ViewerInstance.h \
     ViewerInstancePrivate.h \
+    ViewerTileCodec.h \
     ViewIdx.h \
     WriteNode.h \
     ../Global/Enums.h \
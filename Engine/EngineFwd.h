@@ -173,12 +173,15 @@ class KnobLayers;
 class KnobOutputFile;
 class KnobPage;
 class KnobParametric;
+class KnobsRenderSnapshot;
+struct KnobDimensionSnapshot;
 class KnobPath;
 class KnobSeparator;
 class KnobSerialization;
 class KnobString;
 class KnobTable;
 class LibraryBinary;
+class LocalRenderFarm;
 class LogEntry;
 class NamedKnobHolder;
 class Node;
@@ -221,9 +224,11 @@ class ProjectSerialization;
 class ReadNode;
 class RectD;
 class RectI;
+class RenderBenchmark;
 class RenderEngine;
 class RenderStats;
 class RenderingFlagSetter;
+class RotoBezierTriangulationCache;
 class RotoContext;
 class RotoDrawableItem;
 class RotoDrawableItemSerialization;
@@ -241,6 +246,7 @@ class RotoStrokeItemSerialization;
 class Settings;
 class StringAnimationManager;
 class TLSHolderBase;
+class TaskExecutor;
 class Texture;
 class TextureRect;
 class TimeLine;
@@ -323,6 +329,7 @@ typedef boost::shared_ptr<KnobOutputFile> KnobOutputFilePtr;
 typedef boost::shared_ptr<KnobPath> KnobPathPtr;
 typedef boost::shared_ptr<KnobPage> KnobPagePtr;
 typedef boost::shared_ptr<KnobParametric> KnobParametricPtr;
+typedef boost::shared_ptr<KnobsRenderSnapshot> KnobsRenderSnapshotPtr;
 typedef boost::shared_ptr<KnobSeparator> KnobSeparatorPtr;
 typedef boost::shared_ptr<KnobSerialization> KnobSerializationPtr;
 typedef boost::shared_ptr<KnobString> KnobStringPtr;
@@ -350,6 +357,7 @@ typedef boost::shared_ptr<Project> ProjectPtr;
 typedef boost::shared_ptr<PluginGroupNode> PluginGroupNodePtr;
 typedef boost::shared_ptr<PluginMemory> PluginMemoryPtr;
 typedef boost::shared_ptr<ReadNode> ReadNodePtr;
+typedef boost::shared_ptr<RenderBenchmark> RenderBenchmarkPtr;
 typedef boost::shared_ptr<RenderEngine> RenderEnginePtr;
 typedef boost::shared_ptr<RenderStats> RenderStatsPtr;
 typedef boost::shared_ptr<RotoContext> RotoContextPtr;
@@ -381,6 +389,7 @@ typedef boost::shared_ptr<WriteNode> WriteNodePtr;
 typedef boost::weak_ptr<AbortableRenderInfo> AbortableRenderInfoWPtr;
 typedef boost::weak_ptr<AppInstance> AppInstanceWPtr;
 typedef boost::weak_ptr<Bezier> BezierWPtr;
+typedef boost::weak_ptr<Curve> CurveWPtr;
 typedef boost::weak_ptr<EffectInstance> EffectInstanceWPtr;
 typedef boost::weak_ptr<OSGLContext> OSGLContextWPtr;
 typedef boost::weak_ptr<Image> ImageWPtr;
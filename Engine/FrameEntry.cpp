@@ -29,6 +29,7 @@
 #include <stdexcept>
 
 #include "Engine/RectI.h"
+#include "Engine/ViewerTileCodec.h"
 
 NATRON_NAMESPACE_ENTER;
 
@@ -37,6 +38,9 @@ const U8*
 FrameEntry::pixelAt(int x,
                     int y ) const
 {
+    if ( isCompressed() ) {
+        return 0;
+    }
     const TextureRect& bounds = _key.getTexRect();
 
     if ( (x < bounds.x1) || (x >= bounds.x2) || (y < bounds.y1) || (y > bounds.y2) ) {
@@ -55,6 +59,10 @@ FrameEntry::pixelAt(int x,
 void
 FrameEntry::copy(const FrameEntry& other)
 {
+    assert( !isCompressed() && !other.isCompressed() );
+    if ( isCompressed() || other.isCompressed() ) {
+        return;
+    }
     U8* dstPixels = data();
 
     assert(dstPixels);
@@ -120,4 +128,41 @@ FrameEntry::copy(const FrameEntry& other)
     }
 } // FrameEntry::copy
 
+std::size_t
+FrameEntry::getUncompressedSizeInBytes() const
+{
+    const RectI& bounds = _params->getStorageInfo().bounds;
+
+    return ViewerTileCodec::getUncompressedSize( bounds.width(), bounds.height(), (ImageBitDepthEnum)_key.getBitDepth() );
+}
+
+bool
+FrameEntry::compressPixels(const U8* pixels)
+{
+    assert( isCompressed() );
+    U8* dst = data();
+    if (!dst) {
+        return false;
+    }
+    const RectI& bounds = _params->getStorageInfo().bounds;
+    std::size_t written = ViewerTileCodec::encode( pixels, bounds.width(), bounds.height(), (ImageBitDepthEnum)_key.getBitDepth(),
+                                                   dst, getSizeInBytesFromParams() );
+
+    return written > 0;
+}
+
+bool
+FrameEntry::uncompressPixels(U8* pixels) const
+{
+    assert( isCompressed() );
+    const U8* src = data();
+    if (!src) {
+        return false;
+    }
+    const RectI& bounds = _params->getStorageInfo().bounds;
+
+    return ViewerTileCodec::decode( src, getSizeInBytesFromParams(), bounds.width(), bounds.height(), (ImageBitDepthEnum)_key.getBitDepth(),
+                                    pixels );
+}
+
 NATRON_NAMESPACE_EXIT;
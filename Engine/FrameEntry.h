@@ -77,6 +77,30 @@ public:
 
     void copy(const FrameEntry& other);
 
+    /**
+     * @brief Returns true if data() holds a tile encoded with ViewerTileCodec rather than raw RGBA pixels.
+     * pixelAt() and copy() may not be used on such entries.
+     **/
+    bool isCompressed() const
+    {
+        return _params->isCompressed();
+    }
+
+    /**
+     * @brief The size in bytes of the raw RGBA pixels of the tile held by this entry
+     **/
+    std::size_t getUncompressedSizeInBytes() const;
+
+    /**
+     * @brief Encodes the raw RGBA tile pixels (getUncompressedSizeInBytes() bytes) into the storage of this compressed entry.
+     * Returns false if the tile could not be encoded (see ViewerTileCodec::encode): the entry must then not be used.
+     **/
+    bool compressPixels(const U8* pixels);
+
+    /**
+     * @brief Decodes the storage of this compressed entry into pixels, which must hold getUncompressedSizeInBytes() bytes.
+     **/
+    bool uncompressPixels(U8* pixels) const;
 
     ImagePtr getInternalImage() const
     {
@@ -27,6 +27,8 @@
 
 #include "Global/Macros.h"
 
+#include <cassert>
+
 #if !defined(Q_MOC_RUN) && !defined(SBK_RUN)
 #include <boost/shared_ptr.hpp>
 #include <boost/weak_ptr.hpp>
@@ -61,15 +63,18 @@ public:
     FrameParams(const RectI & rod,
                 int bitDepth,
                 const RectI& bounds,
-                const ImagePtr& originalImage)
+                const ImagePtr& originalImage,
+                int compressionRatio = 1)
         : NonKeyParams()
         , _image(originalImage)
         , _rod(rod)
     {
         CacheEntryStorageInfo& info = getStorageInfo();
 
+        assert(compressionRatio == 1 || compressionRatio == 2 || compressionRatio == 4);
         info.mode = eStorageModeDisk;
-        info.numComponents = 4; // always RGBA
+        // always RGBA: a compressed tile (see ViewerTileCodec) takes 1/compressionRatio of the raw storage
+        info.numComponents = 4 / compressionRatio;
         info.dataTypeSize = getSizeOfForBitDepth( (ImageBitDepthEnum)bitDepth );
         info.bounds = bounds;
         info.textureTarget = GL_TEXTURE_2D;
@@ -93,6 +98,14 @@ public:
         return !(*this == other);
     }
 
+    /**
+     * @brief Returns true if the entry holds a tile encoded with ViewerTileCodec rather than raw RGBA pixels
+     **/
+    bool isCompressed() const
+    {
+        return getStorageInfo().numComponents < 4;
+    }
+
     ImagePtr getInternalImage() const
     {
         return _image.lock();
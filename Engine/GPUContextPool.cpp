@@ -24,10 +24,13 @@
 
 #include "GPUContextPool.h"
 
+#include <algorithm> // std::max
 #include <set>
+#include <map>
 #include <stdexcept>
 
 #include <QMutex>
+#include <QThread>
 #include <QWaitCondition>
 
 #include "Engine/AppManager.h"
@@ -51,7 +54,14 @@ struct GPUContextPoolPrivate
     OSGLContextWPtr glShareContext;
 
 
-    std::set<OSGLContextPtr> cpuGLContextPool;
+    // Each OSMesa context mapped against the number of renders currently attached to it
+    typedef std::map<OSGLContextPtr, int> CPUGLContextPool;
+    CPUGLContextPool cpuGLContextPool;
+
+    // The OSMesa context preferably given to renders launched from a thread. Keeping the same context
+    // for a thread keeps the EffectOpenGLContextData (shaders, FBOs...) of the effects it renders warm.
+    typedef std::map<QThread*, OSGLContextPtr> CPUGLContextThreadMap;
+    CPUGLContextThreadMap cpuGLContextPerThread;
     OSGLContextWPtr lastUsedCPUGLContext;
     OSGLContextWPtr cpuGLShareContext;
 
@@ -61,12 +71,80 @@ struct GPUContextPoolPrivate
         , lastUsedGLContext()
         , glShareContext()
         , cpuGLContextPool()
+        , cpuGLContextPerThread()
         , lastUsedCPUGLContext()
         , cpuGLShareContext()
     {
     }
+
+    /**
+     * @brief Returns the maximum number of OSMesa contexts, which follows the number of render threads in the Settings.
+     **/
+    static int getMaxCPUGLContexts(const SettingsPtr& settings);
+
+    /**
+     * @brief Removes contexts in excess that are not attached to any render, e.g: after the number of threads was lowered
+     **/
+    void trimCPUGLContextPool(int maxContexts);
+
+    /**
+     * @brief Returns the context with the least renders attached to it
+     **/
+    CPUGLContextPool::iterator findLeastUsedCPUGLContext();
 };
 
+int
+GPUContextPoolPrivate::getMaxCPUGLContexts(const SettingsPtr& settings)
+{
+    // For CPU Contexts, use the threads count, we are not limited by the graphic card
+    int nThreads = settings ? settings->getNumberOfThreads() : 0;
+
+    if (nThreads == -1) {
+        return 1;
+    } else if (nThreads == 0) {
+        return std::max(appPTR->getHardwareIdealThreadCount(), 1);
+    }
+
+    return nThreads;
+}
+
+void
+GPUContextPoolPrivate::trimCPUGLContextPool(int maxContexts)
+{
+    // Called with contextPoolMutex locked
+    CPUGLContextPool::iterator it = cpuGLContextPool.begin();
+
+    while ( (int)cpuGLContextPool.size() > maxContexts && it != cpuGLContextPool.end() ) {
+        if (it->second > 0) {
+            ++it;
+            continue;
+        }
+        for (CPUGLContextThreadMap::iterator it2 = cpuGLContextPerThread.begin(); it2 != cpuGLContextPerThread.end();) {
+            if (it2->second == it->first) {
+                cpuGLContextPerThread.erase(it2++);
+            } else {
+                ++it2;
+            }
+        }
+        cpuGLContextPool.erase(it++);
+    }
+}
+
+GPUContextPoolPrivate::CPUGLContextPool::iterator
+GPUContextPoolPrivate::findLeastUsedCPUGLContext()
+{
+    // Called with contextPoolMutex locked
+    CPUGLContextPool::iterator ret = cpuGLContextPool.begin();
+
+    for (CPUGLContextPool::iterator it = cpuGLContextPool.begin(); it != cpuGLContextPool.end(); ++it) {
+        if (it->second < ret->second) {
+            ret = it;
+        }
+    }
+
+    return ret;
+}
+
 GPUContextPool::GPUContextPool()
     : _imp( new GPUContextPoolPrivate() )
 {
@@ -82,6 +160,8 @@ GPUContextPool::clear()
     QMutexLocker k(&_imp->contextPoolMutex);
 
     _imp->glContextPool.clear();
+    _imp->cpuGLContextPool.clear();
+    _imp->cpuGLContextPerThread.clear();
 }
 
 OSGLContextPtr
@@ -166,16 +246,21 @@ GPUContextPool::releaseGLContextFromRender(const OSGLContextPtr& context)
 OSGLContextPtr
 GPUContextPool::attachCPUGLContextToRender(bool retrieveLastContext)
 {
-
 #ifndef HAVE_OSMESA
+    Q_UNUSED(retrieveLastContext);
+
     return OSGLContextPtr();
-#endif
-    
+#else
     QMutexLocker k(&_imp->contextPoolMutex);
 
     if (retrieveLastContext) {
         OSGLContextPtr lastCtx = _imp->lastUsedCPUGLContext.lock();
         if (lastCtx) {
+            GPUContextPoolPrivate::CPUGLContextPool::iterator found = _imp->cpuGLContextPool.find(lastCtx);
+            if ( found != _imp->cpuGLContextPool.end() ) {
+                ++found->second;
+            }
+
             return lastCtx;
         }
     }
@@ -190,37 +275,48 @@ GPUContextPool::attachCPUGLContextToRender(bool retrieveLastContext)
         rendererID = settings->getOpenGLCPUDriver();
     }
 
-    // For CPU Contexts, use the threads count, we are not limited by the graphic card
-    const int maxContexts = appPTR->getHardwareIdealThreadCount();
+    const int maxContexts = GPUContextPoolPrivate::getMaxCPUGLContexts(settings);
+    _imp->trimCPUGLContextPool(maxContexts);
 
-    if ( (int)_imp->cpuGLContextPool.size() < maxContexts ) {
-        //  Create a new one
-        newContext.reset( new OSGLContext( FramebufferConfig(), shareContext.get(), false /*useGPU*/, -1, -1, rendererID ) );
-        _imp->cpuGLContextPool.insert(newContext);
-    } else {
-        while ((int)_imp->cpuGLContextPool.size() > maxContexts) {
-            _imp->cpuGLContextPool.erase(_imp->cpuGLContextPool.begin());
+    // Contexts are handed out per render thread rather than cycled through, so that concurrent renders
+    // do not wait on each other in OSGLContext::setContextCurrent_CPU() as long as there are enough contexts.
+    QThread* curThread = QThread::currentThread();
+    GPUContextPoolPrivate::CPUGLContextPool::iterator foundContext = _imp->cpuGLContextPool.end();
+    {
+        // First, the context of this thread if no other render is using it
+        GPUContextPoolPrivate::CPUGLContextThreadMap::iterator foundThread = _imp->cpuGLContextPerThread.find(curThread);
+        if ( foundThread != _imp->cpuGLContextPerThread.end() ) {
+            GPUContextPoolPrivate::CPUGLContextPool::iterator it = _imp->cpuGLContextPool.find(foundThread->second);
+            if ( ( it != _imp->cpuGLContextPool.end() ) && (it->second == 0) ) {
+                foundContext = it;
+            }
         }
+    }
+    if ( foundContext == _imp->cpuGLContextPool.end() ) {
+        if ( (int)_imp->cpuGLContextPool.size() < maxContexts ) {
+            //  Create a new one, lazily: a thread that never renders with OSMesa never gets a context
+            newContext.reset( new OSGLContext( FramebufferConfig(), shareContext.get(), false /*useGPU*/, -1, -1, rendererID ) );
+            foundContext = _imp->cpuGLContextPool.insert( std::make_pair(newContext, 0) ).first;
+        } else if ( !_imp->cpuGLContextPool.empty() ) {
+            // Take over an idle context, or share the least used one if all threads are busy
+            foundContext = _imp->findLeastUsedCPUGLContext();
+        } else {
+            throw std::logic_error("No context to attach");
+        }
+    }
 
-        // Cycle through all contexts for all renders
-        OSGLContextPtr lastContext = _imp->lastUsedCPUGLContext.lock();
-        if (!lastContext) {
-            newContext = *_imp->cpuGLContextPool.begin();
+    newContext = foundContext->first;
+    ++foundContext->second;
+
+    // A context belongs to a single thread at a time: this also bounds the map when render threads come and go
+    for (GPUContextPoolPrivate::CPUGLContextThreadMap::iterator it = _imp->cpuGLContextPerThread.begin(); it != _imp->cpuGLContextPerThread.end();) {
+        if ( (it->second == newContext) && (it->first != curThread) ) {
+            _imp->cpuGLContextPerThread.erase(it++);
         } else {
-            std::set<OSGLContextPtr>::iterator foundLast = _imp->cpuGLContextPool.find(lastContext);
-            assert( foundLast != _imp->cpuGLContextPool.end() );
-            if ( foundLast == _imp->cpuGLContextPool.end() ) {
-                throw std::logic_error("No context to attach");
-            } else {
-                std::set<OSGLContextPtr>::iterator next = foundLast;
-                ++next;
-                if ( next == _imp->cpuGLContextPool.end() ) {
-                    next = _imp->cpuGLContextPool.begin();
-                }
-                newContext = *next;
-            }
+            ++it;
         }
     }
+    _imp->cpuGLContextPerThread[curThread] = newContext;
 
     assert(newContext);
 
@@ -236,15 +332,20 @@ GPUContextPool::attachCPUGLContextToRender(bool retrieveLastContext)
     }
 
     _imp->lastUsedCPUGLContext = newContext;
-    
-    return newContext;
 
-}
+    return newContext;
+#endif // HAVE_OSMESA
+} // GPUContextPool::attachCPUGLContextToRender
 
 void
 GPUContextPool::releaseCPUGLContextFromRender(const OSGLContextPtr& context)
 {
-    Q_UNUSED(context);
+    QMutexLocker k(&_imp->contextPoolMutex);
+    GPUContextPoolPrivate::CPUGLContextPool::iterator found = _imp->cpuGLContextPool.find(context);
+
+    if ( ( found != _imp->cpuGLContextPool.end() ) && (found->second > 0) ) {
+        --found->second;
+    }
 }
 
 NATRON_NAMESPACE_EXIT;
@@ -70,18 +70,20 @@ public:
     ////////////////////////////// OpenGL CPU related (OSMesa) //////////////////////
 
     /**
-     * @brief Attaches one of the OpenGL context in the pool to a specific frame render.
-     * Multiple frame renders may share the same context, but when they lock it with the
-     * setContextCurrent() function, they own the context and lock out all other renders trying to use it.
+     * @brief Attaches one of the OSMesa contexts in the pool to a specific frame render.
+     * Contexts are created lazily, up to the number of render threads in the Settings, and each
+     * render thread is preferably given the same context, as long as no other render is attached to it.
+     * Frame renders only share a context (and wait on each other in setContextCurrent())
+     * when there are more concurrent renders than contexts.
      * After returning this function, the context must be made current before
      * OpenGL calls can be made.
      *
-     * @param checkIfGLLoaded If true, this function will check if OpenGL was loaded before attempting to create a context
+     * @param retrieveLastContext If true, the last context returned by this function is returned again
      **/
     OSGLContextPtr attachCPUGLContextToRender(bool retrieveLastContext = false);
 
     /**
-     * @brief Releases the given OpenGL context from a render which was previously retrieved from attachGLContextToRender()
+     * @brief Releases the given OpenGL context from a render which was previously retrieved from attachCPUGLContextToRender()
      **/
     void releaseCPUGLContextFromRender(const OSGLContextPtr& context);
 
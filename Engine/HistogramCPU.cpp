@@ -31,7 +31,9 @@
 #include <QtCore/QMutex>
 #include <QtCore/QWaitCondition>
 
+#include "Engine/AppManager.h"
 #include "Engine/Image.h"
+#include "Engine/TaskExecutor.h"
 
 NATRON_NAMESPACE_ENTER;
 
@@ -101,30 +103,57 @@ struct FinishedHistogram
 
 struct HistogramCPUPrivate
 {
-    QWaitCondition requestCond;
+    // Protects requests, taskScheduled and mustQuit
     QMutex requestMutex;
+
+    // Woken up when the task is done
+    QWaitCondition taskDoneCond;
     std::list<HistogramRequest> requests;
+
+    // True while a HistogramTask is queued or running
+    bool taskScheduled;
+    bool mustQuit;
     QMutex producedMutex;
     std::list<boost::shared_ptr<FinishedHistogram> > produced;
-    QWaitCondition mustQuitCond;
-    QMutex mustQuitMutex;
-    bool mustQuit;
 
     HistogramCPUPrivate()
-        : requestCond()
-        , requestMutex()
+        : requestMutex()
+        , taskDoneCond()
         , requests()
+        , taskScheduled(false)
+        , mustQuit(false)
         , producedMutex()
         , produced()
-        , mustQuitCond()
-        , mustQuitMutex()
-        , mustQuit(false)
     {
     }
 };
 
+class HistogramTask
+    : public ExecutorTask
+{
+    HistogramCPU* _histogram;
+
+public:
+
+    HistogramTask(HistogramCPU* histogram)
+        : ExecutorTask()
+        , _histogram(histogram)
+    {
+    }
+
+    virtual void run() OVERRIDE FINAL
+    {
+        _histogram->processRequests();
+    }
+
+    virtual void onDropped() OVERRIDE FINAL
+    {
+        _histogram->processRequests();
+    }
+};
+
 HistogramCPU::HistogramCPU()
-    : QThread()
+    : QObject()
     , _imp( new HistogramCPUPrivate() )
 {
 }
@@ -143,36 +172,35 @@ HistogramCPU::computeHistogram(int mode,      //< corresponds to the enum Histog
                                double vmax,
                                int smoothingKernelSize)
 {
-    /*Starting or waking-up the thread*/
-    QMutexLocker quitLocker(&_imp->mustQuitMutex);
-    QMutexLocker locker(&_imp->requestMutex);
-
-    _imp->requests.push_back( HistogramRequest(binsCount, mode, image, rect, vmin, vmax, smoothingKernelSize) );
-    if (!isRunning() && !_imp->mustQuit) {
-        quitLocker.unlock();
-        start(HighestPriority);
-    } else {
-        quitLocker.unlock();
-        _imp->requestCond.wakeOne();
+    bool mustSchedule;
+    {
+        QMutexLocker locker(&_imp->requestMutex);
+        if (_imp->mustQuit) {
+            return;
+        }
+        _imp->requests.push_back( HistogramRequest(binsCount, mode, image, rect, vmin, vmax, smoothingKernelSize) );
+        mustSchedule = !_imp->taskScheduled;
+        _imp->taskScheduled = true;
+    }
+    if (mustSchedule) {
+        TaskExecutor* executor = appPTR ? appPTR->getTaskExecutor() : 0;
+        if ( !executor || !executor->submit( eTaskPriorityInteractive, ExecutorTaskPtr( new HistogramTask(this) ) ) ) {
+            processRequests();
+        }
     }
 }
 
 void
 HistogramCPU::quitAnyComputation()
 {
-    if ( isRunning() ) {
-        QMutexLocker l(&_imp->mustQuitMutex);
-        assert(!_imp->mustQuit);
-        _imp->mustQuit = true;
-
-        ///post a fake request to wakeup the thread
-        l.unlock();
-        computeHistogram(0, ImagePtr(), RectI(), 0, 0, 0, 0);
-        l.relock();
-        while (_imp->mustQuit) {
-            _imp->mustQuitCond.wait(&_imp->mustQuitMutex);
-        }
+    QMutexLocker l(&_imp->requestMutex);
+
+    _imp->mustQuit = true;
+    _imp->requests.clear();
+    while (_imp->taskScheduled) {
+        _imp->taskDoneCond.wait(&_imp->requestMutex);
     }
+    _imp->mustQuit = false;
 }
 
 bool
@@ -511,33 +539,27 @@ computeHistogramStatic(const HistogramRequest & request,
 } // computeHistogramStatic
 
 void
-HistogramCPU::run()
+HistogramCPU::processRequests()
 {
     for (;; ) {
         HistogramRequest request;
         {
             QMutexLocker l(&_imp->requestMutex);
-            while ( _imp->requests.empty() ) {
-                _imp->requestCond.wait(&_imp->requestMutex);
+            if ( _imp->requests.empty() || _imp->mustQuit ) {
+                _imp->requests.clear();
+                _imp->taskScheduled = false;
+                _imp->taskDoneCond.wakeAll();
+
+                return;
             }
 
             ///get the last request
             request = _imp->requests.back();
-            _imp->requests.pop_back();
 
             ///ignore all other requests pending
             _imp->requests.clear();
         }
 
-        {
-            QMutexLocker l(&_imp->mustQuitMutex);
-            if (_imp->mustQuit) {
-                _imp->mustQuit = false;
-                _imp->mustQuitCond.wakeOne();
-
-                return;
-            }
-        }
         boost::shared_ptr<FinishedHistogram> ret(new FinishedHistogram);
         ret->binsCount = request.binsCount;
         ret->mode = request.mode;
@@ -571,7 +593,7 @@ HistogramCPU::run()
         }
         Q_EMIT histogramProduced();
     }
-} // run
+} // processRequests
 
 NATRON_NAMESPACE_EXIT;
 
@@ -29,7 +29,7 @@
 
 #include <vector>
 
-#include <QtCore/QThread>
+#include <QtCore/QObject>
 
 #if !defined(Q_MOC_RUN) && !defined(SBK_RUN)
 #include <boost/shared_ptr.hpp>
@@ -42,8 +42,12 @@ NATRON_NAMESPACE_ENTER;
 
 struct HistogramCPUPrivate;
 
+/**
+ * @brief Computes the histograms of the viewer images on the TaskExecutor, in the interactive class.
+ * Only the most recent request is computed: older pending ones are dropped.
+ **/
 class HistogramCPU
-    : public QThread
+    : public QObject
 {
 GCC_DIAG_SUGGEST_OVERRIDE_OFF
     Q_OBJECT
@@ -81,6 +85,9 @@ public:
                                           int* mode,
                                           double* vmin, double* vmax, unsigned int* mipMapLevel);
 
+    /**
+     * @brief Drops the pending requests and waits for the histogram being computed, if any.
+     **/
     void quitAnyComputation();
 
 Q_SIGNALS:
@@ -89,7 +96,13 @@ Q_SIGNALS:
 
 private:
 
-    virtual void run() OVERRIDE FINAL;
+    friend class HistogramTask;
+
+    /**
+     * @brief Computes the most recent request until there is none left, in a worker of the TaskExecutor
+     **/
+    void processRequests();
+
     boost::scoped_ptr<HistogramCPUPrivate> _imp;
 };
 
@@ -29,6 +29,10 @@
 #include <cstring> // for std::memcpy, std::memset
 #include <stdexcept>
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
 #include <QtCore/QDebug>
 
 #include "Engine/AppManager.h"
@@ -2350,6 +2354,53 @@ Bitmap::copyBitmapPortion(const RectI& roi,
     }
 }
 
+template <bool doPremult, typename PIX>
+static void
+premultRow(PIX* dstPix,
+           int nPixels)
+{
+    for (int x = 0; x < nPixels; ++x, dstPix += 4) {
+        for (int c = 0; c < 3; ++c) {
+            if (doPremult) {
+                dstPix[c] = PIX(float(dstPix[c]) * dstPix[3]);
+            } else {
+                if (dstPix[3] != 0) {
+                    dstPix[c] = PIX( dstPix[c] / float(dstPix[3]) );
+                }
+            }
+        }
+    }
+}
+
+#ifdef __SSE2__
+/*
+ * RGBA float rows are processed one pixel per register, with the same operations as the scalar code above,
+ * so that the results are bit-exact: alpha is kept, and unpremultiplying skips the pixels where alpha is 0.
+ */
+template <bool doPremult>
+static void
+premultRow(float* dstPix,
+           int nPixels)
+{
+    const __m128 rgbMask = _mm_castsi128_ps( _mm_set_epi32(0, -1, -1, -1) );
+
+    for (int x = 0; x < nPixels; ++x, dstPix += 4) {
+        __m128 v = _mm_loadu_ps(dstPix);
+        __m128 alpha = _mm_shuffle_ps( v, v, _MM_SHUFFLE(3, 3, 3, 3) );
+        __m128 result, mask;
+        if (doPremult) {
+            result = _mm_mul_ps(v, alpha);
+            mask = rgbMask;
+        } else {
+            result = _mm_div_ps(v, alpha);
+            mask = _mm_and_ps( rgbMask, _mm_cmpneq_ps( alpha, _mm_setzero_ps() ) );
+        }
+        _mm_storeu_ps( dstPix, _mm_or_ps( _mm_and_ps(mask, result), _mm_andnot_ps(mask, v) ) );
+    }
+}
+
+#endif
+
 template <typename PIX, bool doPremult>
 void
 Image::premultInternal(const RectI& roi)
@@ -2363,18 +2414,8 @@ Image::premultInternal(const RectI& roi)
 
     int srcRowElements = 4 * _bounds.width();
     PIX* dstPix = (PIX*)acc.pixelAt(renderWindow.x1, renderWindow.y1);
-    for ( int y = renderWindow.y1; y < renderWindow.y2; ++y, dstPix += (srcRowElements - (renderWindow.x2 - renderWindow.x1) * 4) ) {
-        for (int x = renderWindow.x1; x < renderWindow.x2; ++x, dstPix += 4) {
-            for (int c = 0; c < 3; ++c) {
-                if (doPremult) {
-                    dstPix[c] = PIX(float(dstPix[c]) * dstPix[3]);
-                } else {
-                    if (dstPix[3] != 0) {
-                        dstPix[c] = PIX( dstPix[c] / float(dstPix[3]) );
-                    }
-                }
-            }
-        }
+    for (int y = renderWindow.y1; y < renderWindow.y2; ++y, dstPix += srcRowElements) {
+        premultRow<doPremult>(dstPix, renderWindow.x2 - renderWindow.x1);
     }
 }
 
@@ -125,9 +125,6 @@ lutFromColorspace(ViewerColorSpaceEnum cs)
         lut = 0;
         break;
     }
-    if (lut) {
-        lut->validate();
-    }
 
     return lut;
 }
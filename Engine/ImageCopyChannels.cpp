@@ -24,9 +24,15 @@
 
 #include "Image.h"
 
+#include <algorithm> // min, max
 #include <cassert>
+#include <cstddef>
 #include <stdexcept>
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
 #include <QtCore/QDebug>
 
 #include "Engine/OSGLContext.h"
@@ -46,6 +52,106 @@ GCC_DIAG_OFF(unused-but-set-variable) // only on gcc >= 4.6
 
 NATRON_NAMESPACE_ENTER;
 
+/*
+ * Copy the bytes of src selected by pattern to dst. The pattern repeats every patternBytes bytes,
+ * which is a multiple of both the pixel size and the SSE2 register size.
+ */
+static void
+copySelectedBytes(unsigned char* dst,
+                  const unsigned char* src,
+                  std::size_t nBytes,
+                  const unsigned char* pattern,
+                  std::size_t patternBytes)
+{
+    std::size_t i = 0;
+
+#ifdef __SSE2__
+    for (; i + patternBytes <= nBytes; i += patternBytes) {
+        for (std::size_t k = 0; k < patternBytes; k += 16) {
+            __m128i mask = _mm_loadu_si128( (const __m128i*)(pattern + k) );
+            __m128i s = _mm_loadu_si128( (const __m128i*)(src + i + k) );
+            __m128i d = _mm_loadu_si128( (const __m128i*)(dst + i + k) );
+            _mm_storeu_si128( (__m128i*)(dst + i + k), _mm_or_si128( _mm_and_si128(mask, s), _mm_andnot_si128(mask, d) ) );
+        }
+    }
+#endif
+    for (; i < nBytes; ++i) {
+        if (pattern[i % patternBytes]) {
+            dst[i] = src[i];
+        }
+    }
+}
+
+// The pixels where the original image is not defined get 0 in the copied channels
+template <typename PIX, int nComps>
+static void
+clearChannels(PIX* dst,
+              const bool* doChannel,
+              int nPixels)
+{
+    for (int x = 0; x < nPixels; ++x, dst += nComps) {
+        for (int c = 0; c < nComps; ++c) {
+            if (doChannel[c]) {
+                dst[c] = 0;
+            }
+        }
+    }
+}
+
+/*
+ * Copy the unprocessed channels when the original image has the same components as the output:
+ * each unprocessed channel of a pixel is then the same channel of the original pixel (or 0 where the original
+ * image is not defined), so the channels are resolved once into a byte mask and whole rows are blended with it.
+ */
+template <typename PIX, int nComps>
+static void
+copyChannelsFromSameComponents(bool doR,
+                               bool doG,
+                               bool doB,
+                               bool doA,
+                               const RectI& roi,
+                               PIX* dst_pixels,
+                               int dstRowElements,
+                               const Image::ReadAccess& acc,
+                               const RectI& srcBounds)
+{
+    bool doChannel[nComps];
+    bool anyChannel = false;
+
+    for (int c = 0; c < nComps; ++c) {
+        doChannel[c] = ( (c == 0) && doR ) || ( (c == 1) && doG ) || ( (c == 2) && doB ) ||
+                       ( doA && ( (nComps == 1) || (nComps == 4) ) && (c == nComps - 1) );
+        anyChannel |= doChannel[c];
+    }
+    if (!anyChannel) {
+        return;
+    }
+    const std::size_t pixelBytes = nComps * sizeof(PIX);
+    const std::size_t patternBytes = (16 % pixelBytes == 0) ? 16 : 48;
+    unsigned char pattern[48];
+    for (std::size_t i = 0; i < patternBytes; ++i) {
+        pattern[i] = doChannel[(i / sizeof(PIX)) % nComps] ? 0xFF : 0;
+    }
+
+    for (int y = roi.y1; y < roi.y2; ++y, dst_pixels += dstRowElements) {
+        // The part of the row where the original image is defined
+        int sx1 = roi.x2, sx2 = roi.x2;
+        const PIX* src_pixels = 0;
+        if ( (y >= srcBounds.y1) && (y < srcBounds.y2) ) {
+            sx1 = std::max(roi.x1, srcBounds.x1);
+            sx2 = std::max( sx1, std::min(roi.x2, srcBounds.x2) );
+            src_pixels = (sx1 < sx2) ? (const PIX*)acc.pixelAt(sx1, y) : 0;
+        }
+        if (!src_pixels) {
+            sx1 = sx2 = roi.x2;
+        }
+        clearChannels<PIX, nComps>(dst_pixels, doChannel, sx1 - roi.x1);
+        copySelectedBytes( (unsigned char*)( dst_pixels + (sx1 - roi.x1) * nComps ), (const unsigned char*)src_pixels,
+                           (sx2 - sx1) * pixelBytes, pattern, patternBytes );
+        clearChannels<PIX, nComps>(dst_pixels + (sx2 - roi.x1) * nComps, doChannel, roi.x2 - sx2);
+    }
+} // copyChannelsFromSameComponents
+
 template <typename PIX, int maxValue, int srcNComps, int dstNComps, bool doR, bool doG, bool doB, bool doA, bool premult, bool originalPremult, bool ignorePremult>
 void
 Image::copyUnProcessedChannelsForPremult(const std::bitset<4> processChannels,
@@ -64,6 +170,14 @@ Image::copyUnProcessedChannelsForPremult(const std::bitset<4> processChannels,
     assert(srcNComps == 1 || srcNComps == 4 || !originalPremult); // only A or RGBA can be premult
     assert(dstNComps == 1 || dstNComps == 4 || !premult); // only A or RGBA can be premult
 
+#ifndef NATRON_COPY_CHANNELS_UNPREMULT
+    if ( (srcNComps == dstNComps) && originalImage ) {
+        copyChannelsFromSameComponents<PIX, dstNComps>(doR, doG, doB, doA, roi, dst_pixels, dstRowElements, acc, originalImage->getBounds());
+
+        return;
+    }
+#endif
+
     for ( int y = roi.y1; y < roi.y2; ++y, dst_pixels += (dstRowElements - (roi.x2 - roi.x1) * dstNComps) ) {
         for (int x = roi.x1; x < roi.x2; ++x, dst_pixels += dstNComps) {
             const PIX* src_pixels = originalImage ? (const PIX*)acc.pixelAt(x, y) : 0;
@@ -218,6 +332,14 @@ Image::copyUnProcessedChannelsForPremult(const bool premult,
     Q_UNUSED(premult);
     Q_UNUSED(originalPremult);
 
+#ifndef NATRON_COPY_CHANNELS_UNPREMULT
+    if ( (srcNComps == dstNComps) && originalImage ) {
+        copyChannelsFromSameComponents<PIX, dstNComps>(doR, doG, doB, doA, roi, dst_pixels, dstRowElements, acc, originalImage->getBounds());
+
+        return;
+    }
+#endif
+
     for ( int y = roi.y1; y < roi.y2; ++y, dst_pixels += (dstRowElements - (roi.x2 - roi.x1) * dstNComps) ) {
         for (int x = roi.x1; x < roi.x2; ++x, dst_pixels += dstNComps) {
             const PIX* src_pixels = originalImage ? (const PIX*)acc.pixelAt(x, y) : 0;
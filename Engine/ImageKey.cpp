@@ -41,6 +41,7 @@ ImageKey::ImageKey()
     , _draftMode(false)
     , _frameVaryingOrAnimated(false)
     , _fullScaleWithDownscaleInputs(false)
+    , _conversionHash(0)
 {
 }
 
@@ -61,6 +62,7 @@ ImageKey::ImageKey(const CacheEntryHolder* holder,
     , _draftMode(draftMode)
     , _frameVaryingOrAnimated(frameVaryingOrAnimated)
     , _fullScaleWithDownscaleInputs(fullScaleWithDownscaleInputs)
+    , _conversionHash(0)
 {
 }
 
@@ -75,6 +77,9 @@ ImageKey::fillHash(Hash64* hash) const
     hash->append(_pixelAspect);
     hash->append(_draftMode);
     hash->append(_fullScaleWithDownscaleInputs);
+    if (_conversionHash) {
+        hash->append(_conversionHash);
+    }
 }
 
 bool
@@ -86,13 +91,15 @@ ImageKey::operator==(const ImageKey & other) const
                _view == other._view &&
                _pixelAspect == other._pixelAspect &&
                _draftMode == other._draftMode &&
-               _fullScaleWithDownscaleInputs == other._fullScaleWithDownscaleInputs;
+               _fullScaleWithDownscaleInputs == other._fullScaleWithDownscaleInputs &&
+               _conversionHash == other._conversionHash;
     } else {
         return _nodeHashKey == other._nodeHashKey &&
                _view == other._view &&
                _pixelAspect == other._pixelAspect &&
                _draftMode == other._draftMode &&
-               _fullScaleWithDownscaleInputs == other._fullScaleWithDownscaleInputs;
+               _fullScaleWithDownscaleInputs == other._fullScaleWithDownscaleInputs &&
+               _conversionHash == other._conversionHash;
     }
 }
 
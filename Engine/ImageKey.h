@@ -49,6 +49,11 @@ public:
     //hence it is probably not very high quality, even though the mipmap level is 0
     bool _fullScaleWithDownscaleInputs;
 
+    //When non zero, the image is a copy of the image of the node identified by the other members of the key,
+    //converted to another format. This is the hash of the conversion parameters.
+    //This is only used for images in RAM, hence it is not serialized.
+    U64 _conversionHash;
+
     ImageKey();
 
     ImageKey(const CacheEntryHolder* holder,
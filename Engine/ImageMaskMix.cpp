@@ -24,12 +24,181 @@
 
 #include "Image.h"
 
+#include <algorithm> // min, max
 #include <cassert>
+#include <cstring> // for std::memcpy
 #include <stdexcept>
+#include <vector>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
 #include "Engine/OSGLContext.h"
 
 NATRON_NAMESPACE_ENTER;
 
+/*
+ * Returns in [x1,x2) the part of the row y of roi which is covered by bounds (empty if y is outside of bounds).
+ */
+static void
+intersectRow(const RectI& roi,
+             int y,
+             const RectI& bounds,
+             int* x1,
+             int* x2)
+{
+    if ( (y < bounds.y1) || (y >= bounds.y2) ) {
+        *x1 = *x2 = roi.x1;
+    } else {
+        *x1 = std::max(roi.x1, bounds.x1);
+        *x2 = std::max( *x1, std::min(roi.x2, bounds.x2) );
+    }
+}
+
+#ifdef __SSE2__
+/*
+ * Load 4 consecutive elements as floats and store them back.
+ * The integer stores clamp then truncate, which gives exactly the same values as Image::clampIfInt().
+ */
+static inline __m128
+loadFloat4(const float* p)
+{
+    return _mm_loadu_ps(p);
+}
+
+static inline __m128
+loadFloat4(const unsigned short* p)
+{
+    __m128i v = _mm_loadl_epi64( (const __m128i*)p );
+
+    return _mm_cvtepi32_ps( _mm_unpacklo_epi16( v, _mm_setzero_si128() ) );
+}
+
+static inline __m128
+loadFloat4(const unsigned char* p)
+{
+    int i;
+
+    std::memcpy(&i, p, sizeof(int));
+    __m128i v = _mm_unpacklo_epi8( _mm_cvtsi32_si128(i), _mm_setzero_si128() );
+
+    return _mm_cvtepi32_ps( _mm_unpacklo_epi16( v, _mm_setzero_si128() ) );
+}
+
+static inline void
+storeFloat4(float* p,
+            __m128 v)
+{
+    _mm_storeu_ps(p, v);
+}
+
+static inline void
+storeFloat4(unsigned short* p,
+            __m128 v)
+{
+    // _mm_max_ps returns its second operand for NaN, as std::max(0, NaN) does
+    __m128i i = _mm_cvttps_epi32( _mm_min_ps( _mm_max_ps( v, _mm_setzero_ps() ), _mm_set1_ps(65535.f) ) );
+
+    // SSE2 has no unsigned 32 to 16 bits pack: shift into the signed range and back
+    i = _mm_packs_epi32( _mm_sub_epi32( i, _mm_set1_epi32(32768) ), _mm_setzero_si128() );
+    _mm_storel_epi64( (__m128i*)p, _mm_xor_si128( i, _mm_set1_epi16( (short)0x8000 ) ) );
+}
+
+static inline void
+storeFloat4(unsigned char* p,
+            __m128 v)
+{
+    __m128i i = _mm_cvttps_epi32( _mm_min_ps( _mm_max_ps( v, _mm_setzero_ps() ), _mm_set1_ps(255.f) ) );
+
+    i = _mm_packs_epi32(i, i);
+    i = _mm_packus_epi16(i, i);
+    int r = _mm_cvtsi128_si32(i);
+    std::memcpy(p, &r, sizeof(int));
+}
+
+// The same operations in the same order as the scalar code, so that the results are bit-exact
+static inline __m128
+mixFloat4(__m128 dst,
+          __m128 src,
+          __m128 alpha)
+{
+    return _mm_add_ps( _mm_mul_ps(dst, alpha), _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(1.f), alpha), src) );
+}
+
+#endif // __SSE2__
+
+/*
+ * Mix a row of nPixels pixels of dst with the same row of src, both having nComps components.
+ * If masked, alphas holds the mix factor of each pixel, otherwise mix is used for the whole row.
+ */
+template <typename PIX, int nComps, bool masked>
+static void
+mixRow(PIX* dst,
+       const PIX* src,
+       const float* alphas,
+       float mix,
+       int nPixels)
+{
+    int x = 0;
+
+    if (!masked) {
+        // The mix factor does not depend on the pixel: process the row as a flat array of elements
+        const int nElements = nPixels * nComps;
+        int i = 0;
+#ifdef __SSE2__
+        const __m128 alpha = _mm_set1_ps(mix);
+        for (; i + 4 <= nElements; i += 4) {
+            storeFloat4( dst + i, mixFloat4( loadFloat4(dst + i), loadFloat4(src + i), alpha ) );
+        }
+#endif
+        for (; i < nElements; ++i) {
+            float v = float(dst[i]) * mix + (1.f - mix) * float(src[i]);
+            dst[i] = Image::clampIfInt<PIX>(v);
+        }
+
+        return;
+    }
+
+#ifdef __SSE2__
+    if (nComps == 4) {
+        for (; x < nPixels; ++x) {
+            storeFloat4( dst + x * 4, mixFloat4( loadFloat4(dst + x * 4), loadFloat4(src + x * 4), _mm_set1_ps(alphas[x]) ) );
+        }
+    } else if (nComps == 1) {
+        for (; x + 4 <= nPixels; x += 4) {
+            storeFloat4( dst + x, mixFloat4( loadFloat4(dst + x), loadFloat4(src + x), _mm_loadu_ps(alphas + x) ) );
+        }
+    }
+#endif
+    for (; x < nPixels; ++x) {
+        float alpha = alphas[x];
+        for (int c = 0; c < nComps; ++c) {
+            float v = float(dst[x * nComps + c]) * alpha + (1.f - alpha) * float(src[x * nComps + c]);
+            dst[x * nComps + c] = Image::clampIfInt<PIX>(v);
+        }
+    }
+} // mixRow
+
+/*
+ * The pixels of dst where the original image is not defined are mixed with black.
+ */
+template <typename PIX, int nComps, bool masked>
+static void
+fadeRow(PIX* dst,
+        const float* alphas,
+        float mix,
+        int nPixels)
+{
+    for (int x = 0; x < nPixels; ++x, dst += nComps) {
+        float alpha = masked ? alphas[x] : mix;
+        for (int c = 0; c < nComps; ++c) {
+            float v = float(dst[c]) * alpha;
+            dst[c] = Image::clampIfInt<PIX>(v);
+        }
+    }
+}
+
 template<int srcNComps, int dstNComps, typename PIX, int maxValue, bool masked, bool maskInvert>
 void
 Image::applyMaskMixForMaskInvert(const RectI& roi,
@@ -39,32 +208,20 @@ Image::applyMaskMixForMaskInvert(const RectI& roi,
 {
     PIX* dst_pixels = (PIX*)pixelAt(roi.x1, roi.y1);
     unsigned int dstRowElements = _bounds.width() * getComponentsCount();
-
-    for ( int y = roi.y1; y < roi.y2; ++y,
-          dst_pixels += (dstRowElements - (roi.x2 - roi.x1) * dstNComps) ) { // 1 row stride minus what was done at previous iteration
-        for (int x = roi.x1; x < roi.x2; ++x,
-             dst_pixels += dstNComps) {
-            const PIX* src_pixels = originalImg ? (const PIX*)originalImg->pixelAt(x, y) : 0;
-            float maskScale = 1.f;
-            if (!masked) {
-                // just mix
-                float alpha = mix;
-                if (src_pixels) {
-                    for (int c = 0; c < dstNComps; ++c) {
-                        if (c < srcNComps) {
-                            float v = float(dst_pixels[c]) * alpha + (1.f - alpha) * float(src_pixels[c]);
-                            dst_pixels[c] = clampIfInt<PIX>(v);
-                        }
-                    }
-                } else {
-                    for (int c = 0; c < dstNComps; ++c) {
-                        float v = float(dst_pixels[c]) * alpha;
-                        dst_pixels[c] = clampIfInt<PIX>(v);
-                    }
-                }
-            } else {
-                const PIX* maskPixels = maskImg ? (const PIX*)maskImg->pixelAt(x, y) : 0;
-                // figure the scale factor from that pixel
+    const int width = roi.x2 - roi.x1;
+    const int maskNComps = maskImg ? (int)maskImg->getComponentsCount() : 0;
+    // mix factor of each pixel of the current row, only used if masked
+    std::vector<float> alphas(masked ? width : 0);
+
+    for (int y = roi.y1; y < roi.y2; ++y, dst_pixels += dstRowElements) {
+        if (masked) {
+            // figure the scale factor of each pixel of the row
+            int mx1, mx2;
+            intersectRow(roi, y, maskImg ? maskImg->getBounds() : RectI(), &mx1, &mx2);
+            const PIX* maskRow = (mx1 < mx2) ? (const PIX*)maskImg->pixelAt(mx1, y) : 0;
+            for (int x = roi.x1; x < roi.x2; ++x) {
+                const PIX* maskPixels = ( maskRow && (x >= mx1) && (x < mx2) ) ? maskRow + (x - mx1) * maskNComps : 0;
+                float maskScale;
                 if (maskPixels == 0) {
                     maskScale = maskInvert ? 1.f : 0.f;
                 } else {
@@ -73,22 +230,38 @@ Image::applyMaskMixForMaskInvert(const RectI& roi,
                         maskScale = 1.f - maskScale;
                     }
                 }
-                float alpha = mix * maskScale;
-                if (src_pixels) {
+                alphas[x - roi.x1] = mix * maskScale;
+            }
+        }
+
+        // The part of the row where the original image is defined
+        int sx1, sx2;
+        intersectRow(roi, y, originalImg ? originalImg->getBounds() : RectI(), &sx1, &sx2);
+        const PIX* src_pixels = (sx1 < sx2) ? (const PIX*)originalImg->pixelAt(sx1, y) : 0;
+        if (!src_pixels) {
+            sx1 = sx2 = roi.x2;
+        }
+        const float* rowAlphas = ( masked && !alphas.empty() ) ? &alphas[0] : 0;
+
+        fadeRow<PIX, dstNComps, masked>(dst_pixels, rowAlphas, mix, sx1 - roi.x1);
+        if (sx1 < sx2) {
+            PIX* dstPix = dst_pixels + (sx1 - roi.x1) * dstNComps;
+            const float* spanAlphas = masked ? rowAlphas + (sx1 - roi.x1) : 0;
+            if (srcNComps == dstNComps) {
+                mixRow<PIX, dstNComps, masked>(dstPix, src_pixels, spanAlphas, mix, sx2 - sx1);
+            } else {
+                for (int x = 0; x < sx2 - sx1; ++x, dstPix += dstNComps, src_pixels += srcNComps) {
+                    float alpha = masked ? spanAlphas[x] : mix;
                     for (int c = 0; c < dstNComps; ++c) {
                         if (c < srcNComps) {
-                            float v = float(dst_pixels[c]) * alpha + (1.f - alpha) * float(src_pixels[c]);
-                            dst_pixels[c] = clampIfInt<PIX>(v);
+                            float v = float(dstPix[c]) * alpha + (1.f - alpha) * float(src_pixels[c]);
+                            dstPix[c] = clampIfInt<PIX>(v);
                         }
                     }
-                } else {
-                    for (int c = 0; c < dstNComps; ++c) {
-                        float v = float(dst_pixels[c]) * alpha;
-                        dst_pixels[c] = clampIfInt<PIX>(v);
-                    }
                 }
             }
         }
+        fadeRow<PIX, dstNComps, masked>(dst_pixels + (sx2 - roi.x1) * dstNComps, masked ? rowAlphas + (sx2 - roi.x1) : 0, mix, roi.x2 - sx2);
     }
 } // Image::applyMaskMixForMaskInvert
 
@@ -1240,6 +1240,12 @@ public:
      * @brief Must return true if the other knobs type can convert to this knob's type.
      **/
     virtual bool isTypeCompatible(const KnobIPtr & other) const = 0;
+
+    /**
+     * @brief Fills dimensions with a copy of the value and animation curve of each dimension, so that render
+     * threads can read them without taking the locks of the knob. See KnobsRenderSnapshot.
+     **/
+    virtual void getRenderSnapshot(std::vector<KnobDimensionSnapshot>* dimensions) = 0;
     KnobPagePtr getTopLevelPage();
 };
 
@@ -2000,6 +2006,7 @@ public:
     virtual bool canAnimate() const OVERRIDE;
     virtual bool isTypePOD() const OVERRIDE FINAL WARN_UNUSED_RETURN;
     virtual bool isTypeCompatible(const KnobIPtr & other) const OVERRIDE FINAL WARN_UNUSED_RETURN;
+    virtual void getRenderSnapshot(std::vector<KnobDimensionSnapshot>* dimensions) OVERRIDE FINAL;
 
     ///Cannot be overloaded by KnobHelper as it requires setValueAtTime
     virtual bool onKeyFrameSet(double time, ViewSpec view, int dimension) OVERRIDE FINAL;
@@ -2071,6 +2078,16 @@ private:
 
     T clampToMinMax(const T& value, int dimension) const;
 
+    /**
+     * @brief If the calling thread is rendering the holder of this knob and the dimension was frozen in the
+     * snapshot of the render, sets ret to its value at the given time (or at the current time if useCurrentTime
+     * is true) and returns true. No lock of the knob is taken.
+     **/
+    bool getValueFromRenderSnapshot(bool useCurrentTime, double time, int dimension, bool clamp, T* ret);
+
+    T valueFromRenderSnapshot(const KnobDimensionSnapshot& snapshot, double time, bool clamp) const;
+    void valueToRenderSnapshot(const T& value, int dimension, KnobDimensionSnapshot* snapshot) const;
+
     void signalMinMaxChanged(const T& mini, const T& maxi, int dimension);
     void signalDisplayMinMaxChanged(const T& mini, const T& maxi, int dimension);
 
@@ -2637,6 +2654,15 @@ public:
         return ViewIdx(0);
     }
 
+    /**
+     * @brief Returns the snapshot of the knobs of this holder made for the render being done by the calling
+     * thread, or NULL if the calling thread is not rendering this holder.
+     **/
+    virtual const KnobsRenderSnapshot* getCurrentRenderKnobsSnapshot() const
+    {
+        return 0;
+    }
+
     int getPageIndex(const KnobPagePtr page) const;
 
 
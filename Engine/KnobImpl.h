@@ -56,6 +56,7 @@ GCC_DIAG_ON(unused-parameter)
 #include "Engine/Project.h"
 #include "Engine/EffectInstance.h"
 #include "Engine/KnobTypes.h"
+#include "Engine/KnobsRenderSnapshot.h"
 #include "Engine/ViewIdx.h"
 #include "Engine/EngineFwd.h"
 
@@ -343,6 +344,115 @@ KnobBoolBase::clampToMinMax(const bool& value,
     return value;
 }
 
+template <typename T>
+T
+Knob<T>::valueFromRenderSnapshot(const KnobDimensionSnapshot& snapshot,
+                                 double time,
+                                 bool clamp) const
+{
+    if (snapshot.curve) {
+        //getValueAt already clamps to the range for us
+        return (T)snapshot.curve->getValueAt(time, clamp);
+    }
+
+    return (T)(clamp ? snapshot.clampedValue : snapshot.value);
+}
+
+template <>
+std::string
+KnobStringBase::valueFromRenderSnapshot(const KnobDimensionSnapshot& snapshot,
+                                        double /*time*/,
+                                        bool /*clamp*/) const
+{
+    // animated strings are never frozen
+    assert(!snapshot.curve);
+
+    return snapshot.stringValue;
+}
+
+template <typename T>
+void
+Knob<T>::valueToRenderSnapshot(const T& value,
+                               int dimension,
+                               KnobDimensionSnapshot* snapshot) const
+{
+    snapshot->value = (double)value;
+    snapshot->clampedValue = (double)clampToMinMax(value, dimension);
+}
+
+template <>
+void
+KnobStringBase::valueToRenderSnapshot(const std::string& value,
+                                      int /*dimension*/,
+                                      KnobDimensionSnapshot* snapshot) const
+{
+    snapshot->stringValue = value;
+}
+
+template <typename T>
+void
+Knob<T>::getRenderSnapshot(std::vector<KnobDimensionSnapshot>* dimensions)
+{
+    int nDims = getDimension();
+
+    dimensions->resize(nDims);
+    for (int i = 0; i < nDims; ++i) {
+        KnobDimensionSnapshot& snapshot = (*dimensions)[i];
+
+        ///expressions and slaved dimensions are evaluated live
+        if ( !getExpression(i).empty() || getMaster(i).second ) {
+            continue;
+        }
+        if ( canAnimate() ) {
+            CurvePtr curve = getCurve(ViewIdx(0), i, true);
+            if ( curve && curve->isAnimated() ) {
+                if ( !isTypePOD() ) {
+                    ///animated strings have a custom interpolation
+                    continue;
+                }
+                snapshot.curve.reset( new Curve(*curve) );
+            }
+        }
+
+        T value;
+        {
+            QMutexLocker l(&_valueMutex);
+            value = _values[i];
+        }
+        valueToRenderSnapshot(value, i, &snapshot);
+        snapshot.valid = true;
+    }
+}
+
+template <typename T>
+bool
+Knob<T>::getValueFromRenderSnapshot(bool useCurrentTime,
+                                    double time,
+                                    int dimension,
+                                    bool clamp,
+                                    T* ret)
+{
+    KnobHolderPtr holder = getHolder();
+
+    if (!holder) {
+        return false;
+    }
+    const KnobsRenderSnapshot* knobsSnapshot = holder->getCurrentRenderKnobsSnapshot();
+    if (!knobsSnapshot) {
+        return false;
+    }
+    const KnobDimensionSnapshot* snapshot = knobsSnapshot->getDimension(this, dimension);
+    if ( !snapshot || !snapshot->valid ) {
+        return false;
+    }
+    if (useCurrentTime && snapshot->curve) {
+        time = holder->getCurrentTime();
+    }
+    *ret = valueFromRenderSnapshot(*snapshot, time, clamp);
+
+    return true;
+}
+
 template <>
 int
 KnobHelper::pyObjectToType(PyObject* o) const
@@ -707,6 +817,12 @@ Knob<T>::getValue(int dimension,
     if ( ( dimension >= (int)_values.size() ) || (dimension < 0) ) {
         return T();
     }
+    if (!useGuiValues) {
+        T ret;
+        if ( getValueFromRenderSnapshot(true, 0., dimension, clamp, &ret) ) {
+            return ret;
+        }
+    }
     std::string hasExpr = getExpression(dimension);
     if ( !hasExpr.empty() ) {
         T ret;
@@ -821,6 +937,12 @@ Knob<T>::getValueAtTime(double time,
     }
 
     bool useGuiValues = QThread::currentThread() == qApp->thread();
+    if (!useGuiValues) {
+        T ret;
+        if ( getValueFromRenderSnapshot(false, time, dimension, clamp, &ret) ) {
+            return ret;
+        }
+    }
     std::string hasExpr = getExpression(dimension);
     if ( !hasExpr.empty() ) {
         T ret;
@@ -0,0 +1,63 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <http://www.natron.fr/>,
+ * Copyright (C) 2016 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "KnobsRenderSnapshot.h"
+
+#include "Engine/Knob.h"
+
+NATRON_NAMESPACE_ENTER;
+
+KnobsRenderSnapshot::KnobsRenderSnapshot(const KnobsVec& knobs)
+    : _knobs()
+{
+    for (KnobsVec::const_iterator it = knobs.begin(); it != knobs.end(); ++it) {
+        if ( !(*it)->getEvaluateOnChange() ) {
+            continue;
+        }
+        std::vector<KnobDimensionSnapshot> dimensions;
+        (*it)->getRenderSnapshot(&dimensions);
+        if ( !dimensions.empty() ) {
+            _knobs[it->get()].swap(dimensions);
+        }
+    }
+}
+
+KnobsRenderSnapshot::~KnobsRenderSnapshot()
+{
+}
+
+const KnobDimensionSnapshot*
+KnobsRenderSnapshot::getDimension(const KnobI* knob,
+                                  int dimension) const
+{
+    KnobsMap::const_iterator found = _knobs.find(knob);
+
+    if ( ( found == _knobs.end() ) || (dimension < 0) || ( dimension >= (int)found->second.size() ) ) {
+        return 0;
+    }
+
+    return &found->second[dimension];
+}
+
+NATRON_NAMESPACE_EXIT;
@@ -0,0 +1,100 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <http://www.natron.fr/>,
+ * Copyright (C) 2016 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+#ifndef Engine_KnobsRenderSnapshot_h
+#define Engine_KnobsRenderSnapshot_h
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "Global/Macros.h"
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "Engine/EngineFwd.h"
+
+NATRON_NAMESPACE_ENTER;
+
+/**
+ * @brief The value of one dimension of a knob, as frozen when a render started.
+ * If valid is false the dimension cannot be read from the snapshot (it has an expression or
+ * is slaved to another knob) and the knob must be queried as usual.
+ **/
+struct KnobDimensionSnapshot
+{
+    bool valid;
+
+    // The value of the dimension, unclamped and clamped to the min/max of the knob (POD knobs only)
+    double value;
+    double clampedValue;
+
+    // The value of the dimension (string knobs only)
+    std::string stringValue;
+
+    // A private copy of the animation curve, or NULL if the dimension is not animated
+    CurvePtr curve;
+
+    KnobDimensionSnapshot()
+        : valid(false)
+        , value(0.)
+        , clampedValue(0.)
+        , stringValue()
+        , curve()
+    {
+    }
+};
+
+/**
+ * @brief An immutable copy of the values and animation curves of the knobs of an effect, made when a render
+ * of the effect starts. Render threads read knob values from it instead of taking the locks of each knob.
+ * Since it never changes once built, it is shared by all the renders made while the hash of the node
+ * stays the same (see EffectInstance::getOrCreateKnobsRenderSnapshot).
+ **/
+class KnobsRenderSnapshot
+{
+public:
+
+    /**
+     * @brief Builds the snapshot of the given knobs. Knobs that do not evaluate on change are left out:
+     * changing them does not change the hash of the node, hence they must always be read live.
+     **/
+    explicit KnobsRenderSnapshot(const KnobsVec& knobs);
+
+    ~KnobsRenderSnapshot();
+
+    /**
+     * @brief Returns the frozen value of the given dimension of the knob, or NULL if the knob must be
+     * queried as usual. The returned dimension may still be invalid (see KnobDimensionSnapshot).
+     * This is thread-safe and lock-free.
+     **/
+    const KnobDimensionSnapshot* getDimension(const KnobI* knob, int dimension) const WARN_UNUSED_RETURN;
+
+private:
+
+    typedef std::map<const KnobI*, std::vector<KnobDimensionSnapshot> > KnobsMap;
+    KnobsMap _knobs;
+};
+
+NATRON_NAMESPACE_EXIT;
+
+#endif // Engine_KnobsRenderSnapshot_h
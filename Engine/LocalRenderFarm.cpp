@@ -0,0 +1,326 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <http://www.natron.fr/>,
+ * Copyright (C) 2016 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "LocalRenderFarm.h"
+
+#include <list>
+#include <map>
+#include <set>
+#include <cassert>
+#include <iostream>
+#include <stdexcept>
+
+#include <QtCore/QCoreApplication>
+#include <QtCore/QEventLoop>
+#include <QtCore/QTextStream>
+#include <QtCore/QThread>
+
+#if !defined(Q_MOC_RUN) && !defined(SBK_RUN)
+#include <boost/shared_ptr.hpp>
+#endif
+
+#include "Global/GlobalDefines.h"
+
+#include "Engine/AppManager.h"
+#include "Engine/ProcessHandler.h"
+#include "Engine/Timer.h"
+
+// The frames of a job are split in (number of workers * this value) chunks so that a process finishing early
+// can pick up remaining work instead of idling
+#define NATRON_RENDER_FARM_CHUNKS_PER_WORKER 4
+
+// Number of times the frames of a chunk are rendered again when the process rendering them failed
+#define NATRON_RENDER_FARM_MAX_RETRIES 2
+
+NATRON_NAMESPACE_ENTER;
+
+struct RenderFarmChunk
+{
+    QStringList writerArgs;
+    std::vector<int> frames;
+    std::set<int> renderedFrames;
+    int nRetries;
+
+    RenderFarmChunk()
+        : writerArgs()
+        , frames()
+        , renderedFrames()
+        , nRetries(0)
+    {
+    }
+};
+
+typedef boost::shared_ptr<RenderFarmChunk> RenderFarmChunkPtr;
+
+struct RenderFarmWorker
+{
+    ProcessHandlerPtr process;
+    RenderFarmChunkPtr chunk;
+};
+
+struct LocalRenderFarmPrivate
+{
+    Q_DECLARE_TR_FUNCTIONS(LocalRenderFarm)
+
+public:
+    QString projectPath;
+    QStringList commonArgs;
+    int nWorkers;
+
+    // Chunks waiting for an idle process, in the order they should be rendered
+    std::list<RenderFarmChunkPtr> pendingChunks;
+
+    // Chunks being rendered, keyed by the process rendering them
+    std::map<ProcessHandler*, RenderFarmWorker> activeWorkers;
+
+    // Processes that finished: they may not be destroyed in the slot connected to their own signal
+    std::list<ProcessHandlerPtr> finishedProcesses;
+    int nFailedChunks;
+    int nTotalFrames;
+    int nFramesRendered;
+    bool aborted;
+    QEventLoop eventLoop;
+    TimeLapse timer;
+
+    LocalRenderFarmPrivate(const QString& projectPath,
+                           const QStringList& commonArgs,
+                           int nWorkers)
+        : projectPath(projectPath)
+        , commonArgs(commonArgs)
+        , nWorkers( std::max(1, nWorkers) )
+        , pendingChunks()
+        , activeWorkers()
+        , finishedProcesses()
+        , nFailedChunks(0)
+        , nTotalFrames(0)
+        , nFramesRendered(0)
+        , aborted(false)
+        , eventLoop()
+        , timer()
+    {
+    }
+};
+
+LocalRenderFarm::LocalRenderFarm(const QString& projectPath,
+                                 const QStringList& commonArgs,
+                                 int nWorkers)
+    : QObject()
+    , _imp( new LocalRenderFarmPrivate(projectPath, commonArgs, nWorkers) )
+{
+}
+
+LocalRenderFarm::~LocalRenderFarm()
+{
+}
+
+QString
+LocalRenderFarm::makeFrameRangesString(const std::vector<int>& frames)
+{
+    QString ret;
+    std::size_t i = 0;
+
+    while ( i < frames.size() ) {
+        // Extend the run as long as the step between consecutive frames is constant
+        std::size_t runEnd = i;
+        int step = 0;
+        if ( (i + 1) < frames.size() ) {
+            step = frames[i + 1] - frames[i];
+            runEnd = i + 1;
+            while ( ( (runEnd + 1) < frames.size() ) && (frames[runEnd + 1] - frames[runEnd] == step) ) {
+                ++runEnd;
+            }
+        }
+        if ( !ret.isEmpty() ) {
+            ret += QLatin1Char(',');
+        }
+        if (runEnd == i) {
+            ret += QString::number(frames[i]);
+        } else {
+            ret += QString::number(frames[i]) + QLatin1Char('-') + QString::number(frames[runEnd]) + QLatin1Char(':') + QString::number(step);
+        }
+        i = runEnd + 1;
+    }
+
+    return ret;
+}
+
+void
+LocalRenderFarm::addJob(const QStringList& writerArgs,
+                        const std::vector<int>& frames,
+                        bool splittable)
+{
+    if ( frames.empty() ) {
+        return;
+    }
+    std::size_t chunkSize = frames.size();
+    if (splittable) {
+        std::size_t nChunks = _imp->nWorkers * NATRON_RENDER_FARM_CHUNKS_PER_WORKER;
+        chunkSize = std::max( (std::size_t)1, (frames.size() + nChunks - 1) / nChunks );
+    }
+
+    for (std::size_t i = 0; i < frames.size(); i += chunkSize) {
+        RenderFarmChunkPtr chunk(new RenderFarmChunk);
+        chunk->writerArgs = writerArgs;
+        chunk->frames.assign( frames.begin() + i, frames.begin() + std::min(i + chunkSize, frames.size()) );
+        _imp->pendingChunks.push_back(chunk);
+    }
+    _imp->nTotalFrames += (int)frames.size();
+}
+
+bool
+LocalRenderFarm::exec()
+{
+    assert( QThread::currentThread() == qApp->thread() );
+
+    _imp->timer.reset();
+    startPendingChunks();
+    if ( !_imp->activeWorkers.empty() ) {
+        _imp->eventLoop.exec();
+    }
+    _imp->finishedProcesses.clear();
+
+    return !_imp->aborted && _imp->nFailedChunks == 0;
+}
+
+void
+LocalRenderFarm::abortRender()
+{
+    QMetaObject::invokeMethod(this, "onAbortRequested", Qt::QueuedConnection);
+}
+
+void
+LocalRenderFarm::onAbortRequested()
+{
+    if (_imp->aborted) {
+        return;
+    }
+    _imp->aborted = true;
+    _imp->pendingChunks.clear();
+    for (std::map<ProcessHandler*, RenderFarmWorker>::iterator it = _imp->activeWorkers.begin(); it != _imp->activeWorkers.end(); ++it) {
+        it->second.process->onProcessCanceled();
+    }
+}
+
+void
+LocalRenderFarm::startPendingChunks()
+{
+    while ( ( (int)_imp->activeWorkers.size() < _imp->nWorkers ) && !_imp->pendingChunks.empty() ) {
+        RenderFarmWorker worker;
+        worker.chunk = _imp->pendingChunks.front();
+        _imp->pendingChunks.pop_front();
+
+        QStringList args = _imp->commonArgs;
+        args << worker.chunk->writerArgs;
+        args << makeFrameRangesString(worker.chunk->frames);
+
+        worker.process.reset( new ProcessHandler(_imp->projectPath, args) );
+        QObject::connect( worker.process.get(), SIGNAL(frameRendered(int,double)), this, SLOT(onWorkerFrameRendered(int,double)) );
+        QObject::connect( worker.process.get(), SIGNAL(processFinished(int)), this, SLOT(onWorkerFinished(int)) );
+        _imp->activeWorkers[worker.process.get()] = worker;
+        worker.process->startProcess();
+    }
+}
+
+void
+LocalRenderFarm::onWorkerFrameRendered(int frame,
+                                       double /*progress*/)
+{
+    ProcessHandler* process = qobject_cast<ProcessHandler*>( sender() );
+    std::map<ProcessHandler*, RenderFarmWorker>::iterator found = _imp->activeWorkers.find(process);
+
+    if ( found == _imp->activeWorkers.end() ) {
+        return;
+    }
+    // A frame is reported once per view and per writer of the chunk, only count it once
+    if ( !found->second.chunk->renderedFrames.insert(frame).second ) {
+        return;
+    }
+    ++_imp->nFramesRendered;
+
+    double percentage = _imp->nTotalFrames > 0 ? (double)_imp->nFramesRendered / _imp->nTotalFrames : 0.;
+    double timeSpentSinceStartSec = _imp->timer.getTimeSinceCreation();
+    double estimatedFps = timeSpentSinceStartSec > 0 ? _imp->nFramesRendered / timeSpentSinceStartSec : 0.;
+    double timeRemaining = percentage > 0 ? timeSpentSinceStartSec * (1. - percentage) / percentage : 0.;
+    QString frameStr = QString::number(frame);
+    QString longMessage;
+    {
+        QTextStream ts(&longMessage);
+        ts << found->second.chunk->writerArgs.join( QString::fromUtf8(" ") ) << tr(" ==> Frame: ") << frameStr;
+        ts << tr(", Progress: ") << QString::number(percentage * 100, 'f', 1) << "%, ";
+        ts << QString::number(estimatedFps, 'f', 1) << tr(" Fps, Time Remaining: ") << Timer::printAsTime(timeRemaining, true);
+    }
+    QString shortMessage = QString::fromUtf8(kFrameRenderedStringShort) + frameStr + QString::fromUtf8(kProgressChangedStringShort) + QString::number(percentage);
+    appPTR->writeToOutputPipe(longMessage, shortMessage, true);
+} // LocalRenderFarm::onWorkerFrameRendered
+
+void
+LocalRenderFarm::onWorkerFinished(int returnCode)
+{
+    ProcessHandler* process = qobject_cast<ProcessHandler*>( sender() );
+    std::map<ProcessHandler*, RenderFarmWorker>::iterator found = _imp->activeWorkers.find(process);
+
+    if ( found == _imp->activeWorkers.end() ) {
+        return;
+    }
+    RenderFarmWorker worker = found->second;
+    _imp->activeWorkers.erase(found);
+    _imp->finishedProcesses.push_back(worker.process);
+
+    if ( (returnCode != 0) && !_imp->aborted ) {
+        std::vector<int> remainingFrames;
+        for (std::vector<int>::const_iterator it = worker.chunk->frames.begin(); it != worker.chunk->frames.end(); ++it) {
+            if ( worker.chunk->renderedFrames.find(*it) == worker.chunk->renderedFrames.end() ) {
+                remainingFrames.push_back(*it);
+            }
+        }
+        if ( !remainingFrames.empty() ) {
+            QString framesStr = makeFrameRangesString(remainingFrames);
+            if (worker.chunk->nRetries < NATRON_RENDER_FARM_MAX_RETRIES) {
+                std::cerr << tr("WARNING: The render process of frames %1 %2. These frames will be rendered again.")
+                    .arg(framesStr)
+                    .arg( returnCode == 2 ? tr("crashed") : tr("failed") ).toStdString() << std::endl;
+                RenderFarmChunkPtr retry(new RenderFarmChunk);
+                retry->writerArgs = worker.chunk->writerArgs;
+                retry->frames = remainingFrames;
+                retry->nRetries = worker.chunk->nRetries + 1;
+                _imp->pendingChunks.push_front(retry);
+            } else {
+                std::cerr << tr("ERROR: Failed to render frames %1 after %2 attempts:").arg(framesStr).arg(worker.chunk->nRetries + 1).toStdString() << std::endl;
+                std::cerr << worker.process->getProcessLog().toStdString() << std::endl;
+                ++_imp->nFailedChunks;
+            }
+        }
+    }
+
+    startPendingChunks();
+
+    if ( _imp->activeWorkers.empty() ) {
+        _imp->eventLoop.quit();
+    }
+} // LocalRenderFarm::onWorkerFinished
+
+NATRON_NAMESPACE_EXIT;
+
+NATRON_NAMESPACE_USING;
+#include "moc_LocalRenderFarm.cpp"
@@ -0,0 +1,121 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <http://www.natron.fr/>,
+ * Copyright (C) 2016 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+#ifndef Engine_LocalRenderFarm_h
+#define Engine_LocalRenderFarm_h
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "Global/Macros.h"
+
+#include <vector>
+
+#if !defined(Q_MOC_RUN) && !defined(SBK_RUN)
+#include <boost/scoped_ptr.hpp>
+#endif
+
+CLANG_DIAG_OFF(deprecated)
+#include <QtCore/QObject>
+#include <QtCore/QString>
+#include <QtCore/QStringList>
+CLANG_DIAG_ON(deprecated)
+
+#include "Engine/EngineFwd.h"
+
+NATRON_NAMESPACE_ENTER;
+
+/**
+ * @brief Renders frames of a project with several renderer processes running on the local computer.
+ * The frames of each job are split in chunks which are handed out to the first idle process: a process
+ * that finishes early just picks the next chunk, which balances the load across processes.
+ * Each process is driven by a ProcessHandler and reports the frames it rendered via the IPC pipe.
+ * The frames of a chunk whose process failed or crashed are queued again, up to a fixed number of retries.
+ * The progress of all processes is aggregated and forwarded to the output pipe of this process (if any),
+ * so that a GUI process driving this one sees a single render.
+ *
+ * This is used by NatronRenderer --workers N to get around per-process bottlenecks such as the Python GIL
+ * or plug-ins that are not thread-safe.
+ **/
+struct LocalRenderFarmPrivate;
+class LocalRenderFarm
+    : public QObject
+{
+GCC_DIAG_SUGGEST_OVERRIDE_OFF
+    Q_OBJECT
+GCC_DIAG_SUGGEST_OVERRIDE_ON
+
+public:
+
+    /**
+     * @brief Each process loads projectPath with the given commonArgs (readers, Python commands, etc...)
+     * and the writer arguments and frames of the chunk it renders.
+     **/
+    LocalRenderFarm(const QString& projectPath,
+                    const QStringList& commonArgs,
+                    int nWorkers);
+
+    virtual ~LocalRenderFarm();
+
+    /**
+     * @brief Queue frames to render with the given writer arguments (e.g: -w MyWriter).
+     * If splittable is false (e.g: when writing a video file), all the frames are rendered by a single process.
+     **/
+    void addJob(const QStringList& writerArgs,
+                const std::vector<int>& frames,
+                bool splittable);
+
+    /**
+     * @brief Dispatch all jobs to the worker processes. This function runs an event loop and does not return
+     * until all chunks are rendered or the render was aborted.
+     * @returns True if all frames were rendered successfully.
+     **/
+    bool exec();
+
+    /**
+     * @brief Aborts all worker processes. This may be called from any thread.
+     **/
+    void abortRender();
+
+    /**
+     * @brief Returns a frame range string as understood by the command-line, e.g: 1-10:2,15,20-22 or -10--2:2,0
+     * The frames must be sorted in increasing order.
+     **/
+    static QString makeFrameRangesString(const std::vector<int>& frames);
+
+public Q_SLOTS:
+
+    void onWorkerFrameRendered(int frame, double progress);
+
+    void onWorkerFinished(int returnCode);
+
+    void onAbortRequested();
+
+private:
+
+    void startPendingChunks();
+
+    boost::scoped_ptr<LocalRenderFarmPrivate> _imp;
+};
+
+NATRON_NAMESPACE_EXIT;
+
+#endif // Engine_LocalRenderFarm_h
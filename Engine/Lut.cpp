@@ -29,6 +29,10 @@
 #include <cassert>
 #include <stdexcept>
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
 #include "Engine/RectI.h"
 
 /*
@@ -140,6 +144,7 @@ LutManager::getLut(const std::string & name,
                    fromColorSpaceFunctionV1 fromFunc,
                    toColorSpaceFunctionV1 toFunc)
 {
+    QMutexLocker k(&LutManager::m_instance.lutsMutex);
     LutsMap::iterator found = LutManager::m_instance.luts.find(name);
 
     if ( found != LutManager::m_instance.luts.end() ) {
@@ -227,8 +232,6 @@ getOffsetsForPacking(PixelPackingEnum format,
 float
 Lut::fromColorSpaceUint8ToLinearFloatFast(unsigned char v) const
 {
-    assert(init_);
-
     return fromFunc_uint8_to_float[v];
 }
 
@@ -238,8 +241,6 @@ Lut::fromColorSpaceUint8ToLinearFloatFast(unsigned char v) const
 float
 Lut::toColorSpaceFloatFromLinearFloatFast(float v) const
 {
-    assert(init_);
-
     return Color::intToFloat<0xff01>(toFunc_hipart_to_uint8xx[hipart(v)]);
 }
 
@@ -248,16 +249,12 @@ Lut::toColorSpaceFloatFromLinearFloatFast(float v) const
 unsigned char
 Lut::toColorSpaceUint8FromLinearFloatFast(float v) const
 {
-    assert(init_);
-
     return Color::uint8xxToChar(toFunc_hipart_to_uint8xx[hipart(v)]);
 }
 
 unsigned short
 Lut::toColorSpaceUint8xxFromLinearFloatFast(float v) const
 {
-    assert(init_);
-
     return toFunc_hipart_to_uint8xx[hipart(v)];
 }
 
@@ -265,7 +262,6 @@ Lut::toColorSpaceUint8xxFromLinearFloatFast(float v) const
 unsigned short
 Lut::toColorSpaceUint16FromLinearFloatFast(float v) const
 {
-    assert(init_);
     // algorithm:
     // - convert to 8 bits -> val8u
     // - convert val8u-1, val8u and val8u+1 to float
@@ -300,31 +296,12 @@ Lut::toColorSpaceUint16FromLinearFloatFast(float v) const
     }
 
     // interpolate linearly
-    return (v8u_prev << 8) + v8u_prev + (v - v32f_prev) * ( ( (v8u_next - v8u_prev) << 8 ) + (v8u_next + v8u_prev) ) / (v32f_next - v32f_prev) + 0.5;
-}
-
-float
-Lut::fromColorSpaceUint16ToLinearFloatFast(unsigned short v) const
-{
-    assert(init_);
-    // the following is from ImageMagick's quantum.h
-    unsigned char v8u_prev = ( v - (v >> 8) ) >> 8;
-    unsigned char v8u_next = v8u_prev + 1;
-    unsigned short v16u_prev = (v8u_prev << 8) + v8u_prev;
-    unsigned short v16u_next = (v8u_next << 8) + v8u_next;
-    float v32f_prev = fromColorSpaceUint8ToLinearFloatFast(v8u_prev);
-    float v32f_next = fromColorSpaceUint8ToLinearFloatFast(v8u_next);
-
-    // interpolate linearly
-    return v32f_prev + (v - v16u_prev) * (v32f_next - v32f_prev) / (v16u_next - v16u_prev);
+    return (v8u_prev << 8) + v8u_prev + (v - v32f_prev) * ( ( (v8u_next - v8u_prev) << 8 ) + (v8u_next - v8u_prev) ) / (v32f_next - v32f_prev) + 0.5;
 }
 
 void
-Lut::fillTables() const
+Lut::fillTables()
 {
-    if (init_) {
-        return;
-    }
     // fill all
     for (int i = 0; i < 0x10000; ++i) {
         float inp = index_to_float( (unsigned short)i );
@@ -342,6 +319,11 @@ Lut::fillTables() const
         int i = hipart(f);
         toFunc_hipart_to_uint8xx[i] = Color::charToUint8xx(b);
     }
+    // 16-bit values are converted exactly rather than interpolated from the 8-bit table.
+    // Values that are also 8-bit values (0x101 multiples) use the same result as the 8-bit table.
+    for (int i = 0; i < 0x10000; ++i) {
+        fromFunc_uint16_to_float[i] = ( (i % 0x101) == 0 ) ? fromFunc_uint8_to_float[i / 0x101] : _fromFunc( Color::intToFloat<65536>(i) );
+    }
 }
 
 #ifdef DEAD_CODE
@@ -353,7 +335,6 @@ Lut::to_byte_planar(unsigned char* to,
                     int inDelta,
                     int outDelta) const
 {
-    validate();
     unsigned char *end = to + W * outDelta;
     // coverity[dont_call]
     int start = rand() % W;
@@ -398,20 +379,26 @@ Lut::to_byte_planar(unsigned char* to,
 
 #endif // DEAD_CODE
 
-#ifdef DEAD_CODE
 void
-Lut::to_short_planar(unsigned short* /*to*/,
-                     const float* /*from*/,
-                     int /*W*/,
-                     const float* /*alpha*/,
-                     int /*inDelta*/,
-                     int /*outDelta*/) const
-{
-    throw std::runtime_error("Lut::to_short_planar not implemented yet.");
+Lut::to_short_planar(unsigned short* to,
+                     const float* from,
+                     int W,
+                     const float* alpha,
+                     int inDelta,
+                     int outDelta) const
+{
+    // no error diffusion is needed with 16 bits
+    if (!alpha) {
+        for (int f = 0, t = 0; f < W; f += inDelta, t += outDelta) {
+            to[t] = toColorSpaceUint16FromLinearFloatFast(from[f]);
+        }
+    } else {
+        for (int f = 0, t = 0; f < W; f += inDelta, t += outDelta) {
+            to[t] = toColorSpaceUint16FromLinearFloatFast(from[f] * alpha[f]);
+        }
+    }
 }
 
-#endif // DEAD_CODE
-
 void
 Lut::to_float_planar(float* to,
                      const float* from,
@@ -420,7 +407,6 @@ Lut::to_float_planar(float* to,
                      int inDelta,
                      int outDelta) const
 {
-    validate();
     if (!alpha) {
         for (int f = 0, t = 0; f < W; f += inDelta, t += outDelta) {
             to[t] = toColorSpaceFloatFromLinearFloat(from[f]);
@@ -462,8 +448,6 @@ Lut::to_byte_packed(unsigned char* to,
     inPackingSize = inputHasAlpha ? 4 : 3;
     outPackingSize = outputHasAlpha ? 4 : 3;
 
-    validate();
-
     for (int y = rect.y1; y < rect.y2; ++y) {
         // coverity[dont_call]
         int start = rand() % (rect.x2 - rect.x1) + rect.x1;
@@ -516,22 +500,59 @@ Lut::to_byte_packed(unsigned char* to,
     }
 } // to_byte_packed
 
-#ifdef DEAD_CODE
 void
-Lut::to_short_packed(unsigned short* /*to*/,
-                     const float* /*from*/,
-                     const RectI & /*conversionRect*/,
-                     const RectI & /*srcBounds*/,
-                     const RectI & /*dstBounds*/,
-                     PixelPackingEnum /*inputPacking*/,
-                     PixelPackingEnum /*outputPacking*/,
-                     bool /*invertY*/,
-                     bool /*premult*/) const
-{
-    throw std::runtime_error("Lut::to_short_packed not implemented yet.");
-}
+Lut::to_short_packed(unsigned short* to,
+                     const float* from,
+                     const RectI & conversionRect,
+                     const RectI & srcBounds,
+                     const RectI & dstBounds,
+                     PixelPackingEnum inputPacking,
+                     PixelPackingEnum outputPacking,
+                     bool invertY,
+                     bool premult) const
+{
+    ///clip the conversion rect to srcBounds and dstBounds
+    RectI rect = conversionRect;
 
-#endif // DEAD_CODE
+    if ( !clip(&rect, srcBounds) || !clip(&rect, dstBounds) ) {
+        return;
+    }
+
+    bool inputHasAlpha = inputPacking == ePixelPackingBGRA || inputPacking == ePixelPackingRGBA;
+    bool outputHasAlpha = outputPacking == ePixelPackingBGRA || outputPacking == ePixelPackingRGBA;
+    int inROffset, inGOffset, inBOffset, inAOffset;
+    int outROffset, outGOffset, outBOffset, outAOffset;
+    getOffsetsForPacking(inputPacking, &inROffset, &inGOffset, &inBOffset, &inAOffset);
+    getOffsetsForPacking(outputPacking, &outROffset, &outGOffset, &outBOffset, &outAOffset);
+
+    int inPackingSize, outPackingSize;
+    inPackingSize = inputHasAlpha ? 4 : 3;
+    outPackingSize = outputHasAlpha ? 4 : 3;
+
+    for (int y = rect.y1; y < rect.y2; ++y) {
+        int srcY = y;
+        if (invertY) {
+            srcY = srcBounds.y2 - y - 1;
+        }
+
+        int dstY = dstBounds.y2 - y - 1;
+        const float *src_pixels = from + (srcY * (srcBounds.x2 - srcBounds.x1) * inPackingSize);
+        unsigned short *dst_pixels = to + (dstY * (dstBounds.x2 - dstBounds.x1) * outPackingSize);
+        // no error diffusion is needed with 16 bits
+        for (int x = rect.x1; x < rect.x2; ++x) {
+            int inCol = x * inPackingSize;
+            int outCol = x * outPackingSize;
+            float a = (inputHasAlpha && premult) ? src_pixels[inCol + inAOffset] : 1.f;
+            dst_pixels[outCol + outROffset] = toColorSpaceUint16FromLinearFloatFast(src_pixels[inCol + inROffset] * a);
+            dst_pixels[outCol + outGOffset] = toColorSpaceUint16FromLinearFloatFast(src_pixels[inCol + inGOffset] * a);
+            dst_pixels[outCol + outBOffset] = toColorSpaceUint16FromLinearFloatFast(src_pixels[inCol + inBOffset] * a);
+            if (outputHasAlpha) {
+                // alpha is linear
+                dst_pixels[outCol + outAOffset] = floatToInt<65536>(a);
+            }
+        }
+    }
+} // to_short_packed
 
 void
 Lut::to_float_packed(float* to,
@@ -562,8 +583,6 @@ Lut::to_float_packed(float* to,
     inPackingSize = inputHasAlpha ? 4 : 3;
     outPackingSize = outputHasAlpha ? 4 : 3;
 
-    validate();
-
     for (int y = rect.y1; y < rect.y2; ++y) {
         int srcY = y;
         if (invertY) {
@@ -597,10 +616,9 @@ Lut::from_byte_planar(float* to,
                       int inDelta,
                       int outDelta) const
 {
-    validate();
     if (!alpha) {
         for (int f = 0, t = 0; f < W; f += inDelta, t += outDelta) {
-            to[f] = fromFunc_uint8_to_float[(int)from[f]];
+            to[t] = fromFunc_uint8_to_float[(int)from[f]];
         }
     } else {
         for (int f = 0, t = 0; f < W; f += inDelta, t += outDelta) {
@@ -610,14 +628,23 @@ Lut::from_byte_planar(float* to,
 }
 
 void
-Lut::from_short_planar(float* /*to*/,
-                       const unsigned short* /*from*/,
-                       int /*W*/,
-                       const unsigned short*/* alpha*/,
-                       int /*inDelta*/,
-                       int /* outDelta*/) const
-{
-    throw std::runtime_error("Lut::from_short_planar not implemented yet.");
+Lut::from_short_planar(float* to,
+                       const unsigned short* from,
+                       int W,
+                       const unsigned short* alpha,
+                       int inDelta,
+                       int outDelta) const
+{
+    if (!alpha) {
+        for (int f = 0, t = 0; f < W; f += inDelta, t += outDelta) {
+            to[t] = fromFunc_uint16_to_float[from[f]];
+        }
+    } else {
+        for (int f = 0, t = 0; f < W; f += inDelta, t += outDelta) {
+            float a = Color::intToFloat<65536>(alpha[f]);
+            to[t] = a <= 0 ? 0 : fromFunc_uint16_to_float[Color::floatToInt<65536>(Color::intToFloat<65536>(from[f]) / a)] * a;
+        }
+    }
 }
 
 void
@@ -628,7 +655,6 @@ Lut::from_float_planar(float* to,
                        int inDelta,
                        int outDelta) const
 {
-    validate();
     if (!alpha) {
         for (int f = 0, t = 0; f < W; f += inDelta, t += outDelta) {
             to[t] = fromColorSpaceFloatToLinearFloat(from[f]);
@@ -674,7 +700,6 @@ Lut::from_byte_packed(float* to,
     inPackingSize = inputHasAlpha ? 4 : 3;
     outPackingSize = outputHasAlpha ? 4 : 3;
 
-    validate();
     for (int y = rect.y1; y < rect.y2; ++y) {
         int srcY = y;
         if (invertY) {
@@ -722,18 +747,77 @@ Lut::from_byte_packed(float* to,
 } // from_byte_packed
 
 void
-Lut::from_short_packed(float* /*to*/,
-                       const unsigned short* /*from*/,
-                       const RectI & /*conversionRect*/,
-                       const RectI & /*srcBounds*/,
-                       const RectI & /*dstBounds*/,
-                       PixelPackingEnum /*inputPacking*/,
-                       PixelPackingEnum /*outputPacking*/,
-                       bool /*invertY*/,
-                       bool /*premult*/) const
-{
-    throw std::runtime_error("Lut::from_short_packed not implemented yet.");
-}
+Lut::from_short_packed(float* to,
+                       const unsigned short* from,
+                       const RectI & conversionRect,
+                       const RectI & srcBounds,
+                       const RectI & dstBounds,
+                       PixelPackingEnum inputPacking,
+                       PixelPackingEnum outputPacking,
+                       bool invertY,
+                       bool premult) const
+{
+    if ( ( inputPacking == ePixelPackingPLANAR) || ( outputPacking == ePixelPackingPLANAR) ) {
+        throw std::runtime_error("Invalid pixel format.");
+    }
+
+    ///clip the conversion rect to srcBounds and dstBounds
+    RectI rect = conversionRect;
+    if ( !clip(&rect, srcBounds) || !clip(&rect, dstBounds) ) {
+        return;
+    }
+
+
+    bool inputHasAlpha = inputPacking == ePixelPackingBGRA || inputPacking == ePixelPackingRGBA;
+    bool outputHasAlpha = outputPacking == ePixelPackingBGRA || outputPacking == ePixelPackingRGBA;
+    int inROffset, inGOffset, inBOffset, inAOffset;
+    int outROffset, outGOffset, outBOffset, outAOffset;
+    getOffsetsForPacking(inputPacking, &inROffset, &inGOffset, &inBOffset, &inAOffset);
+    getOffsetsForPacking(outputPacking, &outROffset, &outGOffset, &outBOffset, &outAOffset);
+
+    int inPackingSize, outPackingSize;
+    inPackingSize = inputHasAlpha ? 4 : 3;
+    outPackingSize = outputHasAlpha ? 4 : 3;
+
+    for (int y = rect.y1; y < rect.y2; ++y) {
+        int srcY = y;
+        if (invertY) {
+            srcY = srcBounds.y2 - y - 1;
+        }
+
+        const unsigned short *src_pixels = from + (srcY * (srcBounds.x2 - srcBounds.x1) * inPackingSize);
+        float *dst_pixels = to + (y * (dstBounds.x2 - dstBounds.x1) * outPackingSize);
+        for (int x = rect.x1; x < rect.x2; ++x) {
+            int inCol = x * inPackingSize;
+            int outCol = x * outPackingSize;
+            if (inputHasAlpha && premult) {
+                float rf = 0., gf = 0., bf = 0.;
+                float a = Color::intToFloat<65536>(src_pixels[inCol + inAOffset]);
+                if (a > 0) {
+                    rf = Color::intToFloat<65536>(src_pixels[inCol + inROffset]) / a;
+                    gf = Color::intToFloat<65536>(src_pixels[inCol + inGOffset]) / a;
+                    bf = Color::intToFloat<65536>(src_pixels[inCol + inBOffset]) / a;
+                }
+                dst_pixels[outCol + outROffset] = fromFunc_uint16_to_float[Color::floatToInt<65536>(rf)] * a;
+                dst_pixels[outCol + outGOffset] = fromFunc_uint16_to_float[Color::floatToInt<65536>(gf)] * a;
+                dst_pixels[outCol + outBOffset] = fromFunc_uint16_to_float[Color::floatToInt<65536>(bf)] * a;
+                if (outputHasAlpha) {
+                    // alpha is linear
+                    dst_pixels[outCol + outAOffset] = a;
+                }
+            } else {
+                dst_pixels[outCol + outROffset] = fromFunc_uint16_to_float[src_pixels[inCol + inROffset]];
+                dst_pixels[outCol + outGOffset] = fromFunc_uint16_to_float[src_pixels[inCol + inGOffset]];
+                dst_pixels[outCol + outBOffset] = fromFunc_uint16_to_float[src_pixels[inCol + inBOffset]];
+                if (outputHasAlpha) {
+                    // alpha is linear
+                    float a = inputHasAlpha ? Color::intToFloat<65536>(src_pixels[inCol + inAOffset]) : 1.f;
+                    dst_pixels[outCol + outAOffset] = a;
+                }
+            }
+        }
+    }
+} // from_short_packed
 
 void
 Lut::from_float_packed(float* to,
@@ -768,8 +852,6 @@ Lut::from_float_packed(float* to,
     inPackingSize = inputHasAlpha ? 4 : 3;
     outPackingSize = outputHasAlpha ? 4 : 3;
 
-    validate();
-
     for (int y = rect.y1; y < rect.y2; ++y) {
         int srcY = y;
         if (invertY) {
@@ -802,6 +884,58 @@ Lut::from_float_packed(float* to,
 /////////////////////////////////////////// LINEAR //////////////////////////////////////////////
 ///////////////////////
 
+/*
+ * Convert n contiguous integer values to float in [0,1].
+ * Unlike the Lut conversions these do not need any table lookup, so 4 values are converted at once with SSE2.
+ * The division by the max value is kept rather than a multiplication by its inverse, so that
+ * the result is exactly the same as intToFloat().
+ */
+static void
+uint8RowToFloat(const unsigned char* from,
+                float* to,
+                int n)
+{
+    int i = 0;
+
+#ifdef __SSE2__
+    const __m128 maxValue = _mm_set1_ps(255.f);
+    const __m128i zero = _mm_setzero_si128();
+    for (; i + 16 <= n; i += 16) {
+        __m128i v = _mm_loadu_si128( (const __m128i*)(from + i) );
+        __m128i lo = _mm_unpacklo_epi8(v, zero);
+        __m128i hi = _mm_unpackhi_epi8(v, zero);
+        _mm_storeu_ps( to + i, _mm_div_ps(_mm_cvtepi32_ps( _mm_unpacklo_epi16(lo, zero) ), maxValue) );
+        _mm_storeu_ps( to + i + 4, _mm_div_ps(_mm_cvtepi32_ps( _mm_unpackhi_epi16(lo, zero) ), maxValue) );
+        _mm_storeu_ps( to + i + 8, _mm_div_ps(_mm_cvtepi32_ps( _mm_unpacklo_epi16(hi, zero) ), maxValue) );
+        _mm_storeu_ps( to + i + 12, _mm_div_ps(_mm_cvtepi32_ps( _mm_unpackhi_epi16(hi, zero) ), maxValue) );
+    }
+#endif
+    for (; i < n; ++i) {
+        to[i] = intToFloat<256>(from[i]);
+    }
+}
+
+static void
+uint16RowToFloat(const unsigned short* from,
+                 float* to,
+                 int n)
+{
+    int i = 0;
+
+#ifdef __SSE2__
+    const __m128 maxValue = _mm_set1_ps(65535.f);
+    const __m128i zero = _mm_setzero_si128();
+    for (; i + 8 <= n; i += 8) {
+        __m128i v = _mm_loadu_si128( (const __m128i*)(from + i) );
+        _mm_storeu_ps( to + i, _mm_div_ps(_mm_cvtepi32_ps( _mm_unpacklo_epi16(v, zero) ), maxValue) );
+        _mm_storeu_ps( to + i + 4, _mm_div_ps(_mm_cvtepi32_ps( _mm_unpackhi_epi16(v, zero) ), maxValue) );
+    }
+#endif
+    for (; i < n; ++i) {
+        to[i] = intToFloat<65536>(from[i]);
+    }
+}
+
 namespace Linear {
 void
 from_byte_planar(float *to,
@@ -810,6 +944,11 @@ from_byte_planar(float *to,
                  int inDelta,
                  int outDelta)
 {
+    if ( ( inDelta == 1) && ( outDelta == 1) ) {
+        uint8RowToFloat(from, to, W);
+
+        return;
+    }
     from += (W - 1) * inDelta;
     to += W * outDelta;
     for (; --W >= 0; from -= inDelta) {
@@ -825,6 +964,11 @@ from_short_planar(float *to,
                   int inDelta,
                   int outDelta)
 {
+    if ( ( inDelta == 1) && ( outDelta == 1) ) {
+        uint16RowToFloat(from, to, W);
+
+        return;
+    }
     for (int f = 0, t = 0; f < W; f += inDelta, t += outDelta) {
         to[t] = intToFloat<65536>(from[f]);
     }
@@ -888,6 +1032,10 @@ from_byte_packed(float *to,
         }
         const unsigned char *src_pixels = from + (srcY * (srcBounds.x2 - srcBounds.x1) * inPackingSize);
         float *dst_pixels = to + (y * (dstBounds.x2 - dstBounds.x1) * outPackingSize);
+        if (inputPacking == outputPacking) {
+            uint8RowToFloat(src_pixels + rect.x1 * inPackingSize, dst_pixels + rect.x1 * outPackingSize, (rect.x2 - rect.x1) * inPackingSize);
+            continue;
+        }
         for (int x = rect.x1; x < rect.x2; ++x) {
             int inCol = x * inPackingSize;
             int outCol = x * outPackingSize;
@@ -904,17 +1052,64 @@ from_byte_packed(float *to,
 }
 
 void
-from_short_packed(float */*to*/,
-                  const unsigned short */*from*/,
-                  const RectI & /*rect*/,
-                  const RectI & /*srcRod*/,
-                  const RectI & /*rod*/,
-                  PixelPackingEnum /*inputFormat*/,
-                  PixelPackingEnum /*format*/,
-                  bool /*invertY*/)
-{
-    throw std::runtime_error("Linear::from_short_packed not yet implemented.");
-}
+from_short_packed(float *to,
+                  const unsigned short *from,
+                  const RectI &conversionRect,
+                  const RectI &srcBounds,
+                  const RectI &dstBounds,
+                  PixelPackingEnum inputPacking,
+                  PixelPackingEnum outputPacking,
+                  bool invertY)
+{
+    if ( ( inputPacking == ePixelPackingPLANAR) || ( outputPacking == ePixelPackingPLANAR) ) {
+        throw std::runtime_error("Invalid pixel format.");
+    }
+
+    ///clip the conversion rect to srcBounds and dstBounds
+    RectI rect = conversionRect;
+    if ( !clip(&rect, srcBounds) || !clip(&rect, dstBounds) ) {
+        return;
+    }
+
+
+    bool inputHasAlpha = inputPacking == ePixelPackingBGRA || inputPacking == ePixelPackingRGBA;
+    bool outputHasAlpha = outputPacking == ePixelPackingBGRA || outputPacking == ePixelPackingRGBA;
+    int inROffset, inGOffset, inBOffset, inAOffset;
+    int outROffset, outGOffset, outBOffset, outAOffset;
+    getOffsetsForPacking(inputPacking, &inROffset, &inGOffset, &inBOffset, &inAOffset);
+    getOffsetsForPacking(outputPacking, &outROffset, &outGOffset, &outBOffset, &outAOffset);
+
+
+    int inPackingSize, outPackingSize;
+    inPackingSize = inputHasAlpha ? 4 : 3;
+    outPackingSize = outputHasAlpha ? 4 : 3;
+
+
+    for (int y = rect.y1; y < rect.y2; ++y) {
+        int srcY = y;
+        if (invertY) {
+            srcY = srcBounds.y2 - y - 1;
+        }
+        const unsigned short *src_pixels = from + (srcY * (srcBounds.x2 - srcBounds.x1) * inPackingSize);
+        float *dst_pixels = to + (y * (dstBounds.x2 - dstBounds.x1) * outPackingSize);
+        if (inputPacking == outputPacking) {
+            uint16RowToFloat(src_pixels + rect.x1 * inPackingSize, dst_pixels + rect.x1 * outPackingSize, (rect.x2 - rect.x1) * inPackingSize);
+            continue;
+        }
+        for (int x = rect.x1; x < rect.x2; ++x) {
+            int inCol = x * inPackingSize;
+            int outCol = x * outPackingSize;
+            unsigned short a = inputHasAlpha ? src_pixels[inCol + inAOffset] : 65535;
+            dst_pixels[outCol + outROffset] = Color::intToFloat<65536>(src_pixels[inCol + inROffset]);
+            dst_pixels[outCol + outGOffset] = Color::intToFloat<65536>(src_pixels[inCol + inGOffset]);
+            dst_pixels[outCol + outBOffset] = Color::intToFloat<65536>(src_pixels[inCol + inBOffset]);
+            if (outputHasAlpha) {
+                // alpha is linear
+                dst_pixels[outCol + outAOffset] = Color::intToFloat<65536>(a);
+            }
+        }
+    }
+} // from_short_packed
 
 void
 from_float_packed(float *to,
@@ -961,7 +1156,7 @@ from_float_packed(float *to,
         const float *src_pixels = from + (srcY * (srcBounds.x2 - srcBounds.x1) * inPackingSize);
         float *dst_pixels = to + (y * (dstBounds.x2 - dstBounds.x1) * outPackingSize);
         if (inputPacking == outputPacking) {
-            std::memcpy( dst_pixels, src_pixels, (rect.x2 - rect.x1) * sizeof(float) );
+            std::memcpy( dst_pixels + rect.x1 * outPackingSize, src_pixels + rect.x1 * inPackingSize, (rect.x2 - rect.x1) * inPackingSize * sizeof(float) );
         } else {
             for (int x = rect.x1; x < rect.x2; ++x) {
                 int inCol = x * inPackingSize;
@@ -67,8 +67,8 @@ typedef float (*toColorSpaceFunctionV1)(float v);
 
 // a Singleton that holds precomputed LUTs for the whole application.
 // The m_instance member is static and is thus built before the first call to Instance().
-// WARNING : This class is not thread-safe and calling getLut must not be done in a function called
-// by multiple thread at once!
+// getLut is thread-safe. The tables of a Lut are computed when it is created, so the returned
+// Lut can be used by any thread without further synchronization.
 class Lut;
 class LutManager
 {
@@ -81,7 +81,7 @@ public:
     /**
      * @brief Returns a pointer to a lut with the given name and the given from and to functions.
      * If a lut with the same name didn't already exist, then it will create one.
-     * WARNING : NOT THREAD-SAFE
+     * This is MT-safe.
      **/
     static const Lut * getLut(const std::string & name, fromColorSpaceFunctionV1 fromFunc, toColorSpaceFunctionV1 toFunc);
 
@@ -120,6 +120,9 @@ private:
     //each lut with a ref count mapped against their name
     typedef std::map<std::string, const Lut * > LutsMap;
     LutsMap luts;
+
+    // protects luts. Only taken when looking up a lut, never during conversions.
+    QMutex lutsMutex;
 };
 
 
@@ -133,12 +136,11 @@ class Lut
     fromColorSpaceFunctionV1 _fromFunc;
     toColorSpaceFunctionV1 _toFunc;
 
-    /// the fast lookup tables are mutable, because they are automatically initialized post-construction,
-    /// and never change afterwards
-    mutable unsigned short toFunc_hipart_to_uint8xx[0x10000];         /// contains  2^16 = 65536 values between 0-255
-    mutable float fromFunc_uint8_to_float[256];         /// values between 0-1.f
-    mutable bool init_;         ///< false if the tables are not yet initialized
-    mutable QMutex _lock;         ///< protects init_
+    /// the fast lookup tables are filled by the constructor and never change afterwards,
+    /// so they can be read concurrently without locking
+    unsigned short toFunc_hipart_to_uint8xx[0x10000];         /// contains  2^16 = 65536 values between 0-255
+    float fromFunc_uint8_to_float[256];         /// values between 0-1.f
+    float fromFunc_uint16_to_float[0x10000];         /// values between 0-1.f
 
     friend class LutManager;
     ///private constructor, used by LutManager
@@ -148,15 +150,14 @@ class Lut
         : _name(name)
         , _fromFunc(fromFunc)
         , _toFunc(toFunc)
-        , init_(false)
-        , _lock()
     {
+        fillTables();
     }
 
     ///init luts
     ///it uses fromColorSpaceFloatToLinearFloat(float) and toColorSpaceFloatFromLinearFloat(float)
-    ///Called by validate()
-    void fillTables() const;
+    ///Called by the constructor
+    void fillTables();
 
 public:
 
@@ -178,18 +179,6 @@ public:
         return _toFunc(v);
     }
 
-    //Called by all public members
-    void validate() const
-    {
-        QMutexLocker g(&_lock);
-
-        if (init_) {
-            return;
-        }
-        fillTables();
-        init_ = true;
-    }
-
     const std::string & getName() const
     {
         return _name;
@@ -226,7 +215,10 @@ public:
     /* @brief Converts a short ranging in [0 - 65535] in the destination color-space using the look-up tables.
      * @return A float in [0 - 1.f] in linear color-space.
      */
-    float fromColorSpaceUint16ToLinearFloatFast(unsigned short v) const;
+    float fromColorSpaceUint16ToLinearFloatFast(unsigned short v) const
+    {
+        return fromFunc_uint16_to_float[v];
+    }
 
 
     /////@TODO the following functions expects a float input buffer, one could extend it to cover all bitdepths.
@@ -248,8 +240,8 @@ public:
      **/
     //void to_byte_planar(unsigned char* to, const float* from,int W,const float* alpha = NULL,
     //                    int inDelta = 1, int outDelta = 1) const;
-    //void to_short_planar(unsigned short* to, const float* from,int W,const float* alpha = NULL,
-    //                     int inDelta = 1, int outDelta = 1) const;
+    void to_short_planar(unsigned short* to, const float* from, int W, const float* alpha = NULL,
+                         int inDelta = 1, int outDelta = 1) const;
     void to_float_planar(float* to, const float* from, int W, const float* alpha = NULL,
                          int inDelta = 1, int outDelta = 1) const;
 
@@ -282,9 +274,9 @@ public:
     void to_byte_packed(unsigned char* to, const float* from, const RectI & conversionRect,
                         const RectI & srcRoD, const RectI & dstRoD,
                         PixelPackingEnum inputPacking, PixelPackingEnum outputPacking, bool invertY, bool premult) const; // used by QtWriter
-    //void to_short_packed(unsigned short* to, const float* from,const RectI & conversionRect,
-    //                     const RectI & srcRoD,const RectI & dstRoD,
-    //                     PixelPackingEnum inputPacking,PixelPackingEnum outputPacking,bool invertY,bool premult) const;
+    void to_short_packed(unsigned short* to, const float* from, const RectI & conversionRect,
+                         const RectI & srcRoD, const RectI & dstRoD,
+                         PixelPackingEnum inputPacking, PixelPackingEnum outputPacking, bool invertY, bool premult) const;
     void to_float_packed(float* to, const float* from, const RectI & conversionRect,
                          const RectI & srcRoD, const RectI & dstRoD,
                          PixelPackingEnum inputPacking, PixelPackingEnum outputPacking, bool invertY, bool premult) const;
@@ -0,0 +1,359 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <http://www.natron.fr/>,
+ * Copyright (C) 2016 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "MultiThreadExecutor.h"
+
+#include <algorithm> // min, max
+#include <list>
+
+#include <QtCore/QMutex>
+#include <QtCore/QMutexLocker>
+#include <QtCore/QThread>
+#include <QtCore/QWaitCondition>
+
+#include "Engine/ThreadPool.h"
+
+// A worker exits after being idle for this long
+#define NATRON_MULTI_THREAD_EXECUTOR_WORKER_EXPIRY_MS 30000
+
+NATRON_NAMESPACE_ENTER;
+
+class MultiThreadExecutorWorker;
+
+/**
+ * @brief The state of a call to MultiThreadExecutor::run(), which lives on the stack of the calling thread
+ **/
+struct MultiThreadJobState
+{
+    MultiThreadJob* job;
+    QThread* spawnerThread;
+    unsigned int count;
+
+    // Next index to start, and number of indices that returned
+    unsigned int nextIndex;
+    unsigned int nFinished;
+
+    // Workers that may still join, and the workers that joined
+    unsigned int helpersWanted;
+    unsigned int nHelpers;
+
+    // Woken up when the last index returns
+    QWaitCondition doneCond;
+
+    MultiThreadJobState(MultiThreadJob* job,
+                        unsigned int count,
+                        unsigned int helpersWanted)
+        : job(job)
+        , spawnerThread( QThread::currentThread() )
+        , count(count)
+        , nextIndex(0)
+        , nFinished(0)
+        , helpersWanted(helpersWanted)
+        , nHelpers(0)
+        , doneCond()
+    {
+    }
+
+    bool canBeHelped() const
+    {
+        return nextIndex < count && nHelpers < helpersWanted;
+    }
+};
+
+struct MultiThreadExecutorPrivate
+{
+    // Protects all fields below and the fields of the jobs
+    QMutex lock;
+
+    // Wakes up idle workers when a job may be helped or when quitting
+    QWaitCondition jobsAvailableCond;
+    int maxWorkers;
+    int workerExpiryMS;
+
+    // Jobs that may still be helped, the oldest first
+    std::list<MultiThreadJobState*> jobs;
+
+    // All workers started, some of them may have exited after being idle
+    std::list<MultiThreadExecutorWorker*> workers;
+    int nWorkersAlive;
+    int nIdleWorkers;
+
+    // Idle workers woken up that did not pick up a job yet
+    int nWakeUpsPending;
+    bool mustQuit;
+
+    MultiThreadExecutorPrivate(int maxWorkers,
+                               int workerExpiryMS)
+        : lock()
+        , jobsAvailableCond()
+        , maxWorkers(maxWorkers)
+        , workerExpiryMS(workerExpiryMS)
+        , jobs()
+        , workers()
+        , nWorkersAlive(0)
+        , nIdleWorkers(0)
+        , nWakeUpsPending(0)
+        , mustQuit(false)
+    {
+    }
+
+    /**
+     * @brief Returns the oldest job that may be helped and joins it. Must be called with lock held.
+     **/
+    MultiThreadJobState* joinJob()
+    {
+        for (std::list<MultiThreadJobState*>::iterator it = jobs.begin(); it != jobs.end(); ++it) {
+            MultiThreadJobState* state = *it;
+            if ( !state->canBeHelped() ) {
+                continue;
+            }
+            ++state->nHelpers;
+            if ( !state->canBeHelped() ) {
+                jobs.erase(it);
+            }
+
+            return state;
+        }
+
+        return 0;
+    }
+
+    bool hasJobToHelp() const
+    {
+        for (std::list<MultiThreadJobState*>::const_iterator it = jobs.begin(); it != jobs.end(); ++it) {
+            if ( (*it)->canBeHelped() ) {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    /**
+     * @brief Must be called with lock held
+     **/
+    void startWorker();
+
+    /**
+     * @brief Runs indices of the job until there are none left to start. Called with lock held, returns with lock held.
+     * When it returns, the job may not be accessed anymore if helper is true: the caller of run() may have returned.
+     **/
+    void runIndices(MultiThreadJobState* state, bool helper);
+
+    void workerLoop();
+};
+
+class MultiThreadExecutorWorker
+    : public QThread
+      , public AbortableThread
+{
+    MultiThreadExecutorPrivate* _imp;
+
+public:
+
+    MultiThreadExecutorWorker(MultiThreadExecutorPrivate* imp)
+        : QThread()
+        , AbortableThread(this)
+        , _imp(imp)
+    {
+        setThreadName("Multi-thread suite");
+    }
+
+    virtual ~MultiThreadExecutorWorker()
+    {
+    }
+
+private:
+
+    virtual void run() OVERRIDE FINAL
+    {
+        _imp->workerLoop();
+    }
+};
+
+void
+MultiThreadExecutorPrivate::runIndices(MultiThreadJobState* state,
+                                       bool helper)
+{
+    if (state->nextIndex >= state->count) {
+        return;
+    }
+    unsigned int index = state->nextIndex++;
+    if ( !state->canBeHelped() ) {
+        jobs.remove(state);
+    }
+    lock.unlock();
+
+    if (helper) {
+        state->job->onHelperEnter(state->spawnerThread);
+    }
+    for (;; ) {
+        state->job->runIndex(index, state->count);
+
+        lock.lock();
+        if (state->nextIndex >= state->count) {
+            break;
+        }
+        // The job is alive as long as an index did not return
+        index = state->nextIndex++;
+        if ( !state->canBeHelped() ) {
+            jobs.remove(state);
+        }
+        ++state->nFinished;
+        lock.unlock();
+    }
+
+    // The last index of this thread did not return yet: the job is still alive
+    if (helper) {
+        lock.unlock();
+        state->job->onHelperLeave();
+        lock.lock();
+    }
+    ++state->nFinished;
+    if (state->nFinished == state->count) {
+        state->doneCond.wakeAll();
+    }
+}
+
+void
+MultiThreadExecutorPrivate::startWorker()
+{
+    // Reclaim the workers that exited after being idle
+    for (std::list<MultiThreadExecutorWorker*>::iterator it = workers.begin(); it != workers.end(); ) {
+        if ( (*it)->isFinished() ) {
+            (*it)->wait();
+            delete *it;
+            it = workers.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    MultiThreadExecutorWorker* worker = new MultiThreadExecutorWorker(this);
+    workers.push_back(worker);
+    ++nWorkersAlive;
+    worker->start();
+}
+
+void
+MultiThreadExecutorPrivate::workerLoop()
+{
+    QMutexLocker k(&lock);
+
+    while (!mustQuit) {
+        MultiThreadJobState* state = joinJob();
+        if (!state) {
+            ++nIdleWorkers;
+            bool woken = jobsAvailableCond.wait(&lock, workerExpiryMS);
+            --nIdleWorkers;
+            if (nWakeUpsPending > 0) {
+                --nWakeUpsPending;
+                woken = true;
+            }
+            if ( !woken && !mustQuit && !hasJobToHelp() ) {
+                break;
+            }
+            continue;
+        }
+        runIndices(state, true);
+    }
+
+    --nWorkersAlive;
+}
+
+MultiThreadExecutor::MultiThreadExecutor(int maxWorkers,
+                                         int workerExpiryMS)
+    : _imp( new MultiThreadExecutorPrivate( maxWorkers > 0 ? maxWorkers : std::max(1, QThread::idealThreadCount() ),
+                                            workerExpiryMS > 0 ? workerExpiryMS : NATRON_MULTI_THREAD_EXECUTOR_WORKER_EXPIRY_MS ) )
+{
+}
+
+MultiThreadExecutor::~MultiThreadExecutor()
+{
+    std::list<MultiThreadExecutorWorker*> workers;
+    {
+        QMutexLocker k(&_imp->lock);
+        _imp->mustQuit = true;
+        _imp->jobsAvailableCond.wakeAll();
+        workers.swap(_imp->workers);
+    }
+    for (std::list<MultiThreadExecutorWorker*>::iterator it = workers.begin(); it != workers.end(); ++it) {
+        (*it)->wait();
+        delete *it;
+    }
+}
+
+int
+MultiThreadExecutor::getMaxWorkers() const
+{
+    return _imp->maxWorkers;
+}
+
+int
+MultiThreadExecutor::getNumWorkers() const
+{
+    QMutexLocker k(&_imp->lock);
+
+    return _imp->nWorkersAlive;
+}
+
+void
+MultiThreadExecutor::run(MultiThreadJob& job,
+                         unsigned int count,
+                         unsigned int maxConcurrency)
+{
+    if (count == 0) {
+        return;
+    }
+
+    // The calling thread is one of the threads running the job
+    const unsigned int helpersWanted = std::min(std::max(1U, maxConcurrency), count) - 1;
+    MultiThreadJobState state(&job, count, helpersWanted);
+    QMutexLocker k(&_imp->lock);
+
+    if ( (helpersWanted > 0) && !_imp->mustQuit ) {
+        _imp->jobs.push_back(&state);
+
+        // Wake up idle workers first, then start new workers if there are not enough
+        int nAvailable = _imp->nIdleWorkers - _imp->nWakeUpsPending;
+        int nToWake = std::min( (int)helpersWanted, std::max(0, nAvailable) );
+        for (int i = 0; i < nToWake; ++i) {
+            _imp->jobsAvailableCond.wakeOne();
+        }
+        _imp->nWakeUpsPending += nToWake;
+        int nToStart = std::min( (int)helpersWanted - nToWake, _imp->maxWorkers - _imp->nWorkersAlive );
+        for (int i = 0; i < nToStart; ++i) {
+            _imp->startWorker();
+        }
+    }
+
+    // Run indices until none is left to start, then wait for the helpers to finish theirs
+    _imp->runIndices(&state, false);
+    _imp->jobs.remove(&state);
+    while (state.nFinished < state.count) {
+        state.doneCond.wait(&_imp->lock);
+    }
+}
+
+NATRON_NAMESPACE_EXIT;
@@ -0,0 +1,117 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <http://www.natron.fr/>,
+ * Copyright (C) 2016 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+#ifndef Engine_MultiThreadExecutor_h
+#define Engine_MultiThreadExecutor_h
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "Global/Macros.h"
+
+#if !defined(Q_MOC_RUN) && !defined(SBK_RUN)
+#include <boost/scoped_ptr.hpp>
+#endif
+
+#include "Global/GlobalDefines.h"
+#include "Engine/EngineFwd.h"
+
+class QThread;
+
+NATRON_NAMESPACE_ENTER;
+
+/**
+ * @brief A parallel loop run by the MultiThreadExecutor. Inherit it and implement runIndex().
+ **/
+class MultiThreadJob
+{
+public:
+
+    MultiThreadJob() {}
+
+    virtual ~MultiThreadJob() {}
+
+    /**
+     * @brief Does the work of the given index. Called exactly once per index, either by the thread
+     * that called MultiThreadExecutor::run() or by a worker helping it.
+     **/
+    virtual void runIndex(unsigned int index, unsigned int count) = 0;
+
+    /**
+     * @brief Called in a worker before it runs its first index of the job, e.g. to copy the thread-local
+     * storage of the calling thread. Never called in the thread that called MultiThreadExecutor::run().
+     **/
+    virtual void onHelperEnter(QThread* /*spawnerThread*/) {}
+
+    /**
+     * @brief Called in a worker after it ran its last index of the job
+     **/
+    virtual void onHelperLeave() {}
+};
+
+/**
+ * @brief Worker threads running the indices of parallel loops, e.g. for the OpenFX multi-thread suite.
+ * The thread calling run() is not blocked waiting for the workers: it runs indices of its loop itself and
+ * idle workers help it. A loop never waits for an index that no thread has started, so loops may be nested
+ * (an index may call run() again) without deadlocking, and since workers are only borrowed when they are idle,
+ * nested loops never start more threads than getMaxWorkers().
+ * Workers are started on demand and exit after being idle for a while, so that the threads are only kept
+ * while plug-ins are rendering.
+ * All functions are thread-safe.
+ **/
+struct MultiThreadExecutorPrivate;
+class MultiThreadExecutor
+{
+public:
+
+    /**
+     * @brief If maxWorkers is 0, the number of cores is used.
+     * If workerExpiryMS is 0, a worker exits after being idle for 30 seconds.
+     **/
+    explicit MultiThreadExecutor(int maxWorkers = 0, int workerExpiryMS = 0);
+
+    /**
+     * @brief Waits for the workers to finish their current index and stops them.
+     **/
+    ~MultiThreadExecutor();
+
+    int getMaxWorkers() const;
+
+    /**
+     * @brief Returns the number of workers alive, i.e that did not exit after being idle
+     **/
+    int getNumWorkers() const;
+
+    /**
+     * @brief Runs job.runIndex(i, count) for all i in [0, count) on at most maxConcurrency threads,
+     * including the calling thread, and returns when all indices have returned.
+     * runIndex() must not throw.
+     **/
+    void run(MultiThreadJob& job, unsigned int count, unsigned int maxConcurrency);
+
+private:
+
+    boost::scoped_ptr<MultiThreadExecutorPrivate> _imp;
+};
+
+NATRON_NAMESPACE_EXIT;
+
+#endif // Engine_MultiThreadExecutor_h
@@ -6509,6 +6509,102 @@ renderPreviewForDepth(const Image & srcImg,
     }
 }     // renderPreviewForDepth
 
+///output is always RGBA with alpha = 255
+void
+drawPreviewImage(const Image & srcImg,
+                 bool convertToSrgb,
+                 int *dstWidth,
+                 int *dstHeight,
+                 unsigned int* dstPixels)
+{
+    int elemCount = srcImg.getComponents().getNumComponents();
+
+    switch ( srcImg.getBitDepth() ) {
+    case eImageBitDepthByte: {
+        renderPreviewForDepth<unsigned char, 255>(srcImg, elemCount, dstWidth, dstHeight, convertToSrgb, dstPixels);
+        break;
+    }
+    case eImageBitDepthShort: {
+        renderPreviewForDepth<unsigned short, 65535>(srcImg, elemCount, dstWidth, dstHeight, convertToSrgb, dstPixels);
+        break;
+    }
+    case eImageBitDepthHalf:
+        break;
+    case eImageBitDepthFloat: {
+        renderPreviewForDepth<float, 1>(srcImg, elemCount, dstWidth, dstHeight, convertToSrgb, dstPixels);
+        break;
+    }
+    case eImageBitDepthNone:
+        break;
+    }
+} // drawPreviewImage
+
+/**
+ * @brief Look in the cache for an image of the given effect that is fully rendered over its region of definition,
+ * whatever its mipmap level. Among the candidates, the smallest image that is still at least as large as
+ * the preview (i.e: the highest mipmap level lower or equal to mipMapLevel) is preferred, otherwise the
+ * largest of the smaller ones is returned.
+ **/
+ImagePtr
+findCachedPreviewImage(const EffectInstancePtr& effect,
+                       double time,
+                       const RectD & rod,
+                       double par,
+                       unsigned int mipMapLevel)
+{
+    NodePtr node = effect->getNode();
+    U64 nodeHash = effect->getHash();
+    bool isFrameVaryingOrAnimated = effect->isFrameVaryingOrAnimated_Recursive();
+    ImagePtr bestAbove, bestBelow;
+
+    // Images may have been cached in draft mode and/or rendered at full scale then downscaled,
+    // these are all different keys in the cache
+    for (int draft = 0; draft < 2; ++draft) {
+        for (int fullScaleWithDownscale = 0; fullScaleWithDownscale < 2; ++fullScaleWithDownscale) {
+            ImageKey key(node.get(),
+                         nodeHash,
+                         isFrameVaryingOrAnimated,
+                         time,
+                         ViewIdx(0),
+                         par,
+                         draft == 1,
+                         fullScaleWithDownscale == 1);
+            std::list<ImagePtr> cachedImages;
+            if ( !appPTR->getImage(key, &cachedImages) ) {
+                continue;
+            }
+            for (std::list<ImagePtr>::iterator it = cachedImages.begin(); it != cachedImages.end(); ++it) {
+                const ImagePtr& img = *it;
+                if ( !img || ( img->getStorageMode() == eStorageModeGLTex ) || !img->getComponents().isColorPlane() ) {
+                    continue;
+                }
+                unsigned int level = img->getMipMapLevel();
+                RectI imgRoD;
+                rod.toPixelEnclosing(level, par, &imgRoD);
+                if ( !img->getBounds().contains(imgRoD) ) {
+                    continue;
+                }
+                std::list<RectI> restToRender;
+                img->getRestToRender(imgRoD, restToRender);
+                if ( !restToRender.empty() ) {
+                    continue;
+                }
+                if (level <= mipMapLevel) {
+                    if ( !bestBelow || (level > bestBelow->getMipMapLevel()) ) {
+                        bestBelow = img;
+                    }
+                } else {
+                    if ( !bestAbove || (level < bestAbove->getMipMapLevel()) ) {
+                        bestAbove = img;
+                    }
+                }
+            }
+        }
+    }
+
+    return bestBelow ? bestBelow : bestAbove;
+} // findCachedPreviewImage
+
 NATRON_NAMESPACE_ANONYMOUS_EXIT
 
 
@@ -6532,14 +6628,51 @@ public:
     }
 };
 
+/**
+ * @brief Cleans up the TLS the preview created in the calling thread, on every exit path
+ **/
+class PreviewTLSCleaner_RAII
+{
+public:
+    PreviewTLSCleaner_RAII()
+    {
+    }
+
+    ~PreviewTLSCleaner_RAII()
+    {
+        appPTR->getAppTLS()->cleanupTLSForThread();
+    }
+};
+
 bool
 Node::makePreviewImage(SequenceTime time,
                        int *width,
                        int *height,
                        unsigned int* buf)
+{
+    return makePreviewImageInternal(time, width, height, buf, true);
+}
+
+bool
+Node::makePreviewImageFromCache(SequenceTime time,
+                                int *width,
+                                int *height,
+                                unsigned int* buf)
+{
+    return makePreviewImageInternal(time, width, height, buf, false);
+}
+
+bool
+Node::makePreviewImageInternal(SequenceTime time,
+                               int *width,
+                               int *height,
+                               unsigned int* buf,
+                               bool allowRender)
 {
     assert(_imp->knobsInitialized);
 
+    ///Exit of the thread
+    PreviewTLSCleaner_RAII tlsCleaner;
 
     {
         QMutexLocker k(&_imp->isBeingDestroyedMutex);
@@ -6588,6 +6721,22 @@ Node::makePreviewImage(SequenceTime time,
     scale.y = scale.x;
 
     const double par = effect->getAspectRatio(-1);
+
+    ///we convert only when input is Linear.
+    //Rec709 and srGB is acceptable for preview
+    {
+        ImagePtr cachedImage = findCachedPreviewImage(effect, time, rod, par, mipMapLevel);
+        if (cachedImage) {
+            bool convertToSrgb = getApp()->getDefaultColorSpaceForBitDepth( cachedImage->getBitDepth() ) == eViewerColorSpaceLinear;
+            drawPreviewImage(*cachedImage, convertToSrgb, width, height, buf);
+
+            return true;
+        }
+    }
+    if (!allowRender) {
+        return false;
+    }
+
     RectI renderWindow;
     rod.toPixelEnclosing(mipMapLevel, par, &renderWindow);
 
@@ -6666,38 +6815,12 @@ Node::makePreviewImage(SequenceTime time,
         }
 
         const ImagePtr& img = planes.begin()->second;
-        const ImageComponents& components = img->getComponents();
-        int elemCount = components.getNumComponents();
-
-        ///we convert only when input is Linear.
-        //Rec709 and srGB is acceptable for preview
         bool convertToSrgb = getApp()->getDefaultColorSpaceForBitDepth( img->getBitDepth() ) == eViewerColorSpaceLinear;
-
-        switch ( img->getBitDepth() ) {
-        case eImageBitDepthByte: {
-            renderPreviewForDepth<unsigned char, 255>(*img, elemCount, width, height, convertToSrgb, buf);
-            break;
-        }
-        case eImageBitDepthShort: {
-            renderPreviewForDepth<unsigned short, 65535>(*img, elemCount, width, height, convertToSrgb, buf);
-            break;
-        }
-        case eImageBitDepthHalf:
-            break;
-        case eImageBitDepthFloat: {
-            renderPreviewForDepth<float, 1>(*img, elemCount, width, height, convertToSrgb, buf);
-            break;
-        }
-        case eImageBitDepthNone:
-            break;
-        }
+        drawPreviewImage(*img, convertToSrgb, width, height, buf);
     } // ParallelRenderArgsSetter
 
-    ///Exit of the thread
-    appPTR->getAppTLS()->cleanupTLSForThread();
-
     return true;
-} // makePreviewImage
+} // makePreviewImageInternal
 
 bool
 Node::isInputNode() const
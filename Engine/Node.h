@@ -750,6 +750,8 @@ private:
 
     void doDestroyNodeInternalEnd(bool fromDest, bool autoReconnect);
 
+    bool makePreviewImageInternal(SequenceTime time, int *width, int *height, unsigned int* buf, bool allowRender);
+
 public:
 
 
@@ -781,9 +783,19 @@ public:
      *
      * The width and height might be modified by the function, so their value can
      * be queried at the end of the function
+     *
+     * If an image of this node is already in the cache at any mipmap level, it is
+     * downsampled into the preview instead of rendering again.
      **/
     bool makePreviewImage(SequenceTime time, int *width, int *height, unsigned int* buf);
 
+    /**
+     * @brief Same as makePreviewImage but never renders: this only succeeds if an image
+     * of this node covering its region of definition is already in the cache.
+     * This is cheap and may be called while the viewer is rendering.
+     **/
+    bool makePreviewImageFromCache(SequenceTime time, int *width, int *height, unsigned int* buf);
+
     /**
      * @brief Returns true if the node is currently rendering a preview image.
      **/
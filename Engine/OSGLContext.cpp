@@ -44,6 +44,7 @@
 #include "Engine/AppManager.h"
 #include "Engine/AbortableRenderInfo.h"
 #include "Engine/GPUContextPool.h"
+#include "Engine/Timer.h"
 
 #include "Global/GLIncludes.h"
 
@@ -534,7 +535,7 @@ OSGLContext::setContextCurrentNoRender(int width, int height, int rowWidth, void
     }
 }
 
-void
+double
 OSGLContext::setContextCurrent_GPU(const AbortableRenderInfoPtr& abortInfo
 #ifdef DEBUG
                                ,
@@ -542,14 +543,14 @@ OSGLContext::setContextCurrent_GPU(const AbortableRenderInfoPtr& abortInfo
 #endif
                                )
 {
-    setContextCurrentInternal(abortInfo,
+    return setContextCurrentInternal(abortInfo,
 #ifdef DEBUG
                               frameTime,
 #endif
                               0, 0, 0, 0);
 }
 
-void
+double
 OSGLContext::setContextCurrent_CPU(const AbortableRenderInfoPtr& abortInfo
 #ifdef DEBUG
                                    , double frameTime
@@ -559,14 +560,14 @@ OSGLContext::setContextCurrent_CPU(const AbortableRenderInfoPtr& abortInfo
                                    , int rowWidth
                                    , void* buffer)
 {
-    setContextCurrentInternal(abortInfo,
+    return setContextCurrentInternal(abortInfo,
 #ifdef DEBUG
                               frameTime,
 #endif
                               width, height, rowWidth, buffer);
 }
 
-void
+double
 OSGLContext::setContextCurrentInternal(const AbortableRenderInfoPtr& abortInfo
 #ifdef DEBUG
                                        , double frameTime
@@ -582,9 +583,14 @@ OSGLContext::setContextCurrentInternal(const AbortableRenderInfoPtr& abortInfo
 #endif
                     ));
 
+    double timeSpentWaiting = 0.;
     QMutexLocker k(&_imp->renderOwningContextMutex);
-    while (_imp->renderOwningContext && _imp->renderOwningContext != abortInfo) {
-        _imp->renderOwningContextCond.wait(&_imp->renderOwningContextMutex);
+    if (_imp->renderOwningContext && _imp->renderOwningContext != abortInfo) {
+        TimeLapse waitTime;
+        while (_imp->renderOwningContext && _imp->renderOwningContext != abortInfo) {
+            _imp->renderOwningContextCond.wait(&_imp->renderOwningContextMutex);
+        }
+        timeSpentWaiting = waitTime.getTimeSinceCreation();
     }
     _imp->renderOwningContext = abortInfo;
 #ifdef DEBUG
@@ -597,6 +603,7 @@ OSGLContext::setContextCurrentInternal(const AbortableRenderInfoPtr& abortInfo
 
     setContextCurrentNoRender(width, height, rowWidth, buffer);
 
+    return timeSpentWaiting;
 }
 
 void
@@ -137,15 +137,16 @@ private:
      *  context at a time.
      *
      *  @thread_safety This function may be called from any thread.
+     *  @returns The time in seconds spent waiting for another render to release the context
      */
-    void setContextCurrent_GPU(const AbortableRenderInfoPtr& render
+    double setContextCurrent_GPU(const AbortableRenderInfoPtr& render
 #ifdef DEBUG
                            , double frameTime
 #endif
                            );
 
 
-    void setContextCurrent_CPU(const AbortableRenderInfoPtr& render
+    double setContextCurrent_CPU(const AbortableRenderInfoPtr& render
 #ifdef DEBUG
                                , double frameTime
 #endif
@@ -154,7 +155,7 @@ private:
                                , int rowWidth
                                , void* buffer);
 
-    void setContextCurrentInternal(const AbortableRenderInfoPtr& render
+    double setContextCurrentInternal(const AbortableRenderInfoPtr& render
 #ifdef DEBUG
                                    , double frameTime
 #endif
@@ -188,6 +189,7 @@ class OSGLContextAttacher
     bool _attached;
     int _width, _height, _rowWidth;
     void* _buffer;
+    double _timeSpentWaiting;
 
 public:
 
@@ -210,6 +212,7 @@ public:
     , _width(0)
     , _height(0)
     , _buffer(0)
+    , _timeSpentWaiting(0.)
     {
         assert(c);
     }
@@ -235,6 +238,7 @@ public:
     , _height(height)
     , _rowWidth(rowWidth)
     , _buffer(buffer)
+    , _timeSpentWaiting(0.)
     {
         assert(c);
     }
@@ -244,11 +248,19 @@ public:
         return _c;
     }
 
+    /**
+     * @brief Returns the time in seconds spent in attach() waiting for other renders to release the context
+     **/
+    double getTimeSpentWaiting() const
+    {
+        return _timeSpentWaiting;
+    }
+
     void attach()
     {
         if (!_attached) {
             if (!_c->isGPUContext()) {
-                _c->setContextCurrent_CPU(_a.lock()
+                _timeSpentWaiting += _c->setContextCurrent_CPU(_a.lock()
 #ifdef DEBUG
                                           , _frameTime
 #endif
@@ -257,7 +269,7 @@ public:
                                           , _rowWidth
                                           , _buffer);
             } else {
-                _c->setContextCurrent_GPU(_a.lock()
+                _timeSpentWaiting += _c->setContextCurrent_GPU(_a.lock()
 #ifdef DEBUG
                                           , _frameTime
 #endif
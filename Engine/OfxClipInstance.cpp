@@ -45,6 +45,9 @@
 #include "Engine/AppInstance.h"
 #include "Engine/AppManager.h"
 #include "Engine/Node.h"
+#include "Engine/ParallelRenderArgs.h"
+#include "Engine/Plugin.h"
+#include "Engine/RenderStats.h"
 #include "Engine/ViewerInstance.h"
 #include "Engine/RotoContext.h"
 #include "Engine/Transform.h"
@@ -963,11 +966,11 @@ OfxClipInstance::getInputImageInternal(const OfxTime time,
     double par = getAspectRatio();
     OfxImageCommon* retCommon = 0;
     if (retImage) {
-        OfxImage* ofxImage = new OfxImage(renderData, image, true, renderWindow, transform, components, nComps, par);
+        OfxImage* ofxImage = new OfxImage(renderData, effect, image, true, renderWindow, transform, components, nComps, par);
         *retImage = ofxImage;
         retCommon = ofxImage;
     } else if (retTexture) {
-        OfxTexture* ofxTex = new OfxTexture(renderData, image, true, renderWindow, transform, components, nComps, par);
+        OfxTexture* ofxTex = new OfxTexture(renderData, effect, image, true, renderWindow, transform, components, nComps, par);
         *retTexture = ofxTex;
         retCommon = ofxTex;
     }
@@ -1111,11 +1114,11 @@ OfxClipInstance::getOutputImageInternal(const std::string* ofxPlane,
     double par = getAspectRatio();
     OfxImageCommon* retCommon = 0;
     if (retImage) {
-        OfxImage* ret =  new OfxImage(renderData, outputImage, false, renderWindow, boost::shared_ptr<Transform::Matrix3x3>(), ofxComponents, nComps, par);
+        OfxImage* ret =  new OfxImage(renderData, effect, outputImage, false, renderWindow, boost::shared_ptr<Transform::Matrix3x3>(), ofxComponents, nComps, par);
         *retImage = ret;
         retCommon = ret;
     } else if (retTexture) {
-        OfxTexture* ret =  new OfxTexture(renderData, outputImage, false, renderWindow, boost::shared_ptr<Transform::Matrix3x3>(), ofxComponents, nComps, par);
+        OfxTexture* ret =  new OfxTexture(renderData, effect, outputImage, false, renderWindow, boost::shared_ptr<Transform::Matrix3x3>(), ofxComponents, nComps, par);
         *retTexture = ret;
         retCommon = ret;
     }
@@ -1434,6 +1437,7 @@ OfxImageCommon::getComponentsString() const
 
 OfxImageCommon::OfxImageCommon(OFX::Host::ImageEffect::ImageBase* ofxImageBase,
                                const boost::shared_ptr<OfxClipInstance::RenderActionData>& renderData,
+                               const EffectInstancePtr& effect,
                                const boost::shared_ptr<NATRON_NAMESPACE::Image>& internalImage,
                                bool isSrcImage,
                                const RectI& renderWindow,
@@ -1464,19 +1468,28 @@ OfxImageCommon::OfxImageCommon(OFX::Host::ImageEffect::ImageBase* ofxImageBase,
     // Note that when the ReadAccess, or WriteAccess object is released, the image may be resized afterwards (only bigger)
     RectI bounds;
     RectI pluginsSeenBounds;
+    int dataSizeOf = getSizeOfForBitDepth( internalImage->getBitDepth() );
+    // The number of bytes between 2 rows of the buffer given to the plug-in
+    std::size_t rowBytes = 0;
 
     if (isSrcImage) {
         // Some plug-ins need a local version of the input image because they modify it (e.g: ReMap). This is out of spec
         // and if it does so, it may modify the cached output of the node from which this input image comes from.
         // To circumvent this, we copy the source image into a local temporary buffer only used by the plug-in which is released
-        // when this OfxImage is destroyed. By default this local copy is deactivated, to activate it, the user has to go
-        // in the preferences and check "Use input image copy for plug-ins rendering"
-        const bool copySrcToPluginLocalData = appPTR->isCopyInputImageForPluginRenderEnabled();
+        // when this OfxImage is destroyed. By default the image is shared with the cache, to copy it the user has to either
+        // check "Copy inputs" for this plug-in in the preferences, or check "Copy input image before rendering any plug-in"
+        // which applies to all plug-ins.
+        bool copySrcToPluginLocalData = appPTR->isCopyInputImageForPluginRenderEnabled();
+        if (!copySrcToPluginLocalData && effect) {
+            const Plugin* plugin = effect->getNode()->getPlugin();
+            copySrcToPluginLocalData = plugin && plugin->isInputImagesCopyEnabled();
+        }
         boost::shared_ptr<NATRON_NAMESPACE::Image::ReadAccess> access( new NATRON_NAMESPACE::Image::ReadAccess( internalImage.get() ) );
 
         // data ptr
         bounds = internalImage->getBounds();
         renderWindow.intersect(bounds, &pluginsSeenBounds);
+        rowBytes = bounds.width() * nComps * dataSizeOf;
 
         if (storage == eStorageModeGLTex) {
             _imp->access = access;
@@ -1484,21 +1497,33 @@ OfxImageCommon::OfxImageCommon(OFX::Host::ImageEffect::ImageBase* ofxImageBase,
             const unsigned char* ptr = access->pixelAt( pluginsSeenBounds.left(), pluginsSeenBounds.bottom() );
             assert(ptr);
 
+            // The plug-in may only access the render window, so that is all we need to copy
+            std::size_t seenRowBytes = pluginsSeenBounds.width() * nComps * dataSizeOf;
+            U64 seenBytes = (U64)seenRowBytes * pluginsSeenBounds.height();
+
             if (!copySrcToPluginLocalData) {
                 ofxImageBase->setPointerProperty( kOfxImagePropData, const_cast<unsigned char*>(ptr) );
                 _imp->access = access;
             } else {
-                int dataSizeOf = getSizeOfForBitDepth( internalImage->getBitDepth() );
-                std::size_t bufferSize = bounds.area() * dataSizeOf * nComps;
                 _imp->localBuffer.reset( new RamBuffer<unsigned char>() );
-                _imp->localBuffer->resize(bufferSize);
+                _imp->localBuffer->resize(seenBytes);
                 unsigned char* localBufferData = _imp->localBuffer->getData();
-                assert(localBufferData);
+                assert(localBufferData || seenBytes == 0);
                 if (localBufferData) {
-                    memcpy(localBufferData, ptr, bufferSize);
+                    for (int y = 0; y < pluginsSeenBounds.height(); ++y) {
+                        memcpy(localBufferData + y * seenRowBytes, ptr + y * rowBytes, seenRowBytes);
+                    }
                 }
-                unsigned char* bufferStart = NATRON_NAMESPACE::Image::pixelAtStatic(pluginsSeenBounds.left(), pluginsSeenBounds.bottom(), bounds, nComps, dataSizeOf, localBufferData);
-                ofxImageBase->setPointerProperty( kOfxImagePropData, bufferStart );
+                rowBytes = seenRowBytes;
+                ofxImageBase->setPointerProperty( kOfxImagePropData, localBufferData );
+            }
+
+            ParallelRenderArgsPtr frameArgs;
+            if (effect) {
+                frameArgs = effect->getParallelRenderArgsTLS();
+            }
+            if ( frameArgs && frameArgs->stats && frameArgs->stats->isInDepthProfilingEnabled() ) {
+                frameArgs->stats->addInputImageCopyInfosForNode(effect->getNode(), copySrcToPluginLocalData, seenBytes);
             }
         }
     } else {
@@ -1507,6 +1532,7 @@ OfxImageCommon::OfxImageCommon(OFX::Host::ImageEffect::ImageBase* ofxImageBase,
 
         // data ptr
         renderWindow.intersect(bounds, &pluginsSeenBounds);
+        rowBytes = bounds.width() * nComps * dataSizeOf;
 
         if (storage != eStorageModeGLTex) {
             unsigned char* ptr = access->pixelAt( pluginsSeenBounds.left(), pluginsSeenBounds.bottom() );
@@ -1543,8 +1569,7 @@ OfxImageCommon::OfxImageCommon(OFX::Host::ImageEffect::ImageBase* ofxImageBase,
             pluginsSeenBounds.bottom() >= pixelRod.bottom() && pluginsSeenBounds.top() <= pixelRod.top() );
 
     // row bytes
-    ofxImageBase->setIntProperty( kOfxImagePropRowBytes, bounds.width() * nComps *
-                                  getSizeOfForBitDepth( internalImage->getBitDepth() ) );
+    ofxImageBase->setIntProperty( kOfxImagePropRowBytes, (int)rowBytes );
     ofxImageBase->setStringProperty( kOfxImageEffectPropComponents, components);
     ofxImageBase->setStringProperty( kOfxImageEffectPropPixelDepth, OfxClipInstance::natronsDepthToOfxDepth( internalImage->getBitDepth() ) );
     ofxImageBase->setStringProperty( kOfxImageEffectPropPreMultiplication, OfxClipInstance::natronsPremultToOfxPremult( internalImage->getPremultiplication() ) );
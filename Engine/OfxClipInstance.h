@@ -329,6 +329,7 @@ class OfxImageCommon
 public:
     explicit OfxImageCommon(OFX::Host::ImageEffect::ImageBase* ofxImageBase,
                             const boost::shared_ptr<OfxClipInstance::RenderActionData>& renderData,
+                            const EffectInstancePtr& effect,
                             const boost::shared_ptr<NATRON_NAMESPACE::Image>& internalImage,
                             bool isSrcImage,
                             const RectI& renderWindow,
@@ -353,6 +354,7 @@ class OfxImage
 {
 public:
     explicit OfxImage( const boost::shared_ptr<OfxClipInstance::RenderActionData>& renderData,
+                       const EffectInstancePtr& effect,
                        const boost::shared_ptr<NATRON_NAMESPACE::Image>& internalImage,
                        bool isSrcImage,
                        const RectI& renderWindow,
@@ -361,7 +363,7 @@ public:
                        int nComps,
                       double par)
         : OFX::Host::ImageEffect::Image()
-        , OfxImageCommon(this, renderData, internalImage, isSrcImage, renderWindow, mat, components, nComps, par)
+        , OfxImageCommon(this, renderData, effect, internalImage, isSrcImage, renderWindow, mat, components, nComps, par)
     {
     }
 };
@@ -372,6 +374,7 @@ class OfxTexture
 {
 public:
     explicit OfxTexture( const boost::shared_ptr<OfxClipInstance::RenderActionData>& renderData,
+                         const EffectInstancePtr& effect,
                          const boost::shared_ptr<NATRON_NAMESPACE::Image>& internalImage,
                          bool isSrcImage,
                          const RectI& renderWindow,
@@ -380,7 +383,7 @@ public:
                          int nComps,
                         double par)
         : OFX::Host::ImageEffect::Texture()
-        , OfxImageCommon(this, renderData, internalImage, isSrcImage, renderWindow, mat, components, nComps, par)
+        , OfxImageCommon(this, renderData, effect, internalImage, isSrcImage, renderWindow, mat, components, nComps, par)
     {
     }
 };
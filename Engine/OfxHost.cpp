@@ -50,12 +50,6 @@ CLANG_DIAG_ON(uninitialized)
 #ifdef OFX_SUPPORTS_MULTITHREAD
 #include <QtCore/QThread>
 #include <QtCore/QThreadStorage>
-#include <QtConcurrentMap> // QtCore on Qt4, QtConcurrent on Qt5
-
-GCC_DIAG_UNUSED_LOCAL_TYPEDEFS_OFF
-// /usr/local/include/boost/bind/arg.hpp:37:9: warning: unused typedef 'boost_static_assert_typedef_37' [-Wunused-local-typedef]
-#include <boost/bind.hpp>
-GCC_DIAG_UNUSED_LOCAL_TYPEDEFS_ON
 #endif // OFX_SUPPORTS_MULTITHREAD
 
 //ofx
@@ -98,6 +92,7 @@ CLANG_DIAG_ON(unknown-pragmas)
 #include "Engine/NodeSerialization.h"
 #include "Engine/KnobTypes.h"
 #include "Engine/LibraryBinary.h"
+#include "Engine/MultiThreadExecutor.h"
 #include "Engine/Node.h"
 #include "Engine/FStreamsSupport.h"
 #include "Engine/OfxEffectInstance.h"
@@ -152,6 +147,9 @@ struct OfxHostPrivate
     boost::shared_ptr<OFX::Host::ImageEffect::PluginCache> imageEffectPluginCache;
     boost::shared_ptr<TLSHolder<OfxHost::OfxHostTLSData> > tlsData;
 
+    // Runs the multiThread calls when the thread-pool is used
+    boost::scoped_ptr<MultiThreadExecutor> multiThreadExecutor;
+
 #ifdef MULTI_THREAD_SUITE_USES_THREAD_SAFE_MUTEX_ALLOCATION
     std::list<QMutex*> pluginsMutexes;
     QMutex* pluginsMutexesLock; //<protects _pluginsMutexes
@@ -163,6 +161,7 @@ struct OfxHostPrivate
     OfxHostPrivate()
         : imageEffectPluginCache()
         , tlsData( new TLSHolder<OfxHost::OfxHostTLSData>() )
+        , multiThreadExecutor( new MultiThreadExecutor() )
 #ifdef MULTI_THREAD_SUITE_USES_THREAD_SAFE_MUTEX_ALLOCATION
         , pluginsMutexes()
         , pluginsMutexesLock(0)
@@ -1157,45 +1156,82 @@ OfxHost::setThreadAsActionCaller(OfxImageEffectInstance* instance,
 
 NATRON_NAMESPACE_ANONYMOUS_ENTER
 
-///Using QtConcurrent doesn't work with The Foundry Furnace plug-ins because they expect fresh threads
-///to be created. As QtConcurrent's thread-pool recycles thread, it seems to make Furnace crash.
+///Using a thread-pool doesn't work with The Foundry Furnace plug-ins because they expect fresh threads
+///to be created. As the MultiThreadExecutor recycles threads, it seems to make Furnace crash.
 ///We think this is because Furnace must keep an internal thread-local state that becomes then dirty
-///if we re-use the same thread.
-
-static OfxStatus
-threadFunctionWrapper(OfxThreadFunctionV1 func,
-                      unsigned int threadIndex,
-                      unsigned int threadMax,
-                      QThread* spawnerThread,
-                      void *customArg)
+///if we re-use the same thread. That is why OfxThread is still used when the thread-pool is disabled in the preferences.
+
+/**
+ * @brief A call to the multiThread function run by the MultiThreadExecutor
+ **/
+class OfxMultiThreadJob
+    : public MultiThreadJob
 {
-    assert(threadIndex < threadMax);
-    OfxHost::OfxHostDataTLSPtr tls = appPTR->getOFXHost()->getTLSData();
-    tls->threadIndexes.push_back( (int)threadIndex );
+    OfxThreadFunctionV1* _func;
+    void* _customArg;
+    QMutex _statusMutex;
+    OfxStatus _status;
 
-    QThread* spawnedThread = QThread::currentThread();
-    if (spawnedThread != spawnerThread) {
-        appPTR->getAppTLS()->softCopy(spawnerThread, spawnedThread);
+public:
+
+    OfxMultiThreadJob(OfxThreadFunctionV1 func,
+                      void* customArg)
+        : MultiThreadJob()
+        , _func(func)
+        , _customArg(customArg)
+        , _statusMutex()
+        , _status(kOfxStatOK)
+    {
     }
 
-    OfxStatus ret = kOfxStatOK;
-    try {
-        func(threadIndex, threadMax, customArg);
-    } catch (const std::bad_alloc & ba) {
-        ret =  kOfxStatErrMemory;
-    } catch (...) {
-        ret =  kOfxStatFailed;
+    OfxStatus getStatus()
+    {
+        QMutexLocker k(&_statusMutex);
+
+        return _status;
     }
 
-    ///reset back the index otherwise it could mess up the indexes if the same thread is re-used
-    tls->threadIndexes.pop_back();
+    virtual void runIndex(unsigned int threadIndex,
+                          unsigned int threadMax) OVERRIDE FINAL
+    {
+        assert(threadIndex < threadMax);
+        OfxHost::OfxHostDataTLSPtr tls = appPTR->getOFXHost()->getTLSData();
+        tls->threadIndexes.push_back( (int)threadIndex );
 
-    if (spawnedThread != spawnerThread) {
-        appPTR->getAppTLS()->cleanupTLSForThread();
+        OfxStatus stat = kOfxStatOK;
+        try {
+            _func(threadIndex, threadMax, _customArg);
+        } catch (const std::bad_alloc & ba) {
+            stat =  kOfxStatErrMemory;
+        } catch (...) {
+            stat =  kOfxStatFailed;
+        }
+
+        ///reset back the index otherwise it could mess up the indexes if the same thread is re-used
+        tls->threadIndexes.pop_back();
+
+        if (stat != kOfxStatOK) {
+            QMutexLocker k(&_statusMutex);
+            if (_status == kOfxStatOK) {
+                _status = stat;
+            }
+        }
     }
 
-    return ret;
-}
+    virtual void onHelperEnter(QThread* spawnerThread) OVERRIDE FINAL
+    {
+        appPTR->getAppTLS()->softCopy( spawnerThread, QThread::currentThread() );
+
+        ///The worker counts as a running thread in multiThreadNumCPUS while it helps
+        appPTR->fetchAndAddNRunningThreads(1);
+    }
+
+    virtual void onHelperLeave() OVERRIDE FINAL
+    {
+        appPTR->fetchAndAddNRunningThreads(-1);
+        appPTR->getAppTLS()->cleanupTLSForThread();
+    }
+};
 
 class OfxThread
     : public QThread
@@ -1294,29 +1330,20 @@ OfxHost::multiThread(OfxThreadFunctionV1 func,
         }
     }
 
-    QThread* spawnerThread = QThread::currentThread();
     bool useThreadPool = appPTR->getUseThreadPool();
 
     if (useThreadPool) {
-        std::vector<unsigned int> threadIndexes(nThreads);
-        for (unsigned int i = 0; i < nThreads; ++i) {
-            threadIndexes[i] = i;
-        }
-
-        /// DON'T set the maximum thread count, this is a global application setting, and see the documentation excerpt above
-        //QThreadPool::globalInstance()->setMaxThreadCount(nThreads);
-        QFuture<OfxStatus> future = QtConcurrent::mapped( threadIndexes, boost::bind(threadFunctionWrapper, func, _1, nThreads, spawnerThread, customArg) );
-        future.waitForFinished();
-        ///DON'T reset back to the original value the maximum thread count
-        //QThreadPool::globalInstance()->setMaxThreadCount(QThread::idealThreadCount());
-
-        for (QFuture<OfxStatus>::const_iterator it = future.begin(); it != future.end(); ++it) {
-            OfxStatus stat = *it;
-            if (stat != kOfxStatOK) {
-                return stat;
-            }
+        // The calling thread runs indices too instead of waiting, and idle workers of the executor help it.
+        // Since the executor never starts more workers than the number of cores, nested calls do not oversubscribe.
+        OfxMultiThreadJob job(func, customArg);
+        _imp->multiThreadExecutor->run(job, nThreads, maxConcurrentThread);
+
+        OfxStatus stat = job.getStatus();
+        if (stat != kOfxStatOK) {
+            return stat;
         }
     } else {
+        QThread* spawnerThread = QThread::currentThread();
         QVector<OfxStatus> status(nThreads); // vector for the return status of each thread
         status.fill(kOfxStatFailed); // by default, a thread fails
         {
@@ -1415,8 +1442,8 @@ OfxHost::multiThreadNumCPUS(unsigned int *nCPUs) const
                 nThreadsPerEffect = NATRON_MULTI_THREAD_SUITE_MAX_NUM_CPU;
                }*/
         }
-        ///+1 because the current thread is going to wait during the multiThread call so we're better off
-        ///not counting it.
+        ///+1 because the current thread is going to wait (or run one of the indices itself when
+        ///the thread-pool is used) during the multiThread call so we're better off not counting it.
         *nCPUs = std::max( 1, std::min(maxThreadsCount - activeThreadsCount + 1, nThreadsPerEffect) );
     }
 
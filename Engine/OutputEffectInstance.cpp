@@ -448,6 +448,10 @@ OutputEffectInstance::reportStats(int time,
     for (std::map<NodePtr, NodeRenderStats >::const_iterator it = stats.begin(); it != stats.end(); ++it) {
         ofile << "------------------------------- " << it->first->getScriptName_mt_safe() << "------------------------------- " << std::endl;
         ofile << "Time spent rendering: " << Timer::printAsTime(it->second.getTotalTimeSpentRendering(), false).toStdString() << std::endl;
+        double glContextWaitTime = it->second.getTotalTimeSpentWaitingForOpenGLContext();
+        if (glContextWaitTime > 0) {
+            ofile << "Time spent waiting for an OpenGL context: " << Timer::printAsTime(glContextWaitTime, false).toStdString() << std::endl;
+        }
         const RectD & rod = it->second.getRoD();
         ofile << "Region of definition: x1 = " << rod.x1  << " y1 = " << rod.y1 << " x2 = " << rod.x2 << " y2 = " << rod.y2 << std::endl;
         ofile << "Is Identity to Effect? ";
@@ -512,6 +516,15 @@ OutputEffectInstance::reportStats(int time,
         ofile << "Nb cache hit: " << nbCacheMiss << std::endl;
         ofile << "Nb cache miss: " << nbCacheMiss << std::endl;
         ofile << "Nb cache hit requiring mipmap downscaling: " << nbCacheHitButDownscaled << std::endl;
+        int nbInputImagesCopied, nbInputImagesShared;
+        U64 inputImagesCopiedBytes, inputImagesSharedBytes;
+        it->second.getInputImageCopyInfos(&nbInputImagesCopied, &inputImagesCopiedBytes, &nbInputImagesShared, &inputImagesSharedBytes);
+        ofile << "Nb input images copied: " << nbInputImagesCopied << " (" << inputImagesCopiedBytes << " bytes)" << std::endl;
+        ofile << "Nb input images shared without copy: " << nbInputImagesShared << " (" << inputImagesSharedBytes << " bytes)" << std::endl;
+        int nbConversionHits, nbConversionMisses;
+        it->second.getFormatConversionInfos(&nbConversionHits, &nbConversionMisses);
+        ofile << "Nb format conversions found in cache: " << nbConversionHits << std::endl;
+        ofile << "Nb format conversions computed: " << nbConversionMisses << std::endl;
 
         const std::set<std::string> & planes = it->second.getPlanesRendered();
         ofile << "Plane(s) rendered: ";
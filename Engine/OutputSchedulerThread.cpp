@@ -54,8 +54,10 @@
 #include "Engine/KnobFile.h"
 #include "Engine/Node.h"
 #include "Engine/OpenGLViewerI.h"
+#include "Engine/PlaybackController.h"
 #include "Engine/GenericSchedulerThreadWatcher.h"
 #include "Engine/Project.h"
+#include "Engine/RenderBenchmark.h"
 #include "Engine/RenderStats.h"
 #include "Engine/RotoContext.h"
 #include "Engine/Settings.h"
@@ -63,6 +65,7 @@
 #include "Engine/TimeLine.h"
 #include "Engine/TLSHolder.h"
 #include "Engine/RotoPaint.h"
+#include "Engine/TaskExecutor.h"
 #include "Engine/UpdateViewerParams.h"
 #include "Engine/ViewIdx.h"
 #include "Engine/ViewerInstance.h"
@@ -89,6 +92,9 @@
 
 #define NATRON_SCHEDULER_ABORT_AFTER_X_UNSUCCESSFUL_ITERATIONS 5000
 
+// The rendered frames waiting to be processed by the scheduler are limited to this many per hardware thread
+#define NATRON_SCHEDULER_MAX_BUFFERED_FRAMES_PER_THREAD 3
+
 NATRON_NAMESPACE_ENTER;
 
 
@@ -173,7 +179,7 @@ static bool
 isBufferFull(int nbBufferedElement,
              int hardwardIdealThreadCount)
 {
-    return nbBufferedElement >= hardwardIdealThreadCount * 3;
+    return nbBufferedElement >= hardwardIdealThreadCount * NATRON_SCHEDULER_MAX_BUFFERED_FRAMES_PER_THREAD;
 }
 
 #endif
@@ -226,6 +232,19 @@ struct OutputSchedulerThreadPrivate
     ///Protected by framesToRenderMutex
     int lastFramePushedIndex;
     int expectFrameToRender;
+
+#ifndef NATRON_PLAYBACK_USES_THREAD_POOL
+    ///Frames skipped to hold the playback frame rate: if they are being rendered, they are removed from the buffer when they arrive.
+    ///Protected by framesToRenderMutex
+    std::set<int> droppedFrames;
+#endif
+
+    ///Decides how many frames are rendered ahead, and for real-time playback which frames are dropped and at which resolution they are rendered
+    PlaybackController playback;
+    boost::scoped_ptr<TimeLapse> playbackClock; // Only accessed by the scheduler thread
+    int lastReportedNbDroppedFrames; // Only accessed by the scheduler thread
+    unsigned int lastReportedMipMapLevelOffset; // Only accessed by the scheduler thread
+
     boost::weak_ptr<OutputEffectInstance> outputEffect; //< The effect used as output device
     RenderEngine* engine;
 
@@ -269,6 +288,13 @@ struct OutputSchedulerThreadPrivate
         , framesToRenderMutex()
         , lastFramePushedIndex(0)
         , expectFrameToRender(0)
+#ifndef NATRON_PLAYBACK_USES_THREAD_POOL
+        , droppedFrames()
+#endif
+        , playback()
+        , playbackClock()
+        , lastReportedNbDroppedFrames(0)
+        , lastReportedMipMapLevelOffset(0)
         , outputEffect(effect)
         , engine(engine)
 #ifdef NATRON_SCHEDULER_SPAWN_THREADS_WITH_TIMER
@@ -381,6 +407,69 @@ struct OutputSchedulerThreadPrivate
         }
     }
 
+#ifndef NATRON_PLAYBACK_USES_THREAD_POOL
+    /**
+     * @brief Skips at most nbFramesToDrop frames of the playback sequence, starting at *frame, which becomes the next frame to process.
+     * Only frames already pushed to the render threads are skipped, so that the new frame to process is either already pushed or the
+     * next one to push. Returns the number of frames skipped.
+     **/
+    int dropFrames(int nbFramesToDrop,
+                   const boost::shared_ptr<OutputSchedulerThreadStartArgs>& args,
+                   int* frame)
+    {
+        if (args->firstFrame == args->lastFrame) {
+            return 0;
+        }
+        PlaybackModeEnum pMode = engine->getPlaybackMode();
+        int nbDroppedFrames = 0;
+        QMutexLocker k(&framesToRenderMutex);
+        while (nbDroppedFrames < nbFramesToDrop) {
+            int nextFrame;
+            RenderDirectionEnum newDirection = args->processTimelineDirection;
+            if ( !getNextFrameInSequence(pMode, args->processTimelineDirection, *frame, args->firstFrame, args->lastFrame,
+                                         args->frameStep, &nextFrame, &newDirection) ) {
+                break;
+            }
+            bool isLastPushed = *frame == lastFramePushedIndex;
+            std::list<int>::iterator found = std::find(framesToRender.begin(), framesToRender.end(), *frame);
+            if ( found != framesToRender.end() ) {
+                framesToRender.erase(found);
+            }
+            droppedFrames.insert(*frame);
+            args->processTimelineDirection = newDirection;
+            *frame = nextFrame;
+            ++nbDroppedFrames;
+            if (isLastPushed) {
+                break;
+            }
+        }
+        expectFrameToRender = *frame;
+
+        return nbDroppedFrames;
+    }
+
+    void removeDroppedFramesFromBuffer()
+    {
+        std::set<int> frames;
+        {
+            QMutexLocker k(&framesToRenderMutex);
+            if ( droppedFrames.empty() ) {
+                return;
+            }
+            frames = droppedFrames;
+        }
+        QMutexLocker l(&bufMutex);
+        for (FrameBuffer::iterator it = buf.begin(); it != buf.end(); ) {
+            if ( frames.find(it->first.time) != frames.end() ) {
+                buf.erase(it++);
+            } else {
+                ++it;
+            }
+        }
+    }
+
+#endif
+
     void appendRunnable(RenderThreadTask* runnable)
     {
         assert( !renderThreadsMutex.tryLock() );
@@ -707,9 +796,15 @@ OutputSchedulerThread::pushFramesToRenderInternal(int startingFrame,
 #endif
         _imp->lastFramePushedIndex = startingFrame;
     } else {
-        ///Push 2x the count of threads to be sure no one will be waiting
-        while ( (int)_imp->framesToRender.size() < nThreads * 2 ) {
+        ///Push 2x the count of threads to be sure no one will be waiting.
+        ///During playback, push enough frames to have them rendered by the time they are due.
+        int nbFramesAhead = nThreads * 2;
+        if ( isFPSRegulationNeeded() ) {
+            nbFramesAhead = _imp->playback.getRenderAheadCount(nThreads, appPTR->getHardwareIdealThreadCount() * NATRON_SCHEDULER_MAX_BUFFERED_FRAMES_PER_THREAD);
+        }
+        while ( (int)_imp->framesToRender.size() < nbFramesAhead ) {
             _imp->framesToRender.push_back(startingFrame);
+            _imp->droppedFrames.erase(startingFrame);
 #ifdef TRACE_SCHEDULER
             QString pushDirectionStr = newDirection == eRenderDirectionForward ? QLatin1String("Forward") : QLatin1String("Backward");
             qDebug() << "Scheduler Thread:  Pushing frame to render: " << startingFrame << ", new push direction is " << pushDirectionStr;
@@ -1031,6 +1126,19 @@ OutputSchedulerThread::startRender()
     // Start measuring
     _imp->renderTimer.reset(new TimeLapse);
 
+    // Frames may only be dropped when the frame rate is regulated, i.e during playback in the viewer
+    {
+        bool maintainRealTime = isFPSRegulationNeeded() && appPTR->getCurrentSettings()->isRealTimePlaybackEnabled();
+        _imp->playback.reset( getDesiredFPS(), maintainRealTime, appPTR->getCurrentSettings()->getAutoProxyMipMapLevel() );
+        _imp->playbackClock.reset(new TimeLapse);
+        _imp->lastReportedNbDroppedFrames = 0;
+        _imp->lastReportedMipMapLevelOffset = 0;
+#ifndef NATRON_PLAYBACK_USES_THREAD_POOL
+        QMutexLocker k(&_imp->framesToRenderMutex);
+        _imp->droppedFrames.clear();
+#endif
+    }
+
     ///We will push frame to renders starting at startingFrame.
     ///They will be in the range determined by firstFrame-lastFrame
     int startingFrame;
@@ -1271,6 +1379,9 @@ OutputSchedulerThread::threadLoopOnce(const ThreadStartArgsPtr &inArgs)
             } else {
                 nbIterationsWithoutProcessing = 0;
             }
+#ifndef NATRON_PLAYBACK_USES_THREAD_POOL
+            _imp->removeDroppedFramesFromBuffer();
+#endif
             boost::shared_ptr<OutputSchedulerThreadExecMTArgs> framesToRender( new OutputSchedulerThreadExecMTArgs() );
             {
                 QMutexLocker l(&_imp->bufMutex);
@@ -1289,6 +1400,7 @@ OutputSchedulerThread::threadLoopOnce(const ThreadStartArgsPtr &inArgs)
 
             int nextFrameToRender = -1;
             RenderDirectionEnum newDirection = eRenderDirectionForward;
+            int nbDroppedFrames = 0;
 
             if (!renderFinished) {
                 ///////////
@@ -1334,6 +1446,19 @@ OutputSchedulerThread::threadLoopOnce(const ThreadStartArgsPtr &inArgs)
                         _imp->expectFrameToRender = nextFrameToRender;
                     }
 
+#ifndef NATRON_PLAYBACK_USES_THREAD_POOL
+                    ///////////
+                    /////For real-time playback, skip the frames that should already have been displayed
+                    int nbFramesToDrop = _imp->playback.getNbFramesToDrop( _imp->playbackClock->getTimeSinceCreation() );
+                    if (nbFramesToDrop > 0) {
+                        nbDroppedFrames = _imp->dropFrames(nbFramesToDrop, args, &nextFrameToRender);
+                        newDirection = args->processTimelineDirection;
+#ifdef TRACE_SCHEDULER
+                        qDebug() << "Scheduler Thread: dropped " << nbDroppedFrames << " frames after " << expectedTimeToRender;
+#endif
+                    }
+#endif
+
 #ifndef NATRON_SCHEDULER_SPAWN_THREADS_WITH_TIMER
 
 #ifndef NATRON_PLAYBACK_USES_THREAD_POOL
@@ -1385,6 +1510,11 @@ OutputSchedulerThread::threadLoopOnce(const ThreadStartArgsPtr &inArgs)
                 requestExecutionOnMainThread(framesToRender);
             }
 
+            if ( isFPSRegulationNeeded() ) {
+                _imp->playback.notifyFrameDisplayed( _imp->playbackClock->getTimeSinceCreation(), nbDroppedFrames, getNRenderThreads() );
+                reportDroppedFrames();
+            }
+
             expectedTimeToRenderPreviousIteration = expectedTimeToRender;
 
 #ifdef TRACE_SCHEDULER
@@ -1448,6 +1578,20 @@ OutputSchedulerThread::threadLoopOnce(const ThreadStartArgsPtr &inArgs)
     return state;
 } // OutputSchedulerThread::threadLoopOnce
 
+void
+OutputSchedulerThread::reportDroppedFrames()
+{
+    int nbDroppedFrames = _imp->playback.getNbDroppedFrames();
+    unsigned int mipMapLevelOffset = _imp->playback.getMipMapLevelOffset();
+
+    if ( (nbDroppedFrames == _imp->lastReportedNbDroppedFrames) && (mipMapLevelOffset == _imp->lastReportedMipMapLevelOffset) ) {
+        return;
+    }
+    _imp->lastReportedNbDroppedFrames = nbDroppedFrames;
+    _imp->lastReportedMipMapLevelOffset = mipMapLevelOffset;
+    _imp->engine->s_droppedFramesChanged(nbDroppedFrames, (int)mipMapLevelOffset);
+}
+
 void
 OutputSchedulerThread::onAbortRequested(bool /*keepOldestRender*/)
 {
@@ -1552,12 +1696,15 @@ OutputSchedulerThread::notifyFrameRendered(int frame,
 
     bool isLastView = viewIndex == viewsToRender[viewsToRender.size() - 1] || viewIndex == -1;
 
-    // Report render stats if desired
+    // Report render stats if desired. When benchmarking, they are collected for the benchmark report instead.
     OutputEffectInstancePtr effect = _imp->outputEffect.lock();
     if (stats) {
         double timeSpentForFrame;
         std::map<NodePtr, NodeRenderStats > statResults = stats->getStats(&timeSpentForFrame);
-        if ( !statResults.empty() ) {
+        RenderBenchmarkPtr benchmark = effect->getApp()->getRenderBenchmark();
+        if (benchmark) {
+            benchmark->addFrame(frame, viewIndex, timeSpentForFrame, statResults);
+        } else if ( !statResults.empty() ) {
             effect->reportStats(frame, viewIndex, timeSpentForFrame, statResults);
         }
     }
@@ -1786,6 +1933,7 @@ void
 OutputSchedulerThread::setDesiredFPS(double d)
 {
     _imp->timer->setDesiredFrameRate(d);
+    _imp->playback.setDesiredFrameRate(d);
 }
 
 double
@@ -1794,6 +1942,19 @@ OutputSchedulerThread::getDesiredFPS() const
     return _imp->timer->getDesiredFrameRate();
 }
 
+void
+OutputSchedulerThread::notifyFrameRenderCost(double renderTime,
+                                             unsigned int mipMapLevelOffset)
+{
+    _imp->playback.notifyFrameRenderCost(renderTime, mipMapLevelOffset);
+}
+
+unsigned int
+OutputSchedulerThread::getPlaybackMipMapLevelOffset() const
+{
+    return _imp->playback.getMipMapLevelOffset();
+}
+
 void
 OutputSchedulerThread::getLastRunArgs(RenderDirectionEnum* direction,
                                       std::vector<ViewIdx>* viewsToRender) const
@@ -2054,6 +2215,8 @@ RenderThreadTask::run()
 #ifdef TRACE_SCHEDULER
         qDebug() << "Parallel Render Thread: Picking frame to render: " << time;
 #endif
+        unsigned int mipMapLevelOffset = _imp->scheduler->getPlaybackMipMapLevelOffset();
+        TimeLapse renderTime;
         renderFrame(time, viewsToRender, enableRenderStats);
 
         appPTR->getAppTLS()->cleanupTLSForThread();
@@ -2061,6 +2224,7 @@ RenderThreadTask::run()
         if ( mustQuit() ) {
             break;
         }
+        _imp->scheduler->notifyFrameRenderCost(renderTime.getTimeSinceCreation(), mipMapLevelOffset);
     }
 
     {
@@ -3362,6 +3526,12 @@ RenderEngine::getDesiredFPS() const
     return _imp->scheduler ? _imp->scheduler->getDesiredFPS() : 24;
 }
 
+unsigned int
+RenderEngine::getPlaybackMipMapLevelOffset() const
+{
+    return _imp->scheduler ? _imp->scheduler->getPlaybackMipMapLevelOffset() : 0;
+}
+
 void
 RenderEngine::notifyFrameProduced(const BufferableObjectList& frames,
                                   const RenderStatsPtr& stats,
@@ -3455,42 +3625,36 @@ public:
     }
 };
 
-class RenderCurrentFrameFunctorRunnable;
+class RenderCurrentFrameTask;
+typedef boost::shared_ptr<RenderCurrentFrameTask> RenderCurrentFrameTaskPtr;
+
 struct ViewerCurrentFrameRequestSchedulerPrivate
 {
     ViewerInstancePtr viewer;
-    QThreadPool* threadPool;
     QMutex producedFramesMutex;
     ProducedFrameSet producedFrames;
     QWaitCondition producedFramesNotEmpty;
 
-
-    /**
-     * Single thread used by the ViewerCurrentFrameRequestScheduler when the global thread pool has reached its maximum
-     * activity to keep the renders responsive even if the thread pool is choking.
-     **/
-    ViewerCurrentFrameRequestRendererBackup backupThread;
+    // The renders submitted to the TaskExecutor that did not finish yet, from the oldest to the most recent
     mutable QMutex currentFrameRenderTasksMutex;
     QWaitCondition currentFrameRenderTasksCond;
-    std::list<RenderCurrentFrameFunctorRunnable*> currentFrameRenderTasks;
+    std::list<RenderCurrentFrameTaskPtr> currentFrameRenderTasks;
 
     // Used to attribute an age to each renderCurrentFrameRequest
     U64 ageCounter;
 
     ViewerCurrentFrameRequestSchedulerPrivate(const ViewerInstancePtr& viewer)
         : viewer(viewer)
-        , threadPool( QThreadPool::globalInstance() )
         , producedFramesMutex()
         , producedFrames()
         , producedFramesNotEmpty()
-        , backupThread()
         , currentFrameRenderTasksCond()
         , currentFrameRenderTasks()
         , ageCounter(0)
     {
     }
 
-    void appendRunnableTask(RenderCurrentFrameFunctorRunnable* task)
+    void appendRunnableTask(const RenderCurrentFrameTaskPtr& task)
     {
         {
             QMutexLocker k(&currentFrameRenderTasksMutex);
@@ -3498,13 +3662,13 @@ struct ViewerCurrentFrameRequestSchedulerPrivate
         }
     }
 
-    void removeRunnableTask(RenderCurrentFrameFunctorRunnable* task)
+    void removeRunnableTask(RenderCurrentFrameTask* task)
     {
         {
             QMutexLocker k(&currentFrameRenderTasksMutex);
-            for (std::list<RenderCurrentFrameFunctorRunnable*>::iterator it = currentFrameRenderTasks.begin();
+            for (std::list<RenderCurrentFrameTaskPtr>::iterator it = currentFrameRenderTasks.begin();
                  it != currentFrameRenderTasks.end(); ++it) {
-                if (*it == task) {
+                if (it->get() == task) {
                     currentFrameRenderTasks.erase(it);
 
                     currentFrameRenderTasksCond.wakeAll();
@@ -3514,6 +3678,12 @@ struct ViewerCurrentFrameRequestSchedulerPrivate
         }
     }
 
+    /**
+     * @brief Cancels the renders that did not start yet, except the oldest one if keepOldestRender is true
+     * and the ones that may not be skipped
+     **/
+    void cancelPendingRunnableTasks(bool keepOldestRender);
+
     void waitForRunnableTasks()
     {
         QMutexLocker k(&currentFrameRenderTasksMutex);
@@ -3540,20 +3710,29 @@ struct ViewerCurrentFrameRequestSchedulerPrivate
     void processProducedFrame(const RenderStatsPtr& stats, const BufferableObjectList& frames);
 };
 
-class RenderCurrentFrameFunctorRunnable
-    : public QRunnable
+/**
+ * @brief Renders the current frame of a viewer, in the interactive class of the TaskExecutor
+ **/
+class RenderCurrentFrameTask
+    : public ExecutorTask
 {
     boost::shared_ptr<CurrentFrameFunctorArgs> _args;
 
 public:
 
-    RenderCurrentFrameFunctorRunnable(const boost::shared_ptr<CurrentFrameFunctorArgs>& args)
-        : _args(args)
+    RenderCurrentFrameTask(const boost::shared_ptr<CurrentFrameFunctorArgs>& args)
+        : ExecutorTask()
+        , _args(args)
+    {
+    }
+
+    virtual ~RenderCurrentFrameTask()
     {
     }
 
-    virtual ~RenderCurrentFrameFunctorRunnable()
+    bool isSkippable() const
     {
+        return _args->isSkippable();
     }
 
     virtual void run() OVERRIDE FINAL
@@ -3591,6 +3770,21 @@ public:
             }
         }
 
+        onRenderDone(ret);
+    } // run
+
+    /**
+     * @brief The render was cancelled before it started: the scheduler still waits for a frame of its age
+     **/
+    virtual void onDropped() OVERRIDE FINAL
+    {
+        onRenderDone( BufferableObjectList() );
+    }
+
+private:
+
+    void onRenderDone(const BufferableObjectList& ret)
+    {
         if (_args->request) {
 #ifdef DEBUG
             for (BufferableObjectList::iterator it = ret.begin(); it != ret.end(); ++it) {
@@ -3617,9 +3811,26 @@ public:
 
 
         _args->scheduler->removeRunnableTask(this);
-    } // run
+    }
 };
 
+void
+ViewerCurrentFrameRequestSchedulerPrivate::cancelPendingRunnableTasks(bool keepOldestRender)
+{
+    QMutexLocker k(&currentFrameRenderTasksMutex);
+    std::list<RenderCurrentFrameTaskPtr>::iterator it = currentFrameRenderTasks.begin();
+
+    if ( keepOldestRender && ( it != currentFrameRenderTasks.end() ) ) {
+        ++it;
+    }
+    for (; it != currentFrameRenderTasks.end(); ++it) {
+        // Renders already started are aborted by ViewerInstance::markAllOnGoingRendersAsAborted()
+        if ( (*it)->isSkippable() ) {
+            (*it)->cancel();
+        }
+    }
+}
+
 
 class ViewerCurrentFrameRequestSchedulerExecOnMT
     : public GenericThreadExecOnMainThreadArgs
@@ -3628,9 +3839,15 @@ public:
 
     RenderStatsPtr stats;
     BufferableObjectList frames;
+    U64 age;
+    bool isProgressiveCoarsePass;
 
     ViewerCurrentFrameRequestSchedulerExecOnMT()
         : GenericThreadExecOnMainThreadArgs()
+        , stats()
+        , frames()
+        , age(0)
+        , isProgressiveCoarsePass(false)
     {
     }
 
@@ -3648,10 +3865,8 @@ ViewerCurrentFrameRequestScheduler::ViewerCurrentFrameRequestScheduler(const Vie
 
 ViewerCurrentFrameRequestScheduler::~ViewerCurrentFrameRequestScheduler()
 {
-    // Should've been stopped before anyway
-    if (_imp->backupThread.quitThread(false)) {
-        _imp->backupThread.waitForAbortToComplete_enforce_blocking();
-    }
+    // Should've been stopped before anyway: the renders hold a pointer to _imp
+    _imp->waitForRunnableTasks();
 }
 
 GenericSchedulerThread::TaskQueueBehaviorEnum
@@ -3672,22 +3887,23 @@ ViewerCurrentFrameRequestScheduler::threadLoopOnce(const ThreadStartArgsPtr &inA
 #endif
 
 
-    // Start the work in a thread of the thread pool if we can.
-    // Let at least 1 free thread in the thread-pool to allow the renderer to use the thread pool if we use the thread-pool
-    int maxThreads = _imp->threadPool->maxThreadCount();
+    // When painting or tracking, renders must complete in order: wait for the previous ones
     if (args->useSingleThread) {
-        maxThreads = 1;
+        _imp->waitForRunnableTasks();
     }
+
+    // Render in the interactive class of the TaskExecutor, so that viewer renders start before previews and housekeeping
     args->functorArgs->request = args;
-    if ( (maxThreads == 1) || (_imp->threadPool->activeThreadCount() >= maxThreads - 1) ) {
-        _imp->backupThread.startTask(args->functorArgs);
-    } else {
-        RenderCurrentFrameFunctorRunnable* task = new RenderCurrentFrameFunctorRunnable(args->functorArgs);
-        _imp->appendRunnableTask(task);
-        _imp->threadPool->start(task);
+    RenderCurrentFrameTaskPtr task( new RenderCurrentFrameTask(args->functorArgs) );
+    _imp->appendRunnableTask(task);
+    TaskExecutor* executor = appPTR->getTaskExecutor();
+    if ( !executor || !executor->submit(eTaskPriorityInteractive, task) ) {
+        // The executor quit, the application is shutting down
+        task->run();
     }
+    task.reset();
 
-    // Clear the shared ptr now that we started the task in the thread pool
+    // Clear the shared ptr now that we started the task on the executor
     args->functorArgs.reset();
 
     // Wait for the work to be done
@@ -3723,6 +3939,8 @@ ViewerCurrentFrameRequestScheduler::threadLoopOnce(const ThreadStartArgsPtr &inA
 
             mtArgs->frames = found->frames;
             mtArgs->stats = found->stats;
+            mtArgs->age = args->age;
+            mtArgs->isProgressiveCoarsePass = args->isProgressiveCoarsePass;
 
             // Erase from the produced frames all renders that are older that the age we want to render
             // since they are no longer going to be used.
@@ -3765,6 +3983,11 @@ ViewerCurrentFrameRequestScheduler::executeOnMainThread(const ExecOnMTArgsPtr& i
     assert(args);
     if (args) {
         _imp->processProducedFrame(args->stats, args->frames);
+
+        // Refine the coarse pass of a progressive render, unless another render was requested since
+        if ( args->isProgressiveCoarsePass && !args->frames.empty() && (args->age + 1 == _imp->ageCounter) ) {
+            renderCurrentFrameInternal(false, true, false);
+        }
     }
 }
 
@@ -3809,27 +4032,26 @@ ViewerCurrentFrameRequestScheduler::onAbortRequested(bool keepOldestRender)
     //This function marks all active renders of the viewer as aborted (except the oldest one)
     //and each node actually check if the render has been aborted in EffectInstance::Implementation::aborted()
     _imp->viewer->markAllOnGoingRendersAsAborted(keepOldestRender);
-    _imp->backupThread.abortThreadedTask();
+    // The renders still queued in the TaskExecutor will not start
+    _imp->cancelPendingRunnableTasks(keepOldestRender);
 }
 
 void
-ViewerCurrentFrameRequestScheduler::onQuitRequested(bool allowRestarts)
+ViewerCurrentFrameRequestScheduler::onQuitRequested(bool /*allowRestarts*/)
 {
-    _imp->backupThread.quitThread(allowRestarts);
+    _imp->cancelPendingRunnableTasks(false);
 }
 
 void
 ViewerCurrentFrameRequestScheduler::onWaitForThreadToQuit()
 {
     _imp->waitForRunnableTasks();
-    _imp->backupThread.waitForThreadToQuit_enforce_blocking();
 }
 
 void
 ViewerCurrentFrameRequestScheduler::onWaitForAbortCompleted()
 {
     _imp->waitForRunnableTasks();
-    _imp->backupThread.waitForAbortToComplete_enforce_blocking();
 }
 
 void
@@ -3843,6 +4065,14 @@ ViewerCurrentFrameRequestScheduler::notifyFrameProduced(const BufferableObjectLi
 void
 ViewerCurrentFrameRequestScheduler::renderCurrentFrame(bool enableRenderStats,
                                                        bool canAbort)
+{
+    renderCurrentFrameInternal(enableRenderStats, canAbort, true);
+}
+
+void
+ViewerCurrentFrameRequestScheduler::renderCurrentFrameInternal(bool enableRenderStats,
+                                                               bool canAbort,
+                                                               bool allowProgressive)
 {
     if (!_imp->viewer || !_imp->viewer->getNode()) {
         return;
@@ -3887,12 +4117,20 @@ ViewerCurrentFrameRequestScheduler::renderCurrentFrame(bool enableRenderStats,
         curStroke.reset();
     }
 
+    // When the frame is not cached, first render it at a coarse level to give a quick feedback: it is rendered again
+    // at full resolution once displayed, see executeOnMainThread(). Stats are for the actual render.
+    const bool progressive = allowProgressive && canAbort && !enableRenderStats && !rotoPaintNode && !isTracking &&
+                             appPTR->getCurrentSettings()->getNumberOfThreads() != -1 &&
+                             _imp->viewer->isProgressiveRenderUseful();
+    bool refineCachedTextures = false;
+
     boost::shared_ptr<ViewerArgs> args[2];
     if (!rotoPaintNode || isRotoNeatRender) {
         bool clearTexture[2] = {false, false};
 
         for (int i = 0; i < 2; ++i) {
             args[i].reset(new ViewerArgs);
+            args[i]->isProgressiveCoarsePass = progressive;
             status[i] = _imp->viewer->getRenderViewerArgsAndCheckCache_public( frame, false, view, i, viewerHash, canAbort, rotoPaintNode, isRotoNeatRender, stats, args[i].get() );
 
             clearTexture[i] = status[i] == ViewerInstance::eViewerRenderRetCodeFail || status[i] == ViewerInstance::eViewerRenderRetCodeBlack;
@@ -3945,6 +4183,9 @@ ViewerCurrentFrameRequestScheduler::renderCurrentFrame(bool enableRenderStats,
                     std::map<NodePtr, NodeRenderStats > statResults = stats->getStats(&timeSpent);
                     _imp->viewer->reportStats(frame, view, timeSpent, statResults);
                 }
+                if ( progressive && (args[i]->params->mipMapLevel != args[i]->mipmapLevelWithoutDraft) ) {
+                    refineCachedTextures = true;
+                }
                 _imp->viewer->updateViewer(args[i]->params);
                 args[i].reset();
             }
@@ -3953,6 +4194,10 @@ ViewerCurrentFrameRequestScheduler::renderCurrentFrame(bool enableRenderStats,
              ( !args[0] && ( status[0] == ViewerInstance::eViewerRenderRetCodeRender) && args[1] && ( status[1] == ViewerInstance::eViewerRenderRetCodeFail) ) ||
              ( !args[1] && ( status[1] == ViewerInstance::eViewerRenderRetCodeRender) && args[0] && ( status[0] == ViewerInstance::eViewerRenderRetCodeFail) ) ) {
             _imp->viewer->redrawViewer();
+            if (refineCachedTextures) {
+                // Only the coarse textures were cached
+                renderCurrentFrameInternal(enableRenderStats, canAbort, false);
+            }
 
             return;
         }
@@ -3975,7 +4220,7 @@ ViewerCurrentFrameRequestScheduler::renderCurrentFrame(bool enableRenderStats,
     }
 
     if (appPTR->getCurrentSettings()->getNumberOfThreads() == -1) {
-        RenderCurrentFrameFunctorRunnable task(functorArgs);
+        RenderCurrentFrameTask task(functorArgs);
         task.run();
     } else {
         // Identify this render request with an age
@@ -3984,6 +4229,7 @@ ViewerCurrentFrameRequestScheduler::renderCurrentFrame(bool enableRenderStats,
         request->functorArgs = functorArgs;
         // When painting, limit the number of threads to 1 to be sure strokes are painted in the right order
         request->useSingleThread = rotoUse1Thread || isTracking;
+        request->isProgressiveCoarsePass = progressive;
         if (isRotoNeatRender) {
             request->setCanSkip(false);
         }
@@ -3997,36 +4243,7 @@ ViewerCurrentFrameRequestScheduler::renderCurrentFrame(bool enableRenderStats,
         startTask(request);
 
     }
-} // ViewerCurrentFrameRequestScheduler::renderCurrentFrame
-
-ViewerCurrentFrameRequestRendererBackup::ViewerCurrentFrameRequestRendererBackup()
-    : GenericSchedulerThread()
-{
-    setThreadName("ViewerCurrentFrameRequestRendererBackup");
-}
-
-ViewerCurrentFrameRequestRendererBackup::~ViewerCurrentFrameRequestRendererBackup()
-{
-}
-
-GenericSchedulerThread::TaskQueueBehaviorEnum
-ViewerCurrentFrameRequestRendererBackup::tasksQueueBehaviour() const 
-{
-    return eTaskQueueBehaviorSkipToMostRecent;
-}
-
-
-GenericSchedulerThread::ThreadStateEnum
-ViewerCurrentFrameRequestRendererBackup::threadLoopOnce(const ThreadStartArgsPtr& inArgs)
-{
-    boost::shared_ptr<CurrentFrameFunctorArgs> args = boost::dynamic_pointer_cast<CurrentFrameFunctorArgs>(inArgs);
-
-    assert(args);
-    RenderCurrentFrameFunctorRunnable task(args);
-    task.run();
-
-    return eThreadStateActive;
-}
+} // ViewerCurrentFrameRequestScheduler::renderCurrentFrameInternal
 
 NATRON_NAMESPACE_EXIT;
 
@@ -79,10 +79,15 @@ public:
     U64 age;
     boost::shared_ptr<CurrentFrameFunctorArgs> functorArgs;
     bool useSingleThread;
+    // The coarse pass of a progressive render: the frame is rendered again at full resolution once displayed
+    bool isProgressiveCoarsePass;
 
     ViewerCurrentFrameRequestSchedulerStartArgs()
         : GenericThreadStartArgs()
         , age(0)
+        , functorArgs()
+        , useSingleThread(false)
+        , isProgressiveCoarsePass(false)
     {
     }
 
@@ -320,6 +325,16 @@ public:
      **/
     double getDesiredFPS() const;
 
+    /**
+     * @brief Called by the render threads after rendering a frame, see PlaybackController::notifyFrameRenderCost
+     **/
+    void notifyFrameRenderCost(double renderTime, unsigned int mipMapLevelOffset);
+
+    /**
+     * @brief Returns how many mipmap levels lower than requested the frames are rendered during playback to hold the frame rate
+     **/
+    unsigned int getPlaybackMipMapLevelOffset() const;
+
     void runCallbackWithVariables(const QString& callback);
 
 private Q_SLOTS:
@@ -460,6 +475,11 @@ private:
     void startTasks(int startingFrame);
 #endif
 
+    /**
+     * @brief Emits RenderEngine::droppedFramesChanged if frames were dropped or the playback resolution changed since the last call
+     **/
+    void reportDroppedFrames();
+
     /**
      * @brief Make nThreadsToStop quit running. If 0 then all threads will be destroyed.
      **/
@@ -550,6 +570,8 @@ private:
  * in which you launched the thread in the first place.
  * Instead of re-using the OutputSchedulerClass and adding extra handling for special cases we separated it in a different class, specialized for this kind
  * of "current frame re-rendering" which needs much less code to run than all the code in OutputSchedulerThread
+ * The renders themselves are tasks of the interactive class of the TaskExecutor: this thread only submits them
+ * and hands the produced frames to the main thread in order.
  **/
 
 struct ViewerCurrentFrameRequestSchedulerPrivate;
@@ -572,6 +594,12 @@ public:
 
 private:
 
+    /**
+     * @brief If allowProgressive is true and the frame is not cached, it is first rendered at the auto-proxy level
+     * and then at full resolution.
+     **/
+    void renderCurrentFrameInternal(bool enableRenderStats, bool canAbort, bool allowProgressive);
+
     virtual void onWaitForAbortCompleted() OVERRIDE FINAL;
     virtual void onWaitForThreadToQuit() OVERRIDE FINAL;
     virtual void onAbortRequested(bool keepOldestRender) OVERRIDE FINAL;
@@ -592,34 +620,6 @@ private:
 
 struct ViewerArgs;
 
-/**
- * @brief Single thread used by the ViewerCurrentFrameRequestScheduler when the global thread pool has reached its maximum
- * activity to keep the renders responsive even if the thread pool is choking.
- **/
-struct ViewerCurrentFrameRequestRendererBackupPrivate;
-class ViewerCurrentFrameRequestRendererBackup
-    : public GenericSchedulerThread
-{
-public:
-
-    ViewerCurrentFrameRequestRendererBackup();
-
-    virtual ~ViewerCurrentFrameRequestRendererBackup();
-
-private:
-
-    /**
-     * @brief How to pick the task to process from the consumer thread
-     **/
-    virtual TaskQueueBehaviorEnum tasksQueueBehaviour() const OVERRIDE FINAL;
-    
-    /**
-     * @brief Must be implemented to execute the work of the thread for 1 loop. This function will be called in a infinite loop by the thread
-     **/
-    virtual ThreadStateEnum threadLoopOnce(const ThreadStartArgsPtr& inArgs) OVERRIDE FINAL WARN_UNUSED_RETURN;
-};
-
-
 /**
  * @brief This class manages multiple OutputThreadScheduler so that each render request gets processed as soon as possible.
  **/
@@ -693,6 +693,12 @@ public:
      **/
     double getDesiredFPS() const;
 
+    /**
+     * @brief Returns how many mipmap levels lower than requested the frames are rendered during playback to hold the frame rate.
+     * This is 0 unless real-time playback is enabled in the preferences.
+     **/
+    unsigned int getPlaybackMipMapLevelOffset() const;
+
     /**
      * @brief Quit all processing, making sure all threads are finished, this is not blocking
      **/
@@ -798,6 +804,13 @@ Q_SIGNALS:
      **/
     void fpsChanged(double actualFps, double desiredFps);
 
+    /**
+     * @brief Emitted during real-time playback when frames are dropped or the resolution is lowered to hold the frame rate.
+     * @param nbDroppedFrames The number of frames dropped since playback started
+     * @param mipMapLevelOffset How many mipmap levels lower than requested the frames are rendered
+     **/
+    void droppedFramesChanged(int nbDroppedFrames, int mipMapLevelOffset);
+
     /**
      * @brief Emitted after a frame is rendered.
      * This will not be emitted after calling renderCurrentFrame
@@ -846,6 +859,9 @@ private:
     void s_fpsChanged(double actual,
                       double desired) { Q_EMIT fpsChanged(actual, desired); }
 
+    void s_droppedFramesChanged(int nbDroppedFrames,
+                                int mipMapLevelOffset) { Q_EMIT droppedFramesChanged(nbDroppedFrames, mipMapLevelOffset); }
+
     void s_frameRendered(int time,
                          double progress) { Q_EMIT frameRendered(time, progress); }
 
@@ -764,6 +764,9 @@ ParallelRenderArgsSetter::ParallelRenderArgsSetter(const CtorArgsPtr& inArgs)
                 } catch (const std::exception& /*e*/) {
 
                 }
+                // Only release in the destructor the contexts that were attached here
+                _openGLContext = glContext;
+                _cpuOpenGLContext = cpuContext;
             }
         }
     } else {
@@ -773,11 +776,10 @@ ParallelRenderArgsSetter::ParallelRenderArgsSetter(const CtorArgsPtr& inArgs)
         } catch (const std::exception& /*e*/) {
 
         }
+        _openGLContext = glContext;
+        _cpuOpenGLContext = cpuContext;
     }
 
-    _openGLContext = glContext;
-    _cpuOpenGLContext = cpuContext;
-
     bool doNanHandling = appPTR->getCurrentSettings()->isNaNHandlingEnabled();
 
     FindDependenciesMap dependenciesMap;
@@ -918,6 +920,7 @@ ParallelRenderArgs::ParallelRenderArgs()
     , visitsCount(0)
     , rotoPaintNodes()
     , stats()
+    , knobsSnapshot()
     , openGLContext()
     , textureIndex(0)
     , currentThreadSafety(eRenderSafetyInstanceSafe)
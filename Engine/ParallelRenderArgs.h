@@ -116,6 +116,10 @@ public:
     ///Various stats local to the render of a frame
     RenderStatsPtr stats;
 
+    ///The values of the knobs of the node frozen when the render started, read by the render threads
+    ///instead of the knobs themselves. NULL if the knobs must be read live (e.g: for analysis)
+    KnobsRenderSnapshotPtr knobsSnapshot;
+
     ///The OpenGL context to use for the render of this frame
     boost::weak_ptr<OSGLContext> openGLContext;
 
@@ -0,0 +1,257 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <http://www.natron.fr/>,
+ * Copyright (C) 2016 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "PlaybackController.h"
+
+#include <algorithm> // min, max
+#include <cmath>
+
+#include <QtCore/QMutex>
+#include <QtCore/QMutexLocker>
+
+// Weight of a new measure in the running average of the time spent rendering a frame
+#define NATRON_PLAYBACK_RENDER_COST_SMOOTHING 0.2
+
+// Dropped frames are counted over periods of this duration to decide whether the mipmap level should change
+#define NATRON_PLAYBACK_ADJUST_PERIOD_SECONDS 1.
+
+// The frames are rendered at a lower level when more than this fraction of the frames of a period were dropped
+#define NATRON_PLAYBACK_MAX_DROPPED_FRAMES_RATIO 0.1
+
+// The frames are rendered at a higher level again when they could be rendered this much faster than the frame rate at that level
+#define NATRON_PLAYBACK_HIGHER_LEVEL_MARGIN 1.25
+
+// A frame this late is not caught up with by dropping frames: the playback clock restarts from it instead.
+// This happens when playback was stalled, e.g by a modal dialog.
+#define NATRON_PLAYBACK_MAX_LATENESS_SECONDS 1.
+
+NATRON_NAMESPACE_ENTER;
+
+struct PlaybackControllerPrivate
+{
+    mutable QMutex lock;
+    double spf;
+    bool maintainRealTime;
+    unsigned int maxMipMapLevelOffset;
+    unsigned int mipMapLevelOffset;
+
+    // Running average of the time a render thread spends on a frame at the current level, 0 if unknown
+    double renderCost;
+
+    // The playback clock: frame n (displayed or dropped) since the clock started is due at clockOrigin + n * spf
+    bool clockStarted;
+    double clockOrigin;
+    int nbClockedFrames;
+    int nbDroppedFrames;
+
+    // The current adjustment period
+    double periodStart;
+    int nbPeriodFrames;
+    int nbPeriodDroppedFrames;
+
+    PlaybackControllerPrivate()
+        : lock()
+        , spf(1. / 24.)
+        , maintainRealTime(false)
+        , maxMipMapLevelOffset(0)
+        , mipMapLevelOffset(0)
+        , renderCost(0.)
+        , clockStarted(false)
+        , clockOrigin(0.)
+        , nbClockedFrames(0)
+        , nbDroppedFrames(0)
+        , periodStart(0.)
+        , nbPeriodFrames(0)
+        , nbPeriodDroppedFrames(0)
+    {
+    }
+
+    double getLateness(double now) const
+    {
+        return now - (clockOrigin + nbClockedFrames * spf);
+    }
+};
+
+PlaybackController::PlaybackController()
+    : _imp( new PlaybackControllerPrivate() )
+{
+}
+
+PlaybackController::~PlaybackController()
+{
+}
+
+void
+PlaybackController::reset(double desiredFps,
+                          bool maintainRealTime,
+                          unsigned int maxMipMapLevelOffset)
+{
+    QMutexLocker k(&_imp->lock);
+
+    _imp->spf = desiredFps > 0 ? 1. / desiredFps : 1. / 24.;
+    _imp->maintainRealTime = maintainRealTime;
+    _imp->maxMipMapLevelOffset = maintainRealTime ? maxMipMapLevelOffset : 0;
+    _imp->mipMapLevelOffset = 0;
+    _imp->renderCost = 0.;
+    _imp->clockStarted = false;
+    _imp->nbClockedFrames = 0;
+    _imp->nbDroppedFrames = 0;
+    _imp->nbPeriodFrames = 0;
+    _imp->nbPeriodDroppedFrames = 0;
+}
+
+void
+PlaybackController::setDesiredFrameRate(double fps)
+{
+    if (fps <= 0) {
+        return;
+    }
+    QMutexLocker k(&_imp->lock);
+    _imp->spf = 1. / fps;
+    // The clock restarts from the next displayed frame
+    _imp->clockStarted = false;
+}
+
+void
+PlaybackController::notifyFrameRenderCost(double renderTime,
+                                          unsigned int mipMapLevelOffset)
+{
+    QMutexLocker k(&_imp->lock);
+
+    if (mipMapLevelOffset != _imp->mipMapLevelOffset) {
+        return;
+    }
+    if (_imp->renderCost <= 0.) {
+        _imp->renderCost = renderTime;
+    } else {
+        _imp->renderCost += (renderTime - _imp->renderCost) * NATRON_PLAYBACK_RENDER_COST_SMOOTHING;
+    }
+}
+
+double
+PlaybackController::getAverageFrameRenderCost() const
+{
+    QMutexLocker k(&_imp->lock);
+
+    return _imp->renderCost;
+}
+
+int
+PlaybackController::getRenderAheadCount(int nbRenderThreads,
+                                        int maxFrames) const
+{
+    nbRenderThreads = std::max(1, nbRenderThreads);
+    QMutexLocker k(&_imp->lock);
+    if (_imp->renderCost <= 0.) {
+        // Nothing measured yet
+        return nbRenderThreads * 2;
+    }
+    int nbFrames = (int)std::ceil(_imp->renderCost / _imp->spf);
+
+    return std::min( std::max(nbFrames, nbRenderThreads), std::max(maxFrames, nbRenderThreads) );
+}
+
+int
+PlaybackController::getNbFramesToDrop(double now) const
+{
+    QMutexLocker k(&_imp->lock);
+
+    if (!_imp->maintainRealTime || !_imp->clockStarted) {
+        return 0;
+    }
+    double lateness = _imp->getLateness(now);
+    if ( (lateness < _imp->spf) || (lateness > NATRON_PLAYBACK_MAX_LATENESS_SECONDS) ) {
+        return 0;
+    }
+
+    return (int)std::floor(lateness / _imp->spf);
+}
+
+void
+PlaybackController::notifyFrameDisplayed(double now,
+                                         int nbDroppedFrames,
+                                         int nbRenderThreads)
+{
+    QMutexLocker k(&_imp->lock);
+
+    if (!_imp->maintainRealTime) {
+        return;
+    }
+    if (!_imp->clockStarted) {
+        _imp->clockStarted = true;
+        _imp->nbClockedFrames = 0;
+        _imp->clockOrigin = now;
+        _imp->periodStart = now;
+        _imp->nbPeriodFrames = 0;
+        _imp->nbPeriodDroppedFrames = 0;
+    } else {
+        // Frames displayed early do not give credit for later frames, and frames too late restart the clock
+        double lateness = _imp->getLateness(now);
+        if ( (lateness < 0) || (lateness > NATRON_PLAYBACK_MAX_LATENESS_SECONDS) ) {
+            _imp->clockOrigin = now - _imp->nbClockedFrames * _imp->spf;
+        }
+    }
+    _imp->nbClockedFrames += 1 + nbDroppedFrames;
+    _imp->nbDroppedFrames += nbDroppedFrames;
+    _imp->nbPeriodFrames += 1 + nbDroppedFrames;
+    _imp->nbPeriodDroppedFrames += nbDroppedFrames;
+
+    if (now - _imp->periodStart < NATRON_PLAYBACK_ADJUST_PERIOD_SECONDS) {
+        return;
+    }
+    if (_imp->nbPeriodDroppedFrames > _imp->nbPeriodFrames * NATRON_PLAYBACK_MAX_DROPPED_FRAMES_RATIO) {
+        if (_imp->mipMapLevelOffset < _imp->maxMipMapLevelOffset) {
+            ++_imp->mipMapLevelOffset;
+            _imp->renderCost = 0.;
+        }
+    } else if ( (_imp->nbPeriodDroppedFrames == 0) && (_imp->mipMapLevelOffset > 0) && (_imp->renderCost > 0.) ) {
+        // The higher level has 4 times as many pixels to render
+        double higherLevelFps = std::max(1, nbRenderThreads) / (_imp->renderCost * 4.);
+        if (higherLevelFps * _imp->spf > NATRON_PLAYBACK_HIGHER_LEVEL_MARGIN) {
+            --_imp->mipMapLevelOffset;
+            _imp->renderCost = 0.;
+        }
+    }
+    _imp->periodStart = now;
+    _imp->nbPeriodFrames = 0;
+    _imp->nbPeriodDroppedFrames = 0;
+} // PlaybackController::notifyFrameDisplayed
+
+unsigned int
+PlaybackController::getMipMapLevelOffset() const
+{
+    QMutexLocker k(&_imp->lock);
+
+    return _imp->mipMapLevelOffset;
+}
+
+int
+PlaybackController::getNbDroppedFrames() const
+{
+    QMutexLocker k(&_imp->lock);
+
+    return _imp->nbDroppedFrames;
+}
+
+NATRON_NAMESPACE_EXIT;
@@ -0,0 +1,112 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <http://www.natron.fr/>,
+ * Copyright (C) 2016 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+#ifndef Engine_PlaybackController_h
+#define Engine_PlaybackController_h
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "Global/Macros.h"
+
+#if !defined(Q_MOC_RUN) && !defined(SBK_RUN)
+#include <boost/scoped_ptr.hpp>
+#endif
+
+#include "Engine/EngineFwd.h"
+
+NATRON_NAMESPACE_ENTER;
+
+/**
+ * @brief Adapts the playback of a viewer to the time it takes to render the frames.
+ * It measures the average time a render thread spends on a frame, and from it decides how many frames
+ * should be queued for rendering ahead of the one being displayed, so that frames are ready when they are due.
+ * When real-time playback is requested, it also keeps a playback clock: when the frame to display is late
+ * by one frame or more, the frames that should already have been displayed are dropped, and if frames keep
+ * being dropped the frames are rendered at a lower mipmap level (and back at a higher level once there is room for it).
+ * Times are passed in seconds from an arbitrary origin, so that the policy does not depend on a clock.
+ * All functions are thread-safe.
+ **/
+struct PlaybackControllerPrivate;
+class PlaybackController
+{
+public:
+
+    PlaybackController();
+
+    ~PlaybackController();
+
+    /**
+     * @brief Called when playback starts: forgets all measures.
+     * If maintainRealTime is true, frames may be dropped and rendered up to maxMipMapLevelOffset levels lower than requested.
+     **/
+    void reset(double desiredFps, bool maintainRealTime, unsigned int maxMipMapLevelOffset);
+
+    void setDesiredFrameRate(double fps);
+
+    /**
+     * @brief Called by the render threads after rendering a frame, which took renderTime seconds, at the
+     * given offset from the requested mipmap level. Measures made at another offset than the current one are ignored.
+     **/
+    void notifyFrameRenderCost(double renderTime, unsigned int mipMapLevelOffset);
+
+    /**
+     * @brief The average time spent by a render thread on a frame at the current mipmap level, or 0 if unknown yet.
+     **/
+    double getAverageFrameRenderCost() const;
+
+    /**
+     * @brief The number of frames to keep queued for rendering: enough to keep the nbRenderThreads render threads busy,
+     * and so that a frame starts rendering at least the average render time before it is displayed, but at most maxFrames.
+     **/
+    int getRenderAheadCount(int nbRenderThreads, int maxFrames) const;
+
+    /**
+     * @brief Called by the scheduler when the next frame to display is available at the time now.
+     * Returns how many of the frames following it should be dropped to catch up with the playback clock.
+     * This is always 0 if real-time playback was not requested.
+     **/
+    int getNbFramesToDrop(double now) const;
+
+    /**
+     * @brief Called by the scheduler when a frame is displayed at the time now, nbDroppedFrames frames being skipped after it.
+     * This advances the playback clock and adjusts the mipmap level offset.
+     **/
+    void notifyFrameDisplayed(double now, int nbDroppedFrames, int nbRenderThreads);
+
+    /**
+     * @brief How many mipmap levels lower than requested the frames should be rendered to hold the frame rate.
+     **/
+    unsigned int getMipMapLevelOffset() const;
+
+    /**
+     * @brief The number of frames dropped since playback started.
+     **/
+    int getNbDroppedFrames() const;
+
+private:
+
+    boost::scoped_ptr<PlaybackControllerPrivate> _imp;
+};
+
+NATRON_NAMESPACE_EXIT;
+
+#endif // Engine_PlaybackController_h
@@ -312,6 +312,18 @@ Plugin::setOpenGLEnabled(bool b)
     _openglActivated = b;
 }
 
+bool
+Plugin::isInputImagesCopyEnabled() const
+{
+    return _inputImagesCopyEnabled;
+}
+
+void
+Plugin::setInputImagesCopyEnabled(bool b)
+{
+    _inputImagesCopyEnabled = b;
+}
+
 void
 Plugin::setOpenGLRenderSupport(PluginOpenGLRenderSupport support)
 {
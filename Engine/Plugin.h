@@ -192,6 +192,7 @@ class Plugin
     bool _renderScaleEnabled;
     bool _multiThreadingEnabled;
     bool _openglActivated;
+    bool _inputImagesCopyEnabled;
 
     PluginOpenGLRenderSupport _openglRenderSupport;
 
@@ -223,6 +224,7 @@ public:
         , _renderScaleEnabled(true)
         , _multiThreadingEnabled(true)
         , _openglActivated(true)
+        , _inputImagesCopyEnabled(false)
         , _openglRenderSupport(ePluginOpenGLRenderSupportNone)
     {
     }
@@ -265,6 +267,7 @@ public:
         , _renderScaleEnabled(true)
         , _multiThreadingEnabled(true)
         , _openglActivated(true)
+        , _inputImagesCopyEnabled(false)
         , _openglRenderSupport(ePluginOpenGLRenderSupportNone)
     {
         if ( _resourcesPath.isEmpty() ) {
@@ -369,6 +372,13 @@ public:
     bool isOpenGLEnabled() const;
     void setOpenGLEnabled(bool b);
 
+    /**
+     * @brief When true, input images are copied to a buffer private to the plug-in before being
+     * handed to it, for plug-ins that (out of spec) write to their source images.
+     **/
+    bool isInputImagesCopyEnabled() const;
+    void setInputImagesCopyEnabled(bool b);
+
     void setOpenGLRenderSupport(PluginOpenGLRenderSupport support);
     PluginOpenGLRenderSupport getPluginOpenGLRenderSupport() const;
 };
@@ -0,0 +1,299 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <http://www.natron.fr/>,
+ * Copyright (C) 2016 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "PrecompCache.h"
+
+#include <cstring> // memcpy
+#include <set>
+
+#include <QtCore/QDateTime>
+#include <QtCore/QDir>
+#include <QtCore/QFile>
+#include <QtCore/QFileInfo>
+#include <QtCore/QTextStream>
+
+#include <SequenceParsing.h>
+
+#include "Engine/AppManager.h"
+#include "Engine/Hash64.h"
+
+#define NATRON_PRECOMP_CACHE_DIR "PrecompCache"
+#define NATRON_PRECOMP_CACHE_MAGIC "NatronPrecompCache"
+#define NATRON_PRECOMP_CACHE_VERSION 1
+
+NATRON_NAMESPACE_ENTER;
+
+bool
+PrecompCache::hashFile(const std::string& filename,
+                       U64* hash)
+{
+    QFile file( QString::fromUtf8( filename.c_str() ) );
+
+    if ( !file.open(QIODevice::ReadOnly) ) {
+        return false;
+    }
+    QByteArray data = file.readAll();
+    Hash64 h;
+    h.append<qint64>( data.size() );
+    const char* p = data.constData();
+    int nbWords = data.size() / 8;
+    for (int i = 0; i < nbWords; ++i, p += 8) {
+        U64 word;
+        std::memcpy(&word, p, 8);
+        h.append(word);
+    }
+    U64 lastWord = 0;
+    std::memcpy(&lastWord, p, data.size() - nbWords * 8);
+    h.append(lastWord);
+    h.computeHash();
+    *hash = h.value();
+
+    return true;
+}
+
+QString
+PrecompCache::getEntryFilePath(const QString& cacheDir,
+                               const std::string& projectFilename,
+                               const std::string& writeNodeName,
+                               int firstFrame,
+                               int lastFrame)
+{
+    Hash64 h;
+
+    Hash64_appendQString( &h, QString::fromUtf8( projectFilename.c_str() ) );
+    h.append<int>(0);
+    Hash64_appendQString( &h, QString::fromUtf8( writeNodeName.c_str() ) );
+    h.append(firstFrame);
+    h.append(lastFrame);
+    h.computeHash();
+
+    return cacheDir + QLatin1Char('/') + QString::number(h.value(), 16) + QString::fromUtf8(".txt");
+}
+
+QString
+PrecompCache::getEntryFilePath(const std::string& projectFilename,
+                               const std::string& writeNodeName,
+                               int firstFrame,
+                               int lastFrame)
+{
+    QString cacheDir = appPTR->getDiskCacheLocation() + QString::fromUtf8("/" NATRON_PRECOMP_CACHE_DIR);
+
+    return getEntryFilePath(cacheDir, projectFilename, writeNodeName, firstFrame, lastFrame);
+}
+
+static void
+writeFiles(QTextStream& ts,
+           const char* tag,
+           const std::list<PrecompCacheFile>& files)
+{
+    for (std::list<PrecompCacheFile>::const_iterator it = files.begin(); it != files.end(); ++it) {
+        // The path goes last since it may contain spaces
+        ts << tag << ' ' << it->size << ' ' << it->modificationTime << ' ' << it->contentHash << ' '
+           << QString::fromUtf8( it->path.c_str() ) << '\n';
+    }
+}
+
+bool
+PrecompCache::writeEntry(const QString& entryFilePath,
+                         const PrecompCacheEntry& entry)
+{
+    QFileInfo info(entryFilePath);
+
+    if ( !QDir().mkpath( info.absolutePath() ) ) {
+        return false;
+    }
+
+    // Write to a temporary file first so that a concurrent reader never sees a partial entry
+    QString tmpFilePath = entryFilePath + QString::fromUtf8(".tmp");
+    {
+        QFile file(tmpFilePath);
+        if ( !file.open(QIODevice::WriteOnly | QIODevice::Truncate) ) {
+            return false;
+        }
+        QTextStream ts(&file);
+        ts.setCodec("UTF-8");
+        ts << NATRON_PRECOMP_CACHE_MAGIC << ' ' << NATRON_PRECOMP_CACHE_VERSION << '\n';
+        ts << "projectHash " << entry.projectHash << '\n';
+        ts << "treeHash " << entry.treeHash << '\n';
+        ts << "frames " << entry.firstFrame << ' ' << entry.lastFrame << '\n';
+        ts << "writeNode " << QString::fromUtf8( entry.writeNodeName.c_str() ) << '\n';
+        ts << "pattern " << QString::fromUtf8( entry.filePattern.c_str() ) << '\n';
+        writeFiles(ts, "rendered", entry.renderedFiles);
+        writeFiles(ts, "dependency", entry.dependencies);
+        ts.flush();
+        if (ts.status() != QTextStream::Ok) {
+            return false;
+        }
+    }
+    QFile::remove(entryFilePath);
+
+    return QFile::rename(tmpFilePath, entryFilePath);
+}
+
+bool
+PrecompCache::readEntry(const QString& entryFilePath,
+                        PrecompCacheEntry* entry)
+{
+    QFile file(entryFilePath);
+
+    if ( !file.open(QIODevice::ReadOnly) ) {
+        return false;
+    }
+    QTextStream ts(&file);
+    ts.setCodec("UTF-8");
+
+    QString magic;
+    int version = 0;
+    ts >> magic >> version;
+    if ( ( magic != QString::fromUtf8(NATRON_PRECOMP_CACHE_MAGIC) ) || (version != NATRON_PRECOMP_CACHE_VERSION) ) {
+        return false;
+    }
+    *entry = PrecompCacheEntry();
+    while ( !ts.atEnd() ) {
+        QString tag;
+        ts >> tag;
+        if ( tag.isEmpty() ) {
+            continue;
+        }
+        if ( tag == QString::fromUtf8("projectHash") ) {
+            ts >> entry->projectHash;
+        } else if ( tag == QString::fromUtf8("treeHash") ) {
+            ts >> entry->treeHash;
+        } else if ( tag == QString::fromUtf8("frames") ) {
+            ts >> entry->firstFrame >> entry->lastFrame;
+        } else if ( tag == QString::fromUtf8("writeNode") ) {
+            entry->writeNodeName = ts.readLine().mid(1).toStdString();
+        } else if ( tag == QString::fromUtf8("pattern") ) {
+            entry->filePattern = ts.readLine().mid(1).toStdString();
+        } else if ( ( tag == QString::fromUtf8("rendered") ) || ( tag == QString::fromUtf8("dependency") ) ) {
+            PrecompCacheFile f;
+            ts >> f.size >> f.modificationTime >> f.contentHash;
+            f.path = ts.readLine().mid(1).toStdString();
+            if (tag == QString::fromUtf8("rendered")) {
+                entry->renderedFiles.push_back(f);
+            } else {
+                entry->dependencies.push_back(f);
+            }
+        } else {
+            return false;
+        }
+        if (ts.status() != QTextStream::Ok) {
+            return false;
+        }
+    }
+
+    return !entry->filePattern.empty() && !entry->renderedFiles.empty();
+} // PrecompCache::readEntry
+
+bool
+PrecompCache::statFile(bool hashContent,
+                       PrecompCacheFile* file)
+{
+    QFileInfo info( QString::fromUtf8( file->path.c_str() ) );
+
+    if ( !info.exists() ) {
+        return false;
+    }
+    file->size = info.size();
+    file->modificationTime = info.lastModified().toMSecsSinceEpoch();
+    file->contentHash = 0;
+    if (hashContent) {
+        return hashFile(file->path, &file->contentHash);
+    }
+
+    return true;
+}
+
+bool
+PrecompCache::setRenderedFiles(const std::vector<std::string>& viewNames,
+                               PrecompCacheEntry* entry)
+{
+    entry->renderedFiles.clear();
+
+    // Without a view or frame number in the pattern, the same file is shared by all frames and views (e.g a video)
+    std::set<std::string> paths;
+    std::vector<std::string> views = viewNames;
+    if ( views.empty() ) {
+        views.push_back("Main");
+    }
+    for (int frame = entry->firstFrame; frame <= entry->lastFrame; ++frame) {
+        bool frameFound = false;
+        for (std::size_t view = 0; view < views.size(); ++view) {
+            PrecompCacheFile f;
+            f.path = SequenceParsing::generateFileNameFromPattern(entry->filePattern, views, frame, (int)view);
+            if ( paths.find(f.path) != paths.end() ) {
+                frameFound = true;
+                continue;
+            }
+            if ( !statFile(false, &f) ) {
+                continue;
+            }
+            paths.insert(f.path);
+            entry->renderedFiles.push_back(f);
+            frameFound = true;
+        }
+        if (!frameFound) {
+            return false;
+        }
+    }
+
+    return !entry->renderedFiles.empty();
+}
+
+bool
+PrecompCache::areRenderedFilesUpToDate(const PrecompCacheEntry& entry)
+{
+    if ( entry.renderedFiles.empty() ) {
+        return false;
+    }
+    for (std::list<PrecompCacheFile>::const_iterator it = entry.renderedFiles.begin(); it != entry.renderedFiles.end(); ++it) {
+        PrecompCacheFile f;
+        f.path = it->path;
+        if ( !statFile(false, &f) || (f.size != it->size) || (f.modificationTime != it->modificationTime) ) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool
+PrecompCache::isEntryUpToDate(const PrecompCacheEntry& entry,
+                              U64 projectHash)
+{
+    if (entry.projectHash != projectHash) {
+        return false;
+    }
+    for (std::list<PrecompCacheFile>::const_iterator it = entry.dependencies.begin(); it != entry.dependencies.end(); ++it) {
+        PrecompCacheFile f;
+        f.path = it->path;
+        if ( !statFile(true, &f) || (f.contentHash != it->contentHash) ) {
+            return false;
+        }
+    }
+
+    return areRenderedFilesUpToDate(entry);
+}
+
+NATRON_NAMESPACE_EXIT;
@@ -0,0 +1,158 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <http://www.natron.fr/>,
+ * Copyright (C) 2016 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+#ifndef Engine_PrecompCache_h
+#define Engine_PrecompCache_h
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "Global/Macros.h"
+
+#include <list>
+#include <string>
+#include <vector>
+
+#include <QtCore/QString>
+
+#include "Global/GlobalDefines.h"
+
+#include "Engine/EngineFwd.h"
+
+NATRON_NAMESPACE_ENTER;
+
+/**
+ * @brief A file on which a pre-comp render depends, with what is needed to know whether it changed.
+ * Rendered images are compared by size and modification date, sub-projects by the hash of their content.
+ **/
+struct PrecompCacheFile
+{
+    std::string path;
+    qint64 size;
+    qint64 modificationTime;
+    U64 contentHash;
+
+    PrecompCacheFile()
+        : path()
+        , size(0)
+        , modificationTime(0)
+        , contentHash(0)
+    {
+    }
+};
+
+/**
+ * @brief Describes the images pre-rendered by a Write node of a pre-comp project, so that a Precomp node can read them
+ * back in a later session without loading the pre-comp project, as long as neither the project nor the images changed.
+ **/
+struct PrecompCacheEntry
+{
+    // Hash of the content of the pre-comp project file
+    U64 projectHash;
+
+    // Content hash of the tree upstream of the Write node: plug-ins, parameter values and connections.
+    // Unlike the node hashes, it does not depend on the session.
+    U64 treeHash;
+    std::string writeNodeName;
+    int firstFrame, lastFrame;
+
+    // The file pattern of the Write node
+    std::string filePattern;
+
+    // The rendered images
+    std::list<PrecompCacheFile> renderedFiles;
+
+    // Projects of the pre-comps nested in the tree
+    std::list<PrecompCacheFile> dependencies;
+
+    PrecompCacheEntry()
+        : projectHash(0)
+        , treeHash(0)
+        , writeNodeName()
+        , firstFrame(0)
+        , lastFrame(0)
+        , filePattern()
+        , renderedFiles()
+        , dependencies()
+    {
+    }
+};
+
+/**
+ * @brief Persistent storage of the pre-comp renders, one file per pre-comp project, Write node and frame range.
+ * Entries only reference the images rendered by the Write node, they are not copied.
+ **/
+class PrecompCache
+{
+public:
+
+    /**
+     * @brief Hashes the content of the given file. Returns false if it cannot be read.
+     **/
+    static bool hashFile(const std::string& filename, U64* hash);
+
+    /**
+     * @brief Returns the file in which the entry of the given pre-comp render is stored in cacheDir.
+     **/
+    static QString getEntryFilePath(const QString& cacheDir,
+                                    const std::string& projectFilename,
+                                    const std::string& writeNodeName,
+                                    int firstFrame,
+                                    int lastFrame);
+
+    /**
+     * @brief Same as above, in the PrecompCache directory of the disk cache location.
+     **/
+    static QString getEntryFilePath(const std::string& projectFilename,
+                                    const std::string& writeNodeName,
+                                    int firstFrame,
+                                    int lastFrame);
+
+    static bool readEntry(const QString& entryFilePath, PrecompCacheEntry* entry);
+
+    static bool writeEntry(const QString& entryFilePath, const PrecompCacheEntry& entry);
+
+    /**
+     * @brief Fills entry->renderedFiles with the files rendered for each frame of the entry's frame range and each view.
+     * Returns false if no file exists for a frame, e.g because the render was aborted.
+     **/
+    static bool setRenderedFiles(const std::vector<std::string>& viewNames, PrecompCacheEntry* entry);
+
+    /**
+     * @brief Fills the file with the current state of the file at its path. Returns false if it does not exist.
+     **/
+    static bool statFile(bool hashContent, PrecompCacheFile* file);
+
+    /**
+     * @brief Returns true if the images of the entry can be used for the project with the given hash:
+     * the project, the nested pre-comp projects and the rendered images are unchanged.
+     **/
+    static bool isEntryUpToDate(const PrecompCacheEntry& entry, U64 projectHash);
+
+    /**
+     * @brief Same as above, except that the project may have changed: only the rendered images are checked.
+     **/
+    static bool areRenderedFilesUpToDate(const PrecompCacheEntry& entry);
+};
+
+NATRON_NAMESPACE_EXIT;
+
+#endif // Engine_PrecompCache_h
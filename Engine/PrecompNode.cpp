@@ -25,8 +25,19 @@
 #include "PrecompNode.h"
 
 #include <cassert>
+#include <set>
+#include <sstream>
 #include <stdexcept>
 
+#if !defined(Q_MOC_RUN) && !defined(SBK_RUN)
+GCC_DIAG_UNUSED_LOCAL_TYPEDEFS_OFF
+GCC_DIAG_OFF(unused-parameter)
+// /opt/local/include/boost/serialization/smart_cast.hpp:254:25: warning: unused parameter 'u' [-Wunused-parameter]
+#include <boost/archive/xml_oarchive.hpp>
+GCC_DIAG_UNUSED_LOCAL_TYPEDEFS_ON
+GCC_DIAG_ON(unused-parameter)
+#endif
+
 #include "Global/GlobalDefines.h"
 #include "Global/QtCompat.h"
 
@@ -42,9 +53,12 @@ CLANG_DIAG_ON(uninitialized)
 #include "Engine/AppManager.h"
 #include "Engine/CLArgs.h"
 #include "Engine/CreateNodeArgs.h"
+#include "Engine/Hash64.h"
 #include "Engine/Node.h"
+#include "Engine/NodeGroup.h"
 #include "Engine/OutputEffectInstance.h"
 #include "Engine/OutputSchedulerThread.h"
+#include "Engine/PrecompCache.h"
 #include "Engine/KnobTypes.h"
 #include "Engine/KnobFile.h"
 #include "Engine/KnobSerialization.h"
@@ -82,6 +96,10 @@ public:
     NodePtr readNode;
     NodePtr outputNode;
 
+    //False when the pre-rendered images were found in the PrecompCache: the pre-comp project is then only loaded
+    //when a parameter of this node is edited. Only accessed on the main thread.
+    bool projectLoaded;
+
     PrecompNodePrivate(PrecompNode* publicInterface)
         : _publicInterface(publicInterface)
         , app()
@@ -101,6 +119,7 @@ public:
         , precompInputs()
         , readNode()
         , outputNode()
+        , projectLoaded(false)
     {
     }
 
@@ -108,8 +127,20 @@ public:
 
     void reloadProject(bool setWriteNodeChoice);
 
+    void ensureProjectLoaded();
+
+    bool loadFromCache();
+
+    QString getCacheEntryFilePath();
+
+    void updateCacheEntry();
+
+    void checkPreRenderUpToDate();
+
     void createReadNode();
 
+    void createReadNodeForPattern(const std::string& pattern);
+
     void setReadNodeErrorChoice();
 
     void setFirstAndLastFrame();
@@ -330,7 +361,9 @@ PrecompNode::initializeKnobs()
 void
 PrecompNode::onKnobsLoaded()
 {
-    _imp->reloadProject(false);
+    if ( !_imp->loadFromCache() ) {
+        _imp->reloadProject(false);
+    }
     _imp->refreshKnobsVisibility();
 }
 
@@ -343,6 +376,13 @@ PrecompNode::knobChanged(const KnobIPtr& k,
 {
     bool ret = true;
 
+    // The pre-comp project is needed to edit the parameters of this node
+    if ( !_imp->projectLoaded &&
+         ( ( k == _imp->writeNodesKnob.lock() ) || ( k == _imp->preRenderKnob.lock() ) ||
+           ( k == _imp->outputNodeNameKnob.lock() ) || ( k == _imp->enablePreRenderKnob.lock() ) ) ) {
+        _imp->ensureProjectLoaded();
+    }
+
     if ( (reason != eValueChangedReasonTimeChanged) && ( k == _imp->projectFileNameKnob.lock() ) ) {
         _imp->reloadProject(true);
     } else if ( k == _imp->editProjectKnob.lock() ) {
@@ -433,12 +473,211 @@ PrecompNodePrivate::reloadProject(bool setWriteNodeChoice)
     //Switch the timeline to this instance's timeline
     project->setTimeLine( _publicInterface->getApp()->getTimeLine() );
 
+    projectLoaded = true;
+
     populateWriteNodesChoice(true, setWriteNodeChoice);
 
     if (ok) {
         createReadNode();
     }
     refreshOutputNode();
+    if (ok) {
+        checkPreRenderUpToDate();
+    }
+}
+
+void
+PrecompNodePrivate::ensureProjectLoaded()
+{
+    if (!projectLoaded) {
+        reloadProject(false);
+    }
+}
+
+QString
+PrecompNodePrivate::getCacheEntryFilePath()
+{
+    return PrecompCache::getEntryFilePath( projectFileNameKnob.lock()->getValue(),
+                                           writeNodesKnob.lock()->getActiveEntryText_mt_safe(),
+                                           firstFrameKnob.lock()->getValue(),
+                                           lastFrameKnob.lock()->getValue() );
+}
+
+/*
+ * Hashes what the images rendered by node depend on: the plug-ins, parameter values and connections of the tree upstream,
+ * including the trees inside groups and the projects of nested pre-comps, which are added to dependencies.
+ * Unlike the node hashes, this does not depend on the session, so that it can be compared to the hash recorded in the
+ * PrecompCache by a previous session.
+ */
+static void
+appendTreeToHash(const NodePtr& node,
+                 std::set<NodePtr>* visited,
+                 std::list<PrecompCacheFile>* dependencies,
+                 Hash64* hash)
+{
+    if ( !node || !visited->insert(node).second ) {
+        hash->append<int>(-1);
+
+        return;
+    }
+    Hash64_appendQString( hash, QString::fromUtf8( node->getPluginID().c_str() ) );
+    hash->append( node->getMajorVersion() );
+    hash->append( node->getMinorVersion() );
+    Hash64_appendQString( hash, QString::fromUtf8( node->getScriptName_mt_safe().c_str() ) );
+
+    const KnobsVec& knobs = node->getKnobs();
+    for (KnobsVec::const_iterator it = knobs.begin(); it != knobs.end(); ++it) {
+        if ( !(*it)->getIsPersistent() ) {
+            continue;
+        }
+        std::ostringstream ss;
+        try {
+            boost::archive::xml_oarchive oArchive(ss);
+            KnobSerialization serialization(*it);
+            oArchive << boost::serialization::make_nvp("Param", serialization);
+        } catch (...) {
+            // The parameter cannot be compared: make sure the hash never matches a previous one
+            hash->append( (U64)(*it).get() );
+            continue;
+        }
+        Hash64_appendQString( hash, QString::fromUtf8( ss.str().c_str() ) );
+    }
+
+    EffectInstancePtr effect = node->getEffectInstance();
+    PrecompNodePtr isPrecomp = toPrecompNode(effect);
+    if (isPrecomp) {
+        KnobIPtr projectKnob = node->getKnobByName("projectFilename");
+        KnobFilePtr projectFileKnob = toKnobFile(projectKnob);
+        if (projectFileKnob) {
+            PrecompCacheFile f;
+            f.path = projectFileKnob->getValue();
+            if ( PrecompCache::statFile(true, &f) ) {
+                dependencies->push_back(f);
+            }
+            hash->append(f.contentHash);
+        }
+    }
+
+    NodeGroupPtr isGroup = toNodeGroup(effect);
+    if (isGroup) {
+        appendTreeToHash(isGroup->getOutputNode(false), visited, dependencies, hash);
+    }
+
+    int nbInputs = node->getMaxInputCount();
+    hash->append(nbInputs);
+    for (int i = 0; i < nbInputs; ++i) {
+        appendTreeToHash(node->getInput(i), visited, dependencies, hash);
+    }
+} // appendTreeToHash
+
+static U64
+computeTreeHash(const NodePtr& node,
+                std::list<PrecompCacheFile>* dependencies)
+{
+    Hash64 hash;
+    std::set<NodePtr> visited;
+
+    appendTreeToHash(node, &visited, dependencies, &hash);
+    hash.computeHash();
+
+    return hash.value();
+}
+
+bool
+PrecompNodePrivate::loadFromCache()
+{
+    if ( !enablePreRenderKnob.lock()->getValue() ) {
+        return false;
+    }
+    std::string filename = projectFileNameKnob.lock()->getValue();
+    std::string writeNodeName = writeNodesKnob.lock()->getActiveEntryText_mt_safe();
+    if ( writeNodeName.empty() || (writeNodeName == "None") ) {
+        return false;
+    }
+    U64 projectHash;
+    if ( !PrecompCache::hashFile(filename, &projectHash) ) {
+        return false;
+    }
+    PrecompCacheEntry entry;
+    if ( !PrecompCache::readEntry(getCacheEntryFilePath(), &entry) || !PrecompCache::isEntryUpToDate(entry, projectHash) ) {
+        return false;
+    }
+
+    // Neither the project nor the images changed since they were rendered: read them without loading the project
+    QFileInfo file( QString::fromUtf8( filename.c_str() ) );
+    subLabelKnob.lock()->setValue( file.fileName().toStdString() );
+    {
+        std::vector<std::string> choices;
+        choices.push_back("None");
+        choices.push_back(writeNodeName);
+        writeNodesKnob.lock()->populateChoices(choices);
+    }
+    precompInputs.clear();
+    projectLoaded = false;
+    createReadNodeForPattern(entry.filePattern);
+    refreshOutputNode();
+
+    return true;
+}
+
+void
+PrecompNodePrivate::updateCacheEntry()
+{
+    NodePtr writeNode = getWriteNodeFromPreComp();
+    if (!writeNode) {
+        return;
+    }
+    KnobOutputFilePtr fileKnob = toKnobOutputFile( writeNode->getKnobByName(kOfxImageEffectFileParamName) );
+    if (!fileKnob) {
+        return;
+    }
+    PrecompCacheEntry entry;
+    entry.writeNodeName = writeNodesKnob.lock()->getActiveEntryText_mt_safe();
+    entry.firstFrame = firstFrameKnob.lock()->getValue();
+    entry.lastFrame = lastFrameKnob.lock()->getValue();
+    entry.filePattern = fileKnob->getValue();
+    if ( !PrecompCache::hashFile(projectFileNameKnob.lock()->getValue(), &entry.projectHash) ) {
+        return;
+    }
+    entry.treeHash = computeTreeHash(writeNode, &entry.dependencies);
+
+    // Missing images mean that the render failed or was aborted
+    if ( !PrecompCache::setRenderedFiles(app.lock()->getProject()->getProjectViewNames(), &entry) ) {
+        return;
+    }
+    PrecompCache::writeEntry(getCacheEntryFilePath(), entry);
+}
+
+void
+PrecompNodePrivate::checkPreRenderUpToDate()
+{
+    if ( !enablePreRenderKnob.lock()->getValue() ) {
+        return;
+    }
+    NodePtr writeNode = getWriteNodeFromPreComp();
+    if (!writeNode) {
+        return;
+    }
+    QString entryFilePath = getCacheEntryFilePath();
+    PrecompCacheEntry entry;
+    if ( !PrecompCache::readEntry(entryFilePath, &entry) ) {
+        // Never rendered, or by a version without the cache
+        return;
+    }
+    entry.dependencies.clear();
+    U64 treeHash = computeTreeHash(writeNode, &entry.dependencies);
+    if (treeHash != entry.treeHash) {
+        _publicInterface->setPersistentMessage( eMessageTypeWarning,
+                                                tr("The pre-comp project changed since its images were rendered, render them again to update them.").toStdString() );
+
+        return;
+    }
+
+    // Only parts of the project that do not affect the images changed: refresh the entry so that the next sessions do not load the project
+    if ( PrecompCache::areRenderedFilesUpToDate(entry) &&
+         PrecompCache::hashFile(projectFileNameKnob.lock()->getValue(), &entry.projectHash) ) {
+        PrecompCache::writeEntry(entryFilePath, entry);
+    }
 }
 
 void
@@ -558,7 +797,12 @@ PrecompNodePrivate::createReadNode()
         return;
     }
 
-    std::string pattern = fileKnob->getValue();
+    createReadNodeForPattern( fileKnob->getValue() );
+}
+
+void
+PrecompNodePrivate::createReadNodeForPattern(const std::string& pattern)
+{
     QString qpattern = QString::fromUtf8( pattern.c_str() );
     std::string ext = QtCompat::removeFileExtension(qpattern).toLower().toStdString();
     std::string found = appPTR->getReaderPluginIDForFileType(ext);
@@ -599,7 +843,7 @@ PrecompNodePrivate::createReadNode()
         QMutexLocker k(&dataMutex);
         readNode = read;
     }
-} // PrecompNodePrivate::createReadNode
+} // PrecompNodePrivate::createReadNodeForPattern
 
 void
 PrecompNodePrivate::refreshOutputNode()
@@ -700,7 +944,7 @@ PrecompNodePrivate::launchPreRender()
 void
 PrecompNode::onPreRenderFinished()
 {
-    NodePtr output = getOutputNode();
+    NodePtr output = _imp->getWriteNodeFromPreComp();
 
     if (!output) {
         return;
@@ -713,6 +957,8 @@ PrecompNode::onPreRenderFinished()
             QObject::disconnect( engine.get(), SIGNAL(renderFinished(int)), this, SLOT(onPreRenderFinished()) );
         }
     }
+    clearPersistentMessage(false);
+    _imp->updateCacheEntry();
     _imp->refreshReadNodeInput();
 }
 
@@ -54,6 +54,29 @@ ProcessHandler::ProcessHandler(const QString & projectPath,
     , _earlyCancel(false)
     , _processLog()
     , _processArgs()
+{
+    _processArgs << QString::fromUtf8("-b") << QString::fromUtf8("-w") << QString::fromUtf8( writer->getScriptName_mt_safe().c_str() );
+    initializeIPCServer(projectPath);
+}
+
+ProcessHandler::ProcessHandler(const QString & projectPath,
+                               const QStringList& renderArgs)
+    : _process(new QProcess)
+    , _writer()
+    , _ipcServer(0)
+    , _bgProcessOutputSocket(0)
+    , _bgProcessInputSocket(0)
+    , _earlyCancel(false)
+    , _processLog()
+    , _processArgs()
+{
+    _processArgs << QString::fromUtf8("-b");
+    _processArgs << renderArgs;
+    initializeIPCServer(projectPath);
+}
+
+void
+ProcessHandler::initializeIPCServer(const QString& projectPath)
 {
     ///setup the server used to listen the output of the background process
     _ipcServer = new QLocalServer();
@@ -90,7 +113,6 @@ ProcessHandler::ProcessHandler(const QString & projectPath,
     _ipcServer->listen(tmpFileName);
 
 
-    _processArgs << QString::fromUtf8("-b") << QString::fromUtf8("-w") << QString::fromUtf8( writer->getScriptName_mt_safe().c_str() );
     _processArgs << QString::fromUtf8("--IPCpipe") <<  tmpFileName;
     _processArgs << projectPath;
 
@@ -105,7 +127,7 @@ ProcessHandler::ProcessHandler(const QString & projectPath,
     _processLog.push_back( tr("Starting background rendering: %1 %2")
                            .arg( QCoreApplication::applicationFilePath() )
                            .arg( _processArgs.join( QString::fromUtf8(" ") ) ) );
-}
+} // ProcessHandler::initializeIPCServer
 
 ProcessHandler::~ProcessHandler()
 {
@@ -156,10 +178,19 @@ ProcessHandler::onDataWrittenToSocket()
     ///always running in the main thread
     assert( QThread::currentThread() == qApp->thread() );
 
-    QString str = QString::fromUtf8( _bgProcessOutputSocket->readLine() );
-    while ( str.endsWith( QLatin1Char('\n') ) ) {
-        str.chop(1);
+    ///Several messages may have been buffered before readyRead() was emitted: process all of them
+    while ( _bgProcessOutputSocket->canReadLine() ) {
+        QString str = QString::fromUtf8( _bgProcessOutputSocket->readLine() );
+        while ( str.endsWith( QLatin1Char('\n') ) ) {
+            str.chop(1);
+        }
+        processMessage(str);
     }
+}
+
+void
+ProcessHandler::processMessage(QString str)
+{
     _processLog.append( QString::fromUtf8("Message received: ") + str + QLatin1Char('\n') );
     if ( str.startsWith( QString::fromUtf8(kFrameRenderedStringShort) ) ) {
         str = str.remove( QString::fromUtf8(kFrameRenderedStringShort) );
@@ -248,7 +279,12 @@ void
 ProcessHandler::onProcessError(QProcess::ProcessError err)
 {
     if (err == QProcess::FailedToStart) {
-        Dialogs::errorDialog( _writer->getScriptName(), tr("The render process failed to start.").toStdString() );
+        if (_writer) {
+            Dialogs::errorDialog( _writer->getScriptName(), tr("The render process failed to start.").toStdString() );
+        } else {
+            _processLog.append( tr("The render process failed to start.") + QLatin1Char('\n') );
+            Q_EMIT processFinished(1);
+        }
     } else if (err == QProcess::Crashed) {
         //@TODO: find out a way to get the backtrace
     }
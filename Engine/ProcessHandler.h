@@ -106,6 +106,15 @@ public:
     ProcessHandler(const QString & projectPath,
                    const OutputEffectInstancePtr& writer);
 
+    /**
+     * @brief Starts a new process which will load the project specified by "projectPath".
+     * The process will render according to the command-line arguments given in renderArgs
+     * (e.g: -w MyWriter 1-10). The IPC pipe and project path are appended by this class.
+     * This is used by the LocalRenderFarm where no writer instance exists in the main process.
+     **/
+    ProcessHandler(const QString & projectPath,
+                   const QStringList& renderArgs);
+
     virtual ~ProcessHandler();
 
     const QString & getProcessLog() const;
@@ -166,6 +175,15 @@ public Q_SLOTS:
      **/
     void startProcess();
 
+private:
+
+    void initializeIPCServer(const QString& projectPath);
+
+    /**
+     * @brief Interprets a single line written by the background process to the output socket.
+     **/
+    void processMessage(QString str);
+
 Q_SIGNALS:
 
     void deleted();
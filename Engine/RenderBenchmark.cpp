@@ -0,0 +1,438 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <http://www.natron.fr/>,
+ * Copyright (C) 2016 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "RenderBenchmark.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio> // snprintf
+#include <string>
+#include <vector>
+
+#include <QtCore/QMutex>
+
+#include "Global/MemoryInfo.h"
+
+#include "Engine/AppManager.h"
+#include "Engine/Node.h"
+#include "Engine/TaskExecutor.h"
+#include "Engine/Timer.h"
+
+// Number of nodes listed in the report of each run, by decreasing render time
+#define NATRON_RENDER_BENCHMARK_TOP_NODES 10
+
+NATRON_NAMESPACE_ENTER;
+
+NATRON_NAMESPACE_ANONYMOUS_ENTER
+
+struct BenchmarkNodeTotals
+{
+    double timeSpent;
+    int cacheHits, cacheMisses, cacheHitsDownscaled;
+    int inputImagesCopied, inputImagesShared;
+    U64 inputImagesCopiedBytes, inputImagesSharedBytes;
+    int conversionHits, conversionMisses;
+
+    BenchmarkNodeTotals()
+        : timeSpent(0)
+        , cacheHits(0)
+        , cacheMisses(0)
+        , cacheHitsDownscaled(0)
+        , inputImagesCopied(0)
+        , inputImagesShared(0)
+        , inputImagesCopiedBytes(0)
+        , inputImagesSharedBytes(0)
+        , conversionHits(0)
+        , conversionMisses(0)
+    {
+    }
+};
+
+typedef std::map<std::string, BenchmarkNodeTotals> BenchmarkNodeTotalsMap;
+
+struct BenchmarkRun
+{
+    bool coldCache;
+    int nRuns; // > 1 when several warm runs are aggregated
+    double wallTime;
+    std::vector<double> frameTimes;
+    BenchmarkNodeTotalsMap nodes;
+    // The peak RSS is process-wide and never decreases: peakRSSIncrease is how much this run raised it
+    std::size_t processPeakRSS, peakRSSIncrease, currentRSS;
+    // Queue latency of the tasks the TaskExecutor ran during the run, per priority class
+    TaskExecutorStats taskStats[eTaskPriorityCount];
+
+    BenchmarkRun()
+        : coldCache(false)
+        , nRuns(1)
+        , wallTime(0)
+        , frameTimes()
+        , nodes()
+        , processPeakRSS(0)
+        , peakRSSIncrease(0)
+        , currentRSS(0)
+    {
+    }
+};
+
+const char*
+getTaskPriorityName(int priority)
+{
+    switch ( (TaskPriorityEnum)priority ) {
+    case eTaskPriorityCacheDeletion:
+
+        return "cacheDeletion";
+    case eTaskPriorityInteractive:
+
+        return "interactive";
+    case eTaskPriorityPreview:
+
+        return "preview";
+    case eTaskPriorityHousekeeping:
+
+        return "housekeeping";
+    default:
+        break;
+    }
+
+    return "unknown";
+}
+
+bool
+nodeTimeGreater(const std::pair<std::string, BenchmarkNodeTotals>& a,
+                const std::pair<std::string, BenchmarkNodeTotals>& b)
+{
+    return a.second.timeSpent > b.second.timeSpent;
+}
+
+// Nearest-rank percentile of sorted values
+double
+getPercentile(const std::vector<double>& sortedValues,
+              double percent)
+{
+    if ( sortedValues.empty() ) {
+        return 0.;
+    }
+    int rank = (int)std::ceil(percent / 100. * sortedValues.size() ) - 1;
+    rank = std::max( 0, std::min( (int)sortedValues.size() - 1, rank ) );
+
+    return sortedValues[rank];
+}
+
+void
+writeJSONString(std::ostream& os,
+                const std::string& str)
+{
+    os << '"';
+    for (std::size_t i = 0; i < str.size(); ++i) {
+        unsigned char c = (unsigned char)str[i];
+        if ( (c == '"') || (c == '\\') ) {
+            os << '\\' << str[i];
+        } else if (c < 0x20) {
+            char buf[8];
+            snprintf(buf, sizeof(buf), "\\u%04x", (unsigned int)c);
+            os << buf;
+        } else {
+            os << str[i];
+        }
+    }
+    os << '"';
+}
+
+void
+writeJSONNumber(std::ostream& os,
+                double value)
+{
+    char buf[32];
+
+    snprintf(buf, sizeof(buf), "%.9g", value);
+    os << buf;
+}
+
+void
+writeRun(std::ostream& os,
+         const BenchmarkRun& run,
+         const char* indent)
+{
+    std::vector<double> sortedTimes = run.frameTimes;
+
+    std::sort( sortedTimes.begin(), sortedTimes.end() );
+    double sumTimes = 0.;
+    for (std::size_t i = 0; i < sortedTimes.size(); ++i) {
+        sumTimes += sortedTimes[i];
+    }
+    int nFrames = (int)sortedTimes.size();
+
+    int cacheHits = 0, cacheMisses = 0;
+    double nodesTime = 0.;
+    std::vector<std::pair<std::string, BenchmarkNodeTotals> > nodes( run.nodes.begin(), run.nodes.end() );
+    for (std::size_t i = 0; i < nodes.size(); ++i) {
+        cacheHits += nodes[i].second.cacheHits;
+        cacheMisses += nodes[i].second.cacheMisses;
+        nodesTime += nodes[i].second.timeSpent;
+    }
+    std::sort(nodes.begin(), nodes.end(), nodeTimeGreater);
+    if (nodes.size() > NATRON_RENDER_BENCHMARK_TOP_NODES) {
+        nodes.resize(NATRON_RENDER_BENCHMARK_TOP_NODES);
+    }
+
+    os << "{\n";
+    os << indent << "  \"cache\": " << (run.coldCache ? "\"cold\"" : "\"warm\"") << ",\n";
+    os << indent << "  \"runs\": " << run.nRuns << ",\n";
+    os << indent << "  \"frames\": " << nFrames << ",\n";
+    os << indent << "  \"wallTime\": ";
+    writeJSONNumber(os, run.wallTime);
+    os << ",\n" << indent << "  \"framesPerSecond\": ";
+    writeJSONNumber(os, run.wallTime > 0 ? nFrames / run.wallTime : 0.);
+    os << ",\n" << indent << "  \"frameTime\": {";
+    os << "\"mean\": ";
+    writeJSONNumber(os, nFrames ? sumTimes / nFrames : 0.);
+    os << ", \"min\": ";
+    writeJSONNumber(os, nFrames ? sortedTimes.front() : 0.);
+    const double percents[4] = { 50., 90., 95., 99. };
+    for (int i = 0; i < 4; ++i) {
+        os << ", \"p" << (int)percents[i] << "\": ";
+        writeJSONNumber( os, getPercentile(sortedTimes, percents[i]) );
+    }
+    os << ", \"max\": ";
+    writeJSONNumber(os, nFrames ? sortedTimes.back() : 0.);
+    os << "},\n";
+    os << indent << "  \"processPeakRSS\": " << (unsigned long long)run.processPeakRSS << ",\n";
+    os << indent << "  \"peakRSSIncrease\": " << (unsigned long long)run.peakRSSIncrease << ",\n";
+    os << indent << "  \"currentRSS\": " << (unsigned long long)run.currentRSS << ",\n";
+    os << indent << "  \"taskQueues\": {";
+    for (int i = 0; i < eTaskPriorityCount; ++i) {
+        const TaskExecutorStats& taskStats = run.taskStats[i];
+        os << (i == 0 ? "\n" : ",\n") << indent << "    \"" << getTaskPriorityName(i) << "\": {";
+        os << "\"tasksRun\": " << taskStats.nTasksRun;
+        os << ", \"tasksDropped\": " << taskStats.nTasksDropped;
+        os << ", \"meanLatency\": ";
+        writeJSONNumber( os, taskStats.getAverageQueueLatency() );
+        os << ", \"maxLatency\": ";
+        writeJSONNumber(os, taskStats.maxQueueLatency);
+        os << "}";
+    }
+    os << "\n" << indent << "  },\n";
+    os << indent << "  \"cacheHits\": " << cacheHits << ",\n";
+    os << indent << "  \"cacheMisses\": " << cacheMisses << ",\n";
+    os << indent << "  \"cacheHitRate\": ";
+    writeJSONNumber(os, cacheHits + cacheMisses > 0 ? (double)cacheHits / (cacheHits + cacheMisses) : 0.);
+    os << ",\n" << indent << "  \"topNodes\": [";
+    for (std::size_t i = 0; i < nodes.size(); ++i) {
+        const BenchmarkNodeTotals& totals = nodes[i].second;
+        os << (i == 0 ? "\n" : ",\n") << indent << "    {\"name\": ";
+        writeJSONString(os, nodes[i].first);
+        os << ", \"time\": ";
+        writeJSONNumber(os, totals.timeSpent);
+        os << ", \"timeFraction\": ";
+        writeJSONNumber(os, nodesTime > 0 ? totals.timeSpent / nodesTime : 0.);
+        os << ", \"cacheHits\": " << totals.cacheHits;
+        os << ", \"cacheMisses\": " << totals.cacheMisses;
+        os << ", \"cacheHitsDownscaled\": " << totals.cacheHitsDownscaled;
+        os << ", \"inputImagesCopied\": " << totals.inputImagesCopied;
+        os << ", \"inputImagesCopiedBytes\": " << totals.inputImagesCopiedBytes;
+        os << ", \"inputImagesShared\": " << totals.inputImagesShared;
+        os << ", \"inputImagesSharedBytes\": " << totals.inputImagesSharedBytes;
+        os << ", \"conversionHits\": " << totals.conversionHits;
+        os << ", \"conversionMisses\": " << totals.conversionMisses << "}";
+    }
+    if ( !nodes.empty() ) {
+        os << "\n" << indent << "  ";
+    }
+    os << "]\n";
+    os << indent << "}";
+} // writeRun
+
+NATRON_NAMESPACE_ANONYMOUS_EXIT
+
+struct RenderBenchmarkPrivate
+{
+    // Protects runs: frames are added by the render threads
+    mutable QMutex lock;
+    std::vector<BenchmarkRun> runs;
+    TimeLapse runTimer;
+
+    RenderBenchmarkPrivate()
+        : lock()
+        , runs()
+        , runTimer()
+    {
+    }
+};
+
+RenderBenchmark::RenderBenchmark()
+    : _imp( new RenderBenchmarkPrivate() )
+{
+}
+
+RenderBenchmark::~RenderBenchmark()
+{
+}
+
+void
+RenderBenchmark::beginRun(bool coldCache)
+{
+    QMutexLocker k(&_imp->lock);
+
+    _imp->runs.push_back( BenchmarkRun() );
+    _imp->runs.back().coldCache = coldCache;
+    // Baseline, replaced by the peak at the end of the run
+    _imp->runs.back().processPeakRSS = getPeakRSS();
+    TaskExecutor* executor = appPTR ? appPTR->getTaskExecutor() : 0;
+    if (executor) {
+        executor->resetStats();
+    }
+    _imp->runTimer.getTimeElapsedReset();
+}
+
+void
+RenderBenchmark::endRun()
+{
+    QMutexLocker k(&_imp->lock);
+
+    assert( !_imp->runs.empty() );
+    if ( _imp->runs.empty() ) {
+        return;
+    }
+    BenchmarkRun& run = _imp->runs.back();
+    run.wallTime = _imp->runTimer.getTimeElapsedReset();
+    std::size_t peakRSS = getPeakRSS();
+    run.peakRSSIncrease = peakRSS > run.processPeakRSS ? peakRSS - run.processPeakRSS : 0;
+    run.processPeakRSS = peakRSS;
+    run.currentRSS = getCurrentRSS();
+    TaskExecutor* executor = appPTR ? appPTR->getTaskExecutor() : 0;
+    if (executor) {
+        for (int i = 0; i < eTaskPriorityCount; ++i) {
+            executor->getStats( (TaskPriorityEnum)i, &run.taskStats[i] );
+        }
+    }
+}
+
+void
+RenderBenchmark::addFrame(int /*time*/,
+                          ViewIdx /*view*/,
+                          double wallTime,
+                          const std::map<NodePtr, NodeRenderStats>& stats)
+{
+    // Resolve the node names outside of the lock
+    std::vector<std::pair<std::string, BenchmarkNodeTotals> > nodes;
+
+    nodes.reserve( stats.size() );
+    for (std::map<NodePtr, NodeRenderStats>::const_iterator it = stats.begin(); it != stats.end(); ++it) {
+        BenchmarkNodeTotals totals;
+        totals.timeSpent = it->second.getTotalTimeSpentRendering();
+        it->second.getCacheAccessInfos(&totals.cacheMisses, &totals.cacheHits, &totals.cacheHitsDownscaled);
+        it->second.getInputImageCopyInfos(&totals.inputImagesCopied, &totals.inputImagesCopiedBytes, &totals.inputImagesShared, &totals.inputImagesSharedBytes);
+        it->second.getFormatConversionInfos(&totals.conversionHits, &totals.conversionMisses);
+        nodes.push_back( std::make_pair(it->first->getFullyQualifiedName(), totals) );
+    }
+
+    QMutexLocker k(&_imp->lock);
+    if ( _imp->runs.empty() ) {
+        return;
+    }
+    BenchmarkRun& run = _imp->runs.back();
+    run.frameTimes.push_back(wallTime);
+    for (std::size_t i = 0; i < nodes.size(); ++i) {
+        BenchmarkNodeTotals& totals = run.nodes[nodes[i].first];
+        totals.timeSpent += nodes[i].second.timeSpent;
+        totals.cacheHits += nodes[i].second.cacheHits;
+        totals.cacheMisses += nodes[i].second.cacheMisses;
+        totals.cacheHitsDownscaled += nodes[i].second.cacheHitsDownscaled;
+        totals.inputImagesCopied += nodes[i].second.inputImagesCopied;
+        totals.inputImagesCopiedBytes += nodes[i].second.inputImagesCopiedBytes;
+        totals.inputImagesShared += nodes[i].second.inputImagesShared;
+        totals.inputImagesSharedBytes += nodes[i].second.inputImagesSharedBytes;
+        totals.conversionHits += nodes[i].second.conversionHits;
+        totals.conversionMisses += nodes[i].second.conversionMisses;
+    }
+}
+
+int
+RenderBenchmark::getNumRuns() const
+{
+    QMutexLocker k(&_imp->lock);
+
+    return (int)_imp->runs.size();
+}
+
+void
+RenderBenchmark::writeJSON(std::ostream& os) const
+{
+    QMutexLocker k(&_imp->lock);
+
+    os << "{\n";
+    os << "  \"version\": ";
+    writeJSONString(os, NATRON_VERSION_STRING);
+    os << ",\n";
+    os << "  \"runs\": [";
+    for (std::size_t i = 0; i < _imp->runs.size(); ++i) {
+        os << (i == 0 ? "\n    " : ",\n    ");
+        writeRun(os, _imp->runs[i], "    ");
+    }
+    os << "\n  ]";
+
+    // All the warm runs together, which is the figure to compare between versions
+    BenchmarkRun warm;
+    warm.nRuns = 0;
+    for (std::size_t i = 0; i < _imp->runs.size(); ++i) {
+        const BenchmarkRun& run = _imp->runs[i];
+        if (run.coldCache) {
+            continue;
+        }
+        ++warm.nRuns;
+        warm.wallTime += run.wallTime;
+        warm.frameTimes.insert( warm.frameTimes.end(), run.frameTimes.begin(), run.frameTimes.end() );
+        for (BenchmarkNodeTotalsMap::const_iterator it = run.nodes.begin(); it != run.nodes.end(); ++it) {
+            BenchmarkNodeTotals& totals = warm.nodes[it->first];
+            totals.timeSpent += it->second.timeSpent;
+            totals.cacheHits += it->second.cacheHits;
+            totals.cacheMisses += it->second.cacheMisses;
+            totals.cacheHitsDownscaled += it->second.cacheHitsDownscaled;
+            totals.inputImagesCopied += it->second.inputImagesCopied;
+            totals.inputImagesCopiedBytes += it->second.inputImagesCopiedBytes;
+            totals.inputImagesShared += it->second.inputImagesShared;
+            totals.inputImagesSharedBytes += it->second.inputImagesSharedBytes;
+            totals.conversionHits += it->second.conversionHits;
+            totals.conversionMisses += it->second.conversionMisses;
+        }
+        warm.processPeakRSS = std::max(warm.processPeakRSS, run.processPeakRSS);
+        warm.peakRSSIncrease += run.peakRSSIncrease;
+        for (int p = 0; p < eTaskPriorityCount; ++p) {
+            TaskExecutorStats& taskStats = warm.taskStats[p];
+            taskStats.nTasksRun += run.taskStats[p].nTasksRun;
+            taskStats.nTasksDropped += run.taskStats[p].nTasksDropped;
+            taskStats.totalQueueLatency += run.taskStats[p].totalQueueLatency;
+            taskStats.maxQueueLatency = std::max(taskStats.maxQueueLatency, run.taskStats[p].maxQueueLatency);
+        }
+        warm.currentRSS = run.currentRSS;
+    }
+    if (warm.nRuns > 0) {
+        os << ",\n  \"warm\": ";
+        writeRun(os, warm, "  ");
+    }
+    os << "\n}\n";
+} // RenderBenchmark::writeJSON
+
+NATRON_NAMESPACE_EXIT;
@@ -0,0 +1,93 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <http://www.natron.fr/>,
+ * Copyright (C) 2016 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+#ifndef Engine_RenderBenchmark_h
+#define Engine_RenderBenchmark_h
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "Global/Macros.h"
+
+#include <map>
+#include <ostream>
+
+#if !defined(Q_MOC_RUN) && !defined(SBK_RUN)
+#include <boost/scoped_ptr.hpp>
+#endif
+
+#include "Engine/EngineFwd.h"
+#include "Engine/RenderStats.h"
+#include "Engine/ViewIdx.h"
+
+NATRON_NAMESPACE_ENTER;
+
+/**
+ * @brief Collects the timings of the renders made by NatronRenderer --benchmark.
+ * The writers are rendered several times in a row: each render is a "run", the first one being made
+ * with all the caches cleared (cold) and the next ones with the caches left by the previous runs (warm).
+ * For each run, this records the wall-clock time of each frame, the time spent in each node, the
+ * image cache hits and misses of each node and the memory use of the process, and reports them
+ * (per run and aggregated over the warm runs) in JSON format so that they can be compared between versions.
+ **/
+struct RenderBenchmarkPrivate;
+class RenderBenchmark
+{
+public:
+
+    RenderBenchmark();
+
+    ~RenderBenchmark();
+
+    /**
+     * @brief Starts recording a new run. coldCache should be true if the caches were cleared before it.
+     **/
+    void beginRun(bool coldCache);
+
+    /**
+     * @brief Ends the current run: its wall-clock time, the memory use of the process and the queue latency
+     * of the tasks run by the TaskExecutor in each priority class are recorded.
+     **/
+    void endRun();
+
+    /**
+     * @brief Records a rendered frame (one view of it) in the current run.
+     * wallTime is the time in seconds spent rendering the frame and stats the per-node breakdown,
+     * as returned by RenderStats::getStats().
+     * This is thread-safe: it is called by the render threads.
+     **/
+    void addFrame(int time,
+                  ViewIdx view,
+                  double wallTime,
+                  const std::map<NodePtr, NodeRenderStats>& stats);
+
+    int getNumRuns() const;
+
+    void writeJSON(std::ostream& os) const;
+
+private:
+
+    boost::scoped_ptr<RenderBenchmarkPrivate> _imp;
+};
+
+NATRON_NAMESPACE_EXIT;
+
+#endif // Engine_RenderBenchmark_h
@@ -42,6 +42,9 @@ struct NodeRenderStatsPrivate
     //The accumulated time spent in the EffectInstance::renderHandler function
     double totalTimeSpentRendering;
 
+    //The accumulated time spent waiting for another render to release the OpenGL context
+    double totalTimeSpentWaitingForGLContext;
+
     //The region of definition of the node for this frame
     RectD rod;
 
@@ -65,6 +68,16 @@ struct NodeRenderStatsPrivate
     int nbCacheHit;
     int nbCacheHitButDownscaledImages;
 
+    //Input images given to the plug-in: copied to a local buffer, or shared with the cache
+    int nbInputImagesCopied;
+    U64 inputImagesCopiedBytes;
+    int nbInputImagesShared;
+    U64 inputImagesSharedBytes;
+
+    //Input planes format conversions: found already converted in the cache, or converted
+    int nbFormatConversionHits;
+    int nbFormatConversionMisses;
+
     //Is tile support enabled for this render
     bool tileSupportEnabled;
 
@@ -79,6 +92,7 @@ struct NodeRenderStatsPrivate
 
     NodeRenderStatsPrivate()
         : totalTimeSpentRendering(0)
+        , totalTimeSpentWaitingForGLContext(0)
         , rod()
         , isWholeImageIdentity()
         , rectanglesRendered()
@@ -88,6 +102,12 @@ struct NodeRenderStatsPrivate
         , nbCacheMisses(0)
         , nbCacheHit(0)
         , nbCacheHitButDownscaledImages(0)
+        , nbInputImagesCopied(0)
+        , inputImagesCopiedBytes(0)
+        , nbInputImagesShared(0)
+        , inputImagesSharedBytes(0)
+        , nbFormatConversionHits(0)
+        , nbFormatConversionMisses(0)
         , tileSupportEnabled(false)
         , renderScaleSupportEnabled(false)
         , channelsEnabled()
@@ -118,6 +138,7 @@ void
 NodeRenderStats::operator=(const NodeRenderStats& other)
 {
     _imp->totalTimeSpentRendering = other._imp->totalTimeSpentRendering;
+    _imp->totalTimeSpentWaitingForGLContext = other._imp->totalTimeSpentWaitingForGLContext;
     _imp->rod = other._imp->rod;
     _imp->isWholeImageIdentity = other._imp->isWholeImageIdentity;
     _imp->rectanglesRendered = other._imp->rectanglesRendered;
@@ -127,6 +148,12 @@ NodeRenderStats::operator=(const NodeRenderStats& other)
     _imp->nbCacheMisses = other._imp->nbCacheMisses;
     _imp->nbCacheHit = other._imp->nbCacheHit;
     _imp->nbCacheHitButDownscaledImages = other._imp->nbCacheHitButDownscaledImages;
+    _imp->nbInputImagesCopied = other._imp->nbInputImagesCopied;
+    _imp->inputImagesCopiedBytes = other._imp->inputImagesCopiedBytes;
+    _imp->nbInputImagesShared = other._imp->nbInputImagesShared;
+    _imp->inputImagesSharedBytes = other._imp->inputImagesSharedBytes;
+    _imp->nbFormatConversionHits = other._imp->nbFormatConversionHits;
+    _imp->nbFormatConversionMisses = other._imp->nbFormatConversionMisses;
     _imp->tileSupportEnabled = other._imp->tileSupportEnabled;
     _imp->renderScaleSupportEnabled = other._imp->renderScaleSupportEnabled;
     for (int i = 0; i < 4; ++i) {
@@ -147,6 +174,18 @@ NodeRenderStats::getTotalTimeSpentRendering() const
     return _imp->totalTimeSpentRendering;
 }
 
+void
+NodeRenderStats::addTimeSpentWaitingForOpenGLContext(double time)
+{
+    _imp->totalTimeSpentWaitingForGLContext += time;
+}
+
+double
+NodeRenderStats::getTotalTimeSpentWaitingForOpenGLContext() const
+{
+    return _imp->totalTimeSpentWaitingForGLContext;
+}
+
 const RectD&
 NodeRenderStats::getRoD() const
 {
@@ -253,6 +292,49 @@ NodeRenderStats::getCacheAccessInfos(int* nbCacheMisses,
     *nbCacheHitButDownscaledImages = _imp->nbCacheHitButDownscaledImages;
 }
 
+void
+NodeRenderStats::addInputImageCopyInfo(bool copied,
+                                       U64 bytes)
+{
+    if (copied) {
+        ++_imp->nbInputImagesCopied;
+        _imp->inputImagesCopiedBytes += bytes;
+    } else {
+        ++_imp->nbInputImagesShared;
+        _imp->inputImagesSharedBytes += bytes;
+    }
+}
+
+void
+NodeRenderStats::getInputImageCopyInfos(int* nbCopied,
+                                        U64* copiedBytes,
+                                        int* nbShared,
+                                        U64* sharedBytes) const
+{
+    *nbCopied = _imp->nbInputImagesCopied;
+    *copiedBytes = _imp->inputImagesCopiedBytes;
+    *nbShared = _imp->nbInputImagesShared;
+    *sharedBytes = _imp->inputImagesSharedBytes;
+}
+
+void
+NodeRenderStats::addFormatConversionInfo(bool isCacheHit)
+{
+    if (isCacheHit) {
+        ++_imp->nbFormatConversionHits;
+    } else {
+        ++_imp->nbFormatConversionMisses;
+    }
+}
+
+void
+NodeRenderStats::getFormatConversionInfos(int* nbHits,
+                                          int* nbMisses) const
+{
+    *nbHits = _imp->nbFormatConversionHits;
+    *nbMisses = _imp->nbFormatConversionMisses;
+}
+
 void
 NodeRenderStats::setTilesSupported(bool tilesSupported)
 {
@@ -414,6 +496,31 @@ RenderStats::addCacheInfosForNode(const NodePtr& node,
     stats.addCacheAccessInfo(isCacheMiss, hasDownscaled);
 }
 
+void
+RenderStats::addInputImageCopyInfosForNode(const NodePtr& node,
+                                           bool copied,
+                                           U64 bytes)
+{
+    QMutexLocker k(&_imp->lock);
+
+    assert(_imp->doNodesProfiling);
+
+    NodeRenderStats& stats = _imp->findOrCreateNodeStats(node);
+    stats.addInputImageCopyInfo(copied, bytes);
+}
+
+void
+RenderStats::addFormatConversionInfosForNode(const NodePtr& node,
+                                             bool isCacheHit)
+{
+    QMutexLocker k(&_imp->lock);
+
+    assert(_imp->doNodesProfiling);
+
+    NodeRenderStats& stats = _imp->findOrCreateNodeStats(node);
+    stats.addFormatConversionInfo(isCacheHit);
+}
+
 void
 RenderStats::addRenderInfosForNode(const NodePtr& node,
                                    const NodePtr& identity,
@@ -435,6 +542,16 @@ RenderStats::addRenderInfosForNode(const NodePtr& node,
     stats.addPlaneRendered(plane);
 }
 
+void
+RenderStats::addOpenGLContextWaitTimeForNode(const NodePtr& node,
+                                             double timeSpent)
+{
+    QMutexLocker k(&_imp->lock);
+
+    NodeRenderStats& stats = _imp->findOrCreateNodeStats(node);
+    stats.addTimeSpentWaitingForOpenGLContext(timeSpent);
+}
+
 std::map<NodePtr, NodeRenderStats >
 RenderStats::getStats(double *totalTimeSpent) const
 {
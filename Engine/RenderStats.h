@@ -66,6 +66,9 @@ public:
     void addTimeSpentRendering(double time);
     double getTotalTimeSpentRendering() const;
 
+    void addTimeSpentWaitingForOpenGLContext(double time);
+    double getTotalTimeSpentWaitingForOpenGLContext() const;
+
     const RectD& getRoD() const;
     void setRoD(const RectD& rod);
 
@@ -87,6 +90,20 @@ public:
     void addCacheAccessInfo(bool isCacheMiss, bool hasDownscaled);
     void getCacheAccessInfos(int* nbCacheMisses, int* nbCacheHits, int* nbCacheHitButDownscaledImages) const;
 
+    /**
+     * @brief Records an input image handed to the plug-in, either copied to a buffer local to the plug-in
+     * or shared with the cache. Shared images account for the copies that were avoided.
+     **/
+    void addInputImageCopyInfo(bool copied, U64 bytes);
+    void getInputImageCopyInfos(int* nbCopied, U64* copiedBytes, int* nbShared, U64* sharedBytes) const;
+
+    /**
+     * @brief Records a conversion of an image to the components/bit depth requested by a consumer. A cache hit means
+     * the converted image was already in the cache for the region needed.
+     **/
+    void addFormatConversionInfo(bool isCacheHit);
+    void getFormatConversionInfos(int* nbHits, int* nbMisses) const;
+
     void setTilesSupported(bool tilesSupported);
     bool isTilesSupportEnabled() const;
 
@@ -136,12 +153,25 @@ public:
                               bool isCacheMiss,
                               bool hasDownscaled);
 
+    void addInputImageCopyInfosForNode(const NodePtr& node,
+                                       bool copied,
+                                       U64 bytes);
+
+    void addFormatConversionInfosForNode(const NodePtr& node,
+                                         bool isCacheHit);
+
     void addRenderInfosForNode(const NodePtr& node,
                                const NodePtr& identity,
                                const std::string& plane,
                                const RectI& rectangle,
                                double timeSpent);
 
+    /**
+     * @brief Unlike the other per-node infos, this is recorded even without in-depth profiling.
+     **/
+    void addOpenGLContextWaitTimeForNode(const NodePtr& node,
+                                         double timeSpent);
+
     std::map<NodePtr, NodeRenderStats > getStats(double *totalTimeSpent) const;
 
 private:
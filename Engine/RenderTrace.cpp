@@ -0,0 +1,333 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <http://www.natron.fr/>,
+ * Copyright (C) 2016 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "RenderTrace.h"
+
+#include <list>
+#include <vector>
+#include <sstream>
+#include <cstdio> // snprintf
+
+#if !defined(Q_MOC_RUN) && !defined(SBK_RUN)
+#include <boost/shared_ptr.hpp>
+#endif
+
+#include <QtCore/QAtomicInt>
+#include <QtCore/QCoreApplication>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QMutex>
+#include <QtCore/QThread>
+
+#include "Engine/EffectInstance.h"
+#include "Engine/FStreamsSupport.h"
+#include "Engine/ThreadPool.h"
+#include "Engine/ThreadStorage.h"
+
+// Beyond this number of events a thread stops recording, so that a forgotten trace cannot eat all the memory
+#define NATRON_RENDER_TRACE_MAX_EVENTS_PER_THREAD 1000000
+
+NATRON_NAMESPACE_ENTER;
+
+NATRON_NAMESPACE_ANONYMOUS_ENTER
+
+struct TraceEvent
+{
+    const char* category;
+    const char* name;
+    std::string nodeName;
+    std::string detail;
+    qint64 start;
+    qint64 duration;
+};
+
+struct TraceThreadBuffer
+{
+    // Only contended when writing the file
+    QMutex mutex;
+    int tid;
+    std::string threadName;
+    std::vector<TraceEvent> events;
+    int nDroppedEvents;
+
+    TraceThreadBuffer()
+        : mutex()
+        , tid(0)
+        , threadName()
+        , events()
+        , nDroppedEvents(0)
+    {
+    }
+};
+
+typedef boost::shared_ptr<TraceThreadBuffer> TraceThreadBufferPtr;
+
+struct TraceThreadData
+{
+    TraceThreadBufferPtr buffer;
+};
+
+struct RenderTraceGlobals
+{
+    QAtomicInt enabled;
+    QElapsedTimer clock;
+
+    // Protects buffers and nextTid
+    QMutex buffersMutex;
+
+    // Buffers are kept here so that events of threads that exited are still written
+    std::list<TraceThreadBufferPtr> buffers;
+    int nextTid;
+    ThreadStorage<TraceThreadData> tls;
+
+    RenderTraceGlobals()
+        : enabled()
+        , clock()
+        , buffersMutex()
+        , buffers()
+        , nextTid(1)
+        , tls()
+    {
+    }
+};
+
+RenderTraceGlobals traceGlobals;
+
+TraceThreadBufferPtr
+getOrCreateThreadBuffer()
+{
+    TraceThreadData& data = traceGlobals.tls.localData();
+
+    if (data.buffer) {
+        return data.buffer;
+    }
+    data.buffer.reset(new TraceThreadBuffer);
+
+    QThread* thread = QThread::currentThread();
+    if ( qApp && (thread == qApp->thread()) ) {
+        data.buffer->threadName = "Main Thread";
+    } else {
+        AbortableThread* isAbortable = dynamic_cast<AbortableThread*>(thread);
+        if (isAbortable) {
+            data.buffer->threadName = isAbortable->getThreadName();
+        } else if (thread) {
+            data.buffer->threadName = thread->objectName().toStdString();
+        }
+    }
+
+    QMutexLocker k(&traceGlobals.buffersMutex);
+    data.buffer->tid = traceGlobals.nextTid++;
+    traceGlobals.buffers.push_back(data.buffer);
+
+    return data.buffer;
+}
+
+void
+writeJSONString(std::ostream& os,
+                const std::string& str)
+{
+    os << '"';
+    for (std::size_t i = 0; i < str.size(); ++i) {
+        unsigned char c = (unsigned char)str[i];
+        switch (c) {
+        case '"':
+            os << "\\\"";
+            break;
+        case '\\':
+            os << "\\\\";
+            break;
+        case '\n':
+            os << "\\n";
+            break;
+        case '\t':
+            os << "\\t";
+            break;
+        default:
+            if (c < 0x20) {
+                char buf[8];
+                snprintf(buf, sizeof(buf), "\\u%04x", (unsigned int)c);
+                os << buf;
+            } else {
+                os << str[i];
+            }
+            break;
+        }
+    }
+    os << '"';
+}
+
+NATRON_NAMESPACE_ANONYMOUS_EXIT
+
+
+void
+RenderTrace::setEnabled(bool enabled)
+{
+    if (enabled) {
+        QMutexLocker k(&traceGlobals.buffersMutex);
+        if ( !traceGlobals.clock.isValid() ) {
+            traceGlobals.clock.start();
+        }
+    }
+    traceGlobals.enabled = enabled ? 1 : 0;
+}
+
+bool
+RenderTrace::isEnabled()
+{
+    return (int)traceGlobals.enabled != 0;
+}
+
+void
+RenderTrace::clear()
+{
+    QMutexLocker k(&traceGlobals.buffersMutex);
+
+    for (std::list<TraceThreadBufferPtr>::iterator it = traceGlobals.buffers.begin(); it != traceGlobals.buffers.end(); ++it) {
+        QMutexLocker l(&(*it)->mutex);
+        (*it)->events.clear();
+        (*it)->nDroppedEvents = 0;
+    }
+}
+
+qint64
+RenderTrace::getTimestamp()
+{
+    if ( !traceGlobals.clock.isValid() ) {
+        return 0;
+    }
+
+    return traceGlobals.clock.nsecsElapsed() / 1000;
+}
+
+void
+RenderTrace::addEvent(const char* category,
+                      const char* name,
+                      const std::string& nodeName,
+                      const std::string& detail,
+                      qint64 startUs,
+                      qint64 durationUs)
+{
+    TraceThreadBufferPtr buffer = getOrCreateThreadBuffer();
+    QMutexLocker k(&buffer->mutex);
+
+    if (buffer->events.size() >= NATRON_RENDER_TRACE_MAX_EVENTS_PER_THREAD) {
+        ++buffer->nDroppedEvents;
+
+        return;
+    }
+    TraceEvent e;
+    e.category = category;
+    e.name = name;
+    e.nodeName = nodeName;
+    e.detail = detail;
+    e.start = startUs;
+    e.duration = durationUs;
+    buffer->events.push_back(e);
+}
+
+bool
+RenderTrace::writeToFile(const std::string& filePath,
+                         std::string* error)
+{
+    FStreamsSupport::ofstream ofile;
+
+    FStreamsSupport::open(&ofile, filePath);
+    if (!ofile) {
+        *error = "Failed to open " + filePath + " for writing";
+
+        return false;
+    }
+
+    qint64 pid = QCoreApplication::applicationPid();
+    std::list<TraceThreadBufferPtr> buffers;
+    {
+        QMutexLocker k(&traceGlobals.buffersMutex);
+        buffers = traceGlobals.buffers;
+    }
+
+    ofile << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    bool first = true;
+    for (std::list<TraceThreadBufferPtr>::iterator it = buffers.begin(); it != buffers.end(); ++it) {
+        QMutexLocker k(&(*it)->mutex);
+        if (!first) {
+            ofile << ",";
+        }
+        first = false;
+        ofile << "\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" << pid << ",\"tid\":" << (*it)->tid << ",\"args\":{\"name\":";
+        writeJSONString(ofile, (*it)->threadName);
+        ofile << ",\"droppedEvents\":" << (*it)->nDroppedEvents << "}}";
+
+        for (std::vector<TraceEvent>::const_iterator it2 = (*it)->events.begin(); it2 != (*it)->events.end(); ++it2) {
+            ofile << ",\n{\"name\":";
+            writeJSONString(ofile, it2->name);
+            ofile << ",\"cat\":";
+            writeJSONString(ofile, it2->category);
+            ofile << ",\"ph\":\"X\",\"ts\":" << it2->start << ",\"dur\":" << it2->duration;
+            ofile << ",\"pid\":" << pid << ",\"tid\":" << (*it)->tid << ",\"args\":{\"node\":";
+            writeJSONString(ofile, it2->nodeName);
+            if ( !it2->detail.empty() ) {
+                ofile << ",\"detail\":";
+                writeJSONString(ofile, it2->detail);
+            }
+            ofile << "}}";
+        }
+    }
+    ofile << "\n]}\n";
+
+    if (!ofile) {
+        *error = "Failed to write " + filePath;
+
+        return false;
+    }
+
+    return true;
+} // RenderTrace::writeToFile
+
+RenderTraceScope::RenderTraceScope(const char* category,
+                                   const char* name,
+                                   const EffectInstance* effect)
+    : _active( RenderTrace::isEnabled() )
+    , _category(category)
+    , _name(name)
+    , _nodeName()
+    , _detail()
+    , _start(0)
+{
+    if (!_active) {
+        return;
+    }
+    if (effect) {
+        _nodeName = effect->getScriptName_mt_safe();
+    }
+    _start = RenderTrace::getTimestamp();
+}
+
+RenderTraceScope::~RenderTraceScope()
+{
+    if (!_active) {
+        return;
+    }
+    RenderTrace::addEvent(_category, _name, _nodeName, _detail, _start, RenderTrace::getTimestamp() - _start);
+}
+
+NATRON_NAMESPACE_EXIT;
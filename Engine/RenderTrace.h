@@ -0,0 +1,119 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <http://www.natron.fr/>,
+ * Copyright (C) 2016 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+#ifndef Engine_RenderTrace_h
+#define Engine_RenderTrace_h
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "Global/Macros.h"
+
+#include <string>
+
+#include <QtCore/QtGlobal> // qint64
+
+#include "Engine/EngineFwd.h"
+
+NATRON_NAMESPACE_ENTER;
+
+/**
+ * @brief Opt-in recording of a timeline of the render activity: each thread records begin/end events
+ * for plug-in actions, cache lookups, tiles dispatched and waits on the Python GIL.
+ * The timeline can be written as a trace-event JSON file that can be opened with chrome://tracing or
+ * https://ui.perfetto.dev to find stalls and serialization points in a render.
+ *
+ * When disabled, recording an event costs an atomic load. When enabled, each thread appends to its own
+ * buffer so that threads do not contend with each other.
+ **/
+class RenderTrace
+{
+public:
+
+    static void setEnabled(bool enabled);
+
+    static bool isEnabled();
+
+    /**
+     * @brief Remove all events recorded so far.
+     **/
+    static void clear();
+
+    /**
+     * @brief Returns the time in microseconds elapsed since tracing was first enabled.
+     **/
+    static qint64 getTimestamp();
+
+    /**
+     * @brief Record an event of the calling thread. category and name must be string literals.
+     **/
+    static void addEvent(const char* category,
+                         const char* name,
+                         const std::string& nodeName,
+                         const std::string& detail,
+                         qint64 startUs,
+                         qint64 durationUs);
+
+    /**
+     * @brief Write all recorded events to filePath in the trace-event JSON format.
+     * @returns False and sets error if the file could not be written.
+     **/
+    static bool writeToFile(const std::string& filePath, std::string* error);
+};
+
+/**
+ * @brief Records an event spanning the lifetime of this object on the calling thread if tracing is enabled.
+ * category and name must be string literals.
+ **/
+class RenderTraceScope
+{
+    bool _active;
+    const char* _category;
+    const char* _name;
+    std::string _nodeName;
+    std::string _detail;
+    qint64 _start;
+
+public:
+
+    RenderTraceScope(const char* category,
+                     const char* name,
+                     const EffectInstance* effect = 0);
+
+    ~RenderTraceScope();
+
+    /**
+     * @brief Returns whether the event is recorded. Use it to avoid computing the detail string when not tracing.
+     **/
+    bool isActive() const
+    {
+        return _active;
+    }
+
+    void setDetail(const std::string& detail)
+    {
+        _detail = detail;
+    }
+};
+
+NATRON_NAMESPACE_EXIT;
+
+#endif // Engine_RenderTrace_h
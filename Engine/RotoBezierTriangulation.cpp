@@ -24,8 +24,16 @@
 
 #include "RotoBezierTriangulation.h"
 
+#include <list>
+
+#include <QtCore/QMutex>
+
 #include "libtess.h"
 
+// Number of (time, mipmap level, feather distance) triangulations kept per item.
+// This covers motion-blur samples and a few frames around the current one during playback.
+#define NATRON_ROTO_TRIANGULATION_CACHE_MAX_ENTRIES 32
+
 NATRON_NAMESPACE_ENTER;
 
 NATRON_NAMESPACE_ANONYMOUS_ENTER;
@@ -391,4 +399,92 @@ RotoBezierTriangulation::computeTriangles(const Bezier * bezier, double time, un
     
 } // RotoBezierTriangulation::computeTriangles
 
-NATRON_NAMESPACE_EXIT;
\ No newline at end of file
+struct RotoBezierTriangulationCacheEntry
+{
+    const Bezier* bezier;
+    double time;
+    unsigned int mipmapLevel;
+    double featherDist;
+    RotoBezierTriangulation::PolygonDataConstPtr data;
+};
+
+struct RotoBezierTriangulationCachePrivate
+{
+    // Protects all fields below
+    QMutex lock;
+
+    // The hash of the item for which the entries were computed
+    U64 hash;
+
+    // Most recently used entries first
+    std::list<RotoBezierTriangulationCacheEntry> entries;
+
+    RotoBezierTriangulationCachePrivate()
+    : lock()
+    , hash(0)
+    , entries()
+    {
+    }
+};
+
+RotoBezierTriangulationCache::RotoBezierTriangulationCache()
+: _imp(new RotoBezierTriangulationCachePrivate())
+{
+}
+
+RotoBezierTriangulationCache::~RotoBezierTriangulationCache()
+{
+}
+
+RotoBezierTriangulation::PolygonDataConstPtr
+RotoBezierTriangulationCache::getOrComputeTriangles(const Bezier* bezier,
+                                                    U64 itemHash,
+                                                    double time,
+                                                    unsigned int mipmapLevel,
+                                                    double featherDist)
+{
+    {
+        QMutexLocker k(&_imp->lock);
+        if (_imp->hash != itemHash) {
+            _imp->entries.clear();
+            _imp->hash = itemHash;
+        }
+        for (std::list<RotoBezierTriangulationCacheEntry>::iterator it = _imp->entries.begin(); it != _imp->entries.end(); ++it) {
+            if (it->bezier == bezier && it->time == time && it->mipmapLevel == mipmapLevel && it->featherDist == featherDist) {
+                // Move the entry to the front so it is the last one to be evicted
+                _imp->entries.splice(_imp->entries.begin(), _imp->entries, it);
+                return _imp->entries.front().data;
+            }
+        }
+    }
+
+    // Do not hold the lock while tesselating: other threads may be rendering another time of the same item.
+    // If two threads compute the same entry concurrently, they both get a valid result and only one is kept.
+    boost::shared_ptr<RotoBezierTriangulation::PolygonData> data(new RotoBezierTriangulation::PolygonData);
+    RotoBezierTriangulation::computeTriangles(bezier, time, mipmapLevel, featherDist, data.get());
+
+    RotoBezierTriangulationCacheEntry entry;
+    entry.bezier = bezier;
+    entry.time = time;
+    entry.mipmapLevel = mipmapLevel;
+    entry.featherDist = featherDist;
+    entry.data = data;
+
+    QMutexLocker k(&_imp->lock);
+    if (_imp->hash == itemHash) {
+        _imp->entries.push_front(entry);
+        while (_imp->entries.size() > NATRON_ROTO_TRIANGULATION_CACHE_MAX_ENTRIES) {
+            _imp->entries.pop_back();
+        }
+    }
+    return entry.data;
+} // RotoBezierTriangulationCache::getOrComputeTriangles
+
+void
+RotoBezierTriangulationCache::clear()
+{
+    QMutexLocker k(&_imp->lock);
+    _imp->entries.clear();
+}
+
+NATRON_NAMESPACE_EXIT;
@@ -30,9 +30,11 @@
 
 #if !defined(Q_MOC_RUN) && !defined(SBK_RUN)
 #include <boost/scoped_ptr.hpp>
+#include <boost/shared_ptr.hpp>
 #endif
 
 #include <vector>
+#include "Global/GlobalDefines.h"
 #include "Engine/EngineFwd.h"
 
 #include "Engine/Bezier.h"
@@ -100,10 +102,46 @@ public:
         unsigned int error;
     };
 
+    typedef boost::shared_ptr<const PolygonData> PolygonDataConstPtr;
+
     static void computeTriangles(const Bezier * bezier, double time, unsigned int mipmapLevel,  double featherDist, PolygonData* outArgs);
 
 };
 
+/**
+ * @brief Keeps the triangulation computed by RotoBezierTriangulation::computeTriangles around so that
+ * rendering the same shape again at the same time, mipmap level and feather distance (e.g. for another RoI,
+ * or from the OpenGL and CPU paths) does not re-discretize and re-tesselate the bezier.
+ * Entries are invalidated as a whole as soon as the hash of the item changes.
+ * This class is thread-safe.
+ **/
+struct RotoBezierTriangulationCachePrivate;
+class RotoBezierTriangulationCache
+{
+public:
+
+    RotoBezierTriangulationCache();
+
+    ~RotoBezierTriangulationCache();
+
+    /**
+     * @brief Returns the triangulation of the given bezier, computing it if it is not cached yet.
+     * @param itemHash The hash of the node rendering the item: when it differs from the hash
+     * of the cached entries, they are all discarded.
+     **/
+    RotoBezierTriangulation::PolygonDataConstPtr getOrComputeTriangles(const Bezier* bezier,
+                                                                       U64 itemHash,
+                                                                       double time,
+                                                                       unsigned int mipmapLevel,
+                                                                       double featherDist);
+
+    void clear();
+
+private:
+
+    boost::scoped_ptr<RotoBezierTriangulationCachePrivate> _imp;
+};
+
 NATRON_NAMESPACE_EXIT;
 
 #endif // ROTOBEZIERTRIANGULATION_H
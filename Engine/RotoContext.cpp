@@ -44,8 +44,6 @@ GCC_DIAG_UNUSED_LOCAL_TYPEDEFS_OFF
 #include <boost/math/special_functions/fpclassify.hpp>
 GCC_DIAG_UNUSED_LOCAL_TYPEDEFS_ON
 
-#define ROTO_CAIRO_RENDER_TRIANGLES_ONLY
-
 
 
 #include "Global/MemoryInfo.h"
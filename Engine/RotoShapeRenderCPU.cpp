@@ -0,0 +1,615 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <http://www.natron.fr/>,
+ * Copyright (C) 2016 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "RotoShapeRenderCPU.h"
+
+#include <algorithm> // min, max
+#include <cmath>
+#include <cstring> // memset
+#include <vector>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include <QtConcurrentMap> // QtCore on Qt4, QtConcurrent on Qt5
+
+#if !defined(Q_MOC_RUN) && !defined(SBK_RUN)
+#include <boost/bind.hpp>
+#endif
+
+#include "Engine/Bezier.h"
+#include "Engine/Image.h"
+#include "Engine/KnobTypes.h"
+
+// Number of rows of the RoI rasterized by each task
+#define NATRON_ROTO_CPU_RENDER_BAND_HEIGHT 32
+
+// Number of intervals of the table inverting the Cairo feather fall-off
+#define NATRON_ROTO_CPU_FALLOFF_TABLE_SIZE 1024
+
+NATRON_NAMESPACE_ENTER;
+
+NATRON_NAMESPACE_ANONYMOUS_ENTER;
+
+/**
+ * @brief An edge of the internal shape, in coordinates relative to the RoI bottom-left corner.
+ * x is always within [0, width]: the part of an edge left of the RoI is moved onto the left border
+ * where it has the same contribution, and the part right of the RoI onto the right border where it does not
+ * contribute to any visible pixel.
+ **/
+struct CoverageEdge
+{
+    double x0, y0, x1, y1;
+};
+
+/**
+ * @brief A triangle of the feather mesh, t is 1 on the inner vertices and 0 on the outer ones.
+ **/
+struct FeatherTriangle
+{
+    double x[3], y[3], t[3];
+    double ymin, ymax;
+};
+
+/**
+ * @brief The fall-off of the feather as rendered by Cairo. Cairo renders each feather triangle as a Coons patch
+ * whose sides from the inner to the outer vertices are cubic curves with their control points at 1 / (2 fallOff^2 + 1)
+ * and 2 / (fallOff^2 + 2) of the side (see RotoShapeRenderCairo::renderFeather_cairo), and interpolates the alpha linearly
+ * along the parameter u of the curves: a point where the weight of the inner vertices is t has an alpha of 1 - u,
+ * where u solves B(u) = 1 - t. B is monotonic, it is inverted once per render in a table.
+ **/
+class FeatherFallOff
+{
+    std::vector<float> _alphas; // 1 - u for 1 - t sampled uniformly
+
+public:
+
+    explicit FeatherFallOff(double fallOff)
+        : _alphas()
+    {
+        if (fallOff == 1.) {
+            // B(u) = u
+            return;
+        }
+        const double a = 1. / (2. * fallOff * fallOff + 1.);
+        const double b = 2. / (fallOff * fallOff + 2.);
+        _alphas.resize(NATRON_ROTO_CPU_FALLOFF_TABLE_SIZE + 1);
+        for (int i = 0; i <= NATRON_ROTO_CPU_FALLOFF_TABLE_SIZE; ++i) {
+            double s = (double)i / NATRON_ROTO_CPU_FALLOFF_TABLE_SIZE;
+            double u0 = 0., u1 = 1.;
+            for (int it = 0; it < 32; ++it) {
+                double u = 0.5 * (u0 + u1);
+                double v = 1. - u;
+                double bu = 3. * a * u * v * v + 3. * b * u * u * v + u * u * u;
+                if (bu < s) {
+                    u0 = u;
+                } else {
+                    u1 = u;
+                }
+            }
+            _alphas[i] = (float)( 1. - 0.5 * (u0 + u1) );
+        }
+    }
+
+    double operator()(double t) const
+    {
+        if ( _alphas.empty() ) {
+            return t;
+        }
+        double x = (1. - t) * NATRON_ROTO_CPU_FALLOFF_TABLE_SIZE;
+        int i = std::max( 0, std::min(NATRON_ROTO_CPU_FALLOFF_TABLE_SIZE - 1, (int)x) );
+        double f = x - i;
+
+        return _alphas[i] + (_alphas[i + 1] - _alphas[i]) * f;
+    }
+};
+
+struct CoverageRenderData
+{
+    int width, height;
+    FeatherFallOff fallOff;
+    RampTypeEnum rampType;
+    std::vector<CoverageEdge> edges;
+    std::vector<FeatherTriangle> featherTriangles;
+    float* coverage;
+
+    explicit CoverageRenderData(double fallOff)
+        : width(0)
+        , height(0)
+        , fallOff(fallOff)
+        , rampType(eRampTypeLinear)
+        , edges()
+        , featherTriangles()
+        , coverage(0)
+    {
+    }
+};
+
+struct CoverageBand
+{
+    int y1, y2;
+};
+
+static void
+addEdgeClippedToWidth(double x0,
+                      double y0,
+                      double x1,
+                      double y1,
+                      int width,
+                      std::vector<CoverageEdge>* edges)
+{
+    if (y0 == y1) {
+        // Horizontal edges do not contribute
+        return;
+    }
+
+    // Split the edge where it crosses the left and right borders of the RoI
+    double ts[4];
+    int nTs = 0;
+    ts[nTs++] = 0.;
+    if (x0 != x1) {
+        double tLeft = (0. - x0) / (x1 - x0);
+        double tRight = ( (double)width - x0 ) / (x1 - x0);
+        if ( (tLeft > 0.) && (tLeft < 1.) ) {
+            ts[nTs++] = tLeft;
+        }
+        if ( (tRight > 0.) && (tRight < 1.) ) {
+            ts[nTs++] = tRight;
+        }
+        if ( (nTs == 3) && (ts[2] < ts[1]) ) {
+            std::swap(ts[1], ts[2]);
+        }
+    }
+    ts[nTs++] = 1.;
+
+    for (int i = 0; i < nTs - 1; ++i) {
+        CoverageEdge e;
+        e.x0 = x0 + (x1 - x0) * ts[i];
+        e.y0 = y0 + (y1 - y0) * ts[i];
+        e.x1 = x0 + (x1 - x0) * ts[i + 1];
+        e.y1 = y0 + (y1 - y0) * ts[i + 1];
+        e.x0 = std::max( 0., std::min( (double)width, e.x0 ) );
+        e.x1 = std::max( 0., std::min( (double)width, e.x1 ) );
+        if (e.y0 != e.y1) {
+            edges->push_back(e);
+        }
+    }
+}
+
+static void
+addInternalTriangle(const ParametricPoint& p0,
+                    const ParametricPoint& p1,
+                    const ParametricPoint& p2,
+                    double offsetX,
+                    double offsetY,
+                    CoverageRenderData* data)
+{
+    double ax = p0.x - offsetX, ay = p0.y - offsetY;
+    double bx = p1.x - offsetX, by = p1.y - offsetY;
+    double cx = p2.x - offsetX, cy = p2.y - offsetY;
+
+    // Orient all triangles the same way so that the coverage of adjacent triangles adds up
+    double area = (bx - ax) * (cy - ay) - (cx - ax) * (by - ay);
+
+    if (area == 0.) {
+        return;
+    }
+    if (area < 0.) {
+        std::swap(bx, cx);
+        std::swap(by, cy);
+    }
+    addEdgeClippedToWidth(ax, ay, bx, by, data->width, &data->edges);
+    addEdgeClippedToWidth(bx, by, cx, cy, data->width, &data->edges);
+    addEdgeClippedToWidth(cx, cy, ax, ay, data->width, &data->edges);
+}
+
+/**
+ * @brief Accumulates the signed area covered by the edge in each cell of the accumulation buffer.
+ * The coverage of a pixel is then the sum of all cells on its left, including itself.
+ * The buffer has width + 2 cells per row so that edges on the right border can be accumulated without
+ * bounds checks.
+ **/
+static void
+accumulateEdge(const CoverageEdge& edge,
+               int bandY1,
+               int bandHeight,
+               int rowStride,
+               float* acc)
+{
+    double dir;
+    double x0, y0, x1, y1;
+
+    if (edge.y0 < edge.y1) {
+        dir = 1.;
+        x0 = edge.x0; y0 = edge.y0 - bandY1;
+        x1 = edge.x1; y1 = edge.y1 - bandY1;
+    } else {
+        dir = -1.;
+        x0 = edge.x1; y0 = edge.y1 - bandY1;
+        x1 = edge.x0; y1 = edge.y0 - bandY1;
+    }
+    if ( (y1 <= 0.) || (y0 >= bandHeight) ) {
+        return;
+    }
+
+    double dxdy = (x1 - x0) / (y1 - y0);
+    double x = x0;
+    if (y0 < 0.) {
+        x -= y0 * dxdy;
+    }
+    int yStart = std::max(0, (int)std::floor(y0));
+    int yEnd = std::min( bandHeight, (int)std::ceil(y1) );
+
+    for (int y = yStart; y < yEnd; ++y) {
+        float* row = acc + y * rowStride;
+        double dy = std::min( (double)(y + 1), y1 ) - std::max( (double)y, y0 );
+        double xnext = x + dxdy * dy;
+        double d = dy * dir;
+        double xa = std::min(x, xnext);
+        double xb = std::max(x, xnext);
+        double xaFloor = std::floor(xa);
+        int xai = (int)xaFloor;
+        double xbCeil = std::ceil(xb);
+        int xbi = (int)xbCeil;
+
+        if (xbi <= xai + 1) {
+            // The edge stays within a single pixel on this row
+            double xmf = 0.5 * (x + xnext) - xaFloor;
+            row[xai] += (float)(d - d * xmf);
+            row[xai + 1] += (float)(d * xmf);
+        } else {
+            double s = 1. / (xb - xa);
+            double xaf = xa - xaFloor;
+            double a0 = 0.5 * s * (1. - xaf) * (1. - xaf);
+            double xbf = xb - xbCeil + 1.;
+            double am = 0.5 * s * xbf * xbf;
+            row[xai] += (float)(d * a0);
+            if (xbi == xai + 2) {
+                row[xai + 1] += (float)( d * (1. - a0 - am) );
+            } else {
+                double a1 = s * (1.5 - xaf);
+                row[xai + 1] += (float)( d * (a1 - a0) );
+                for (int xi = xai + 2; xi < xbi - 1; ++xi) {
+                    row[xi] += (float)(d * s);
+                }
+                double a2 = a1 + (xbi - xai - 3) * s;
+                row[xbi - 1] += (float)( d * (1. - a2 - am) );
+            }
+            row[xbi] += (float)(d * am);
+        }
+        x = xnext;
+    }
+} // accumulateEdge
+
+/**
+ * @brief Computes the running sum of the accumulation row, which yields the coverage of each pixel.
+ * Overlapping triangles may cover a pixel more than once, hence the clamp.
+ **/
+static void
+resolveCoverageRow(const float* acc,
+                   int width,
+                   float* coverage)
+{
+    int x = 0;
+    float sum = 0.f;
+
+#ifdef __SSE2__
+    const __m128 absMask = _mm_castsi128_ps( _mm_set1_epi32(0x7fffffff) );
+    const __m128 one = _mm_set1_ps(1.f);
+    __m128 offset = _mm_setzero_ps();
+    for (; x + 4 <= width; x += 4) {
+        // In-register prefix sum of the 4 cells, then add the sum of all the previous cells
+        __m128 v = _mm_loadu_ps(acc + x);
+        v = _mm_add_ps( v, _mm_castsi128_ps( _mm_slli_si128(_mm_castps_si128(v), 4) ) );
+        v = _mm_add_ps( v, _mm_castsi128_ps( _mm_slli_si128(_mm_castps_si128(v), 8) ) );
+        v = _mm_add_ps(v, offset);
+        _mm_storeu_ps( coverage + x, _mm_min_ps(_mm_and_ps(v, absMask), one) );
+        offset = _mm_shuffle_ps( v, v, _MM_SHUFFLE(3, 3, 3, 3) );
+    }
+    sum = _mm_cvtss_f32(offset);
+#endif
+    for (; x < width; ++x) {
+        sum += acc[x];
+        coverage[x] = std::min(std::abs(sum), 1.f);
+    }
+}
+
+/**
+ * @brief Shades the feather triangle in the feather buffer of the band, whose first row is band.y1.
+ * Pixels on an edge shared by 2 triangles keep the max, so that they are not counted twice.
+ **/
+static void
+renderFeatherTriangle(const FeatherTriangle& tri,
+                      const CoverageRenderData& data,
+                      const CoverageBand& band,
+                      float* feather)
+{
+    double area = (tri.x[1] - tri.x[0]) * (tri.y[2] - tri.y[0]) - (tri.x[2] - tri.x[0]) * (tri.y[1] - tri.y[0]);
+
+    if (std::abs(area) < 1e-12) {
+        return;
+    }
+    double invArea = 1. / area;
+    double xmin = std::min( tri.x[0], std::min(tri.x[1], tri.x[2]) );
+    double xmax = std::max( tri.x[0], std::max(tri.x[1], tri.x[2]) );
+    int px1 = std::max(0, (int)std::floor(xmin));
+    int px2 = std::min( data.width, (int)std::ceil(xmax) );
+    int py1 = std::max( band.y1, (int)std::floor(tri.ymin) );
+    int py2 = std::min( band.y2, (int)std::ceil(tri.ymax) );
+    // Tolerance so that pixel centers lying exactly on an edge shared by 2 triangles are not missed
+    const double eps = -1e-9;
+
+    for (int y = py1; y < py2; ++y) {
+        float* dst = feather + (std::size_t)(y - band.y1) * data.width;
+        double py = y + 0.5;
+        for (int x = px1; x < px2; ++x) {
+            double px = x + 0.5;
+            double w0 = ( (tri.x[1] - px) * (tri.y[2] - py) - (tri.x[2] - px) * (tri.y[1] - py) ) * invArea;
+            double w1 = ( (tri.x[2] - px) * (tri.y[0] - py) - (tri.x[0] - px) * (tri.y[2] - py) ) * invArea;
+            double w2 = 1. - w0 - w1;
+            if ( (w0 < eps) || (w1 < eps) || (w2 < eps) ) {
+                continue;
+            }
+            double t = w0 * tri.t[0] + w1 * tri.t[1] + w2 * tri.t[2];
+            t = std::max( 0., std::min(1., t) );
+            float v = (float)data.fallOff( applyRotoRampType(t, data.rampType) );
+            if (v > dst[x]) {
+                dst[x] = v;
+            }
+        }
+    }
+} // renderFeatherTriangle
+
+static void
+renderCoverageBand(const CoverageRenderData* data,
+                   CoverageBand& band)
+{
+    int bandHeight = band.y2 - band.y1;
+    int rowStride = data->width + 2;
+    std::vector<float> acc( (std::size_t)rowStride * bandHeight, 0.f );
+
+    for (std::vector<CoverageEdge>::const_iterator it = data->edges.begin(); it != data->edges.end(); ++it) {
+        accumulateEdge(*it, band.y1, bandHeight, rowStride, &acc[0]);
+    }
+    for (int y = 0; y < bandHeight; ++y) {
+        resolveCoverageRow( &acc[(std::size_t)y * rowStride], data->width, data->coverage + (std::size_t)(band.y1 + y) * data->width );
+    }
+
+    std::vector<float> feather;
+    for (std::vector<FeatherTriangle>::const_iterator it = data->featherTriangles.begin(); it != data->featherTriangles.end(); ++it) {
+        if ( (it->ymax <= band.y1) || (it->ymin >= band.y2) ) {
+            continue;
+        }
+        if ( feather.empty() ) {
+            feather.resize( (std::size_t)data->width * bandHeight, 0.f );
+        }
+        renderFeatherTriangle(*it, *data, band, &feather[0]);
+    }
+    if ( feather.empty() ) {
+        return;
+    }
+
+    // Cairo paints the internal shape over the feather in the same mesh pattern
+    float* dst = data->coverage + (std::size_t)band.y1 * data->width;
+    for (std::size_t i = 0; i < feather.size(); ++i) {
+        dst[i] += feather[i] * (1.f - dst[i]);
+    }
+}
+
+NATRON_NAMESPACE_ANONYMOUS_EXIT;
+
+
+void
+RotoShapeRenderCPU::renderCoverage_cpu(const RotoBezierTriangulation::PolygonData& inArgs,
+                                       double fallOff,
+                                       RampTypeEnum rampType,
+                                       const RectI& roi,
+                                       float* coverage)
+{
+    assert(coverage);
+    CoverageRenderData data(fallOff);
+    data.width = roi.width();
+    data.height = roi.height();
+    data.rampType = rampType;
+    data.coverage = coverage;
+    if ( (data.width <= 0) || (data.height <= 0) ) {
+        return;
+    }
+
+    const double offsetX = roi.x1;
+    const double offsetY = roi.y1;
+    const std::vector<ParametricPoint>& vertices = inArgs.bezierPolygonJoined;
+
+    // Convert the libtess output to a list of edges of triangles
+    for (std::vector<RotoBezierTriangulation::RotoTriangles>::const_iterator it = inArgs.internalTriangles.begin(); it != inArgs.internalTriangles.end(); ++it) {
+        assert(it->indices.size() % 3 == 0);
+        for (std::size_t i = 0; i + 2 < it->indices.size(); i += 3) {
+            addInternalTriangle(vertices[it->indices[i]], vertices[it->indices[i + 1]], vertices[it->indices[i + 2]], offsetX, offsetY, &data);
+        }
+    }
+    for (std::vector<RotoBezierTriangulation::RotoTriangleFans>::const_iterator it = inArgs.internalFans.begin(); it != inArgs.internalFans.end(); ++it) {
+        for (std::size_t i = 1; i + 1 < it->indices.size(); ++i) {
+            addInternalTriangle(vertices[it->indices[0]], vertices[it->indices[i]], vertices[it->indices[i + 1]], offsetX, offsetY, &data);
+        }
+    }
+    for (std::vector<RotoBezierTriangulation::RotoTriangleStrips>::const_iterator it = inArgs.internalStrips.begin(); it != inArgs.internalStrips.end(); ++it) {
+        for (std::size_t i = 0; i + 2 < it->indices.size(); ++i) {
+            addInternalTriangle(vertices[it->indices[i]], vertices[it->indices[i + 1]], vertices[it->indices[i + 2]], offsetX, offsetY, &data);
+        }
+    }
+
+    // The feather mesh is a list of triangles
+    assert(inArgs.featherMesh.size() % 3 == 0);
+    for (std::size_t i = 0; i + 2 < inArgs.featherMesh.size(); i += 3) {
+        FeatherTriangle tri;
+        for (int v = 0; v < 3; ++v) {
+            const RotoBezierTriangulation::RotoFeatherVertex& vertex = inArgs.featherMesh[i + v];
+            tri.x[v] = vertex.x - offsetX;
+            tri.y[v] = vertex.y - offsetY;
+            tri.t[v] = vertex.isInner ? 1. : 0.;
+        }
+        tri.ymin = std::min( tri.y[0], std::min(tri.y[1], tri.y[2]) );
+        tri.ymax = std::max( tri.y[0], std::max(tri.y[1], tri.y[2]) );
+        if ( (tri.ymax <= 0.) || (tri.ymin >= data.height) ) {
+            continue;
+        }
+        data.featherTriangles.push_back(tri);
+    }
+
+    std::vector<CoverageBand> bands;
+    for (int y = 0; y < data.height; y += NATRON_ROTO_CPU_RENDER_BAND_HEIGHT) {
+        CoverageBand b;
+        b.y1 = y;
+        b.y2 = std::min(data.height, y + NATRON_ROTO_CPU_RENDER_BAND_HEIGHT);
+        bands.push_back(b);
+    }
+
+    // Bands write to disjoint rows of the coverage buffer
+    if (bands.size() == 1) {
+        renderCoverageBand(&data, bands[0]);
+    } else {
+        QtConcurrent::blockingMap( bands, boost::bind(&renderCoverageBand, &data, _1) );
+    }
+} // RotoShapeRenderCPU::renderCoverage_cpu
+
+void
+RotoShapeRenderCPU::renderBezier_cpu(const Bezier* bezier,
+                                     double opacity,
+                                     double time,
+                                     double startTime,
+                                     double endTime,
+                                     double mbFrameStep,
+                                     unsigned int mipmapLevel,
+                                     RotoBezierTriangulationCache* triangulationCache,
+                                     U64 itemHash,
+                                     const RectI& roi,
+                                     const ImagePtr& dstImage)
+{
+    assert(triangulationCache && dstImage);
+    assert(dstImage->getBitDepth() == eImageBitDepthFloat);
+
+    std::size_t nPixels = (std::size_t)roi.width() * roi.height();
+    if (nPixels == 0) {
+        return;
+    }
+
+    RampTypeEnum rampType;
+    {
+        KnobChoicePtr typeKnob = bezier->getFallOffRampTypeKnob();
+        rampType = (RampTypeEnum)typeKnob->getValue();
+    }
+
+    std::vector<double> sampleTimes;
+    for (double t = startTime; t <= endTime; t += mbFrameStep) {
+        sampleTimes.push_back(t);
+    }
+    if ( sampleTimes.empty() ) {
+        return;
+    }
+
+    // As with Cairo, the pattern of each sample is used as both source and mask, so its alpha is squared,
+    // and the motion blur samples are composited over each other in order
+    std::vector<float> coverage(nPixels);
+    std::vector<float> sampleCoverage;
+    if (sampleTimes.size() > 1) {
+        sampleCoverage.resize(nPixels);
+    }
+    for (std::size_t i = 0; i < sampleTimes.size(); ++i) {
+        double t = sampleTimes[i];
+        double fallOff = bezier->getFeatherFallOff(t);
+        double featherDist = bezier->getFeatherDistance(t);
+
+        ///Adjust the feather distance so it takes the mipmap level into account
+        if (mipmapLevel != 0) {
+            featherDist /= (1 << mipmapLevel);
+        }
+
+        RotoBezierTriangulation::PolygonDataConstPtr data = triangulationCache->getOrComputeTriangles(bezier, itemHash, t, mipmapLevel, featherDist);
+        if (sampleTimes.size() == 1) {
+            renderCoverage_cpu(*data, fallOff, rampType, roi, &coverage[0]);
+            for (std::size_t p = 0; p < nPixels; ++p) {
+                coverage[p] *= coverage[p];
+            }
+        } else {
+            renderCoverage_cpu(*data, fallOff, rampType, roi, &sampleCoverage[0]);
+            if (i == 0) {
+                std::memset( &coverage[0], 0, nPixels * sizeof(float) );
+            }
+            for (std::size_t p = 0; p < nPixels; ++p) {
+                float a = sampleCoverage[p] * sampleCoverage[p];
+                coverage[p] += a * (1.f - coverage[p]);
+            }
+        }
+    }
+
+    // Write the premultiplied shape color to the image
+    double shapeColor[3];
+    bezier->getColor(time, shapeColor);
+    const float r = (float)(shapeColor[0] * opacity);
+    const float g = (float)(shapeColor[1] * opacity);
+    const float b = (float)(shapeColor[2] * opacity);
+    const float a = (float)opacity;
+    const int nComps = (int)dstImage->getComponentsCount();
+    const int width = roi.width();
+    Image::WriteAccess acc = dstImage->getWriteRights();
+
+    for (int y = 0; y < roi.height(); ++y) {
+        const float* srcPix = &coverage[(std::size_t)y * width];
+        float* dstPix = (float*)acc.pixelAt(roi.x1, roi.y1 + y);
+        assert(dstPix);
+        switch (nComps) {
+            case 1:
+                for (int x = 0; x < width; ++x) {
+                    dstPix[x] = srcPix[x] * a;
+                }
+                break;
+            case 2:
+                for (int x = 0; x < width; ++x, dstPix += 2) {
+                    dstPix[0] = srcPix[x] * r;
+                    dstPix[1] = srcPix[x] * g;
+                }
+                break;
+            case 3:
+                for (int x = 0; x < width; ++x, dstPix += 3) {
+                    dstPix[0] = srcPix[x] * r;
+                    dstPix[1] = srcPix[x] * g;
+                    dstPix[2] = srcPix[x] * b;
+                }
+                break;
+            case 4:
+                for (int x = 0; x < width; ++x, dstPix += 4) {
+                    dstPix[0] = srcPix[x] * r;
+                    dstPix[1] = srcPix[x] * g;
+                    dstPix[2] = srcPix[x] * b;
+                    dstPix[3] = srcPix[x] * a;
+                }
+                break;
+            default:
+                break;
+        }
+    }
+} // RotoShapeRenderCPU::renderBezier_cpu
+
+NATRON_NAMESPACE_EXIT;
@@ -0,0 +1,84 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <http://www.natron.fr/>,
+ * Copyright (C) 2016 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+#ifndef ROTOSHAPERENDERCPU_H
+#define ROTOSHAPERENDERCPU_H
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "Global/GlobalDefines.h"
+#include "Engine/EngineFwd.h"
+
+#include "Engine/RotoBezierTriangulation.h"
+#include "Engine/RotoShapeRenderGL.h"
+
+NATRON_NAMESPACE_ENTER;
+
+/**
+ * @brief Native CPU renderer for closed beziers.
+ * The triangulation computed by RotoBezierTriangulation is rasterized with a scanline algorithm
+ * computing the exact (analytic) area covered by the internal shape in each pixel, so edges are
+ * anti-aliased without super-sampling. The feather mesh is shaded with the ramp types of the OpenGL
+ * implementation and the fall-off of the Cairo implementation, and the shape is composited as Cairo does.
+ * The RoI is split in horizontal bands that are rasterized concurrently.
+ * The result is not bit-compatible with Cairo, which does not anti-alias the shape and works in 8 bits:
+ * RotoShapeRenderNode only uses it when Cairo is not available.
+ **/
+class RotoShapeRenderCPU
+{
+public:
+
+    RotoShapeRenderCPU()
+    {
+    }
+
+    /**
+     * @brief Low level: rasterizes the coverage of the given triangulated bezier in the given float buffer
+     * of roi.width() * roi.height() elements. The first row of the buffer corresponds to roi.y1.
+     * This is the alpha of the mesh pattern of the Cairo implementation: the internal shape over the feather.
+     * The buffer does not need to be initialized.
+     **/
+    static void renderCoverage_cpu(const RotoBezierTriangulation::PolygonData& data,
+                                   double fallOff,
+                                   RampTypeEnum rampType,
+                                   const RectI& roi,
+                                   float* coverage);
+
+    /**
+     * @brief High level: renders the given bezier with motion blur in the RoI of the given float image.
+     **/
+    static void renderBezier_cpu(const Bezier* bezier,
+                                 double opacity,
+                                 double time,
+                                 double startTime,
+                                 double endTime,
+                                 double mbFrameStep,
+                                 unsigned int mipmapLevel,
+                                 RotoBezierTriangulationCache* triangulationCache,
+                                 U64 itemHash,
+                                 const RectI& roi,
+                                 const ImagePtr& dstImage);
+};
+
+NATRON_NAMESPACE_EXIT;
+
+#endif // ROTOSHAPERENDERCPU_H
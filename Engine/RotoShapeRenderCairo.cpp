@@ -27,6 +27,11 @@
 #ifdef ROTO_SHAPE_RENDER_ENABLE_CAIRO
 
 #include <QLineF>
+#include <QtConcurrentMap> // QtCore on Qt4, QtConcurrent on Qt5
+
+#if !defined(Q_MOC_RUN) && !defined(SBK_RUN)
+#include <boost/bind.hpp>
+#endif
 
 #include <cairo/cairo.h>
 
@@ -42,10 +47,6 @@
 
 
 
-//This will enable correct evaluation of beziers
-//#define ROTO_USE_MESH_PATTERN_ONLY
-
-
 NATRON_NAMESPACE_ENTER;
 
 QString
@@ -66,18 +67,6 @@ RotoShapeRenderCairo::CairoImageWrapper::~CairoImageWrapper()
 }
 
 
-static void
-adjustToPointToScale(unsigned int mipmapLevel,
-                     double &x,
-                     double &y)
-{
-    if (mipmapLevel != 0) {
-        int pot = (1 << mipmapLevel);
-        x /= pot;
-        y /= pot;
-    }
-}
-
 
 
 
@@ -1110,288 +1099,150 @@ RotoShapeRenderCairo::renderSmear_cairo(double time,
 } // RotoShapeRenderCairo::renderSmear_cairo
 
 
-void
-RotoShapeRenderCairo::renderBezier_cairo(cairo_t* cr,
-                                       const Bezier* bezier,
-                                       double opacity,
-                                       double /*time*/,
-                                       double startTime, double endTime, double mbFrameStep,
-                                       unsigned int mipmapLevel)
-{
+NATRON_NAMESPACE_ANONYMOUS_ENTER;
 
-    for (double t = startTime; t <= endTime; t+=mbFrameStep) {
+/**
+ * @brief A motion-blur sample of a bezier, rasterized in its own coverage buffer
+ **/
+struct BezierCairoSample
+{
+    double time;
+    cairo_surface_t* coverage;
+};
 
-        double fallOff = bezier->getFeatherFallOff(t);
-        double featherDist = bezier->getFeatherDistance(t);
-        double shapeColor[3];
-        bezier->getColor(t, shapeColor);
+static void
+renderBezierSample_cairo(cairo_t* cr,
+                         const Bezier* bezier,
+                         double t,
+                         unsigned int mipmapLevel,
+                         RotoBezierTriangulationCache* triangulationCache,
+                         U64 itemHash)
+{
+    double fallOff = bezier->getFeatherFallOff(t);
+    double featherDist = bezier->getFeatherDistance(t);
+    double shapeColor[3];
+    bezier->getColor(t, shapeColor);
 
 
-        cairo_set_operator(cr, CAIRO_OPERATOR_OVER);
+    cairo_set_operator(cr, CAIRO_OPERATOR_OVER);
 
-        cairo_new_path(cr);
+    cairo_new_path(cr);
 
-        ////Define the feather edge pattern
-        cairo_pattern_t* mesh = cairo_pattern_create_mesh();
-        if (cairo_pattern_status(mesh) != CAIRO_STATUS_SUCCESS) {
-            cairo_pattern_destroy(mesh);
+    ////Define the feather edge pattern
+    cairo_pattern_t* mesh = cairo_pattern_create_mesh();
+    if (cairo_pattern_status(mesh) != CAIRO_STATUS_SUCCESS) {
+        cairo_pattern_destroy(mesh);
 
-            return;
-        }
+        return;
+    }
 
-        ///Adjust the feather distance so it takes the mipmap level into account
-        if (mipmapLevel != 0) {
-            featherDist /= (1 << mipmapLevel);
-        }
+    ///Adjust the feather distance so it takes the mipmap level into account
+    if (mipmapLevel != 0) {
+        featherDist /= (1 << mipmapLevel);
+    }
 
 
 
-#ifdef ROTO_CAIRO_RENDER_TRIANGLES_ONLY
-        PolygonData data;
-        computeTriangles(bezier, t, mipmapLevel, featherDist, &data);
-        renderFeather_cairo(data, shapeColor, fallOff, mesh);
-        renderInternalShape_cairo(data, shapeColor, mesh);
-        Q_UNUSED(opacity);
-#else
-        renderFeather_old_cairo(bezier, t, mipmapLevel, shapeColor, opacity, featherDist, fallOff, mesh);
+    // The tesselation only depends on the shape at this time and mipmap level: it is shared by all the tiles and
+    // the renders of the item until its hash changes.
+    assert(triangulationCache);
+    RotoBezierTriangulation::PolygonDataConstPtr data = triangulationCache->getOrComputeTriangles(bezier, itemHash, t, mipmapLevel, featherDist);
+    if ( data->featherMesh.empty() ) {
+        cairo_pattern_destroy(mesh);
 
-        Transform::Matrix3x3 transform;
-        bezier->getTransformAtTime(t, &transform);
+        return;
+    }
+    RotoShapeRenderCairo::renderFeather_cairo(*data, shapeColor, fallOff, mesh);
+    RotoShapeRenderCairo::renderInternalShape_cairo(*data, shapeColor, mesh);
 
-        // strangely, the above-mentioned cairo bug doesn't affect this function
-        BezierCPs cps = bezier->getControlPoints_mt_safe();
-        renderInternalShape_old_cairo(t, mipmapLevel, shapeColor, opacity, transform, cr, mesh, cps);
+    RotoShapeRenderCairo::applyAndDestroyMask(cr, mesh);
+} // renderBezierSample_cairo
 
-#endif
+static void
+renderBezierSampleToCoverage_cairo(const Bezier* bezier,
+                                   unsigned int mipmapLevel,
+                                   RotoBezierTriangulationCache* triangulationCache,
+                                   U64 itemHash,
+                                   BezierCairoSample& sample)
+{
+    // Each sample has its own surface and context, so they can be rendered concurrently
+    cairo_t* ctx = cairo_create(sample.coverage);
+    cairo_set_fill_rule(ctx, CAIRO_FILL_RULE_WINDING);
+    cairo_set_antialias(ctx, CAIRO_ANTIALIAS_NONE);
+    renderBezierSample_cairo(ctx, bezier, sample.time, mipmapLevel, triangulationCache, itemHash);
+    cairo_destroy(ctx);
+    cairo_surface_flush(sample.coverage);
+}
 
+NATRON_NAMESPACE_ANONYMOUS_EXIT;
 
-        RotoShapeRenderCairo::applyAndDestroyMask(cr, mesh);
-    }
-} // RotoShapeRenderCairo::renderBezier_cairo
 
 void
-RotoShapeRenderCairo::renderFeather_old_cairo(const Bezier* bezier,
-                                            double time,
-                                            unsigned int mipmapLevel,
-                                            double shapeColor[3],
-                                            double /*opacity*/,
-                                            double featherDist,
-                                            double fallOff,
-                                            cairo_pattern_t* mesh)
+RotoShapeRenderCairo::renderBezier_cairo(cairo_t* cr,
+                                       const Bezier* bezier,
+                                       double /*opacity*/,
+                                       double /*time*/,
+                                       double startTime, double endTime, double mbFrameStep,
+                                       unsigned int mipmapLevel,
+                                       RotoBezierTriangulationCache* triangulationCache,
+                                       U64 itemHash)
 {
-    ///Note that we do not use the opacity when rendering the bezier, it is rendered with correct floating point opacity/color when converting
-    ///to the Natron image.
-
-    double fallOffInverse = 1. / fallOff;
-    /*
-     * We descretize the feather control points to obtain a polygon so that the feather distance will be of the same thickness around all the shape.
-     * If we were to extend only the end points, the resulting bezier interpolation would create a feather with different thickness around the shape,
-     * yielding an unwanted behaviour for the end user.
-     */
-    ///here is the polygon of the feather bezier
-    ///This is used only if the feather distance is different of 0 and the feather points equal
-    ///the control points in order to still be able to apply the feather distance.
-    std::vector<ParametricPoint> featherPolygon;
-    std::vector<ParametricPoint> bezierPolygon;
-    RectD featherPolyBBox;
-
-    featherPolyBBox.setupInfinity();
-
-    bezier->evaluateFeatherPointsAtTime_DeCasteljau(false, time, mipmapLevel,
-#ifdef ROTO_BEZIER_EVAL_ITERATIVE
-                                                    50,
-#else
-                                                    1,
-#endif
-                                                    true, &featherPolygon, &featherPolyBBox);
-    bezier->evaluateAtTime_DeCasteljau(false, time, mipmapLevel,
-#ifdef ROTO_BEZIER_EVAL_ITERATIVE
-                                       50,
-#else
-                                       1,
-#endif
-                                       &bezierPolygon, NULL);
-
-    bool clockWise = bezier->isFeatherPolygonClockwiseOriented(false, time);
-
-    assert( !featherPolygon.empty() && !bezierPolygon.empty() );
-
-
-    std::vector<Point> featherContour;
-
-    // prepare iterators
-    std::vector<ParametricPoint>::iterator next = featherPolygon.begin();
-    ++next;  // can only be valid since we assert the list is not empty
-    if ( next == featherPolygon.end() ) {
-        next = featherPolygon.begin();
-    }
-    std::vector<ParametricPoint>::iterator prev = featherPolygon.end();
-    --prev; // can only be valid since we assert the list is not empty
-    std::vector<ParametricPoint>::iterator bezIT = bezierPolygon.begin();
-    std::vector<ParametricPoint>::iterator prevBez = bezierPolygon.end();
-    --prevBez; // can only be valid since we assert the list is not empty
-
-    // prepare p1
-    double absFeatherDist = std::abs(featherDist);
-    Point p1;
-    p1.x = featherPolygon.begin()->x;
-    p1.y = featherPolygon.begin()->y;
-    double norm = sqrt( (next->x - prev->x) * (next->x - prev->x) + (next->y - prev->y) * (next->y - prev->y) );
-    assert(norm != 0);
-    double dx = (norm != 0) ? -( (next->y - prev->y) / norm ) : 0;
-    double dy = (norm != 0) ? ( (next->x - prev->x) / norm ) : 1;
-
-    if (!clockWise) {
-        p1.x -= dx * absFeatherDist;
-        p1.y -= dy * absFeatherDist;
-    } else {
-        p1.x += dx * absFeatherDist;
-        p1.y += dy * absFeatherDist;
-    }
-
-    Point origin = p1;
-    featherContour.push_back(p1);
-
-
-    // increment for first iteration
-    std::vector<ParametricPoint>::iterator cur = featherPolygon.begin();
-    // ++cur, ++prev, ++next, ++bezIT, ++prevBez
-    // all should be valid, actually
-    assert( cur != featherPolygon.end() &&
-           prev != featherPolygon.end() &&
-           next != featherPolygon.end() &&
-           bezIT != bezierPolygon.end() &&
-           prevBez != bezierPolygon.end() );
-    if ( cur != featherPolygon.end() ) {
-        ++cur;
-    }
-    if ( prev != featherPolygon.end() ) {
-        ++prev;
-    }
-    if ( next != featherPolygon.end() ) {
-        ++next;
-    }
-    if ( bezIT != bezierPolygon.end() ) {
-        ++bezIT;
-    }
-    if ( prevBez != bezierPolygon.end() ) {
-        ++prevBez;
+    std::vector<BezierCairoSample> samples;
+    for (double t = startTime; t <= endTime; t+=mbFrameStep) {
+        BezierCairoSample s;
+        s.time = t;
+        s.coverage = 0;
+        samples.push_back(s);
     }
 
-    for (;; ++cur) { // for each point in polygon
-        if ( next == featherPolygon.end() ) {
-            next = featherPolygon.begin();
-        }
-        if ( prev == featherPolygon.end() ) {
-            prev = featherPolygon.begin();
-        }
-        if ( bezIT == bezierPolygon.end() ) {
-            bezIT = bezierPolygon.begin();
-        }
-        if ( prevBez == bezierPolygon.end() ) {
-            prevBez = bezierPolygon.begin();
-        }
-        bool mustStop = false;
-        if ( cur == featherPolygon.end() ) {
-            mustStop = true;
-            cur = featherPolygon.begin();
-        }
-
-        ///skip it
-        if ( (cur->x == prev->x) && (cur->y == prev->y) ) {
-            continue;
-        }
-
-        Point p0, p0p1, p1p0, p2, p2p3, p3p2, p3;
-        p0.x = prevBez->x;
-        p0.y = prevBez->y;
-        p3.x = bezIT->x;
-        p3.y = bezIT->y;
-
-        if (!mustStop) {
-            norm = sqrt( (next->x - prev->x) * (next->x - prev->x) + (next->y - prev->y) * (next->y - prev->y) );
-            assert(norm != 0);
-            dx = -( (next->y - prev->y) / norm );
-            dy = ( (next->x - prev->x) / norm );
-            p2.x = cur->x;
-            p2.y = cur->y;
-
-            if (!clockWise) {
-                p2.x -= dx * absFeatherDist;
-                p2.y -= dy * absFeatherDist;
-            } else {
-                p2.x += dx * absFeatherDist;
-                p2.y += dy * absFeatherDist;
-            }
-        } else {
-            p2.x = origin.x;
-            p2.y = origin.y;
+    if (samples.size() <= 1) {
+        // No motion-blur: render directly onto the destination
+        for (std::size_t i = 0; i < samples.size(); ++i) {
+            renderBezierSample_cairo(cr, bezier, samples[i].time, mipmapLevel, triangulationCache, itemHash);
         }
-        featherContour.push_back(p2);
-
-        ///linear interpolation
-        p0p1.x = (p0.x * fallOff * 2. + fallOffInverse * p1.x) / (fallOff * 2. + fallOffInverse);
-        p0p1.y = (p0.y * fallOff * 2. + fallOffInverse * p1.y) / (fallOff * 2. + fallOffInverse);
-        p1p0.x = (p0.x * fallOff + 2. * fallOffInverse * p1.x) / (fallOff + 2. * fallOffInverse);
-        p1p0.y = (p0.y * fallOff + 2. * fallOffInverse * p1.y) / (fallOff + 2. * fallOffInverse);
-
-
-        p2p3.x = (p3.x * fallOff + 2. * fallOffInverse * p2.x) / (fallOff + 2. * fallOffInverse);
-        p2p3.y = (p3.y * fallOff + 2. * fallOffInverse * p2.y) / (fallOff + 2. * fallOffInverse);
-        p3p2.x = (p3.x * fallOff * 2. + fallOffInverse * p2.x) / (fallOff * 2. + fallOffInverse);
-        p3p2.y = (p3.y * fallOff * 2. + fallOffInverse * p2.y) / (fallOff * 2. + fallOffInverse);
-
-
-        ///move to the initial point
-        cairo_mesh_pattern_begin_patch(mesh);
-        cairo_mesh_pattern_move_to(mesh, p0.x, p0.y);
-        cairo_mesh_pattern_curve_to(mesh, p0p1.x, p0p1.y, p1p0.x, p1p0.y, p1.x, p1.y);
-        cairo_mesh_pattern_line_to(mesh, p2.x, p2.y);
-        cairo_mesh_pattern_curve_to(mesh, p2p3.x, p2p3.y, p3p2.x, p3p2.y, p3.x, p3.y);
-        cairo_mesh_pattern_line_to(mesh, p0.x, p0.y);
-        ///Set the 4 corners color
-        ///inner is full color
-
-        // IMPORTANT NOTE:
-        // The two sqrt below are due to a probable cairo bug.
-        // To check wether the bug is present is a given cairo version,
-        // make any shape with a very large feather and set
-        // opacity to 0.5. Then, zoom on the polygon border to check if the intensity is continuous
-        // and approximately equal to 0.5.
-        // If the bug if ixed in cairo, please use #if CAIRO_VERSION>xxx to keep compatibility with
-        // older Cairo versions.
-        cairo_mesh_pattern_set_corner_color_rgba( mesh, 0, shapeColor[0], shapeColor[1], shapeColor[2], 1.);
-        ///outter is faded
-        cairo_mesh_pattern_set_corner_color_rgba(mesh, 1, shapeColor[0], shapeColor[1], shapeColor[2], 0.);
-        cairo_mesh_pattern_set_corner_color_rgba(mesh, 2, shapeColor[0], shapeColor[1], shapeColor[2], 0.);
-        ///inner is full color
-        cairo_mesh_pattern_set_corner_color_rgba(mesh, 3, shapeColor[0], shapeColor[1], shapeColor[2], 1.);
-        assert(cairo_pattern_status(mesh) == CAIRO_STATUS_SUCCESS);
-
-        cairo_mesh_pattern_end_patch(mesh);
+        return;
+    }
 
-        if (mustStop) {
+    // With motion-blur, each sample is an independent shape: rasterize them in parallel, each
+    // into its own coverage buffer with the same geometry as the destination, then composite
+    // them in order with the OVER operator, which is what rendering them sequentially did.
+    cairo_surface_t* dstSurface = cairo_get_target(cr);
+    int width = cairo_image_surface_get_width(dstSurface);
+    int height = cairo_image_surface_get_height(dstSurface);
+    double offsetX, offsetY;
+    cairo_surface_get_device_offset(dstSurface, &offsetX, &offsetY);
+
+    bool allocOk = true;
+    for (std::size_t i = 0; i < samples.size(); ++i) {
+        samples[i].coverage = cairo_image_surface_create(CAIRO_FORMAT_A8, width, height);
+        if (cairo_surface_status(samples[i].coverage) != CAIRO_STATUS_SUCCESS) {
+            allocOk = false;
             break;
         }
+        cairo_surface_set_device_offset(samples[i].coverage, offsetX, offsetY);
+    }
 
-        p1 = p2;
+    if (allocOk) {
+        QtConcurrent::blockingMap( samples, boost::bind(&renderBezierSampleToCoverage_cairo, bezier, mipmapLevel, triangulationCache, itemHash, _1) );
 
-        // increment for next iteration
-        // ++prev, ++next, ++bezIT, ++prevBez
-        if ( prev != featherPolygon.end() ) {
-            ++prev;
-        }
-        if ( next != featherPolygon.end() ) {
-            ++next;
+        cairo_set_operator(cr, CAIRO_OPERATOR_OVER);
+        for (std::size_t i = 0; i < samples.size(); ++i) {
+            cairo_set_source_surface(cr, samples[i].coverage, 0, 0);
+            cairo_paint(cr);
         }
-        if ( bezIT != bezierPolygon.end() ) {
-            ++bezIT;
+    } else {
+        // Not enough memory for the coverage buffers: fallback on rendering sequentially
+        for (std::size_t i = 0; i < samples.size(); ++i) {
+            renderBezierSample_cairo(cr, bezier, samples[i].time, mipmapLevel, triangulationCache, itemHash);
         }
-        if ( prevBez != bezierPolygon.end() ) {
-            ++prevBez;
+    }
+
+    for (std::size_t i = 0; i < samples.size(); ++i) {
+        if (samples[i].coverage) {
+            cairo_surface_destroy(samples[i].coverage);
         }
-    }  // for each point in polygon
-} // RotoShapeRenderCairo::renderFeather_old_cairo
+    }
+} // RotoShapeRenderCairo::renderBezier_cairo
 
 void
 RotoShapeRenderCairo::renderFeather_cairo(const RotoBezierTriangulation::PolygonData& inArgs, double shapeColor[3], double fallOff, cairo_pattern_t * mesh)
@@ -1672,218 +1523,6 @@ RotoShapeRenderCairo::renderInternalShape_cairo(const RotoBezierTriangulation::P
 } // RotoShapeRenderCairo::renderInternalShape_cairo
 
 
-void
-RotoShapeRenderCairo::renderInternalShape_old_cairo(double time,
-                                                  unsigned int mipmapLevel,
-                                                  double /*shapeColor*/[3],
-                                                  double /*opacity*/,
-                                                  const Transform::Matrix3x3& transform,
-                                                  cairo_t* cr,
-#ifdef ROTO_USE_MESH_PATTERN_ONLY
-                                                  cairo_pattern_t* mesh,
-#else
-                                                  cairo_pattern_t* /*mesh*/,
-#endif
-                                                  const BezierCPs & cps)
-{
-    assert( !cps.empty() );
-#ifdef ROTO_USE_MESH_PATTERN_ONLY
-    std::list<BezierCPs> coonPatches;
-    bezulate(time, cps, &coonPatches);
-
-    for (std::list<BezierCPs>::iterator it = coonPatches.begin(); it != coonPatches.end(); ++it) {
-        std::list<BezierCPs> fixedPatch;
-        CoonsRegularization::regularize(*it, time, &fixedPatch);
-        for (std::list<BezierCPs>::iterator it2 = fixedPatch.begin(); it2 != fixedPatch.end(); ++it2) {
-            std::size_t size = it2->size();
-            assert(size <= 4 && size >= 2);
-
-            BezierCPs::iterator patchIT = it2->begin();
-            BezierCPPtr p0ptr, p1ptr, p2ptr, p3ptr;
-            p0ptr = *patchIT;
-            ++patchIT;
-            if (size == 2) {
-                p1ptr = p0ptr;
-                p2ptr = *patchIT;
-                p3ptr = p2ptr;
-            } else if (size == 3) {
-                p1ptr = *patchIT;
-                p2ptr = *patchIT;
-                ++patchIT;
-                p3ptr = *patchIT;
-            } else if (size == 4) {
-                p1ptr = *patchIT;
-                ++patchIT;
-                p2ptr = *patchIT;
-                ++patchIT;
-                p3ptr = *patchIT;
-            }
-            assert(p0ptr && p1ptr && p2ptr && p3ptr);
-
-            Point p0, p0p1, p1p0, p1, p1p2, p2p1, p2p3, p3p2, p2, p3, p3p0, p0p3;
-
-            p0ptr->getLeftBezierPointAtTime(time, &p0p3.x, &p0p3.y);
-            p0ptr->getPositionAtTime(time, &p0.x, &p0.y);
-            p0ptr->getRightBezierPointAtTime(time, &p0p1.x, &p0p1.y);
-
-            p1ptr->getLeftBezierPointAtTime(time, &p1p0.x, &p1p0.y);
-            p1ptr->getPositionAtTime(time, &p1.x, &p1.y);
-            p1ptr->getRightBezierPointAtTime(time, &p1p2.x, &p1p2.y);
-
-            p2ptr->getLeftBezierPointAtTime(time, &p2p1.x, &p2p1.y);
-            p2ptr->getPositionAtTime(time, &p2.x, &p2.y);
-            p2ptr->getRightBezierPointAtTime(time, &p2p3.x, &p2p3.y);
-
-            p3ptr->getLeftBezierPointAtTime(time, &p3p2.x, &p3p2.y);
-            p3ptr->getPositionAtTime(time, &p3.x, &p3.y);
-            p3ptr->getRightBezierPointAtTime(time, &p3p0.x, &p3p0.y);
-
-
-            adjustToPointToScale(mipmapLevel, p0.x, p0.y);
-            adjustToPointToScale(mipmapLevel, p0p1.x, p0p1.y);
-            adjustToPointToScale(mipmapLevel, p1p0.x, p1p0.y);
-            adjustToPointToScale(mipmapLevel, p1.x, p1.y);
-            adjustToPointToScale(mipmapLevel, p1p2.x, p1p2.y);
-            adjustToPointToScale(mipmapLevel, p2p1.x, p2p1.y);
-            adjustToPointToScale(mipmapLevel, p2.x, p2.y);
-            adjustToPointToScale(mipmapLevel, p2p3.x, p2p3.y);
-            adjustToPointToScale(mipmapLevel, p3p2.x, p3p2.y);
-            adjustToPointToScale(mipmapLevel, p3.x, p3.y);
-            adjustToPointToScale(mipmapLevel, p3p0.x, p3p0.y);
-            adjustToPointToScale(mipmapLevel, p0p3.x, p0p3.y);
-
-            // Add a Coons patch such as:
-
-            //         C1  Side 1   C2
-            //        +---------------+
-            //        |               |
-            //        |  P1       P2  |
-            //        |               |
-            // Side 0 |               | Side 2
-            //        |               |
-            //        |               |
-            //        |  P0       P3  |
-            //        |               |
-            //        +---------------+
-            //        C0     Side 3   C3
-
-            // In the above drawing, C0 is p0, P0 is p0p1, P1 is p1p0, C1 is p1 and so on...
-
-            ///move to C0
-            cairo_mesh_pattern_begin_patch(mesh);
-            cairo_mesh_pattern_move_to(mesh, p0.x, p0.y);
-            if (size == 4) {
-                cairo_mesh_pattern_curve_to(mesh, p0p1.x, p0p1.y, p1p0.x, p1p0.y, p1.x, p1.y);
-                cairo_mesh_pattern_curve_to(mesh, p1p2.x, p1p2.y, p2p1.x, p2p1.y, p2.x, p2.y);
-                cairo_mesh_pattern_curve_to(mesh, p2p3.x, p2p3.y, p3p2.x, p3p2.y, p3.x, p3.y);
-                cairo_mesh_pattern_curve_to(mesh, p3p0.x, p3p0.y, p0p3.x, p0p3.y, p0.x, p0.y);
-            } else if (size == 3) {
-                cairo_mesh_pattern_curve_to(mesh, p0p1.x, p0p1.y, p1p0.x, p1p0.y, p1.x, p1.y);
-                cairo_mesh_pattern_line_to(mesh, p2.x, p2.y);
-                cairo_mesh_pattern_curve_to(mesh, p2p3.x, p2p3.y, p3p2.x, p3p2.y, p3.x, p3.y);
-                cairo_mesh_pattern_curve_to(mesh, p3p0.x, p3p0.y, p0p3.x, p0p3.y, p0.x, p0.y);
-            } else {
-                assert(size == 2);
-                cairo_mesh_pattern_line_to(mesh, p1.x, p1.y);
-                cairo_mesh_pattern_curve_to(mesh, p1p2.x, p1p2.y, p2p1.x, p2p1.y, p2.x, p2.y);
-                cairo_mesh_pattern_line_to(mesh, p3.x, p3.y);
-                cairo_mesh_pattern_curve_to(mesh, p3p0.x, p3p0.y, p0p3.x, p0p3.y, p0.x, p0.y);
-            }
-            ///Set the 4 corners color
-
-            // IMPORTANT NOTE:
-            // The two sqrt below are due to a probable cairo bug.
-            // To check wether the bug is present is a given cairo version,
-            // make any shape with a very large feather and set
-            // opacity to 0.5. Then, zoom on the polygon border to check if the intensity is continuous
-            // and approximately equal to 0.5.
-            // If the bug if ixed in cairo, please use #if CAIRO_VERSION>xxx to keep compatibility with
-            // older Cairo versions.
-            cairo_mesh_pattern_set_corner_color_rgba( mesh, 0, shapeColor[0], shapeColor[1], shapeColor[2],
-                                                     std::sqrt(opacity) );
-            cairo_mesh_pattern_set_corner_color_rgba(mesh, 1, shapeColor[0], shapeColor[1], shapeColor[2],
-                                                     opacity);
-            cairo_mesh_pattern_set_corner_color_rgba(mesh, 2, shapeColor[0], shapeColor[1], shapeColor[2],
-                                                     opacity);
-            cairo_mesh_pattern_set_corner_color_rgba( mesh, 3, shapeColor[0], shapeColor[1], shapeColor[2],
-                                                     std::sqrt(opacity) );
-            assert(cairo_pattern_status(mesh) == CAIRO_STATUS_SUCCESS);
-
-            cairo_mesh_pattern_end_patch(mesh);
-        }
-    }
-#else // ifdef ROTO_USE_MESH_PATTERN_ONLY
-
-    cairo_set_source_rgba(cr, 1, 1, 1, 1);
-
-    BezierCPs::const_iterator point = cps.begin();
-    assert( point != cps.end() );
-    if ( point == cps.end() ) {
-        return;
-    }
-    BezierCPs::const_iterator nextPoint = point;
-    if ( nextPoint != cps.end() ) {
-        ++nextPoint;
-    }
-
-
-    Transform::Point3D initCp;
-    (*point)->getPositionAtTime(false, time, ViewIdx(0), &initCp.x, &initCp.y);
-    initCp.z = 1.;
-    initCp = Transform::matApply(transform, initCp);
-
-    adjustToPointToScale(mipmapLevel, initCp.x, initCp.y);
-
-    cairo_move_to(cr, initCp.x, initCp.y);
-
-    while ( point != cps.end() ) {
-        if ( nextPoint == cps.end() ) {
-            nextPoint = cps.begin();
-        }
-
-        Transform::Point3D right, nextLeft, next;
-        (*point)->getRightBezierPointAtTime(false, time, ViewIdx(0), &right.x, &right.y);
-        right.z = 1;
-        (*nextPoint)->getLeftBezierPointAtTime(false, time, ViewIdx(0), &nextLeft.x, &nextLeft.y);
-        nextLeft.z = 1;
-        (*nextPoint)->getPositionAtTime(false, time, ViewIdx(0), &next.x, &next.y);
-        next.z = 1;
-
-        right = Transform::matApply(transform, right);
-        nextLeft = Transform::matApply(transform, nextLeft);
-        next = Transform::matApply(transform, next);
-
-        adjustToPointToScale(mipmapLevel, right.x, right.y);
-        adjustToPointToScale(mipmapLevel, next.x, next.y);
-        adjustToPointToScale(mipmapLevel, nextLeft.x, nextLeft.y);
-        cairo_curve_to(cr, right.x, right.y, nextLeft.x, nextLeft.y, next.x, next.y);
-
-        // increment for next iteration
-        ++point;
-        if ( nextPoint != cps.end() ) {
-            ++nextPoint;
-        }
-    } // while()
-    //    if (cairo_get_antialias(cr) != CAIRO_ANTIALIAS_NONE ) {
-    //        cairo_fill_preserve(cr);
-    //        // These line properties make for a nicer looking polygon mesh
-    //        cairo_set_line_join(cr, CAIRO_LINE_JOIN_BEVEL);
-    //        cairo_set_line_cap(cr, CAIRO_LINE_CAP_BUTT);
-    //        // Comment out the following call to cairo_set_line width
-    //        // since the hard-coded width value of 1.0 is not appropriate
-    //        // for fills of small areas. Instead, use the line width that
-    //        // has already been set by the user via the above call of
-    //        // poly_line which in turn calls set_current_context which in
-    //        // turn calls cairo_set_line_width for the user-specified
-    //        // width.
-    //        cairo_set_line_width(cr, 1.0);
-    //        cairo_stroke(cr);
-    //    } else {
-    cairo_fill(cr);
-    //    }
-#endif // ifdef ROTO_USE_MESH_PATTERN_ONLY
-} // RotoShapeRenderCairo::renderInternalShape_old_cairo
-
 
 void
 RotoShapeRenderCairo::renderMaskInternal_cairo(const RotoDrawableItemPtr& rotoItem,
@@ -1900,6 +1539,8 @@ RotoShapeRenderCairo::renderMaskInternal_cairo(const RotoDrawableItemPtr& rotoIt
                                                const Point& lastCenterPointIn,
                                                const std::list<std::list<std::pair<Point, double> > >& strokes,
                                                const ImagePtr &dstImage,
+                                               RotoBezierTriangulationCache* triangulationCache,
+                                               U64 itemHash,
                                                double* distToNextOut,
                                                Point* lastCenterPointOut)
 {
@@ -1996,7 +1637,7 @@ RotoShapeRenderCairo::renderMaskInternal_cairo(const RotoDrawableItemPtr& rotoIt
     } else {
         ///render the bezier only if finished (closed) and activated
         if ( isBezier->isCurveFinished() && isBezier->isActivated(time) && ( isBezier->getControlPointsCount() >1 ) ) {
-            RotoShapeRenderCairo::renderBezier_cairo(imgWrapper.ctx, isBezier, opacity, time, startTime, endTime, timeStep, mipmapLevel);
+            RotoShapeRenderCairo::renderBezier_cairo(imgWrapper.ctx, isBezier, opacity, time, startTime, endTime, timeStep, mipmapLevel, triangulationCache, itemHash);
         }
     }
 
@@ -118,27 +118,21 @@ public:
                                    Point* lastCenterPoint);
 
     /**
-     * @brief Low level: renders the given bezier with motion blur onto the given cairo image
+     * @brief Low level: renders the given bezier with motion blur onto the given cairo image.
+     * Motion-blur samples are rasterized concurrently in separate coverage buffers which are then composited onto the image.
+     * The triangulation of each sample is fetched from the given cache. The opacity is not used here: it is applied when
+     * converting the cairo image to the Natron image.
      **/
-    static void renderBezier_cairo(cairo_t* cr, const Bezier* bezier, double opacity, double time, double startTime, double endTime, double mbFrameStep, unsigned int mipmapLevel);
+    static void renderBezier_cairo(cairo_t* cr, const Bezier* bezier, double opacity, double time, double startTime, double endTime, double mbFrameStep, unsigned int mipmapLevel,
+                                   RotoBezierTriangulationCache* triangulationCache, U64 itemHash);
 
     /**
-     * @brief Low level: renders the given bezier feather onto the given mesh pattern. This uses the old algorithm which does not use triangulation.
-     **/
-    static void renderFeather_old_cairo(const Bezier * bezier, double time, unsigned int mipmapLevel, double shapeColor[3], double opacity, double featherDist, double fallOff, cairo_pattern_t * mesh);
-
-    /**
-    * @brief Low level: renders the given internal bezier shape onto the given mesh pattern. This uses the old algorithm which does not use triangulation.
-    **/
-    static void renderInternalShape_old_cairo(double time, unsigned int mipmapLevel, double shapeColor[3], double opacity, const Transform::Matrix3x3 & transform, cairo_t * cr, cairo_pattern_t * mesh, const BezierCPs &cps);
-
-    /**
-     * @brief Low level: renders the given bezier feather onto the given mesh pattern. This uses the new algorithm which does use triangulation.
+     * @brief Low level: renders the given bezier feather onto the given mesh pattern from its triangulation.
      **/
     static void renderFeather_cairo(const RotoBezierTriangulation::PolygonData& inArgs, double shapeColor[3],  double fallOff, cairo_pattern_t * mesh);
 
     /**
-     * @brief Low level: renders the given internal bezier shape onto the given mesh pattern. This uses the new algorithm which does use triangulation.
+     * @brief Low level: renders the given internal bezier shape onto the given mesh pattern from its triangulation.
      **/
     static void renderInternalShape_cairo(const RotoBezierTriangulation::PolygonData& inArgs,
                                           double shapeColor[3],  cairo_pattern_t * mesh);
@@ -161,6 +155,8 @@ public:
                                          const Point& lastCenterPointIn,
                                          const std::list<std::list<std::pair<Point, double> > >& strokes,
                                          const ImagePtr &dstImage,
+                                         RotoBezierTriangulationCache* triangulationCache,
+                                         U64 itemHash,
                                          double* distToNextOut,
                                          Point* lastCenterPointOut);
 
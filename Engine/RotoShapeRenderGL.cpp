@@ -48,16 +48,16 @@ static const char* rotoRamp_FragmentShader =
 "	gl_FragColor = fillColor;\n"
 "   float t = gl_Color.a;\n"
 "#ifdef RAMP_P_LINEAR\n"
-"   t = t * t * t;\n"
+"   t = " ROTO_RAMP_GLSL( ROTO_RAMP_P_LINEAR(t) ) ";\n"
 "#endif\n"
 "#ifdef RAMP_EASE_IN\n"
-"   t = t * t * (2.0 - t);\n"
+"   t = " ROTO_RAMP_GLSL( ROTO_RAMP_EASE_IN(t) ) ";\n"
 "#endif\n"
 "#ifdef RAMP_EASE_OUT\n"
-"   t = t * (1.0 + t * (1.0 - t));\n"
+"   t = " ROTO_RAMP_GLSL( ROTO_RAMP_EASE_OUT(t) ) ";\n"
 "#endif\n"
 "#ifdef RAMP_SMOOTH\n"
-"   t = t * t * (3.0 - 2.0 * t); \n"
+"   t = " ROTO_RAMP_GLSL( ROTO_RAMP_SMOOTH(t) ) ";\n"
 "#endif\n"
 "   gl_FragColor.a = pow(t,fallOff);\n"
 "   gl_FragColor.rgb *= gl_FragColor.a;\n"
@@ -635,6 +635,8 @@ RotoShapeRenderGL::renderBezier_gl(const OSGLContextPtr& glContext,
                                    double endTime,
                                    double mbFrameStep,
                                    unsigned int mipmapLevel,
+                                   RotoBezierTriangulationCache* triangulationCache,
+                                   U64 itemHash,
                                    int target)
 {
     Q_UNUSED(roi);
@@ -670,8 +672,9 @@ RotoShapeRenderGL::renderBezier_gl(const OSGLContextPtr& glContext,
             featherDist /= (1 << mipmapLevel);
         }
 
-        RotoBezierTriangulation::PolygonData data;
-        RotoBezierTriangulation::computeTriangles(bezier, t, mipmapLevel, featherDist, &data);
+        assert(triangulationCache);
+        RotoBezierTriangulation::PolygonDataConstPtr dataPtr = triangulationCache->getOrComputeTriangles(bezier, itemHash, t, mipmapLevel, featherDist);
+        const RotoBezierTriangulation::PolygonData& data = *dataPtr;
 
         if (glContext->isGPUContext()) {
             setupTexParams<GL_GPU>(target);
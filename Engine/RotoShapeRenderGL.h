@@ -66,6 +66,42 @@ enum RampTypeEnum
 
 };
 
+// The feather ramp functions, written once for the feather shader (as GLSL source) and for applyRotoRampType.
+// t is in [0, 1] and is 1 on the inner vertices of the feather.
+#define ROTO_RAMP_P_LINEAR(t) t * t * t
+#define ROTO_RAMP_EASE_IN(t) t * t * (2.0 - t)
+#define ROTO_RAMP_EASE_OUT(t) t * (1.0 + t * (1.0 - t))
+#define ROTO_RAMP_SMOOTH(t) t * t * (3.0 - 2.0 * t)
+#define ROTO_RAMP_STR(s) # s
+#define ROTO_RAMP_GLSL(expr) ROTO_RAMP_STR(expr)
+
+/**
+ * @brief Applies the given ramp type to t in [0, 1], as the feather shader does before the fall-off.
+ **/
+inline double
+applyRotoRampType(double t,
+                  RampTypeEnum type)
+{
+    switch (type) {
+    case eRampTypeLinear:
+        break;
+    case eRampTypePLinear:
+        t = ROTO_RAMP_P_LINEAR(t);
+        break;
+    case eRampTypeEaseIn:
+        t = ROTO_RAMP_EASE_IN(t);
+        break;
+    case eRampTypeEaseOut:
+        t = ROTO_RAMP_EASE_OUT(t);
+        break;
+    case eRampTypeSmooth:
+        t = ROTO_RAMP_SMOOTH(t);
+        break;
+    }
+
+    return t;
+}
+
 class RotoShapeRenderNodeOpenGLData : public EffectOpenGLContextData
 {
     unsigned int _iboID, _vboVerticesID, _vboColorsID;
@@ -156,6 +192,8 @@ public:
                                 double endTime,
                                 double mbFrameStep,
                                 unsigned int mipmapLevel,
+                                RotoBezierTriangulationCache* triangulationCache,
+                                U64 itemHash,
                                 int target);
 
 };
@@ -26,6 +26,7 @@
 
 
 #include "Engine/AppInstance.h"
+#include "Engine/AppManager.h"
 #include "Engine/Bezier.h"
 #include "Engine/Image.h"
 #include "Engine/Node.h"
@@ -36,8 +37,10 @@
 #include "Engine/RotoStrokeItem.h"
 #include "Engine/RotoShapeRenderNodePrivate.h"
 #include "Engine/RotoShapeRenderCairo.h"
+#include "Engine/RotoShapeRenderCPU.h"
 #include "Engine/RotoShapeRenderGL.h"
 #include "Engine/ParallelRenderArgs.h"
+#include "Engine/Settings.h"
 
 
 NATRON_NAMESPACE_ENTER;
@@ -60,13 +63,28 @@ RotoShapeRenderNode::~RotoShapeRenderNode()
 
 }
 
+/**
+ * @brief Returns true if the item is rendered on CPU by RotoShapeRenderCPU: only closed beziers are supported,
+ * when the native renderer is selected in the preferences.
+ **/
+static bool
+isRenderedByNativeCPURenderer(const RotoDrawableItem* item)
+{
+    const Bezier* isBezier = dynamic_cast<const Bezier*>(item);
+
+    return isBezier && !isBezier->isOpenBezier() && appPTR->getCurrentSettings()->isNativeRotoCPURendererEnabled();
+}
+
 bool
 RotoShapeRenderNode::canCPUImplementationSupportOSMesa() const
 {
 #ifdef ROTO_SHAPE_RENDER_ENABLE_CAIRO
     return false;
 #else
-    return true;
+    // Strokes and open beziers are rendered with OSMesa on CPU
+    RotoDrawableItemPtr rotoItem = getNode()->getAttachedRotoItem();
+
+    return !isRenderedByNativeCPURenderer( rotoItem.get() );
 #endif
 }
 
@@ -201,18 +219,6 @@ StatusEnum
 RotoShapeRenderNode::render(const RenderActionArgs& args)
 {
 
-#if !defined(ROTO_SHAPE_RENDER_ENABLE_CAIRO) && !defined(HAVE_OSMESA)
-    setPersistentMessage(eMessageTypeError, tr("Roto requires either OSMesa (CONFIG += enable-osmesa) or Cairo (CONFIG += enable-cairo) in order to render on CPU").toStdString());
-    return eStatusFailed;
-#endif
-
-#if !defined(ROTO_SHAPE_RENDER_ENABLE_CAIRO)
-    if (!args.useOpenGL) {
-        setPersistentMessage(eMessageTypeError, tr("An OpenGL context is required to draw with the Roto node. This might be because you are trying to render an image too big for OpenGL.").toStdString());
-        return eStatusFailed;
-    }
-#endif
-
     RotoDrawableItemPtr rotoItem = getNode()->getAttachedRotoItem();
     assert(rotoItem);
     if (!rotoItem) {
@@ -224,6 +230,23 @@ RotoShapeRenderNode::render(const RenderActionArgs& args)
     RotoStrokeItem* isStroke = dynamic_cast<RotoStrokeItem*>(rotoItem.get());
     Bezier* isBezier = dynamic_cast<Bezier*>(rotoItem.get());
 
+    // Closed beziers may be rendered on CPU by RotoShapeRenderCPU, see the "Native Roto renderer" preference.
+    // Otherwise strokes and shapes are rendered by Cairo on CPU, or by OpenGL.
+    const bool renderBezierOnCPU = isRenderedByNativeCPURenderer( rotoItem.get() );
+    if (!renderBezierOnCPU) {
+#if !defined(ROTO_SHAPE_RENDER_ENABLE_CAIRO) && !defined(HAVE_OSMESA)
+        setPersistentMessage(eMessageTypeError, tr("Roto requires either OSMesa (CONFIG += enable-osmesa) or Cairo (CONFIG += enable-cairo) in order to render strokes on CPU").toStdString());
+        return eStatusFailed;
+#endif
+
+#if !defined(ROTO_SHAPE_RENDER_ENABLE_CAIRO)
+        if (!args.useOpenGL) {
+            setPersistentMessage(eMessageTypeError, tr("An OpenGL context is required to draw with the Roto node. This might be because you are trying to render an image too big for OpenGL.").toStdString());
+            return eStatusFailed;
+        }
+#endif
+    }
+
     if (type == eRotoShapeRenderTypeSmear && !isStroke) {
         return eStatusFailed;
     }
@@ -348,9 +371,13 @@ RotoShapeRenderNode::render(const RenderActionArgs& args)
             }
 #endif
 
+            if (!args.useOpenGL && renderBezierOnCPU) {
+                double opacity = rotoItem->getOpacity(args.time);
+                RotoShapeRenderCPU::renderBezier_cpu(isBezier, opacity, args.time, startTime, endTime, mbFrameStep, mipmapLevel, &_imp->triangulationCache, getRenderHash(), args.roi, outputPlane.second);
+            }
 #ifdef ROTO_SHAPE_RENDER_ENABLE_CAIRO
-            if (!args.useOpenGL) {
-                RotoShapeRenderCairo::renderMaskInternal_cairo(rotoItem, args.roi, outputPlane.first, startTime, endTime, mbFrameStep, args.time, outputPlane.second->getBitDepth(), mipmapLevel, isDuringPainting, distNextIn, lastCenterIn, strokes, outputPlane.second, &distToNextOut, &lastCenterOut);
+            else if (!args.useOpenGL) {
+                RotoShapeRenderCairo::renderMaskInternal_cairo(rotoItem, args.roi, outputPlane.first, startTime, endTime, mbFrameStep, args.time, outputPlane.second->getBitDepth(), mipmapLevel, isDuringPainting, distNextIn, lastCenterIn, strokes, outputPlane.second, &_imp->triangulationCache, getRenderHash(), &distToNextOut, &lastCenterOut);
                 if (isDuringPainting) {
                     getApp()->updateStrokeData(lastCenterOut, distToNextOut);
                 }
@@ -370,7 +397,7 @@ RotoShapeRenderNode::render(const RenderActionArgs& args)
                 } else {
                     RotoShapeRenderGL::renderBezier_gl(glContext, glData,
                                                        args.roi,
-                                                       isBezier, opacity, args.time, startTime, endTime, mbFrameStep, mipmapLevel, outputPlane.second->getGLTextureTarget());
+                                                       isBezier, opacity, args.time, startTime, endTime, mbFrameStep, mipmapLevel, &_imp->triangulationCache, getRenderHash(), outputPlane.second->getGLTextureTarget());
                 }
             }
         }   break;
@@ -466,6 +493,7 @@ RotoShapeRenderNode::purgeCaches()
     if (!rotoItem) {
         return;
     }
+    _imp->triangulationCache.clear();
 #ifdef ROTO_SHAPE_RENDER_ENABLE_CAIRO
     RotoShapeRenderCairo::purgeCaches_cairo(rotoItem);
 #endif
@@ -29,6 +29,7 @@
 #include "Engine/EngineFwd.h"
 #include "Global/GlobalDefines.h"
 #include "Engine/OSGLContext.h"
+#include "Engine/RotoBezierTriangulation.h"
 
 
 NATRON_NAMESPACE_ENTER;
@@ -45,6 +46,9 @@ public:
     // of preserving the actual content.
     ImagePtr osmesaSmearTmpTexture;
 
+    // Triangulations of the attached bezier, shared across renders until the node hash changes
+    RotoBezierTriangulationCache triangulationCache;
+
 
     RotoShapeRenderNodePrivate();
 
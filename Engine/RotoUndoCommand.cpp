@@ -81,25 +81,13 @@ MoveControlPointsUndoCommand::MoveControlPointsUndoCommand(const RotoPaintIntera
 
     roto->getSelection(&_selectedCurves, &_selectedPoints);
 
-    ///we make a copy of the points
+    ///we save what the move may change on the points: a ripple edit changes all keyframes, otherwise only the one at _time
     for (SelectedCpList::iterator it = _pointsToDrag.begin(); it != _pointsToDrag.end(); ++it) {
-        CpPtr first, second;
-        if ( it->first->isFeatherPoint() ) {
-            first.reset( new FeatherPoint( it->first->getBezier() ) );
-            first->clone( *(it->first) );
-        } else {
-            first.reset( new BezierCP( *(it->first) ) );
-        }
-
+        _originalPoints.push_back( std::make_pair( BezierCPDelta(), BezierCPDelta() ) );
+        it->first->saveDelta(_time, _rippleEditEnabled, &_originalPoints.back().first);
         if (it->second) {
-            if ( it->second->isFeatherPoint() ) {
-                second.reset( new FeatherPoint( it->second->getBezier() ) );
-                second->clone( *(it->second) );
-            } else {
-                second.reset( new BezierCP( *(it->second) ) );
-            }
+            it->second->saveDelta(_time, _rippleEditEnabled, &_originalPoints.back().second);
         }
-        _originalPoints.push_back( std::make_pair(first, second) );
     }
 
     for (SelectedCpList::iterator it = _pointsToDrag.begin(); it != _pointsToDrag.end(); ++it) {
@@ -118,7 +106,7 @@ MoveControlPointsUndoCommand::~MoveControlPointsUndoCommand()
 void
 MoveControlPointsUndoCommand::undo()
 {
-    SelectedCpList::iterator cpIt = _originalPoints.begin();
+    std::list< std::pair<BezierCPDelta, BezierCPDelta> >::const_iterator cpIt = _originalPoints.begin();
     std::set<Bezier*> beziers;
 
     for (SelectedCpList::iterator it = _pointsToDrag.begin(); it != _pointsToDrag.end(); ++it) {
@@ -126,9 +114,9 @@ MoveControlPointsUndoCommand::undo()
     }
 
     for (SelectedCpList::iterator it = _pointsToDrag.begin(); it != _pointsToDrag.end(); ++it, ++cpIt) {
-        it->first->clone(*cpIt->first);
+        it->first->restoreDelta(cpIt->first);
         if (it->second) {
-            it->second->clone(*cpIt->second);
+            it->second->restoreDelta(cpIt->second);
         }
     }
 
@@ -212,6 +200,19 @@ MoveControlPointsUndoCommand::mergeWith(const UndoCommandPtr& other)
     return true;
 }
 
+std::size_t
+MoveControlPointsUndoCommand::getMemoryCost() const
+{
+    std::size_t ret = sizeof(*this) + getText().size();
+
+    for (std::list< std::pair<BezierCPDelta, BezierCPDelta> >::const_iterator it = _originalPoints.begin(); it != _originalPoints.end(); ++it) {
+        ret += it->first.getMemoryCost() + it->second.getMemoryCost();
+    }
+    ret += ( _selectedPoints.size() + _pointsToDrag.size() ) * sizeof(SelectedCp) + _selectedCurves.size() * sizeof(RotoDrawableItemPtr) + _indexesToMove.size() * sizeof(int);
+
+    return ret;
+}
+
 ////////////////////////
 
 TransformUndoCommand::TransformUndoCommand(const RotoPaintInteractPtr& roto,
@@ -244,14 +245,13 @@ TransformUndoCommand::TransformUndoCommand(const RotoPaintInteractPtr& roto,
 
 
     *_matrix = Transform::matTransformCanonical(tx, ty, sx, sy, skewX, skewY, true, (rot), centerX, centerY);
-    ///we make a copy of the points
+    ///we save what the transform may change on the points: only the keyframe at _time
     for (SelectedCpList::iterator it = _selectedPoints.begin(); it != _selectedPoints.end(); ++it) {
-        CpPtr first( new BezierCP( *(it->first) ) );
-        CpPtr second;
+        _originalPoints.push_back( std::make_pair( BezierCPDelta(), BezierCPDelta() ) );
+        it->first->saveDelta(_time, false, &_originalPoints.back().first);
         if (it->second) {
-            second.reset( new BezierCP( *(it->second) ) );
+            it->second->saveDelta(_time, false, &_originalPoints.back().second);
         }
-        _originalPoints.push_back( std::make_pair(first, second) );
     }
 
     setText( tr("Transform control points").toStdString() );
@@ -264,7 +264,7 @@ TransformUndoCommand::~TransformUndoCommand()
 void
 TransformUndoCommand::undo()
 {
-    SelectedCpList::iterator cpIt = _originalPoints.begin();
+    std::list< std::pair<BezierCPDelta, BezierCPDelta> >::const_iterator cpIt = _originalPoints.begin();
     std::set<Bezier*> beziers;
 
     for (SelectedCpList::iterator it = _selectedPoints.begin(); it != _selectedPoints.end(); ++it) {
@@ -277,9 +277,9 @@ TransformUndoCommand::undo()
 
 
     for (SelectedCpList::iterator it = _selectedPoints.begin(); it != _selectedPoints.end(); ++it, ++cpIt) {
-        it->first->clone(*cpIt->first);
+        it->first->restoreDelta(cpIt->first);
         if (it->second) {
-            it->second->clone(*cpIt->second);
+            it->second->restoreDelta(cpIt->second);
         }
     }
 
@@ -351,6 +351,19 @@ TransformUndoCommand::mergeWith(const UndoCommandPtr& other)
     return true;
 }
 
+std::size_t
+TransformUndoCommand::getMemoryCost() const
+{
+    std::size_t ret = sizeof(*this) + getText().size() + sizeof(Transform::Matrix3x3);
+
+    for (std::list< std::pair<BezierCPDelta, BezierCPDelta> >::const_iterator it = _originalPoints.begin(); it != _originalPoints.end(); ++it) {
+        ret += it->first.getMemoryCost() + it->second.getMemoryCost();
+    }
+    ret += _selectedPoints.size() * sizeof(SelectedCp) + _selectedCurves.size() * sizeof(RotoDrawableItemPtr);
+
+    return ret;
+}
+
 ////////////////////////
 
 
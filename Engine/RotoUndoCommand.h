@@ -27,6 +27,7 @@
 
 #include "Global/Macros.h"
 
+#include <cstddef>
 #include <list>
 #include <map>
 
@@ -36,6 +37,7 @@ CLANG_DIAG_OFF(uninitialized)
 CLANG_DIAG_ON(deprecated)
 CLANG_DIAG_ON(uninitialized)
 
+#include "Engine/BezierCP.h"
 #include "Engine/UndoCommand.h"
 #include "Engine/EngineFwd.h"
 
@@ -61,6 +63,7 @@ public:
     virtual void undo() OVERRIDE FINAL;
     virtual void redo() OVERRIDE FINAL;
     virtual bool mergeWith(const UndoCommandPtr& other) OVERRIDE FINAL;
+    virtual std::size_t getMemoryCost() const OVERRIDE FINAL WARN_UNUSED_RETURN;
 
 private:
 
@@ -73,7 +76,8 @@ private:
     double _time; //< the time at which the change was made
     std::list<RotoDrawableItemPtr > _selectedCurves;
     std::list<int> _indexesToMove; //< indexes of the control points
-    std::list< std::pair<BezierCPPtr, BezierCPPtr > > _originalPoints, _selectedPoints, _pointsToDrag;
+    std::list< std::pair<BezierCPDelta, BezierCPDelta> > _originalPoints; //< what the move changes on _pointsToDrag
+    std::list< std::pair<BezierCPPtr, BezierCPPtr > > _selectedPoints, _pointsToDrag;
 };
 
 
@@ -110,6 +114,7 @@ public:
     virtual void undo() OVERRIDE FINAL;
     virtual void redo() OVERRIDE FINAL;
     virtual bool mergeWith(const UndoCommandPtr& other) OVERRIDE FINAL;
+    virtual std::size_t getMemoryCost() const OVERRIDE FINAL WARN_UNUSED_RETURN;
 
 private:
 
@@ -122,7 +127,8 @@ private:
     boost::shared_ptr<Transform::Matrix3x3> _matrix;
     double _time; //< the time at which the change was made
     std::list<RotoDrawableItemPtr > _selectedCurves;
-    std::list< std::pair<BezierCPPtr, BezierCPPtr > > _originalPoints, _selectedPoints;
+    std::list< std::pair<BezierCPDelta, BezierCPDelta> > _originalPoints; //< what the transform changes on _selectedPoints
+    std::list< std::pair<BezierCPPtr, BezierCPPtr > > _selectedPoints;
 };
 
 class AddPointUndoCommand
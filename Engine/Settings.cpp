@@ -389,7 +389,9 @@ Settings::initializeKnobsRendering()
                                                      "that write to the source image, thus modifying the output of the node upstream in "
                                                      "the cache. This is a known bug of an old version of RevisionFX REMap for instance. "
                                                      "By default, this parameter should be leaved unchecked, as this will require an extra "
-                                                     "image allocation and copy before rendering any plug-in.").arg( QString::fromUtf8(NATRON_APPLICATION_NAME) ) );
+                                                     "image allocation and copy before rendering any plug-in. To only copy the input images "
+                                                     "of the plug-ins that need it, check \"Copy inputs\" for those plug-ins in the "
+                                                     "Plug-ins tab instead.").arg( QString::fromUtf8(NATRON_APPLICATION_NAME) ) );
     _renderingPage->addKnob(_pluginUseImageCopyForSource);
 
     _activateRGBSupport = AppManager::createKnob<KnobBool>( shared_from_this(), tr("RGB components support") );
@@ -408,6 +410,15 @@ Settings::initializeKnobsRendering()
                                                                "transformations.").arg( QString::fromUtf8(NATRON_APPLICATION_NAME) ) );
     _activateTransformConcatenationSupport->setName("transformCatSupport");
     _renderingPage->addKnob(_activateTransformConcatenationSupport);
+
+    _rotoUseNativeCPURenderer = AppManager::createKnob<KnobBool>( shared_from_this(), tr("Native Roto renderer") );
+    _rotoUseNativeCPURenderer->setHintToolTip( tr("When checked, closed Roto shapes rendered on the CPU are rasterized by %1 with "
+                                                  "exact anti-aliasing, which is faster than Cairo and OSMesa. Strokes and open shapes "
+                                                  "are not affected. "
+                                                  "The result differs slightly from the Cairo renderer: images already in the cache "
+                                                  "are not rendered again when this option changes.").arg( QString::fromUtf8(NATRON_APPLICATION_NAME) ) );
+    _rotoUseNativeCPURenderer->setName("rotoNativeCPURenderer");
+    _renderingPage->addKnob(_rotoUseNativeCPURenderer);
 }
 
 void
@@ -1162,6 +1173,21 @@ Settings::initializeKnobsViewers()
     _autoProxyLevel->populateChoices(autoProxyChoices);
     _viewersTab->addKnob(_autoProxyLevel);
 
+    _progressiveViewerRendering = AppManager::createKnob<KnobBool>( shared_from_this(), tr("Progressive rendering") );
+    _progressiveViewerRendering->setName("progressiveViewerRendering");
+    _progressiveViewerRendering->setHintToolTip( tr("When checked, an image that is not cached is first rendered in the viewer "
+                                                    "at the level indicated by the auto-proxy parameter to give an immediate feedback, "
+                                                    "then at full resolution.") );
+    _viewersTab->addKnob(_progressiveViewerRendering);
+
+    _realTimePlayback = AppManager::createKnob<KnobBool>( shared_from_this(), tr("Maintain real-time playback") );
+    _realTimePlayback->setName("realTimePlayback");
+    _realTimePlayback->setHintToolTip( tr("When checked, the viewer holds the playback frame rate when the frames cannot be rendered "
+                                          "fast enough: frames that are late are skipped, and if frames keep being skipped "
+                                          "the frames are rendered at a lower resolution, down to the level indicated by the auto-proxy parameter. "
+                                          "When unchecked, every frame is displayed at full resolution, even if the playback slows down.") );
+    _viewersTab->addKnob(_realTimePlayback);
+
     _maximumNodeViewerUIOpened = AppManager::createKnob<KnobInt>( shared_from_this(), tr("Max. opened node viewer interface") );
     _maximumNodeViewerUIOpened->setName("maxNodeUiOpened");
     _maximumNodeViewerUIOpened->setMinimum(1);
@@ -1221,6 +1247,17 @@ Settings::initializeKnobsNodeGraph()
                                               "Changing this value will clear the undo/redo stack.").arg( QString::fromUtf8(NATRON_APPLICATION_NAME) ) );
     _nodegraphTab->addKnob(_maxUndoRedoNodeGraph);
 
+    _maxUndoRedoMemory = AppManager::createKnob<KnobInt>( shared_from_this(), tr("Maximum undo/redo memory per panel (MiB)") );
+    _maxUndoRedoMemory->setName("maxUndoRedoMemory");
+    _maxUndoRedoMemory->disableSlider();
+    _maxUndoRedoMemory->setMinimum(0);
+    _maxUndoRedoMemory->setHintToolTip( tr("Set the maximum memory the undo/redo history of a settings panel (e.g. a Roto node "
+                                           "being edited) may take. When recording a new event exceeds this size, "
+                                           "the oldest events of the history of the panel are forgotten. The current size is shown in the "
+                                           "tooltip of the panel undo button.\n"
+                                           "When set to 0, the history is not limited.") );
+    _nodegraphTab->addKnob(_maxUndoRedoMemory);
+
 
     _disconnectedArrowLength = AppManager::createKnob<KnobInt>( shared_from_this(), tr("Disconnected arrow length") );
     _disconnectedArrowLength->setName("disconnectedArrowLength");
@@ -1272,6 +1309,13 @@ Settings::initializeKnobsCaching()
         ramHint.append( tr("The version of %1 you are running is 32 bits, which means the available RAM "
                            "is limited to 4GiB. The amount of RAM used for caching is 4GiB * MaxRamPercent.").arg( QString::fromUtf8(NATRON_APPLICATION_NAME) ) );
     }
+    U64 cgroupLimit = getCGroupMemoryLimit();
+    if (cgroupLimit) {
+        ramHint.append( QString::fromUtf8("\n") );
+        ramHint.append( tr("The memory of this process is limited to %1 by its cgroup (e.g. a container): "
+                           "the percentage applies to this limit. The memory caches are also shrunk automatically "
+                           "when the system is under memory pressure.").arg( printAsRAM(cgroupLimit) ) );
+    }
 
     _maxRAMPercent->setHintToolTip(ramHint);
     _maxRAMPercent->setAddNewLine(false);
@@ -1314,6 +1358,25 @@ Settings::initializeKnobsCaching()
     _maxViewerDiskCacheGB->setHintToolTip( tr("The maximum size that may be used by the playback cache on disk (in GiB)") );
     _cachingTab->addKnob(_maxViewerDiskCacheGB);
 
+    _viewerCacheCompression = AppManager::createKnob<KnobChoice>( shared_from_this(), tr("Playback cache compression") );
+    _viewerCacheCompression->setName("viewerCacheCompression");
+    {
+        std::vector<std::string> entries, helps;
+        entries.push_back("None");
+        helps.push_back( tr("Viewer textures are stored as is in the playback cache.").toStdString() );
+        entries.push_back("2:1");
+        helps.push_back( tr("Viewer textures take half the space in the playback cache. Textures are stored losslessly "
+                            "unless they are too noisy to fit, in which case their least significant bits are dropped.").toStdString() );
+        entries.push_back("4:1");
+        helps.push_back( tr("Viewer textures take a quarter of the space in the playback cache. Most textures lose some "
+                            "precision in their least significant bits.").toStdString() );
+        _viewerCacheCompression->populateChoices(entries, helps);
+    }
+    _viewerCacheCompression->setHintToolTip( tr("Compressing the viewer textures allows the playback cache to hold more frames "
+                                                "within the same disk space, at the expense of some CPU time when rendering and "
+                                                "reading back a frame. Changing this setting clears the playback cache.") );
+    _cachingTab->addKnob(_viewerCacheCompression);
+
     _maxDiskCacheNodeGB = AppManager::createKnob<KnobInt>( shared_from_this(), tr("Maximum DiskCache node disk usage (GiB)") );
     _maxDiskCacheNodeGB->setName("maxDiskCacheNode");
     _maxDiskCacheNodeGB->disableSlider();
@@ -1464,7 +1527,7 @@ void
 Settings::setCachingLabels()
 {
     int maxTotalRam = _maxRAMPercent->getValue();
-    U64 systemTotalRam = getSystemTotalRAM();
+    U64 systemTotalRam = getSystemTotalRAM_conditionnally();
     U64 maxRAM = (U64)( ( (double)maxTotalRam / 100. ) * systemTotalRam );
 
     _maxRAMLabel->setValue( printAsRAM(maxRAM).toStdString() );
@@ -1487,6 +1550,7 @@ Settings::setDefaultValues()
     _autoSaveDelay->setDefaultValue(5, 0);
     _autoSaveUnSavedProjects->setDefaultValue(true);
     _maxUndoRedoNodeGraph->setDefaultValue(20, 0);
+    _maxUndoRedoMemory->setDefaultValue(0, 0);
     _linearPickers->setDefaultValue(true, 0);
     _convertNaNValues->setDefaultValue(true);
     _pluginUseImageCopyForSource->setDefaultValue(false);
@@ -1515,6 +1579,12 @@ Settings::setDefaultValues()
     _renderOnEditingFinished->setDefaultValue(false);
     _activateRGBSupport->setDefaultValue(true);
     _activateTransformConcatenationSupport->setDefaultValue(true);
+#ifdef ROTO_SHAPE_RENDER_ENABLE_CAIRO
+    // Cairo stays the default as long as the output of the native renderer is not bit-compatible with it
+    _rotoUseNativeCPURenderer->setDefaultValue(false);
+#else
+    _rotoUseNativeCPURenderer->setDefaultValue(true);
+#endif
     _extraPluginPaths->setDefaultValue("", 0);
     _preferBundledPlugins->setDefaultValue(true);
     _loadBundledPlugins->setDefaultValue(true);
@@ -1532,6 +1602,8 @@ Settings::setDefaultValues()
     _autoWipe->setDefaultValue(true);
     _autoProxyWhenScrubbingTimeline->setDefaultValue(true);
     _autoProxyLevel->setDefaultValue(1);
+    _progressiveViewerRendering->setDefaultValue(true);
+    _realTimePlayback->setDefaultValue(false);
     _maximumNodeViewerUIOpened->setDefaultValue(2);
     _viewerKeys->setDefaultValue(true);
 
@@ -1542,6 +1614,7 @@ Settings::setDefaultValues()
     _maxRAMPercent->setDefaultValue(50, 0);
     _unreachableRAMPercent->setDefaultValue(5);
     _maxViewerDiskCacheGB->setDefaultValue(5, 0);
+    _viewerCacheCompression->setDefaultValue(0, 0);
     _maxDiskCacheNodeGB->setDefaultValue(10, 0);
     setCachingLabels();
     _autoScroll->setDefaultValue(false);
@@ -1864,6 +1937,14 @@ Settings::restorePluginSettings()
                     settings.setValue(glKey, plugin->isOpenGLEnabled());
                 }
 
+                QString copyInputKey = pluginIDKey + QString::fromUtf8("_copyinput");
+                if ( settings.contains(copyInputKey) ) {
+                    bool copyInputEnabled = settings.value(copyInputKey).toBool();
+                    plugin->setInputImagesCopyEnabled(copyInputEnabled);
+                } else {
+                    settings.setValue( copyInputKey, plugin->isInputImagesCopyEnabled() );
+                }
+
             }
         }
     }
@@ -1895,6 +1976,9 @@ Settings::savePluginsSettings()
             QString glKey = pluginID + QString::fromUtf8("_gl");
             settings.setValue(glKey, plugin->isOpenGLEnabled());
 
+            QString copyInputKey = pluginID + QString::fromUtf8("_copyinput");
+            settings.setValue( copyInputKey, plugin->isInputImagesCopyEnabled() );
+
         }
     }
 }
@@ -2291,6 +2375,8 @@ Settings::onKnobValueChanged(const KnobIPtr& k,
         appPTR->onViewerTileCacheSizeChanged();
     } else if ( k == _texturesMode &&  !_restoringSettings) {
          appPTR->onViewerTileCacheSizeChanged();
+    } else if ( k == _viewerCacheCompression && !_restoringSettings) {
+        appPTR->onViewerTileCacheSizeChanged();
     } else if ( ( k == _hideOptionalInputsAutomatically ) && !_restoringSettings && (reason == eValueChangedReasonUserEdited) ) {
         appPTR->toggleAutoHideGraphInputs();
     } else if ( k == _autoProxyWhenScrubbingTimeline ) {
@@ -2390,6 +2476,22 @@ Settings::getViewerTilesPowerOf2() const
     return _powerOf2Tiling->getValue();
 }
 
+int
+Settings::getViewerCacheCompressionRatio() const
+{
+    switch ( _viewerCacheCompression->getValue() ) {
+    case 1:
+
+        return 2;
+    case 2:
+
+        return 4;
+    default:
+
+        return 1;
+    }
+}
+
 int
 Settings::getCheckerboardTileSize() const
 {
@@ -2438,6 +2540,18 @@ Settings::getAutoProxyMipMapLevel() const
     return (unsigned int)_autoProxyLevel->getValue() + 1;
 }
 
+bool
+Settings::isProgressiveViewerRenderingEnabled() const
+{
+    return _progressiveViewerRendering->getValue();
+}
+
+bool
+Settings::isRealTimePlaybackEnabled() const
+{
+    return _realTimePlayback->getValue();
+}
+
 int
 Settings::getMaxOpenedNodesViewerContext() const
 {
@@ -2683,6 +2797,12 @@ Settings::getMaximumUndoRedoNodeGraph() const
     return _maxUndoRedoNodeGraph->getValue();
 }
 
+int
+Settings::getMaximumUndoRedoMemoryMB() const
+{
+    return _maxUndoRedoMemory->getValue();
+}
+
 int
 Settings::getAutoSaveDelayMS() const
 {
@@ -3010,6 +3130,12 @@ Settings::isTransformConcatenationEnabled() const
     return _activateTransformConcatenationSupport->getValue();
 }
 
+bool
+Settings::isNativeRotoCPURendererEnabled() const
+{
+    return _rotoUseNativeCPURenderer->getValue();
+}
+
 bool
 Settings::useGlobalThreadPool() const
 {
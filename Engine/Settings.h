@@ -116,6 +116,12 @@ public:
 
     U64 getMaximumViewerDiskCacheSize() const;
 
+    /**
+     * @brief The factor by which the viewer textures held in the playback cache are compressed (1, 2 or 4).
+     * 1 means the textures are stored uncompressed.
+     **/
+    int getViewerCacheCompressionRatio() const;
+
     U64 getMaximumDiskCacheNodeSize() const;
 
     double getUnreachableRamPercent() const;
@@ -174,6 +180,9 @@ public:
 
     int getMaximumUndoRedoNodeGraph() const;
 
+    ///0 means the undo/redo history of a panel is not limited
+    int getMaximumUndoRedoMemoryMB() const;
+
     int getAutoSaveDelayMS() const;
 
     bool isAutoSaveEnabledForUnsavedProjects() const;
@@ -249,6 +258,8 @@ public:
     bool isAutoWipeEnabled() const;
     bool isAutoProxyEnabled() const;
     unsigned int getAutoProxyMipMapLevel() const;
+    bool isProgressiveViewerRenderingEnabled() const;
+    bool isRealTimePlaybackEnabled() const;
     int getMaxOpenedNodesViewerContext() const;
     bool isViewerKeysEnabled() const;
     ///////////////////////////////////////////////////////
@@ -257,6 +268,8 @@ public:
 
     bool isTransformConcatenationEnabled() const;
 
+    bool isNativeRotoCPURendererEnabled() const;
+
     bool isMergeAutoConnectingToAInput() const;
 
     /**
@@ -443,6 +456,7 @@ private:
     KnobBoolPtr _pluginUseImageCopyForSource;
     KnobBoolPtr _activateRGBSupport;
     KnobBoolPtr _activateTransformConcatenationSupport;
+    KnobBoolPtr _rotoUseNativeCPURenderer;
 
     // General/GPU rendering
     KnobPagePtr _gpuPage;
@@ -509,6 +523,7 @@ private:
 
     ///The total disk space allowed for all Natron's caches
     KnobIntPtr _maxViewerDiskCacheGB;
+    KnobChoicePtr _viewerCacheCompression;
     KnobIntPtr _maxDiskCacheNodeGB;
     KnobPathPtr _diskCachePath;
     KnobButtonPtr _wipeDiskCache;
@@ -523,6 +538,8 @@ private:
     KnobBoolPtr _autoWipe;
     KnobBoolPtr _autoProxyWhenScrubbingTimeline;
     KnobChoicePtr _autoProxyLevel;
+    KnobBoolPtr _progressiveViewerRendering;
+    KnobBoolPtr _realTimePlayback;
     KnobIntPtr _maximumNodeViewerUIOpened;
     KnobBoolPtr _viewerKeys;
 
@@ -534,6 +551,7 @@ private:
     KnobBoolPtr _snapNodesToConnections;
     KnobBoolPtr _useBWIcons;
     KnobIntPtr _maxUndoRedoNodeGraph;
+    KnobIntPtr _maxUndoRedoMemory;
     KnobIntPtr _disconnectedArrowLength;
     KnobBoolPtr _hideOptionalInputsAutomatically;
     KnobBoolPtr _useInputAForMergeAutoConnect;
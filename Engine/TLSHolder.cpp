@@ -25,6 +25,7 @@
 #include "TLSHolder.h"
 #include "TLSHolderImpl.h"
 
+#include <algorithm> // swap
 #include <cassert>
 #include <stdexcept>
 
@@ -41,11 +42,66 @@
 NATRON_NAMESPACE_ENTER;
 
 
+NATRON_NAMESPACE_ANONYMOUS_ENTER
+
+// Allocation of the slots of the TLSHolder: the slots of destroyed holders are reused
+QMutex holderSlotsMutex;
+std::vector<std::size_t> freeHolderSlots;
+// The id of the holder alive in each slot, 0 if the slot is free
+std::vector<U64> holderSlotIds;
+U64 lastHolderId = 0;
+
+bool
+isHolderAlive(std::size_t slotIndex,
+              U64 holderId)
+{
+    QMutexLocker k(&holderSlotsMutex);
+
+    return slotIndex < holderSlotIds.size() && holderSlotIds[slotIndex] == holderId;
+}
+
+NATRON_NAMESPACE_ANONYMOUS_EXIT
+
+TLSHolderBase::TLSHolderBase()
+    : _slotIndex(0)
+    , _holderId(0)
+{
+    QMutexLocker k(&holderSlotsMutex);
+
+    if ( !freeHolderSlots.empty() ) {
+        _slotIndex = freeHolderSlots.back();
+        freeHolderSlots.pop_back();
+    } else {
+        _slotIndex = holderSlotIds.size();
+        holderSlotIds.push_back(0);
+    }
+    _holderId = ++lastHolderId;
+    holderSlotIds[_slotIndex] = _holderId;
+}
+
+TLSHolderBase::~TLSHolderBase()
+{
+    // Mark the slot as dead first so that a copy to a spawned thread running concurrently does not put a value back
+    {
+        QMutexLocker k(&holderSlotsMutex);
+        holderSlotIds[_slotIndex] = 0;
+    }
+
+    // Release the values of all the threads now: they may hold render data (e.g. EffectTLSData) that must not outlive
+    // the holder, and threads of the pools may stay alive for a long time.
+    // The AppManager is already gone if the holder is destroyed with it, the values are then released with its AppTLS.
+    if (appPTR) {
+        appPTR->getAppTLS()->releaseSlot(_slotIndex, _holderId);
+    }
+
+    QMutexLocker k(&holderSlotsMutex);
+    freeHolderSlots.push_back(_slotIndex);
+}
+
 AppTLS::AppTLS()
-    : _objectMutex()
-    , _object( new GLobalTLSObject() )
-    , _spawnsMutex()
-    , _spawns()
+    : _threadData()
+    , _threadsMutex()
+    , _threads()
 {
 }
 
@@ -53,15 +109,147 @@ AppTLS::~AppTLS()
 {
 }
 
+AppTLS::ThreadDataPtr
+AppTLS::createThreadData()
+{
+    ThreadDataPtr data(new ThreadData);
+    QMutexLocker k(&_threadsMutex);
+
+    //Forget the threads that exited
+    for (ThreadDataMap::iterator it = _threads.begin(); it != _threads.end();) {
+        if ( it->second.expired() ) {
+            _threads.erase(it++);
+        } else {
+            ++it;
+        }
+    }
+    _threads[QThread::currentThread()] = data;
+
+    return data;
+}
+
+AppTLS::ThreadData*
+AppTLS::getThreadData()
+{
+    ThreadDataPtr& data = _threadData.localData();
+
+    if (!data) {
+        data = createThreadData();
+    }
+    if (data->spawnerThread) {
+        const QThread* spawnerThread = data->spawnerThread;
+        data->spawnerThread = 0;
+        copyTLSInternal(spawnerThread, data.get());
+    }
+
+    return data.get();
+}
+
+void
+AppTLS::setSlotValue(ThreadData* data,
+                     const TLSHolderBase* holder,
+                     const boost::shared_ptr<void>& value,
+                     CopyTLSFunctor copyFunctor)
+{
+    Slot slot;
+
+    slot.holderId = holder->_holderId;
+    slot.value = value;
+    slot.copyFunctor = copyFunctor;
+    {
+        QMutexLocker k(&data->slotsMutex);
+        if ( holder->_slotIndex >= data->slots.size() ) {
+            data->slots.resize(holder->_slotIndex + 1);
+        }
+        //Swap so that the value of a destroyed holder previously in the slot is released outside of the lock
+        std::swap(data->slots[holder->_slotIndex], slot);
+    }
+}
+
+void
+AppTLS::copyTLSInternal(const QThread* fromThread,
+                        ThreadData* toData)
+{
+    ThreadDataPtr fromData;
+    {
+        QMutexLocker k(&_threadsMutex);
+        ThreadDataMap::const_iterator found = _threads.find(fromThread);
+        if ( found != _threads.end() ) {
+            fromData = found->second.lock();
+        }
+    }
+
+    if ( !fromData || (fromData.get() == toData) ) {
+        ///No TLS for fromThread
+        return;
+    }
+
+    std::vector<std::pair<std::size_t, Slot> > copies;
+    {
+        QMutexLocker k(&fromData->slotsMutex);
+        for (std::size_t i = 0; i < fromData->slots.size(); ++i) {
+            const Slot& slot = fromData->slots[i];
+            if (!slot.value || !slot.copyFunctor) {
+                continue;
+            }
+            Slot copy;
+            copy.holderId = slot.holderId;
+            copy.value = slot.copyFunctor(slot.value);
+            copy.copyFunctor = slot.copyFunctor;
+            if (copy.value) {
+                copies.push_back( std::make_pair(i, copy) );
+            }
+        }
+    }
+    if ( copies.empty() ) {
+        return;
+    }
+
+    QMutexLocker k(&toData->slotsMutex);
+    for (std::size_t i = 0; i < copies.size(); ++i) {
+        std::size_t index = copies[i].first;
+        //The holder may have been destroyed since the copy was made: its values were already released by
+        //releaseSlot(), which takes the lock of this thread after marking the holder as dead
+        if ( !isHolderAlive(index, copies[i].second.holderId) ) {
+            continue;
+        }
+        if ( index >= toData->slots.size() ) {
+            toData->slots.resize(index + 1);
+        }
+        //Ids are increasing: a higher id in the slot belongs to a holder created after the one we copy from
+        //was destroyed, keep it
+        if (toData->slots[index].holderId <= copies[i].second.holderId) {
+            toData->slots[index] = copies[i].second;
+        }
+    }
+}
+
 void
-AppTLS::registerTLSHolder(const boost::shared_ptr<const TLSHolderBase>& holder)
+AppTLS::releaseSlot(std::size_t slotIndex,
+                    U64 holderId)
 {
-    //This must be the first time for this thread that we reach here since cleanupTLSForThread() was made, otherwise
-    //the TLS data should always be available on the TLSHolder
+    std::vector<ThreadDataPtr> threads;
     {
-        QWriteLocker k(&_objectMutex);
-        //The insert call might not succeed because another thread inserted this holder in the set already, that's fine
-        _object->objects.insert(holder);
+        QMutexLocker k(&_threadsMutex);
+        for (ThreadDataMap::const_iterator it = _threads.begin(); it != _threads.end(); ++it) {
+            ThreadDataPtr data = it->second.lock();
+            if (data) {
+                threads.push_back(data);
+            }
+        }
+    }
+
+    //Release the values outside of the locks: their destructor may use TLS
+    std::vector<Slot> releasedSlots;
+    for (std::size_t i = 0; i < threads.size(); ++i) {
+        QMutexLocker k(&threads[i]->slotsMutex);
+        if ( slotIndex < threads[i]->slots.size() ) {
+            Slot& slot = threads[i]->slots[slotIndex];
+            if (slot.holderId == holderId) {
+                releasedSlots.push_back( Slot() );
+                std::swap(releasedSlots.back(), slot);
+            }
+        }
     }
 }
 
@@ -88,18 +276,11 @@ AppTLS::copyTLS(QThread* fromThread,
     if ( (fromThread == toThread) || !fromThread || !toThread ) {
         return;
     }
+    assert( toThread == QThread::currentThread() );
 
     copyAbortInfo(fromThread, toThread);
 
-    QReadLocker k(&_objectMutex);
-    const TLSObjects& objectsCRef = _object->objects; // take a const ref, since it's a read lock
-    for (TLSObjects::const_iterator it = objectsCRef.begin();
-         it != objectsCRef.end(); ++it) {
-        boost::shared_ptr<const TLSHolderBase> p = (*it).lock();
-        if (p) {
-            p->copyTLS(fromThread, toThread);
-        }
-    }
+    copyTLSInternal( fromThread, getThreadData() );
 }
 
 void
@@ -109,11 +290,15 @@ AppTLS::softCopy(QThread* fromThread,
     if ( (fromThread == toThread) || !fromThread || !toThread ) {
         return;
     }
+    assert( toThread == QThread::currentThread() );
 
     copyAbortInfo(fromThread, toThread);
 
-    QWriteLocker k(&_spawnsMutex);
-    _spawns[toThread] = fromThread;
+    ThreadDataPtr& data = _threadData.localData();
+    if (!data) {
+        data = createThreadData();
+    }
+    data->spawnerThread = fromThread;
 }
 
 void
@@ -126,65 +311,22 @@ AppTLS::cleanupTLSForThread()
         isAbortableThread->clearAbortInfo();
     }
 
-    //Cleanup any cached data on the TLSHolder
-    {
-        QWriteLocker l(&_spawnsMutex);
+    if ( !_threadData.hasLocalData() ) {
+        return;
+    }
+    ThreadDataPtr data = _threadData.localData();
+    if (!data) {
+        return;
+    }
 
-        //This thread was spawned, but TLS not used, do not bother to clean-up
-        ThreadSpawnMap::iterator foundSpawned = _spawns.find(curThread);
-        if ( foundSpawned != _spawns.end() ) {
-            _spawns.erase(foundSpawned);
+    //This thread was spawned, but TLS not used, do not bother to clean-up
+    data->spawnerThread = 0;
 
-            return;
-        }
-    }
-    std::list<boost::shared_ptr<const TLSHolderBase> > objectsToClean;
+    //Release the values outside of the lock
+    std::vector<Slot> slots;
     {
-        QReadLocker k (&_objectMutex);
-        const TLSObjects& objectsCRef = _object->objects;
-        for (TLSObjects::iterator it = objectsCRef.begin();
-             it != objectsCRef.end();
-             ++it) {
-            boost::shared_ptr<const TLSHolderBase> p = (*it).lock();
-            if (p) {
-                if ( p->canCleanupPerThreadData(curThread) ) {
-                    objectsToClean.push_back(p);
-                }
-            }
-        }
-    }
-    if ( !objectsToClean.empty() ) {
-#if 1
-        // version from 1a0712b
-        // should be OK, since the bug in 1a0712b was in canCleanupPerThreadData
-        QWriteLocker k (&_objectMutex);
-        for (std::list<boost::shared_ptr<const TLSHolderBase> >::iterator it = objectsToClean.begin();
-             it != objectsToClean.end();
-             ++it) {
-            if ( (*it)->cleanupPerThreadData(curThread) ) {
-                TLSObjects::iterator found = _object->objects.find(*it);
-                if ( found != _object->objects.end() ) {
-                    _object->objects.erase(found);
-                }
-            }
-        }
-#else
-        // original version
-        TLSObjects newObjects;
-        QWriteLocker k (&_objectMutex);
-        for (TLSObjects::iterator it = _object->objects.begin();
-             it != _object->objects.end(); ++it) {
-            boost::shared_ptr<const TLSHolderBase> p = (*it).lock();
-            if (p) {
-                if ( !p->cleanupPerThreadData(curThread) ) {
-                    //The TLSHolder still has TLS on it for another thread and is still alive,
-                    //then leave it in the set
-                    newObjects.insert(p);
-                }
-            }
-        }
-        _object->objects = newObjects;
-#endif
+        QMutexLocker k(&data->slotsMutex);
+        slots.swap(data->slots);
     }
 } // AppTLS::cleanupTLSForThread
 
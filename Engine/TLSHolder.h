@@ -38,72 +38,89 @@
 #if !defined(Q_MOC_RUN) && !defined(SBK_RUN)
 #include <boost/shared_ptr.hpp>
 #include <boost/weak_ptr.hpp>
-#include <boost/enable_shared_from_this.hpp>
 #endif
 
+#include <QtCore/QMutex>
 #include <QtCore/QReadWriteLock>
 #include <QtCore/QThread>
 
 #include "Engine/EngineFwd.h"
+#include "Engine/ThreadStorage.h"
 
 NATRON_NAMESPACE_ENTER;
 
-///This must be stored as a shared_ptr
+/**
+ * @brief Base class of all TLSHolder: each holder owns a slot in the thread-local storage of every thread.
+ * When a holder is destroyed, the values of its slot are released in all the threads and the slot is recycled.
+ * The id of the holder, which is never reused, tells whether the value found in a slot belongs to this holder.
+ **/
 class TLSHolderBase
-    : public boost::enable_shared_from_this<TLSHolderBase>
 {
     friend class AppTLS;
 
 public:
-    // TODO: enable_shared_from_this
-    // constructors should be privatized in any class that derives from boost::enable_shared_from_this<>
 
-    TLSHolderBase() {}
+    TLSHolderBase();
 
-public:
-    virtual ~TLSHolderBase() {}
+    virtual ~TLSHolderBase();
 
 protected:
 
-    /**
-     * @brief Returns true if cleanupPerThreadData would do anything OR would return true.
-     * It does not return the same value as cleanupPerThreadData, since cleanupPerThreadData
-     * may do something and return false.
-     * This is much faster than cleanupPerThreadData as it does not take any write lock.
-     **/
-    virtual bool canCleanupPerThreadData(const QThread* curThread) const = 0;
-
-    /**
-     * @brief Must clean-up any data stored for the given thread 'curThread'
-     * @returns True if this object no longer holds any per-thread data
-     **/
-    virtual bool cleanupPerThreadData(const QThread* curThread) const = 0;
-
-    /**
-     * @brief Copy all the TLS from fromThread to toThread
-     **/
-    virtual void copyTLS(const QThread* fromThread, const QThread* toThread) const = 0;
+    std::size_t _slotIndex;
+    U64 _holderId;
 };
 
 
 /**
- * @brief Stores globally to the application any thread-local storage object so that it gets
- * destroyed when all threads are shutdown.
+ * @brief Stores the thread-local storage of all TLSHolder. Each thread has a vector of slots, indexed
+ * by the slot index of the holders, that it reads without taking any lock.
+ * The TLS of a thread may be copied to a thread it spawned (see copyTLS() and softCopy()). This is the
+ * only time a thread reads the TLS of another thread: the slots of a thread are then read under its lock,
+ * which the thread also takes when it modifies them.
  **/
 class AppTLS
 {
-    //This is the object in the QThreadStorage, it is duplicated on every thread
+public:
+
+    // Returns a copy of the TLS value to give to a spawned thread, or NULL if it should not be copied
+    typedef boost::shared_ptr<void> (*CopyTLSFunctor)(const boost::shared_ptr<void>& value);
 
-    typedef std::set<boost::weak_ptr<const TLSHolderBase> > TLSObjects;
-    struct GLobalTLSObject
+    struct Slot
+    {
+        U64 holderId;
+        boost::shared_ptr<void> value;
+        CopyTLSFunctor copyFunctor;
+
+        Slot()
+            : holderId(0)
+            , value()
+            , copyFunctor(0)
+        {
+        }
+    };
+
+    struct ThreadData
     {
-        TLSObjects objects;
+        // Protects slots: taken by the owning thread when it modifies them and by other threads to read them
+        QMutex slotsMutex;
+        std::vector<Slot> slots;
+
+        // If set, the TLS of this thread must be copied from the spawner thread before it is used, see softCopy()
+        const QThread* spawnerThread;
+
+        ThreadData()
+            : slotsMutex()
+            , slots()
+            , spawnerThread(0)
+        {
+        }
     };
 
-    typedef boost::shared_ptr<GLobalTLSObject> GLobalTLSObjectPtr;
+    typedef boost::shared_ptr<ThreadData> ThreadDataPtr;
 
-    //<spawned thread, spawner thread>
-    typedef std::map<const QThread*, const QThread*> ThreadSpawnMap;
+private:
+
+    typedef std::map<const QThread*, boost::weak_ptr<ThreadData> > ThreadDataMap;
 
 public:
 
@@ -112,20 +129,27 @@ public:
     virtual ~AppTLS();
 
     /**
-     * @brief Registers the holder as using TLS.
+     * @brief Returns the TLS of the calling thread, after having copied the TLS of its spawner thread
+     * if softCopy() was called. This does not take any lock, except the first time it is called on a thread.
      **/
-    void registerTLSHolder(const boost::shared_ptr<const TLSHolderBase>& holder);
+    ThreadData* getThreadData();
 
+    /**
+     * @brief Sets the value of the slot of the given holder for the calling thread.
+     **/
+    void setSlotValue(ThreadData* data,
+                      const TLSHolderBase* holder,
+                      const boost::shared_ptr<void>& value,
+                      CopyTLSFunctor copyFunctor);
 
     /**
-     * @brief Copy all the TLS from fromThread to toThread
+     * @brief Copy all the TLS from fromThread to toThread. toThread must be the calling thread.
      **/
     void copyTLS(QThread* fromThread, QThread* toThread);
 
     /**
-     * @brief This function registers fromThread as a thread who spawned toThread.
-     * The first time attempting to call getOrCreateTLSData() for toThread, it will
-     * call copyTLS() first before returning the TLS value.
+     * @brief This function registers fromThread as a thread who spawned toThread, which must be the calling thread.
+     * The first time the TLS is needed on toThread, it will call copyTLS() first before returning the TLS value.
      * This is to ensure that threads that "may" need TLS do not always copy the TLS
      * if it is not needed.
      * Note that when calling softCopy,  fromThread may not already have
@@ -135,59 +159,38 @@ public:
     void softCopy(QThread* fromThread, QThread* toThread);
 
     /**
-     * @brief Same as copyTLS() except that if a spawner thread was register for curThread beforehand
-     * with softCopy() then the TLS will be copied from the spawner thread.
-     * This function also returns the TLS for the given holder for convenience.
+     * @brief Should be called by any thread using TLS when done to cleanup its TLS
      **/
-    template <typename T>
-    boost::shared_ptr<T> copyTLSFromSpawnerThread(const TLSHolderBase* holder,
-                                                  const QThread* curThread);
-
+    void cleanupTLSForThread();
 
     /**
-     * @brief Should be called by any thread using TLS when done to cleanup its TLS
+     * @brief Releases the values of the given destroyed holder in all the threads. Called by ~TLSHolderBase().
      **/
-    void cleanupTLSForThread();
+    void releaseSlot(std::size_t slotIndex, U64 holderId);
 
 private:
 
-    template <typename T>
-    boost::shared_ptr<T> copyTLSFromSpawnerThreadInternal(const TLSHolderBase* holder,
-                                                          const QThread* curThread,
-                                                          const QThread* spawnerThread);
+    ThreadDataPtr createThreadData();
 
+    void copyTLSInternal(const QThread* fromThread, ThreadData* toData);
 
-    //This is the "TLS" object: it stores a set of all TLSHolder's who used the TLS to clean it up afterwards
-    mutable QReadWriteLock _objectMutex;
-    GLobalTLSObjectPtr _object;
+    // The TLS of each thread. The main thread has its own instance so that it is destroyed with this object.
+    ThreadStorage<ThreadDataPtr> _threadData;
 
-    //if a thread is a spawned thread, then copy the tls from the spawner thread instead
-    //of creating a new object and no longer mark it as spawned
-    mutable QReadWriteLock _spawnsMutex;
-    ThreadSpawnMap _spawns;
+    // All the threads with TLS, only used to find the TLS of a spawner thread
+    mutable QMutex _threadsMutex;
+    ThreadDataMap _threads;
 };
 
 
 /**
  * @brief Use this class if you need to hold TLS data on an object.
  * @param T is the data type held in the thread local storage.
- * @param multipleInstance If true, then the TLS object will be mapped against this object
- * so that there can be multiple instance of it in the global TLS. Otherwise only
- * a single instance of the TLS object will be present.
  **/
 template <typename T>
 class TLSHolder
     : public TLSHolderBase
 {
-    friend class AppTLS;
-
-    struct ThreadData
-    {
-        boost::shared_ptr<T> value;
-    };
-
-    typedef std::map<const QThread*, ThreadData> ThreadDataMap;
-
 public:
 
     TLSHolder()
@@ -200,14 +203,8 @@ public:
 
 private:
 
-    virtual bool canCleanupPerThreadData(const QThread* curThread) const OVERRIDE FINAL WARN_UNUSED_RETURN;
-    virtual bool cleanupPerThreadData(const QThread* curThread) const OVERRIDE FINAL WARN_UNUSED_RETURN;
-    virtual void copyTLS(const QThread* fromThread, const QThread* toThread) const OVERRIDE FINAL;
-    boost::shared_ptr<T> copyAndReturnNewTLS(const QThread* fromThread, const QThread* toThread) const WARN_UNUSED_RETURN;
-
-    //Store a cache on the object to be faster than using the getOrCreate... function from AppTLS
-    mutable QReadWriteLock perThreadDataMutex;
-    mutable ThreadDataMap perThreadData;
+    // Only EffectInstance::EffectTLSData is copied to spawned threads, see TLSHolderImpl.h
+    static boost::shared_ptr<void> copyTLSValue(const boost::shared_ptr<void>& value);
 };
 
 NATRON_NAMESPACE_EXIT;
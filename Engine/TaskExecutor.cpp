@@ -0,0 +1,562 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <http://www.natron.fr/>,
+ * Copyright (C) 2016 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "TaskExecutor.h"
+
+#include <algorithm> // min, max
+#include <climits> // ULONG_MAX
+#include <list>
+#include <stdexcept>
+
+#include <QtCore/QDebug>
+#include <QtCore/QMutex>
+#include <QtCore/QMutexLocker>
+#include <QtCore/QThread>
+#include <QtCore/QWaitCondition>
+
+#include "Engine/AbortableRenderInfo.h"
+#include "Engine/AppManager.h"
+#include "Engine/EffectInstance.h"
+#include "Engine/ThreadPool.h"
+#include "Engine/Timer.h"
+#include "Engine/TLSHolder.h"
+
+// A worker exits after being idle for this long
+#define NATRON_TASK_EXECUTOR_WORKER_EXPIRY_MS 30000
+
+// Default maximum number of tasks running at the same time for the housekeeping class
+#define NATRON_TASK_EXECUTOR_MAX_HOUSEKEEPING_TASKS 2
+
+NATRON_NAMESPACE_ENTER;
+
+ExecutorTask::ExecutorTask(const AbortableRenderInfoPtr& abortInfo)
+    : _abortInfo(abortInfo)
+    , _cancelled()
+{
+}
+
+ExecutorTask::~ExecutorTask()
+{
+}
+
+const AbortableRenderInfoPtr&
+ExecutorTask::getAbortInfo() const
+{
+    return _abortInfo;
+}
+
+void
+ExecutorTask::cancel()
+{
+    _cancelled.fetchAndStoreRelease(1);
+}
+
+bool
+ExecutorTask::isCancelled() const
+{
+    if ( (int)_cancelled != 0 ) {
+        return true;
+    }
+
+    return _abortInfo && _abortInfo->isAborted();
+}
+
+class TaskExecutorWorker;
+
+struct QueuedTask
+{
+    ExecutorTaskPtr task;
+
+    // Started when the task is queued
+    TimeLapse queuedTime;
+};
+
+struct TaskExecutorPrivate
+{
+    // Protects all fields below
+    mutable QMutex lock;
+
+    // Wakes up idle workers when a task is queued or when quitting
+    QWaitCondition tasksAvailableCond;
+
+    // Woken up when a task finishes or a worker exits
+    QWaitCondition taskFinishedCond;
+    int maxWorkers;
+    int maxRunning[eTaskPriorityCount];
+    int nRunning[eTaskPriorityCount];
+    std::list<QueuedTask> queues[eTaskPriorityCount];
+    TaskExecutorStats stats[eTaskPriorityCount];
+
+    // All workers started, some of them may have exited after being idle
+    std::list<TaskExecutorWorker*> workers;
+    int nWorkersAlive;
+    int nIdleWorkers;
+
+    // Idle workers woken up by submit() that did not pick up a task yet
+    int nWakeUpsPending;
+    bool mustQuit;
+
+    TaskExecutorPrivate(int maxWorkers)
+        : lock()
+        , tasksAvailableCond()
+        , taskFinishedCond()
+        , maxWorkers(maxWorkers)
+        , workers()
+        , nWorkersAlive(0)
+        , nIdleWorkers(0)
+        , nWakeUpsPending(0)
+        , mustQuit(false)
+    {
+        for (int i = 0; i < eTaskPriorityCount; ++i) {
+            maxRunning[i] = maxWorkers;
+            nRunning[i] = 0;
+        }
+        maxRunning[eTaskPriorityPreview] = std::max(1, maxWorkers / 2);
+        maxRunning[eTaskPriorityHousekeeping] = std::min(maxWorkers, NATRON_TASK_EXECUTOR_MAX_HOUSEKEEPING_TASKS);
+    }
+
+    /**
+     * @brief Returns true if a task of the given class may start now. Must be called with lock held.
+     **/
+    bool canStart(int priority) const;
+
+    /**
+     * @brief Pops the next task to run, and the cancelled tasks found before it in dropped. Must be called with lock held.
+     **/
+    bool takeTask(QueuedTask* task, int* priority, std::list<ExecutorTaskPtr>* dropped);
+
+    void enqueue(int priority, const ExecutorTaskPtr& task);
+
+    bool hasTaskToStart() const;
+
+    void startWorker();
+
+    void workerLoop(TaskExecutorWorker* worker);
+
+    void runTask(TaskExecutorWorker* worker, const ExecutorTaskPtr& task, int priority);
+};
+
+class TaskExecutorWorker
+    : public QThread
+      , public AbortableThread
+{
+    TaskExecutorPrivate* _imp;
+
+public:
+
+    TaskExecutorWorker(TaskExecutorPrivate* imp)
+        : QThread()
+        , AbortableThread(this)
+        , _imp(imp)
+    {
+        setThreadName("TaskExecutor");
+    }
+
+    virtual ~TaskExecutorWorker()
+    {
+    }
+
+private:
+
+    virtual void run() OVERRIDE FINAL
+    {
+        _imp->workerLoop(this);
+    }
+};
+
+static void
+dropTasks(const std::list<ExecutorTaskPtr>& tasks)
+{
+    for (std::list<ExecutorTaskPtr>::const_iterator it = tasks.begin(); it != tasks.end(); ++it) {
+        (*it)->onDropped();
+    }
+}
+
+bool
+TaskExecutorPrivate::canStart(int priority) const
+{
+    if (nRunning[priority] >= maxRunning[priority]) {
+        return false;
+    }
+    if ( (priority == eTaskPriorityHousekeeping) || queues[eTaskPriorityHousekeeping].empty() || (nRunning[eTaskPriorityHousekeeping] > 0) ) {
+        return true;
+    }
+
+    // Housekeeping tasks are waiting and none runs: keep a worker for them
+    int nRunningTotal = 0;
+    for (int i = 0; i < eTaskPriorityCount; ++i) {
+        nRunningTotal += nRunning[i];
+    }
+
+    return nRunningTotal < maxWorkers - 1;
+}
+
+bool
+TaskExecutorPrivate::takeTask(QueuedTask* task,
+                              int* priority,
+                              std::list<ExecutorTaskPtr>* dropped)
+{
+    for (int i = 0; i < eTaskPriorityCount; ++i) {
+        std::list<QueuedTask>& queue = queues[i];
+        while ( !queue.empty() && queue.front().task->isCancelled() ) {
+            dropped->push_back(queue.front().task);
+            ++stats[i].nTasksDropped;
+            queue.pop_front();
+        }
+        if ( queue.empty() || !canStart(i) ) {
+            continue;
+        }
+        *task = queue.front();
+        queue.pop_front();
+        *priority = i;
+        ++nRunning[i];
+
+        double latency = task->queuedTime.getTimeSinceCreation();
+        stats[i].totalQueueLatency += latency;
+        stats[i].maxQueueLatency = std::max(stats[i].maxQueueLatency, latency);
+
+        return true;
+    }
+
+    return false;
+}
+
+void
+TaskExecutorPrivate::enqueue(int priority,
+                             const ExecutorTaskPtr& task)
+{
+    // The queue latency starts now
+    queues[priority].push_back( QueuedTask() );
+    queues[priority].back().task = task;
+}
+
+bool
+TaskExecutorPrivate::hasTaskToStart() const
+{
+    for (int i = 0; i < eTaskPriorityCount; ++i) {
+        if ( !queues[i].empty() && canStart(i) ) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void
+TaskExecutorPrivate::startWorker()
+{
+    // Reclaim the workers that exited after being idle
+    for (std::list<TaskExecutorWorker*>::iterator it = workers.begin(); it != workers.end(); ) {
+        if ( (*it)->isFinished() ) {
+            (*it)->wait();
+            delete *it;
+            it = workers.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    TaskExecutorWorker* worker = new TaskExecutorWorker(this);
+    workers.push_back(worker);
+    ++nWorkersAlive;
+    worker->start();
+}
+
+void
+TaskExecutorPrivate::runTask(TaskExecutorWorker* worker,
+                             const ExecutorTaskPtr& task,
+                             int priority)
+{
+    switch ( (TaskPriorityEnum)priority ) {
+    case eTaskPriorityPreview:
+        // Previews must never slow down the viewer or the interface
+        worker->setPriority(QThread::LowestPriority);
+        break;
+    case eTaskPriorityHousekeeping:
+        worker->setPriority(QThread::LowPriority);
+        break;
+    default:
+        worker->setPriority(QThread::NormalPriority);
+        break;
+    }
+
+    const AbortableRenderInfoPtr& abortInfo = task->getAbortInfo();
+    if (abortInfo) {
+        worker->setAbortInfo(priority == eTaskPriorityInteractive, abortInfo, EffectInstancePtr());
+    }
+
+    try {
+        task->run();
+    } catch (const std::exception& e) {
+        qDebug() << "Exception in a task of the TaskExecutor:" << e.what();
+    } catch (...) {
+        qDebug() << "Unknown exception in a task of the TaskExecutor";
+    }
+
+    if (abortInfo) {
+        worker->clearAbortInfo();
+    }
+    if (appPTR) {
+        appPTR->getAppTLS()->cleanupTLSForThread();
+    }
+}
+
+void
+TaskExecutorPrivate::workerLoop(TaskExecutorWorker* worker)
+{
+    QMutexLocker k(&lock);
+
+    for (;; ) {
+        QueuedTask task;
+        int priority = 0;
+        std::list<ExecutorTaskPtr> dropped;
+        bool gotTask = !mustQuit && takeTask(&task, &priority, &dropped);
+        bool droppedTasks = !dropped.empty();
+
+        if (droppedTasks) {
+            k.unlock();
+            dropTasks(dropped);
+            dropped.clear();
+            k.relock();
+        }
+
+        if (gotTask) {
+            k.unlock();
+            runTask(worker, task.task, priority);
+            task.task.reset();
+            k.relock();
+
+            --nRunning[priority];
+            ++stats[priority].nTasksRun;
+            taskFinishedCond.wakeAll();
+            continue;
+        }
+
+        if (mustQuit) {
+            break;
+        }
+        if ( droppedTasks || hasTaskToStart() ) {
+            continue;
+        }
+
+        ++nIdleWorkers;
+        bool woken = tasksAvailableCond.wait(&lock, NATRON_TASK_EXECUTOR_WORKER_EXPIRY_MS);
+        --nIdleWorkers;
+        if (nWakeUpsPending > 0) {
+            --nWakeUpsPending;
+            woken = true;
+        }
+        if ( !woken && !mustQuit && !hasTaskToStart() ) {
+            break;
+        }
+    }
+
+    --nWorkersAlive;
+    taskFinishedCond.wakeAll();
+} // TaskExecutorPrivate::workerLoop
+
+TaskExecutor::TaskExecutor(int maxWorkers)
+    : _imp( new TaskExecutorPrivate( maxWorkers > 0 ? maxWorkers : std::max(2, QThread::idealThreadCount()) ) )
+{
+}
+
+TaskExecutor::~TaskExecutor()
+{
+    quit();
+}
+
+int
+TaskExecutor::getMaxWorkers() const
+{
+    return _imp->maxWorkers;
+}
+
+void
+TaskExecutor::setMaxRunningTasks(TaskPriorityEnum priority,
+                                 int maxTasks)
+{
+    QMutexLocker k(&_imp->lock);
+
+    _imp->maxRunning[priority] = std::max(1, maxTasks);
+    // More tasks of this class may start now
+    _imp->tasksAvailableCond.wakeAll();
+}
+
+int
+TaskExecutor::getMaxRunningTasks(TaskPriorityEnum priority) const
+{
+    QMutexLocker k(&_imp->lock);
+
+    return _imp->maxRunning[priority];
+}
+
+bool
+TaskExecutor::submit(TaskPriorityEnum priority,
+                     const ExecutorTaskPtr& task)
+{
+    assert(task);
+    assert(priority >= 0 && priority < eTaskPriorityCount);
+    QMutexLocker k(&_imp->lock);
+
+    if (_imp->mustQuit) {
+        return false;
+    }
+
+    _imp->enqueue(priority, task);
+
+    if (_imp->nIdleWorkers > _imp->nWakeUpsPending) {
+        ++_imp->nWakeUpsPending;
+        _imp->tasksAvailableCond.wakeOne();
+    } else if (_imp->nWorkersAlive < _imp->maxWorkers) {
+        _imp->startWorker();
+    }
+
+    return true;
+}
+
+bool
+TaskExecutor::trySubmit(TaskPriorityEnum priority,
+                        const ExecutorTaskPtr& task)
+{
+    assert(task);
+    assert(priority >= 0 && priority < eTaskPriorityCount);
+    QMutexLocker k(&_imp->lock);
+
+    // The task would wait behind the queued ones of its class, or for a slot of its class
+    if ( _imp->mustQuit || !_imp->queues[priority].empty() || !_imp->canStart(priority) ) {
+        return false;
+    }
+
+    if (_imp->nIdleWorkers > _imp->nWakeUpsPending) {
+        ++_imp->nWakeUpsPending;
+        _imp->tasksAvailableCond.wakeOne();
+    } else if (_imp->nWorkersAlive < _imp->maxWorkers) {
+        _imp->startWorker();
+    } else {
+        return false;
+    }
+    _imp->enqueue(priority, task);
+
+    return true;
+}
+
+int
+TaskExecutor::getNumPendingTasks(TaskPriorityEnum priority) const
+{
+    QMutexLocker k(&_imp->lock);
+
+    return (int)_imp->queues[priority].size();
+}
+
+int
+TaskExecutor::getNumRunningTasks(TaskPriorityEnum priority) const
+{
+    QMutexLocker k(&_imp->lock);
+
+    return _imp->nRunning[priority];
+}
+
+int
+TaskExecutor::getNumWorkers() const
+{
+    QMutexLocker k(&_imp->lock);
+
+    return _imp->nWorkersAlive;
+}
+
+void
+TaskExecutor::getStats(TaskPriorityEnum priority,
+                       TaskExecutorStats* stats) const
+{
+    assert(stats);
+    QMutexLocker k(&_imp->lock);
+    *stats = _imp->stats[priority];
+}
+
+void
+TaskExecutor::resetStats()
+{
+    QMutexLocker k(&_imp->lock);
+
+    for (int i = 0; i < eTaskPriorityCount; ++i) {
+        _imp->stats[i] = TaskExecutorStats();
+    }
+}
+
+bool
+TaskExecutor::waitForIdle(int timeoutMS)
+{
+    TimeLapse timer;
+    QMutexLocker k(&_imp->lock);
+
+    for (;; ) {
+        bool idle = true;
+        for (int i = 0; i < eTaskPriorityCount; ++i) {
+            if ( !_imp->queues[i].empty() || (_imp->nRunning[i] > 0) ) {
+                idle = false;
+                break;
+            }
+        }
+        if (idle) {
+            return true;
+        }
+        if (timeoutMS <= 0) {
+            _imp->taskFinishedCond.wait(&_imp->lock);
+        } else {
+            double remainingMS = timeoutMS - timer.getTimeSinceCreation() * 1000.;
+            if ( (remainingMS <= 0) || !_imp->taskFinishedCond.wait( &_imp->lock, (unsigned long)remainingMS + 1 ) ) {
+                return false;
+            }
+        }
+    }
+}
+
+void
+TaskExecutor::quit()
+{
+    std::list<ExecutorTaskPtr> dropped;
+    std::list<TaskExecutorWorker*> workers;
+    {
+        QMutexLocker k(&_imp->lock);
+        _imp->mustQuit = true;
+        for (int i = 0; i < eTaskPriorityCount; ++i) {
+            for (std::list<QueuedTask>::iterator it = _imp->queues[i].begin(); it != _imp->queues[i].end(); ++it) {
+                dropped.push_back(it->task);
+                ++_imp->stats[i].nTasksDropped;
+            }
+            _imp->queues[i].clear();
+        }
+        _imp->tasksAvailableCond.wakeAll();
+        workers.swap(_imp->workers);
+    }
+
+    dropTasks(dropped);
+
+    for (std::list<TaskExecutorWorker*>::iterator it = workers.begin(); it != workers.end(); ++it) {
+        (*it)->wait();
+        delete *it;
+    }
+}
+
+NATRON_NAMESPACE_EXIT;
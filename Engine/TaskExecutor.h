@@ -0,0 +1,200 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <http://www.natron.fr/>,
+ * Copyright (C) 2016 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+#ifndef Engine_TaskExecutor_h
+#define Engine_TaskExecutor_h
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "Global/Macros.h"
+
+#if !defined(Q_MOC_RUN) && !defined(SBK_RUN)
+#include <boost/scoped_ptr.hpp>
+#include <boost/shared_ptr.hpp>
+#endif
+
+#include <QtCore/QAtomicInt>
+
+#include "Global/GlobalDefines.h"
+
+#include "Engine/EngineFwd.h"
+
+NATRON_NAMESPACE_ENTER;
+
+/**
+ * @brief The priority classes of the tasks run by the TaskExecutor, from the most to the least urgent.
+ **/
+enum TaskPriorityEnum
+{
+    // Freeing of the entries evicted from a cache: render threads may be waiting for it when a cache is full
+    eTaskPriorityCacheDeletion = 0,
+    // Work the user is waiting for in the interface: viewer renders, tracking, histograms
+    eTaskPriorityInteractive,
+    // Node previews
+    eTaskPriorityPreview,
+    // Cache clean-up and other work nobody waits for
+    eTaskPriorityHousekeeping,
+    eTaskPriorityCount
+};
+
+/**
+ * @brief A unit of work run by the TaskExecutor. Inherit it and implement run().
+ * A task may belong to a render: it is then cancelled when the render is aborted, and while it runs
+ * the worker thread carries the render abort info so that EffectInstance::aborted() works as on a render thread.
+ **/
+class ExecutorTask
+{
+public:
+
+    ExecutorTask(const AbortableRenderInfoPtr& abortInfo = AbortableRenderInfoPtr());
+
+    virtual ~ExecutorTask();
+
+    const AbortableRenderInfoPtr& getAbortInfo() const;
+
+    /**
+     * @brief Cancels the task: if it did not start yet, it will not run. A running task
+     * may check isCancelled() to return early.
+     **/
+    void cancel();
+
+    /**
+     * @brief True if cancel() was called or if the render the task belongs to was aborted
+     **/
+    bool isCancelled() const;
+
+    /**
+     * @brief Does the work, in a worker thread of the executor
+     **/
+    virtual void run() = 0;
+
+    /**
+     * @brief Called instead of run() when the task is discarded before it starts, because it was
+     * cancelled or because the executor quit. Called without any lock held, in the thread that discarded it.
+     **/
+    virtual void onDropped() {}
+
+private:
+
+    AbortableRenderInfoPtr _abortInfo;
+    QAtomicInt _cancelled;
+};
+
+typedef boost::shared_ptr<ExecutorTask> ExecutorTaskPtr;
+
+/**
+ * @brief Statistics of a priority class of the TaskExecutor. Latencies are the time in seconds a task
+ * spent in the queue before a worker started it.
+ **/
+struct TaskExecutorStats
+{
+    U64 nTasksRun;
+    U64 nTasksDropped;
+    double totalQueueLatency;
+    double maxQueueLatency;
+
+    TaskExecutorStats()
+        : nTasksRun(0)
+        , nTasksDropped(0)
+        , totalQueueLatency(0)
+        , maxQueueLatency(0)
+    {
+    }
+
+    double getAverageQueueLatency() const
+    {
+        return nTasksRun == 0 ? 0. : totalQueueLatency / nTasksRun;
+    }
+};
+
+/**
+ * @brief An engine-wide pool of worker threads that runs tasks by priority class.
+ * A worker always starts the oldest task of the most urgent class that may start: each class has a maximum
+ * number of running tasks, and when housekeeping tasks are waiting one worker is kept for them so that
+ * they are never starved by other tasks. Workers are started on demand up to getMaxWorkers() and
+ * exit after being idle for a while.
+ * All functions are thread-safe.
+ **/
+struct TaskExecutorPrivate;
+class TaskExecutor
+{
+public:
+
+    /**
+     * @brief If maxWorkers is 0, the number of cores is used (at least 2, so that a worker can
+     * be kept for housekeeping).
+     **/
+    explicit TaskExecutor(int maxWorkers = 0);
+
+    /**
+     * @brief Calls quit()
+     **/
+    ~TaskExecutor();
+
+    int getMaxWorkers() const;
+
+    /**
+     * @brief Sets the maximum number of tasks of the given class that may run at the same time
+     **/
+    void setMaxRunningTasks(TaskPriorityEnum priority, int maxTasks);
+    int getMaxRunningTasks(TaskPriorityEnum priority) const;
+
+    /**
+     * @brief Queues the task in the given class.
+     * @returns false if the executor has quit, in which case the task will not run.
+     **/
+    bool submit(TaskPriorityEnum priority, const ExecutorTaskPtr& task);
+
+    /**
+     * @brief Queues the task only if a worker can start it right away.
+     * @returns false if all the workers are busy, the class is at its maximum number of running tasks
+     * or the executor has quit: the caller should then do the work itself rather than wait.
+     **/
+    bool trySubmit(TaskPriorityEnum priority, const ExecutorTaskPtr& task);
+
+    int getNumPendingTasks(TaskPriorityEnum priority) const;
+    int getNumRunningTasks(TaskPriorityEnum priority) const;
+    int getNumWorkers() const;
+
+    void getStats(TaskPriorityEnum priority, TaskExecutorStats* stats) const;
+    void resetStats();
+
+    /**
+     * @brief Blocks until no task is queued or running, or until timeoutMS milliseconds elapsed
+     * (if timeoutMS is positive). Returns false on timeout.
+     **/
+    bool waitForIdle(int timeoutMS = -1);
+
+    /**
+     * @brief Drops the queued tasks, waits for the running ones and stops the workers.
+     * The executor may not be used anymore afterwards.
+     **/
+    void quit();
+
+private:
+
+    boost::scoped_ptr<TaskExecutorPrivate> _imp;
+};
+
+NATRON_NAMESPACE_EXIT;
+
+#endif // Engine_TaskExecutor_h
@@ -44,6 +44,7 @@ CLANG_DIAG_ON(uninitialized)
 #include "Engine/KnobTypes.h"
 #include "Engine/Project.h"
 #include "Engine/Curve.h"
+#include "Engine/TaskExecutor.h"
 #include "Engine/TLSHolder.h"
 #include "Engine/Transform.h"
 #include "Engine/TrackMarker.h"
@@ -1819,6 +1820,83 @@ public:
     }
 };
 
+// The tracks of one frame, tracked concurrently by the TaskExecutor
+class TrackStepBatch
+{
+    QMutex _lock;
+    QWaitCondition _doneCond;
+    int _nRemaining;
+    bool _anySucceeded;
+
+public:
+
+    TrackStepBatch(int nTracks)
+        : _lock()
+        , _doneCond()
+        , _nRemaining(nTracks)
+        , _anySucceeded(false)
+    {
+    }
+
+    void onTrackDone(bool succeeded)
+    {
+        QMutexLocker k(&_lock);
+
+        _anySucceeded |= succeeded;
+        --_nRemaining;
+        if (_nRemaining == 0) {
+            _doneCond.wakeAll();
+        }
+    }
+
+    /**
+     * @brief Waits for all the tracks and returns true if at least one of them succeeded
+     **/
+    bool waitForTracks()
+    {
+        QMutexLocker k(&_lock);
+
+        while (_nRemaining > 0) {
+            _doneCond.wait(&_lock);
+        }
+
+        return _anySucceeded;
+    }
+};
+
+class TrackStepTask
+    : public ExecutorTask
+{
+    boost::shared_ptr<TrackStepBatch> _batch;
+    boost::shared_ptr<TrackArgs> _args;
+    int _trackIndex;
+    int _time;
+
+public:
+
+    TrackStepTask(const boost::shared_ptr<TrackStepBatch>& batch,
+                  const boost::shared_ptr<TrackArgs>& args,
+                  int trackIndex,
+                  int time)
+        : ExecutorTask()
+        , _batch(batch)
+        , _args(args)
+        , _trackIndex(trackIndex)
+        , _time(time)
+    {
+    }
+
+    virtual void run() OVERRIDE FINAL
+    {
+        _batch->onTrackDone( TrackSchedulerPrivate::trackStepFunctor(_trackIndex, *_args, _time) );
+    }
+
+    virtual void onDropped() OVERRIDE FINAL
+    {
+        _batch->onTrackDone(false);
+    }
+};
+
 NATRON_NAMESPACE_ANONYMOUS_EXIT
 
 GenericSchedulerThread::ThreadStateEnum
@@ -1843,9 +1921,7 @@ TrackScheduler::threadLoopOnce(const ThreadStartArgsPtr& inArgs)
 
     const std::vector<TrackMarkerAndOptionsPtr >& tracks = args->getTracks();
     const int numTracks = (int)tracks.size();
-    std::vector<int> trackIndexes( tracks.size() );
     for (std::size_t i = 0; i < tracks.size(); ++i) {
-        trackIndexes[i] = i;
         tracks[i]->natronMarker->notifyTrackingStarted();
         // unslave the enabled knob, since it is slaved to the gui but we may modify it
         KnobBoolPtr enabledKnob = tracks[i]->natronMarker->getEnabledKnob();
@@ -1873,21 +1949,17 @@ TrackScheduler::threadLoopOnce(const ThreadStartArgsPtr& inArgs)
 
 
         while (cur != end) {
-            ///Launch parallel thread for each track using the global thread pool
-            QFuture<bool> future = QtConcurrent::mapped( trackIndexes,
-                                                         boost::bind(&TrackSchedulerPrivate::trackStepFunctor,
-                                                                     _1,
-                                                                     *args,
-                                                                     cur) );
-            future.waitForFinished();
-
-            allTrackFailed = true;
-            for (QFuture<bool>::const_iterator it = future.begin(); it != future.end(); ++it) {
-                if ( (*it) ) {
-                    allTrackFailed = false;
-                    break;
+            ///Track each marker in the interactive class of the TaskExecutor, the user is waiting for the tracks
+            boost::shared_ptr<TrackStepBatch> batch( new TrackStepBatch(numTracks) );
+            TaskExecutor* executor = appPTR->getTaskExecutor();
+            for (int i = 0; i < numTracks; ++i) {
+                ExecutorTaskPtr task( new TrackStepTask(batch, args, i, cur) );
+                if ( !executor || !executor->submit(eTaskPriorityInteractive, task) ) {
+                    // The executor quit, the application is shutting down
+                    task->run();
                 }
             }
+            allTrackFailed = !batch->waitForTracks();
 
 
 
@@ -43,6 +43,9 @@
 //#define TRACKER_GENERATE_DATA_SEQUENTIALLY
 #endif
 
+// Number of batches of keyframes per thread of the global thread pool when solving the transform
+#define NATRON_TRACKER_SOLVER_BATCHES_PER_THREAD 4
+
 
 NATRON_NAMESPACE_ENTER;
 
@@ -1752,132 +1755,183 @@ PointWithErrorCompareLess(const PointWithError& lhs,
     return lhs.error < rhs.error;
 }
 
+Point
+TrackerContextPrivate::applyJitter(const Point* samples,
+                                   int nSamples,
+                                   bool jitterAdd)
+{
+    assert(nSamples > 0);
+    if (nSamples == 1) {
+        return samples[0];
+    }
+
+    // Average halfJitter frames before and after the time together to smooth the center
+    Point atTime = samples[(nSamples - 1) / 2];
+    Point avg = {0, 0};
+    for (int i = 0; i < nSamples; ++i) {
+        avg.x += samples[i].x;
+        avg.y += samples[i].y;
+    }
+    avg.x /= nSamples;
+    avg.y /= nSamples;
+    if (!jitterAdd) {
+        return avg;
+    }
+
+    Point ret;
+    ret.x = atTime.x + (atTime.x - avg.x);
+    ret.y = atTime.y + (atTime.y - avg.y);
+
+    return ret;
+}
+
 void
-TrackerContextPrivate::extractSortedPointsFromMarkers(double refTime,
-                                                      double time,
-                                                      const std::vector<TrackMarkerPtr>& markers,
-                                                      int jitterPeriod,
-                                                      bool jitterAdd,
-                                                      std::vector<Point>* x1,
-                                                      std::vector<Point>* x2)
+TrackerContextPrivate::extractReferencePoints(double refTime,
+                                              const std::vector<TrackMarkerPtr>& markers,
+                                              int jitterPeriod,
+                                              bool jitterAdd,
+                                              std::vector<Point>* refPoints)
 {
-    assert( !markers.empty() );
+    const int halfJitter = jitterPeriod > 1 ? jitterPeriod / 2 : 0;
+    std::vector<Point> samples(2 * halfJitter + 1);
 
-    std::vector<PointWithError> pointsWithErrors;
-    bool useJitter = (jitterPeriod > 1);
-    int halfJitter = std::max(0, jitterPeriod / 2);
-    // Prosac expects the points to be sorted by decreasing correlation score (increasing error)
-    int pIndex = 0;
+    refPoints->resize( markers.size() );
     for (std::size_t i = 0; i < markers.size(); ++i) {
         KnobDoublePtr centerKnob = markers[i]->getCenterKnob();
-        KnobDoublePtr errorKnob = markers[i]->getErrorKnob();
-
-        if (centerKnob->getKeyFrameIndex(ViewSpec::current(), 0, time) < 0) {
-            continue;
+        for (int j = 0; j < (int)samples.size(); ++j) {
+            double t = refTime - halfJitter + j;
+            samples[j].x = centerKnob->getValueAtTime(t, 0);
+            samples[j].y = centerKnob->getValueAtTime(t, 1);
         }
-        pointsWithErrors.resize(pointsWithErrors.size() + 1);
+        (*refPoints)[i] = applyJitter(&samples.front(), (int)samples.size(), jitterAdd);
+    }
+}
 
-        PointWithError& perr = pointsWithErrors[pIndex];
+void
+TrackerContextPrivate::makeSolverBatches(const std::set<double>& keyframes,
+                                         int nBatches,
+                                         std::vector<std::vector<double> >* batches)
+{
+    batches->clear();
+    if ( keyframes.empty() ) {
+        return;
+    }
+    nBatches = std::max( 1, std::min(nBatches, (int)keyframes.size()) );
 
-        if (!useJitter) {
-            perr.p1.x = centerKnob->getValueAtTime(refTime, 0);
-            perr.p1.y = centerKnob->getValueAtTime(refTime, 1);
-            perr.p2.x = centerKnob->getValueAtTime(time, 0);
-            perr.p2.y = centerKnob->getValueAtTime(time, 1);
-        } else {
-            // Average halfJitter frames before and after refTime and time together to smooth the center
-            std::vector<Point> x1PointJitter, x2PointJitter;
-            for (double t = refTime - halfJitter; t <= refTime + halfJitter; t += 1.) {
-                Point p;
-                p.x = centerKnob->getValueAtTime(t, 0);
-                p.y = centerKnob->getValueAtTime(t, 1);
-                x1PointJitter.push_back(p);
-            }
-            for (double t = time - halfJitter; t <= time + halfJitter; t += 1.) {
-                Point p;
-                p.x = centerKnob->getValueAtTime(t, 0);
-                p.y = centerKnob->getValueAtTime(t, 1);
-                x2PointJitter.push_back(p);
-            }
-            assert( x1PointJitter.size() == x2PointJitter.size() );
-            Point x1AtTime = x1PointJitter[(x1PointJitter.size() - 1) / 2];
-            Point x2AtTime = x2PointJitter[(x2PointJitter.size() - 1) / 2];
-            Point x1avg = {0, 0}, x2avg = {0, 0};
-            for (std::size_t i = 0; i < x1PointJitter.size(); ++i) {
-                x1avg.x += x1PointJitter[i].x;
-                x1avg.y += x1PointJitter[i].y;
-                x2avg.x += x2PointJitter[i].x;
-                x2avg.y += x2PointJitter[i].y;
-            }
-            if ( !x1PointJitter.empty() ) {
-                x1avg.x /= x1PointJitter.size();
-                x1avg.y /= x1PointJitter.size();
+    const std::size_t batchSize = (keyframes.size() + nBatches - 1) / nBatches;
+    for (std::set<double>::const_iterator it = keyframes.begin(); it != keyframes.end(); ++it) {
+        if ( batches->empty() || (batches->back().size() == batchSize) ) {
+            batches->push_back( std::vector<double>() );
+            batches->back().reserve(batchSize);
+        }
+        batches->back().push_back(*it);
+    }
+}
 
-                x2avg.x /= x1PointJitter.size();
-                x2avg.y /= x1PointJitter.size();
-            }
-            if (!jitterAdd) {
-                perr.p1.x = x1avg.x;
-                perr.p1.y = x1avg.y;
-                perr.p2.x = x2avg.x;
-                perr.p2.y = x2avg.y;
-            } else {
-                Point highFreqX1, highFreqX2;
-                highFreqX1.x = x1AtTime.x - x1avg.x;
-                highFreqX1.y = x1AtTime.y - x1avg.y;
+void
+TrackerContextPrivate::extractSolverBatch(const std::vector<TrackMarkerPtr>& markers,
+                                          int jitterPeriod,
+                                          SolverBatch* batch)
+{
+    const int halfJitter = jitterPeriod > 1 ? jitterPeriod / 2 : 0;
+    const std::size_t nKeys = batch->keyframes.size();
+
+    // The windows of consecutive keyframes overlap: sample each time only once
+    batch->sampleTimes.clear();
+    batch->sampleTimes.reserve( nKeys + 2 * halfJitter );
+    for (std::size_t k = 0; k < nKeys; ++k) {
+        for (int j = -halfJitter; j <= halfJitter; ++j) {
+            batch->sampleTimes.push_back(batch->keyframes[k] + j);
+        }
+    }
+    std::sort( batch->sampleTimes.begin(), batch->sampleTimes.end() );
+    batch->sampleTimes.erase( std::unique( batch->sampleTimes.begin(), batch->sampleTimes.end() ), batch->sampleTimes.end() );
+
+    const std::size_t nSamples = batch->sampleTimes.size();
+    batch->centers.resize(markers.size() * nSamples);
+    batch->errors.resize(markers.size() * nKeys);
+    batch->used.resize(markers.size() * nKeys);
+
+    for (std::size_t m = 0; m < markers.size(); ++m) {
+        KnobDoublePtr centerKnob = markers[m]->getCenterKnob();
+        KnobDoublePtr errorKnob = markers[m]->getErrorKnob();
+        bool usedInBatch = false;
+        for (std::size_t k = 0; k < nKeys; ++k) {
+            const double time = batch->keyframes[k];
+            const bool used = markers[m]->isEnabled(time) && centerKnob->getKeyFrameIndex(ViewSpec::current(), 0, time) >= 0;
+            batch->used[m * nKeys + k] = used;
+            batch->errors[m * nKeys + k] = used ? errorKnob->getValueAtTime(time, 0) : 0.;
+            usedInBatch |= used;
+        }
+        if (!usedInBatch) {
+            continue;
+        }
+        Point* centers = &batch->centers[m * nSamples];
+        for (std::size_t i = 0; i < nSamples; ++i) {
+            centers[i].x = centerKnob->getValueAtTime(batch->sampleTimes[i], 0);
+            centers[i].y = centerKnob->getValueAtTime(batch->sampleTimes[i], 1);
+        }
+    }
+} // TrackerContextPrivate::extractSolverBatch
 
-                highFreqX2.x = x2AtTime.x - x2avg.x;
-                highFreqX2.y = x2AtTime.y - x2avg.y;
+void
+TrackerContextPrivate::makeSortedPointsFromSolverBatch(const SolverBatch& batch,
+                                                       std::size_t keyIndex,
+                                                       const std::vector<Point>& refPoints,
+                                                       int jitterPeriod,
+                                                       bool jitterAdd,
+                                                       std::vector<Point>* x1,
+                                                       std::vector<Point>* x2)
+{
+    assert( keyIndex < batch.keyframes.size() );
+    const int halfJitter = jitterPeriod > 1 ? jitterPeriod / 2 : 0;
+    const std::size_t nKeys = batch.keyframes.size();
+    const std::size_t nSamples = batch.sampleTimes.size();
+    const std::size_t nMarkers = refPoints.size();
+    assert(batch.used.size() == nMarkers * nKeys);
+
+    // The window of the keyframe is contiguous in the sorted sample times
+    const double time = batch.keyframes[keyIndex];
+    const std::size_t firstSample = std::lower_bound(batch.sampleTimes.begin(), batch.sampleTimes.end(), time - halfJitter) - batch.sampleTimes.begin();
+    assert(firstSample + 2 * halfJitter < nSamples && batch.sampleTimes[firstSample + halfJitter] == time);
 
-                perr.p1.x = x1AtTime.x + highFreqX1.x;
-                perr.p1.y = x1AtTime.y + highFreqX1.y;
-                perr.p2.x = x2AtTime.x + highFreqX2.x;
-                perr.p2.y = x2AtTime.y + highFreqX2.y;
-            }
+    std::vector<PointWithError> pointsWithErrors;
+    pointsWithErrors.reserve(nMarkers);
+    for (std::size_t m = 0; m < nMarkers; ++m) {
+        if (!batch.used[m * nKeys + keyIndex]) {
+            continue;
         }
-
-        perr.error = errorKnob->getValueAtTime(time, 0);
-        ++pIndex;
+        PointWithError perr;
+        perr.p1 = refPoints[m];
+        perr.p2 = applyJitter(&batch.centers[m * nSamples + firstSample], 2 * halfJitter + 1, jitterAdd);
+        perr.error = batch.errors[m * nKeys + keyIndex];
+        pointsWithErrors.push_back(perr);
     }
 
     std::sort(pointsWithErrors.begin(), pointsWithErrors.end(), PointWithErrorCompareLess);
 
     x1->resize( pointsWithErrors.size() );
     x2->resize( pointsWithErrors.size() );
-    /*int r = 0;
-       for (int i = (int)pointsWithErrors.size() - 1; i >= 0; --i, ++r) {
-        (*x1)[r] = pointsWithErrors[i].p1;
-        (*x2)[r] = pointsWithErrors[i].p2;
-       }*/
     for (std::size_t i =  0; i < pointsWithErrors.size(); ++i) {
         assert(i == 0 || pointsWithErrors[i].error >= pointsWithErrors[i - 1].error);
         (*x1)[i] = pointsWithErrors[i].p1;
         (*x2)[i] = pointsWithErrors[i].p2;
     }
-} // TrackerContext::extractSortedPointsFromMarkers
+} // TrackerContextPrivate::makeSortedPointsFromSolverBatch
 
 TrackerContextPrivate::TransformData
-TrackerContextPrivate::computeTransformParamsFromTracksAtTime(double refTime,
-                                                              double time,
-                                                              int jitterPeriod,
-                                                              bool jitterAdd,
-                                                              bool robustModel,
-                                                              const std::vector<TrackMarkerPtr>& allMarkers)
+TrackerContextPrivate::computeTransformParamsFromPoints(double refTime,
+                                                        double time,
+                                                        bool robustModel,
+                                                        const RectD& rodRef,
+                                                        const RectD& rodTime,
+                                                        const std::vector<Point>& x1,
+                                                        const std::vector<Point>& x2)
 {
-    std::vector<TrackMarkerPtr> markers;
-
-    for (std::size_t i = 0; i < allMarkers.size(); ++i) {
-        if ( allMarkers[i]->isEnabled(time) ) {
-            markers.push_back(allMarkers[i]);
-        }
-    }
     TrackerContextPrivate::TransformData data;
     data.rms = 0.;
     data.time = time;
     data.valid = true;
-    assert( !markers.empty() );
-    std::vector<Point> x1, x2;
-    extractSortedPointsFromMarkers(refTime, time, markers, jitterPeriod, jitterAdd, &x1, &x2);
     assert( x1.size() == x2.size() );
     if ( x1.empty() ) {
         data.valid = false;
@@ -1892,8 +1946,6 @@ TrackerContextPrivate::computeTransformParamsFromTracksAtTime(double refTime,
         return data;
     }
 
-    RectD rodRef = getInputRoDAtTime(refTime);
-    RectD rodTime = getInputRoDAtTime(time);
     int w1 = rodRef.width();
     int h1 = rodRef.height();
     int w2 = rodTime.width();
@@ -1913,30 +1965,21 @@ TrackerContextPrivate::computeTransformParamsFromTracksAtTime(double refTime,
     }
 
     return data;
-} // TrackerContextPrivate::computeTransformParamsFromTracksAtTime
+} // TrackerContextPrivate::computeTransformParamsFromPoints
 
 TrackerContextPrivate::CornerPinData
-TrackerContextPrivate::computeCornerPinParamsFromTracksAtTime(double refTime,
-                                                              double time,
-                                                              int jitterPeriod,
-                                                              bool jitterAdd,
-                                                              bool robustModel,
-                                                              const std::vector<TrackMarkerPtr>& allMarkers)
+TrackerContextPrivate::computeCornerPinParamsFromPoints(double refTime,
+                                                        double time,
+                                                        bool robustModel,
+                                                        const RectD& rodRef,
+                                                        const RectD& rodTime,
+                                                        const std::vector<Point>& x1,
+                                                        const std::vector<Point>& x2)
 {
-    std::vector<TrackMarkerPtr> markers;
-
-    for (std::size_t i = 0; i < allMarkers.size(); ++i) {
-        if ( allMarkers[i]->isEnabled(time) ) {
-            markers.push_back(allMarkers[i]);
-        }
-    }
     TrackerContextPrivate::CornerPinData data;
     data.rms = 0.;
     data.time = time;
     data.valid = true;
-    assert( !markers.empty() );
-    std::vector<Point> x1, x2;
-    extractSortedPointsFromMarkers(refTime, time, markers, jitterPeriod, jitterAdd, &x1, &x2);
     assert( x1.size() == x2.size() );
     if ( x1.empty() ) {
         data.valid = false;
@@ -1950,8 +1993,6 @@ TrackerContextPrivate::computeCornerPinParamsFromTracksAtTime(double refTime,
         return data;
     }
 
-    RectD rodRef = getInputRoDAtTime(refTime);
-    RectD rodTime = getInputRoDAtTime(time);
     int w1 = rodRef.width();
     int h1 = rodRef.height();
     int w2 = rodTime.width();
@@ -1977,7 +2018,73 @@ TrackerContextPrivate::computeCornerPinParamsFromTracksAtTime(double refTime,
     }
 
     return data;
-} // TrackerContextPrivate::computeCornerPinParamsFromTracksAtTime
+} // TrackerContextPrivate::computeCornerPinParamsFromPoints
+
+std::vector<TrackerContextPrivate::TransformData>
+TrackerContextPrivate::computeTransformParamsFromTracksForBatch(double refTime,
+                                                                const std::vector<double>& keyframes,
+                                                                int jitterPeriod,
+                                                                bool jitterAdd,
+                                                                bool robustModel,
+                                                                const std::vector<TrackMarkerPtr>& allMarkers,
+                                                                const std::vector<Point>& refPoints)
+{
+    SolverBatch batch;
+
+    batch.keyframes = keyframes;
+    extractSolverBatch(allMarkers, jitterPeriod, &batch);
+
+    const RectD rodRef = getInputRoDAtTime(refTime);
+    std::vector<TransformData> ret( keyframes.size() );
+    std::vector<Point> x1, x2;
+    for (std::size_t k = 0; k < keyframes.size(); ++k) {
+        makeSortedPointsFromSolverBatch(batch, k, refPoints, jitterPeriod, jitterAdd, &x1, &x2);
+        if ( x1.empty() ) {
+            ret[k].time = keyframes[k];
+            continue;
+        }
+        ret[k] = computeTransformParamsFromPoints( refTime, keyframes[k], robustModel, rodRef, getInputRoDAtTime(keyframes[k]), x1, x2 );
+    }
+
+    return ret;
+}
+
+std::vector<TrackerContextPrivate::CornerPinData>
+TrackerContextPrivate::computeCornerPinParamsFromTracksForBatch(double refTime,
+                                                                const std::vector<double>& keyframes,
+                                                                int jitterPeriod,
+                                                                bool jitterAdd,
+                                                                bool robustModel,
+                                                                const std::vector<TrackMarkerPtr>& allMarkers,
+                                                                const std::vector<Point>& refPoints)
+{
+    SolverBatch batch;
+
+    batch.keyframes = keyframes;
+    extractSolverBatch(allMarkers, jitterPeriod, &batch);
+
+    const RectD rodRef = getInputRoDAtTime(refTime);
+    std::vector<CornerPinData> ret( keyframes.size() );
+    std::vector<Point> x1, x2;
+    for (std::size_t k = 0; k < keyframes.size(); ++k) {
+        makeSortedPointsFromSolverBatch(batch, k, refPoints, jitterPeriod, jitterAdd, &x1, &x2);
+        if ( x1.empty() ) {
+            ret[k].time = keyframes[k];
+            continue;
+        }
+        ret[k] = computeCornerPinParamsFromPoints( refTime, keyframes[k], robustModel, rodRef, getInputRoDAtTime(keyframes[k]), x1, x2 );
+    }
+
+    return ret;
+}
+
+void
+TrackerContextPrivate::prepareSolveRequest()
+{
+    // A few batches per thread so that the threads stay busy when some batches have more tracks to solve
+    makeSolverBatches(lastSolveRequest.keyframes, QThreadPool::globalInstance()->maxThreadCount() * NATRON_TRACKER_SOLVER_BATCHES_PER_THREAD, &lastSolveRequest.keyframeBatches);
+    extractReferencePoints(lastSolveRequest.refTime, lastSolveRequest.allMarkers, lastSolveRequest.jitterPeriod, lastSolveRequest.jitterAdd, &lastSolveRequest.refPoints);
+}
 
 void
 TrackerContextPrivate::computeCornerParamsFromTracksEnd(double refTime,
@@ -2149,24 +2256,26 @@ TrackerContextPrivate::computeCornerParamsFromTracksEnd(double refTime,
 void
 TrackerContextPrivate::computeCornerParamsFromTracks()
 {
+    prepareSolveRequest();
 #ifndef TRACKER_GENERATE_DATA_SEQUENTIALLY
     lastSolveRequest.tWatcher.reset();
-    lastSolveRequest.cpWatcher.reset( new QFutureWatcher<TrackerContextPrivate::CornerPinData>() );
+    lastSolveRequest.cpWatcher.reset( new QFutureWatcher<std::vector<TrackerContextPrivate::CornerPinData> >() );
     QObject::connect( lastSolveRequest.cpWatcher.get(), SIGNAL(finished()), this, SLOT(onCornerPinSolverWatcherFinished()) );
     QObject::connect( lastSolveRequest.cpWatcher.get(), SIGNAL(progressValueChanged(int)), this, SLOT(onCornerPinSolverWatcherProgress(int)) );
-    lastSolveRequest.cpWatcher->setFuture( QtConcurrent::mapped( lastSolveRequest.keyframes, boost::bind(&TrackerContextPrivate::computeCornerPinParamsFromTracksAtTime, this, lastSolveRequest.refTime, _1, lastSolveRequest.jitterPeriod, lastSolveRequest.jitterAdd, lastSolveRequest.robustModel, lastSolveRequest.allMarkers) ) );
+    lastSolveRequest.cpWatcher->setFuture( QtConcurrent::mapped( lastSolveRequest.keyframeBatches, boost::bind(&TrackerContextPrivate::computeCornerPinParamsFromTracksForBatch, this, lastSolveRequest.refTime, _1, lastSolveRequest.jitterPeriod, lastSolveRequest.jitterAdd, lastSolveRequest.robustModel, lastSolveRequest.allMarkers, lastSolveRequest.refPoints) ) );
 #else
     NodePtr thisNode = node.lock();
     QList<CornerPinData> validResults;
     {
-        int nKeys = (int)lastSolveRequest.keyframes.size();
-        int keyIndex = 0;
-        for (std::set<double>::const_iterator it = lastSolveRequest.keyframes.begin(); it != lastSolveRequest.keyframes.end(); ++it, ++keyIndex) {
-            CornerPinData data = computeCornerPinParamsFromTracksAtTime(lastSolveRequest.refTime, *it, lastSolveRequest.jitterPeriod, lastSolveRequest.jitterAdd, lastSolveRequest.robustModel, lastSolveRequest.allMarkers);
-            if (data.valid) {
-                validResults.push_back(data);
+        int nBatches = (int)lastSolveRequest.keyframeBatches.size();
+        for (int i = 0; i < nBatches; ++i) {
+            std::vector<CornerPinData> batchResults = computeCornerPinParamsFromTracksForBatch(lastSolveRequest.refTime, lastSolveRequest.keyframeBatches[i], lastSolveRequest.jitterPeriod, lastSolveRequest.jitterAdd, lastSolveRequest.robustModel, lastSolveRequest.allMarkers, lastSolveRequest.refPoints);
+            for (std::size_t j = 0; j < batchResults.size(); ++j) {
+                if (batchResults[j].valid) {
+                    validResults.push_back(batchResults[j]);
+                }
             }
-            double progress = (keyIndex + 1) / (double)nKeys;
+            double progress = (i + 1) / (double)nBatches;
             thisNode->getApp()->progressUpdate(thisNode, progress);
         }
     }
@@ -2483,24 +2592,26 @@ TrackerContextPrivate::computeTransformParamsFromTracksEnd(double refTime,
 void
 TrackerContextPrivate::computeTransformParamsFromTracks()
 {
+    prepareSolveRequest();
 #ifndef TRACKER_GENERATE_DATA_SEQUENTIALLY
     lastSolveRequest.cpWatcher.reset();
-    lastSolveRequest.tWatcher.reset( new QFutureWatcher<TrackerContextPrivate::TransformData>() );
+    lastSolveRequest.tWatcher.reset( new QFutureWatcher<std::vector<TrackerContextPrivate::TransformData> >() );
     QObject::connect( lastSolveRequest.tWatcher.get(), SIGNAL(finished()), this, SLOT(onTransformSolverWatcherFinished()) );
     QObject::connect( lastSolveRequest.tWatcher.get(), SIGNAL(progressValueChanged(int)), this, SLOT(onTransformSolverWatcherProgress(int)) );
-    lastSolveRequest.tWatcher->setFuture( QtConcurrent::mapped( lastSolveRequest.keyframes, boost::bind(&TrackerContextPrivate::computeTransformParamsFromTracksAtTime, this, lastSolveRequest.refTime, _1, lastSolveRequest.jitterPeriod, lastSolveRequest.jitterAdd, lastSolveRequest.robustModel, lastSolveRequest.allMarkers) ) );
+    lastSolveRequest.tWatcher->setFuture( QtConcurrent::mapped( lastSolveRequest.keyframeBatches, boost::bind(&TrackerContextPrivate::computeTransformParamsFromTracksForBatch, this, lastSolveRequest.refTime, _1, lastSolveRequest.jitterPeriod, lastSolveRequest.jitterAdd, lastSolveRequest.robustModel, lastSolveRequest.allMarkers, lastSolveRequest.refPoints) ) );
 #else
     NodePtr thisNode = node.lock();
     QList<TransformData> validResults;
     {
-        int nKeys = lastSolveRequest.keyframes.size();
-        int keyIndex = 0;
-        for (std::set<double>::const_iterator it = lastSolveRequest.keyframes.begin(); it != lastSolveRequest.keyframes.end(); ++it, ++keyIndex) {
-            TransformData data = computeTransformParamsFromTracksAtTime(lastSolveRequest.refTime, *it, lastSolveRequest.jitterPeriod, lastSolveRequest.jitterAdd, lastSolveRequest.robustModel, lastSolveRequest.allMarkers);
-            if (data.valid) {
-                validResults.push_back(data);
+        int nBatches = (int)lastSolveRequest.keyframeBatches.size();
+        for (int i = 0; i < nBatches; ++i) {
+            std::vector<TransformData> batchResults = computeTransformParamsFromTracksForBatch(lastSolveRequest.refTime, lastSolveRequest.keyframeBatches[i], lastSolveRequest.jitterPeriod, lastSolveRequest.jitterAdd, lastSolveRequest.robustModel, lastSolveRequest.allMarkers, lastSolveRequest.refPoints);
+            for (std::size_t j = 0; j < batchResults.size(); ++j) {
+                if (batchResults[j].valid) {
+                    validResults.push_back(batchResults[j]);
+                }
             }
-            double progress = (keyIndex + 1) / (double)nKeys;
+            double progress = (i + 1) / (double)nBatches;
             thisNode->getApp()->progressUpdate(thisNode, progress);
         }
     }
@@ -2512,14 +2623,28 @@ void
 TrackerContextPrivate::onCornerPinSolverWatcherFinished()
 {
     assert(lastSolveRequest.cpWatcher);
-    computeCornerParamsFromTracksEnd( lastSolveRequest.refTime, lastSolveRequest.maxFittingError, lastSolveRequest.cpWatcher->future().results() );
+    QList<CornerPinData> results;
+    QList<std::vector<CornerPinData> > batchResults = lastSolveRequest.cpWatcher->future().results();
+    for (QList<std::vector<CornerPinData> >::const_iterator it = batchResults.begin(); it != batchResults.end(); ++it) {
+        for (std::size_t i = 0; i < it->size(); ++i) {
+            results.push_back( (*it)[i] );
+        }
+    }
+    computeCornerParamsFromTracksEnd(lastSolveRequest.refTime, lastSolveRequest.maxFittingError, results);
 }
 
 void
 TrackerContextPrivate::onTransformSolverWatcherFinished()
 {
     assert(lastSolveRequest.tWatcher);
-    computeTransformParamsFromTracksEnd( lastSolveRequest.refTime, lastSolveRequest.maxFittingError, lastSolveRequest.tWatcher->future().results() );
+    QList<TransformData> results;
+    QList<std::vector<TransformData> > batchResults = lastSolveRequest.tWatcher->future().results();
+    for (QList<std::vector<TransformData> >::const_iterator it = batchResults.begin(); it != batchResults.end(); ++it) {
+        for (std::size_t i = 0; i < it->size(); ++i) {
+            results.push_back( (*it)[i] );
+        }
+    }
+    computeTransformParamsFromTracksEnd(lastSolveRequest.refTime, lastSolveRequest.maxFittingError, results);
 }
 
 void
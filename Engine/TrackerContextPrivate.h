@@ -30,6 +30,7 @@
 #include "Engine/TrackerContext.h"
 
 #include <list>
+#include <vector>
 
 #include "Global/Macros.h"
 
@@ -471,8 +472,30 @@ public:
         double rms;
     };
 
-    typedef boost::shared_ptr<QFutureWatcher<CornerPinData> > CornerPinSolverWatcher;
-    typedef boost::shared_ptr<QFutureWatcher<TransformData> > TransformSolverWatcher;
+    /**
+     * @brief The marker data needed to solve a contiguous range of keyframes.
+     * The centers of all markers are read once for all the sample times of the batch (the keyframes
+     * and their jitter window) into contiguous arrays instead of once per keyframe and per window.
+     **/
+    struct SolverBatch
+    {
+        // Sorted keyframes to solve
+        std::vector<double> keyframes;
+
+        // Sorted union of the jitter windows of the keyframes
+        std::vector<double> sampleTimes;
+
+        // Center of marker m at sampleTimes[s] is centers[m * sampleTimes.size() + s]
+        std::vector<Point> centers;
+
+        // Error of marker m at keyframes[k] is errors[m * keyframes.size() + k].
+        // The marker is used at that keyframe only if it is enabled and has a keyframe on its center
+        std::vector<double> errors;
+        std::vector<bool> used;
+    };
+
+    typedef boost::shared_ptr<QFutureWatcher<std::vector<CornerPinData> > > CornerPinSolverWatcher;
+    typedef boost::shared_ptr<QFutureWatcher<std::vector<TransformData> > > TransformSolverWatcher;
 
     struct SolveRequest
     {
@@ -485,6 +508,11 @@ public:
         bool robustModel;
         double maxFittingError;
         std::vector<TrackMarkerPtr> allMarkers;
+
+        // Computed when the solve starts: the keyframes split in contiguous batches solved
+        // concurrently and the center of allMarkers at the reference time
+        std::vector<std::vector<double> > keyframeBatches;
+        std::vector<Point> refPoints;
     };
 
     SolveRequest lastSolveRequest;
@@ -619,37 +647,91 @@ public:
                                               double *RMS = 0);
 
     /**
-     * @brief Extracts the values of the center point of the given markers at x1Time and x2Time.
-     * @param jitterPeriod If jitterPeriod > 1 this is the amount of frames that will be averaged together to add
-     * jitter or remove jitter.
-     * @param jitterAdd If jitterPeriod > 1 this parameter is disregarded. Otherwise, if jitterAdd is false, then
-     * the values of the center points are smoothed with high frequencies removed (using average over jitterPeriod)
-     * If jitterAdd is true, then we compute the smoothed points (using average over jitterPeriod), and substract it
-     * from the original points to get the high frequencies. We then add those high frequencies back to the original
-     * points to increase shaking/motion
+     * @brief Returns the center of a marker at a time from the samples of its center over the jitter window
+     * centered on that time.
+     * @param nSamples The size of the window: 1 or 2 * (jitterPeriod / 2) + 1.
+     * If nSamples is 1 the sample is returned as is. Otherwise, if jitterAdd is false, then
+     * the values of the center points are smoothed with high frequencies removed (using average over the window)
+     * If jitterAdd is true, then we compute the smoothed point (using average over the window), and substract it
+     * from the original point to get the high frequencies. We then add those high frequencies back to the original
+     * point to increase shaking/motion
+     **/
+    static Point applyJitter(const Point* samples, int nSamples, bool jitterAdd);
+
+    /**
+     * @brief Returns the center of each marker at refTime, with the jitter applied as in applyJitter.
      **/
-    static void extractSortedPointsFromMarkers(double x1Time, double x2Time,
-                                               const std::vector<TrackMarkerPtr>& markers,
-                                               int jitterPeriod,
-                                               bool jitterAdd,
-                                               std::vector<Point>* x1,
-                                               std::vector<Point>* x2);
-
-
-    TransformData computeTransformParamsFromTracksAtTime(double refTime,
-                                                         double time,
-                                                         int jitterPeriod,
-                                                         bool jitterAdd,
-                                                         bool robustModel,
-                                                         const std::vector<TrackMarkerPtr>& allMarkers);
-
-    CornerPinData computeCornerPinParamsFromTracksAtTime(double refTime,
-                                                         double time,
-                                                         int jitterPeriod,
-                                                         bool jitterAdd,
-                                                         bool robustModel,
-                                                         const std::vector<TrackMarkerPtr>& allMarkers);
+    static void extractReferencePoints(double refTime,
+                                       const std::vector<TrackMarkerPtr>& markers,
+                                       int jitterPeriod,
+                                       bool jitterAdd,
+                                       std::vector<Point>* refPoints);
 
+    /**
+     * @brief Splits the keyframes in at most nBatches contiguous batches of the same size.
+     **/
+    static void makeSolverBatches(const std::set<double>& keyframes,
+                                  int nBatches,
+                                  std::vector<std::vector<double> >* batches);
+
+    /**
+     * @brief Reads the centers and errors of the markers needed to solve the keyframes of the batch.
+     * batch->keyframes must be set.
+     **/
+    static void extractSolverBatch(const std::vector<TrackMarkerPtr>& markers,
+                                   int jitterPeriod,
+                                   SolverBatch* batch);
+
+    /**
+     * @brief Builds the correspondences between the reference points and the points at batch.keyframes[keyIndex]
+     * of all markers used at that keyframe. Prosac expects the points to be sorted by decreasing correlation score
+     * (increasing error) so they are sorted by increasing error.
+     * x1 and x2 are cleared before, but their memory is reused across keyframes.
+     **/
+    static void makeSortedPointsFromSolverBatch(const SolverBatch& batch,
+                                                std::size_t keyIndex,
+                                                const std::vector<Point>& refPoints,
+                                                int jitterPeriod,
+                                                bool jitterAdd,
+                                                std::vector<Point>* x1,
+                                                std::vector<Point>* x2);
+
+    static TransformData computeTransformParamsFromPoints(double refTime,
+                                                          double time,
+                                                          bool robustModel,
+                                                          const RectD& rodRef,
+                                                          const RectD& rodTime,
+                                                          const std::vector<Point>& x1,
+                                                          const std::vector<Point>& x2);
+
+    static CornerPinData computeCornerPinParamsFromPoints(double refTime,
+                                                          double time,
+                                                          bool robustModel,
+                                                          const RectD& rodRef,
+                                                          const RectD& rodTime,
+                                                          const std::vector<Point>& x1,
+                                                          const std::vector<Point>& x2);
+
+    std::vector<TransformData> computeTransformParamsFromTracksForBatch(double refTime,
+                                                                        const std::vector<double>& keyframes,
+                                                                        int jitterPeriod,
+                                                                        bool jitterAdd,
+                                                                        bool robustModel,
+                                                                        const std::vector<TrackMarkerPtr>& allMarkers,
+                                                                        const std::vector<Point>& refPoints);
+
+    std::vector<CornerPinData> computeCornerPinParamsFromTracksForBatch(double refTime,
+                                                                        const std::vector<double>& keyframes,
+                                                                        int jitterPeriod,
+                                                                        bool jitterAdd,
+                                                                        bool robustModel,
+                                                                        const std::vector<TrackMarkerPtr>& allMarkers,
+                                                                        const std::vector<Point>& refPoints);
+
+    /**
+     * @brief Splits the keyframes of lastSolveRequest in batches and extracts the reference points
+     **/
+    void prepareSolveRequest();
 
     void resetTransformParamsAnimation();
 
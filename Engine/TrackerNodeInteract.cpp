@@ -1214,7 +1214,6 @@ TrackerNodeInteract::convertImageTosRGBOpenGLTexture(const ImagePtr& image,
             int w = roi.width();
             int srcRowElements = bounds.width() * srcNComps;
             const Color::Lut* lut = Color::LutManager::sRGBLut();
-            lut->validate();
             assert(lut);
 
             unsigned char alpha = 255;
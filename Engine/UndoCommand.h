@@ -27,6 +27,7 @@
 
 #include "Global/Macros.h"
 
+#include <cstddef>
 #include <string>
 
 #include "Engine/EngineFwd.h"
@@ -74,6 +75,15 @@ public:
     {
         return false;
     }
+
+    /**
+     * @brief Returns an estimate in bytes of the memory held by this action, used to report
+     * and cap the size of the undo/redo stacks.
+     **/
+    virtual std::size_t getMemoryCost() const
+    {
+        return sizeof(*this) + _text.capacity();
+    }
 };
 
 NATRON_NAMESPACE_EXIT;
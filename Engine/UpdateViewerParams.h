@@ -59,10 +59,13 @@ public:
         bool isCached;
         unsigned char* ramBuffer; // a pointer to the RAM buffer held either by the cached frame or allocated by malloc()
         std::size_t bytesCount; // number of bytes in the texture
+        // true if ramBuffer was allocated by malloc() for a tile stored compressed in the cache, in which case it is freed
+        // along with these params
+        bool ownsRamBuffer;
 
 
         CachedTile()
-            : rect(), rectRounded(), cachedData(), isCached(false), ramBuffer(0), bytesCount(0) {}
+            : rect(), rectRounded(), cachedData(), isCached(false), ramBuffer(0), bytesCount(0), ownsRamBuffer(false) {}
     };
 
     UpdateViewerParams()
@@ -101,6 +104,11 @@ public:
             assert(tiles.size() == 1);
             free(tiles.front().ramBuffer);
         }
+        for (std::list<CachedTile>::iterator it = tiles.begin(); it != tiles.end(); ++it) {
+            if (it->ownsRamBuffer) {
+                free(it->ramBuffer);
+            }
+        }
     }
 
     virtual std::size_t sizeInRAM() const OVERRIDE FINAL
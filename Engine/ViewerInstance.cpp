@@ -119,6 +119,7 @@ static void renderFunctor(const RectI& roi,
                           const RenderViewerArgs & args,
                           const ViewerInstancePtr& viewer,
                           UpdateViewerParams::CachedTile tile);
+static void uncompressCachedTile(UpdateViewerParams::CachedTile* tile);
 
 /**
  *@brief Actually converting to ARGB... but it is called BGRA by
@@ -151,9 +152,6 @@ ViewerInstance::lutFromColorspace(ViewerColorSpaceEnum cs)
         lut = 0;
         break;
     }
-    if (lut) {
-        lut->validate();
-    }
 
     return lut;
 }
@@ -814,6 +812,41 @@ ViewerInstance::getRenderViewerArgsAndCheckCache_public(SequenceTime time,
     return stat;
 }
 
+unsigned int
+ViewerInstance::getAutoProxyMipMapLevel(double zoomFactor)
+{
+    unsigned int autoProxyLevel = appPTR->getCurrentSettings()->getAutoProxyMipMapLevel();
+
+    if (zoomFactor > 1) {
+        //Decrease draft mode at each inverse mipmaplevel level taken
+        unsigned int invLevel = Image::getLevelFromScale(1. / zoomFactor);
+        if (invLevel < autoProxyLevel) {
+            autoProxyLevel -= invLevel;
+        } else {
+            autoProxyLevel = 0;
+        }
+    }
+
+    return autoProxyLevel;
+}
+
+bool
+ViewerInstance::isProgressiveRenderUseful() const
+{
+    assert( qApp && qApp->thread() == QThread::currentThread() );
+    if ( !_imp->uiContext || !appPTR->getCurrentSettings()->isProgressiveViewerRenderingEnabled() || isFullFrameProcessingEnabled() ) {
+        return false;
+    }
+    // Draft renders with auto-proxy are already coarse
+    if ( getApp()->isDraftRenderEnabled() && appPTR->getCurrentSettings()->isAutoProxyEnabled() ) {
+        return false;
+    }
+    // Same as the level computed in setupMinimalUpdateViewerParams()
+    int mipMapLevel = std::max( (int)getViewerMipMapLevel(), getMipMapLevelFromZoomFactor() );
+
+    return (int)getAutoProxyMipMapLevel( _imp->uiContext->getZoomFactor() ) > mipMapLevel;
+}
+
 void
 ViewerInstance::setupMinimalUpdateViewerParams(const SequenceTime time,
                                                const ViewIdx view,
@@ -854,19 +887,20 @@ ViewerInstance::setupMinimalUpdateViewerParams(const SequenceTime time,
 
     outArgs->draftModeEnabled = getApp()->isDraftRenderEnabled();
 
-    // If draft mode is enabled, compute the mipmap level according to the auto-proxy setting in the preferences
-    if ( outArgs->draftModeEnabled && appPTR->getCurrentSettings()->isAutoProxyEnabled() ) {
-        unsigned int autoProxyLevel = appPTR->getCurrentSettings()->getAutoProxyMipMapLevel();
-        if (zoomFactor > 1) {
-            //Decrease draft mode at each inverse mipmaplevel level taken
-            unsigned int invLevel = Image::getLevelFromScale(1. / zoomFactor);
-            if (invLevel < autoProxyLevel) {
-                autoProxyLevel -= invLevel;
-            } else {
-                autoProxyLevel = 0;
-            }
+    // If draft mode is enabled, compute the mipmap level according to the auto-proxy setting in the preferences.
+    // The coarse pass of a progressive render is a draft render at that level.
+    if ( outArgs->isProgressiveCoarsePass || ( outArgs->draftModeEnabled && appPTR->getCurrentSettings()->isAutoProxyEnabled() ) ) {
+        outArgs->draftModeEnabled = true;
+        outArgs->mipMapLevelWithDraft = (unsigned int)std::max( (int)outArgs->mipmapLevelWithoutDraft, (int)getAutoProxyMipMapLevel(zoomFactor) );
+    }
+
+    // During playback, the engine may lower the resolution to hold the frame rate (see PlaybackController)
+    if (isSequential) {
+        unsigned int playbackOffset = getRenderEngine()->getPlaybackMipMapLevelOffset();
+        if (playbackOffset > 0) {
+            outArgs->draftModeEnabled = true;
+            outArgs->mipMapLevelWithDraft = std::max(outArgs->mipMapLevelWithDraft, outArgs->mipmapLevelWithoutDraft + playbackOffset);
         }
-        outArgs->mipMapLevelWithDraft = (unsigned int)std::max( (int)outArgs->mipmapLevelWithoutDraft, (int)autoProxyLevel );
     }
 
 
@@ -1035,6 +1069,7 @@ ViewerInstance::getViewerRoIAndTexture(const RectD& rod,
 
     if (useCache) {
         FrameEntryLocker entryLocker(_imp.get());
+        std::vector<UpdateViewerParams::CachedTile*> compressedTiles;
         for (std::list<UpdateViewerParams::CachedTile>::iterator it = outArgs->params->tiles.begin(); it != outArgs->params->tiles.end(); ++it) {
             FrameKey key(getNode().get(),
                          outArgs->params->time,
@@ -1101,11 +1136,33 @@ ViewerInstance::getViewerRoIAndTexture(const RectD& rod,
                 // The data will be valid as long as the cachedFrame shared pointer use_count is gt 1
                 it->cachedData = foundCachedEntry;
                 it->isCached = true;
-                it->ramBuffer = foundCachedEntry->data();
-                assert(it->ramBuffer);
+                if ( foundCachedEntry->isCompressed() ) {
+                    // Decoded below, all at once
+                    compressedTiles.push_back( &*it );
+                } else {
+                    it->ramBuffer = foundCachedEntry->data();
+                    assert(it->ramBuffer);
+                }
                 ++outArgs->params->nbCachedTile;
             }
         }
+
+        // Decode the compressed tiles while their entries are locked, in parallel unless the thread pool is already busy
+        if ( (compressedTiles.size() > 1) && ( QThreadPool::globalInstance()->activeThreadCount() < QThreadPool::globalInstance()->maxThreadCount() ) ) {
+            QtConcurrent::blockingMap(compressedTiles, uncompressCachedTile);
+        } else {
+            for (std::size_t i = 0; i < compressedTiles.size(); ++i) {
+                uncompressCachedTile(compressedTiles[i]);
+            }
+        }
+        for (std::size_t i = 0; i < compressedTiles.size(); ++i) {
+            if (!compressedTiles[i]->ramBuffer) {
+                // The tile could not be decoded, render it again
+                compressedTiles[i]->cachedData.reset();
+                compressedTiles[i]->isCached = false;
+                --outArgs->params->nbCachedTile;
+            }
+        }
     }
 
 
@@ -1474,6 +1531,8 @@ ViewerInstance::renderViewer_internal(ViewIdx view,
 
 #pragma message WARN("Implement Viewer so it accepts OpenGL Textures in input")
     BufferableObjectList partialUpdateObjects;
+    // Set when another render superseded this one while it was rendering: the textures are only cached
+    bool isSuperseded = false;
     for (std::size_t rectIndex = 0; rectIndex < splitRoi.size(); ++rectIndex) {
         //AlphaImage will only be set when displaying the Matte overlay
         ImagePtr alphaImage, colorImage;
@@ -1554,12 +1613,14 @@ ViewerInstance::renderViewer_internal(ViewIdx view,
 
         ///We check that the render age is still OK and that no other renders were triggered, in which case we should not need to
         ///refresh the viewer.
-        if ( !_imp->checkAgeNoUpdate( inArgs.params->textureIndex, inArgs.params->abortInfo->getRenderAge() ) ) {
-            return eViewerRenderRetCodeRedraw;
-        }
-
-        if ( inArgs.activeInputToRender->aborted() ) {
-            return eViewerRenderRetCodeRedraw;
+        if ( !isSuperseded && ( !_imp->checkAgeNoUpdate( inArgs.params->textureIndex, inArgs.params->abortInfo->getRenderAge() ) ||
+                                inArgs.activeInputToRender->aborted() ) ) {
+            // The image is complete: if it is still up to date, put its textures in the cache anyway for the render that
+            // superseded this one (e.g. after a pan or zoom, or the refinement of a progressive render), but do not display them.
+            if ( !useTextureCache || (inArgs.activeInputToRender->getHash() != inArgs.activeInputHash) ) {
+                return eViewerRenderRetCodeRedraw;
+            }
+            isSuperseded = true;
         }
 
         const bool viewerRenderRoiOnly = !useTextureCache;
@@ -1713,6 +1774,7 @@ ViewerInstance::renderViewer_internal(ViewIdx view,
             tileBounds.x2 = tileBounds.y2 = inArgs.params->tileSize;
 
             std::string inputToRenderName = inArgs.activeInputToRender->getNode()->getScriptName_mt_safe();
+            const int compressionRatio = appPTR->getCurrentSettings()->getViewerCacheCompressionRatio();
             for (std::list<UpdateViewerParams::CachedTile>::iterator it = updateParams->tiles.begin(); it != updateParams->tiles.end(); ++it) {
                 if (it->isCached) {
                     assert(it->ramBuffer);
@@ -1739,7 +1801,7 @@ ViewerInstance::renderViewer_internal(ViewIdx view,
 
 
 
-                    boost::shared_ptr<FrameParams> cachedFrameParams( new FrameParams(bounds , key.getBitDepth(), tileBounds, ImagePtr() ) );
+                    boost::shared_ptr<FrameParams> cachedFrameParams( new FrameParams(bounds , key.getBitDepth(), tileBounds, ImagePtr(), compressionRatio) );
                     bool cached = appPTR->getTextureOrCreate(key, cachedFrameParams, &entryLocker, &it->cachedData);
                     if (!it->cachedData) {
                         std::size_t size = cachedFrameParams->getStorageInfo().numComponents * cachedFrameParams->getStorageInfo().dataTypeSize * cachedFrameParams->getStorageInfo().bounds.area();
@@ -1755,9 +1817,17 @@ ViewerInstance::renderViewer_internal(ViewIdx view,
                     } else {
                         // If the tile is cached and we got it that means rendering is done
                         entryLocker.lock(it->cachedData);
-                        it->ramBuffer = it->cachedData->data();
-                        it->isCached = true;
-                        continue;
+                        if ( !it->cachedData->isCompressed() ) {
+                            it->ramBuffer = it->cachedData->data();
+                            it->isCached = true;
+                            continue;
+                        }
+                        uncompressCachedTile( &*it );
+                        if (it->ramBuffer) {
+                            it->isCached = true;
+                            continue;
+                        }
+                        // The tile could not be decoded: render it again and overwrite the entry
                     }
 
 
@@ -1767,7 +1837,20 @@ ViewerInstance::renderViewer_internal(ViewIdx view,
                     ///Since it is used during the whole function scope it is guaranteed not to be freed before
                     ///The viewer is actually done with it.
                     /// @see Cache::clearInMemoryPortion and Cache::clearDiskPortion and LRUHashTable::evict
-                    it->ramBuffer = it->cachedData->data();
+                    if ( it->cachedData->isCompressed() ) {
+                        // Render into a raw buffer which renderFunctor encodes into the entry.
+                        // Zero it so that the padding of the edge tiles costs nothing to encode.
+                        it->ramBuffer = (unsigned char*)calloc(it->bytesCount, 1);
+                        if (!it->ramBuffer) {
+                            QString s = tr("Failed to allocate a texture of %1.").arg( printAsRAM(it->bytesCount) );
+                            Dialogs::errorDialog( tr("Out of memory").toStdString(), s.toStdString() );
+
+                            return eViewerRenderRetCodeFail;
+                        }
+                        it->ownsRamBuffer = true;
+                    } else {
+                        it->ramBuffer = it->cachedData->data();
+                    }
                     assert(it->ramBuffer);
                     unCachedTiles.push_back(*it);
                 } // !it->isCached
@@ -1926,6 +2009,10 @@ ViewerInstance::renderViewer_internal(ViewIdx view,
     } // for (std::vector<RectI>::iterator rect = splitRoi.begin(); rect != splitRoi.end(), ++rect) {
 
 
+    if (isSuperseded) {
+        return eViewerRenderRetCodeRedraw;
+    }
+
     /*
        If we were rendering only partial rectangles, update them all at once
      */
@@ -1982,6 +2069,33 @@ renderFunctor(const RectI& roi,
         // texture is stored as sRGB/Rec709 compressed 8-bit RGBA
         scaleToTexture8bits(roi, args, viewer, tile, (U32*)tile.ramBuffer);
     }
+
+    // Encode the tile into the cache here so that tiles are compressed in parallel
+    if ( tile.cachedData && tile.ownsRamBuffer && tile.cachedData->isCompressed() ) {
+        if ( !tile.cachedData->compressPixels(tile.ramBuffer) ) {
+            // The tile does not fit in its slot without visible loss (e.g: grain): it is displayed from
+            // the raw buffer but not cached
+            appPTR->removeFromViewerCache(tile.cachedData);
+        }
+    }
+}
+
+/**
+ * @brief Decodes the compressed cache entry of the tile into a buffer owned by the tile.
+ * On failure the tile is left without buffer.
+ **/
+void
+uncompressCachedTile(UpdateViewerParams::CachedTile* tile)
+{
+    assert( tile->cachedData && tile->cachedData->isCompressed() );
+    assert( tile->bytesCount == tile->cachedData->getUncompressedSizeInBytes() );
+    unsigned char* pixels = (unsigned char*)malloc(tile->bytesCount);
+    if ( pixels && !tile->cachedData->uncompressPixels(pixels) ) {
+        free(pixels);
+        pixels = 0;
+    }
+    tile->ramBuffer = pixels;
+    tile->ownsRamBuffer = (pixels != 0);
 }
 
 inline
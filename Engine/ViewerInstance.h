@@ -59,6 +59,28 @@ struct ViewerArgs
     bool userRoIEnabled;
     bool mustComputeRoDAndLookupCache;
     bool isDoingPartialUpdates;
+    // Set by the caller before calling getRenderViewerArgsAndCheckCache_public(): render at the auto-proxy level,
+    // the caller renders again at full resolution afterwards
+    bool isProgressiveCoarsePass;
+
+    ViewerArgs()
+        : activeInputToRender()
+        , forceRender(false)
+        , activeInputIndex(-1)
+        , activeInputHash(0)
+        , params()
+        , isRenderingFlag()
+        , draftModeEnabled(false)
+        , mipMapLevelWithDraft(0)
+        , mipmapLevelWithoutDraft(0)
+        , autoContrast(false)
+        , channels(eDisplayChannelsRGB)
+        , userRoIEnabled(false)
+        , mustComputeRoDAndLookupCache(true)
+        , isDoingPartialUpdates(false)
+        , isProgressiveCoarsePass(false)
+    {
+    }
 };
 
 class ViewerInstance
@@ -132,7 +154,19 @@ public:
                                                                 const RenderStatsPtr& stats,
                                                                 ViewerArgs* outArgs);
 
+    /**
+     * @brief Returns true if a progressive render would first render at a lower resolution than the one of the viewer,
+     * i.e: if it is enabled in the preferences and the auto-proxy level is coarser than the current mipmap level.
+     **/
+    bool isProgressiveRenderUseful() const WARN_UNUSED_RETURN;
+
 private:
+
+    /**
+     * @brief Returns the auto-proxy mipmap level from the preferences, adjusted for zoom factors greater than 1.
+     **/
+    static unsigned int getAutoProxyMipMapLevel(double zoomFactor) WARN_UNUSED_RETURN;
+
     /**
      * @brief Look-up the cache and try to find a matching texture for the portion to render.
      **/
@@ -0,0 +1,606 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <http://www.natron.fr/>,
+ * Copyright (C) 2016 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "ViewerTileCodec.h"
+
+#include <vector>
+#include <algorithm> // min, max
+#include <cassert>
+#include <cstring> // for std::memcpy
+
+NATRON_NAMESPACE_ENTER;
+
+// Size of the header written in front of each encoded tile
+#define VIEWER_TILE_CODEC_HEADER_SIZE 4
+
+// Length of the unary prefix after which a residual is stored raw
+#define VIEWER_TILE_CODEC_ESCAPE 24
+
+// Number of samples after which the adaptive statistics of a channel are halved
+#define VIEWER_TILE_CODEC_RESET 64
+
+NATRON_NAMESPACE_ANONYMOUS_ENTER
+
+enum TileCodingEnum
+{
+    // Median edge detector prediction and adaptive Rice codes of the samples shifted right by the header parameter
+    eTileCodingPredictive = 0
+};
+
+enum TileSampleFormatEnum
+{
+    eTileSampleFormatByte = 0,
+    // Half-float bits remapped so that their integer order matches the order of the values
+    eTileSampleFormatOrderedHalf
+};
+
+inline int
+countLeadingZeros(U32 v)
+{
+    assert(v);
+#if defined(__GNUC__)
+
+    return __builtin_clz(v);
+#else
+    int n = 0;
+    while ( !(v & 0x80000000) ) {
+        v <<= 1;
+        ++n;
+    }
+
+    return n;
+#endif
+}
+
+inline unsigned short
+floatToHalf(float value)
+{
+    U32 f;
+
+    std::memcpy( &f, &value, sizeof(U32) );
+
+    U32 sign = (f >> 16) & 0x8000;
+    U32 mant = f & 0x7fffff;
+    int exp = (int)( (f >> 23) & 0xff ) - 127 + 15;
+
+    if ( (f & 0x7fffffff) >= 0x7f800000 ) {
+        // Inf or NaN
+        return (unsigned short)( sign | 0x7c00 | (mant ? 0x200 : 0) );
+    }
+    if (exp >= 31) {
+        // Overflow
+        return (unsigned short)(sign | 0x7c00);
+    }
+    if (exp <= 0) {
+        // Denormal or zero
+        if (exp < -10) {
+            return (unsigned short)sign;
+        }
+        mant |= 0x800000;
+        int shift = 14 - exp;
+        U32 h = mant >> shift;
+        U32 rem = mant & ( (1u << shift) - 1 );
+        U32 halfway = 1u << (shift - 1);
+        if ( (rem > halfway) || ( (rem == halfway) && (h & 1) ) ) {
+            ++h;
+        }
+
+        return (unsigned short)(sign | h);
+    }
+
+    // Round to nearest even, a carry correctly propagates to the exponent
+    U32 h = sign | ( (U32)exp << 10 ) | (mant >> 13);
+    U32 rem = mant & 0x1fff;
+    if ( (rem > 0x1000) || ( (rem == 0x1000) && (h & 1) ) ) {
+        ++h;
+    }
+
+    return (unsigned short)h;
+}
+
+inline float
+halfToFloat(unsigned short h)
+{
+    U32 sign = (U32)(h & 0x8000) << 16;
+    U32 exp = (h >> 10) & 0x1f;
+    U32 mant = h & 0x3ff;
+    U32 f;
+
+    if (exp == 0) {
+        if (mant == 0) {
+            f = sign;
+        } else {
+            // Normalize the denormal
+            exp = 127 - 15 + 1;
+            while ( !(mant & 0x400) ) {
+                mant <<= 1;
+                --exp;
+            }
+            mant &= 0x3ff;
+            f = sign | (exp << 23) | (mant << 13);
+        }
+    } else if (exp == 31) {
+        f = sign | 0x7f800000 | (mant << 13);
+    } else {
+        f = sign | ( (exp + 112) << 23 ) | (mant << 13);
+    }
+    float ret;
+    std::memcpy( &ret, &f, sizeof(float) );
+
+    return ret;
+}
+
+inline unsigned short
+halfToOrdered(unsigned short h)
+{
+    return (h & 0x8000) ? (unsigned short)(~h & 0xffff) : (unsigned short)(h | 0x8000);
+}
+
+inline unsigned short
+orderedToHalf(unsigned short o)
+{
+    return (o & 0x8000) ? (unsigned short)(o & 0x7fff) : (unsigned short)(~o & 0xffff);
+}
+
+class BitWriter
+{
+    unsigned char* _dst;
+    std::size_t _size;
+    std::size_t _pos;
+    U64 _acc;
+    int _nBits;
+    bool _overflow;
+
+public:
+
+    BitWriter(unsigned char* dst,
+              std::size_t size)
+        : _dst(dst)
+        , _size(size)
+        , _pos(0)
+        , _acc(0)
+        , _nBits(0)
+        , _overflow(false)
+    {
+    }
+
+    // Writes the n (<= 32) low bits of value, most significant first
+    void put(U32 value,
+             int n)
+    {
+        assert(n <= 32);
+        _acc = (_acc << n) | value;
+        _nBits += n;
+        while (_nBits >= 8) {
+            _nBits -= 8;
+            if (_pos < _size) {
+                _dst[_pos++] = (unsigned char)(_acc >> _nBits);
+            } else {
+                _overflow = true;
+            }
+        }
+        _acc &= ( (U64)1 << _nBits ) - 1;
+    }
+
+    bool hasOverflowed() const
+    {
+        return _overflow;
+    }
+
+    // Pads the last byte and returns the number of bytes written or 0 if it did not fit
+    std::size_t finish()
+    {
+        if (_nBits) {
+            put(0, 8 - _nBits);
+        }
+
+        return _overflow ? 0 : _pos;
+    }
+};
+
+class BitReader
+{
+    const unsigned char* _src;
+    std::size_t _size;
+    std::size_t _pos;
+    std::size_t _padding;
+    U64 _acc;
+    int _nBits;
+
+public:
+
+    BitReader(const unsigned char* src,
+              std::size_t size)
+        : _src(src)
+        , _size(size)
+        , _pos(0)
+        , _padding(0)
+        , _acc(0)
+        , _nBits(0)
+    {
+    }
+
+    // Makes sure at least 57 bits are available
+    void refill()
+    {
+        if ( (_nBits > 0) && (_pos + 8 <= _size) ) {
+            // Fast path: append as many whole bytes as fit in the accumulator at once
+            int nBytes = (64 - _nBits) >> 3;
+            U64 v = 0;
+            for (int i = 0; i < 8; ++i) {
+                v = (v << 8) | _src[_pos + i];
+            }
+            _acc = ( _acc << (nBytes * 8) ) | ( v >> (64 - nBytes * 8) );
+            _pos += nBytes;
+            _nBits += nBytes * 8;
+
+            return;
+        }
+        while (_nBits <= 56) {
+            U64 b = 0;
+            if (_pos < _size) {
+                b = _src[_pos++];
+            } else {
+                ++_padding;
+            }
+            _acc = (_acc << 8) | b;
+            _nBits += 8;
+        }
+    }
+
+    // Reads n (<= 32) bits
+    U32 get(int n)
+    {
+        if (!n) {
+            return 0;
+        }
+        if (_nBits < n) {
+            refill();
+        }
+        _nBits -= n;
+
+        return (U32)( (_acc >> _nBits) & ( ( (U64)1 << n ) - 1 ) );
+    }
+
+    // Reads a residual coded with the Rice parameter k: a unary prefix of q 0 bits followed by a 1 bit and k bits,
+    // or VIEWER_TILE_CODEC_ESCAPE 0 bits followed by the raw residual on escapeBits bits
+    U32 getRice(int k,
+                int escapeBits)
+    {
+        if (_nBits < 48) {
+            refill();
+        }
+        U32 peek = (U32)(_acc >> (_nBits - 32));
+        int q = peek ? countLeadingZeros(peek) : 32;
+        if (q >= VIEWER_TILE_CODEC_ESCAPE) {
+            _nBits -= VIEWER_TILE_CODEC_ESCAPE;
+
+            return get(escapeBits);
+        }
+        // At most 24 + 1 + 16 bits, all available after the refill
+        _nBits -= q + 1 + k;
+
+        return ( (U32)q << k ) | (U32)( (_acc >> _nBits) & ( ( (U64)1 << k ) - 1 ) );
+    }
+
+    // True if the reader went past the end of the stream, by more than what a refill may prefetch
+    bool isExhausted() const
+    {
+        return _padding * 8 > (std::size_t)_nBits;
+    }
+};
+
+struct ChannelStats
+{
+    U32 a;
+    U32 n;
+
+    ChannelStats()
+        : a(2)
+        , n(1)
+    {
+    }
+
+    void init(int bits)
+    {
+        a = std::max(2, ( (1 << bits) + 32 ) >> 6);
+        n = 1;
+    }
+
+    // Smallest k such that n * 2^k >= a, i.e. the expected magnitude of the residuals
+    int getK(int bits) const
+    {
+        int k = countLeadingZeros(n) - countLeadingZeros(a);
+
+        if (k < 0) {
+            return 0;
+        }
+        if ( (n << k) < a ) {
+            ++k;
+        }
+
+        return k < bits ? k : bits;
+    }
+
+    void update(U32 u)
+    {
+        a += u;
+        if (n == VIEWER_TILE_CODEC_RESET) {
+            // a stays >= 1
+            a = (a + 1) >> 1;
+            n >>= 1;
+        }
+        ++n;
+    }
+};
+
+// Median edge detector, from the left (a), above (b) and above-left (c) neighbours
+inline int
+predictMED(int a,
+           int b,
+           int c)
+{
+    int mn = a < b ? a : b;
+    int mx = a < b ? b : a;
+    int grad = a + b - c;
+
+    // Written so that the compiler can use conditional moves: the outcome is not predictable
+    grad = c <= mn ? mx : grad;
+
+    return c >= mx ? mn : grad;
+}
+
+// Rows hold the 4 channels interleaved
+inline int
+predict(const unsigned short* row,
+        const unsigned short* prevRow,
+        int i,
+        int bits)
+{
+    if (!prevRow) {
+        return i < 4 ? (1 << (bits - 1)) : row[i - 4];
+    } else if (i < 4) {
+        return prevRow[i];
+    }
+
+    return predictMED(row[i - 4], prevRow[i], prevRow[i - 4]);
+}
+
+// The 4 channels are coded in the same pass, each with its own statistics, so that their
+// dependency chains can be executed in parallel by the CPU
+std::size_t
+encodePredictive(const std::vector<unsigned short>& samples,
+                 int width,
+                 int height,
+                 int sampleBits,
+                 int shift,
+                 unsigned char* dst,
+                 std::size_t dstSize)
+{
+    const int bits = sampleBits - shift;
+    const int half = 1 << (bits - 1);
+    const int mask = (1 << bits) - 1;
+    const int rowSize = width * 4;
+    BitWriter writer(dst, dstSize);
+    ChannelStats stats[4];
+
+    for (int c = 0; c < 4; ++c) {
+        stats[c].init(bits);
+    }
+
+    // Predictions are made on quantized values so that the decoder can reproduce them
+    std::vector<unsigned short> rows(rowSize * 2);
+    const unsigned short* src = &samples[0];
+    for (int y = 0; y < height; ++y) {
+        unsigned short* row = &rows[(y & 1) * rowSize];
+        const unsigned short* prevRow = y ? &rows[( (y - 1) & 1 ) * rowSize] : 0;
+        for (int i = 0; i < rowSize; ++i, ++src) {
+            ChannelStats& s = stats[i & 3];
+            row[i] = *src >> shift;
+            // Residual modulo the range, in [-range / 2, range / 2)
+            int e = ( ( row[i] - predict(row, prevRow, i, bits) + half ) & mask ) - half;
+            // Map signed residuals to unsigned: 0, -1, 1, -2, ... to 0, 1, 2, 3, ...
+            U32 u = ( (U32)e << 1 ) ^ (U32)(e >> 31);
+            int k = s.getK(bits);
+            U32 q = u >> k;
+            if (q < VIEWER_TILE_CODEC_ESCAPE) {
+                // q 0 bits, a 1 bit and the k low bits of u
+                writer.put( ( (U32)1 << k ) | ( u & ( (1u << k) - 1 ) ), q + 1 + k );
+            } else {
+                writer.put(0, VIEWER_TILE_CODEC_ESCAPE);
+                writer.put(u, bits);
+            }
+            s.update(u);
+        }
+        if ( writer.hasOverflowed() ) {
+            return 0;
+        }
+    }
+
+    return writer.finish();
+} // encodePredictive
+
+bool
+decodePredictive(BitReader& reader,
+                 int width,
+                 int height,
+                 int sampleBits,
+                 int shift,
+                 std::vector<unsigned short>* samples)
+{
+    const int bits = sampleBits - shift;
+    const int mask = (1 << bits) - 1;
+    const unsigned short rounding = shift ? (unsigned short)( 1 << (shift - 1) ) : 0;
+    const int rowSize = width * 4;
+    ChannelStats stats[4];
+
+    for (int c = 0; c < 4; ++c) {
+        stats[c].init(bits);
+    }
+
+    std::vector<unsigned short> rows(rowSize * 2);
+    unsigned short* dst = &(*samples)[0];
+    for (int y = 0; y < height; ++y) {
+        unsigned short* row = &rows[(y & 1) * rowSize];
+        const unsigned short* prevRow = y ? &rows[( (y - 1) & 1 ) * rowSize] : 0;
+        for (int i = 0; i < rowSize; ++i, ++dst) {
+            ChannelStats& s = stats[i & 3];
+            U32 u = reader.getRice(s.getK(bits), bits);
+            s.update(u);
+            int e = (int)(u >> 1) ^ -(int)(u & 1);
+            row[i] = (unsigned short)( ( predict(row, prevRow, i, bits) + e ) & mask );
+            *dst = (unsigned short)( (row[i] << shift) | rounding );
+        }
+        if ( reader.isExhausted() ) {
+            return false;
+        }
+    }
+
+    return true;
+} // decodePredictive
+
+NATRON_NAMESPACE_ANONYMOUS_EXIT
+
+namespace ViewerTileCodec {
+std::size_t
+getUncompressedSize(int width,
+                    int height,
+                    ImageBitDepthEnum depth)
+{
+    std::size_t pixelSize = 4;
+
+    if (depth == eImageBitDepthFloat) {
+        pixelSize *= sizeof(float);
+    }
+
+    return (std::size_t)width * height * pixelSize;
+}
+
+std::size_t
+encode(const unsigned char* pixels,
+       int width,
+       int height,
+       ImageBitDepthEnum depth,
+       unsigned char* dst,
+       std::size_t dstSize)
+{
+    assert(depth == eImageBitDepthByte || depth == eImageBitDepthFloat);
+    if ( (width <= 0) || (height <= 0) || (dstSize <= VIEWER_TILE_CODEC_HEADER_SIZE) ) {
+        return 0;
+    }
+    const std::size_t nSamples = (std::size_t)width * height * 4;
+    std::vector<unsigned short> samples(nSamples);
+    int sampleBits;
+    TileSampleFormatEnum format;
+    if (depth == eImageBitDepthFloat) {
+        const float* src = (const float*)pixels;
+        for (std::size_t i = 0; i < nSamples; ++i) {
+            samples[i] = halfToOrdered( floatToHalf(src[i]) );
+        }
+        sampleBits = 16;
+        format = eTileSampleFormatOrderedHalf;
+    } else {
+        for (std::size_t i = 0; i < nSamples; ++i) {
+            samples[i] = pixels[i];
+        }
+        sampleBits = 8;
+        format = eTileSampleFormatByte;
+    }
+
+    dst[1] = (unsigned char)format;
+    dst[3] = 0;
+    unsigned char* payload = dst + VIEWER_TILE_CODEC_HEADER_SIZE;
+    const std::size_t payloadSize = dstSize - VIEWER_TILE_CODEC_HEADER_SIZE;
+
+    // Drop least significant bits until the tile fits, keeping at least half of the bits
+    for (int shift = 0; shift <= sampleBits / 2; ++shift) {
+        std::size_t written = encodePredictive(samples, width, height, sampleBits, shift, payload, payloadSize);
+        if (written) {
+            dst[0] = (unsigned char)eTileCodingPredictive;
+            dst[2] = (unsigned char)shift;
+
+            return written + VIEWER_TILE_CODEC_HEADER_SIZE;
+        }
+    }
+
+    // Noise-like content: dropping more bits would visibly posterize the tile
+    return 0;
+} // encode
+
+bool
+decode(const unsigned char* src,
+       std::size_t srcSize,
+       int width,
+       int height,
+       ImageBitDepthEnum depth,
+       unsigned char* pixels)
+{
+    assert(depth == eImageBitDepthByte || depth == eImageBitDepthFloat);
+    if ( (width <= 0) || (height <= 0) || (srcSize <= VIEWER_TILE_CODEC_HEADER_SIZE) ) {
+        return false;
+    }
+    const TileSampleFormatEnum format = (TileSampleFormatEnum)src[1];
+    const int sampleBits = format == eTileSampleFormatOrderedHalf ? 16 : 8;
+    if ( format != (depth == eImageBitDepthFloat ? eTileSampleFormatOrderedHalf : eTileSampleFormatByte) ) {
+        return false;
+    }
+    const std::size_t nSamples = (std::size_t)width * height * 4;
+    std::vector<unsigned short> samples(nSamples);
+    BitReader reader(src + VIEWER_TILE_CODEC_HEADER_SIZE, srcSize - VIEWER_TILE_CODEC_HEADER_SIZE);
+    const int param = src[2];
+
+    switch ( (TileCodingEnum)src[0] ) {
+    case eTileCodingPredictive:
+        if ( (param > sampleBits / 2) || !decodePredictive(reader, width, height, sampleBits, param, &samples) ) {
+            return false;
+        }
+        break;
+    default:
+
+        return false;
+    }
+
+    if (format == eTileSampleFormatOrderedHalf) {
+        float* dst = (float*)pixels;
+        for (std::size_t i = 0; i < nSamples; ++i) {
+            dst[i] = halfToFloat( orderedToHalf(samples[i]) );
+        }
+    } else {
+        for (std::size_t i = 0; i < nSamples; ++i) {
+            pixels[i] = (unsigned char)samples[i];
+        }
+    }
+
+    return true;
+} // decode
+
+bool
+isLossless(const unsigned char* src,
+           std::size_t srcSize)
+{
+    return srcSize > VIEWER_TILE_CODEC_HEADER_SIZE && src[0] == eTileCodingPredictive && src[2] == 0 && src[1] == eTileSampleFormatByte;
+}
+} // namespace ViewerTileCodec
+
+NATRON_NAMESPACE_EXIT;
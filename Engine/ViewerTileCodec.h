@@ -0,0 +1,85 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <http://www.natron.fr/>,
+ * Copyright (C) 2016 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+#ifndef NATRON_ENGINE_VIEWERTILECODEC_H
+#define NATRON_ENGINE_VIEWERTILECODEC_H
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "Global/Macros.h"
+
+#include <cstddef>
+
+#include "Global/GlobalDefines.h"
+
+#include "Engine/EngineFwd.h"
+
+NATRON_NAMESPACE_ENTER;
+
+/**
+ * @brief Compression of the RGBA viewer tiles held in the playback cache.
+ *
+ * Each channel is predicted from its left, top and top-left neighbours (median edge detector) and the
+ * residuals are stored with adaptive Golomb-Rice codes. 8-bit tiles are coded as is, 32-bit floating point
+ * tiles are first converted to half-float.
+ * The tile must fit in a fixed budget (the size of a compressed slot in the cache): if the lossless code
+ * is too large, the least significant bits of the samples are progressively dropped (near-lossless), at most half of them.
+ * Tiles that still do not fit (e.g: noise) are not encoded: they cannot be stored compressed without visible loss.
+ **/
+namespace ViewerTileCodec {
+/**
+ * @brief Size in bytes of an uncompressed tile of the given dimensions, made of 4 channels of the given depth.
+ * Only eImageBitDepthByte and eImageBitDepthFloat are supported.
+ **/
+std::size_t getUncompressedSize(int width, int height, ImageBitDepthEnum depth);
+
+/**
+ * @brief Encodes the interleaved 4-channel tile pixels into dst which is dstSize bytes long.
+ * Returns the number of bytes written, or 0 if the tile does not fit in dstSize even near-losslessly.
+ **/
+std::size_t encode(const unsigned char* pixels,
+                   int width,
+                   int height,
+                   ImageBitDepthEnum depth,
+                   unsigned char* dst,
+                   std::size_t dstSize);
+
+/**
+ * @brief Decodes a tile encoded with encode() into pixels, which must hold getUncompressedSize(width, height, depth) bytes.
+ * Returns false if src does not hold a valid tile of these dimensions and depth.
+ **/
+bool decode(const unsigned char* src,
+            std::size_t srcSize,
+            int width,
+            int height,
+            ImageBitDepthEnum depth,
+            unsigned char* pixels);
+
+/**
+ * @brief Returns true if the tile held in src was encoded without any loss.
+ **/
+bool isLossless(const unsigned char* src, std::size_t srcSize);
+} // namespace ViewerTileCodec
+
+NATRON_NAMESPACE_EXIT;
+
+#endif // NATRON_ENGINE_VIEWERTILECODEC_H
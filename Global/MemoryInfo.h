@@ -28,8 +28,11 @@
  *          http://creativecommons.org/licenses/by/3.0/deed.en_US
  */
 #include <vector>
+#include <string>
 #include <iostream>
 #include <cmath>
+#include <cstring> // strncmp, strchr, strstr
+#include <cstdlib> // strtoull, strtod
 #include <algorithm> // min, max
 #include <stdexcept>
 
@@ -108,19 +111,340 @@ getSystemTotalRAM()
 #endif
 }
 
+#if defined(__linux__) || defined(__linux) || defined(linux) || defined(__gnu_linux__)
+
+#define NATRON_CGROUP_MOUNT_POINT "/sys/fs/cgroup"
+
+/**
+ * @brief Finds the memory cgroup of this process in /proc/self/cgroup.
+ * Returns false if the process is not in a memory cgroup, otherwise path is the
+ * path of the cgroup relative to the cgroup mount point, and isV2 tells if it is a
+ * unified (v2) hierarchy or a v1 memory controller hierarchy.
+ **/
+inline bool
+getCGroupMemoryPath(std::string* path,
+                    bool* isV2)
+{
+    FILE* fp = fopen("/proc/self/cgroup", "r");
+
+    if (!fp) {
+        return false;
+    }
+    bool found = false;
+    char line[4096];
+    while ( fgets( line, sizeof(line), fp ) ) {
+        // Lines are "hierarchy-ID:controller-list:cgroup-path"
+        char* controllers = strchr(line, ':');
+        if (!controllers) {
+            continue;
+        }
+        ++controllers;
+        char* cgroupPath = strchr(controllers, ':');
+        if (!cgroupPath) {
+            continue;
+        }
+        *cgroupPath = '\0';
+        ++cgroupPath;
+        cgroupPath[strcspn(cgroupPath, "\n")] = '\0';
+
+        if (*controllers == '\0') {
+            // v2 entry "0::/path". Keep looking for a v1 memory controller, which takes precedence on hybrid systems
+            if (!found) {
+                *path = cgroupPath;
+                *isV2 = true;
+                found = true;
+            }
+        } else {
+            // v1 entry, the controller list is comma separated
+            std::string list = std::string(",") + controllers + ",";
+            if (list.find(",memory,") != std::string::npos) {
+                *path = cgroupPath;
+                *isV2 = false;
+                found = true;
+                break;
+            }
+        }
+    }
+    fclose(fp);
+
+    return found;
+}
+
+/**
+ * @brief The memory cgroup of this process, resolved once: /proc/self/cgroup does not change during
+ * the lifetime of the process and is too expensive to parse on every cache allocation.
+ **/
+struct CGroupMemoryInfo
+{
+    bool valid; // false if the process is not in a memory cgroup or if its files cannot be found
+    bool isV2;
+    std::string directory; // the directory containing the memory.* files of the cgroup
+
+    CGroupMemoryInfo()
+        : valid(false)
+        , isV2(false)
+        , directory()
+    {
+    }
+};
+
+inline CGroupMemoryInfo
+findCGroupMemoryInfo()
+{
+    CGroupMemoryInfo info;
+    std::string cgroupPath;
+
+    if ( !getCGroupMemoryPath(&cgroupPath, &info.isV2) ) {
+        return info;
+    }
+    // The files are either in the cgroup of the process, or at the root of the hierarchy
+    // (which is what a container without cgroup namespace sees)
+    std::string root = info.isV2 ? NATRON_CGROUP_MOUNT_POINT : NATRON_CGROUP_MOUNT_POINT "/memory";
+    const char* usageFile = info.isV2 ? "/memory.current" : "/memory.usage_in_bytes";
+    std::string candidates[2] = { root + cgroupPath, root };
+    for (int i = 0; i < 2; ++i) {
+        FILE* fp = fopen( (candidates[i] + usageFile).c_str(), "r" );
+        if (fp) {
+            fclose(fp);
+            info.directory = candidates[i];
+            info.valid = true;
+            break;
+        }
+    }
+
+    return info;
+}
+
+inline const CGroupMemoryInfo&
+getCGroupMemoryInfo()
+{
+    static const CGroupMemoryInfo info = findCGroupMemoryInfo();
+
+    return info;
+}
+
+/**
+ * @brief Reads a single value from a file of the memory cgroup of the process.
+ * Returns false if the file could not be read or if the value is "max" (no limit).
+ **/
+inline bool
+readCGroupMemoryValue(const char* file,
+                      uint64_t* value)
+{
+    const CGroupMemoryInfo& info = getCGroupMemoryInfo();
+
+    if (!info.valid) {
+        return false;
+    }
+    FILE* fp = fopen( (info.directory + "/" + file).c_str(), "r" );
+    if (!fp) {
+        return false;
+    }
+    char buf[64];
+    bool ok = fgets( buf, sizeof(buf), fp ) != NULL;
+    fclose(fp);
+    if (!ok || !strncmp(buf, "max", 3)) {
+        return false;
+    }
+    char* end = NULL;
+    *value = strtoull(buf, &end, 10);
+
+    return end != buf;
+}
+
+/**
+ * @brief Reads the value of key in the memory.stat file of the memory cgroup of the process.
+ * Returns false if the key was not found.
+ **/
+inline bool
+readCGroupMemoryStat(const char* key,
+                     uint64_t* value)
+{
+    const CGroupMemoryInfo& info = getCGroupMemoryInfo();
+
+    if (!info.valid) {
+        return false;
+    }
+    FILE* fp = fopen( (info.directory + "/memory.stat").c_str(), "r" );
+    if (!fp) {
+        return false;
+    }
+    // Lines are "key value"
+    std::size_t keyLen = strlen(key);
+    bool found = false;
+    char line[256];
+    while ( fgets( line, sizeof(line), fp ) ) {
+        if ( !strncmp(line, key, keyLen) && (line[keyLen] == ' ') ) {
+            *value = strtoull(line + keyLen + 1, NULL, 10);
+            found = true;
+            break;
+        }
+    }
+    fclose(fp);
+
+    return found;
+}
+
+/**
+ * @brief Reads the memory limit of the cgroup of this process, see getCGroupMemoryLimit()
+ **/
+inline uint64_t
+readCGroupMemoryLimit()
+{
+    if ( !getCGroupMemoryInfo().valid ) {
+        return 0;
+    }
+    uint64_t limit = 0;
+    if ( getCGroupMemoryInfo().isV2 ) {
+        uint64_t value;
+        if ( readCGroupMemoryValue("memory.max", &value) ) {
+            limit = value;
+        }
+        if ( readCGroupMemoryValue("memory.high", &value) && ( !limit || (value < limit) ) ) {
+            limit = value;
+        }
+    } else {
+        if ( !readCGroupMemoryValue("memory.limit_in_bytes", &limit) ) {
+            limit = 0;
+        }
+    }
+
+    // v1 reports "no limit" as a huge page-aligned number
+    if ( limit >= getSystemTotalRAM() ) {
+        limit = 0;
+    }
+
+    return limit;
+}
+
+#endif // __linux__
+
+/**
+ * @brief Returns the memory limit imposed on this process by its cgroup (e.g: inside a container),
+ * or 0 if there is no such limit. With cgroup v2 the lowest of memory.max and memory.high is returned,
+ * since the kernel starts throttling and reclaiming at memory.high.
+ * The limit is read once, on the first call.
+ **/
+inline uint64_t
+getCGroupMemoryLimit()
+{
+#if defined(__linux__) || defined(__linux) || defined(linux) || defined(__gnu_linux__)
+    static const uint64_t limit = readCGroupMemoryLimit();
+
+    return limit;
+#else
+
+    return 0;
+#endif
+}
+
+/**
+ * @brief Returns the memory currently charged to the cgroup of this process, or 0 if it cannot be determined.
+ * The inactive file-backed pages are not counted: the kernel reclaims them first when reaching the limit,
+ * so they are not memory the process needs to make room for.
+ **/
+inline uint64_t
+getCGroupMemoryUsage()
+{
+#if defined(__linux__) || defined(__linux) || defined(linux) || defined(__gnu_linux__)
+    bool isV2 = getCGroupMemoryInfo().isV2;
+    uint64_t usage = 0;
+    if ( !readCGroupMemoryValue(isV2 ? "memory.current" : "memory.usage_in_bytes", &usage) ) {
+        return 0;
+    }
+    uint64_t inactiveFile = 0;
+    if ( readCGroupMemoryStat(isV2 ? "inactive_file" : "total_inactive_file", &inactiveFile) ) {
+        usage -= std::min(usage, inactiveFile);
+    }
+
+    return usage;
+#else
+
+    return 0;
+#endif
+}
+
+/**
+ * @brief Reads the Linux pressure stall information (PSI) for memory: the percentage of wall time,
+ * averaged over the last 10 seconds, during which some (resp. all) non-idle tasks were stalled waiting for memory.
+ * The PSI of the cgroup is used if available, otherwise the system-wide one.
+ * Returns false if PSI is not available (non Linux system, kernel older than 4.20 or PSI disabled).
+ **/
+inline bool
+getMemoryPressure(double* someAvg10,
+                  double* fullAvg10)
+{
+#if defined(__linux__) || defined(__linux) || defined(linux) || defined(__gnu_linux__)
+    std::string file = "/proc/pressure/memory";
+    {
+        const CGroupMemoryInfo& info = getCGroupMemoryInfo();
+        if (info.valid && info.isV2) {
+            std::string cgroupFile = info.directory + "/memory.pressure";
+            FILE* fp = fopen(cgroupFile.c_str(), "r");
+            if (fp) {
+                fclose(fp);
+                file = cgroupFile;
+            }
+        }
+    }
+    FILE* fp = fopen(file.c_str(), "r");
+    if (!fp) {
+        return false;
+    }
+    // Lines are "some avg10=0.00 avg60=0.00 avg300=0.00 total=0" and "full avg10=..."
+    bool gotSome = false;
+    *someAvg10 = 0.;
+    if (fullAvg10) {
+        *fullAvg10 = 0.;
+    }
+    char line[256];
+    while ( fgets( line, sizeof(line), fp ) ) {
+        const char* avg10 = strstr(line, "avg10=");
+        if (!avg10) {
+            continue;
+        }
+        double value = strtod(avg10 + 6, NULL);
+        if ( !strncmp(line, "some", 4) ) {
+            *someAvg10 = value;
+            gotSome = true;
+        } else if ( fullAvg10 && !strncmp(line, "full", 4) ) {
+            *fullAvg10 = value;
+        }
+    }
+    fclose(fp);
+
+    return gotSome;
+#else
+    Q_UNUSED(someAvg10);
+    Q_UNUSED(fullAvg10);
+
+    return false;
+#endif
+}
+
 inline bool
 isApplication32Bits()
 {
     return sizeof(void*) == 4;
 }
 
+/**
+ * @brief Returns the amount of RAM the application may use: the total system RAM, capped by the cgroup
+ * memory limit if any (e.g: in a container) and by the address space of 32-bit builds.
+ **/
 inline uint64_t
 getSystemTotalRAM_conditionnally()
 {
+    uint64_t totalRAM = getSystemTotalRAM();
+    uint64_t cgroupLimit = getCGroupMemoryLimit();
+
+    if (cgroupLimit) {
+        totalRAM = std::min(totalRAM, cgroupLimit);
+    }
     if ( isApplication32Bits() ) {
-        return std::min( (uint64_t)0x100000000ULL, getSystemTotalRAM() );
+        return std::min( (uint64_t)0x100000000ULL, totalRAM );
     } else {
-        return getSystemTotalRAM();
+        return totalRAM;
     }
 }
 
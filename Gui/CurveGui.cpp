@@ -25,7 +25,8 @@
 #include "CurveGui.h"
 
 #include <cmath>
-#include <algorithm> // min, max
+#include <algorithm> // min, max, lower_bound, upper_bound
+#include <map>
 #include <stdexcept>
 
 #include <QtCore/QThread>
@@ -70,16 +71,13 @@ CurveGui::~CurveGui()
 
 void
 CurveGui::nextPointForSegment(const double x1,
-                              const KeyFrameSet & keys,
-                              const std::list<double>& keysWidgetCoords,
+                              const std::vector<KeyFrame>& keys,
+                              const std::vector<double>& keysWidgetCoords,
                               const Curve::YRange& curveYRange,
                               const double xminCurveWidgetCoord,
                               const double xmaxCurveWidgetCoord,
-                              KeyFrameSet::const_iterator* lastUpperIt,
-                              std::list<double>::const_iterator* lastUpperItCoords,
                               double* x2,
-                              KeyFrame* x1Key,
-                              bool* isx1Key)
+                              int* x2KeyIndex)
 {
     // always running in the main thread
     assert( qApp && qApp->thread() == QThread::currentThread() );
@@ -98,7 +96,7 @@ CurveGui::nextPointForSegment(const double x1,
             } else {
                 ///find out the equation of the straight line going from the first keyframe and intersecting
                 ///the min axis, so we can get the coordinates of the point intersecting the min axis.
-                KeyFrameSet::const_iterator firstKf = keys.begin();
+                std::vector<KeyFrame>::const_iterator firstKf = keys.begin();
 
                 if (firstKf->getLeftDerivative() == 0) {
                     *x2 = xminCurveWidgetCoord;
@@ -129,7 +127,7 @@ CurveGui::nextPointForSegment(const double x1,
             } else {
                 ///find out the equation of the straight line going from the last keyframe and intersecting
                 ///the min axis, so we can get the coordinates of the point intersecting the min axis.
-                KeyFrameSet::const_reverse_iterator lastKf = keys.rbegin();
+                std::vector<KeyFrame>::const_reverse_iterator lastKf = keys.rbegin();
 
                 if (lastKf->getRightDerivative() == 0) {
                     *x2 = _curveWidget->width() - 1;
@@ -151,37 +149,18 @@ CurveGui::nextPointForSegment(const double x1,
     } else {
         //we're between 2 keyframes,get the upper and lower
         assert( keys.size() == keysWidgetCoords.size() );
-        KeyFrameSet::const_iterator upper = keys.end();
-        KeyFrameSet::const_iterator itKeys = keys.begin();
-        double upperWidgetCoord = x1;
-        std::list<double>::const_iterator it;
-        if ( *lastUpperItCoords != keysWidgetCoords.end() ) {
-            assert( *lastUpperIt != keys.end() );
-            itKeys = *lastUpperIt;
-            it = *lastUpperItCoords;
-        } else {
-            itKeys = keys.begin();
-            it = keysWidgetCoords.begin();
-        }
-        for (; it != keysWidgetCoords.end(); ++it, ++itKeys) {
-            if (*it > x1) {
-                upperWidgetCoord = *it;
-                upper = itKeys;
-                *lastUpperItCoords = it;
-                *lastUpperIt = upper;
-                break;
-            }
-        }
-        assert( upper != keys.end() && upper != keys.begin() );
-        if ( ( upper == keys.end() ) || ( upper == keys.begin() ) ) {
-            *lastUpperItCoords = keysWidgetCoords.end();
-            *lastUpperIt = keys.end();
-            *isx1Key = false;
+        std::vector<double>::const_iterator upperCoord = std::upper_bound(keysWidgetCoords.begin(), keysWidgetCoords.end(), x1);
+        assert( upperCoord != keysWidgetCoords.end() && upperCoord != keysWidgetCoords.begin() );
+        if ( ( upperCoord == keysWidgetCoords.end() ) || ( upperCoord == keysWidgetCoords.begin() ) ) {
+            *x2 = x1 + 1.;
+            *x2KeyIndex = -1;
 
             return;
         }
-        KeyFrameSet::const_iterator lower = upper;
-        --lower;
+        const double upperWidgetCoord = *upperCoord;
+        const int upperIndex = (int)( upperCoord - keysWidgetCoords.begin() );
+        std::vector<KeyFrame>::const_iterator upper = keys.begin() + upperIndex;
+        std::vector<KeyFrame>::const_iterator lower = upper - 1;
 
         double t = ( x1 - lower->getTime() ) / ( upper->getTime() - lower->getTime() );
         double P3 = upper->getValue();
@@ -199,15 +178,14 @@ CurveGui::nextPointForSegment(const double x1,
 
         if (upperWidgetCoord < x1 + delta_x) {
             *x2 = upperWidgetCoord;
-            *x1Key = *upper;
-            *isx1Key = true;
+            *x2KeyIndex = upperIndex;
 
             return;
         } else {
             *x2 = x1 + delta_x;
         }
     }
-    *isx1Key = false;
+    *x2KeyIndex = -1;
 } // nextPointForSegment
 
 Curve::YRange
@@ -262,6 +240,94 @@ drawLineStrip(const std::vector<float>& vertices,
     GL_GPU::glEnd();
 }
 
+void
+CurveGui::computeCurveVertices(const std::vector<KeyFrame>& keyframes,
+                               std::vector<float>* vertices)
+{
+    vertices->clear();
+    if ( keyframes.empty() ) {
+        return;
+    }
+
+    const double widgetWidth = _curveWidget->width();
+    try {
+        std::vector<double> keysWidgetCoords( keyframes.size() );
+        for (std::size_t i = 0; i < keyframes.size(); ++i) {
+            keysWidgetCoords[i] = _curveWidget->toWidgetCoordinates(keyframes[i].getTime(), 0).x();
+        }
+        const double xminCurveWidgetCoord = keysWidgetCoords.front();
+        const double xmaxCurveWidgetCoord = keysWidgetCoords.back();
+        Curve::YRange curveYRange = getCurveYRange();
+        double x1 = 0;
+        double x2;
+        int x1KeyIndex = -1;
+
+        while ( x1 < (widgetWidth - 1) ) {
+            if (x1KeyIndex < 0) {
+                double x = _curveWidget->toZoomCoordinates(x1, 0).x();
+                double y = evaluate(false, x);
+                vertices->push_back( (float)x );
+                vertices->push_back( (float)y );
+            } else {
+                const KeyFrame& key = keyframes[x1KeyIndex];
+                vertices->push_back( (float)key.getTime() );
+                vertices->push_back( (float)key.getValue() );
+
+                // Baked curves may have many keyframes in a single pixel column: the strip only needs to go
+                // through their extrema, in time order, and end on the last one of the column.
+                const double columnEnd = std::floor(keysWidgetCoords[x1KeyIndex]) + 1.;
+                int last = x1KeyIndex;
+                int minIndex = x1KeyIndex;
+                int maxIndex = x1KeyIndex;
+                while ( ( last + 1 < (int)keyframes.size() ) && (keysWidgetCoords[last + 1] < columnEnd) ) {
+                    ++last;
+                    if ( keyframes[last].getValue() < keyframes[minIndex].getValue() ) {
+                        minIndex = last;
+                    } else if ( keyframes[last].getValue() > keyframes[maxIndex].getValue() ) {
+                        maxIndex = last;
+                    }
+                }
+                if (last > x1KeyIndex) {
+                    const int extrema[2] = { std::min(minIndex, maxIndex), std::max(minIndex, maxIndex) };
+                    for (int i = 0; i < 2; ++i) {
+                        if ( (extrema[i] != x1KeyIndex) && (extrema[i] != last) && ( (i == 0) || (extrema[1] != extrema[0]) ) ) {
+                            vertices->push_back( (float)keyframes[extrema[i]].getTime() );
+                            vertices->push_back( (float)keyframes[extrema[i]].getValue() );
+                        }
+                    }
+                    // The next iteration adds the last keyframe of the column
+                    x1KeyIndex = last;
+                    x1 = keysWidgetCoords[last];
+                    continue;
+                }
+            }
+            nextPointForSegment(x1, keyframes, keysWidgetCoords, curveYRange, xminCurveWidgetCoord, xmaxCurveWidgetCoord, &x2, &x1KeyIndex);
+            x1 = x2;
+        }
+        //also add the last point
+        {
+            double x = _curveWidget->toZoomCoordinates(x1, 0).x();
+            double y = evaluate(false, x);
+            vertices->push_back( (float)x );
+            vertices->push_back( (float)y );
+        }
+    } catch (...) {
+    }
+} // computeCurveVertices
+
+NATRON_NAMESPACE_ANONYMOUS_ENTER
+
+struct KeyFrameTimeLess
+{
+    bool operator()(const KeyFrame& key,
+                    double time) const
+    {
+        return key.getTime() < time;
+    }
+};
+
+NATRON_NAMESPACE_ANONYMOUS_EXIT
+
 void
 CurveGui::drawCurve(int curveIndex,
                     int curvesCount)
@@ -275,11 +341,8 @@ CurveGui::drawCurve(int curveIndex,
 
     assert( QGLContext::currentContext() == _curveWidget->context() );
 
-    std::vector<float> vertices, exprVertices;
-    double x1 = 0;
-    double x2;
+    std::vector<float> exprVertices;
     const double widgetWidth = _curveWidget->width();
-    KeyFrameSet keyframes;
     BezierCPCurveGui* isBezierGui = dynamic_cast<BezierCPCurveGui*>(this);
     KnobCurveGui* isKnobCurve = dynamic_cast<KnobCurveGui*>(this);
     bool hasDrawnExpr = false;
@@ -290,7 +353,7 @@ CurveGui::drawCurve(int curveIndex,
         expr = knob->getExpression( isKnobCurve->getDimension() );
         if ( !expr.empty() ) {
             //we have no choice but to evaluate the expression at each time
-            for (int i = x1; i < widgetWidth; ++i) {
+            for (int i = 0; i < widgetWidth; ++i) {
                 double x = _curveWidget->toZoomCoordinates(i, 0).x();;
                 double y = knob->getValueAtWithExpression( x, ViewIdx(0), isKnobCurve->getDimension() );
                 exprVertices.push_back(x);
@@ -300,59 +363,36 @@ CurveGui::drawCurve(int curveIndex,
         }
     }
 
+    QPointF btmLeft = _curveWidget->toZoomCoordinates(0, _curveWidget->height() - 1);
+    QPointF topRight = _curveWidget->toZoomCoordinates(_curveWidget->width() - 1, 0);
+
+    // Only read the keyframes and evaluate the curve again if the curve changed since the last draw,
+    // or if the view moved. Bezier keyframes have no change count, they are always read again.
     if (isBezierGui) {
-        std::set<double> keys;
-        isBezierGui->getBezier()->getKeyframeTimes(&keys);
-        int i = 0;
-        for (std::set<double>::iterator it = keys.begin(); it != keys.end(); ++it, ++i) {
-            keyframes.insert( KeyFrame(*it, i) );
-        }
+        KeyFrameSet keys = getKeyFrames();
+        _drawCache.keyframes.assign( keys.begin(), keys.end() );
+        _drawCache.curve = 0;
+        _drawCache.verticesValid = false;
     } else {
-        keyframes = getInternalCurve()->getKeyFrames_mt_safe();
-    }
-    if ( !keyframes.empty() ) {
-        try {
-            double xminCurveWidgetCoord = _curveWidget->toWidgetCoordinates(keyframes.begin()->getTime(), 0).x();
-            double xmaxCurveWidgetCoord = _curveWidget->toWidgetCoordinates(keyframes.rbegin()->getTime(), 0).x();
-            std::list<double> keysWidgetCoords;
-            for (KeyFrameSet::const_iterator it = keyframes.begin(); it != keyframes.end(); ++it) {
-                double widgetCoord = _curveWidget->toWidgetCoordinates(it->getTime(), 0).x();
-                keysWidgetCoords.push_back(widgetCoord);
-            }
-
-            Curve::YRange curveYRange = getCurveYRange();
-            bool isX1AKey = false;
-            KeyFrame x1Key;
-            std::list<double>::const_iterator lastUpperItCoords = keysWidgetCoords.end();
-            KeyFrameSet::const_iterator lastUpperIt = keyframes.end();
-
-            while ( x1 < (widgetWidth - 1) ) {
-                double x, y;
-                if (!isX1AKey) {
-                    x = _curveWidget->toZoomCoordinates(x1, 0).x();
-                    y = evaluate(false, x);
-                } else {
-                    x = x1Key.getTime();
-                    y = x1Key.getValue();
-                }
-                vertices.push_back( (float)x );
-                vertices.push_back( (float)y );
-                nextPointForSegment(x1, keyframes, keysWidgetCoords, curveYRange, xminCurveWidgetCoord, xmaxCurveWidgetCoord, &lastUpperIt, &lastUpperItCoords, &x2, &x1Key, &isX1AKey);
-                x1 = x2;
-            }
-            //also add the last point
-            {
-                double x = _curveWidget->toZoomCoordinates(x1, 0).x();
-                double y = evaluate(false, x);
-                vertices.push_back( (float)x );
-                vertices.push_back( (float)y );
-            }
-        } catch (...) {
+        CurvePtr curve = getInternalCurve();
+        if ( ( curve.get() != _drawCache.curve ) || ( curve->getChangeCount() != _drawCache.changeCount ) ) {
+            curve->getKeyFramesArray_mt_safe(&_drawCache.keyframes, &_drawCache.changeCount);
+            _drawCache.curve = curve.get();
+            _drawCache.verticesValid = false;
         }
     }
+    if ( !_drawCache.verticesValid || (_drawCache.btmLeft != btmLeft) || (_drawCache.topRight != topRight) ||
+         ( _drawCache.widgetWidth != _curveWidget->width() ) || ( _drawCache.widgetHeight != _curveWidget->height() ) ) {
+        computeCurveVertices(_drawCache.keyframes, &_drawCache.vertices);
+        _drawCache.verticesValid = !isBezierGui;
+        _drawCache.btmLeft = btmLeft;
+        _drawCache.topRight = topRight;
+        _drawCache.widgetWidth = _curveWidget->width();
+        _drawCache.widgetHeight = _curveWidget->height();
+    }
 
-    QPointF btmLeft = _curveWidget->toZoomCoordinates(0, _curveWidget->height() - 1);
-    QPointF topRight = _curveWidget->toZoomCoordinates(_curveWidget->width() - 1, 0);
+    const std::vector<KeyFrame>& keyframes = _drawCache.keyframes;
+    const std::vector<float>& vertices = _drawCache.vertices;
     const QColor & curveColor = _selected ?  _curveWidget->getSelectedCurveColor() : _color;
 
     {
@@ -435,36 +475,72 @@ CurveGui::drawCurve(int curveIndex,
         }
 
         //bool isCurveSelected = foundCurveSelected != selectedKeyFrames.end();
+        std::map<double, KeyPtr> selectedKeysByTime;
+        if ( foundCurveSelected != selectedKeyFrames.end() ) {
+            for (std::list<KeyPtr>::const_iterator it2 = foundCurveSelected->second.begin();
+                 it2 != foundCurveSelected->second.end(); ++it2) {
+                if ( (*it2)->curve.get() == this ) {
+                    selectedKeysByTime.insert( std::make_pair( (*it2)->key.getTime(), *it2 ) );
+                }
+            }
+        }
 
-        for (KeyFrameSet::const_iterator k = keyframes.begin(); k != keyframes.end(); ++k) {
+        // Gather the visible keyframes so that they are drawn in one call per color. Unselected keyframes
+        // falling on the same pixel as the previous one are skipped since they would not be seen.
+        std::vector<float> keysVertices, selectedKeysVertices;
+        std::vector<std::pair<KeyFrame, KeyPtr> > selectedKeysToDraw;
+        std::vector<KeyFrame>::const_iterator firstVisible = std::lower_bound( keyframes.begin(), keyframes.end(), btmLeft.x(), KeyFrameTimeLess() );
+        QPointF lastKeyPixel(-1, -1);
+        for (std::vector<KeyFrame>::const_iterator k = firstVisible; k != keyframes.end(); ++k) {
             const KeyFrame & key = (*k);
 
-            if ( ( key.getTime() < btmLeft.x() ) || ( key.getTime() > topRight.x() ) || ( key.getValue() < btmLeft.y() ) || ( key.getValue() > topRight.y() ) ) {
+            if ( key.getTime() > topRight.x() ) {
+                break;
+            }
+            if ( ( key.getValue() < btmLeft.y() ) || ( key.getValue() > topRight.y() ) ) {
                 continue;
             }
 
-            GL_GPU::glColor4f( _color.redF(), _color.greenF(), _color.blueF(), _color.alphaF() );
-
             //if the key is selected change its color to white
-            KeyPtr isSelected;
-            if ( foundCurveSelected != selectedKeyFrames.end() ) {
-                for (std::list<KeyPtr>::const_iterator it2 = foundCurveSelected->second.begin();
-                     it2 != foundCurveSelected->second.end(); ++it2) {
-                    if ( ( (*it2)->key.getTime() == key.getTime() ) && ( (*it2)->curve.get() == this ) ) {
-                        isSelected = *it2;
-                        GL_GPU::glColor4f(1.f, 1.f, 1.f, 1.f);
-                        break;
-                    }
-                }
+            std::map<double, KeyPtr>::const_iterator isSelected = selectedKeysByTime.find( key.getTime() );
+            if ( isSelected != selectedKeysByTime.end() ) {
+                selectedKeysVertices.push_back( (float)key.getTime() );
+                selectedKeysVertices.push_back( (float)key.getValue() );
+                selectedKeysToDraw.push_back( std::make_pair(key, isSelected->second) );
+                continue;
             }
 
+            QPointF keyPixel = _curveWidget->toWidgetCoordinates( key.getTime(), key.getValue() );
+            keyPixel.setX( std::floor( keyPixel.x() ) );
+            keyPixel.setY( std::floor( keyPixel.y() ) );
+            if (keyPixel == lastKeyPixel) {
+                continue;
+            }
+            lastKeyPixel = keyPixel;
+            keysVertices.push_back( (float)key.getTime() );
+            keysVertices.push_back( (float)key.getValue() );
+        }
+
+        GL_GPU::glEnableClientState(GL_VERTEX_ARRAY);
+        if ( !keysVertices.empty() ) {
+            GL_GPU::glColor4f( _color.redF(), _color.greenF(), _color.blueF(), _color.alphaF() );
+            GL_GPU::glVertexPointer(2, GL_FLOAT, 0, &keysVertices.front());
+            GL_GPU::glDrawArrays(GL_POINTS, 0, (GLsizei)keysVertices.size() / 2);
+        }
+        if ( !selectedKeysVertices.empty() ) {
+            GL_GPU::glColor4f(1.f, 1.f, 1.f, 1.f);
+            GL_GPU::glVertexPointer(2, GL_FLOAT, 0, &selectedKeysVertices.front());
+            GL_GPU::glDrawArrays(GL_POINTS, 0, (GLsizei)selectedKeysVertices.size() / 2);
+        }
+        GL_GPU::glDisableClientState(GL_VERTEX_ARRAY);
+
+        for (std::vector<std::pair<KeyFrame, KeyPtr> >::const_iterator k = selectedKeysToDraw.begin(); k != selectedKeysToDraw.end(); ++k) {
+            const KeyFrame & key = k->first;
+            const KeyPtr & isSelected = k->second;
             double x = key.getTime();
             double y = key.getValue();
-            GL_GPU::glBegin(GL_POINTS);
-            GL_GPU::glVertex2f(x, y);
-            GL_GPU::glEnd();
 
-            if ( !isBezierGui && isSelected && (key.getInterpolation() != eKeyframeTypeConstant) ) {
+            if ( !isBezierGui && (key.getInterpolation() != eKeyframeTypeConstant) ) {
                 QFontMetrics m( _curveWidget->getFont() );
 
 
@@ -518,9 +594,9 @@ CurveGui::drawCurve(int curveIndex,
                 GL_GPU::glVertex2f( isSelected->leftTan.first, isSelected->leftTan.second );
                 GL_GPU::glVertex2f( isSelected->rightTan.first, isSelected->rightTan.second );
                 GL_GPU::glEnd();
-            } // if ( !isBezierGui && ( isSelected != selectedKeyFrames.end() ) && (key.getInterpolation() != eKeyframeTypeConstant) ) {
+            } // if ( !isBezierGui && (key.getInterpolation() != eKeyframeTypeConstant) ) {
 
-        } // for (KeyFrameSet::const_iterator k = keyframes.begin(); k != keyframes.end(); ++k) {
+        } // for (std::vector<std::pair<KeyFrame, KeyPtr> >::const_iterator k = selectedKeysToDraw.begin(); k != selectedKeysToDraw.end(); ++k) {
     } // GLProtectAttrib(GL_HINT_BIT | GL_ENABLE_BIT | GL_LINE_BIT | GL_COLOR_BUFFER_BIT | GL_POINT_BIT | GL_CURRENT_BIT);
 
     glCheckError(GL_GPU);
@@ -27,6 +27,8 @@
 
 #include "Global/Macros.h"
 
+#include <vector>
+
 #if !defined(Q_MOC_RUN) && !defined(SBK_RUN)
 #include <boost/shared_ptr.hpp>
 #endif
@@ -34,6 +36,7 @@
 CLANG_DIAG_OFF(deprecated)
 CLANG_DIAG_OFF(uninitialized)
 #include <QtCore/QObject> // QObject
+#include <QtCore/QPointF>
 #include <QtGui/QColor> // QColor
 CLANG_DIAG_ON(deprecated)
 CLANG_DIAG_ON(uninitialized)
@@ -132,16 +135,19 @@ public:
 private:
 
     void nextPointForSegment(const double x1,
-                             const KeyFrameSet & keyframes,
-                             const std::list<double>& keysWidgetCoords,
+                             const std::vector<KeyFrame>& keyframes,
+                             const std::vector<double>& keysWidgetCoords,
                              const Curve::YRange& curveYRange,
                              const double xminCurveWidgetCoord,
                              const double xmaxCurveWidgetCoord,
-                             KeyFrameSet::const_iterator* lastUpperIt,
-                             std::list<double>::const_iterator* lastUpperItCoords,
                              double* x2,
-                             KeyFrame* key,
-                             bool* isKey );
+                             int* x2KeyIndex);
+
+    /**
+     * @brief Fills vertices with the line strip of the curve across the widget. Keyframes falling in the
+     * same pixel column are decimated to the first, the last and the extrema of the column.
+     **/
+    void computeCurveVertices(const std::vector<KeyFrame>& keyframes, std::vector<float>* vertices);
 
 protected:
 
@@ -155,6 +161,33 @@ private:
     int _thickness; /// its thickness
     bool _visible; /// should we draw this curve ?
     bool _selected; /// is this curve selected
+
+    /// The keyframes and line strip of the curve, kept across redraws until the curve or the view changes
+    struct DrawCache
+    {
+        const Curve* curve; /// the curve the keyframes were read from
+        U64 changeCount; /// Curve::getChangeCount() when the keyframes were read
+        std::vector<KeyFrame> keyframes;
+        bool verticesValid;
+        QPointF btmLeft, topRight; /// the view the vertices were computed for
+        int widgetWidth, widgetHeight;
+        std::vector<float> vertices;
+
+        DrawCache()
+            : curve(0)
+            , changeCount(0)
+            , keyframes()
+            , verticesValid(false)
+            , btmLeft()
+            , topRight()
+            , widgetWidth(0)
+            , widgetHeight(0)
+            , vertices()
+        {
+        }
+    };
+
+    DrawCache _drawCache;
 };
 
 typedef std::list<CurveGuiPtr > Curves;
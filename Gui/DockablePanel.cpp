@@ -42,6 +42,8 @@ GCC_DIAG_UNUSED_PRIVATE_FIELD_ON
 
 #include <ofxNatron.h>
 
+#include "Global/MemoryInfo.h"
+
 #include "Engine/Image.h" // Image::clamp
 #include "Engine/KnobTypes.h" // KnobButton
 #include "Engine/GroupOutput.h"
@@ -811,8 +813,16 @@ DockablePanel::refreshUndoRedoButtonsEnabledNess(bool canUndo,
                                                  bool canRedo)
 {
     if (_imp->_undoButton && _imp->_redoButton) {
+        // The commands forgotten to enforce the memory cap cannot be undone
+        canUndo = canUndo && getUndoStack()->index() > getNumForgottenUndoCommands();
         _imp->_undoButton->setEnabled(canUndo);
         _imp->_redoButton->setEnabled(canRedo);
+
+        QString tt = tr("Undo the last change made to this operator.");
+        if (canUndo || canRedo) {
+            tt += QLatin1Char('\n') + tr("Undo/redo history: %1").arg( printAsRAM( (U64)getUndoStackMemoryCost() ) );
+        }
+        _imp->_undoButton->setToolTip( NATRON_NAMESPACE::convertFromPlainText(tt, NATRON_NAMESPACE::WhiteSpaceNormal) );
     }
 }
 
@@ -821,11 +831,11 @@ DockablePanel::onUndoClicked()
 {
     boost::shared_ptr<QUndoStack> stack = getUndoStack();
 
-    stack->undo();
-    if (_imp->_undoButton && _imp->_redoButton) {
-        _imp->_undoButton->setEnabled( stack->canUndo() );
-        _imp->_redoButton->setEnabled( stack->canRedo() );
+    if ( stack->index() <= getNumForgottenUndoCommands() ) {
+        return;
     }
+    stack->undo();
+    refreshUndoRedoButtonsEnabledNess( stack->canUndo(), stack->canRedo() );
     Q_EMIT undoneChange();
 }
 
@@ -835,10 +845,7 @@ DockablePanel::onRedoPressed()
     boost::shared_ptr<QUndoStack> stack = getUndoStack();
 
     stack->redo();
-    if (_imp->_undoButton && _imp->_redoButton) {
-        _imp->_undoButton->setEnabled( stack->canUndo() );
-        _imp->_redoButton->setEnabled( stack->canRedo() );
-    }
+    refreshUndoRedoButtonsEnabledNess( stack->canUndo(), stack->canRedo() );
     Q_EMIT redoneChange();
 }
 
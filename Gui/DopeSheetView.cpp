@@ -24,8 +24,12 @@
 
 #include "DopeSheetView.h"
 
-#include <algorithm> // min, max
+#include <algorithm> // min, max, lower_bound
+#include <climits>
+#include <cmath>
 #include <limits>
+#include <map>
+#include <vector>
 #include <stdexcept>
 
 // Qt includes
@@ -119,6 +123,15 @@ running_in_main_thread_and_context(const QGLWidget *glWidget)
     running_in_main_context(glWidget);
 }
 
+struct KeyFrameTimeLess
+{
+    bool operator()(const KeyFrame& key,
+                    double time) const
+    {
+        return key.getTime() < time;
+    }
+};
+
 NATRON_NAMESPACE_ANONYMOUS_EXIT
 
 
@@ -217,11 +230,23 @@ public:
     void drawRange(const DSNodePtr &dsNode) const;
     void drawKeyframes(const DSNodePtr &dsNode) const;
 
-    void drawTexturedKeyframe(DopeSheetViewPrivate::KeyframeTexture textureType,
-                              bool drawTime,
-                              double time,
-                              const QColor& textColor,
-                              const RectD &rect) const;
+    /**
+     * @brief Returns the keyframes of the curve as a contiguous array, read again only when the curve changed.
+     **/
+    const std::vector<KeyFrame>& getCurveKeyFrames(const CurvePtr& curve) const;
+
+    /**
+     * @brief Adds a keyframe to the batch of its texture, drawn by drawQueuedKeyframes()
+     **/
+    void queueTexturedKeyframe(DopeSheetViewPrivate::KeyframeTexture textureType,
+                               bool drawTime,
+                               double time,
+                               const RectD &rect) const;
+
+    /**
+     * @brief Draws the keyframes queued by queueTexturedKeyframe(), with one draw call per texture
+     **/
+    void drawQueuedKeyframes(const QColor& textColor) const;
 
     void drawGroupOverlay(const DSNodePtr &dsNode, const DSNodePtr &group) const;
 
@@ -284,6 +309,26 @@ public:
     // for textures
     GLuint kfTexturesIDs[KF_TEXTURES_COUNT];
 
+    // for drawing keyframes
+    struct CurveKeyFrames
+    {
+        CurveWPtr curve;
+        U64 changeCount;
+        std::vector<KeyFrame> keyframes;
+
+        CurveKeyFrames()
+            : curve()
+            , changeCount(0)
+            , keyframes()
+        {
+        }
+    };
+
+    mutable std::map<const Curve*, CurveKeyFrames> curvesKeyFrames;
+    // interleaved texture and vertex coordinates of the keyframe quads, per texture
+    mutable std::vector<float> keyframesBatches[KF_TEXTURES_COUNT];
+    mutable std::vector<std::pair<double, RectD> > keyframesTimes;
+
     // for navigating
     ZoomContext zoomContext;
     bool zoomOrPannedSinceLastFit;
@@ -325,6 +370,9 @@ DopeSheetViewPrivate::DopeSheetViewPrivate(DopeSheetView *qq)
     , font( new QFont(appFont, appFontSize) )
     , textRenderer()
     , kfTexturesIDs()
+    , curvesKeyFrames()
+    , keyframesBatches()
+    , keyframesTimes()
     , zoomContext()
     , zoomOrPannedSinceLastFit(false)
     , selectionRect()
@@ -1032,6 +1080,15 @@ DopeSheetViewPrivate::drawRows() const
             }
         }
 
+        {
+            SettingsPtr settings = appPTR->getCurrentSettings();
+            double selectionColorRGB[3];
+            settings->getSelectionColor(&selectionColorRGB[0], &selectionColorRGB[1], &selectionColorRGB[2]);
+            QColor selectionColor;
+            selectionColor.setRgbF(selectionColorRGB[0], selectionColorRGB[1], selectionColorRGB[2]);
+            drawQueuedKeyframes(selectionColor);
+        }
+
         // Draw node rows separations
         for (DSTreeItemNodeMap::const_iterator it = treeItemsAndDSNodes.begin();
              it != treeItemsAndDSNodes.end();
@@ -1247,200 +1304,211 @@ DopeSheetViewPrivate::drawRange(const DSNodePtr &dsNode) const
 /**
  * @brief DopeSheetViewPrivate::drawKeyframes
  *
- *
+ * The keyframes are not drawn here but queued, see queueTexturedKeyframe().
+ * Keyframes of a row which would be drawn on the same pixel column with the same texture are only queued once.
  */
 void
 DopeSheetViewPrivate::drawKeyframes(const DSNodePtr &dsNode) const
 {
     running_in_main_thread_and_context(q_ptr);
 
-    SettingsPtr settings = appPTR->getCurrentSettings();
-    double selectionColorRGB[3];
-    settings->getSelectionColor(&selectionColorRGB[0], &selectionColorRGB[1], &selectionColorRGB[2]);
-    QColor selectionColor;
-    selectionColor.setRgbF(selectionColorRGB[0], selectionColorRGB[1], selectionColorRGB[2]);
+    const DSTreeItemKnobMap& knobItems = dsNode->getItemKnobMap();
+    double kfTimeSelected;
+    int hasSingleKfTimeSelected = model->getSelectionModel()->hasSingleKeyFrameTimeSelected(&kfTimeSelected);
+    // Master keyframes, by pixel column: the time of the first keyframe of the column and whether any is selected
+    std::map<int, std::pair<double, bool> > nodeKeytimes;
+    std::map<DSKnob *, std::map<int, std::pair<double, bool> > > knobsKeytimes;
 
-    // Perform drawing
-    {
-        GLProtectAttrib<GL_GPU> a(GL_CURRENT_BIT | GL_COLOR_BUFFER_BIT | GL_ENABLE_BIT);
-
-        GL_GPU::glEnable(GL_BLEND);
-        GL_GPU::glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-
-        const DSTreeItemKnobMap& knobItems = dsNode->getItemKnobMap();
-        double kfTimeSelected;
-        int hasSingleKfTimeSelected = model->getSelectionModel()->hasSingleKeyFrameTimeSelected(&kfTimeSelected);
-        std::map<double, bool> nodeKeytimes;
-        std::map<DSKnob *, std::map<double, bool> > knobsKeytimes;
-
-        for (DSTreeItemKnobMap::const_iterator it = knobItems.begin();
-             it != knobItems.end();
-             ++it) {
-            DSKnobPtr dsKnob = (*it).second;
-            QTreeWidgetItem *knobTreeItem = dsKnob->getTreeItem();
-
-            // The knob is no longer animated
-            if ( knobTreeItem->isHidden() ) {
-                continue;
-            }
-
-            int dim = dsKnob->getDimension();
-
-            if (dim == -1) {
-                continue;
-            }
+    for (DSTreeItemKnobMap::const_iterator it = knobItems.begin();
+         it != knobItems.end();
+         ++it) {
+        DSKnobPtr dsKnob = (*it).second;
+        QTreeWidgetItem *knobTreeItem = dsKnob->getTreeItem();
 
-            KeyFrameSet keyframes = dsKnob->getKnobGui()->getCurve(ViewIdx(0), dim)->getKeyFrames_mt_safe();
+        // The knob is no longer animated
+        if ( knobTreeItem->isHidden() ) {
+            continue;
+        }
 
-            for (KeyFrameSet::const_iterator kIt = keyframes.begin();
-                 kIt != keyframes.end();
-                 ++kIt) {
-                KeyFrame kf = (*kIt);
-                double keyTime = kf.getTime();
+        int dim = dsKnob->getDimension();
 
-                // Clip keyframes horizontally //TODO Clip vertically too
-                if ( ( keyTime < zoomContext.left() ) || ( keyTime > zoomContext.right() ) ) {
-                    continue;
-                }
+        if (dim == -1) {
+            continue;
+        }
 
-                double rowCenterYWidget = hierarchyView->visualItemRect( dsKnob->getTreeItem() ).center().y();
+        const std::vector<KeyFrame>& keyframes = getCurveKeyFrames( dsKnob->getKnobGui()->getCurve(ViewIdx(0), dim) );
+        const double rowCenterYWidget = hierarchyView->visualItemRect(knobTreeItem).center().y();
+        // Draw keyframe in the knob dim row only if it's visible
+        const bool drawInDimRow = hierarchyView->itemIsVisibleFromOutside(knobTreeItem);
+        DSKnobPtr rootDSKnob = model->mapNameItemToDSKnob( knobTreeItem->parent() );
+        std::map<int, std::pair<double, bool> >* knobTimes = rootDSKnob ? &knobsKeytimes[rootDSKnob.get()] : 0;
+        int lastColumn = INT_MIN;
+        DopeSheetViewPrivate::KeyframeTexture lastTexType = DopeSheetViewPrivate::kfTextureNone;
+
+        // Clip keyframes horizontally //TODO Clip vertically too
+        std::vector<KeyFrame>::const_iterator kIt = std::lower_bound( keyframes.begin(), keyframes.end(), zoomContext.left(), KeyFrameTimeLess() );
+        for (; kIt != keyframes.end() && kIt->getTime() <= zoomContext.right(); ++kIt) {
+            const KeyFrame& kf = (*kIt);
+            double keyTime = kf.getTime();
+            const int column = (int)std::floor( zoomContext.toWidgetCoordinates(keyTime, 0).x() );
+            bool kfSelected = model->getSelectionModel()->keyframeIsSelected(dsKnob, kf);
+
+            if (drawInDimRow) {
                 RectD zoomKfRect = getKeyFrameBoundingRectZoomCoords(keyTime, rowCenterYWidget);
-                bool kfSelected = model->getSelectionModel()->keyframeIsSelected(dsKnob, kf);
-
-                // Draw keyframe in the knob dim row only if it's visible
-                bool drawInDimRow = hierarchyView->itemIsVisibleFromOutside(knobTreeItem);
-
-                if (drawInDimRow) {
-                    DopeSheetViewPrivate::KeyframeTexture texType = kfTextureFromKeyframeType( kf.getInterpolation(),
-                                                                                               kfSelected || selectionRect.intersects(zoomKfRect) );
-
-                    if (texType != DopeSheetViewPrivate::kfTextureNone) {
-                        drawTexturedKeyframe(texType, hasSingleKfTimeSelected && kfSelected,
-                                             kfTimeSelected, selectionColor, zoomKfRect);
-                    }
+                DopeSheetViewPrivate::KeyframeTexture texType = kfTextureFromKeyframeType( kf.getInterpolation(),
+                                                                                           kfSelected || selectionRect.intersects(zoomKfRect) );
+
+                if ( (texType != DopeSheetViewPrivate::kfTextureNone) && ( (column != lastColumn) || (texType != lastTexType) ) ) {
+                    queueTexturedKeyframe(texType, hasSingleKfTimeSelected && kfSelected,
+                                          kfTimeSelected, zoomKfRect);
+                    lastColumn = column;
+                    lastTexType = texType;
                 }
+            }
 
-                // Fill the knob times map
-                {
-                    DSKnobPtr rootDSKnob = model->mapNameItemToDSKnob( knobTreeItem->parent() );
-                    if (rootDSKnob) {
-                        assert(rootDSKnob);
-                        const std::map<double, bool>& map = knobsKeytimes[rootDSKnob.get()];
-                        bool knobTimeExists = ( map.find(keyTime) != map.end() );
-
-                        if (!knobTimeExists) {
-                            knobsKeytimes[rootDSKnob.get()][keyTime] = kfSelected;
-                        } else {
-                            bool knobTimeIsSelected = knobsKeytimes[rootDSKnob.get()][keyTime];
-
-                            if (!knobTimeIsSelected && kfSelected) {
-                                knobsKeytimes[rootDSKnob.get()][keyTime] = true;
-                            }
-                        }
-                    }
+            // Fill the knob times map
+            if (knobTimes) {
+                std::pair<std::map<int, std::pair<double, bool> >::iterator, bool> knobTime = knobTimes->insert( std::make_pair( column, std::make_pair(keyTime, kfSelected) ) );
+                if (!knobTime.second && kfSelected) {
+                    knobTime.first->second.second = true;
                 }
+            }
 
-                // Fill the node times map
-                bool nodeTimeExists = ( nodeKeytimes.find(keyTime) != nodeKeytimes.end() );
-
-                if (!nodeTimeExists) {
-                    nodeKeytimes[keyTime] = kfSelected;
-                } else {
-                    bool nodeTimeIsSelected = nodeKeytimes[keyTime];
-
-                    if (!nodeTimeIsSelected && kfSelected) {
-                        nodeKeytimes[keyTime] = true;
-                    }
+            // Fill the node times map
+            {
+                std::pair<std::map<int, std::pair<double, bool> >::iterator, bool> nodeTime = nodeKeytimes.insert( std::make_pair( column, std::make_pair(keyTime, kfSelected) ) );
+                if (!nodeTime.second && kfSelected) {
+                    nodeTime.first->second.second = true;
                 }
             }
         }
+    }
 
-        // Draw master keys in knob root section
-        for (std::map<DSKnob *, std::map<double, bool> >::const_iterator it = knobsKeytimes.begin();
-             it != knobsKeytimes.end();
-             ++it) {
-            QTreeWidgetItem *knobRootItem = (*it).first->getTreeItem();
-            std::map<double, bool> knobTimes = (*it).second;
-
-            for (std::map<double, bool>::const_iterator mIt = knobTimes.begin();
-                 mIt != knobTimes.end();
-                 ++mIt) {
-                double time = (*mIt).first;
-                bool drawSelected = (*mIt).second;
-                bool drawInKnobRootRow = hierarchyView->itemIsVisibleFromOutside(knobRootItem);
-
-                if (drawInKnobRootRow) {
-                    double newCenterY = hierarchyView->visualItemRect(knobRootItem).center().y();
-                    RectD zoomKfRect = getKeyFrameBoundingRectZoomCoords(time, newCenterY);
-                    DopeSheetViewPrivate::KeyframeTexture textureType = (drawSelected)
-                                                                        ? DopeSheetViewPrivate::kfTextureMasterSelected
-                                                                        : DopeSheetViewPrivate::kfTextureMaster;
-
-                    drawTexturedKeyframe(textureType, hasSingleKfTimeSelected && drawSelected,
-                                         kfTimeSelected, selectionColor, zoomKfRect);
-                }
-            }
+    // Draw master keys in knob root section
+    for (std::map<DSKnob *, std::map<int, std::pair<double, bool> > >::const_iterator it = knobsKeytimes.begin();
+         it != knobsKeytimes.end();
+         ++it) {
+        QTreeWidgetItem *knobRootItem = (*it).first->getTreeItem();
+        bool drawInKnobRootRow = hierarchyView->itemIsVisibleFromOutside(knobRootItem);
+
+        if (!drawInKnobRootRow) {
+            continue;
         }
+        double newCenterY = hierarchyView->visualItemRect(knobRootItem).center().y();
+        const std::map<int, std::pair<double, bool> >& knobTimes = (*it).second;
 
-        // Draw master keys in node section
-        for (std::map<double, bool>::const_iterator it = nodeKeytimes.begin();
+        for (std::map<int, std::pair<double, bool> >::const_iterator mIt = knobTimes.begin();
+             mIt != knobTimes.end();
+             ++mIt) {
+            double time = mIt->second.first;
+            bool drawSelected = mIt->second.second;
+            RectD zoomKfRect = getKeyFrameBoundingRectZoomCoords(time, newCenterY);
+            DopeSheetViewPrivate::KeyframeTexture textureType = (drawSelected)
+                                                                ? DopeSheetViewPrivate::kfTextureMasterSelected
+                                                                : DopeSheetViewPrivate::kfTextureMaster;
+
+            queueTexturedKeyframe(textureType, hasSingleKfTimeSelected && drawSelected,
+                                  kfTimeSelected, zoomKfRect);
+        }
+    }
+
+    // Draw master keys in node section
+    QTreeWidgetItem *nodeItem = dsNode->getTreeItem();
+    bool drawInNodeRow = hierarchyView->itemIsVisibleFromOutside(nodeItem);
+    if (drawInNodeRow) {
+        double newCenterY = hierarchyView->visualItemRect(nodeItem).center().y();
+        for (std::map<int, std::pair<double, bool> >::const_iterator it = nodeKeytimes.begin();
              it != nodeKeytimes.end();
              ++it) {
-            double time = (*it).first;
-            bool drawSelected = (*it).second;
-            QTreeWidgetItem *nodeItem = dsNode->getTreeItem();
-            bool drawInNodeRow = hierarchyView->itemIsVisibleFromOutside(nodeItem);
-
-            if (drawInNodeRow) {
-                double newCenterY = hierarchyView->visualItemRect(nodeItem).center().y();
-                RectD zoomKfRect = getKeyFrameBoundingRectZoomCoords(time, newCenterY);
-                DopeSheetViewPrivate::KeyframeTexture textureType = (drawSelected)
-                                                                    ? DopeSheetViewPrivate::kfTextureMasterSelected
-                                                                    : DopeSheetViewPrivate::kfTextureMaster;
-
-                drawTexturedKeyframe(textureType, hasSingleKfTimeSelected && drawSelected,
-                                     kfTimeSelected, selectionColor, zoomKfRect);
-            }
+            double time = it->second.first;
+            bool drawSelected = it->second.second;
+            RectD zoomKfRect = getKeyFrameBoundingRectZoomCoords(time, newCenterY);
+            DopeSheetViewPrivate::KeyframeTexture textureType = (drawSelected)
+                                                                ? DopeSheetViewPrivate::kfTextureMasterSelected
+                                                                : DopeSheetViewPrivate::kfTextureMaster;
+
+            queueTexturedKeyframe(textureType, hasSingleKfTimeSelected && drawSelected,
+                                  kfTimeSelected, zoomKfRect);
         }
     }
 } // DopeSheetViewPrivate::drawKeyframes
 
-void
-DopeSheetViewPrivate::drawTexturedKeyframe(DopeSheetViewPrivate::KeyframeTexture textureType,
-                                           bool drawTime,
-                                           double time,
-                                           const QColor& textColor,
-                                           const RectD &rect) const
+const std::vector<KeyFrame>&
+DopeSheetViewPrivate::getCurveKeyFrames(const CurvePtr& curve) const
 {
-    GLProtectAttrib<GL_GPU> a(GL_ENABLE_BIT | GL_COLOR_BUFFER_BIT | GL_CURRENT_BIT | GL_TRANSFORM_BIT);
-    GLProtectMatrix<GL_GPU> pr(GL_MODELVIEW);
+    CurveKeyFrames& entry = curvesKeyFrames[curve.get()];
 
-    GL_GPU::glEnable(GL_TEXTURE_2D);
-    GL_GPU::glBindTexture(GL_TEXTURE_2D, kfTexturesIDs[textureType]);
+    if ( ( entry.curve.lock() != curve ) || ( entry.changeCount != curve->getChangeCount() ) ) {
+        curve->getKeyFramesArray_mt_safe(&entry.keyframes, &entry.changeCount);
+        entry.curve = curve;
+    }
 
-    GL_GPU::glBegin(GL_POLYGON);
-    GL_GPU::glTexCoord2f(0.0f, 1.0f);
-    GL_GPU::glVertex2f( rect.left(), rect.top() );
-    GL_GPU::glTexCoord2f(0.0f, 0.0f);
-    GL_GPU::glVertex2f( rect.left(), rect.bottom() );
-    GL_GPU::glTexCoord2f(1.0f, 0.0f);
-    GL_GPU::glVertex2f( rect.right(), rect.bottom() );
-    GL_GPU::glTexCoord2f(1.0f, 1.0f);
-    GL_GPU::glVertex2f( rect.right(), rect.top() );
-    GL_GPU::glEnd();
+    return entry.keyframes;
+}
 
-    GL_GPU::glColor4f(1, 1, 1, 1);
-    GL_GPU::glBindTexture(GL_TEXTURE_2D, 0);
+void
+DopeSheetViewPrivate::queueTexturedKeyframe(DopeSheetViewPrivate::KeyframeTexture textureType,
+                                            bool drawTime,
+                                            double time,
+                                            const RectD &rect) const
+{
+    // Quad corners, as texture coordinates followed by vertex coordinates
+    const float quad[16] = {
+        0.f, 1.f, (float)rect.left(), (float)rect.top(),
+        0.f, 0.f, (float)rect.left(), (float)rect.bottom(),
+        1.f, 0.f, (float)rect.right(), (float)rect.bottom(),
+        1.f, 1.f, (float)rect.right(), (float)rect.top()
+    };
+    std::vector<float>& batch = keyframesBatches[textureType];
 
-    GL_GPU::glDisable(GL_TEXTURE_2D);
+    batch.insert( batch.end(), quad, quad + 16 );
 
     if (drawTime) {
-        QString text = QString::number(time);
-        QPointF p = zoomContext.toWidgetCoordinates( rect.right(), rect.bottom() );
+        keyframesTimes.push_back( std::make_pair(time, rect) );
+    }
+}
+
+void
+DopeSheetViewPrivate::drawQueuedKeyframes(const QColor& textColor) const
+{
+    {
+        GLProtectAttrib<GL_GPU> a(GL_ENABLE_BIT | GL_COLOR_BUFFER_BIT | GL_CURRENT_BIT | GL_TRANSFORM_BIT);
+        GLProtectMatrix<GL_GPU> pr(GL_MODELVIEW);
+
+        GL_GPU::glEnable(GL_BLEND);
+        GL_GPU::glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        GL_GPU::glEnable(GL_TEXTURE_2D);
+        GL_GPU::glEnableClientState(GL_VERTEX_ARRAY);
+        GL_GPU::glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+
+        // One draw call per texture
+        for (int i = 0; i < KF_TEXTURES_COUNT; ++i) {
+            std::vector<float>& batch = keyframesBatches[i];
+            if ( batch.empty() ) {
+                continue;
+            }
+            GL_GPU::glBindTexture(GL_TEXTURE_2D, kfTexturesIDs[i]);
+            GL_GPU::glTexCoordPointer(2, GL_FLOAT, 4 * sizeof(float), &batch[0]);
+            GL_GPU::glVertexPointer(2, GL_FLOAT, 4 * sizeof(float), &batch[2]);
+            GL_GPU::glDrawArrays(GL_QUADS, 0, (GLsizei)batch.size() / 4);
+            batch.clear();
+        }
+
+        GL_GPU::glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+        GL_GPU::glDisableClientState(GL_VERTEX_ARRAY);
+        GL_GPU::glColor4f(1, 1, 1, 1);
+        GL_GPU::glBindTexture(GL_TEXTURE_2D, 0);
+        GL_GPU::glDisable(GL_TEXTURE_2D);
+    }
+
+    for (std::vector<std::pair<double, RectD> >::const_iterator it = keyframesTimes.begin(); it != keyframesTimes.end(); ++it) {
+        QString text = QString::number(it->first);
+        QPointF p = zoomContext.toWidgetCoordinates( it->second.right(), it->second.bottom() );
         p.rx() += 3;
         p = zoomContext.toZoomCoordinates( p.x(), p.y() );
         renderText(p.x(), p.y(), text, textColor, *font);
     }
+    keyframesTimes.clear();
 }
 
 void
@@ -3039,6 +3107,9 @@ DopeSheetView::onNodeAboutToBeRemoved(const DSNodePtr& dsNode)
         _imp->nodeRanges.erase(toRemove);
     }
 
+    // The curves of the node may go away
+    _imp->curvesKeyFrames.clear();
+
     _imp->computeSelectedKeysBRect();
 
     redraw();
@@ -31,6 +31,7 @@
 #include <QPainter>
 #include <QApplication>
 #include <QGraphicsScene>
+#include <QStyleOptionGraphicsItem>
 
 #include "Gui/NodeGui.h"
 #include "Gui/NodeGraph.h"
@@ -60,6 +61,9 @@
 // number of offset pixels from the arrow that determine if a click is contained in the arrow or not
 #define kGraphicalContainerOffset 10
 
+// below this zoom level, edges are drawn as plain aliased lines, without arrow head, dash or bend point
+#define EDGE_MIN_LEVEL_OF_DETAIL 0.3
+
 NATRON_NAMESPACE_ENTER;
 
 struct EdgePrivate
@@ -111,8 +115,26 @@ struct EdgePrivate
     }
 
     void initLabel();
+
+    void markNodeDirty();
 };
 
+void
+EdgePrivate::markNodeDirty()
+{
+    // In the NodeGraph spatial index, the edge is part of the area of the node it is an input of,
+    // or of its source node for an output edge
+    NodeGuiPtr node = isOutputEdge ? source.lock() : dest.lock();
+
+    if (!node) {
+        return;
+    }
+    NodeGraph* graph = node->getDagGui();
+    if (graph) {
+        graph->markNodeDirty(node);
+    }
+}
+
 Edge::Edge(int inputNb_,
            double angle_,
            const NodeGuiPtr & dest_,
@@ -356,6 +378,7 @@ Edge::refreshState(bool hovered)
         bool visible = computeVisibility(hovered);
         if (isVisible() != visible) {
             setVisible(visible);
+            _imp->markNodeDirty();
         }
     }
 }
@@ -416,6 +439,8 @@ Edge::initLine()
         return;
     }
 
+    _imp->markNodeDirty();
+
     double sc = scale();
     QRectF sourceBBOX = source ? mapFromItem( source.get(), source->boundingRect() ).boundingRect() : QRectF(0, 0, 1, 1);
     QRectF destBBOX = dest ? mapFromItem( dest.get(), dest->boundingRect() ).boundingRect()  : QRectF(0, 0, 1, 1);
@@ -658,6 +683,7 @@ Edge::contains(const QPointF &point) const
 void
 Edge::dragSource(const QPointF & src)
 {
+    _imp->markNodeDirty();
     setLine( QLineF(line().p1(), src) );
 
     double a = std::acos( line().dx() / std::max( EDGE_LENGTH_MIN, line().length() ) );
@@ -682,6 +708,7 @@ Edge::dragSource(const QPointF & src)
 void
 Edge::dragDest(const QPointF & dst)
 {
+    _imp->markNodeDirty();
     setLine( QLineF( dst, line().p2() ) );
 
     double a = std::acos( line().dx() / std::max( EDGE_LENGTH_MIN, line().length() ) );
@@ -726,13 +753,6 @@ Edge::paint(QPainter *painter,
             const QStyleOptionGraphicsItem * /*options*/,
             QWidget * /*parent*/)
 {
-    bool antialias = appPTR->getCurrentSettings()->isNodeGraphAntiAliasingEnabled();
-
-    if (!antialias) {
-        painter->setRenderHint(QPainter::Antialiasing, false);
-    }
-
-    QPen myPen = pen();
     NodeGuiPtr dst = _imp->dest.lock();
     if (dst) {
         if ( dst->getDagGui()->isDoingNavigatorRender() ) {
@@ -740,7 +760,18 @@ Edge::paint(QPainter *painter,
         }
     }
 
-    if (_imp->paintWithDash) {
+    // When the graph is zoomed out far enough, the arrow head and bend point are only a few pixels wide:
+    // skip them, this is where most of the time is spent when drawing thousands of edges.
+    const bool drawDetails = QStyleOptionGraphicsItem::levelOfDetailFromTransform( painter->worldTransform() ) >= EDGE_MIN_LEVEL_OF_DETAIL;
+    bool antialias = drawDetails && appPTR->getCurrentSettings()->isNodeGraphAntiAliasingEnabled();
+
+    if (!antialias) {
+        painter->setRenderHint(QPainter::Antialiasing, false);
+    }
+
+    QPen myPen = pen();
+
+    if (_imp->paintWithDash && drawDetails) {
         QVector<qreal> dashStyle;
         qreal space = 4;
         dashStyle << 3 << space;
@@ -766,6 +797,10 @@ Edge::paint(QPainter *painter,
 
     painter->drawLine( line() );
 
+    if (!drawDetails) {
+        return;
+    }
+
     myPen.setStyle(Qt::SolidLine);
     painter->setPen(myPen);
 
@@ -170,6 +170,7 @@ SOURCES += \
     NodeGraph45.cpp \
     NodeGraphPrivate.cpp \
     NodeGraphPrivate10.cpp \
+    NodeGraphSpatialIndex.cpp \
     NodeGraphTextItem.cpp \
     NodeGraphUndoRedo.cpp \
     NodeGui.cpp \
@@ -307,6 +308,7 @@ HEADERS += \
     NodeCreationDialog.h \
     NodeGraph.h \
     NodeGraphPrivate.h \
+    NodeGraphSpatialIndex.h \
     NodeGraphTextItem.h \
     NodeGraphUndoRedo.h \
     NodeGui.h \
@@ -564,7 +564,6 @@ Gui::debugImage(const Image* image,
     }
     QImage output(renderWindow.width(), renderWindow.height(), QImage::Format_ARGB32);
     const Color::Lut* lut = Color::LutManager::sRGBLut();
-    lut->validate();
     Image::ReadAccess acc = image->getReadRights();
     const float* from = (const float*)acc.pixelAt( renderWindow.left(), renderWindow.bottom() );
     assert(from);
@@ -43,6 +43,10 @@
 
 #define NATRON_PREVIEW_WIDTH 64
 #define NATRON_PREVIEW_HEIGHT 38
+// Maximum number of threads computing node previews concurrently
+#define NATRON_PREVIEW_MAX_THREADS 4
+// Interval at which a preview waiting for the viewers to finish rendering checks them again
+#define NATRON_PREVIEW_VIEWER_YIELD_MS 50
 
 #define NODE_WIDTH 80
 #define NODE_HEIGHT 30
@@ -113,7 +113,7 @@ public:
         , gValueStr()
         , bValueStr()
         , filterSize(0)
-        , histogramThread()
+        , histogramCPU()
         , histogram1()
         , histogram2()
         , histogram3()
@@ -179,7 +179,7 @@ public:
     QString rValueStr, gValueStr, bValueStr;
     int filterSize;
 
-    HistogramCPU histogramThread;
+    HistogramCPU histogramCPU;
 
     ///up to 3 histograms (in the RGB) case. FOr all other cases just histogram1 is used.
     std::vector<float> histogram1;
@@ -207,7 +207,7 @@ Histogram::Histogram(Gui* gui,
 
     setSizePolicy(QSizePolicy::Preferred, QSizePolicy::Expanding);
     setMouseTracking(true);
-    QObject::connect( &_imp->histogramThread, SIGNAL(histogramProduced()), this, SLOT(onCPUHistogramComputed()) );
+    QObject::connect( &_imp->histogramCPU, SIGNAL(histogramProduced()), this, SLOT(onCPUHistogramComputed()) );
 
 //    QDesktopWidget* desktop = QApplication::desktop();
 //    _imp->sizeH = desktop->screenGeometry().size();
@@ -958,7 +958,7 @@ Histogram::computeHistogramAndRefresh(bool forceEvenIfNotVisible)
     RectI rect;
     ImagePtr image = _imp->getHistogramImage(&rect);
     if (image) {
-        _imp->histogramThread.computeHistogram(_imp->mode, image, rect, width(), vmin, vmax, _imp->filterSize);
+        _imp->histogramCPU.computeHistogram(_imp->mode, image, rect, width(), vmin, vmax, _imp->filterSize);
     } else {
         _imp->hasImage = false;
     }
@@ -978,7 +978,7 @@ Histogram::onCPUHistogramComputed()
     assert( qApp && qApp->thread() == QThread::currentThread() );
 
     int mode;
-    bool success = _imp->histogramThread.getMostRecentlyProducedHistogram(&_imp->histogram1, &_imp->histogram2, &_imp->histogram3, &_imp->binsCount, &_imp->pixelsCount, &mode, &_imp->vmin, &_imp->vmax, &_imp->mipMapLevel);
+    bool success = _imp->histogramCPU.getMostRecentlyProducedHistogram(&_imp->histogram1, &_imp->histogram2, &_imp->histogram3, &_imp->binsCount, &_imp->pixelsCount, &mode, &_imp->vmin, &_imp->vmax, &_imp->mipMapLevel);
     assert(success);
     if (success) {
         _imp->hasImage = true;
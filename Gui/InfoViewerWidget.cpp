@@ -50,6 +50,8 @@ InfoViewerWidget::InfoViewerWidget(const QString & description,
     , _comp( ImageComponents::getNoneComponents() )
     , _colorValid(false)
     , _colorApprox(false)
+    , _nbDroppedFrames(0)
+    , _playbackMipMapLevelOffset(0)
 {
     for (int i = 0; i < 4; ++i) {
         currentColor[i] = 0;
@@ -72,7 +74,9 @@ InfoViewerWidget::InfoViewerWidget(const QString & description,
                              "<font color=orange>Image format:</font>  An identifier for the pixel components and bitdepth of the displayed image<br />"
                              "<font color=orange>Format:</font>  The resolution of the project's format<br />"
                              "<font color=orange>RoD:</font>  The region of definition of the displayed image<br />"
-                             "<font color=orange>Fps:</font>  (Only active during playback) The frame-rate of the play-back sustained by the viewer<br />"
+                             "<font color=orange>Fps:</font>  (Only active during playback) The frame-rate of the play-back sustained by the viewer. "
+                             "When real-time playback is enabled in the preferences, it also shows the number of frames skipped and "
+                             "the resolution frames are rendered at to hold the frame rate<br />"
                              "<font color=orange>Coordinates:</font>  The coordinates of the current mouse location<br />"
                              "<font color=orange>RGBA:</font>  The RGBA color of the displayed image. Note that if some <b>?</b> are set instead of colors "
                              "that means the underlying image cannot be accessed internally, you should refresh the viewer to make it available. "
@@ -191,8 +195,15 @@ InfoViewerWidget::setFps(double actualFps,
     } else if ( actualFps < (desiredFps / 2.f) ) {
         colorStr = QString::fromUtf8("red");
     }
-    QString str = QString::fromUtf8("<font color=\"") + colorStr + QString::fromUtf8("\" face=\"%2\" size=%3>%1 fps</font>")
-                  .arg( QString::number(actualFps, 'f', 1) )
+    QString fpsStr = QString::number(actualFps, 'f', 1) + QString::fromUtf8(" fps");
+    if (_nbDroppedFrames > 0) {
+        fpsStr += tr(", %1 dropped").arg(_nbDroppedFrames);
+    }
+    if (_playbackMipMapLevelOffset > 0) {
+        fpsStr += tr(", 1/%1 res").arg(1 << _playbackMipMapLevelOffset);
+    }
+    QString str = QString::fromUtf8("<font color=\"") + colorStr + QString::fromUtf8("\" face=\"%2\" size=%3>%1</font>")
+                  .arg(fpsStr)
                   .arg( font.family() )
                   .arg( font.pixelSize() );
 
@@ -202,9 +213,20 @@ InfoViewerWidget::setFps(double actualFps,
     }
 }
 
+void
+InfoViewerWidget::setDroppedFrames(int nbDroppedFrames,
+                                   int mipMapLevelOffset)
+{
+    // Shown with the next frame-rate update
+    _nbDroppedFrames = nbDroppedFrames;
+    _playbackMipMapLevelOffset = mipMapLevelOffset;
+}
+
 void
 InfoViewerWidget::hideFps()
 {
+    _nbDroppedFrames = 0;
+    _playbackMipMapLevelOffset = 0;
     if ( _fpsLabel->isVisible() ) {
         _fpsLabel->hide();
     }
@@ -79,6 +79,7 @@ public Q_SLOTS:
     void hideColorAndMouseInfo();
     void showColorAndMouseInfo();
     void setFps(double actualFps, double desiredFps);
+    void setDroppedFrames(int nbDroppedFrames, int mipMapLevelOffset);
     void hideFps();
 
 private:
@@ -104,6 +105,8 @@ private:
     bool _colorValid;
     bool _colorApprox;
     double currentColor[4];
+    int _nbDroppedFrames;
+    int _playbackMipMapLevelOffset;
 };
 
 NATRON_NAMESPACE_EXIT;
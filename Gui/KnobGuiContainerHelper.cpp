@@ -24,6 +24,8 @@
 
 #include "KnobGuiContainerHelper.h"
 
+#include <algorithm> // min, max
+
 CLANG_DIAG_OFF(deprecated)
 CLANG_DIAG_OFF(uninitialized)
 #include <QScrollArea>
@@ -39,10 +41,12 @@ CLANG_DIAG_ON(deprecated)
 CLANG_DIAG_ON(uninitialized)
 
 #include "Engine/KnobTypes.h"
+#include "Engine/Settings.h"
 #include "Gui/KnobGui.h"
 #include "Gui/ClickableLabel.h"
 #include "Gui/KnobGuiGroup.h"
 #include "Gui/GuiApplicationManager.h"
+#include "Gui/NodeGraphUndoRedo.h"
 #include "Gui/TabGroup.h"
 
 #define NATRON_FORM_LAYOUT_LINES_SPACING 0
@@ -63,6 +67,12 @@ struct KnobGuiContainerHelperPrivate
     boost::shared_ptr<QUndoStack> undoStack; /*!< undo/redo stack*/
     QUndoCommand* cmdBeingPushed;
     bool clearedStackDuringPush;
+
+    // Estimate of the memory held by the commands of undoStack, maintained by pushUndoCommand()
+    std::size_t undoStackMemoryCost;
+
+    // The commands at the bottom of undoStack forgotten to enforce the memory cap
+    int nForgottenCommands;
     boost::scoped_ptr<KnobGuiContainerSignalsHandler> signals;
 
     KnobGuiContainerHelperPrivate(KnobGuiContainerHelper* p,
@@ -76,6 +86,8 @@ struct KnobGuiContainerHelperPrivate
         , undoStack()
         , cmdBeingPushed(0)
         , clearedStackDuringPush(false)
+        , undoStackMemoryCost(0)
+        , nForgottenCommands(0)
         , signals( new KnobGuiContainerSignalsHandler(p) )
     {
         if (stack) {
@@ -1160,6 +1172,15 @@ KnobGuiContainerHelper::getLastUndoCommand() const
     return _imp->undoStack->command(_imp->undoStack->index() - 1);
 }
 
+static std::size_t
+getUndoCommandMemoryCost(const QUndoCommand* cmd)
+{
+    const NodeUndoRedoCommand* nodeCmd = dynamic_cast<const NodeUndoRedoCommand*>(cmd);
+
+    // Knob commands only hold a few values
+    return nodeCmd ? nodeCmd->getMemoryCost() : sizeof(QUndoCommand);
+}
+
 void
 KnobGuiContainerHelper::pushUndoCommand(QUndoCommand* cmd)
 {
@@ -1168,16 +1189,58 @@ KnobGuiContainerHelper::pushUndoCommand(QUndoCommand* cmd)
 
         return;
     }
-    _imp->undoStack->setActive();
+    QUndoStack* stack = _imp->undoStack.get();
+    stack->setActive();
+
+    // The commands that could be redone are deleted by the push
+    for (int i = stack->index(); i < stack->count(); ++i) {
+        std::size_t cost = getUndoCommandMemoryCost( stack->command(i) );
+        _imp->undoStackMemoryCost -= std::min(cost, _imp->undoStackMemoryCost);
+    }
+    int nCommandsBefore = stack->index();
+    _imp->nForgottenCommands = std::min(_imp->nForgottenCommands, nCommandsBefore);
+
+    // The command may be merged into the current one, which changes its cost
+    const QUndoCommand* top = nCommandsBefore > 0 ? stack->command(nCommandsBefore - 1) : 0;
+    std::size_t topCostBefore = top ? getUndoCommandMemoryCost(top) : 0;
+
     _imp->cmdBeingPushed = cmd;
     _imp->clearedStackDuringPush = false;
-    _imp->undoStack->push(cmd);
+    stack->push(cmd);
 
     //We may be in a situation where the command was not pushed because the stack was cleared
     if (!_imp->clearedStackDuringPush) {
         _imp->cmdBeingPushed = 0;
+        if (stack->count() > nCommandsBefore) {
+            _imp->undoStackMemoryCost += getUndoCommandMemoryCost( stack->command(stack->count() - 1) );
+        } else if (stack->count() == nCommandsBefore) {
+            // Merged into the current command
+            std::size_t topCost = top ? getUndoCommandMemoryCost(top) : 0;
+            _imp->undoStackMemoryCost = _imp->undoStackMemoryCost - std::min(topCostBefore, _imp->undoStackMemoryCost) + topCost;
+        } else {
+            // The merge made the current command obsolete and it was deleted: count again
+            _imp->undoStackMemoryCost = 0;
+            for (int i = 0; i < stack->count(); ++i) {
+                _imp->undoStackMemoryCost += getUndoCommandMemoryCost( stack->command(i) );
+            }
+            _imp->nForgottenCommands = std::min(_imp->nForgottenCommands, stack->count());
+        }
+
+        // Enforce the memory cap by forgetting the oldest commands. The current command is never forgotten:
+        // the next ones may still be merged into it (e.g. while dragging).
+        int maxMemoryMB = appPTR->getCurrentSettings()->getMaximumUndoRedoMemoryMB();
+        std::size_t maxMemory = (std::size_t)std::max(0, maxMemoryMB) * 1024 * 1024;
+        while ( (maxMemory > 0) && (_imp->undoStackMemoryCost > maxMemory) && (_imp->nForgottenCommands < stack->count() - 1) ) {
+            NodeUndoRedoCommand* oldest = dynamic_cast<NodeUndoRedoCommand*>( const_cast<QUndoCommand*>( stack->command(_imp->nForgottenCommands) ) );
+            if (oldest) {
+                std::size_t cost = oldest->getMemoryCost();
+                oldest->forget();
+                _imp->undoStackMemoryCost -= std::min(cost - oldest->getMemoryCost(), _imp->undoStackMemoryCost);
+            }
+            ++_imp->nForgottenCommands;
+        }
     }
-    refreshUndoRedoButtonsEnabledNess( _imp->undoStack->canUndo(), _imp->undoStack->canRedo() );
+    refreshUndoRedoButtonsEnabledNess( stack->canUndo(), stack->canRedo() );
 }
 
 boost::shared_ptr<QUndoStack>
@@ -1186,11 +1249,25 @@ KnobGuiContainerHelper::getUndoStack() const
     return _imp->undoStack;
 }
 
+std::size_t
+KnobGuiContainerHelper::getUndoStackMemoryCost() const
+{
+    return _imp->undoStackMemoryCost;
+}
+
+int
+KnobGuiContainerHelper::getNumForgottenUndoCommands() const
+{
+    return _imp->nForgottenCommands;
+}
+
 void
 KnobGuiContainerHelper::clearUndoRedoStack()
 {
     if (_imp->undoStack) {
         _imp->undoStack->clear();
+        _imp->undoStackMemoryCost = 0;
+        _imp->nForgottenCommands = 0;
         _imp->clearedStackDuringPush = true;
         _imp->signals->s_deleteCurCmdLater();
         refreshUndoRedoButtonsEnabledNess( _imp->undoStack->canUndo(), _imp->undoStack->canRedo() );
@@ -1208,6 +1285,8 @@ KnobGuiContainerHelper::onDeleteCurCmdLater()
 {
     if (_imp->cmdBeingPushed) {
         _imp->undoStack->clear();
+        _imp->undoStackMemoryCost = 0;
+        _imp->nForgottenCommands = 0;
         _imp->cmdBeingPushed = 0;
     }
 }
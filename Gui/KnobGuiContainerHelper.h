@@ -27,6 +27,7 @@
 
 #include "Global/Macros.h"
 
+#include <cstddef>
 #include <map>
 
 #if !defined(Q_MOC_RUN) && !defined(SBK_RUN)
@@ -193,6 +194,17 @@ public:
      **/
     boost::shared_ptr<QUndoStack> getUndoStack() const;
 
+    /**
+     * @brief Returns an estimate in bytes of the memory held by the commands of the undo/redo stack
+     **/
+    std::size_t getUndoStackMemoryCost() const;
+
+    /**
+     * @brief Returns the number of commands at the bottom of the undo/redo stack that were forgotten
+     * to enforce the memory cap: they can no longer be undone.
+     **/
+    int getNumForgottenUndoCommands() const;
+
     /**
      * @brief Returns whether paging is enabled or not. If paging is disabled, there should only be a single page
      **/
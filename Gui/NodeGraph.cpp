@@ -412,6 +412,7 @@ NodeGraph::createNodeGUI(const NodePtr & node,
         QMutexLocker l(&_imp->_nodesMutex);
         _imp->_nodes.push_back(node_ui);
     }
+    markNodeDirty(node_ui);
 
     //NodeGroupPtr parentIsGroup = toNodeGroup(node->getGroup());;
     const NodesList& nodesBeingCreated = getGui()->getApp()->getNodesBeingCreated();
@@ -109,6 +109,17 @@ public:
 
     void restoreFromTrash(const NodeGuiPtr& node);
 
+    /**
+     * @brief To be called whenever the node (or one of its edges) moved, was resized or changed its look:
+     * its area is re-computed in the spatial index and re-rendered in the navigator.
+     **/
+    void markNodeDirty(const NodeGuiPtr& node);
+
+    /**
+     * @brief Called by the node when it is destroyed.
+     **/
+    void removeNodeFromSpatialIndex(const NodeGui* node);
+
     QGraphicsItem* getRootItem() const;
     virtual void notifyGuiClosing() OVERRIDE FINAL;
     void discardScenePointer();
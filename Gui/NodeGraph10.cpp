@@ -53,49 +53,12 @@ GCC_DIAG_UNUSED_PRIVATE_FIELD_ON
 #include "Global/QtCompat.h"
 
 NATRON_NAMESPACE_ENTER;
-static NodeGuiPtr
-isNodeGuiChild(QGraphicsItem* item)
-{
-    NodeGui* n = dynamic_cast<NodeGui*>(item);
-
-    if (n) {
-        return n->shared_from_this();
-    }
-    QGraphicsItem* parent = item->parentItem();
-    if (parent) {
-        return isNodeGuiChild(parent);
-    } else {
-        return NodeGuiPtr();
-    }
-}
-
-static Edge*
-isEdgeChild(QGraphicsItem* item)
-{
-    Edge* n = dynamic_cast<Edge*>(item);
-
-    if (n) {
-        return n;
-    }
-    QGraphicsItem* parent = item->parentItem();
-    if (parent) {
-        return isEdgeChild(parent);
-    } else {
-        return 0;
-    }
-}
 
 void
 NodeGraph::getNodesWithinViewportRect(const QRect& rect,
                                       std::set<NodeGuiPtr>* nodes) const
 {
-    QList<QGraphicsItem*> selectedItems = items(rect, Qt::IntersectsItemShape);
-    for (QList<QGraphicsItem*>::Iterator it = selectedItems.begin(); it != selectedItems.end(); ++it) {
-        NodeGuiPtr n = isNodeGuiChild(*it);
-        if (n) {
-            nodes->insert(n);
-        }
-    }
+    _imp->getItemsWithinViewportRect(rect, nodes, 0);
 }
 
 NodeGraph::NearbyItemEnum
@@ -111,19 +74,9 @@ NodeGraph::hasItemNearbyMouse(const QPoint& mousePosViewport,
                         mousePosViewport.y() - tolerance / 2.,
                         tolerance,
                         tolerance);
-    QList<QGraphicsItem*> selectedItems = items(toleranceRect, Qt::IntersectsItemShape);
     std::set<Edge*> edges;
     std::set<NodeGuiPtr> nodes;
-    for (QList<QGraphicsItem*>::Iterator it = selectedItems.begin(); it != selectedItems.end(); ++it) {
-        Edge* isEdge = isEdgeChild(*it);
-        if (isEdge) {
-            edges.insert(isEdge);
-        }
-        NodeGuiPtr n = isNodeGuiChild(*it);
-        if (n) {
-            nodes.insert(n);
-        }
-    }
+    _imp->getItemsWithinViewportRect(toleranceRect, &nodes, &edges);
 
     for (std::set<NodeGuiPtr>::iterator it = nodes.begin(); it != nodes.end(); ++it) {
         if ( (*it)->isVisible() && (*it)->isActive() ) {
@@ -63,6 +63,9 @@ NodeGraph::getFullSceneScreenShot()
 {
     _imp->isDoingPreviewRender = true;
 
+    // Collect the regions of the scene that changed since the last render
+    _imp->updateSpatialIndex();
+
     // The bbox of all nodes in the nodegraph
     QRectF sceneR = _imp->calcNodesBoundingRect();
 
@@ -82,12 +85,6 @@ NodeGraph::getFullSceneScreenShot()
     int sceneW_navPixelCoord = std::floor(sceneR.width() * scaleFactor);
     int sceneH_navPixelCoord = std::floor(sceneR.height() * scaleFactor);
 
-    // Render the scene in an image with the same aspect ratio  as the scene rect
-    QImage renderImage(sceneW_navPixelCoord, sceneH_navPixelCoord, QImage::Format_ARGB32_Premultiplied);
-
-    // Fill the background
-    renderImage.fill( QColor(71, 71, 71, 255) );
-
     // Offset the visible rect corner as an offset relative to the scene rect corner
     viewRect.setX( viewRect.x() - sceneR.x() );
     viewRect.setY( viewRect.y() - sceneR.y() );
@@ -100,20 +97,39 @@ NodeGraph::getFullSceneScreenShot()
     viewRect_navCoordinates.setRight(viewRect.right() * scaleFactor);
     viewRect_navCoordinates.setTop(viewRect.top() * scaleFactor);
 
-    // Paint the visible portion with a highlight
-    QPainter painter(&renderImage);
-
     // Remove the overlays from the scene before rendering it
     scene()->removeItem(_imp->_cacheSizeText);
     scene()->removeItem(_imp->_navigator);
 
-    // Render into the QImage with downscaling
-    scene()->render(&painter, renderImage.rect(), sceneR, Qt::KeepAspectRatio);
+    // The render of the previous call can be re-used if the navigator maps the same portion of the scene:
+    // only the regions that changed since then are rendered again.
+    // This is the common case when zooming or panning inside a large graph.
+    if ( !_imp->navigatorSceneImageValid ||
+         ( _imp->navigatorSceneImage.width() != sceneW_navPixelCoord) ||
+         ( _imp->navigatorSceneImage.height() != sceneH_navPixelCoord) ||
+         ( _imp->navigatorSceneRect != sceneR) ) {
+        // Render the scene in an image with the same aspect ratio  as the scene rect
+        _imp->navigatorSceneImage = QImage(sceneW_navPixelCoord, sceneH_navPixelCoord, QImage::Format_ARGB32_Premultiplied);
+        _imp->navigatorSceneRect = sceneR;
+        _imp->renderNavigatorSceneRegion(sceneR);
+        _imp->navigatorSceneImageValid = true;
+    } else {
+        for (std::list<QRectF>::const_iterator it = _imp->navigatorDirtyRects.begin(); it != _imp->navigatorDirtyRects.end(); ++it) {
+            if ( it->intersects(sceneR) ) {
+                _imp->renderNavigatorSceneRegion( it->intersected(sceneR) );
+            }
+        }
+    }
+    _imp->navigatorDirtyRects.clear();
 
     // Add the overlays back
     scene()->addItem(_imp->_navigator);
     scene()->addItem(_imp->_cacheSizeText);
 
+    // Paint the visible portion with a highlight on a copy of the render
+    QImage renderImage = _imp->navigatorSceneImage.copy();
+    QPainter painter(&renderImage);
+
     // Fill the highlight with a semi transparent whitish grey
     painter.fillRect( viewRect_navCoordinates, QColor(200, 200, 200, 100) );
 
@@ -185,6 +201,8 @@ NodeGraph::moveToTrash(const NodeGuiPtr& node)
         }
     }
 
+    markNodeDirty(node);
+
     QMutexLocker l(&_imp->_nodesMutex);
     for (NodesGuiList::iterator it = _imp->_nodes.begin(); it != _imp->_nodes.end(); ++it) {
         if ( *it == node ) {
@@ -199,6 +217,8 @@ void
 NodeGraph::restoreFromTrash(const NodeGuiPtr& node)
 {
     assert(node);
+    markNodeDirty(node);
+
     QMutexLocker l(&_imp->_nodesMutex);
     for (NodesGuiList::iterator it = _imp->_nodesTrash.begin(); it != _imp->_nodesTrash.end(); ++it) {
         if ( *it == node ) {
@@ -209,6 +229,18 @@ NodeGraph::restoreFromTrash(const NodeGuiPtr& node)
     }
 }
 
+void
+NodeGraph::markNodeDirty(const NodeGuiPtr& node)
+{
+    _imp->spatialIndex.markDirty(node);
+}
+
+void
+NodeGraph::removeNodeFromSpatialIndex(const NodeGui* node)
+{
+    _imp->spatialIndex.remove(node);
+}
+
 // grabbed from QDirModelPrivate::size() in qtbase/src/widgets/itemviews/qdirmodel.cpp
 static
 QString
@@ -264,7 +296,14 @@ NodeGraph::updateCacheSizeText()
     QString cacheSizeStr = QDirModelPrivate_size(cacheSize);
     quint64 diskSize = appPTR->getCachesTotalDiskSize();
     QString diskCacheSizeStr = QDirModelPrivate_size(diskSize);
-    QString newText = tr("Memory cache: %1 / Disk cache: %2").arg(cacheSizeStr).arg(diskCacheSizeStr);
+    bool budgetReduced = false;
+    QString cacheBudgetStr = QDirModelPrivate_size( appPTR->getCachesMemoryBudget(&budgetReduced) );
+    QString newText;
+    if (budgetReduced) {
+        newText = tr("Memory cache: %1 of %2 (reduced by memory pressure) / Disk cache: %3").arg(cacheSizeStr).arg(cacheBudgetStr).arg(diskCacheSizeStr);
+    } else {
+        newText = tr("Memory cache: %1 of %2 / Disk cache: %3").arg(cacheSizeStr).arg(cacheBudgetStr).arg(diskCacheSizeStr);
+    }
     if (newText != oldText) {
         _imp->_cacheSizeText->setText(newText);
     }
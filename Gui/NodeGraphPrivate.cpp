@@ -27,6 +27,13 @@
 
 #include <stdexcept>
 
+CLANG_DIAG_OFF(deprecated)
+CLANG_DIAG_OFF(uninitialized)
+#include <QGraphicsScene>
+#include <QPainterPath>
+CLANG_DIAG_ON(deprecated)
+CLANG_DIAG_ON(uninitialized)
+
 #include "Engine/Node.h"
 #include "Engine/NodeGroup.h"
 #include "Engine/NodeSerialization.h"
@@ -92,6 +99,11 @@ NodeGraphPrivate::NodeGraphPrivate(NodeGraph* p,
     , _hasMovedOnce(false)
     , lastSelectedViewer(0)
     , isDoingPreviewRender(false)
+    , spatialIndex()
+    , navigatorSceneImage()
+    , navigatorSceneRect()
+    , navigatorDirtyRects()
+    , navigatorSceneImageValid(false)
     , autoScrollTimer()
 {
     appPTR->getIcon(NATRON_PIXMAP_LOCKED, &unlockIcon);
@@ -184,6 +196,108 @@ NodeGraphPrivate::calcNodesBoundingRect()
     return ret;
 }
 
+void
+NodeGraphPrivate::updateSpatialIndex()
+{
+    std::list<QRectF> changedRects;
+
+    spatialIndex.update(&changedRects);
+    if (!navigatorSceneImageValid) {
+        return;
+    }
+    navigatorDirtyRects.splice(navigatorDirtyRects.end(), changedRects);
+    if (navigatorDirtyRects.size() > NATRON_NAVIGATOR_MAX_DIRTY_RECTS) {
+        // Too many changes, e.g: a lot of nodes were moved or pasted. A full render is cheaper.
+        navigatorDirtyRects.clear();
+        navigatorSceneImageValid = false;
+    }
+}
+
+static bool
+itemOrChildrenIntersectsScenePath(QGraphicsItem* item,
+                                  const QPainterPath& scenePath)
+{
+    if ( !item->isVisible() ) {
+        return false;
+    }
+    if ( item->collidesWithPath(item->mapFromScene(scenePath), Qt::IntersectsItemShape) ) {
+        return true;
+    }
+    QList<QGraphicsItem*> children = item->childItems();
+    for (QList<QGraphicsItem*>::iterator it = children.begin(); it != children.end(); ++it) {
+        if ( itemOrChildrenIntersectsScenePath(*it, scenePath) ) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void
+NodeGraphPrivate::getItemsWithinViewportRect(const QRect& rect,
+                                             std::set<NodeGuiPtr>* nodes,
+                                             std::set<Edge*>* edges)
+{
+    updateSpatialIndex();
+
+    QPainterPath scenePath;
+    scenePath.addPolygon( _publicInterface->mapToScene(rect) );
+    scenePath.closeSubpath();
+
+    std::list<NodeGuiPtr> candidates;
+    spatialIndex.getNodesIntersecting(scenePath.boundingRect(), &candidates);
+
+    for (std::list<NodeGuiPtr>::iterator it = candidates.begin(); it != candidates.end(); ++it) {
+        if ( !(*it)->isVisible() ) {
+            continue;
+        }
+        if ( nodes && itemOrChildrenIntersectsScenePath(it->get(), scenePath) ) {
+            nodes->insert(*it);
+        }
+        if (edges) {
+            const std::vector<Edge*>& inputs = (*it)->getInputsArrows();
+            for (std::vector<Edge*>::const_iterator it2 = inputs.begin(); it2 != inputs.end(); ++it2) {
+                if ( itemOrChildrenIntersectsScenePath(*it2, scenePath) ) {
+                    edges->insert(*it2);
+                }
+            }
+            Edge* output = (*it)->getOutputArrow();
+            if ( output && itemOrChildrenIntersectsScenePath(output, scenePath) ) {
+                edges->insert(output);
+            }
+        }
+    }
+}
+
+void
+NodeGraphPrivate::renderNavigatorSceneRegion(const QRectF& sceneRect)
+{
+    if ( navigatorSceneImage.isNull() || navigatorSceneRect.isEmpty() ) {
+        return;
+    }
+    double xScale = navigatorSceneImage.width() / navigatorSceneRect.width();
+    double yScale = navigatorSceneImage.height() / navigatorSceneRect.height();
+
+    // Align the region on the pixels of the image (with a 1 pixel margin for antialiasing) and render
+    // exactly the scene portion covered by these pixels, so that the result is the same as a full render.
+    QRectF imageRectF( (sceneRect.left() - navigatorSceneRect.left() ) * xScale,
+                       (sceneRect.top() - navigatorSceneRect.top() ) * yScale,
+                       sceneRect.width() * xScale,
+                       sceneRect.height() * yScale );
+    QRect imageRect = imageRectF.toAlignedRect().adjusted(-1, -1, 1, 1).intersected( navigatorSceneImage.rect() );
+    if ( imageRect.isEmpty() ) {
+        return;
+    }
+    QRectF sourceRect(navigatorSceneRect.left() + imageRect.left() / xScale,
+                      navigatorSceneRect.top() + imageRect.top() / yScale,
+                      imageRect.width() / xScale,
+                      imageRect.height() / yScale);
+    QPainter painter(&navigatorSceneImage);
+    painter.setClipRect(imageRect);
+    painter.fillRect( imageRect, QColor(71, 71, 71, 255) );
+    _publicInterface->scene()->render(&painter, imageRect, sourceRect, Qt::IgnoreAspectRatio);
+}
+
 void
 NodeGraphPrivate::resetAllClipboards()
 {
@@ -27,6 +27,9 @@
 
 #include "Global/Macros.h"
 
+#include <list>
+#include <set>
+
 #if !defined(Q_MOC_RUN) && !defined(SBK_RUN)
 #include <boost/weak_ptr.hpp>
 #endif
@@ -35,6 +38,8 @@ CLANG_DIAG_OFF(deprecated)
 CLANG_DIAG_OFF(uninitialized)
 #include <QtCore/QTimer>
 #include <QtCore/QMutex>
+#include <QtCore/QRectF>
+#include <QImage>
 #include <QGraphicsItem>
 #include <QGraphicsLineItem>
 #include <QGraphicsPixmapItem>
@@ -47,6 +52,7 @@ CLANG_DIAG_ON(deprecated)
 CLANG_DIAG_ON(uninitialized)
 
 #include "Gui/NodeGraphUndoRedo.h" // NodeGuiPtr
+#include "Gui/NodeGraphSpatialIndex.h"
 #include "Gui/GuiFwd.h"
 
 
@@ -59,6 +65,9 @@ CLANG_DIAG_ON(uninitialized)
 #define NATRON_NAVIGATOR_BASE_HEIGHT 0.2
 #define NATRON_NAVIGATOR_BASE_WIDTH 0.2
 
+///Past this number of dirty regions, the navigator image is fully re-rendered instead of being updated region by region.
+#define NATRON_NAVIGATOR_MAX_DIRTY_RECTS 64
+
 #define NATRON_SCENE_MAX 1e6
 #define NATRON_SCENE_MIN 0
 
@@ -203,6 +212,16 @@ public:
 
     ///True when the graph is rendered from the getFullSceneScreenShot() function
     bool isDoingPreviewRender;
+
+    ///Index of the nodes (and their edges) area, used for hit-testing
+    NodeGraphSpatialIndex spatialIndex;
+
+    ///The last render of the scene made for the navigator, without the visible portion highlight.
+    ///Only the regions in navigatorDirtyRects are re-rendered when the navigator needs to be refreshed
+    QImage navigatorSceneImage;
+    QRectF navigatorSceneRect;
+    std::list<QRectF> navigatorDirtyRects;
+    bool navigatorSceneImageValid;
     QTimer autoScrollTimer;
     QTimer refreshRenderStateTimer;
 
@@ -216,6 +235,25 @@ public:
 
     QRectF calcNodesBoundingRect();
 
+    /**
+     * @brief Re-computes the area of the nodes that changed in the spatial index and marks
+     * these areas dirty in the navigator image.
+     **/
+    void updateSpatialIndex();
+
+    /**
+     * @brief Returns the visible nodes and edges whose shape (or the shape of one of their children)
+     * intersects the given rectangle in viewport coordinates.
+     * This is equivalent to calling QGraphicsView::items() and sorting the items, but only tests the nodes
+     * found in the spatial index.
+     **/
+    void getItemsWithinViewportRect(const QRect& rect, std::set<NodeGuiPtr>* nodes, std::set<Edge*>* edges);
+
+    /**
+     * @brief Renders the given portion of the scene in navigatorSceneImage, which maps navigatorSceneRect.
+     **/
+    void renderNavigatorSceneRegion(const QRectF& sceneRect);
+
     void copyNodesInternal(const NodesGuiList& selection, NodeClipBoard & clipboard);
     void pasteNodesInternal(const NodeClipBoard & clipboard, const QPointF& scenPos,
                             bool useUndoCommand,
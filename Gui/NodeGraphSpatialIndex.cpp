@@ -0,0 +1,307 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <http://www.natron.fr/>,
+ * Copyright (C) 2016 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "NodeGraphSpatialIndex.h"
+
+#include <cassert>
+#include <cmath>
+#include <map>
+#include <set>
+#include <vector>
+
+#include "Gui/Edge.h"
+#include "Gui/NodeGui.h"
+
+// Size in scene coordinates of a cell of the grid. A default node is about 100x30.
+#define NATRON_NODEGRAPH_SPATIAL_INDEX_CELL_SIZE 256.
+
+// Nodes covering more cells than this (big backdrops, nodes with very long input edges)
+// are not stored in the grid but always returned as candidates by queries.
+#define NATRON_NODEGRAPH_SPATIAL_INDEX_MAX_CELLS_PER_NODE 64
+
+NATRON_NAMESPACE_ENTER;
+
+NATRON_NAMESPACE_ANONYMOUS_ENTER
+
+typedef std::pair<int, int> CellKey;
+typedef std::set<const NodeGui*> NodeSet;
+
+struct SpatialIndexEntry
+{
+    NodeGuiWPtr node;
+
+    // The area covered by the node and its edges, in scene coordinates
+    QRectF area;
+
+    // The range of cells covered by area, inclusive
+    int x1, y1, x2, y2;
+
+    // True if the node is in the large nodes list rather than in the grid
+    bool isLarge;
+
+    SpatialIndexEntry()
+        : node()
+        , area()
+        , x1(0)
+        , y1(0)
+        , x2(-1)
+        , y2(-1)
+        , isLarge(false)
+    {
+    }
+};
+
+typedef std::map<const NodeGui*, SpatialIndexEntry> EntriesMap;
+
+int
+toCellCoord(double v)
+{
+    return (int)std::floor(v / NATRON_NODEGRAPH_SPATIAL_INDEX_CELL_SIZE);
+}
+
+QRectF
+computeNodeArea(const NodeGuiPtr& node)
+{
+    QRectF ret = node->mapToScene( node->boundingRect() ).boundingRect();
+    const std::vector<Edge*>& inputs = node->getInputsArrows();
+
+    for (std::vector<Edge*>::const_iterator it = inputs.begin(); it != inputs.end(); ++it) {
+        if ( (*it)->isVisible() ) {
+            ret = ret.united( (*it)->sceneBoundingRect() );
+        }
+    }
+    Edge* output = node->getOutputArrow();
+    if ( output && output->isVisible() ) {
+        ret = ret.united( output->sceneBoundingRect() );
+    }
+
+    return ret;
+}
+
+NATRON_NAMESPACE_ANONYMOUS_EXIT
+
+struct NodeGraphSpatialIndexPrivate
+{
+    EntriesMap entries;
+    std::map<CellKey, NodeSet> cells;
+    NodeSet largeNodes;
+    std::map<const NodeGui*, NodeGuiWPtr> dirtyNodes;
+
+    NodeGraphSpatialIndexPrivate()
+        : entries()
+        , cells()
+        , largeNodes()
+        , dirtyNodes()
+    {
+    }
+
+    void unindexEntry(const NodeGui* key, const SpatialIndexEntry& entry);
+
+    void indexEntry(const NodeGui* key, SpatialIndexEntry& entry);
+};
+
+void
+NodeGraphSpatialIndexPrivate::unindexEntry(const NodeGui* key,
+                                           const SpatialIndexEntry& entry)
+{
+    if (entry.isLarge) {
+        largeNodes.erase(key);
+
+        return;
+    }
+    for (int y = entry.y1; y <= entry.y2; ++y) {
+        for (int x = entry.x1; x <= entry.x2; ++x) {
+            std::map<CellKey, NodeSet>::iterator found = cells.find( CellKey(x, y) );
+            if ( found != cells.end() ) {
+                found->second.erase(key);
+                if ( found->second.empty() ) {
+                    cells.erase(found);
+                }
+            }
+        }
+    }
+}
+
+void
+NodeGraphSpatialIndexPrivate::indexEntry(const NodeGui* key,
+                                         SpatialIndexEntry& entry)
+{
+    if ( entry.area.isNull() ) {
+        entry.x1 = entry.y1 = 0;
+        entry.x2 = entry.y2 = -1;
+        entry.isLarge = false;
+
+        return;
+    }
+    entry.x1 = toCellCoord( entry.area.left() );
+    entry.y1 = toCellCoord( entry.area.top() );
+    entry.x2 = toCellCoord( entry.area.right() );
+    entry.y2 = toCellCoord( entry.area.bottom() );
+
+    double nCells = (double)(entry.x2 - entry.x1 + 1) * (double)(entry.y2 - entry.y1 + 1);
+    entry.isLarge = nCells > NATRON_NODEGRAPH_SPATIAL_INDEX_MAX_CELLS_PER_NODE;
+    if (entry.isLarge) {
+        largeNodes.insert(key);
+
+        return;
+    }
+    for (int y = entry.y1; y <= entry.y2; ++y) {
+        for (int x = entry.x1; x <= entry.x2; ++x) {
+            cells[CellKey(x, y)].insert(key);
+        }
+    }
+}
+
+NodeGraphSpatialIndex::NodeGraphSpatialIndex()
+    : _imp( new NodeGraphSpatialIndexPrivate() )
+{
+}
+
+NodeGraphSpatialIndex::~NodeGraphSpatialIndex()
+{
+}
+
+void
+NodeGraphSpatialIndex::markDirty(const NodeGuiPtr& node)
+{
+    if (node) {
+        _imp->dirtyNodes[node.get()] = node;
+    }
+}
+
+void
+NodeGraphSpatialIndex::remove(const NodeGui* node)
+{
+    _imp->dirtyNodes.erase(node);
+    EntriesMap::iterator found = _imp->entries.find(node);
+    if ( found == _imp->entries.end() ) {
+        return;
+    }
+    _imp->unindexEntry(node, found->second);
+    _imp->entries.erase(found);
+}
+
+void
+NodeGraphSpatialIndex::clear()
+{
+    _imp->entries.clear();
+    _imp->cells.clear();
+    _imp->largeNodes.clear();
+    _imp->dirtyNodes.clear();
+}
+
+void
+NodeGraphSpatialIndex::update(std::list<QRectF>* changedRects)
+{
+    for (std::map<const NodeGui*, NodeGuiWPtr>::iterator it = _imp->dirtyNodes.begin(); it != _imp->dirtyNodes.end(); ++it) {
+        NodeGuiPtr node = it->second.lock();
+        EntriesMap::iterator found = _imp->entries.find(it->first);
+
+        if (!node) {
+            // The node is being destroyed
+            if ( found != _imp->entries.end() ) {
+                _imp->unindexEntry(it->first, found->second);
+                _imp->entries.erase(found);
+            }
+            continue;
+        }
+
+        SpatialIndexEntry* entry;
+        QRectF oldArea;
+        if ( found != _imp->entries.end() ) {
+            entry = &found->second;
+            oldArea = entry->area;
+            _imp->unindexEntry(it->first, *entry);
+        } else {
+            entry = &_imp->entries[it->first];
+            entry->node = node;
+        }
+        entry->area = computeNodeArea(node);
+        _imp->indexEntry(it->first, *entry);
+
+        if (changedRects) {
+            changedRects->push_back( oldArea.united(entry->area) );
+        }
+    }
+    _imp->dirtyNodes.clear();
+} // NodeGraphSpatialIndex::update
+
+void
+NodeGraphSpatialIndex::getNodesIntersecting(const QRectF& sceneRect,
+                                            std::list<NodeGuiPtr>* nodes) const
+{
+    assert( _imp->dirtyNodes.empty() );
+    if ( sceneRect.isNull() ) {
+        return;
+    }
+
+    int x1 = toCellCoord( sceneRect.left() );
+    int y1 = toCellCoord( sceneRect.top() );
+    int x2 = toCellCoord( sceneRect.right() );
+    int y2 = toCellCoord( sceneRect.bottom() );
+    double nCells = (double)(x2 - x1 + 1) * (double)(y2 - y1 + 1);
+
+    if ( nCells >= (double)_imp->entries.size() ) {
+        // The rectangle is large compared to the number of nodes (e.g: the whole viewport when zoomed out):
+        // it is cheaper to test every node.
+        for (EntriesMap::const_iterator it = _imp->entries.begin(); it != _imp->entries.end(); ++it) {
+            if ( it->second.area.intersects(sceneRect) ) {
+                NodeGuiPtr node = it->second.node.lock();
+                if (node) {
+                    nodes->push_back(node);
+                }
+            }
+        }
+
+        return;
+    }
+
+    NodeSet candidates = _imp->largeNodes;
+    for (int y = y1; y <= y2; ++y) {
+        for (int x = x1; x <= x2; ++x) {
+            std::map<CellKey, NodeSet>::const_iterator found = _imp->cells.find( CellKey(x, y) );
+            if ( found != _imp->cells.end() ) {
+                candidates.insert( found->second.begin(), found->second.end() );
+            }
+        }
+    }
+    for (NodeSet::const_iterator it = candidates.begin(); it != candidates.end(); ++it) {
+        EntriesMap::const_iterator found = _imp->entries.find(*it);
+        assert( found != _imp->entries.end() );
+        if ( ( found != _imp->entries.end() ) && found->second.area.intersects(sceneRect) ) {
+            NodeGuiPtr node = found->second.node.lock();
+            if (node) {
+                nodes->push_back(node);
+            }
+        }
+    }
+} // NodeGraphSpatialIndex::getNodesIntersecting
+
+std::size_t
+NodeGraphSpatialIndex::getNumNodes() const
+{
+    return _imp->entries.size();
+}
+
+NATRON_NAMESPACE_EXIT;
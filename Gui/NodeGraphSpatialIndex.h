@@ -0,0 +1,99 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <http://www.natron.fr/>,
+ * Copyright (C) 2016 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+#ifndef NODEGRAPHSPATIALINDEX_H
+#define NODEGRAPHSPATIALINDEX_H
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "Global/Macros.h"
+
+#include <list>
+
+#if !defined(Q_MOC_RUN) && !defined(SBK_RUN)
+#include <boost/scoped_ptr.hpp>
+#endif
+
+CLANG_DIAG_OFF(deprecated)
+CLANG_DIAG_OFF(uninitialized)
+#include <QtCore/QRectF>
+CLANG_DIAG_ON(deprecated)
+CLANG_DIAG_ON(uninitialized)
+
+#include "Gui/GuiFwd.h"
+
+NATRON_NAMESPACE_ENTER;
+
+struct NodeGraphSpatialIndexPrivate;
+
+/**
+ * @brief A uniform grid over the scene coordinates of the NodeGraph, mapping each cell to the nodes
+ * whose area (the node itself and its input edges) overlaps it.
+ * QGraphicsScene's own BSP index is of no use here: the scene always spans the fixed
+ * [NATRON_SCENE_MIN, NATRON_SCENE_MAX] area, so with a few thousand nodes all of them end up in a handful of leaves.
+ *
+ * Nodes are not re-indexed when they move: they are only marked dirty (which is cheap and happens a lot while dragging)
+ * and the grid is updated lazily on the next query.
+ * This is not thread-safe and must only be used from the main thread.
+ **/
+class NodeGraphSpatialIndex
+{
+public:
+
+    NodeGraphSpatialIndex();
+
+    ~NodeGraphSpatialIndex();
+
+    /**
+     * @brief Marks the area covered by the given node as changed: it will be re-computed on the next query.
+     **/
+    void markDirty(const NodeGuiPtr& node);
+
+    /**
+     * @brief Removes the node from the index. This must be called before the node is destroyed.
+     **/
+    void remove(const NodeGui* node);
+
+    void clear();
+
+    /**
+     * @brief Re-computes the area of all dirty nodes. For each of them, the union of its old and new area
+     * (in scene coordinates) is appended to changedRects if not NULL.
+     **/
+    void update(std::list<QRectF>* changedRects);
+
+    /**
+     * @brief Returns all nodes whose area intersects the given rectangle in scene coordinates.
+     * The index must have been updated beforehand.
+     **/
+    void getNodesIntersecting(const QRectF& sceneRect, std::list<NodeGuiPtr>* nodes) const;
+
+    std::size_t getNumNodes() const;
+
+private:
+
+    boost::scoped_ptr<NodeGraphSpatialIndexPrivate> _imp;
+};
+
+NATRON_NAMESPACE_EXIT;
+
+#endif // NODEGRAPHSPATIALINDEX_H
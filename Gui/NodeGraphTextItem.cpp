@@ -28,7 +28,9 @@
 #include <stdexcept>
 
 #include <QtCore/QDebug>
+#include <QPainter>
 #include <QStyleOption>
+#include <QStyleOptionGraphicsItem>
 
 #include "Engine/Settings.h"
 
@@ -41,6 +43,21 @@
 
 NATRON_NAMESPACE_ENTER;
 
+NATRON_NAMESPACE_ANONYMOUS_ENTER
+
+/**
+ * @brief Returns the scale from item coordinates to device pixels of the given painter.
+ * This is read from the painter world transform which already holds the full item-to-viewport
+ * transform, which is much cheaper than mapping the item through the scene and the view on each paint.
+ **/
+double
+getPainterLevelOfDetail(const QPainter* painter)
+{
+    return QStyleOptionGraphicsItem::levelOfDetailFromTransform( painter->worldTransform() );
+}
+
+NATRON_NAMESPACE_ANONYMOUS_EXIT
+
 NodeGraphTextItem::NodeGraphTextItem(NodeGraph* graph,
                                      QGraphicsItem* parent,
                                      bool alwaysDrawText)
@@ -73,9 +90,7 @@ NodeGraphTextItem::paint(QPainter *painter,
             isTooSmall = true;
         } else {
             QFontMetrics fm( font() );
-            QPoint topLeft = _graph->mapFromScene( mapToScene( QPointF(0, 0) ) );
-            QPoint btmLeft = _graph->mapFromScene( mapToScene( QPointF( 0, fm.height() ) ) );
-            int height = std::abs( btmLeft.y() - topLeft.y() );
+            double height = fm.height() * getPainterLevelOfDetail(painter);
             isTooSmall = height < NODEGRAPH_TEXT_ITEM_MIN_HEIGHT_PX;
         }
     }
@@ -117,9 +132,7 @@ NodeGraphSimpleTextItem::paint(QPainter *painter,
             isTooSmall = true;
         } else {
             QFontMetrics fm( font() );
-            QPoint topLeft = _graph->mapFromScene( mapToScene( QPointF(0, 0) ) );
-            QPoint btmLeft = _graph->mapFromScene( mapToScene( QPointF( 0, fm.height() ) ) );
-            int height = std::abs( btmLeft.y() - topLeft.y() );
+            double height = fm.height() * getPainterLevelOfDetail(painter);
             isTooSmall = height < NODEGRAPH_SIMPLE_TEXT_ITEM_MIN_HEIGHT_PX;
         }
     }
@@ -148,8 +161,7 @@ NodeGraphPixmapItem::paint(QPainter *painter,
     if ( _graph->isDoingNavigatorRender() ) {
         return;
     }
-    QRect br = _graph->mapFromScene( mapToScene( boundingRect() ).boundingRect() ).boundingRect();
-    int height = br.height();
+    double height = boundingRect().height() * getPainterLevelOfDetail(painter);
     if (height < NODEGRAPH_PIXMAP_ITEM_MIN_HEIGHT_PX) {
         return;
     }
@@ -41,6 +41,7 @@ CLANG_DIAG_ON(uninitialized)
 #include "Engine/Project.h"
 #include "Engine/RotoLayer.h"
 #include "Engine/TimeLine.h"
+#include "Engine/UndoCommand.h"
 #include "Engine/ViewerInstance.h"
 
 #include "Gui/NodeClipBoard.h"
@@ -2072,4 +2073,61 @@ InlineGroupCommand::redo()
     _firstRedoCalled = true;
 }
 
+NodeUndoRedoCommand::NodeUndoRedoCommand(const UndoCommandPtr& command)
+    : QUndoCommand()
+    , _command(command)
+{
+    setText( QString::fromUtf8( command->getText().c_str() ) );
+}
+
+NodeUndoRedoCommand::~NodeUndoRedoCommand()
+{
+}
+
+void
+NodeUndoRedoCommand::redo()
+{
+    if (_command) {
+        _command->redo();
+    }
+}
+
+void
+NodeUndoRedoCommand::undo()
+{
+    if (_command) {
+        _command->undo();
+    }
+}
+
+int
+NodeUndoRedoCommand::id() const
+{
+    return kNodeUndoChangeCommandCompressionID;
+}
+
+bool
+NodeUndoRedoCommand::mergeWith(const QUndoCommand* other)
+{
+    const NodeUndoRedoCommand* o = dynamic_cast<const NodeUndoRedoCommand*>(other);
+
+    if (!o || !_command || !o->_command) {
+        return false;
+    }
+
+    return _command->mergeWith(o->_command);
+}
+
+std::size_t
+NodeUndoRedoCommand::getMemoryCost() const
+{
+    return sizeof(*this) + (_command ? _command->getMemoryCost() : 0);
+}
+
+void
+NodeUndoRedoCommand::forget()
+{
+    _command.reset();
+}
+
 NATRON_NAMESPACE_EXIT;
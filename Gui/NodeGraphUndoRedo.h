@@ -27,6 +27,7 @@
 
 #include "Global/Macros.h"
 
+#include <cstddef>
 #include <list>
 #include <vector>
 
@@ -469,6 +470,40 @@ private:
 };
 
 
+/**
+ * @class Wraps an Engine UndoCommand (e.g. the roto commands) so that it can be pushed on the
+ * undo/redo stack of a settings panel.
+ **/
+class NodeUndoRedoCommand
+    : public QUndoCommand
+{
+public:
+
+    NodeUndoRedoCommand(const UndoCommandPtr& command);
+
+    virtual ~NodeUndoRedoCommand();
+
+    virtual void redo() OVERRIDE FINAL;
+    virtual void undo() OVERRIDE FINAL;
+    virtual int id() const OVERRIDE FINAL WARN_UNUSED_RETURN;
+    virtual bool mergeWith(const QUndoCommand* other) OVERRIDE FINAL WARN_UNUSED_RETURN;
+
+    /**
+     * @brief Returns an estimate in bytes of the memory held by the wrapped command.
+     **/
+    std::size_t getMemoryCost() const WARN_UNUSED_RETURN;
+
+    /**
+     * @brief Releases the wrapped command to free its memory: undo() and redo() do nothing afterwards.
+     * Used to forget the oldest commands of a stack which exceeds its memory cap.
+     **/
+    void forget();
+
+private:
+
+    UndoCommandPtr _command;
+};
+
 NATRON_NAMESPACE_EXIT;
 
 #endif // NODEGRAPHUNDOREDO_H
@@ -208,6 +208,9 @@ NodeGui::NodeGui(QGraphicsItem *parent)
 
 NodeGui::~NodeGui()
 {
+    if (_graph) {
+        _graph->removeNodeFromSpatialIndex(this);
+    }
 }
 
 void
@@ -963,6 +966,8 @@ NodeGui::refreshPositionEnd(double x,
 {
     setPos(x, y);
     if (_graph) {
+        _graph->markNodeDirty( shared_from_this() );
+
         QRectF bbox = mapRectToScene( boundingRect() );
         const NodesGuiList & allNodes = _graph->getAllActiveNodes();
 
@@ -1630,6 +1635,9 @@ NodeGui::refreshCurrentBrush()
     } else {
         applyBrush(_currentColor);
     }
+    if (_graph) {
+        _graph->markNodeDirty( shared_from_this() );
+    }
 }
 
 bool
@@ -3686,51 +3694,6 @@ NodeGui::onHideInputsKnobValueChanged(bool /*hidden*/)
     refreshEdgesVisility();
 }
 
-class NodeUndoRedoCommand
-    : public QUndoCommand
-{
-    boost::shared_ptr<UndoCommand> _command;
-
-public:
-
-    NodeUndoRedoCommand(const UndoCommandPtr& command)
-        : QUndoCommand()
-        , _command(command)
-    {
-        setText( QString::fromUtf8( command->getText().c_str() ) );
-    }
-
-    virtual ~NodeUndoRedoCommand()
-    {
-    }
-
-    virtual void redo() OVERRIDE FINAL
-    {
-        _command->redo();
-    }
-
-    virtual void undo() OVERRIDE FINAL
-    {
-        _command->undo();
-    }
-
-    virtual int id() const OVERRIDE FINAL WARN_UNUSED_RETURN
-    {
-        return kNodeUndoChangeCommandCompressionID;
-    }
-
-    virtual bool mergeWith(const QUndoCommand* other) OVERRIDE FINAL WARN_UNUSED_RETURN
-    {
-        const NodeUndoRedoCommand* o = dynamic_cast<const NodeUndoRedoCommand*>(other);
-
-        if (!o) {
-            return false;
-        }
-
-        return _command->mergeWith(o->_command);
-    }
-};
-
 void
 NodeGui::pushUndoCommand(const UndoCommandPtr& command)
 {
@@ -66,6 +66,7 @@ CLANG_DIAG_ON(uninitialized)
 #define COL_RS_ENABLED COL_ENABLED + 1
 #define COL_MT_ENABLED COL_RS_ENABLED + 1
 #define COL_GL_ENABLED COL_MT_ENABLED + 1
+#define COL_COPY_INPUT_ENABLED COL_GL_ENABLED + 1
 
 NATRON_NAMESPACE_ENTER;
 
@@ -83,6 +84,7 @@ struct PluginTreeNode
     AnimatedCheckBox* rsCheckbox;
     AnimatedCheckBox* mtCheckbox;
     AnimatedCheckBox* glCheckbox;
+    AnimatedCheckBox* copyInputCheckbox;
     Plugin* plugin;
 };
 
@@ -478,6 +480,8 @@ PreferencesPanel::createPluginsView(QGridLayout* pluginsFrameLayout)
     treeHeader->setText( COL_MT_ENABLED, tr("M-T") );
     treeHeader->setToolTip(COL_GL_ENABLED, tr("If unchecked, OpenGL rendering is disabled for any node with this plug-in. If the checkbox is disabled, the plug-in does not support OpenGL rendering"));
     treeHeader->setText( COL_GL_ENABLED, tr("OpenGL") );
+    treeHeader->setToolTip(COL_COPY_INPUT_ENABLED, tr("If checked, the input images are copied before being given to any node with this plug-in. Only check this for plug-ins that modify their input images (this is out of the OpenFX spec), as it requires an extra image allocation and copy for each input of each render"));
+    treeHeader->setText( COL_COPY_INPUT_ENABLED, tr("Copy inputs") );
     _imp->pluginsView->setHeaderItem(treeHeader);
     _imp->pluginsView->setSelectionMode(QAbstractItemView::NoSelection);
 #if QT_VERSION < 0x050000
@@ -573,6 +577,19 @@ PreferencesPanel::createPluginsView(QGridLayout* pluginsFrameLayout)
                 }
                 node.glCheckbox = checkbox;
             }
+            {
+                QWidget *checkboxContainer = new QWidget(0);
+                QHBoxLayout* checkboxLayout = new QHBoxLayout(checkboxContainer);
+                AnimatedCheckBox* checkbox = new AnimatedCheckBox(checkboxContainer);
+                checkboxLayout->addWidget(checkbox, Qt::AlignLeft | Qt::AlignVCenter);
+                checkboxLayout->setContentsMargins(0, 0, 0, 0);
+                checkboxLayout->setSpacing(0);
+                checkbox->setFixedSize( TO_DPIX(NATRON_SMALL_BUTTON_SIZE), TO_DPIY(NATRON_SMALL_BUTTON_SIZE) );
+                checkbox->setChecked( plugin->isInputImagesCopyEnabled() );
+                QObject::connect( checkbox, SIGNAL(clicked(bool)), this, SLOT(onCopyInputEnabledCheckBoxChecked(bool)) );
+                _imp->pluginsView->setItemWidget(node.item, COL_COPY_INPUT_ENABLED, checkbox);
+                node.copyInputCheckbox = checkbox;
+            }
 
             _imp->pluginsList.push_back(node);
         }
@@ -877,6 +894,23 @@ PreferencesPanel::onGLEnabledCheckBoxChecked(bool checked)
     }
 }
 
+void
+PreferencesPanel::onCopyInputEnabledCheckBoxChecked(bool checked)
+{
+    AnimatedCheckBox* cb = qobject_cast<AnimatedCheckBox*>( sender() );
+
+    if (!cb) {
+        return;
+    }
+    for (PluginTreeNodeList::iterator it = _imp->pluginsList.begin(); it != _imp->pluginsList.end(); ++it) {
+        if (it->copyInputCheckbox == cb) {
+            it->plugin->setInputImagesCopyEnabled(checked);
+            _imp->pluginSettingsChanged = true;
+            break;
+        }
+    }
+}
+
 void
 PreferencesPanelPrivate::setVisiblePage(int index)
 {
@@ -1132,6 +1166,9 @@ PreferencesPanel::restoreDefaults()
             if (it->mtCheckbox) {
                 it->mtCheckbox->setChecked(true);
             }
+            if (it->copyInputCheckbox) {
+                it->copyInputCheckbox->setChecked(false);
+            }
         }
     }
 }
@@ -83,6 +83,7 @@ public Q_SLOTS:
     void onRSEnabledCheckBoxChecked(bool);
     void onMTEnabledCheckBoxChecked(bool);
     void onGLEnabledCheckBoxChecked(bool);
+    void onCopyInputEnabledCheckBoxChecked(bool);
 
     void filterPlugins(const QString & txt);
 
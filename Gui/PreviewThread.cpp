@@ -25,53 +25,149 @@
 #include "PreviewThread.h"
 
 #include <list>
+#include <set>
 #include <vector>
+#include <algorithm> // min, max
 #include <stdexcept>
 #include <cstring> // for std::memcpy, std::memset
 
 #include <QtCore/QWaitCondition>
 #include <QtCore/QMutex>
 
+#include "Engine/AppManager.h"
+#include "Engine/Node.h"
+#include "Engine/OutputSchedulerThread.h"
+#include "Engine/TaskExecutor.h"
+#include "Engine/ViewerInstance.h"
+
+#include "Gui/Gui.h"
 #include "Gui/GuiDefines.h"
+#include "Gui/NodeGraph.h"
 #include "Gui/NodeGui.h"
-
-#include "Engine/Node.h"
+#include "Gui/ViewerTab.h"
 
 
 NATRON_NAMESPACE_ENTER;
 
-class ComputePreviewRequest
-    : public GenericThreadStartArgs
+struct PreviewRequest
 {
-public:
-
-    double time;
     NodeGuiWPtr node;
+    double time;
+
+    // True if the preview could not be made from the cache while a viewer was rendering: it is dispatched
+    // again once the viewers are idle
+    bool mustRender;
+};
+
+struct PreviewThreadPrivate
+{
+    PreviewThread* _publicInterface;
+
+    // Protects all fields below except maxTasks
+    QMutex requestsMutex;
 
-    ComputePreviewRequest()
-        : GenericThreadStartArgs()
-        , time(0)
-        , node()
-    {}
+    // Wakes up the dispatcher waiting for the viewers when quitting
+    QWaitCondition mustQuitCond;
 
-    virtual ~ComputePreviewRequest()
+    // Wakes up the thread waiting for all tasks to be done when quitting
+    QWaitCondition nodesComputingEmptyCond;
+
+    // Requests not dispatched yet, at most one per node
+    std::list<PreviewRequest> pendingRequests;
+
+    // Nodes for which a task is currently queued or computing the preview on the TaskExecutor
+    std::set<const NodeGui*> nodesComputing;
+    bool mustQuit;
+
+    // Maximum number of previews computed concurrently
+    const int maxTasks;
+
+    PreviewThreadPrivate(PreviewThread* publicInterface)
+        : _publicInterface(publicInterface)
+        , requestsMutex()
+        , mustQuitCond()
+        , nodesComputingEmptyCond()
+        , pendingRequests()
+        , nodesComputing()
+        , mustQuit(false)
+        , maxTasks( std::max( 1, std::min(NATRON_PREVIEW_MAX_THREADS, QThread::idealThreadCount() / 2) ) )
     {
     }
+
+    bool isAnyViewerRendering(const NodeGuiPtr& node) const;
+
+    /**
+     * @brief Blocks the dispatcher while a viewer is rendering. Returns false if the thread must quit.
+     * requestsMutex must be locked.
+     **/
+    bool waitForViewers(const NodeGuiPtr& node);
+
+    /**
+     * @brief Makes the preview from the cache, or renders it if mustRender is true or if no viewer is rendering.
+     * Returns false if the preview must be rendered once the viewers are idle.
+     **/
+    bool computePreview(const NodeGuiPtr& node, double time, bool mustRender);
+
+    /**
+     * @brief Queues again a request whose preview must be rendered once the viewers are idle
+     **/
+    void deferPreview(const NodeGuiPtr& node, double time);
+
+    void onPreviewComputed(const NodeGui* node);
 };
 
-struct PreviewThreadPrivate
+/**
+ * @brief Computes one preview on the TaskExecutor. The executor runs preview tasks
+ * at the lowest thread priority so they never slow down the viewer or the interface.
+ * A task never waits for the viewers, so that it does not hold a worker of the executor:
+ * if the preview cannot be made from the cache while a viewer renders, the request is deferred to the dispatcher.
+ **/
+class PreviewTask
+    : public ExecutorTask
 {
-    std::vector<unsigned int> data;
+    PreviewThreadPrivate* _imp;
+    NodeGuiWPtr _node;
+    const NodeGui* _nodeKey;
+    double _time;
+    bool _mustRender;
+
+public:
+
+    PreviewTask(PreviewThreadPrivate* imp,
+                const NodeGuiPtr& node,
+                double time,
+                bool mustRender)
+        : ExecutorTask()
+        , _imp(imp)
+        , _node(node)
+        , _nodeKey( node.get() )
+        , _time(time)
+        , _mustRender(mustRender)
+    {
+    }
+
+    virtual ~PreviewTask()
+    {
+    }
+
+    virtual void run() OVERRIDE FINAL
+    {
+        NodeGuiPtr node = _node.lock();
+        if ( node && !_imp->computePreview(node, _time, _mustRender) ) {
+            _imp->deferPreview(node, _time);
+        }
+        _imp->onPreviewComputed(_nodeKey);
+    }
 
-    PreviewThreadPrivate()
-        : data( NATRON_PREVIEW_HEIGHT * NATRON_PREVIEW_WIDTH * sizeof(unsigned int) )
+    virtual void onDropped() OVERRIDE FINAL
     {
+        _imp->onPreviewComputed(_nodeKey);
     }
 };
 
 PreviewThread::PreviewThread()
     : GenericSchedulerThread()
-    , _imp( new PreviewThreadPrivate() )
+    , _imp( new PreviewThreadPrivate(this) )
 {
     setThreadName("PreviewThread");
 }
@@ -86,51 +182,233 @@ void
 PreviewThread::appendToQueue(const NodeGuiPtr& node,
                              double time)
 {
-    boost::shared_ptr<ComputePreviewRequest> r( new ComputePreviewRequest() );
+    if (!node) {
+        return;
+    }
+    {
+        QMutexLocker k(&_imp->requestsMutex);
+        bool found = false;
+        for (std::list<PreviewRequest>::iterator it = _imp->pendingRequests.begin(); it != _imp->pendingRequests.end(); ++it) {
+            if (it->node.lock() == node) {
+                // Coalesce: only the most recent request is relevant
+                it->time = time;
+                found = true;
+                break;
+            }
+        }
+        if (!found) {
+            PreviewRequest r;
+            r.node = node;
+            r.time = time;
+            r.mustRender = false;
+            _imp->pendingRequests.push_back(r);
+        }
+    }
 
-    r->node = node;
-    r->time = time;
-    startTask(r);
+    // Wake up the dispatcher
+    startTask( ThreadStartArgsPtr( new GenericThreadStartArgs() ) );
+}
+
+void
+PreviewThread::onQuitRequested(bool /*allowRestarts*/)
+{
+    QMutexLocker k(&_imp->requestsMutex);
+
+    _imp->pendingRequests.clear();
+    _imp->mustQuit = true;
+    _imp->mustQuitCond.wakeAll();
+}
+
+void
+PreviewThread::onWaitForThreadToQuit()
+{
+    QMutexLocker k(&_imp->requestsMutex);
+
+    while ( !_imp->nodesComputing.empty() ) {
+        _imp->nodesComputingEmptyCond.wait(&_imp->requestsMutex);
+    }
+    _imp->mustQuit = false;
 }
 
 GenericSchedulerThread::ThreadStateEnum
-PreviewThread::threadLoopOnce(const ThreadStartArgsPtr& inArgs)
+PreviewThread::threadLoopOnce(const ThreadStartArgsPtr& /*inArgs*/)
 {
-    boost::shared_ptr<ComputePreviewRequest> args = boost::dynamic_pointer_cast<ComputePreviewRequest>(inArgs);
+    std::list<ExecutorTaskPtr> tasks;
+    {
+        QMutexLocker k(&_imp->requestsMutex);
 
-    assert(args);
+        // Previews that could not be made from the cache are rendered once the viewers are idle.
+        // Wait here rather than in the tasks, this thread is dedicated to dispatching.
+        for (std::list<PreviewRequest>::iterator it = _imp->pendingRequests.begin(); it != _imp->pendingRequests.end(); ++it) {
+            NodeGuiPtr node = it->node.lock();
+            if (it->mustRender && node) {
+                if ( !_imp->waitForViewers(node) ) {
+                    return eThreadStateActive;
+                }
+                break;
+            }
+        }
 
+        std::list<PreviewRequest>::iterator it = _imp->pendingRequests.begin();
 
-    NodeGuiPtr node = args->node.lock();
-    if (node) {
-        ///Mark this thread as running
-        appPTR->fetchAndAddNRunningThreads(1);
+        while ( !_imp->mustQuit && ( it != _imp->pendingRequests.end() ) && ( (int)_imp->nodesComputing.size() < _imp->maxTasks ) ) {
+            NodeGuiPtr node = it->node.lock();
+            if (!node) {
+                it = _imp->pendingRequests.erase(it);
+                continue;
+            }
+            // A preview is already being computed for this node: keep the request pending,
+            // it will be dispatched when the task is done
+            if ( _imp->nodesComputing.find( node.get() ) != _imp->nodesComputing.end() ) {
+                ++it;
+                continue;
+            }
+            _imp->nodesComputing.insert( node.get() );
+            tasks.push_back( ExecutorTaskPtr( new PreviewTask(_imp.get(), node, it->time, it->mustRender) ) );
+            it = _imp->pendingRequests.erase(it);
+        }
+    }
+
+    // Submit outside of the lock: the tasks lock requestsMutex when they are done
+    TaskExecutor* executor = appPTR->getTaskExecutor();
+    for (std::list<ExecutorTaskPtr>::iterator it = tasks.begin(); it != tasks.end(); ++it) {
+        if ( !executor || !executor->submit(eTaskPriorityPreview, *it) ) {
+            (*it)->run();
+        }
+    }
+
+    return eThreadStateActive;
+} // PreviewThread::threadLoopOnce
+
+bool
+PreviewThreadPrivate::isAnyViewerRendering(const NodeGuiPtr& node) const
+{
+    NodeGraph* graph = node->getDagGui();
+    Gui* gui = graph ? graph->getGui() : 0;
+
+    if (!gui) {
+        return false;
+    }
+    std::list<ViewerTab*> viewers = gui->getViewersList_mt_safe();
+    for (std::list<ViewerTab*>::const_iterator it = viewers.begin(); it != viewers.end(); ++it) {
+        ViewerInstancePtr viewer = (*it)->getInternalNode();
+        if (!viewer) {
+            continue;
+        }
+        RenderEnginePtr engine = viewer->getRenderEngine();
+        if ( engine && engine->hasThreadsWorking() ) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool
+PreviewThreadPrivate::waitForViewers(const NodeGuiPtr& node)
+{
+    while ( !mustQuit && isAnyViewerRendering(node) ) {
+        mustQuitCond.wait(&requestsMutex, NATRON_PREVIEW_VIEWER_YIELD_MS);
+    }
+
+    return !mustQuit;
+}
+
+bool
+PreviewThreadPrivate::computePreview(const NodeGuiPtr& node,
+                                     double time,
+                                     bool mustRender)
+{
+    NodePtr internalNode = node->getNode();
+
+    if (!internalNode) {
+        return true;
+    }
+
+    ///Mark this thread as running
+    appPTR->fetchAndAddNRunningThreads(1);
 
-        //process the request if valid
-        int w = NATRON_PREVIEW_WIDTH;
-        int h = NATRON_PREVIEW_HEIGHT;
+    //process the request if valid
+    int w = NATRON_PREVIEW_WIDTH;
+    int h = NATRON_PREVIEW_HEIGHT;
+    std::vector<unsigned int> data( NATRON_PREVIEW_HEIGHT * NATRON_PREVIEW_WIDTH * sizeof(unsigned int) );
 
-        //set buffer to 0
+    //set buffer to 0
 #ifndef __NATRON_WIN32__
-        std::memset( &_imp->data.front(), 0, _imp->data.size() * sizeof(unsigned int) );
+    std::memset( &data.front(), 0, data.size() * sizeof(unsigned int) );
 #else
-        for (std::size_t i = 0; i < _imp->data.size(); ++i) {
-            _imp->data[i] = qRgba(0, 0, 0, 255);
-        }
+    for (std::size_t i = 0; i < data.size(); ++i) {
+        data[i] = qRgba(0, 0, 0, 255);
+    }
 #endif
-        NodePtr internalNode = node->getNode();
-        if (internalNode) {
-            bool ok = internalNode->makePreviewImage( args->time, &w, &h, &_imp->data.front() );
-            Q_UNUSED(ok);
-            node->copyPreviewImageBuffer(_imp->data, w, h);
+
+    // First try to make the preview out of an image in the cache, otherwise render it once the viewers are idle
+    bool ok = internalNode->makePreviewImageFromCache( time, &w, &h, &data.front() );
+    bool done = true;
+    if (!ok) {
+        bool viewersRendering;
+        {
+            QMutexLocker k(&requestsMutex);
+            viewersRendering = !mustRender && isAnyViewerRendering(node);
+        }
+        if (viewersRendering) {
+            done = false;
+        } else {
+            ok = internalNode->makePreviewImage( time, &w, &h, &data.front() );
         }
+    }
+    Q_UNUSED(ok);
+    if (done) {
+        node->copyPreviewImageBuffer(data, w, h);
+    }
+
+    ///Unmark this thread as running
+    appPTR->fetchAndAddNRunningThreads(-1);
 
-        ///Unmark this thread as running
-        appPTR->fetchAndAddNRunningThreads(-1);
+    return done;
+} // computePreview
+
+void
+PreviewThreadPrivate::deferPreview(const NodeGuiPtr& node,
+                                   double time)
+{
+    QMutexLocker k(&requestsMutex);
+
+    if (mustQuit) {
+        return;
     }
+    for (std::list<PreviewRequest>::iterator it = pendingRequests.begin(); it != pendingRequests.end(); ++it) {
+        if (it->node.lock() == node) {
+            // A more recent request was made meanwhile, it will be rendered instead
+            it->mustRender = true;
 
-    return eThreadStateActive;
-} // PreviewThread::threadLoopOnce
+            return;
+        }
+    }
+    PreviewRequest r;
+    r.node = node;
+    r.time = time;
+    r.mustRender = true;
+    pendingRequests.push_back(r);
+}
 
-NATRON_NAMESPACE_EXIT;
+void
+PreviewThreadPrivate::onPreviewComputed(const NodeGui* node)
+{
+    bool hasPendingRequests;
+    {
+        QMutexLocker k(&requestsMutex);
+        nodesComputing.erase(node);
+        if ( nodesComputing.empty() ) {
+            nodesComputingEmptyCond.wakeAll();
+        }
+        hasPendingRequests = !mustQuit && !pendingRequests.empty();
+    }
+
+    // Dispatch requests that were waiting for a task to be done
+    if (hasPendingRequests) {
+        _publicInterface->startTask( ThreadStartArgsPtr( new GenericThreadStartArgs() ) );
+    }
+}
 
+NATRON_NAMESPACE_EXIT;
@@ -41,6 +41,14 @@
 
 NATRON_NAMESPACE_ENTER;
 
+/**
+ * @brief Schedules the computation of node previews.
+ * Requests are coalesced per node: if a preview is requested for a node which already has a pending request,
+ * only the most recent time is kept. Pending requests are dispatched as preview tasks to the TaskExecutor,
+ * at most one per node at a time. Previews that can be made from images already in the cache are done right away,
+ * otherwise they are rendered once the viewers are done rendering: the dispatcher waits for the viewers,
+ * not the tasks, so that no worker of the executor is blocked.
+ **/
 struct PreviewThreadPrivate;
 class PreviewThread
     : public GenericSchedulerThread
@@ -56,9 +64,11 @@ private:
 
     virtual TaskQueueBehaviorEnum tasksQueueBehaviour() const OVERRIDE FINAL WARN_UNUSED_RETURN
     {
-        return eTaskQueueBehaviorProcessInOrder;
+        return eTaskQueueBehaviorSkipToMostRecent;
     }
 
+    virtual void onQuitRequested(bool allowRestarts) OVERRIDE FINAL;
+    virtual void onWaitForThreadToQuit() OVERRIDE FINAL;
     virtual ThreadStateEnum threadLoopOnce(const ThreadStartArgsPtr& inArgs) OVERRIDE FINAL WARN_UNUSED_RETURN;
     boost::scoped_ptr<PreviewThreadPrivate> _imp;
 };
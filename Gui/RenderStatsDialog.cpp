@@ -35,7 +35,9 @@
 #include <QItemSelectionModel>
 #include <QtCore/QRegExp>
 
+#include "Engine/AppManager.h" // Dialogs::errorDialog
 #include "Engine/Node.h"
+#include "Engine/RenderTrace.h"
 #include "Engine/Timer.h"
 #include "Engine/Utils.h" // convertFromPlainText
 #include "Engine/ViewIdx.h"
@@ -45,6 +47,7 @@
 #include "Gui/Label.h"
 #include "Gui/LineEdit.h"
 #include "Gui/NodeGui.h"
+#include "Gui/SequenceFileDialog.h"
 #include "Gui/TableModelView.h"
 
 
@@ -704,6 +707,9 @@ struct RenderStatsDialogPrivate
     Label* totalTimeSpentValueLabel;
     double totalSpentTime;
     Button* resetButton;
+    Label* recordTimelineLabel;
+    QCheckBox* recordTimelineCheckbox;
+    Button* exportTimelineButton;
     QWidget* filterContainer;
     QHBoxLayout* filterLayout;
     Label* filtersLabel;
@@ -730,6 +736,9 @@ struct RenderStatsDialogPrivate
         , totalTimeSpentValueLabel(0)
         , totalSpentTime(0)
         , resetButton(0)
+        , recordTimelineLabel(0)
+        , recordTimelineCheckbox(0)
+        , exportTimelineButton(0)
         , filterContainer(0)
         , filterLayout(0)
         , filtersLabel(0)
@@ -815,6 +824,28 @@ RenderStatsDialog::RenderStatsDialog(Gui* gui)
     QObject::connect( _imp->resetButton, SIGNAL(clicked(bool)), this, SLOT(resetStats()) );
     _imp->globalInfosLayout->addWidget(_imp->resetButton);
 
+    _imp->globalInfosLayout->addSpacing(20);
+
+    QString timelineTt = NATRON_NAMESPACE::convertFromPlainText(tr("When checked, each thread records when it enters and leaves plug-in actions, "
+                                                                   "cache lookups, tiles and waits on the Python interpreter.
+"
+                                                                   "The timeline can then be exported to a file that can be opened with chrome://tracing "
+                                                                   "or https://ui.perfetto.dev to find stalls in the render."), NATRON_NAMESPACE::WhiteSpaceNormal);
+    _imp->recordTimelineLabel = new Label(tr("Record Timeline:"), _imp->globalInfosContainer);
+    _imp->recordTimelineLabel->setToolTip(timelineTt);
+    _imp->recordTimelineCheckbox = new QCheckBox(_imp->globalInfosContainer);
+    _imp->recordTimelineCheckbox->setChecked( RenderTrace::isEnabled() );
+    _imp->recordTimelineCheckbox->setToolTip(timelineTt);
+    QObject::connect( _imp->recordTimelineCheckbox, SIGNAL(clicked(bool)), this, SLOT(onRecordTimelineCheckboxClicked(bool)) );
+
+    _imp->globalInfosLayout->addWidget(_imp->recordTimelineLabel);
+    _imp->globalInfosLayout->addWidget(_imp->recordTimelineCheckbox);
+
+    _imp->exportTimelineButton = new Button(tr("Export Timeline..."), _imp->globalInfosContainer);
+    _imp->exportTimelineButton->setToolTip( tr("Writes the recorded timeline to a trace-event JSON file.") );
+    QObject::connect( _imp->exportTimelineButton, SIGNAL(clicked(bool)), this, SLOT(onExportTimelineButtonClicked()) );
+    _imp->globalInfosLayout->addWidget(_imp->exportTimelineButton);
+
     _imp->globalInfosLayout->addStretch();
 
     _imp->mainLayout->addWidget(_imp->globalInfosContainer);
@@ -972,6 +1003,33 @@ RenderStatsDialog::resetStats()
     _imp->model->clearRows();
     _imp->totalTimeSpentValueLabel->setText( QString::fromUtf8("0.0 sec") );
     _imp->totalSpentTime = 0;
+    RenderTrace::clear();
+}
+
+void
+RenderStatsDialog::onRecordTimelineCheckboxClicked(bool checked)
+{
+    RenderTrace::setEnabled(checked);
+}
+
+void
+RenderStatsDialog::onExportTimelineButtonClicked()
+{
+    std::vector<std::string> filters;
+
+    filters.push_back("json");
+    SequenceFileDialog dialog(this, filters, false, SequenceFileDialog::eFileDialogModeSave, "", _imp->gui, false);
+    if ( !dialog.exec() ) {
+        return;
+    }
+    std::string filePath = dialog.filesToSave();
+    if ( filePath.empty() ) {
+        return;
+    }
+    std::string error;
+    if ( !RenderTrace::writeToFile(filePath, &error) ) {
+        Dialogs::errorDialog( tr("Export Timeline").toStdString(), error );
+    }
 }
 
 void
@@ -1003,6 +1061,8 @@ void
 RenderStatsDialog::closeEvent(QCloseEvent * /*event*/)
 {
     _imp->gui->setRenderStatsEnabled(false);
+    _imp->recordTimelineCheckbox->setChecked(false);
+    RenderTrace::setEnabled(false);
 }
 
 void
@@ -73,6 +73,9 @@ public Q_SLOTS:
     void onNameLineEditChanged(const QString& filter);
     void onIDLineEditChanged(const QString& filter);
 
+    void onRecordTimelineCheckboxClicked(bool checked);
+    void onExportTimelineButtonClicked();
+
 private:
 
     virtual void closeEvent(QCloseEvent * event) OVERRIDE FINAL;
@@ -148,10 +148,13 @@ ViewerTab::manageSlotsForInfoWidget(int textureIndex,
     assert(engine);
     if (connect) {
         QObject::connect( engine.get(), SIGNAL(fpsChanged(double,double)), _imp->infoWidget[textureIndex], SLOT(setFps(double,double)) );
+        QObject::connect( engine.get(), SIGNAL(droppedFramesChanged(int,int)), _imp->infoWidget[textureIndex], SLOT(setDroppedFrames(int,int)) );
         QObject::connect( engine.get(), SIGNAL(renderFinished(int)), _imp->infoWidget[textureIndex], SLOT(hideFps()) );
     } else {
         QObject::disconnect( engine.get(), SIGNAL(fpsChanged(double,double)), _imp->infoWidget[textureIndex],
                              SLOT(setFps(double,double)) );
+        QObject::disconnect( engine.get(), SIGNAL(droppedFramesChanged(int,int)), _imp->infoWidget[textureIndex],
+                             SLOT(setDroppedFrames(int,int)) );
         QObject::disconnect( engine.get(), SIGNAL(renderFinished(int)), _imp->infoWidget[textureIndex], SLOT(hideFps()) );
     }
 }
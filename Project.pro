@@ -36,6 +36,7 @@ SUBDIRS += \
     Renderer \
     Gui \
     Tests \
+    Benchmarks \
     App
 
 # where to find the sub projects - give the folders
@@ -57,6 +58,7 @@ Engine.depends = libmv openMVG HostSupport libtess ceres
 Renderer.depends = Engine
 Gui.depends = Engine qhttpserver
 Tests.depends = Gui Engine
+Benchmarks.depends = Engine
 App.depends = Gui Engine
 
 OTHER_FILES += \
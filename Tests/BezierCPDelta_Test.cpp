@@ -0,0 +1,158 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <http://www.natron.fr/>,
+ * Copyright (C) 2016 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "Global/Macros.h"
+
+#include <gtest/gtest.h>
+
+#include "Engine/BezierCP.h"
+#include "Engine/Curve.h"
+#include "Engine/ViewIdx.h"
+
+NATRON_NAMESPACE_USING
+
+static void
+setPointAtTime(BezierCP & cp,
+               double time,
+               double x,
+               double y)
+{
+    cp.setPositionAtTime(false, time, x, y);
+    cp.setLeftBezierPointAtTime(false, time, x - 1., y);
+    cp.setRightBezierPointAtTime(false, time, x + 1., y);
+}
+
+static void
+expectPointAtTime(const BezierCP & cp,
+                  double time,
+                  double x,
+                  double y)
+{
+    double px, py, lx, ly, rx, ry;
+
+    EXPECT_TRUE( cp.getPositionAtTime(false, time, ViewIdx(0), &px, &py) );
+    cp.getLeftBezierPointAtTime(false, time, ViewIdx(0), &lx, &ly);
+    cp.getRightBezierPointAtTime(false, time, ViewIdx(0), &rx, &ry);
+    EXPECT_EQ(x, px);
+    EXPECT_EQ(y, py);
+    EXPECT_EQ(x - 1., lx);
+    EXPECT_EQ(x + 1., rx);
+
+    // the GUI curves must follow
+    EXPECT_TRUE( cp.getPositionAtTime(true, time, ViewIdx(0), &px, &py) );
+    EXPECT_EQ(x, px);
+    EXPECT_EQ(y, py);
+}
+
+TEST(BezierCPDelta, RestoreKeyframeAtTime)
+{
+    BezierCP cp;
+
+    for (int i = 0; i < 10; ++i) {
+        setPointAtTime(cp, i * 10., i, 2. * i);
+    }
+
+    BezierCPDelta delta;
+    cp.saveDelta(30., false, &delta);
+    for (int i = 0; i < BezierCPDelta::eCurveCount; ++i) {
+        EXPECT_EQ( 1u, delta.keyframes[i].size() );
+    }
+
+    setPointAtTime(cp, 30., 100., 100.);
+    cp.restoreDelta(delta);
+
+    EXPECT_EQ( 10, cp.getKeyframesCount(false) );
+    for (int i = 0; i < 10; ++i) {
+        expectPointAtTime(cp, i * 10., i, 2. * i);
+    }
+}
+
+TEST(BezierCPDelta, RemoveAddedKeyframe)
+{
+    BezierCP cp;
+
+    setPointAtTime(cp, 0., 1., 2.);
+    setPointAtTime(cp, 10., 3., 4.);
+
+    BezierCPDelta delta;
+    cp.saveDelta(5., false, &delta);
+    for (int i = 0; i < BezierCPDelta::eCurveCount; ++i) {
+        EXPECT_TRUE( delta.keyframes[i].empty() );
+    }
+
+    // e.g. a move with auto-keying sets a keyframe
+    setPointAtTime(cp, 5., 50., 50.);
+    EXPECT_EQ( 3, cp.getKeyframesCount(false) );
+    cp.restoreDelta(delta);
+
+    EXPECT_EQ( 2, cp.getKeyframesCount(false) );
+    EXPECT_FALSE( cp.hasKeyFrameAtTime(false, 5.) );
+    EXPECT_FALSE( cp.hasKeyFrameAtTime(true, 5.) );
+    expectPointAtTime(cp, 0., 1., 2.);
+    expectPointAtTime(cp, 10., 3., 4.);
+}
+
+TEST(BezierCPDelta, RestoreStaticPosition)
+{
+    BezierCP cp;
+
+    cp.setStaticPosition(false, 1., 2.);
+
+    BezierCPDelta delta;
+    cp.saveDelta(0., false, &delta);
+    cp.setStaticPosition(false, 10., 20.);
+    cp.restoreDelta(delta);
+
+    double x, y;
+    EXPECT_FALSE( cp.getPositionAtTime(false, 0., ViewIdx(0), &x, &y) );
+    EXPECT_EQ(1., x);
+    EXPECT_EQ(2., y);
+}
+
+TEST(BezierCPDelta, RippleEdit)
+{
+    BezierCP cp;
+
+    for (int i = 0; i < 100; ++i) {
+        setPointAtTime(cp, i, i, i);
+    }
+
+    BezierCPDelta rippleDelta, delta;
+    cp.saveDelta(50., true, &rippleDelta);
+    cp.saveDelta(50., false, &delta);
+    EXPECT_EQ( 100u, rippleDelta.keyframes[BezierCPDelta::eCurveX].size() );
+    // a delta for a single time does not grow with the number of keyframes
+    EXPECT_LT( delta.getMemoryCost(), rippleDelta.getMemoryCost() );
+    EXPECT_LT( delta.getMemoryCost(), sizeof(BezierCPDelta) + BezierCPDelta::eCurveCount * 2 * sizeof(KeyFrame) );
+
+    for (int i = 0; i < 100; ++i) {
+        setPointAtTime(cp, i, i + 5., i - 5.);
+    }
+    cp.restoreDelta(rippleDelta);
+
+    EXPECT_EQ( 100, cp.getKeyframesCount(false) );
+    for (int i = 0; i < 100; ++i) {
+        expectPointAtTime(cp, i, i, i);
+    }
+}
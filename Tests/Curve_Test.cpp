@@ -124,3 +124,39 @@ TEST(Curve, Basic)
 }
 
 
+
+TEST(Curve, ChangeCount)
+{
+    Curve c;
+    std::vector<KeyFrame> keys;
+    U64 changeCount;
+
+    c.getKeyFramesArray_mt_safe(&keys, &changeCount);
+    EXPECT_TRUE( keys.empty() );
+    EXPECT_EQ( changeCount, c.getChangeCount() );
+
+    // any modification of the keyframes changes the count
+    c.addKeyFrame( KeyFrame(1., 20.) );
+    c.addKeyFrame( KeyFrame(0., 10.) );
+    EXPECT_NE( changeCount, c.getChangeCount() );
+    c.getKeyFramesArray_mt_safe(&keys, &changeCount);
+    ASSERT_EQ( 2U, keys.size() );
+    EXPECT_EQ( 0., keys[0].getTime() );
+    EXPECT_EQ( 1., keys[1].getTime() );
+
+    // reading the curve does not
+    (void)c.getValueAt(0.5);
+    EXPECT_EQ( changeCount, c.getChangeCount() );
+
+    c.setKeyFrameValueAndTime(0., 15., 0);
+    EXPECT_NE( changeCount, c.getChangeCount() );
+    changeCount = c.getChangeCount();
+    c.setKeyFrameInterpolation(eKeyframeTypeLinear, 1);
+    EXPECT_NE( changeCount, c.getChangeCount() );
+    changeCount = c.getChangeCount();
+    c.removeKeyFrameWithIndex(0);
+    EXPECT_NE( changeCount, c.getChangeCount() );
+    changeCount = c.getChangeCount();
+    c.clearKeyFrames();
+    EXPECT_NE( changeCount, c.getChangeCount() );
+}
@@ -24,10 +24,14 @@
 
 #include "Global/Macros.h"
 
+#include <algorithm>
+#include <bitset>
 #include <cstring>
+#include <vector>
 #include <gtest/gtest.h>
 
 #include "Engine/Image.h"
+#include "Engine/ImageComponents.h"
 #include "Engine/ViewIdx.h"
 
 NATRON_NAMESPACE_USING
@@ -157,3 +161,232 @@ TEST(ImageKeyTest, Difference) {
     ASSERT_TRUE(keyHash1 != keyHash2);
 }
 
+
+TEST(ImageKeyTest, ConversionDifference) {
+    ImageKey key1(0, 1234, false, 0, ViewIdx(0), 1., false, false);
+    U64 keyHash1 = key1.getHash();
+
+    ///a converted variant of an image must not be found under the key of the image itself
+    ImageKey key2 = key1;
+    key2._conversionHash = 42;
+    key2.resetHash();
+    U64 keyHash2 = key2.getHash();
+    ASSERT_TRUE(keyHash1 != keyHash2);
+    ASSERT_FALSE(key1 == key2);
+
+    ///but it still belongs to the same node hash, so it is evicted along with it
+    ASSERT_TRUE( key1.getTreeVersion() == key2.getTreeVersion() );
+}
+
+// Images with odd sizes, so that the vectorized loops of the pixel kernels also run their scalar tails
+template <typename PIX>
+static ImagePtr
+makeTestImage(const ImageComponents& components,
+              ImageBitDepthEnum depth,
+              const RectI& bounds,
+              int maxValue,
+              unsigned int seed)
+{
+    RectD rod(bounds.x1, bounds.y1, bounds.x2, bounds.y2);
+    ImagePtr image( new Image(components, rod, bounds, 0, 1., depth, eImagePremultiplicationPremultiplied, eImageFieldingOrderNone) );
+    Image::WriteAccess acc( image.get() );
+    int nElements = bounds.width() * (int)components.getNumComponents();
+
+    for (int y = bounds.y1; y < bounds.y2; ++y) {
+        PIX* row = (PIX*)acc.pixelAt(bounds.x1, y);
+        for (int i = 0; i < nElements; ++i) {
+            seed = seed * 1103515245 + 12345;
+            // float images also get values slightly out of [0,1], which the integer kernels would clamp
+            float v = ( (seed >> 16) % 1000 ) / 800.f - 0.1f;
+            if (maxValue == 1) {
+                row[i] = (PIX)v;
+            } else {
+                row[i] = (PIX)( std::max( 0.f, std::min(1.f, v) ) * maxValue );
+            }
+        }
+    }
+
+    return image;
+}
+
+static std::vector<unsigned char>
+imagePixels(const ImagePtr& image)
+{
+    const RectI& bounds = image->getBounds();
+    Image::ReadAccess acc( image.get() );
+    const unsigned char* data = acc.pixelAt(bounds.x1, bounds.y1);
+    std::size_t size = (std::size_t)bounds.area() * image->getComponentsCount() * getSizeOfForBitDepth( image->getBitDepth() );
+
+    return std::vector<unsigned char>(data, data + size);
+}
+
+// The per-pixel definition of Image::applyMaskMix()
+template <typename PIX, int maxValue>
+static void
+maskMixReference(const ImagePtr& dst,
+                 const ImagePtr& mask,
+                 const ImagePtr& original,
+                 bool maskInvert,
+                 float mix)
+{
+    Image::WriteAccess dstAcc( dst.get() );
+    Image::ReadAccess maskAcc( mask.get() );
+    Image::ReadAccess originalAcc( original.get() );
+    const RectI& bounds = dst->getBounds();
+    int dstNComps = dst->getComponentsCount();
+    int srcNComps = original->getComponentsCount();
+
+    for (int y = bounds.y1; y < bounds.y2; ++y) {
+        for (int x = bounds.x1; x < bounds.x2; ++x) {
+            PIX* dstPix = (PIX*)dstAcc.pixelAt(x, y);
+            const PIX* srcPix = (const PIX*)originalAcc.pixelAt(x, y);
+            float alpha = mix;
+            if (mask) {
+                const PIX* maskPix = (const PIX*)maskAcc.pixelAt(x, y);
+                float maskScale = maskPix ? *maskPix / float(maxValue) : (maskInvert ? 1.f : 0.f);
+                if (maskPix && maskInvert) {
+                    maskScale = 1.f - maskScale;
+                }
+                alpha = mix * maskScale;
+            }
+            for (int c = 0; c < dstNComps; ++c) {
+                if (!srcPix) {
+                    dstPix[c] = Image::clampIfInt<PIX>(float(dstPix[c]) * alpha);
+                } else if (c < srcNComps) {
+                    dstPix[c] = Image::clampIfInt<PIX>( float(dstPix[c]) * alpha + (1.f - alpha) * float(srcPix[c]) );
+                }
+            }
+        }
+    }
+}
+
+template <typename PIX, int maxValue>
+static void
+checkMaskMix(ImageBitDepthEnum depth,
+             const ImageComponents& dstComponents,
+             const ImageComponents& srcComponents)
+{
+    RectI bounds(0, 0, 37, 9);
+    // the original image and the mask only partially cover the output
+    ImagePtr original = makeTestImage<PIX>(srcComponents, depth, RectI(3, -2, 30, 7), maxValue, 2);
+    ImagePtr mask = makeTestImage<PIX>(ImageComponents::getAlphaComponents(), depth, RectI(5, 2, 40, 12), maxValue, 3);
+
+    for (int masked = 0; masked < 2; ++masked) {
+        for (int maskInvert = 0; maskInvert < 2; ++maskInvert) {
+            ImagePtr img = makeTestImage<PIX>(dstComponents, depth, bounds, maxValue, 1);
+            ImagePtr expected = makeTestImage<PIX>(dstComponents, depth, bounds, maxValue, 1);
+            img->applyMaskMix(bounds, mask.get(), original.get(), masked, maskInvert, 0.3f);
+            maskMixReference<PIX, maxValue>(expected, masked ? mask : ImagePtr(), original, maskInvert, 0.3f);
+            EXPECT_TRUE( imagePixels(img) == imagePixels(expected) ) << "depth " << depth << " components " << dstComponents.getNumComponents()
+                                                                    << "/" << srcComponents.getNumComponents() << " masked " << masked << " invert " << maskInvert;
+        }
+    }
+}
+
+TEST(ImageKernelsTest, MaskMixIsBitExact) {
+    const ImageComponents& rgba = ImageComponents::getRGBAComponents();
+    const ImageComponents& rgb = ImageComponents::getRGBComponents();
+    const ImageComponents& alpha = ImageComponents::getAlphaComponents();
+
+    checkMaskMix<float, 1>(eImageBitDepthFloat, rgba, rgba);
+    checkMaskMix<float, 1>(eImageBitDepthFloat, rgb, rgb);
+    checkMaskMix<float, 1>(eImageBitDepthFloat, alpha, alpha);
+    checkMaskMix<float, 1>(eImageBitDepthFloat, rgba, rgb);
+    checkMaskMix<unsigned short, 65535>(eImageBitDepthShort, rgba, rgba);
+    checkMaskMix<unsigned short, 65535>(eImageBitDepthShort, alpha, alpha);
+    checkMaskMix<unsigned char, 255>(eImageBitDepthByte, rgba, rgba);
+    checkMaskMix<unsigned char, 255>(eImageBitDepthByte, rgb, rgb);
+    checkMaskMix<unsigned char, 255>(eImageBitDepthByte, alpha, alpha);
+}
+
+// The per-pixel definition of Image::copyUnProcessedChannels() for images with the same components
+template <typename PIX>
+static void
+copyChannelsReference(const ImagePtr& dst,
+                      const ImagePtr& original,
+                      std::bitset<4> processChannels)
+{
+    Image::WriteAccess dstAcc( dst.get() );
+    Image::ReadAccess originalAcc( original.get() );
+    const RectI& bounds = dst->getBounds();
+    int nComps = dst->getComponentsCount();
+    bool doChannel[4] = {
+        !processChannels[0] && nComps >= 2, !processChannels[1] && nComps >= 2, !processChannels[2] && nComps >= 3, false
+    };
+
+    if ( (nComps == 1) || (nComps == 4) ) {
+        doChannel[nComps - 1] = !processChannels[3];
+    }
+    for (int y = bounds.y1; y < bounds.y2; ++y) {
+        for (int x = bounds.x1; x < bounds.x2; ++x) {
+            PIX* dstPix = (PIX*)dstAcc.pixelAt(x, y);
+            const PIX* srcPix = (const PIX*)originalAcc.pixelAt(x, y);
+            for (int c = 0; c < nComps; ++c) {
+                if (doChannel[c]) {
+                    dstPix[c] = srcPix ? srcPix[c] : 0;
+                }
+            }
+        }
+    }
+}
+
+template <typename PIX, int maxValue>
+static void
+checkCopyChannels(ImageBitDepthEnum depth,
+                  const ImageComponents& components)
+{
+    RectI bounds(0, 0, 37, 9);
+    ImagePtr original = makeTestImage<PIX>(components, depth, RectI(3, -2, 30, 7), maxValue, 2);
+
+    for (unsigned long channels = 0; channels < 16; ++channels) {
+        std::bitset<4> processChannels(channels);
+        ImagePtr img = makeTestImage<PIX>(components, depth, bounds, maxValue, 1);
+        ImagePtr expected = makeTestImage<PIX>(components, depth, bounds, maxValue, 1);
+        img->copyUnProcessedChannels(bounds, eImagePremultiplicationPremultiplied, eImagePremultiplicationPremultiplied, processChannels, original, false);
+        copyChannelsReference<PIX>(expected, original, processChannels);
+        EXPECT_TRUE( imagePixels(img) == imagePixels(expected) ) << "depth " << depth << " components " << components.getNumComponents()
+                                                                << " processed " << processChannels.to_string();
+    }
+}
+
+TEST(ImageKernelsTest, CopyUnProcessedChannelsIsBitExact) {
+    checkCopyChannels<float, 1>( eImageBitDepthFloat, ImageComponents::getRGBAComponents() );
+    checkCopyChannels<float, 1>( eImageBitDepthFloat, ImageComponents::getRGBComponents() );
+    checkCopyChannels<float, 1>( eImageBitDepthFloat, ImageComponents::getAlphaComponents() );
+    checkCopyChannels<unsigned short, 65535>( eImageBitDepthShort, ImageComponents::getRGBAComponents() );
+    checkCopyChannels<unsigned short, 65535>( eImageBitDepthShort, ImageComponents::getRGBComponents() );
+    checkCopyChannels<unsigned char, 255>( eImageBitDepthByte, ImageComponents::getRGBAComponents() );
+    checkCopyChannels<unsigned char, 255>( eImageBitDepthByte, ImageComponents::getRGBComponents() );
+}
+
+TEST(ImageKernelsTest, PremultIsBitExact) {
+    RectI bounds(0, 0, 37, 9);
+    // only a part of the image is processed
+    RectI roi(1, 2, 34, 9);
+
+    for (int doPremult = 0; doPremult < 2; ++doPremult) {
+        ImagePtr img = makeTestImage<float>(ImageComponents::getRGBAComponents(), eImageBitDepthFloat, bounds, 1, 1);
+        ImagePtr expected = makeTestImage<float>(ImageComponents::getRGBAComponents(), eImageBitDepthFloat, bounds, 1, 1);
+        if (doPremult) {
+            img->premultImage(roi);
+        } else {
+            img->unpremultImage(roi);
+        }
+        {
+            Image::WriteAccess acc( expected.get() );
+            for (int y = roi.y1; y < roi.y2; ++y) {
+                for (int x = roi.x1; x < roi.x2; ++x) {
+                    float* pix = (float*)acc.pixelAt(x, y);
+                    for (int c = 0; c < 3; ++c) {
+                        if (doPremult) {
+                            pix[c] = pix[c] * pix[3];
+                        } else if (pix[3] != 0) {
+                            pix[c] = pix[c] / pix[3];
+                        }
+                    }
+                }
+            }
+        }
+        EXPECT_TRUE( imagePixels(img) == imagePixels(expected) ) << (doPremult ? "premult" : "unpremult");
+    }
+}
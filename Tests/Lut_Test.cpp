@@ -25,8 +25,10 @@
 #include "Global/Macros.h"
 
 #include <cstdlib>
+#include <vector>
 #include <gtest/gtest.h>
 #include "Engine/Lut.h"
+#include "Engine/RectI.h"
 
 NATRON_NAMESPACE_USING
 using namespace NATRON_NAMESPACE::Color;
@@ -51,3 +53,126 @@ TEST(Lut, IntConversions) {
         EXPECT_EQ( i, uint8xxToChar( charToUint8xx(i) ) );
     }
 }
+
+TEST(Lut, LutManager) {
+    const Lut* srgb = LutManager::sRGBLut();
+
+    ASSERT_TRUE(srgb != NULL);
+    EXPECT_EQ( srgb, LutManager::sRGBLut() );
+    EXPECT_NE( srgb, LutManager::Rec709Lut() );
+}
+
+TEST(Lut, Uint8RoundTrip) {
+    const Lut* luts[2] = { LutManager::sRGBLut(), LutManager::Rec709Lut() };
+
+    for (int l = 0; l < 2; ++l) {
+        for (int i = 0; i < 0x100; ++i) {
+            EXPECT_EQ( i, luts[l]->toColorSpaceUint8FromLinearFloatFast( luts[l]->fromColorSpaceUint8ToLinearFloatFast(i) ) );
+        }
+    }
+}
+
+TEST(Lut, Uint16Conversions) {
+    const Lut* lut = LutManager::sRGBLut();
+
+    for (int i = 0; i < 0x10000; ++i) {
+        float f = lut->fromColorSpaceUint16ToLinearFloatFast(i);
+        EXPECT_NEAR( from_func_srgb( intToFloat<65536>(i) ), f, 1e-6 );
+        // the linear to 16-bit conversion is interpolated from the 8-bit table
+        EXPECT_NEAR( i, lut->toColorSpaceUint16FromLinearFloatFast(f), 4 );
+    }
+}
+
+TEST(Lut, ShortPacked) {
+    const Lut* lut = LutManager::sRGBLut();
+    const int w = 5, h = 3;
+    RectI bounds(0, 0, w, h);
+    std::vector<unsigned short> src(w * h * 4);
+
+    for (std::size_t i = 0; i < src.size(); ++i) {
+        src[i] = (unsigned short)( (i * 4099) & 0xffff );
+    }
+
+    std::vector<float> lin(w * h * 4);
+    lut->from_short_packed(&lin[0], &src[0], bounds, bounds, bounds, ePixelPackingRGBA, ePixelPackingRGBA, false, false);
+    for (std::size_t i = 0; i < src.size(); ++i) {
+        if (i % 4 == 3) {
+            EXPECT_EQ( intToFloat<65536>(src[i]), lin[i] );
+        } else {
+            EXPECT_EQ( lut->fromColorSpaceUint16ToLinearFloatFast(src[i]), lin[i] );
+        }
+    }
+
+    // to_short_packed writes the rows bottom-up, and an opaque alpha when not premultiplying
+    std::vector<unsigned short> back(w * h * 4);
+    lut->to_short_packed(&back[0], &lin[0], bounds, bounds, bounds, ePixelPackingRGBA, ePixelPackingRGBA, false, false);
+    for (int y = 0; y < h; ++y) {
+        for (int x = 0; x < w * 4; ++x) {
+            int srcIndex = y * w * 4 + x;
+            int dstIndex = (h - y - 1) * w * 4 + x;
+            if (x % 4 == 3) {
+                EXPECT_EQ( 0xffff, back[dstIndex] );
+            } else {
+                EXPECT_NEAR( src[srcIndex], back[dstIndex], 4 );
+            }
+        }
+    }
+
+    std::vector<float> planar(w);
+    std::vector<unsigned short> planarBack(w);
+    lut->from_short_planar(&planar[0], &src[0], w);
+    lut->to_short_planar(&planarBack[0], &planar[0], w);
+    for (int x = 0; x < w; ++x) {
+        EXPECT_EQ( lut->fromColorSpaceUint16ToLinearFloatFast(src[x]), planar[x] );
+        EXPECT_NEAR( src[x], planarBack[x], 4 );
+    }
+}
+
+TEST(Lut, LinearRows) {
+    // odd sizes, so that both the vectorized loops and their remainders are exercised
+    const int n = 37;
+    unsigned char bytes[n];
+    unsigned short shorts[n];
+
+    for (int i = 0; i < n; ++i) {
+        bytes[i] = (unsigned char)(i * 7);
+        shorts[i] = (unsigned short)(i * 1771);
+    }
+    float out[n];
+    Linear::from_byte_planar(out, bytes, n);
+    for (int i = 0; i < n; ++i) {
+        EXPECT_EQ( intToFloat<256>(bytes[i]), out[i] );
+    }
+    Linear::from_short_planar(out, shorts, n);
+    for (int i = 0; i < n; ++i) {
+        EXPECT_EQ( intToFloat<65536>(shorts[i]), out[i] );
+    }
+
+    // convert only a portion of a packed image: the other pixels must be left untouched
+    const int w = 9, h = 2;
+    RectI bounds(0, 0, w, h);
+    RectI rect(1, 0, w - 1, h);
+    std::vector<unsigned char> src8(w * h * 4);
+    std::vector<unsigned short> src16(w * h * 4);
+    std::vector<float> srcf(w * h * 4);
+    for (std::size_t i = 0; i < src8.size(); ++i) {
+        src8[i] = (unsigned char)(i * 13);
+        src16[i] = (unsigned short)(i * 2741);
+        srcf[i] = i / 10.f;
+    }
+    std::vector<float> dst8(w * h * 4, -1.f), dst16(w * h * 4, -1.f), dstf(w * h * 4, -1.f);
+    Linear::from_byte_packed(&dst8[0], &src8[0], rect, bounds, bounds, ePixelPackingRGBA, ePixelPackingRGBA, false);
+    Linear::from_short_packed(&dst16[0], &src16[0], rect, bounds, bounds, ePixelPackingRGBA, ePixelPackingRGBA, false);
+    Linear::from_float_packed(&dstf[0], &srcf[0], rect, bounds, bounds, ePixelPackingRGBA, ePixelPackingRGBA, false);
+    for (int y = 0; y < h; ++y) {
+        for (int x = 0; x < w; ++x) {
+            bool inside = x >= rect.x1 && x < rect.x2;
+            for (int c = 0; c < 4; ++c) {
+                int i = (y * w + x) * 4 + c;
+                EXPECT_EQ( inside ? intToFloat<256>(src8[i]) : -1.f, dst8[i] );
+                EXPECT_EQ( inside ? intToFloat<65536>(src16[i]) : -1.f, dst16[i] );
+                EXPECT_EQ( inside ? srcf[i] : -1.f, dstf[i] );
+            }
+        }
+    }
+}
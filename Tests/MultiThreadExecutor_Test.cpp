@@ -0,0 +1,277 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <http://www.natron.fr/>,
+ * Copyright (C) 2016 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "Global/Macros.h"
+
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <QtCore/QAtomicInt>
+#include <QtCore/QMutex>
+#include <QtCore/QMutexLocker>
+#include <QtCore/QThread>
+
+#include "Engine/MultiThreadExecutor.h"
+
+NATRON_NAMESPACE_USING
+
+namespace {
+// Counts how many times each index ran and on which threads
+class CountingJob
+    : public MultiThreadJob
+{
+public:
+
+    QMutex mutex;
+    std::vector<int> nRuns;
+    std::vector<QThread*> threads;
+    QThread* caller;
+    int nEnter, nLeave;
+    bool enterInCaller;
+    bool spawnerIsCaller;
+    unsigned int sleepMs;
+
+    CountingJob(unsigned int count,
+                unsigned int sleepMs = 0)
+        : MultiThreadJob()
+        , mutex()
+        , nRuns(count, 0)
+        , threads(count, (QThread*)0)
+        , caller( QThread::currentThread() )
+        , nEnter(0)
+        , nLeave(0)
+        , enterInCaller(false)
+        , spawnerIsCaller(true)
+        , sleepMs(sleepMs)
+    {
+    }
+
+    virtual void runIndex(unsigned int index,
+                          unsigned int /*count*/) OVERRIDE FINAL
+    {
+        if (sleepMs > 0) {
+            QThread::msleep(sleepMs);
+        }
+        QMutexLocker k(&mutex);
+
+        ++nRuns[index];
+        threads[index] = QThread::currentThread();
+    }
+
+    virtual void onHelperEnter(QThread* spawnerThread) OVERRIDE FINAL
+    {
+        QMutexLocker k(&mutex);
+
+        ++nEnter;
+        enterInCaller |= QThread::currentThread() == caller;
+        spawnerIsCaller &= spawnerThread == caller;
+    }
+
+    virtual void onHelperLeave() OVERRIDE FINAL
+    {
+        QMutexLocker k(&mutex);
+
+        ++nLeave;
+    }
+};
+
+// Each index runs an inner loop on the same executor
+class NestedJob
+    : public MultiThreadJob
+{
+    MultiThreadExecutor* _executor;
+    unsigned int _innerCount;
+
+public:
+
+    QAtomicInt nInnerRuns;
+
+    NestedJob(MultiThreadExecutor* executor,
+              unsigned int innerCount)
+        : MultiThreadJob()
+        , _executor(executor)
+        , _innerCount(innerCount)
+        , nInnerRuns(0)
+    {
+    }
+
+    virtual void runIndex(unsigned int /*index*/,
+                          unsigned int /*count*/) OVERRIDE FINAL
+    {
+        CountingJob inner(_innerCount);
+
+        _executor->run(inner, _innerCount, _innerCount);
+        for (unsigned int i = 0; i < _innerCount; ++i) {
+            nInnerRuns.fetchAndAddRelaxed(inner.nRuns[i]);
+        }
+    }
+};
+// Runs a nested loop from its own thread
+class NestedCaller
+    : public QThread
+{
+    MultiThreadExecutor* _executor;
+    unsigned int _outerCount;
+
+public:
+
+    NestedJob job;
+
+    NestedCaller(MultiThreadExecutor* executor,
+                 unsigned int outerCount,
+                 unsigned int innerCount)
+        : QThread()
+        , _executor(executor)
+        , _outerCount(outerCount)
+        , job(executor, innerCount)
+    {
+    }
+
+private:
+
+    virtual void run() OVERRIDE FINAL
+    {
+        _executor->run(job, _outerCount, _outerCount);
+    }
+};
+} // anon
+
+TEST(MultiThreadExecutor, EachIndexRunsOnce)
+{
+    MultiThreadExecutor executor(4);
+    const unsigned int count = 64;
+    CountingJob job(count);
+
+    executor.run(job, count, count);
+    for (unsigned int i = 0; i < count; ++i) {
+        EXPECT_EQ(1, job.nRuns[i]);
+    }
+
+    // Workers are only ever entered through onHelperEnter and leave through onHelperLeave
+    EXPECT_EQ(job.nEnter, job.nLeave);
+    EXPECT_FALSE(job.enterInCaller);
+    EXPECT_TRUE(job.spawnerIsCaller);
+    EXPECT_LE( executor.getNumWorkers(), executor.getMaxWorkers() );
+
+    // Nothing to do
+    executor.run(job, 0, count);
+}
+
+TEST(MultiThreadExecutor, CallerParticipates)
+{
+    MultiThreadExecutor executor(4);
+    const unsigned int count = 8;
+
+    // Without concurrency the calling thread runs all the indices and no worker is started
+    CountingJob serial(count);
+    executor.run(serial, count, 1);
+    for (unsigned int i = 0; i < count; ++i) {
+        EXPECT_EQ(1, serial.nRuns[i]);
+        EXPECT_EQ(serial.caller, serial.threads[i]);
+    }
+    EXPECT_EQ(0, serial.nEnter);
+    EXPECT_EQ(0, executor.getNumWorkers());
+
+    // The first index is always run by the calling thread
+    CountingJob job(count, 10);
+    executor.run(job, count, count);
+    EXPECT_EQ(job.caller, job.threads[0]);
+    EXPECT_EQ(job.nEnter, job.nLeave);
+    EXPECT_GT(job.nEnter, 0);
+}
+
+TEST(MultiThreadExecutor, WorkersArePersistent)
+{
+    MultiThreadExecutor executor(2);
+    const unsigned int count = 16;
+
+    for (int i = 0; i < 8; ++i) {
+        CountingJob job(count, 1);
+        executor.run(job, count, count);
+        for (unsigned int j = 0; j < count; ++j) {
+            EXPECT_EQ(1, job.nRuns[j]);
+        }
+        EXPECT_LE( executor.getNumWorkers(), 2 );
+    }
+}
+
+TEST(MultiThreadExecutor, WorkersExpireWhenIdle)
+{
+    MultiThreadExecutor executor(2, 50);
+    const unsigned int count = 8;
+
+    CountingJob first(count, 10);
+    executor.run(first, count, count);
+    EXPECT_GT(first.nEnter, 0);
+    EXPECT_GT(executor.getNumWorkers(), 0);
+
+    // Idle workers exit after the expiry delay
+    for (int i = 0; i < 100 && executor.getNumWorkers() > 0; ++i) {
+        QThread::msleep(10);
+    }
+    EXPECT_EQ(0, executor.getNumWorkers());
+
+    // Workers are started again for the next loop
+    CountingJob second(count, 10);
+    executor.run(second, count, count);
+    for (unsigned int i = 0; i < count; ++i) {
+        EXPECT_EQ(1, second.nRuns[i]);
+    }
+    EXPECT_GT(second.nEnter, 0);
+    EXPECT_LE( executor.getNumWorkers(), 2 );
+}
+
+TEST(MultiThreadExecutor, NestedDoesNotDeadlock)
+{
+    // A single worker: the inner loops can only complete if the threads running them run their indices themselves
+    MultiThreadExecutor executor(1);
+    const unsigned int outerCount = 8;
+    const unsigned int innerCount = 8;
+    NestedJob job(&executor, innerCount);
+
+    executor.run(job, outerCount, outerCount);
+    EXPECT_EQ( (int)(outerCount * innerCount), (int)job.nInnerRuns );
+    EXPECT_LE( executor.getNumWorkers(), 1 );
+}
+
+TEST(MultiThreadExecutor, ConcurrentCallers)
+{
+    MultiThreadExecutor executor(3);
+    const int nThreads = 4;
+    const unsigned int outerCount = 4;
+    const unsigned int innerCount = 16;
+
+    std::vector<NestedCaller*> callers(nThreads);
+    for (int i = 0; i < nThreads; ++i) {
+        callers[i] = new NestedCaller(&executor, outerCount, innerCount);
+        callers[i]->start();
+    }
+    for (int i = 0; i < nThreads; ++i) {
+        callers[i]->wait();
+        EXPECT_EQ( (int)(outerCount * innerCount), (int)callers[i]->job.nInnerRuns );
+        delete callers[i];
+    }
+    EXPECT_LE( executor.getNumWorkers(), 3 );
+}
@@ -0,0 +1,156 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <http://www.natron.fr/>,
+ * Copyright (C) 2016 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "Global/Macros.h"
+
+#include <gtest/gtest.h>
+
+#include "Engine/PlaybackController.h"
+
+NATRON_NAMESPACE_USING
+
+// Displays one frame every interval seconds from start (included) to end (excluded), dropping nbDroppedFrames after each.
+// Returns the time of the next frame.
+static double
+displayFrames(PlaybackController& playback,
+              double start,
+              double end,
+              double interval,
+              int nbDroppedFrames)
+{
+    double t = start;
+
+    for (; t < end; t += interval) {
+        playback.notifyFrameDisplayed(t, nbDroppedFrames, 1);
+    }
+
+    return t;
+}
+
+TEST(PlaybackController,
+     RenderAhead)
+{
+    PlaybackController playback;
+
+    playback.reset(25., false, 0);
+
+    // Without any measure, each render thread has 2 frames queued
+    EXPECT_EQ( 8, playback.getRenderAheadCount(4, 24) );
+
+    // A frame taking 0.5s to render must start 12.5 frames ahead at 25fps
+    playback.notifyFrameRenderCost(0.5, 0);
+    EXPECT_DOUBLE_EQ( 0.5, playback.getAverageFrameRenderCost() );
+    EXPECT_EQ( 13, playback.getRenderAheadCount(4, 24) );
+    EXPECT_EQ( 10, playback.getRenderAheadCount(4, 10) );
+
+    // Fast renders still keep every thread busy
+    playback.reset(25., false, 0);
+    playback.notifyFrameRenderCost(0.001, 0);
+    EXPECT_EQ( 4, playback.getRenderAheadCount(4, 24) );
+
+    // Measures are averaged
+    playback.notifyFrameRenderCost(0.011, 0);
+    EXPECT_GT(playback.getAverageFrameRenderCost(), 0.001);
+    EXPECT_LT(playback.getAverageFrameRenderCost(), 0.011);
+}
+
+TEST(PlaybackController,
+     NoDropsWithoutRealTime)
+{
+    PlaybackController playback;
+
+    playback.reset(25., false, 3);
+    playback.notifyFrameDisplayed(0., 0, 1);
+    EXPECT_EQ( 0, playback.getNbFramesToDrop(0.5) );
+    displayFrames(playback, 0.5, 3., 0.5, 0);
+    EXPECT_EQ( 0u, playback.getMipMapLevelOffset() );
+}
+
+TEST(PlaybackController,
+     DropsLateFrames)
+{
+    PlaybackController playback;
+
+    playback.reset(25., true, 2);
+
+    // The clock starts with the first frame displayed
+    EXPECT_EQ( 0, playback.getNbFramesToDrop(10.) );
+    playback.notifyFrameDisplayed(0., 0, 1);
+
+    // The second frame is due at 0.04, it is late by 2 frames at 0.13
+    EXPECT_EQ( 0, playback.getNbFramesToDrop(0.05) );
+    EXPECT_EQ( 2, playback.getNbFramesToDrop(0.13) );
+    playback.notifyFrameDisplayed(0.13, 2, 1);
+    EXPECT_EQ( 2, playback.getNbDroppedFrames() );
+
+    // The fifth frame is due at 0.16
+    EXPECT_EQ( 0, playback.getNbFramesToDrop(0.17) );
+
+    // After a stall, the clock restarts instead of dropping frames
+    EXPECT_EQ( 0, playback.getNbFramesToDrop(5.) );
+    playback.notifyFrameDisplayed(5., 0, 1);
+    EXPECT_EQ( 0, playback.getNbFramesToDrop(5.05) );
+    EXPECT_EQ( 1, playback.getNbFramesToDrop(5.09) );
+
+    // Changing the frame rate restarts the clock
+    playback.setDesiredFrameRate(10.);
+    EXPECT_EQ( 0, playback.getNbFramesToDrop(5.5) );
+    playback.notifyFrameDisplayed(5.5, 0, 1);
+    EXPECT_EQ( 0, playback.getNbFramesToDrop(5.65) );
+    EXPECT_EQ( 1, playback.getNbFramesToDrop(5.75) );
+}
+
+TEST(PlaybackController,
+     AdaptsResolution)
+{
+    PlaybackController playback;
+
+    playback.reset(25., true, 2);
+    playback.notifyFrameRenderCost(0.08, 0);
+
+    // Every other frame is dropped: the resolution is lowered once per second, down to the maximum offset
+    double t = displayFrames(playback, 0., 1.05, 0.08, 1);
+    EXPECT_EQ( 1u, playback.getMipMapLevelOffset() );
+    EXPECT_DOUBLE_EQ( 0., playback.getAverageFrameRenderCost() );
+
+    // Measures at the previous level are ignored
+    playback.notifyFrameRenderCost(0.08, 0);
+    EXPECT_DOUBLE_EQ( 0., playback.getAverageFrameRenderCost() );
+
+    t = displayFrames(playback, t, 3.05, 0.08, 1);
+    EXPECT_EQ( 2u, playback.getMipMapLevelOffset() );
+
+    // Frames are on time but would not be at the higher level: keep the resolution
+    playback.notifyFrameRenderCost(0.03, 2);
+    t = displayFrames(playback, t, 4.2, 0.04, 0);
+    EXPECT_EQ( 2u, playback.getMipMapLevelOffset() );
+
+    // Frames render fast enough to be on time at the higher level: raise the resolution
+    playback.reset(25., true, 2);
+    displayFrames(playback, 0., 1.05, 0.08, 1);
+    ASSERT_EQ( 1u, playback.getMipMapLevelOffset() );
+    playback.notifyFrameRenderCost(0.005, 1);
+    displayFrames(playback, 1.12, 2.2, 0.04, 0);
+    EXPECT_EQ( 0u, playback.getMipMapLevelOffset() );
+}
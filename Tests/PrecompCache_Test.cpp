@@ -0,0 +1,177 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <http://www.natron.fr/>,
+ * Copyright (C) 2016 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "Global/Macros.h"
+
+#include <gtest/gtest.h>
+
+#include <QtCore/QDir>
+#include <QtCore/QFile>
+#include <QtCore/QString>
+
+#include "Engine/PrecompCache.h"
+#include "Engine/StandardPaths.h"
+
+NATRON_NAMESPACE_USING
+
+static QDir
+getTestDir()
+{
+    QDir dir( StandardPaths::writableLocation(StandardPaths::eStandardLocationTemp) );
+
+    dir.mkpath( QString::fromUtf8("NatronPrecompCacheTest") );
+    dir.cd( QString::fromUtf8("NatronPrecompCacheTest") );
+
+    return dir;
+}
+
+static void
+writeFile(const QString& path,
+          const char* content)
+{
+    QFile file(path);
+
+    file.open(QIODevice::WriteOnly | QIODevice::Truncate);
+    file.write(content);
+}
+
+TEST(PrecompCache,
+     EntryFilePath)
+{
+    QString cacheDir = getTestDir().absolutePath();
+    QString path = PrecompCache::getEntryFilePath(cacheDir, "/projects/precomp.ntp", "Write1", 1, 10);
+
+    EXPECT_TRUE( path.startsWith(cacheDir) );
+    EXPECT_EQ( path, PrecompCache::getEntryFilePath(cacheDir, "/projects/precomp.ntp", "Write1", 1, 10) );
+    EXPECT_NE( path, PrecompCache::getEntryFilePath(cacheDir, "/projects/precomp.ntp", "Write2", 1, 10) );
+    EXPECT_NE( path, PrecompCache::getEntryFilePath(cacheDir, "/projects/precomp.ntp", "Write1", 1, 11) );
+    EXPECT_NE( path, PrecompCache::getEntryFilePath(cacheDir, "/projects/other.ntp", "Write1", 1, 10) );
+}
+
+TEST(PrecompCache,
+     EntryRoundTrip)
+{
+    QDir dir = getTestDir();
+    PrecompCacheEntry entry;
+
+    entry.projectHash = 0xFEDCBA9876543210ULL;
+    entry.treeHash = 42;
+    entry.writeNodeName = "Group1.Write 1";
+    entry.firstFrame = -5;
+    entry.lastFrame = 20;
+    entry.filePattern = "/renders/my shot/out_####.exr";
+    PrecompCacheFile f;
+    f.path = "/renders/my shot/out_0001.exr";
+    f.size = 123456789012LL;
+    f.modificationTime = 1476000000000LL;
+    entry.renderedFiles.push_back(f);
+    f.path = "/projects/nested precomp.ntp";
+    f.contentHash = 0x8000000000000001ULL;
+    entry.dependencies.push_back(f);
+
+    QString entryFilePath = dir.absoluteFilePath( QString::fromUtf8("entry.txt") );
+    ASSERT_TRUE( PrecompCache::writeEntry(entryFilePath, entry) );
+
+    PrecompCacheEntry read;
+    ASSERT_TRUE( PrecompCache::readEntry(entryFilePath, &read) );
+    EXPECT_EQ(entry.projectHash, read.projectHash);
+    EXPECT_EQ(entry.treeHash, read.treeHash);
+    EXPECT_EQ(entry.writeNodeName, read.writeNodeName);
+    EXPECT_EQ(entry.firstFrame, read.firstFrame);
+    EXPECT_EQ(entry.lastFrame, read.lastFrame);
+    EXPECT_EQ(entry.filePattern, read.filePattern);
+    ASSERT_EQ( 1, (int)read.renderedFiles.size() );
+    EXPECT_EQ(entry.renderedFiles.front().path, read.renderedFiles.front().path);
+    EXPECT_EQ(entry.renderedFiles.front().size, read.renderedFiles.front().size);
+    EXPECT_EQ(entry.renderedFiles.front().modificationTime, read.renderedFiles.front().modificationTime);
+    ASSERT_EQ( 1, (int)read.dependencies.size() );
+    EXPECT_EQ(entry.dependencies.front().path, read.dependencies.front().path);
+    EXPECT_EQ(entry.dependencies.front().contentHash, read.dependencies.front().contentHash);
+
+    // Entries of another format are ignored
+    writeFile(entryFilePath, "something else\n");
+    EXPECT_FALSE( PrecompCache::readEntry(entryFilePath, &read) );
+    QFile::remove(entryFilePath);
+    EXPECT_FALSE( PrecompCache::readEntry(entryFilePath, &read) );
+}
+
+TEST(PrecompCache,
+     UpToDate)
+{
+    QDir dir = getTestDir();
+    QString projectPath = dir.absoluteFilePath( QString::fromUtf8("precomp.ntp") );
+    QString nestedPath = dir.absoluteFilePath( QString::fromUtf8("nested.ntp") );
+
+    writeFile(projectPath, "<project/>");
+    writeFile(nestedPath, "<nested/>");
+    for (int i = 1; i <= 3; ++i) {
+        writeFile(dir.absoluteFilePath( QString::fromUtf8("out_%1.unittest").arg(i) ), "image");
+    }
+
+    U64 projectHash, otherHash;
+    ASSERT_TRUE( PrecompCache::hashFile(projectPath.toStdString(), &projectHash) );
+    ASSERT_TRUE( PrecompCache::hashFile(nestedPath.toStdString(), &otherHash) );
+    EXPECT_NE(projectHash, otherHash);
+
+    PrecompCacheEntry entry;
+    entry.projectHash = projectHash;
+    entry.filePattern = dir.absoluteFilePath( QString::fromUtf8("out_#.unittest") ).toStdString();
+    std::vector<std::string> views;
+    views.push_back("Main");
+
+    // A frame was not rendered
+    entry.firstFrame = 1;
+    entry.lastFrame = 4;
+    EXPECT_FALSE( PrecompCache::setRenderedFiles(views, &entry) );
+
+    entry.lastFrame = 3;
+    ASSERT_TRUE( PrecompCache::setRenderedFiles(views, &entry) );
+    EXPECT_EQ( 3, (int)entry.renderedFiles.size() );
+
+    PrecompCacheFile nested;
+    nested.path = nestedPath.toStdString();
+    ASSERT_TRUE( PrecompCache::statFile(true, &nested) );
+    entry.dependencies.push_back(nested);
+
+    EXPECT_TRUE( PrecompCache::isEntryUpToDate(entry, projectHash) );
+    EXPECT_FALSE( PrecompCache::isEntryUpToDate(entry, otherHash) );
+
+    // A nested pre-comp changed
+    writeFile(nestedPath, "<nested changed/>");
+    EXPECT_FALSE( PrecompCache::isEntryUpToDate(entry, projectHash) );
+    EXPECT_TRUE( PrecompCache::areRenderedFilesUpToDate(entry) );
+    writeFile(nestedPath, "<nested/>");
+    EXPECT_TRUE( PrecompCache::isEntryUpToDate(entry, projectHash) );
+
+    // An image was rendered again
+    writeFile( dir.absoluteFilePath( QString::fromUtf8("out_2.unittest") ), "another image" );
+    EXPECT_FALSE( PrecompCache::areRenderedFilesUpToDate(entry) );
+    EXPECT_FALSE( PrecompCache::isEntryUpToDate(entry, projectHash) );
+
+    QFile::remove(projectPath);
+    QFile::remove(nestedPath);
+    for (int i = 1; i <= 3; ++i) {
+        QFile::remove( dir.absoluteFilePath( QString::fromUtf8("out_%1.unittest").arg(i) ) );
+    }
+}
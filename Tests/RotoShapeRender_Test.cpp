@@ -0,0 +1,237 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <http://www.natron.fr/>,
+ * Copyright (C) 2016 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "Global/Macros.h"
+
+#include <cmath>
+#include <vector>
+#include <gtest/gtest.h>
+
+#ifdef ROTO_SHAPE_RENDER_ENABLE_CAIRO
+#include <cairo/cairo.h>
+#endif
+
+#include "Engine/RectI.h"
+#include "Engine/RotoBezierTriangulation.h"
+#include "Engine/RotoShapeRenderCPU.h"
+#ifdef ROTO_SHAPE_RENDER_ENABLE_CAIRO
+#include "Engine/RotoShapeRenderCairo.h"
+#endif
+
+#ifndef M_PI
+#define M_PI        3.14159265358979323846264338327950288   /* pi             */
+#endif
+
+NATRON_NAMESPACE_USING
+
+// Make a regular polygon, triangulated as a single fan, with a feather of the given width around it
+static void
+makeFeatheredPolygon(double cx,
+                     double cy,
+                     double radius,
+                     double feather,
+                     int nVertices,
+                     RotoBezierTriangulation::PolygonData* data)
+{
+    RotoBezierTriangulation::RotoTriangleFans fan;
+
+    for (int i = 0; i < nVertices; ++i) {
+        double a = 2. * M_PI * i / nVertices;
+        ParametricPoint p;
+        p.x = cx + radius * std::cos(a);
+        p.y = cy + radius * std::sin(a);
+        p.t = 0.;
+        data->bezierPolygonJoined.push_back(p);
+        fan.indices.push_back(i);
+    }
+    data->internalFans.push_back(fan);
+
+    for (int i = 0; i < nVertices; ++i) {
+        double a = 2. * M_PI * i / nVertices;
+        double b = 2. * M_PI * (i + 1) / nVertices;
+        RotoBezierTriangulation::RotoFeatherVertex innerA = { cx + radius * std::cos(a), cy + radius * std::sin(a), true };
+        RotoBezierTriangulation::RotoFeatherVertex outerA = { cx + (radius + feather) * std::cos(a), cy + (radius + feather) * std::sin(a), false };
+        RotoBezierTriangulation::RotoFeatherVertex innerB = { cx + radius * std::cos(b), cy + radius * std::sin(b), true };
+        RotoBezierTriangulation::RotoFeatherVertex outerB = { cx + (radius + feather) * std::cos(b), cy + (radius + feather) * std::sin(b), false };
+        data->featherMesh.push_back(innerA);
+        data->featherMesh.push_back(outerA);
+        data->featherMesh.push_back(innerB);
+        data->featherMesh.push_back(outerA);
+        data->featherMesh.push_back(outerB);
+        data->featherMesh.push_back(innerB);
+    }
+}
+
+TEST(RotoShapeRenderCPU, AnalyticCoverage)
+{
+    // An axis-aligned rectangle with fractional edges: the coverage of each pixel is the area of the
+    // pixel inside the rectangle
+    RotoBezierTriangulation::PolygonData data;
+    const double corners[4][2] = { {10.25, 10.5}, {20.75, 10.5}, {20.75, 30.}, {10.25, 30.} };
+    RotoBezierTriangulation::RotoTriangleFans fan;
+
+    for (int i = 0; i < 4; ++i) {
+        ParametricPoint p;
+        p.x = corners[i][0];
+        p.y = corners[i][1];
+        p.t = 0.;
+        data.bezierPolygonJoined.push_back(p);
+        fan.indices.push_back(i);
+    }
+    data.internalFans.push_back(fan);
+
+    RectI roi(0, 0, 40, 40);
+    std::vector<float> coverage( roi.area() );
+    RotoShapeRenderCPU::renderCoverage_cpu(data, 1., eRampTypeLinear, roi, &coverage[0]);
+
+    double sum = 0.;
+    for (std::size_t i = 0; i < coverage.size(); ++i) {
+        sum += coverage[i];
+    }
+    EXPECT_NEAR(10.5 * 19.5, sum, 1e-3);
+    EXPECT_NEAR(0.75, coverage[15 * 40 + 10], 1e-5);
+    EXPECT_NEAR(1., coverage[15 * 40 + 11], 1e-5);
+    EXPECT_NEAR(0.75, coverage[15 * 40 + 20], 1e-5);
+    EXPECT_NEAR(0.5, coverage[10 * 40 + 15], 1e-5);
+    EXPECT_NEAR(0.375, coverage[10 * 40 + 10], 1e-5);
+    EXPECT_NEAR(0., coverage[30 * 40 + 15], 1e-5);
+
+    // A RoI crossing the right edge of the shape must give the same coverage as the full render
+    RectI subRoi(15, 5, 23, 35);
+    std::vector<float> subCoverage( subRoi.area() );
+    RotoShapeRenderCPU::renderCoverage_cpu(data, 1., eRampTypeLinear, subRoi, &subCoverage[0]);
+    for (int y = subRoi.y1; y < subRoi.y2; ++y) {
+        for (int x = subRoi.x1; x < subRoi.x2; ++x) {
+            EXPECT_NEAR(coverage[y * 40 + x], subCoverage[(y - subRoi.y1) * subRoi.width() + (x - subRoi.x1)], 1e-5);
+        }
+    }
+}
+
+TEST(RotoShapeRenderCPU, FeatherRamp)
+{
+    RotoBezierTriangulation::PolygonData data;
+
+    makeFeatheredPolygon(64., 64., 40., 16., 128, &data);
+
+    RectI roi(0, 0, 128, 128);
+    std::vector<float> coverage( roi.area() );
+    RotoShapeRenderCPU::renderCoverage_cpu(data, 1., eRampTypeLinear, roi, &coverage[0]);
+
+    // Inside the shape, coverage is full; outside of the feather it is zero and it decreases in between
+    EXPECT_NEAR(1., coverage[64 * 128 + 64], 1e-5);
+    EXPECT_NEAR(0., coverage[64 * 128 + 127], 1e-5);
+    float prev = 1.f;
+    for (int x = 64 + 41; x < 64 + 56; ++x) {
+        float c = coverage[64 * 128 + x];
+        EXPECT_LE(c, prev);
+        prev = c;
+    }
+    // Halfway through the feather, a linear ramp gives half the coverage
+    EXPECT_NEAR(0.5, coverage[64 * 128 + 64 + 48], 0.05);
+}
+
+TEST(RotoShapeRenderCPU, FeatherFallOff)
+{
+    // Cairo renders each feather triangle as a patch whose sides are cubic curves with control points at a and b
+    // along the side, and interpolates the alpha along the curve parameter u: the alpha at a distance
+    // s = B(u) into the feather is 1 - u
+    const double fallOff = 2.;
+    const double a = 1. / (2. * fallOff * fallOff + 1.);
+    const double b = 2. / (fallOff * fallOff + 2.);
+    RotoBezierTriangulation::PolygonData data;
+
+    makeFeatheredPolygon(64., 64., 40., 16., 128, &data);
+
+    RectI roi(0, 0, 128, 128);
+    std::vector<float> coverage( roi.area() );
+    RotoShapeRenderCPU::renderCoverage_cpu(data, fallOff, eRampTypeLinear, roi, &coverage[0]);
+
+    for (int x = 64 + 41; x < 64 + 56; ++x) {
+        double r = std::sqrt( (x + 0.5 - 64.) * (x + 0.5 - 64.) + 0.25 );
+        double s = (r - 40.) / 16.;
+        double u0 = 0., u1 = 1.;
+        for (int i = 0; i < 40; ++i) {
+            double u = 0.5 * (u0 + u1);
+            double bu = 3. * a * u * (1. - u) * (1. - u) + 3. * b * u * u * (1. - u) + u * u * u;
+            if (bu < s) {
+                u0 = u;
+            } else {
+                u1 = u;
+            }
+        }
+        EXPECT_NEAR(1. - u0, coverage[64 * 128 + x], 0.01);
+    }
+}
+
+#ifdef ROTO_SHAPE_RENDER_ENABLE_CAIRO
+// Visual diff against the triangle-based Cairo renderer which uses the same triangulation
+TEST(RotoShapeRenderCPU, MatchesCairo)
+{
+    RotoBezierTriangulation::PolygonData data;
+
+    makeFeatheredPolygon(100.3, 95.7, 60., 20., 96, &data);
+
+    RectI roi(10, 5, 190, 185);
+    const double fallOffs[2] = { 1., 2. };
+    for (int f = 0; f < 2; ++f) {
+        std::vector<float> coverage( roi.area() );
+        RotoShapeRenderCPU::renderCoverage_cpu(data, fallOffs[f], eRampTypeLinear, roi, &coverage[0]);
+
+        cairo_surface_t* surface = cairo_image_surface_create( CAIRO_FORMAT_A8, roi.width(), roi.height() );
+        ASSERT_EQ(CAIRO_STATUS_SUCCESS, cairo_surface_status(surface));
+        cairo_surface_set_device_offset(surface, -roi.x1, -roi.y1);
+        cairo_t* cr = cairo_create(surface);
+        cairo_set_antialias(cr, CAIRO_ANTIALIAS_NONE);
+        cairo_set_operator(cr, CAIRO_OPERATOR_OVER);
+        cairo_pattern_t* mesh = cairo_pattern_create_mesh();
+        double shapeColor[3] = {1., 1., 1.};
+        RotoShapeRenderCairo::renderFeather_cairo(data, shapeColor, fallOffs[f], mesh);
+        RotoShapeRenderCairo::renderInternalShape_cairo(data, shapeColor, mesh);
+        RotoShapeRenderCairo::applyAndDestroyMask(cr, mesh);
+        cairo_surface_flush(surface);
+
+        const unsigned char* cairoData = cairo_image_surface_get_data(surface);
+        int stride = cairo_image_surface_get_stride(surface);
+        double sumDiff = 0.;
+        int nLargeDiffs = 0;
+        for (int y = 0; y < roi.height(); ++y) {
+            for (int x = 0; x < roi.width(); ++x) {
+                // Cairo uses the mesh as both source and mask, as renderBezier_cpu does, so the pattern alpha is squared
+                float c = coverage[y * roi.width() + x];
+                double diff = std::abs(c * c - cairoData[y * stride + x] / 255.);
+                sumDiff += diff;
+                if (diff > 0.15) {
+                    ++nLargeDiffs;
+                }
+            }
+        }
+        cairo_destroy(cr);
+        cairo_surface_destroy(surface);
+
+        // Cairo does not anti-alias the internal shape, so only the pixels along the edges are allowed to differ
+        EXPECT_LT(sumDiff / roi.area(), 0.02);
+        EXPECT_LT(nLargeDiffs, roi.area() / 50);
+    }
+}
+#endif // ROTO_SHAPE_RENDER_ENABLE_CAIRO
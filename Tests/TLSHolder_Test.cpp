@@ -0,0 +1,139 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <http://www.natron.fr/>,
+ * Copyright (C) 2016 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "Global/Macros.h"
+
+#include <gtest/gtest.h>
+
+#include <boost/shared_ptr.hpp>
+#include <boost/weak_ptr.hpp>
+
+#include <QtCore/QMutex>
+#include <QtCore/QMutexLocker>
+#include <QtCore/QThread>
+#include <QtCore/QWaitCondition>
+
+#include "Engine/AppManager.h"
+#include "Engine/Project.h"
+#include "Engine/TLSHolder.h"
+
+#include "BaseTest.h"
+
+NATRON_NAMESPACE_USING
+
+namespace {
+typedef TLSHolder<Project::ProjectTLSData> ProjectTLSHolder;
+typedef boost::weak_ptr<Project::ProjectTLSData> ProjectTLSDataWPtr;
+
+// Stores a value in the TLS of a holder, then stays alive until it is told to exit
+class TLSValueThread
+    : public QThread
+{
+public:
+
+    TLSValueThread(const ProjectTLSHolder* holder)
+        : QThread()
+        , _holder(holder)
+        , _mutex()
+        , _cond()
+        , _value()
+        , _valueSet(false)
+        , _mustExit(false)
+    {
+    }
+
+    ProjectTLSDataWPtr waitForValue()
+    {
+        QMutexLocker k(&_mutex);
+
+        while (!_valueSet) {
+            _cond.wait(&_mutex);
+        }
+
+        return _value;
+    }
+
+    void quitAndWait()
+    {
+        {
+            QMutexLocker k(&_mutex);
+            _mustExit = true;
+            _cond.wakeAll();
+        }
+        wait();
+    }
+
+private:
+
+    virtual void run() OVERRIDE FINAL
+    {
+        // Only the slot of the holder keeps the value alive
+        ProjectTLSDataWPtr value = _holder->getOrCreateTLSData();
+        {
+            QMutexLocker k(&_mutex);
+            _value = value;
+            _valueSet = true;
+            _cond.wakeAll();
+            while (!_mustExit) {
+                _cond.wait(&_mutex);
+            }
+        }
+        appPTR->getAppTLS()->cleanupTLSForThread();
+    }
+
+    const ProjectTLSHolder* _holder;
+    QMutex _mutex;
+    QWaitCondition _cond;
+    ProjectTLSDataWPtr _value;
+    bool _valueSet;
+    bool _mustExit;
+};
+}
+
+typedef BaseTest TLSHolderTest;
+
+TEST_F(TLSHolderTest, DestroyedHolderReleasesValues)
+{
+    ProjectTLSHolder* holder = new ProjectTLSHolder;
+    ProjectTLSDataWPtr mainValue = holder->getOrCreateTLSData();
+
+    TLSValueThread thread(holder);
+    thread.start();
+    ProjectTLSDataWPtr threadValue = thread.waitForValue();
+
+    EXPECT_FALSE( mainValue.expired() );
+    EXPECT_FALSE( threadValue.expired() );
+
+    delete holder;
+
+    // The thread has not cleaned-up its TLS yet: the holder must have released its value
+    EXPECT_TRUE( mainValue.expired() );
+    EXPECT_TRUE( threadValue.expired() );
+
+    // A holder reusing the slot does not see the values of the destroyed one
+    ProjectTLSHolder newHolder;
+    EXPECT_FALSE( newHolder.getTLSData() );
+
+    thread.quitAndWait();
+}
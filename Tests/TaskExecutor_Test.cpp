@@ -0,0 +1,341 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <http://www.natron.fr/>,
+ * Copyright (C) 2016 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "Global/Macros.h"
+
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <QtCore/QMutex>
+#include <QtCore/QMutexLocker>
+#include <QtCore/QSemaphore>
+#include <QtCore/QThread>
+#include <QtCore/QWaitCondition>
+
+#include "Engine/AbortableRenderInfo.h"
+#include "Engine/TaskExecutor.h"
+
+NATRON_NAMESPACE_USING
+
+namespace {
+// Blocks its worker until released
+struct Gate
+{
+    QMutex mutex;
+    QWaitCondition cond;
+    bool open;
+
+    Gate()
+        : mutex()
+        , cond()
+        , open(false)
+    {
+    }
+
+    void release()
+    {
+        QMutexLocker k(&mutex);
+
+        open = true;
+        cond.wakeAll();
+    }
+
+    void wait()
+    {
+        QMutexLocker k(&mutex);
+
+        while (!open) {
+            cond.wait(&mutex);
+        }
+    }
+};
+
+class BlockingTask
+    : public ExecutorTask
+{
+    Gate* _gate;
+
+public:
+
+    BlockingTask(Gate* gate)
+        : ExecutorTask()
+        , _gate(gate)
+    {
+    }
+
+    virtual void run() OVERRIDE FINAL
+    {
+        _gate->wait();
+    }
+};
+
+// Records how many of its instances run at the same time
+class ConcurrencyTask
+    : public ExecutorTask
+{
+    Gate* _gate;
+    QSemaphore* _started;
+    QAtomicInt* _nRunning;
+    QAtomicInt* _maxRunning;
+
+public:
+
+    ConcurrencyTask(Gate* gate,
+                    QSemaphore* started,
+                    QAtomicInt* nRunning,
+                    QAtomicInt* maxRunning)
+        : ExecutorTask()
+        , _gate(gate)
+        , _started(started)
+        , _nRunning(nRunning)
+        , _maxRunning(maxRunning)
+    {
+    }
+
+    virtual void run() OVERRIDE FINAL
+    {
+        int n = _nRunning->fetchAndAddOrdered(1) + 1;
+        int maxN = *_maxRunning;
+
+        while ( n > maxN && !_maxRunning->testAndSetOrdered(maxN, n) ) {
+            maxN = *_maxRunning;
+        }
+        _started->release();
+        _gate->wait();
+        _nRunning->fetchAndAddOrdered(-1);
+    }
+};
+
+// Records the order in which tasks run
+struct Recorder
+{
+    QMutex mutex;
+    std::vector<int> order;
+    int nDropped;
+
+    Recorder()
+        : mutex()
+        , order()
+        , nDropped(0)
+    {
+    }
+};
+
+class RecordingTask
+    : public ExecutorTask
+{
+    Recorder* _recorder;
+    int _id;
+
+public:
+
+    RecordingTask(Recorder* recorder,
+                  int id,
+                  const AbortableRenderInfoPtr& abortInfo = AbortableRenderInfoPtr())
+        : ExecutorTask(abortInfo)
+        , _recorder(recorder)
+        , _id(id)
+    {
+    }
+
+    virtual void run() OVERRIDE FINAL
+    {
+        QMutexLocker k(&_recorder->mutex);
+
+        _recorder->order.push_back(_id);
+    }
+
+    virtual void onDropped() OVERRIDE FINAL
+    {
+        QMutexLocker k(&_recorder->mutex);
+
+        ++_recorder->nDropped;
+    }
+};
+
+void
+waitForRunningTasks(const TaskExecutor& executor,
+                    TaskPriorityEnum priority,
+                    int nTasks)
+{
+    while (executor.getNumRunningTasks(priority) < nTasks) {
+        QThread::yieldCurrentThread();
+    }
+}
+} // anon
+
+TEST(TaskExecutor, RunsByPriority)
+{
+    TaskExecutor executor(1);
+    Gate gate;
+    Recorder recorder;
+
+    ASSERT_TRUE( executor.submit( eTaskPriorityInteractive, ExecutorTaskPtr( new BlockingTask(&gate) ) ) );
+    waitForRunningTasks(executor, eTaskPriorityInteractive, 1);
+
+    executor.submit( eTaskPriorityPreview, ExecutorTaskPtr( new RecordingTask(&recorder, eTaskPriorityPreview) ) );
+    executor.submit( eTaskPriorityInteractive, ExecutorTaskPtr( new RecordingTask(&recorder, eTaskPriorityInteractive) ) );
+    executor.submit( eTaskPriorityCacheDeletion, ExecutorTaskPtr( new RecordingTask(&recorder, eTaskPriorityCacheDeletion) ) );
+    EXPECT_EQ( 1, executor.getNumPendingTasks(eTaskPriorityPreview) );
+
+    gate.release();
+    ASSERT_TRUE( executor.waitForIdle(10000) );
+
+    ASSERT_EQ( 3u, recorder.order.size() );
+    EXPECT_EQ( (int)eTaskPriorityCacheDeletion, recorder.order[0] );
+    EXPECT_EQ( (int)eTaskPriorityInteractive, recorder.order[1] );
+    EXPECT_EQ( (int)eTaskPriorityPreview, recorder.order[2] );
+
+    // Queue latency is measured per class
+    TaskExecutorStats stats;
+    executor.getStats(eTaskPriorityPreview, &stats);
+    EXPECT_EQ( 1u, stats.nTasksRun );
+    EXPECT_GT( stats.maxQueueLatency, 0. );
+    executor.getStats(eTaskPriorityInteractive, &stats);
+    EXPECT_EQ( 2u, stats.nTasksRun );
+    executor.resetStats();
+    executor.getStats(eTaskPriorityInteractive, &stats);
+    EXPECT_EQ( 0u, stats.nTasksRun );
+}
+
+TEST(TaskExecutor, HousekeepingIsNotStarved)
+{
+    TaskExecutor executor(2);
+    Gate gate1, gate2;
+    Recorder recorder;
+
+    executor.submit( eTaskPriorityInteractive, ExecutorTaskPtr( new BlockingTask(&gate1) ) );
+    executor.submit( eTaskPriorityInteractive, ExecutorTaskPtr( new BlockingTask(&gate2) ) );
+    waitForRunningTasks(executor, eTaskPriorityInteractive, 2);
+
+    executor.submit( eTaskPriorityInteractive, ExecutorTaskPtr( new RecordingTask(&recorder, eTaskPriorityInteractive) ) );
+    executor.submit( eTaskPriorityHousekeeping, ExecutorTaskPtr( new RecordingTask(&recorder, eTaskPriorityHousekeeping) ) );
+
+    // The first worker to be free goes to the housekeeping task even though renders are waiting
+    gate1.release();
+    while ( executor.getNumPendingTasks(eTaskPriorityHousekeeping) > 0 ) {
+        QThread::yieldCurrentThread();
+    }
+    gate2.release();
+    ASSERT_TRUE( executor.waitForIdle(10000) );
+
+    ASSERT_EQ( 2u, recorder.order.size() );
+    EXPECT_EQ( (int)eTaskPriorityHousekeeping, recorder.order[0] );
+    EXPECT_EQ( (int)eTaskPriorityInteractive, recorder.order[1] );
+}
+
+TEST(TaskExecutor, MaxRunningTasks)
+{
+    TaskExecutor executor(4);
+    Gate gate;
+    QSemaphore started;
+    QAtomicInt nRunning(0), maxRunning(0);
+
+    executor.setMaxRunningTasks(eTaskPriorityPreview, 1);
+    executor.submit( eTaskPriorityPreview, ExecutorTaskPtr( new ConcurrencyTask(&gate, &started, &nRunning, &maxRunning) ) );
+    executor.submit( eTaskPriorityPreview, ExecutorTaskPtr( new ConcurrencyTask(&gate, &started, &nRunning, &maxRunning) ) );
+    started.acquire();
+
+    // The second task may only start once the first one is done
+    EXPECT_EQ( 1, executor.getNumRunningTasks(eTaskPriorityPreview) );
+    EXPECT_EQ( 1, executor.getNumPendingTasks(eTaskPriorityPreview) );
+    EXPECT_LE( executor.getNumWorkers(), executor.getMaxWorkers() );
+
+    gate.release();
+    started.acquire();
+    ASSERT_TRUE( executor.waitForIdle(10000) );
+    EXPECT_EQ( 1, (int)maxRunning );
+}
+
+TEST(TaskExecutor, TrySubmit)
+{
+    TaskExecutor executor(1);
+    Gate gate;
+    Recorder recorder;
+
+    // A worker can start it right away
+    ASSERT_TRUE( executor.trySubmit( eTaskPriorityCacheDeletion, ExecutorTaskPtr( new RecordingTask(&recorder, 1) ) ) );
+    ASSERT_TRUE( executor.waitForIdle(10000) );
+
+    // The only worker is busy: the caller must do the work itself
+    executor.submit( eTaskPriorityPreview, ExecutorTaskPtr( new BlockingTask(&gate) ) );
+    waitForRunningTasks(executor, eTaskPriorityPreview, 1);
+    EXPECT_FALSE( executor.trySubmit( eTaskPriorityCacheDeletion, ExecutorTaskPtr( new RecordingTask(&recorder, 2) ) ) );
+    EXPECT_EQ( 0, executor.getNumPendingTasks(eTaskPriorityCacheDeletion) );
+
+    gate.release();
+    ASSERT_TRUE( executor.waitForIdle(10000) );
+    ASSERT_EQ( 1u, recorder.order.size() );
+    EXPECT_EQ( 1, recorder.order[0] );
+}
+
+TEST(TaskExecutor, Cancellation)
+{
+    TaskExecutor executor(1);
+    Gate gate;
+    Recorder recorder;
+
+    executor.submit( eTaskPriorityInteractive, ExecutorTaskPtr( new BlockingTask(&gate) ) );
+    waitForRunningTasks(executor, eTaskPriorityInteractive, 1);
+
+    AbortableRenderInfoPtr abortInfo = AbortableRenderInfo::create(true, 0);
+    ExecutorTaskPtr cancelled( new RecordingTask(&recorder, 1) );
+    executor.submit(eTaskPriorityInteractive, cancelled);
+    executor.submit( eTaskPriorityInteractive, ExecutorTaskPtr( new RecordingTask(&recorder, 2, abortInfo) ) );
+    executor.submit( eTaskPriorityInteractive, ExecutorTaskPtr( new RecordingTask(&recorder, 3) ) );
+
+    cancelled->cancel();
+    // Tasks that belong to an aborted render do not run either
+    abortInfo->setAborted();
+    gate.release();
+    ASSERT_TRUE( executor.waitForIdle(10000) );
+
+    ASSERT_EQ( 1u, recorder.order.size() );
+    EXPECT_EQ( 3, recorder.order[0] );
+    EXPECT_EQ( 2, recorder.nDropped );
+
+    TaskExecutorStats stats;
+    executor.getStats(eTaskPriorityInteractive, &stats);
+    EXPECT_EQ( 2u, stats.nTasksDropped );
+}
+
+TEST(TaskExecutor, Quit)
+{
+    TaskExecutor executor(1);
+    Gate gate;
+    Recorder recorder;
+
+    executor.submit( eTaskPriorityHousekeeping, ExecutorTaskPtr( new BlockingTask(&gate) ) );
+    waitForRunningTasks(executor, eTaskPriorityHousekeeping, 1);
+    executor.submit( eTaskPriorityHousekeeping, ExecutorTaskPtr( new RecordingTask(&recorder, 1) ) );
+
+    gate.release();
+    executor.quit();
+
+    // Queued tasks are dropped, the running one completed
+    EXPECT_EQ( 0, executor.getNumWorkers() );
+    EXPECT_FALSE( executor.submit( eTaskPriorityHousekeeping, ExecutorTaskPtr( new RecordingTask(&recorder, 2) ) ) );
+    EXPECT_EQ( 1u, recorder.order.size() + (std::size_t)recorder.nDropped );
+}
@@ -54,7 +54,15 @@ SOURCES += \
     Lut_Test.cpp \
     KnobFile_Test.cpp \
     Curve_Test.cpp \
-    Tracker_Test.cpp
+    RotoShapeRender_Test.cpp \
+    PlaybackController_Test.cpp \
+    BezierCPDelta_Test.cpp \
+    PrecompCache_Test.cpp \
+    Tracker_Test.cpp \
+    TaskExecutor_Test.cpp \
+    MultiThreadExecutor_Test.cpp \
+    TLSHolder_Test.cpp \
+    ViewerTileCodec_Test.cpp
 
 HEADERS += \
     BaseTest.h
@@ -24,6 +24,7 @@
 
 #include "Global/Macros.h"
 
+#include <set>
 #include <vector>
 #include <cmath>
 #include <cstdlib>
@@ -35,7 +36,9 @@ GCC_DIAG_UNUSED_LOCAL_TYPEDEFS_OFF
 GCC_DIAG_UNUSED_LOCAL_TYPEDEFS_ON
 
 #include "Engine/EngineFwd.h"
+#include "Engine/RectD.h"
 #include "Engine/Transform.h"
+#include "Engine/TrackerContextPrivate.h"
 #include "Global/GlobalDefines.h"
 
 NATRON_NAMESPACE_USING;
@@ -464,3 +467,127 @@ TEST(ModelSearch, HomographyNPoints)
     }
     testHomography(x1);
 }
+
+// Fills a solver batch with nMarkers markers translated by (time, 2 * time) and whose error decreases
+// with the marker index, marker 1 being unused at odd keyframes
+static void
+makeTranslationSolverBatch(int nMarkers,
+                           int jitterPeriod,
+                           TrackerContextPrivate::SolverBatch* batch)
+{
+    const int halfJitter = jitterPeriod > 1 ? jitterPeriod / 2 : 0;
+
+    for (double t = batch->keyframes.front() - halfJitter; t <= batch->keyframes.back() + halfJitter; t += 1.) {
+        batch->sampleTimes.push_back(t);
+    }
+    const std::size_t nSamples = batch->sampleTimes.size();
+    const std::size_t nKeys = batch->keyframes.size();
+    batch->centers.resize(nMarkers * nSamples);
+    batch->errors.resize(nMarkers * nKeys);
+    batch->used.resize(nMarkers * nKeys);
+    for (int m = 0; m < nMarkers; ++m) {
+        for (std::size_t s = 0; s < nSamples; ++s) {
+            batch->centers[m * nSamples + s].x = 10. * m + batch->sampleTimes[s];
+            batch->centers[m * nSamples + s].y = 100. - 5. * m + 2. * batch->sampleTimes[s];
+        }
+        for (std::size_t k = 0; k < nKeys; ++k) {
+            batch->used[m * nKeys + k] = m != 1 || ( (int)batch->keyframes[k] % 2 == 0 );
+            batch->errors[m * nKeys + k] = nMarkers - m;
+        }
+    }
+}
+
+TEST(TrackSolver, KeyframeBatches)
+{
+    std::set<double> keyframes;
+
+    for (int i = 0; i < 10; ++i) {
+        keyframes.insert(i);
+    }
+
+    std::vector<std::vector<double> > batches;
+    TrackerContextPrivate::makeSolverBatches(keyframes, 4, &batches);
+    ASSERT_EQ(4, (int)batches.size());
+    std::vector<double> all;
+    for (std::size_t i = 0; i < batches.size(); ++i) {
+        EXPECT_FALSE( batches[i].empty() );
+        all.insert( all.end(), batches[i].begin(), batches[i].end() );
+    }
+    EXPECT_EQ( std::vector<double>( keyframes.begin(), keyframes.end() ), all );
+
+    // Never more batches than keyframes
+    TrackerContextPrivate::makeSolverBatches(keyframes, 100, &batches);
+    EXPECT_EQ(10, (int)batches.size());
+
+    keyframes.clear();
+    TrackerContextPrivate::makeSolverBatches(keyframes, 4, &batches);
+    EXPECT_TRUE( batches.empty() );
+}
+
+TEST(TrackSolver, SortedPointsFromBatch)
+{
+    const int nMarkers = 4;
+    const int jitterPeriod = 3;
+    TrackerContextPrivate::SolverBatch batch;
+
+    for (int i = 10; i < 20; ++i) {
+        batch.keyframes.push_back(i);
+    }
+    makeTranslationSolverBatch(nMarkers, jitterPeriod, &batch);
+
+    std::vector<Point> refPoints(nMarkers);
+    for (int m = 0; m < nMarkers; ++m) {
+        refPoints[m].x = 10. * m;
+        refPoints[m].y = 100. - 5. * m;
+    }
+
+    std::vector<Point> x1, x2;
+    for (std::size_t k = 0; k < batch.keyframes.size(); ++k) {
+        const double time = batch.keyframes[k];
+        TrackerContextPrivate::makeSortedPointsFromSolverBatch(batch, k, refPoints, jitterPeriod, false, &x1, &x2);
+        const bool marker1Used = (int)time % 2 == 0;
+        ASSERT_EQ(marker1Used ? nMarkers : nMarkers - 1, (int)x1.size());
+        ASSERT_EQ( x1.size(), x2.size() );
+
+        // Sorted by increasing error, i.e: by decreasing marker index
+        EXPECT_EQ(refPoints[nMarkers - 1].x, x1.front().x);
+        EXPECT_EQ(refPoints[0].x, x1.back().x);
+
+        // The tracks are linear, so averaging over the jitter window gives the point at the keyframe
+        for (std::size_t i = 0; i < x1.size(); ++i) {
+            EXPECT_NEAR(x1[i].x + time, x2[i].x, 1e-9);
+            EXPECT_NEAR(x1[i].y + 2. * time, x2[i].y, 1e-9);
+        }
+    }
+}
+
+TEST(TrackSolver, TranslationFromBatch)
+{
+    const int nMarkers = 8;
+    TrackerContextPrivate::SolverBatch batch;
+
+    for (int i = 1; i < 50; ++i) {
+        batch.keyframes.push_back(i);
+    }
+    makeTranslationSolverBatch(nMarkers, 0, &batch);
+
+    std::vector<Point> refPoints(nMarkers);
+    for (int m = 0; m < nMarkers; ++m) {
+        refPoints[m].x = 10. * m;
+        refPoints[m].y = 100. - 5. * m;
+    }
+
+    RectD rod(0, 0, 500, 500);
+    std::vector<Point> x1, x2;
+    for (std::size_t k = 0; k < batch.keyframes.size(); ++k) {
+        const double time = batch.keyframes[k];
+        TrackerContextPrivate::makeSortedPointsFromSolverBatch(batch, k, refPoints, 0, false, &x1, &x2);
+        TrackerContextPrivate::TransformData data = TrackerContextPrivate::computeTransformParamsFromPoints(0., time, true, rod, rod, x1, x2);
+        ASSERT_TRUE(data.valid);
+        EXPECT_EQ(time, data.time);
+        EXPECT_NEAR(time, data.translation.x, 1e-6);
+        EXPECT_NEAR(2. * time, data.translation.y, 1e-6);
+        EXPECT_NEAR(0., data.rotation, 1e-6);
+        EXPECT_NEAR(1., data.scale, 1e-6);
+    }
+}
@@ -0,0 +1,130 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * This file is part of Natron <http://www.natron.fr/>,
+ * Copyright (C) 2016 INRIA and Alexandre Gauthier-Foichat
+ *
+ * Natron is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Natron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Natron.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>
+ * ***** END LICENSE BLOCK ***** */
+
+// ***** BEGIN PYTHON BLOCK *****
+// from <https://docs.python.org/3/c-api/intro.html#include-files>:
+// "Since Python may define some pre-processor definitions which affect the standard headers on some systems, you must include Python.h before any standard headers are included."
+#include <Python.h>
+// ***** END PYTHON BLOCK *****
+
+#include "Global/Macros.h"
+
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+#include <gtest/gtest.h>
+#include "Engine/ViewerTileCodec.h"
+
+NATRON_NAMESPACE_USING
+
+namespace {
+// A smooth gradient with some mild noise, similar to what a viewer tile of natural footage holds
+void
+makeByteTile(int size,
+             int noise,
+             std::vector<unsigned char>* pixels)
+{
+    pixels->resize(size * size * 4);
+    std::srand(1);
+    for (int y = 0; y < size; ++y) {
+        for (int x = 0; x < size; ++x) {
+            unsigned char* p = &(*pixels)[(y * size + x) * 4];
+            for (int c = 0; c < 3; ++c) {
+                int v = (x * (c + 1) + y * 2) / 3 + (noise ? std::rand() % noise : 0);
+                p[c] = (unsigned char)std::min(255, v);
+            }
+            p[3] = 255;
+        }
+    }
+}
+}
+
+TEST(ViewerTileCodec, ByteLossless) {
+    const int size = 64;
+    std::vector<unsigned char> pixels;
+
+    makeByteTile(size, 2, &pixels);
+    std::vector<unsigned char> encoded(pixels.size() / 2);
+    std::size_t written = ViewerTileCodec::encode(&pixels[0], size, size, eImageBitDepthByte, &encoded[0], encoded.size());
+    ASSERT_GT(written, 0u);
+    EXPECT_LE( written, encoded.size() );
+    EXPECT_TRUE( ViewerTileCodec::isLossless(&encoded[0], written) );
+
+    std::vector<unsigned char> decoded( pixels.size() );
+    ASSERT_TRUE( ViewerTileCodec::decode(&encoded[0], written, size, size, eImageBitDepthByte, &decoded[0]) );
+    EXPECT_TRUE(decoded == pixels);
+}
+
+TEST(ViewerTileCodec, ByteNearLossless) {
+    const int size = 64;
+    std::vector<unsigned char> pixels;
+
+    // Too noisy to be coded losslessly in a third of the size
+    makeByteTile(size, 16, &pixels);
+    std::vector<unsigned char> encoded(pixels.size() / 3);
+    std::size_t written = ViewerTileCodec::encode(&pixels[0], size, size, eImageBitDepthByte, &encoded[0], encoded.size());
+    ASSERT_GT(written, 0u);
+    EXPECT_LE( written, encoded.size() );
+    EXPECT_FALSE( ViewerTileCodec::isLossless(&encoded[0], written) );
+
+    std::vector<unsigned char> decoded( pixels.size() );
+    ASSERT_TRUE( ViewerTileCodec::decode(&encoded[0], written, size, size, eImageBitDepthByte, &decoded[0]) );
+    for (std::size_t i = 0; i < pixels.size(); ++i) {
+        // At most 4 bits are dropped, and the decoded value is the middle of the dropped range
+        EXPECT_LE(std::abs( (int)decoded[i] - (int)pixels[i] ), 8);
+    }
+
+    // Pure noise cannot be coded near-losslessly in a third of the size: it is not encoded at all
+    for (std::size_t i = 0; i < pixels.size(); ++i) {
+        pixels[i] = (unsigned char)(std::rand() & 0xff);
+    }
+    written = ViewerTileCodec::encode(&pixels[0], size, size, eImageBitDepthByte, &encoded[0], encoded.size());
+    EXPECT_EQ(0u, written);
+}
+
+TEST(ViewerTileCodec, Float) {
+    const int size = 32;
+    std::vector<float> pixels(size * size * 4);
+
+    for (int y = 0; y < size; ++y) {
+        for (int x = 0; x < size; ++x) {
+            float* p = &pixels[(y * size + x) * 4];
+            p[0] = x / (float)size;
+            p[1] = -y / (float)size;
+            p[2] = 100.f + x * y;
+            p[3] = 1.f;
+        }
+    }
+    std::size_t rawSize = ViewerTileCodec::getUncompressedSize(size, size, eImageBitDepthFloat);
+    ASSERT_EQ( rawSize, pixels.size() * sizeof(float) );
+    std::vector<unsigned char> encoded(rawSize / 4);
+    std::size_t written = ViewerTileCodec::encode( (const unsigned char*)&pixels[0], size, size, eImageBitDepthFloat, &encoded[0], encoded.size() );
+    ASSERT_GT(written, 0u);
+
+    std::vector<float> decoded( pixels.size() );
+    ASSERT_TRUE( ViewerTileCodec::decode(&encoded[0], written, size, size, eImageBitDepthFloat, (unsigned char*)&decoded[0]) );
+    for (std::size_t i = 0; i < pixels.size(); ++i) {
+        // half-float precision
+        EXPECT_NEAR(decoded[i], pixels[i], std::fabs(pixels[i]) * 1e-3 + 1e-6);
+    }
+
+    // Decoding with the wrong depth or a truncated stream must fail
+    std::vector<unsigned char> bytes(size * size * 4);
+    EXPECT_FALSE( ViewerTileCodec::decode(&encoded[0], written, size, size, eImageBitDepthByte, &bytes[0]) );
+    EXPECT_FALSE( ViewerTileCodec::decode(&encoded[0], written / 2, size, size, eImageBitDepthFloat, (unsigned char*)&decoded[0]) );
+}